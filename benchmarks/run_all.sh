@@ -5,6 +5,10 @@
 # Usage:
 #   ./run_all.sh                    # Run benchmarks, generate charts
 #   ./run_all.sh --baseline malloc  # Save as baseline comparison
+#   ./run_all.sh --compare main     # Run, then diff against baseline/main
+#
+# Each harness also writes tslab-bench-v1 JSON Lines (*.jsonl) with per-phase
+# hardware counters; set TSLAB_BENCH_PERF=0 to skip perf_event_open.
 #
 
 set -e
@@ -18,18 +22,44 @@ IMAGES_DIR="$PROJECT_ROOT/docs/images"
 
 # Parse arguments
 BASELINE=""
-if [[ "$1" == "--baseline" ]] && [[ -n "$2" ]]; then
-    BASELINE="$2"
+COMPARE=""
+while [[ $# -gt 0 ]]; do
+    case "$1" in
+        --baseline)
+            BASELINE="$2"
+            shift 2
+            ;;
+        --compare)
+            COMPARE="$2"
+            shift 2
+            ;;
+        *)
+            echo "Unknown argument: $1" >&2
+            echo "Usage: $0 [--baseline NAME] [--compare NAME]" >&2
+            exit 1
+            ;;
+    esac
+done
+
+if [[ -n "$BASELINE" ]]; then
     RESULTS_DIR="$SCRIPT_DIR/baseline/$BASELINE/results"
     mkdir -p "$RESULTS_DIR"
     echo "Running in baseline mode: $BASELINE"
     echo "Results will be saved to: $RESULTS_DIR"
 fi
 
+if [[ -n "$COMPARE" ]]; then
+    COMPARE_DIR="$SCRIPT_DIR/baseline/$COMPARE/results"
+    if ! ls "$COMPARE_DIR"/*.jsonl >/dev/null 2>&1; then
+        echo "No JSONL baseline in $COMPARE_DIR (create it with --baseline $COMPARE)" >&2
+        exit 1
+    fi
+fi
+
 # Ensure binaries are built
 echo "Building benchmarks..."
 cd "$SRC_DIR"
-make -s benchmark_accurate churn_test smoke_tests
+make -s benchmark_accurate benchmark_threads churn_test smoke_tests locality_bench
 
 # Create results directory
 mkdir -p "$RESULTS_DIR"
@@ -37,7 +67,17 @@ mkdir -p "$RESULTS_DIR"
 # Run benchmarks
 echo ""
 echo "Running benchmark_accurate..."
-./benchmark_accurate --csv "$RESULTS_DIR/latency.csv" | grep -E "(Average|p50|p99|p999|RSS|Summary|efficiency)"
+./benchmark_accurate --csv "$RESULTS_DIR/latency.csv" --json "$RESULTS_DIR/accurate.jsonl" | \
+    grep -E "(Average|p50|p99|p999|RSS|Summary|efficiency|HW counters)"
+
+echo ""
+echo "Running benchmark_threads..."
+./benchmark_threads --csv "$RESULTS_DIR/scaling.csv" --json "$RESULTS_DIR/threads.jsonl" | \
+    grep -E "(Testing with|Throughput|Avg p99|HW counters)"
+
+echo ""
+echo "Running locality_bench..."
+../workloads/locality_bench --json "$RESULTS_DIR/locality.jsonl" | grep -E "(operations|HW counters)"
 
 echo ""
 echo "Running churn_test (this takes ~30 seconds)..."
@@ -71,7 +111,13 @@ if [[ -z "$BASELINE" ]]; then
 else
     echo ""
     echo "✓ Baseline results saved to: $RESULTS_DIR"
-    echo "  Use tools/compare_allocators.py to compare baselines (coming soon)"
+    echo "  Compare later runs with: ./run_all.sh --compare $BASELINE"
+fi
+
+if [[ -n "$COMPARE" ]]; then
+    echo ""
+    echo "Comparing against baseline: $COMPARE"
+    python3 "$TOOLS_DIR/plot_bench.py" --input "$RESULTS_DIR" --compare "$COMPARE_DIR"
 fi
 
 echo ""
@@ -19,10 +19,11 @@
 
 typedef struct epoch_domain {
     SlabAllocator* alloc;      /* Allocator instance */
-    EpochId epoch_id;          /* Underlying epoch (ring index 0-15) */
+    EpochId epoch_id;          /* Underlying epoch (era-qualified from epoch_current) */
     uint64_t epoch_era;        /* Era captured at create/wrap time (wrap-around safety) */
     uint32_t refcount;         /* Nesting depth (thread-local by contract) */
     bool auto_close;           /* Close epoch on last exit? */
+    bool default_classes;      /* Allocator uses the default class table */
 
     /* Enforce thread-local contract */
     pthread_t owner_tid;
@@ -86,4 +87,46 @@ void epoch_domain_destroy(epoch_domain_t* domain);
  */
 void epoch_domain_force_close(epoch_domain_t* domain);
 
+/**
+ * Allocate from the domain's epoch (domain-bound fast path).
+ *
+ * Equivalent to alloc_obj_epoch(domain->alloc, size, domain->epoch_id, out),
+ * but the epoch is resolved once per thread when the domain is entered:
+ * each call rechecks only that the epoch is still open and still at the
+ * same era, then claims a slot from the current slab. A closed epoch, or
+ * one whose ring slot was reopened, falls back to alloc_obj_epoch() and
+ * gets its usual result (NULL for a stale epoch).
+ *
+ * Meant for use between epoch_domain_enter() and epoch_domain_exit() on the
+ * owner thread; outside a scope the first call binds the epoch lazily.
+ *
+ * epoch_domain_alloc() is inline: with a compile-time constant size and the
+ * default class table the class index folds to a constant, otherwise it is
+ * looked up per call (epoch_domain_alloc_size).
+ *
+ * @param domain Domain to allocate from
+ * @param size Requested size in bytes (same rules as alloc_obj_epoch)
+ * @param out Optional handle output (may be NULL)
+ * @return Object pointer, or NULL (see alloc_obj_epoch)
+ */
+void* epoch_domain_alloc_size(epoch_domain_t* domain, uint32_t size, SlabHandle* out);
+
+/**
+ * Allocate an object of size class `size_class` from the domain's epoch.
+ * Class indices are positions in the allocator's size-class table.
+ *
+ * @return Object pointer, or NULL for an unknown class or as epoch_domain_alloc()
+ */
+void* epoch_domain_alloc_class(epoch_domain_t* domain, uint32_t size_class, SlabHandle* out);
+
+static inline void* epoch_domain_alloc(epoch_domain_t* domain, uint32_t size, SlabHandle* out) {
+#if defined(__GNUC__)
+    if (__builtin_constant_p(size) && slab_default_class_index(size) >= 0 &&
+        domain && domain->default_classes) {
+        return epoch_domain_alloc_class(domain, (uint32_t)slab_default_class_index(size), out);
+    }
+#endif
+    return epoch_domain_alloc_size(domain, size, out);
+}
+
 #endif /* EPOCH_DOMAIN_H */
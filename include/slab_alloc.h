@@ -24,7 +24,8 @@
  * - No background compaction or relocation (no latency spikes)
  * 
  * TRADE-OFFS:
- * - Fixed size classes only (64-768 bytes in 8 classes)
+ * - Fixed size classes only (64-768 bytes on single-page slabs, 1K-16K on
+ *   multi-page slabs; 14 classes total)
  * - 11.1% internal fragmentation (vs ~5-10% for jemalloc)
  * - No NUMA awareness (single allocator for all threads)
  * - Compared to jemalloc: sacrifices generality for deterministic behavior
@@ -38,7 +39,7 @@
  * 
  * NOT SUITABLE FOR:
  * - Variable-size allocations (use jemalloc/tcmalloc)
- * - Large objects >768 bytes (use general-purpose allocator)
+ * - Large objects >16KB (use general-purpose allocator)
  * - Drop-in malloc replacement (use jemalloc with LD_PRELOAD)
  * 
  * BASIC USAGE:
@@ -72,32 +73,85 @@
 
 /* ==================== Configuration ==================== */
 
-/* Size of each slab (must be page-aligned)
+/* Base slab size (small tier)
  * Each slab is subdivided into fixed-size slots based on size class.
- * Common page size on x86-64, ARM64, and most modern systems.
+ * This is the allocator's unit, not the OS page size: it stays 4KB on
+ * 16KB/64KB-page kernels, where several slabs share one OS page (see
+ * SlabClassStats.release_bytes). Slab sizes never depend on the host.
  */
 #define SLAB_PAGE_SIZE 4096u
 
+/* Size class layout
+ *
+ * Small tier (64-768 bytes): one SLAB_PAGE_SIZE slab.
+ * Large tier (1K-16K bytes): power-of-two slabs sized to hold ~16 objects
+ * (16KB slabs for 1KB objects up to 256KB slabs for 16KB objects).
+ *
+ * Both tiers get epoch grouping, handles, and epoch_close() reclamation.
+ *
+ * SLAB_NUM_CLASSES is the size of the default table. Custom tables
+ * (allocator_init_with_config) may hold up to SLAB_MAX_CLASSES entries,
+ * each between SLAB_MIN_OBJECT_SIZE and SLAB_MAX_OBJECT_SIZE.
+ */
+#define SLAB_NUM_CLASSES     14u
+#define SLAB_MAX_CLASSES     32u
+#define SLAB_MIN_OBJECT_SIZE 16u
+#define SLAB_MAX_OBJECT_SIZE 16384u
+
+/* Class index of `size` in the default table, or -1 if no class fits.
+ * Written as a comparison chain so a constant size folds to a constant
+ * (see epoch_domain_alloc). Only valid for allocators built with the
+ * default table. */
+static inline int slab_default_class_index(uint32_t size) {
+  return size == 0u    ? -1 : size <= 64u   ? 0  : size <= 96u   ? 1  :
+         size <= 128u  ? 2  : size <= 192u  ? 3  : size <= 256u  ? 4  :
+         size <= 384u  ? 5  : size <= 512u  ? 6  : size <= 768u  ? 7  :
+         size <= 1024u ? 8  : size <= 1536u ? 9  : size <= 2048u ? 10 :
+         size <= 4096u ? 11 : size <= 8192u ? 12 : size <= 16384u ? 13 : -1;
+}
+
+/* NUMA nodes tracked per size class (slab pools, arenas, stats).
+ * Nodes beyond this fold onto node_id % SLAB_MAX_NUMA_NODES. */
+#define SLAB_MAX_NUMA_NODES  8u
+
 /* ==================== Epoch Management ==================== */
 
+/* Epoch ring size (SlabAllocatorConfig.epoch_count). The ring is rounded up
+ * to a power of two; each extra slot costs one EpochState (~180 bytes) per
+ * size class. */
+#define SLAB_DEFAULT_EPOCHS  16u
+#define SLAB_MAX_EPOCHS      4096u
+
 /* Epoch ID for temporal grouping
  * 
  * Objects allocated in the same epoch are grouped into the same slabs,
  * enabling efficient reclamation when the epoch expires.
  * 
  * PROPERTIES:
- * - Epochs are numbered 0..N-1 (ring buffer, N=16 by default)
+ * - Epochs live in a ring of N slots (N = SLAB_DEFAULT_EPOCHS unless
+ *   configured, see slab_epoch_count())
  * - Epoch 0 is the default for backward compatibility
  * - Epochs advance via epoch_advance() call
  * - Closed epochs drain naturally (no forced compaction)
  * 
+ * ENCODING (64-bit, era-qualified):
+ *   bits  0-31: ring index (SLAB_EPOCH_INDEX)
+ *   bits 32-63: era + 1, truncated to 32 bits (0 = unqualified)
+ * 
+ *   epoch_current() returns qualified IDs. Once epoch_advance() wraps onto
+ *   the same ring slot, the old ID is stale and every API rejects it:
+ *   allocations return NULL, epoch_close/epoch_release_all/labels/refcounts
+ *   are no-ops, epoch_close_async fails with ESTALE. A stale ID never
+ *   aliases the newer epoch's slabs. Bare ring indices (upper half zero)
+ *   are still accepted and name whichever epoch occupies the slot.
+ * 
  * LIFECYCLE:
- *   uint32_t e0 = epoch_current(alloc);  // Returns active epoch
+ *   EpochId e0 = epoch_current(alloc);  // Returns active epoch
  *   void* p = alloc_obj_epoch(alloc, 128, e0, &h);
  *   
  *   epoch_advance(alloc);  // Rotate to next epoch
  *   
- *   uint32_t e1 = epoch_current(alloc);  // New allocations go here
+ *   EpochId e1 = epoch_current(alloc);  // New allocations go here
  *   void* q = alloc_obj_epoch(alloc, 128, e1, &h2);
  * 
  * USE CASES:
@@ -105,7 +159,10 @@
  * - Cache entries: group by insertion time, evict entire epochs
  * - Message queues: separate producer epochs, batch-free on consumer drain
  */
-typedef uint32_t EpochId;
+typedef uint64_t EpochId;
+
+#define SLAB_EPOCH_INDEX(id) ((uint32_t)(id))                /* Ring slot of an ID */
+#define SLAB_EPOCH_IS_QUALIFIED(id) (((id) >> 32) != 0)     /* Carries an era */
 
 /* Epoch lifecycle state for observability
  * 
@@ -196,7 +253,7 @@ typedef uint64_t SlabHandle;
  */
 typedef struct PerfCounters {
   uint64_t slow_path_hits;              /* Total times fast path failed (lock acquired) */
-  uint64_t new_slab_count;              /* Total slabs allocated from OS (mmap calls) */
+  uint64_t new_slab_count;              /* Total fresh slabs carved from arenas */
   uint64_t list_move_partial_to_full;   /* Slabs that became completely full */
   uint64_t list_move_full_to_partial;   /* Slabs with at least one free after being full */
   uint64_t current_partial_null;        /* Fast path found no current_partial slab */
@@ -209,15 +266,16 @@ typedef struct PerfCounters {
 
 /* Create a new allocator instance
  * 
- * Allocates and initializes an allocator with 8 size classes:
- * 64, 96, 128, 192, 256, 384, 512, 768 bytes.
+ * Allocates and initializes an allocator with SLAB_NUM_CLASSES size classes:
+ * 64, 96, 128, 192, 256, 384, 512, 768 bytes (single-page slabs) and
+ * 1024, 1536, 2048, 4096, 8192, 16384 bytes (multi-page slabs).
  * 
  * RETURNS: Pointer to allocator, or NULL on allocation failure
  * 
  * INITIALIZATION:
- * - Builds O(1) class lookup table (768 bytes, once per process)
+ * - Builds O(1) class lookup table (16KB, once per process)
  * - Allocates per-size-class structures (~4KB total)
- * - Initializes slab cache (32 slots × 8 classes = 256 slab capacity)
+ * - Initializes slab cache (32 slots per class)
  * - Does NOT pre-allocate slabs (allocated on first use per class)
  * 
  * LIFETIME:
@@ -298,6 +356,205 @@ void slab_allocator_free(SlabAllocator* alloc);
 void allocator_init(SlabAllocator* alloc);
 void allocator_destroy(SlabAllocator* alloc);
 
+/* ==================== Size-Class Configuration ==================== */
+
+/* How recycled slabs return physical memory (ENABLE_RSS_RECLAMATION=1)
+ * 
+ * IMMEDIATE: one madvise(MADV_DONTNEED) per slab as it is recycled (default)
+ * BATCHED:   slabs recycled together (epoch_close, epoch_release_all) are
+ *            sorted, adjacent slabs coalesced into ranges, and the ranges
+ *            returned with one vectored process_madvise() where the kernel
+ *            supports it (per-range madvise otherwise)
+ * LAZY:      as BATCHED with MADV_FREE: cheaper (no immediate zeroing or
+ *            TLB shootdown), pages drop from RSS only under memory pressure
+ * 
+ * Only never-published slabs are madvised in any mode.
+ */
+typedef enum SlabReclaimMode {
+  SLAB_RECLAIM_IMMEDIATE = 0,
+  SLAB_RECLAIM_BATCHED   = 1,
+  SLAB_RECLAIM_LAZY      = 2,
+} SlabReclaimMode;
+
+/* Allocator configuration
+ * 
+ * Zero-initialize and set only the fields you need; zero/NULL fields keep
+ * the defaults used by slab_allocator_create().
+ * 
+ * SIZE CLASSES:
+ *   size_classes - Ascending object sizes, or NULL for the default table
+ *                  (64, 96, 128, 192, 256, 384, 512, 768, 1K ... 16K)
+ *   num_classes  - Entries in size_classes (1..SLAB_MAX_CLASSES)
+ * 
+ *   Each size must be a multiple of 8 in [SLAB_MIN_OBJECT_SIZE,
+ *   SLAB_MAX_OBJECT_SIZE], strictly greater than the previous one. Requests
+ *   above the largest configured class are rejected (alloc returns NULL).
+ * 
+ * RECLAMATION:
+ *   reclaim_mode - SlabReclaimMode (0 = SLAB_RECLAIM_IMMEDIATE)
+ * 
+ * CROSS-THREAD FREE:
+ *   remote_free  - Frees of a slab that the freeing CPU slot is not
+ *                  currently allocating from are pushed onto that slab's
+ *                  lock-free remote stack (one CAS, no bitmap/free_count
+ *                  RMW, no list lock). The allocating side absorbs the stack
+ *                  in one batch when it exhausts the slab; epoch_close()
+ *                  absorbs what is left. Suits producer/consumer pipelines.
+ *                  Trade-off: a second free of an object still on a remote
+ *                  stack is not detected, and freed slots become reusable
+ *                  only after the next absorb.
+ * 
+ * MALLOC-STYLE API:
+ *   header_free  - slab_malloc_epoch() returns the object itself, with no
+ *                  8-byte handle prefix, so a 64B request uses the 64B class
+ *                  and the limit is the largest class. slab_free() recovers
+ *                  slab, slot and class from the pointer (slab headers sit
+ *                  at slab-size-aligned addresses) and validates the header
+ *                  magic against the registry. Trade-off: the handle is
+ *                  rebuilt with the slab's current generation, so a double
+ *                  free is caught only while the slot is still free.
+ * 
+ * EPOCH RING:
+ *   epoch_count  - Ring slots, i.e. epochs that can be open at once
+ *                  (0 = SLAB_DEFAULT_EPOCHS). Rounded up to a power of two;
+ *                  above SLAB_MAX_EPOCHS is EINVAL. One epoch per in-flight
+ *                  request batch needs a ring at least as large as the
+ *                  number of batches in flight, or epoch_advance() wraps
+ *                  onto epochs that are still draining.
+ * 
+ * PAGES:
+ *   hugepage_slabs - Back slab arenas with transparent huge pages
+ *                  (madvise(MADV_HUGEPAGE)) for TLB reach. Pages then go
+ *                  back to the OS a whole huge page at a time, once every
+ *                  slab in it sits in the slab cache, so RSS moves in 2MB
+ *                  steps. Ignored (SlabGlobalStats.hugepage_bytes == 0)
+ *                  without THP, or when the huge page is larger than an
+ *                  arena (64KB-page arm64 kernels use 512MB).
+ * 
+ *   Slab sizes never depend on the OS page size. On 16KB/64KB-page kernels
+ *   small slabs share an OS page, and its memory is returned only once all
+ *   of them are cached (SlabClassStats.release_bytes is the unit).
+ * 
+ * EXAMPLE (histogram peaks at 40B and 144B):
+ *   static const uint32_t classes[] = {40, 64, 96, 144, 192, 256, 512, 1024};
+ *   SlabAllocatorConfig cfg = { .size_classes = classes, .num_classes = 8 };
+ *   SlabAllocator* a = slab_allocator_create_with_config(&cfg);
+ */
+typedef struct SlabAllocatorConfig {
+  const uint32_t* size_classes;
+  uint32_t num_classes;
+  SlabReclaimMode reclaim_mode;
+  bool remote_free;
+  bool header_free;
+  uint32_t epoch_count;
+  bool hugepage_slabs;
+} SlabAllocatorConfig;
+
+/* Create / initialize an allocator with a custom configuration
+ * 
+ * RETURNS:
+ *   slab_allocator_create_with_config: allocator, or NULL (errno set)
+ *   allocator_init_with_config:        true, or false (errno set)
+ * 
+ * ERRORS:
+ *   EINVAL - Size-class table violates the rules above, unknown reclaim_mode,
+ *            epoch_count > SLAB_MAX_EPOCHS, or an OS page larger than an
+ *            arena (2MB)
+ *   ENOMEM - Out of memory for per-class or per-epoch state
+ * 
+ * config == NULL is equivalent to slab_allocator_create() / allocator_init().
+ * Class lookup is built per instance (16KB table, O(1) at allocation time).
+ */
+SlabAllocator* slab_allocator_create_with_config(const SlabAllocatorConfig* config);
+bool allocator_init_with_config(SlabAllocator* alloc, const SlabAllocatorConfig* config);
+
+/* Switch reclamation mode at runtime (affects slabs recycled afterwards)
+ * 
+ * RETURNS: true, or false with errno = EINVAL for an unknown mode.
+ */
+bool slab_set_reclaim_mode(SlabAllocator* alloc, SlabReclaimMode mode);
+
+/* Set a soft ceiling on resident slab memory (0 = none, the default)
+ * 
+ * Resident is estimated as carved slab bytes minus cached slabs whose pages
+ * were returned (SlabGlobalStats.resident_estimate_bytes). While it exceeds
+ * the budget, at most once per 100ms (on a fresh slab carve, or on the
+ * background reclaimer's idle tick) every slab cache is trimmed to its warm
+ * floor and, with slab_reclaimer_start() running, CLOSING epochs are queued
+ * for another reclaim pass. Setting a budget already exceeded enforces it
+ * once immediately.
+ * 
+ * Soft: allocations never fail because of it, and slabs still holding live
+ * objects are not touched. Cached slabs that were published lock-free keep
+ * their pages for ~1s after retirement before a trim may return them.
+ * 
+ * RETURNS: true, or false with errno = EINVAL if alloc is NULL.
+ */
+bool slab_set_memory_budget(SlabAllocator* alloc, uint64_t bytes);
+
+/* Suggest a size-class table from a sampled request-size histogram
+ * 
+ * PARAMETERS:
+ *   hist        - hist[s] = number of sampled requests of s bytes
+ *   hist_len    - Entries in hist (sizes > SLAB_MAX_OBJECT_SIZE are ignored)
+ *   max_classes - Size of out_classes (capped at SLAB_MAX_CLASSES)
+ *   out_classes - Output: ascending class sizes, valid for SlabAllocatorConfig
+ * 
+ * RETURNS: Number of classes written (<= max_classes), 0 if the histogram is
+ *          empty or on error (errno = EINVAL / ENOMEM).
+ * 
+ * Minimizes total internal fragmentation (class_size - request_size summed
+ * over samples) exactly via dynamic programming. The largest class always
+ * covers the largest sampled size. Offline/cold-path helper (~10-100ms for
+ * dense histograms).
+ * 
+ * EXAMPLE:
+ *   uint64_t hist[1025] = {0};
+ *   for (...) hist[sampled_size]++;
+ *   uint32_t classes[8];
+ *   uint32_t n = slab_suggest_size_classes(hist, 1025, 8, classes);
+ *   SlabAllocatorConfig cfg = { .size_classes = classes, .num_classes = n };
+ */
+uint32_t slab_suggest_size_classes(const uint64_t* hist, uint32_t hist_len,
+                                   uint32_t max_classes, uint32_t* out_classes);
+
+/* ==================== Warm-up / Pre-reservation ==================== */
+
+/* slab_reserve() flags */
+#define SLAB_RESERVE_PREFAULT  0x1u  /* Fault in every page of the reserved slabs */
+#define SLAB_RESERVE_KEEP_WARM 0x2u  /* Raise the class's warm floor to n_slabs */
+
+/* Pre-create slabs for a size class so the first allocations hit the cache
+ *
+ * PARAMETERS:
+ *   alloc      - Allocator instance
+ *   size_class - Size class index (as for slab_stats_class / get_perf_counters)
+ *   n_slabs    - Slabs to carve and push onto the calling thread's node cache
+ *   flags      - SLAB_RESERVE_* bits (0 = carve only)
+ *
+ * Each slab is carved from the class's arena, takes a registry ID (growing
+ * the registry now rather than on the allocation path) and is pushed onto
+ * the slab cache without being madvised. new_slab() then finds it there:
+ * a cache pop and a header reset instead of an arena carve, a registry
+ * grow and first-touch page faults.
+ *
+ * SLAB_RESERVE_PREFAULT populates the pages (MADV_POPULATE_WRITE, or a
+ * write per page on older kernels), the per-slab equivalent of MAP_POPULATE.
+ * SLAB_RESERVE_KEEP_WARM sets the warm floor: recycling never madvises a
+ * slab while its node cache holds fewer than that many slabs, so the
+ * reserve survives epoch_close() cycles.
+ *
+ * RETURNS: Slabs reserved (< n_slabs only on error, errno = ENOMEM);
+ *          0 with errno = EINVAL for an unknown size_class.
+ *
+ * Thread-safe; cold path (one arena lock per slab, plus page faults).
+ *
+ * EXAMPLE (before market open):
+ *   for (uint32_t c = 0; c < 4; c++)
+ *     slab_reserve(alloc, c, 256, SLAB_RESERVE_PREFAULT | SLAB_RESERVE_KEEP_WARM);
+ */
+uint32_t slab_reserve(SlabAllocator* alloc, uint32_t size_class, uint32_t n_slabs, uint32_t flags);
+
 /* ==================== Core API (Epoch-Aware, Handle-Based) ==================== */
 
 /* Allocate object in specific epoch with explicit handle
@@ -307,8 +564,8 @@ void allocator_destroy(SlabAllocator* alloc);
  * 
  * PARAMETERS:
  *   alloc      - Allocator instance
- *   size       - Requested size in bytes (must be > 0 and <= 768)
- *   epoch      - Epoch ID (must be < epoch_count)
+ *   size       - Requested size in bytes (must be > 0 and <= SLAB_MAX_OBJECT_SIZE)
+ *   epoch      - Epoch ID (valid per epoch_id_valid)
  *   out_handle - Output parameter for handle (must not be NULL)
  * 
  * RETURNS:
@@ -323,10 +580,12 @@ void allocator_destroy(SlabAllocator* alloc);
  *   Size is rounded up to next size class via lookup table:
  *   1-64   → 64    |  65-96   → 96    | 97-128   → 128  | 129-192  → 192
  *   193-256 → 256  |  257-384 → 384   | 385-512  → 512  | 513-768  → 768
+ *   769-1024 → 1K  |  1025-1536 → 1.5K | 1537-2048 → 2K  | 2049-4096 → 4K
+ *   4097-8192 → 8K |  8193-16384 → 16K
  * 
  * PERFORMANCE (Intel Core Ultra 7, 128-byte objects):
  *   Fast path: ~70ns median (lock-free CAS loop)
- *   Slow path: ~2-5µs (new slab allocation via mmap)
+ *   Slow path: ~2-5µs (new slab carved from arena)
  * 
  * THREAD SAFETY: Safe to call concurrently on same allocator.
  */
@@ -350,21 +609,67 @@ void* alloc_obj_epoch(SlabAllocator* alloc, uint32_t size, EpochId epoch, SlabHa
  */
 bool free_obj(SlabAllocator* alloc, SlabHandle handle);
 
+/* ==================== Batch API ==================== */
+
+/* Allocate several same-sized objects from one epoch
+ * 
+ * PARAMETERS:
+ *   alloc       - Allocator instance
+ *   size        - Requested size in bytes (same rules as alloc_obj_epoch())
+ *   epoch       - Epoch ID (valid per epoch_id_valid)
+ *   out_ptrs    - Output array of count pointers (must not be NULL)
+ *   out_handles - Output array of count handles (may be NULL)
+ *   count       - Number of objects wanted
+ * 
+ * RETURNS:
+ *   Number of objects allocated, written to out_ptrs[0..n) and
+ *   out_handles[0..n). Less than count if the epoch closes or memory runs
+ *   out part-way; 0 for invalid size/epoch.
+ * 
+ * PERFORMANCE:
+ *   Claims up to 32 slots per bitmap CAS and updates the slab's free_count,
+ *   stats counters and list state once per slab instead of once per object.
+ * 
+ * THREAD SAFETY: Safe to call concurrently.
+ */
+uint32_t alloc_obj_epoch_batch(SlabAllocator* alloc, uint32_t size, EpochId epoch,
+                               void** out_ptrs, SlabHandle* out_handles, uint32_t count);
+
+/* Free several objects by handle
+ * 
+ * PARAMETERS:
+ *   alloc   - Allocator instance (must be same as used for allocation)
+ *   handles - Array of count handles (any order, any classes/epochs)
+ *   count   - Number of handles
+ * 
+ * RETURNS:
+ *   Number of objects freed. Handles free_obj() would reject (invalid,
+ *   stale, double-free, duplicated within the batch) are skipped.
+ * 
+ * PERFORMANCE:
+ *   Handles are grouped by slab; each slab's bitmap words, free_count and
+ *   list state are touched once per group.
+ * 
+ * THREAD SAFETY: Safe to call concurrently.
+ */
+uint32_t free_obj_batch(SlabAllocator* alloc, const SlabHandle* handles, uint32_t count);
+
 /* ==================== Malloc-Style API ==================== */
 
 /* Allocate memory in specific epoch (malloc-compatible)
  * 
  * PARAMETERS:
  *   alloc - Allocator instance
- *   size  - Requested size in bytes (must be > 0 and <= 760)
- *   epoch - Epoch ID (must be < epoch_count)
+ *   size  - Requested size in bytes (must be > 0 and <= SLAB_MAX_OBJECT_SIZE - 8)
+ *   epoch - Epoch ID (valid per epoch_id_valid)
  * 
  * RETURNS:
  *   Pointer to usable memory, or NULL on failure.
  * 
  * OVERHEAD:
  *   8 bytes per allocation (handle storage in header)
- *   Max usable size: 760 bytes (768 - 8 byte header)
+ *   Max usable size: 16376 bytes (16384 - 8 byte header)
+ *   None with SlabAllocatorConfig.header_free (max: largest class)
  * 
  * THREAD SAFETY: Safe to call concurrently.
  */
@@ -378,19 +683,42 @@ void* slab_malloc_epoch(SlabAllocator* alloc, size_t size, EpochId epoch);
  * 
  * BEHAVIOR:
  *   Reads handle from 8-byte header before ptr and calls free_obj().
+ *   With header_free, finds the slab by masking ptr to each slab size in
+ *   use instead; pointers that resolve to no live slab slot are ignored.
  *   NULL pointers are safely ignored (no-op, like standard free()).
  * 
  * THREAD SAFETY: Safe to call concurrently.
  */
 void slab_free(SlabAllocator* alloc, void* ptr);
 
+/* Usable bytes behind a slab_malloc_epoch() pointer (malloc_usable_size)
+ * 
+ * RETURNS:
+ *   Bytes the caller may use at ptr: the class size, minus the 8-byte
+ *   prefix unless header_free. 0 for NULL, foreign or freed pointers.
+ * 
+ * THREAD SAFETY: Safe to call concurrently.
+ */
+size_t slab_usable_size(SlabAllocator* alloc, const void* ptr);
+
+/* Does ptr point into memory this allocator's slabs were carved from?
+ * 
+ * Lock-free (a two-level bitmap of the allocator's arena regions). Answers
+ * "ours or the system allocator's?" for any pointer without dereferencing
+ * it, e.g. in a free() interposer. True for any address inside an owned
+ * arena, live object or not.
+ * 
+ * THREAD SAFETY: Safe to call concurrently.
+ */
+bool slab_owns(SlabAllocator* alloc, const void* ptr);
+
 /* ==================== Instrumentation ==================== */
 
 /* Get performance counters for a size class
  * 
  * PARAMETERS:
  *   alloc      - Allocator instance
- *   size_class - Size class index (0=64B, 1=96B, 2=128B, ..., 7=768B)
+ *   size_class - Size class index (default table: 0=64B, 1=96B, 2=128B, ..., 13=16KB)
  *   out        - Output buffer for counters (must not be NULL)
  * 
  * USAGE:
@@ -409,12 +737,15 @@ void get_perf_counters(SlabAllocator* alloc, uint32_t size_class, PerfCounters*
 
 /* Calculate how many objects fit in a slab for given size
  * 
- * Accounts for slab header and bitmap overhead.
+ * Accounts for slab header and bitmap overhead, and for the larger slab
+ * size used by the large tier (objects > 768 bytes). The same on every
+ * host: slab sizes do not follow the OS page size.
  * Useful for capacity planning and understanding memory layout.
  * 
  * EXAMPLE:
  *   uint32_t count = slab_object_count(128);  // Returns 31
  *   printf("A 128-byte slab holds %u objects\n", count);
+ *   slab_object_count(4096);  // Returns 15 (64KB slab)
  */
 uint32_t slab_object_count(uint32_t obj_size);
 
@@ -450,15 +781,28 @@ uint64_t now_ns(void);
 
 /* Get current active epoch
  * 
- * Returns the epoch ID that new allocations will be assigned to.
+ * Returns the era-qualified epoch ID that new allocations will be assigned
+ * to. The ID stays valid until the ring wraps onto its slot again.
  * 
  * THREAD SAFETY: Safe to call concurrently.
  */
 EpochId epoch_current(SlabAllocator* alloc);
 
+/* Number of ring slots (SlabAllocatorConfig.epoch_count, rounded up) */
+uint32_t slab_epoch_count(SlabAllocator* alloc);
+
+/* Does the ID still name a live ring slot?
+ * 
+ * False if the ring index is out of range, or the ID is qualified and its
+ * slot has been reopened by a later epoch_advance(). Bare ring indices are
+ * valid whenever in range. One atomic load, no locks.
+ */
+bool epoch_id_valid(SlabAllocator* alloc, EpochId epoch);
+
 /* Advance to next epoch
  * 
- * Rotates the active epoch forward (mod epoch_count).
+ * Rotates the active epoch forward (mod slab_epoch_count()). The slot it
+ * opens gets a new era, so IDs of that slot's previous epoch go stale.
  * Previous epoch is "closed" - no new allocations, but existing objects remain valid.
  * 
  * BEHAVIOR:
@@ -524,6 +868,145 @@ void epoch_advance(SlabAllocator* alloc);
  */
 void epoch_close(SlabAllocator* alloc, EpochId epoch);
 
+/* Release every object of an epoch at once (arena-mode teardown)
+ * 
+ * For epochs whose objects all die together (request arenas): drops every
+ * slab of the epoch straight into the slab cache / madvise path without
+ * per-object free_obj() calls. Cost is O(slabs), not O(objects).
+ * 
+ * BEHAVIOR:
+ * - Marks epoch CLOSING (like epoch_close)
+ * - Bumps each slab's generation: every outstanding handle from the epoch
+ *   fails validation (free_obj returns false) instead of corrupting memory
+ * - Pointers into the epoch become dangling (contents may be zeroed)
+ * 
+ * REQUIREMENTS:
+ *   No thread may allocate into, free from, or access objects of this epoch
+ *   during or after the call.
+ * 
+ * RETURNS: Number of slabs released.
+ * 
+ * EXAMPLE:
+ *   EpochId req = epoch_current(alloc);
+ *   ... allocate freely, never free individually ...
+ *   epoch_release_all(alloc, req);
+ */
+size_t epoch_release_all(SlabAllocator* alloc, EpochId epoch);
+
+/* ==================== Compaction ==================== */
+
+/* Result of slab_compact_epoch() */
+typedef struct SlabCompactStats {
+  uint32_t slabs_scanned;   /* Slabs of the epoch inspected */
+  uint32_t slabs_released;  /* Slabs evacuated (or already empty) and recycled */
+  uint32_t objects_moved;   /* Live objects copied into denser slabs */
+  uint32_t forward_tables;  /* Forwarding tables created for evacuated slabs */
+  uint64_t bytes_released;  /* slabs_released × slab size */
+} SlabCompactStats;
+
+/* Compact a closed epoch by relocating live objects (handle users only)
+ *
+ * A long-lived epoch whose objects die in a scattered order ends up with
+ * many sparsely occupied slabs that epoch_close() cannot reclaim. This
+ * moves the live objects of the sparsest slabs into free slots of the
+ * densest ones, as long as every moved object fits, and recycles the
+ * evacuated slabs (their pages are madvised).
+ *
+ * Outstanding handles to moved objects stay valid: their slab's registry
+ * entry keeps a forwarding table, so slab_handle_deref() and free_obj()
+ * follow it to the object's new home. A table is retired once every
+ * object it forwards has been freed (or by epoch_release_all()).
+ *
+ * REQUIREMENTS:
+ * - The epoch is CLOSING (epoch_close() or epoch_advance() past it);
+ *   otherwise returns 0 with errno = EBUSY
+ * - Objects are reached only through handles: raw pointers from
+ *   alloc_obj_epoch(), slab_malloc_epoch() or an earlier
+ *   slab_handle_deref() are invalid after the call. Not supported with
+ *   SlabAllocatorConfig.header_free (errno = ENOTSUP)
+ * - No thread allocates into, frees from, or dereferences handles of this
+ *   epoch during the call
+ *
+ * RETURNS: Number of slabs released (0 with errno set on refusal).
+ *          out_stats (optional) receives the details.
+ */
+uint32_t slab_compact_epoch(SlabAllocator* alloc, EpochId epoch, SlabCompactStats* out_stats);
+
+/* Resolve a handle to its object's current address
+ *
+ * Follows forwarding tables left by slab_compact_epoch(), so it is the way
+ * to reach an object that may have moved. Lock-free; costs one registry
+ * lookup for objects that never moved.
+ *
+ * RETURNS: Object pointer, or NULL if the handle is invalid, stale or its
+ *          object has been freed (best effort, like free_obj()'s checks).
+ *          The pointer stays valid until the object is freed or its epoch
+ *          is compacted again.
+ *
+ * THREAD SAFETY: Safe to call concurrently, except with a compaction of
+ *                the handle's epoch.
+ */
+void* slab_handle_deref(SlabAllocator* alloc, SlabHandle handle);
+
+/* ==================== Background Reclamation ==================== */
+
+/* Completion callback for epoch_close_async()
+ * 
+ * Runs on the reclaimer thread after the epoch's scan, madvise and RSS
+ * measurement finish. May call epoch_close_async() again; must not call
+ * slab_reclaimer_stop() or destroy the allocator.
+ */
+typedef void (*EpochCloseCallback)(SlabAllocator* alloc, EpochId epoch, void* arg);
+
+/* Reclaimer budget
+ * 
+ * The reclaimer works one size class at a time. After any class that takes
+ * the current slice past slice_budget_ns, it sleeps pause_us before the next
+ * one, capping its CPU share at roughly budget / (budget + pause).
+ * 
+ * slice_budget_ns == 0: no budget (run each close to completion)
+ * config == NULL:       defaults (1ms slices, 200µs pauses)
+ */
+typedef struct SlabReclaimerConfig {
+  uint64_t slice_budget_ns;
+  uint32_t pause_us;
+} SlabReclaimerConfig;
+
+/* Start / stop the background reclaimer thread
+ * 
+ * slab_reclaimer_start RETURNS: true, or false with errno:
+ *   EALREADY - Reclaimer already running
+ *   other    - pthread_create() failure (EAGAIN, ...)
+ * 
+ * slab_reclaimer_stop() finishes every queued close (callbacks included),
+ * then joins the thread. No-op if not running. allocator_destroy() calls it.
+ */
+bool slab_reclaimer_start(SlabAllocator* alloc, const SlabReclaimerConfig* config);
+void slab_reclaimer_stop(SlabAllocator* alloc);
+
+/* Close an epoch, deferring reclamation to the reclaimer thread
+ * 
+ * The caller only marks the epoch CLOSING (one atomic store + enqueue): new
+ * allocations into it are rejected immediately. TLS flush, partial/full list
+ * scans, madvise and the RSS before/after reads run later on the reclaimer.
+ * 
+ * If the epoch is reopened (epoch_advance wraps onto it) before the reclaimer
+ * gets to it, the remaining work is abandoned; the callback still runs.
+ * 
+ * Without a running reclaimer, behaves like epoch_close() on the calling
+ * thread and invokes cb (if non-NULL) before returning.
+ * 
+ * RETURNS: true if queued (or completed inline), false with errno:
+ *   EINVAL - epoch out of range
+ *   ESTALE - qualified ID whose ring slot has since been reopened
+ *   EBUSY  - a close of this epoch is already queued or running
+ * 
+ * epoch_close_done() is the polling alternative to a callback: true once no
+ * close of the epoch is queued or in progress.
+ */
+bool epoch_close_async(SlabAllocator* alloc, EpochId epoch, EpochCloseCallback cb, void* arg);
+bool epoch_close_done(SlabAllocator* alloc, EpochId epoch);
+
 /* ==================== Phase 2.3: Semantic Attribution APIs ==================== */
 
 /* Set semantic label for epoch (for debugging and observability)
@@ -544,6 +1027,39 @@ void epoch_close(SlabAllocator* alloc, EpochId epoch);
  */
 void slab_epoch_set_label(SlabAllocator* alloc, EpochId epoch, const char* label);
 
+/* Called on the allocating thread each time a label's quota refuses a slab
+ * (no allocator locks held). committed/quota are bytes at the time. */
+typedef void (*SlabQuotaCallback)(SlabAllocator* alloc, const char* label,
+                                  uint64_t committed, uint64_t quota, void* arg);
+
+/* Cap the slab memory held by epochs carrying a label
+ * 
+ * Every slab is charged to its epoch's label when new_slab() hands it out
+ * and credited when it goes back to the cache, so accounting costs one
+ * atomic add per slab and nothing per object. A slab that would take the
+ * label past `bytes` is refused: the allocation needing it returns NULL
+ * with errno = EDQUOT (fail fast, no reclaim attempt), and `cb` (optional)
+ * runs. Objects already allocated are unaffected; frees that empty slabs
+ * make room again.
+ * 
+ * PARAMETERS:
+ *   label - Registered like slab_epoch_set_label() (same 16-ID registry);
+ *           "(unlabeled)" names ID 0, epochs with no label
+ *   bytes - Quota in bytes (rounded down to whole slabs); 0 removes it
+ *   cb    - Optional denial callback, replaces any previous one
+ * 
+ * The label an epoch has when a slab is taken is the one charged; set the
+ * label before allocating. Labels are per allocator instance.
+ * 
+ * RETURNS: true, or false with errno = EINVAL (NULL args) or ENOSPC
+ *          (label registry full).
+ */
+bool slab_label_set_quota(SlabAllocator* alloc, const char* label, uint64_t bytes,
+                          SlabQuotaCallback cb, void* arg);
+
+/* Slab bytes currently charged to a label (0 if it was never registered) */
+uint64_t slab_label_committed(SlabAllocator* alloc, const char* label);
+
 /* Increment domain refcount for epoch
  * 
  * Tracks domain enter/exit boundaries for leak detection.
@@ -585,14 +1101,14 @@ uint64_t slab_epoch_get_refcount(SlabAllocator* alloc, EpochId epoch);
 #if ENABLE_TLS_CACHE
 /* Print TLS cache statistics
  * 
- * Prints aggregate statistics across all threads showing:
+ * Prints aggregate statistics across all threads (live and exited) showing:
  * - Alloc attempts, bypassed, hits, refills
- * - Free cached, dribbles, bypassed
+ * - Epoch bins dropped by flush requests, bins evicted
  * - Hit rates and bypass rates
  * 
  * USAGE: Call at end of benchmark to validate TLS behavior
  * 
- * THREAD SAFETY: Acquires thread registry lock
+ * THREAD SAFETY: Acquires thread registry lock (shared)
  */
 void tls_print_stats(void);
 #endif
@@ -604,14 +1120,14 @@ void tls_print_stats(void);
  * PARAMETERS:
  *   alloc      - Allocator instance
  *   size       - Requested size in bytes
- *   epoch      - Epoch ID (must be < epoch_count)
+ *   epoch      - Epoch ID (valid per epoch_id_valid)
  *   out_handle - Output parameter for handle
  * 
  * RETURNS:
  *   Pointer to allocated memory, or NULL on failure.
  * 
  * EPOCH VALIDATION:
- *   If epoch >= epoch_count, returns NULL.
+ *   If the epoch ID is out of range or stale, returns NULL.
  * 
  * THREAD SAFETY: Safe to call concurrently.
  */
@@ -624,7 +1140,7 @@ void* alloc_obj_epoch(SlabAllocator* alloc, uint32_t size, EpochId epoch, SlabHa
  * PARAMETERS:
  *   alloc - Allocator instance
  *   size  - Requested size in bytes
- *   epoch - Epoch ID (must be < epoch_count)
+ *   epoch - Epoch ID (valid per epoch_id_valid)
  * 
  * RETURNS:
  *   Pointer to usable memory, or NULL on failure.
@@ -32,7 +32,7 @@
 typedef struct EpochLeakCandidate {
   uint32_t class_index;              /* Size class index */
   uint32_t object_size;              /* Object size in bytes */
-  EpochId epoch_id;                  /* Ring index (0-15) */
+  uint32_t epoch_id;                 /* Ring slot (< epoch_count) */
   uint64_t epoch_era;                /* Monotonic generation */
   char label[32];                    /* Semantic label (if set) */
   
@@ -138,7 +138,7 @@ void slab_analyze_slow_path(SlabAllocator* alloc, SlowPathReport* out);
 /* Per-epoch reclamation effectiveness data */
 typedef struct EpochReclamation {
   uint32_t class_index;              /* Size class index */
-  EpochId epoch_id;                  /* Ring index */
+  uint32_t epoch_id;                 /* Ring slot */
   uint64_t epoch_era;                /* Monotonic generation */
   
   /* Reclamation metrics */
@@ -0,0 +1,157 @@
+#ifndef SLAB_GROUP_H
+#define SLAB_GROUP_H
+
+#include "slab_alloc.h"
+#include "slab_stats.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Sharded allocator groups for temporal-slab
+ *
+ * A thread-per-core server runs one event loop per core. A group gives each
+ * loop its own SlabAllocator (a shard) and ties the shards together:
+ *
+ * - Allocation stays shard-local. A loop allocates from
+ *   slab_group_shard(g, i) with the ordinary API (alloc_obj_epoch,
+ *   epoch_advance, epoch_close, ...), with no atomics shared with other cores.
+ * - Frees route by handle. Each shard writes its index into the top bits of
+ *   the handle's slab_id field, so any core can free any object with
+ *   slab_group_free() without looking up its owner. Cross-core frees then
+ *   take the shard's normal thread-safe free path (remote_free lists when
+ *   the shard config enables them).
+ * - Idle memory has one cap (the "depot"). depot_bytes bounds the resident
+ *   memory of cached (empty, reusable) slabs across the whole group, and
+ *   any shard's carve can run the check. When the group holds more, the
+ *   shards that took the fewest slabs since the last check give their
+ *   cached pages back first, so a busy shard keeps its warm cache while
+ *   idle ones do not strand memory.
+ * - Stats aggregate: slab_group_stats_global() sums SlabGlobalStats over
+ *   the shards, and slab_group_stats() reports the depot per shard.
+ *
+ * SHARED: only the handle space, the idle-memory cap and the merged stats.
+ * Each shard keeps its own label registry, empty-slab cache, reclaimer,
+ * epoch ring and memory budget. The depot is a cap, not a pool: slabs
+ * never change shard, because a slab's registry ID, arena and cache node
+ * belong to the shard that carved it and handles and header-free pointers
+ * resolve through them. A trimmed shard keeps its cached slabs with their
+ * pages returned, and a busy shard still carves its own. The check runs
+ * from any shard's slab carve path (the memory budget hook, at most once
+ * per 100ms for the whole group), from any shard's reclaimer idle tick,
+ * and from slab_group_rebalance().
+ *
+ * HANDLE SPACE: a group of N shards takes ceil(log2(N)) of the 25 slab_id
+ * bits, so each shard can hold 2^25 / 2^ceil(log2(N)) slabs (e.g. 4M slabs,
+ * 16GB of 4KB slabs, per shard of 8). A handle is only valid with the
+ * group (or shard) that minted it.
+ */
+
+#define SLAB_GROUP_MAX_SHARDS 64u
+
+/* Default depot: idle slab memory kept resident per shard */
+#define SLAB_GROUP_DEPOT_PER_SHARD (4ull << 20)
+
+typedef struct SlabGroup SlabGroup;
+
+/* Group configuration
+ *
+ * shards       - Shard count, 1..SLAB_GROUP_MAX_SHARDS (0 = online CPUs,
+ *                capped at SLAB_GROUP_MAX_SHARDS)
+ * shard_config - Applied to every shard (NULL = defaults). Each shard has
+ *                its own epoch ring, label registry and memory budget.
+ * depot_bytes  - Cached-slab memory the group keeps resident
+ *                (0 = SLAB_GROUP_DEPOT_PER_SHARD per shard, UINT64_MAX = no cap)
+ */
+typedef struct SlabGroupConfig {
+  uint32_t shards;
+  const SlabAllocatorConfig* shard_config;
+  uint64_t depot_bytes;
+} SlabGroupConfig;
+
+/* Create / destroy
+ *
+ * slab_group_create RETURNS the group, or NULL with errno:
+ *   EINVAL - shards > SLAB_GROUP_MAX_SHARDS, or an invalid shard_config
+ *   ENOMEM - Out of memory
+ *
+ * slab_group_destroy() destroys every shard (as slab_allocator_free). No
+ * shard may be in use.
+ */
+SlabGroup* slab_group_create(const SlabGroupConfig* config);
+void slab_group_destroy(SlabGroup* group);
+
+/* Shards
+ *
+ * slab_group_shard RETURNS shard `index`, or NULL if out of range. The
+ * pointer is stable for the group's lifetime. Do not pass it to
+ * slab_allocator_free().
+ */
+uint32_t slab_group_shards(const SlabGroup* group);
+SlabAllocator* slab_group_shard(SlabGroup* group, uint32_t index);
+
+/* Shard that minted a handle (no memory access). Returns UINT32_MAX for
+ * handles naming no shard of this group. Does not validate the rest. */
+uint32_t slab_group_shard_of(const SlabGroup* group, SlabHandle handle);
+
+/* Free from any thread, routed to the owning shard
+ *
+ * slab_group_free       - free_obj() on the handle's shard. RETURNS false
+ *                         for invalid, stale or misrouted handles.
+ * slab_group_free_batch - free_obj_batch() per run of same-shard handles.
+ *                         RETURNS the number freed.
+ * slab_group_slab_free  - slab_free() for slab_malloc_epoch() pointers. With
+ *                         header_free shards the owner is found by arena
+ *                         lookup (up to one per shard). NULL is a no-op.
+ */
+bool slab_group_free(SlabGroup* group, SlabHandle handle);
+uint32_t slab_group_free_batch(SlabGroup* group, const SlabHandle* handles, uint32_t count);
+void slab_group_slab_free(SlabGroup* group, void* ptr);
+
+/* Depot control
+ *
+ * slab_group_set_depot() sets depot_bytes (0 = default, as in the config)
+ * and checks the group at once. RETURNS false with EINVAL if group is NULL.
+ * slab_group_rebalance() runs a depot check now, regardless of the 100ms
+ * rate limit. RETURNS the cached slab bytes given back to the OS.
+ */
+bool slab_group_set_depot(SlabGroup* group, uint64_t bytes);
+uint64_t slab_group_rebalance(SlabGroup* group);
+
+/* ==================== Statistics ==================== */
+
+typedef struct SlabGroupShardStats {
+  uint64_t resident_estimate_bytes;    /* Shard's SlabGlobalStats.resident_estimate_bytes */
+  uint64_t idle_bytes;                 /* Cached slabs still holding pages */
+  uint64_t slab_demand;                /* Slabs taken from cache or carved, lifetime */
+  uint64_t depot_trimmed_bytes;        /* Cached bytes this shard gave back to the depot */
+} SlabGroupShardStats;
+
+typedef struct SlabGroupStats {
+  uint32_t shards;
+  uint32_t shard_bits;                 /* slab_id bits holding the shard index */
+  uint32_t shard_max_slabs;            /* Registry IDs per shard */
+  uint64_t depot_bytes;                /* Cap in effect */
+  uint64_t idle_bytes;                 /* Sum of shard idle_bytes */
+  uint64_t depot_checks;               /* Depot checks run */
+  uint64_t depot_passes;               /* Of those, found the group over the cap */
+  uint64_t depot_trimmed_bytes;        /* Sum of shard depot_trimmed_bytes */
+  uint64_t misrouted_frees;            /* Handles naming no shard (slab_group_free*) */
+  SlabGroupShardStats shard[SLAB_GROUP_MAX_SHARDS];  /* Entries [0, shards) valid */
+} SlabGroupStats;
+
+void slab_group_stats(SlabGroup* group, SlabGroupStats* out);
+
+/* slab_stats_global() summed over the shards
+ *
+ * Counters and byte totals are summed. Per-label arrays are merged by
+ * label name (shards number their labels independently; labels beyond the
+ * 16th distinct name are dropped). Fields that describe one allocator
+ * (current_epoch, epoch_count, reclaim_mode, os_page_size, hugepage_bytes,
+ * latency_sample_shift) come from shard 0, and rss_bytes_current is the
+ * process RSS, read once.
+ *
+ * COST: one slab_stats_global() per shard.
+ */
+void slab_group_stats_global(SlabGroup* group, SlabGlobalStats* out);
+
+#endif /* SLAB_GROUP_H */
@@ -2,6 +2,7 @@
 #define SLAB_STATS_H
 
 #include "slab_alloc.h"
+#include <stdatomic.h>
 #include <stdint.h>
 #include <time.h>
 
@@ -22,11 +23,11 @@
  * 
  * PERFORMANCE:
  * - Global stats: O(classes * epochs) = ~128 iterations + brief locks
- * - Class stats: O(epochs) = ~16 iterations + 2 brief locks  
+ * - Class stats: O(epochs) = epoch_count iterations (16 by default) + 2 brief locks  
  * - Epoch stats: O(partial_slabs) = scan to find reclaimable
  */
 
-#define SLAB_STATS_VERSION 2  /* Phase 2.3: Added per-label contention maps */
+#define SLAB_STATS_VERSION 19  /* Added page geometry (release_bytes, hugepage) */
 
 /* ==================== Slowpath Sampling (Phase 2.5) ==================== */
 
@@ -105,6 +106,67 @@ ThreadStats slab_stats_thread(void);
 
 #endif /* ENABLE_SLOWPATH_SAMPLING */
 
+/* ==================== Latency Histograms ==================== */
+
+/* Log-bucketed latency histograms (ENABLE_LATENCY_HIST builds)
+ *
+ * Answers: "What do alloc/free/new_slab/epoch_close latencies look like
+ * at p99/p999, in production, without a profiler attached?"
+ *
+ * BUCKETS (HdrHistogram-style, 2 significant bits):
+ * - Values 0-3ns get one bucket each
+ * - Every power of two above splits into 4 equal sub-buckets (<25% error)
+ * - 128 buckets reach 2^33ns (~8.6s); slower samples land in the last one
+ *
+ * Recording is lock-free: relaxed atomic adds into per-CPU stripes.
+ * slab_stats_global() merges the stripes into SlabGlobalStats.latency[].
+ * Alloc and free are timed 1 in 2^latency_sample_shift calls; new_slab()
+ * and epoch_close() are rare and timed every time.
+ */
+#define SLAB_LAT_BUCKETS 128u
+
+typedef enum SlabLatencyOp {
+  SLAB_LAT_ALLOC_FAST = 0,  /* alloc_obj_epoch() served without the slow path */
+  SLAB_LAT_ALLOC_SLOW,      /* alloc_obj_epoch() that entered the slow path */
+  SLAB_LAT_FREE,            /* free_obj() */
+  SLAB_LAT_NEW_SLAB,        /* new_slab(): cache pop or fresh carve */
+  SLAB_LAT_EPOCH_CLOSE,     /* epoch_close() work, sync or async */
+  SLAB_LAT_OPS
+} SlabLatencyOp;
+
+typedef struct SlabLatencyHist {
+  uint64_t count;                      /* Recorded samples */
+  uint64_t sum_ns;                     /* Sum of recorded latencies */
+  uint64_t buckets[SLAB_LAT_BUCKETS];  /* Sample count per bucket */
+} SlabLatencyHist;
+
+/* Bucket index for a latency in nanoseconds */
+static inline uint32_t slab_lat_bucket(uint64_t ns) {
+  if (ns < 4) return (uint32_t)ns;
+  uint32_t e = 63u - (uint32_t)__builtin_clzll(ns);   /* floor(log2(ns)) >= 2 */
+  uint32_t b = (e - 1u) * 4u + (uint32_t)((ns >> (e - 2u)) & 3u);
+  return b < SLAB_LAT_BUCKETS ? b : SLAB_LAT_BUCKETS - 1u;
+}
+
+/* Largest latency (ns) that maps to bucket b */
+static inline uint64_t slab_lat_bucket_max_ns(uint32_t b) {
+  if (b < 4) return b;
+  uint32_t e = b / 4u + 1u;
+  return ((4ull + (b & 3u) + 1ull) << (e - 2u)) - 1ull;
+}
+
+/* Latency at quantile q (0.0-1.0) of a histogram
+ *
+ * Returns the upper bound of the bucket holding the q-th sample, or 0 for
+ * an empty histogram.
+ *
+ * USAGE:
+ *   SlabGlobalStats gs;
+ *   slab_stats_global(alloc, &gs);
+ *   uint64_t p99 = slab_latency_percentile(&gs.latency[SLAB_LAT_ALLOC_FAST], 0.99);
+ */
+uint64_t slab_latency_percentile(const SlabLatencyHist* h, double q);
+
 /* ==================== Global Statistics ==================== */
 
 /* Aggregate statistics across all size classes and epochs
@@ -116,7 +178,9 @@ typedef struct SlabGlobalStats {
   uint32_t version;  /* = SLAB_STATS_VERSION */
   
   /* Epoch state */
-  uint32_t current_epoch;              /* Active epoch for new allocations */
+  uint32_t current_epoch;              /* Epoch sequence (low 32 bits) of the active epoch */
+  uint32_t epoch_count;                /* Ring slots (SlabAllocatorConfig.epoch_count) */
+  uint64_t epoch_stale_rejects;        /* Calls turned away for a stale era-qualified EpochId */
   uint32_t active_epoch_count;         /* Epochs in ACTIVE state */
   uint32_t closing_epoch_count;        /* Epochs in CLOSING state */
   
@@ -127,7 +191,7 @@ typedef struct SlabGlobalStats {
   
   /* RSS accounting */
   uint64_t rss_bytes_current;          /* Actual RSS from OS */
-  uint64_t estimated_slab_rss_bytes;   /* net_slabs * 4096 */
+  uint64_t estimated_slab_rss_bytes;   /* Sum of per-class net_slabs * slab_bytes */
   
   /* Performance totals */
   uint64_t total_slow_path_hits;       /* Sum across all classes */
@@ -141,6 +205,20 @@ typedef struct SlabGlobalStats {
   uint64_t total_madvise_calls;
   uint64_t total_madvise_bytes;
   uint64_t total_madvise_failures;
+  uint64_t total_madvise_batches;
+  uint64_t total_madvise_ranges;
+  uint32_t reclaim_mode;               /* SlabReclaimMode in effect */
+  
+  /* Remote-free lists (SlabAllocatorConfig.remote_free) */
+  uint64_t total_remote_frees;
+  uint64_t total_remote_drains;
+  uint64_t total_remote_drained_objects;
+  uint64_t total_bump_allocs;          /* Fresh-slab slots taken by bump (no bitmap CAS) */
+  
+  /* Slab registry (slab_id space, max 2^25 IDs in handle v2) */
+  uint32_t registry_ids_issued;        /* High-water mark: IDs ever bump-allocated */
+  uint32_t registry_ids_free;          /* Released IDs waiting for reuse */
+  uint64_t registry_ids_recycled;      /* IDs handed out again from the free list */
   
   /* Phase 2.2: Lock-free contention totals */
   uint64_t total_bitmap_alloc_cas_retries;       /* Sum across all classes */
@@ -149,6 +227,41 @@ typedef struct SlabGlobalStats {
   uint64_t total_bitmap_alloc_attempts;          /* Denominators */
   uint64_t total_bitmap_free_attempts;
   uint64_t total_current_partial_cas_attempts;
+  
+  /* Arena reservation totals */
+  uint64_t total_arena_count;          /* Sum of arena_count */
+  uint64_t total_arena_reserved_bytes; /* Virtual address space reserved */
+  uint64_t total_arena_committed_bytes;/* Bytes carved into slabs */
+  
+  /* Page geometry (fixed at init) */
+  uint32_t os_page_size;               /* sysconf(_SC_PAGESIZE) */
+  uint32_t hugepage_bytes;             /* THP size backing arenas (0 = hugepage_slabs off/ignored) */
+  
+  /* Soft memory budget (slab_set_memory_budget) */
+  uint64_t memory_budget_bytes;        /* 0 = none */
+  uint64_t resident_estimate_bytes;    /* Carved bytes minus page-returned cached slabs */
+  uint64_t budget_enforcements;        /* Trim/reclaim passes run while over budget */
+  
+  /* Per-label slab accounting (slab_label_set_quota), indexed by label ID
+   * like the *_by_label arrays; entries [0, label_count) valid */
+  uint32_t label_count;                /* Registered labels, incl. ID 0 (unlabeled) */
+  uint64_t label_committed_bytes[16];  /* Slab bytes held by the label's epochs */
+  uint64_t label_peak_bytes[16];       /* High-water mark of committed */
+  uint64_t label_quota_bytes[16];      /* 0 = unlimited */
+  uint64_t label_quota_denials[16];    /* Slab requests refused over quota */
+  
+  /* Background reclaimer (epoch_close_async) */
+  uint32_t reclaim_running;            /* 1 if the reclaimer thread is running */
+  uint32_t reclaim_pending;            /* Epochs queued or being reclaimed */
+  uint64_t reclaim_submitted;          /* Closes handed to the reclaimer */
+  uint64_t reclaim_completed;          /* Closes finished (incl. abandoned) */
+  uint64_t reclaim_abandoned;          /* Stopped early: epoch reopened */
+  uint64_t reclaim_budget_pauses;      /* Slices cut short by slice_budget_ns */
+  
+  /* Latency histograms, merged across CPUs (all zero unless ENABLE_LATENCY_HIST) */
+  uint32_t latency_enabled;            /* 1 if this build records latencies */
+  uint32_t latency_sample_shift;       /* Alloc/free timed 1 in 2^shift calls */
+  SlabLatencyHist latency[SLAB_LAT_OPS];  /* Indexed by SlabLatencyOp */
 } SlabGlobalStats;
 
 /* ==================== Per-Class Statistics ==================== */
@@ -161,7 +274,9 @@ typedef struct SlabClassStats {
   /* Version and identity */
   uint32_t version;                    /* = SLAB_STATS_VERSION */
   uint32_t class_index;                /* 0-7 */
-  uint32_t object_size;                /* 64, 96, 128, 192, 256, 384, 512, 768 */
+  uint32_t object_size;                /* 64, 96, 128, ... 768 (small), 1024 ... 16384 (large) */
+  uint32_t slab_bytes;                 /* Bytes per slab (4096 small, 16K-256K large) */
+  uint32_t release_bytes;              /* Page-return unit: max(slab_bytes, OS page, huge page) */
   
   /* Core perf counters (existing) */
   uint64_t slow_path_hits;
@@ -181,13 +296,29 @@ typedef struct SlabClassStats {
   uint64_t madvise_calls;              /* madvise(MADV_DONTNEED) invocations */
   uint64_t madvise_bytes;              /* Total bytes passed to madvise */
   uint64_t madvise_failures;           /* madvise returned error */
+  uint64_t madvise_batches;            /* Batched reclaims (BATCHED/LAZY modes) */
+  uint64_t madvise_ranges;             /* Coalesced ranges in those batches */
+  
+  /* Remote-free lists */
+  uint64_t remote_frees;               /* Frees deferred onto slab remote stacks */
+  uint64_t remote_drains;              /* Non-empty remote stacks absorbed */
+  uint64_t remote_drained_objects;     /* Objects returned by those drains */
+  
+  /* Fresh-slab bump allocation */
+  uint64_t bump_allocs;                /* Slots taken from a fresh slab's bump reserve */
+  uint64_t bump_retires;               /* Reserves handed back to the bitmap by a first free */
   
   /* Epoch-close telemetry (Phase 2.1) */
   uint64_t epoch_close_calls;          /* How many times epoch_close() called */
-  uint64_t epoch_close_scanned_slabs;  /* Total slabs scanned for reclaimable */
+  uint64_t epoch_close_scanned_slabs;  /* Parked empty slabs examined */
   uint64_t epoch_close_recycled_slabs; /* Slabs actually recycled */
   uint64_t epoch_close_total_ns;       /* Total time spent in epoch_close() */
   
+  /* Bulk epoch release (epoch_release_all) */
+  uint64_t epoch_release_calls;        /* epoch_release_all() passes over this class */
+  uint64_t epoch_release_slabs;        /* Slabs released without per-object frees */
+  uint64_t epoch_release_objects;      /* Live objects discarded by bulk release */
+  
   /* Phase 2.2: Lock-free contention metrics */
   uint64_t bitmap_alloc_cas_retries;     /* CAS spins in allocation */
   uint64_t bitmap_free_cas_retries;      /* CAS spins in free */
@@ -208,10 +339,15 @@ typedef struct SlabClassStats {
   uint32_t scan_mode;                        /* Current mode (0=sequential, 1=randomized) */
   
   /* Phase 3: Live vs committed diagnostics (fragmentation detection) */
-  uint64_t committed_bytes;                  /* Total bytes mmap'd for slabs */
+  uint64_t committed_bytes;                  /* Total bytes carved for slabs */
   uint64_t live_bytes;                       /* Bytes currently allocated to live objects */
   uint64_t empty_slabs_count;                /* Number of slabs currently empty */
   
+  /* Arena reservation (always-on) */
+  uint64_t arena_count;                      /* SLAB_ARENA_SIZE regions reserved */
+  uint64_t arena_reserved_bytes;             /* Virtual bytes reserved (MAP_NORESERVE) */
+  uint64_t arena_committed_bytes;            /* Bytes carved into slabs (never shrinks) */
+  
   /* Phase 2.2: Derived contention metrics */
   double avg_alloc_cas_retries_per_attempt;  /* retries / alloc_attempts */
   double avg_free_cas_retries_per_attempt;   /* retries / free_attempts */
@@ -233,19 +369,41 @@ typedef struct SlabClassStats {
   uint64_t bitmap_free_cas_retries_by_label[16];   /* Per-label free CAS retries */
 #endif
   
-  /* Cache state snapshot (requires cache_lock) */
-  uint32_t cache_size;                 /* Slabs currently in array cache */
-  uint32_t cache_capacity;             /* Max array cache size */
-  uint32_t cache_overflow_len;         /* Slabs in overflow list */
+  /* Cache state snapshot (lock-free stacks), summed over NUMA node pools */
+  uint32_t cache_size;                 /* Cached slabs within cache_capacity */
+  uint32_t cache_capacity;             /* Adaptive cache target (per node pool) */
+  uint32_t cache_overflow_len;         /* Cached slabs beyond cache_capacity */
+  uint64_t cache_cas_retries;          /* Failed cache push/pop CAS (recycle contention) */
+  uint32_t cache_clean_slabs;          /* Cached slabs whose pages were returned */
+  uint32_t cache_target_grows;         /* cache_capacity raises (demand spikes) */
+  uint32_t cache_target_shrinks;       /* cache_capacity cuts (sustained low demand) */
+  uint64_t cache_trims;                /* Trim passes that returned cached slab pages */
+  uint64_t cache_trimmed_slabs;        /* Cached slabs those passes returned */
+  uint64_t release_units;              /* Whole release units returned (release_bytes > slab_bytes) */
+  uint64_t hugepage_arenas;            /* Arenas advised MADV_HUGEPAGE */
+  
+  /* Warm-up (slab_reserve) */
+  uint64_t reserved_slabs;             /* Slabs pre-created into the cache */
+  uint32_t warm_floor;                 /* Per node pool: no madvise below this cache depth */
+  uint64_t warm_madvise_skips;         /* Recycled slabs left resident by the warm floor */
+  
+  /* NUMA node-local pools (entries [0, numa_nodes) valid) */
+  uint32_t numa_nodes;                                 /* Pools in use (1 on single-node hosts) */
+  uint32_t numa_cached_slabs[SLAB_MAX_NUMA_NODES];     /* Cached slabs per node */
+  uint64_t numa_slabs_carved[SLAB_MAX_NUMA_NODES];     /* Fresh slabs carved on node */
+  uint64_t numa_cache_pops_local[SLAB_MAX_NUMA_NODES]; /* Node's threads reused a node-local slab */
+  uint64_t numa_cache_pops_remote[SLAB_MAX_NUMA_NODES];/* Node's threads took another node's slab */
+  uint64_t numa_bind_failures;                         /* mbind() failures, all nodes */
   
   /* Slab distribution snapshot (requires sc->lock) */
   uint32_t total_partial_slabs;        /* Sum of partial.len across epochs */
   uint32_t total_full_slabs;           /* Sum of full.len across epochs */
+  uint32_t total_empty_slabs;          /* Sum of empty.len across epochs (what close recycles) */
   
   /* Derived metrics */
   double recycle_rate_pct;             /* 100 * recycled / (recycled + overflowed) */
   uint64_t net_slabs;                  /* new_slab_count - empty_slab_recycled */
-  uint64_t estimated_rss_bytes;        /* net_slabs * 4096 */
+  uint64_t estimated_rss_bytes;        /* net_slabs * slab_bytes */
 } SlabClassStats;
 
 /* ==================== Per-Epoch Statistics ==================== */
@@ -259,7 +417,7 @@ typedef struct SlabEpochStats {
   uint32_t version;                    /* = SLAB_STATS_VERSION */
   uint32_t class_index;                /* 0-7 */
   uint32_t object_size;                /* Size class */
-  EpochId epoch_id;                    /* Ring index (0-15) */
+  uint32_t epoch_id;                   /* Ring slot (< epoch_count) */
   uint64_t epoch_era;                  /* Monotonic generation (Phase 2.2) */
   EpochLifecycleState state;           /* ACTIVE or CLOSING */
   
@@ -275,13 +433,14 @@ typedef struct SlabEpochStats {
   /* Slab counts (requires sc->lock) */
   uint32_t partial_slab_count;
   uint32_t full_slab_count;
+  uint32_t empty_slab_count;           /* Parked empty slabs: epoch_close() work */
   
   /* Memory footprint */
-  uint64_t estimated_rss_bytes;        /* (partial + full) * 4096 */
+  uint64_t estimated_rss_bytes;        /* (partial + full + empty) * slab_bytes */
   
   /* Reclamation potential (requires scan) */
   uint32_t reclaimable_slab_count;     /* Slabs with free_count == object_count */
-  uint64_t reclaimable_bytes;          /* reclaimable_slab_count * 4096 */
+  uint64_t reclaimable_bytes;          /* reclaimable_slab_count * slab_bytes */
 } SlabEpochStats;
 
 /* ==================== Snapshot APIs ==================== */
@@ -324,7 +483,7 @@ void slab_stats_class(SlabAllocator* alloc, uint32_t size_class, SlabClassStats*
  * PARAMETERS:
  *   alloc      - Allocator instance
  *   size_class - Class index (0-7)
- *   epoch      - Epoch ID (0-15)
+ *   epoch      - Epoch ID (qualified or bare ring slot; stale IDs give zeroed stats)
  *   out        - Output buffer
  * 
  * COST: Brief lock on sc->lock + O(partial_slabs) scan (~50µs typical)
@@ -340,4 +499,137 @@ void slab_stats_class(SlabAllocator* alloc, uint32_t size_class, SlabClassStats*
  */
 void slab_stats_epoch(SlabAllocator* alloc, uint32_t size_class, EpochId epoch, SlabEpochStats* out);
 
+/* ==================== Shared-Memory Stats Segment ==================== */
+
+/* Publish stats into a memory-mapped file for out-of-process scrapers
+ *
+ * Answers: "How do I scrape a running process without calling into it?"
+ *
+ * The allocator copies its stats into a file (default /dev/shm/tslab.<pid>).
+ * An external reader (stats_dump --attach <pid>, a Prometheus sidecar) maps
+ * the file read-only and copies it out. The reader needs no syscalls after
+ * attach and takes no locks in the target process.
+ *
+ * LAYOUT (versioned by SLAB_SHM_VERSION and SLAB_STATS_VERSION):
+ *   SlabShmHeader                     at offset 0
+ *   SlabClassStats[num_classes]       at classes_offset
+ *   SlabShmEpoch[epoch_count]         at epochs_offset
+ *
+ * CONSISTENCY: the writer holds seq odd while it updates the segment (seqlock).
+ * slab_stats_shm_read() retries until it gets a copy taken while seq was
+ * even and unchanged. Class and global counters keep the usual
+ * per-field semantics. Class entries omit total_partial_slabs,
+ * total_full_slabs and total_empty_slabs (always 0), because counting
+ * them takes sc->lock.
+ *
+ * PUBLISHING: slab_stats_shm_start() maps the file. With interval_ms > 0 it
+ * also starts a publisher thread. Otherwise the application calls
+ * slab_stats_shm_publish() whenever it wants. One publish costs about the
+ * same as slab_stats_global() plus one slab_stats_class() per class.
+ */
+#define SLAB_SHM_MAGIC   0x314d4853424c5354ull  /* "TSLBSHM1" little-endian */
+#define SLAB_SHM_VERSION 1u
+
+/* Default segment path for a pid ("/dev/shm/tslab.<pid>"). It names the
+ * process, not the allocator: only one allocator per process can publish
+ * there. Give the others (e.g. the shards of a slab_group) their own
+ * SlabStatsShmConfig.path. */
+#define SLAB_SHM_PATH_FMT "/dev/shm/tslab.%u"
+
+/* One epoch ring slot */
+typedef struct SlabShmEpoch {
+  uint32_t slot;                       /* Ring index */
+  uint32_t state;                      /* EpochLifecycleState */
+  uint64_t era;                        /* Era of the epoch in this slot */
+  uint64_t open_since_ns;              /* CLOCK_MONOTONIC at epoch_advance() */
+  uint64_t domain_refcount;            /* Active epoch_domain_enter() calls */
+  uint64_t rss_before_close;           /* RSS before the last epoch_close() (0 if never) */
+  uint64_t rss_after_close;            /* RSS after it */
+  uint32_t label_id;                   /* 0 = unlabeled */
+  char label[32];                      /* NUL-terminated */
+} SlabShmEpoch;
+
+typedef struct SlabShmHeader {
+  uint64_t magic;                      /* = SLAB_SHM_MAGIC */
+  uint32_t shm_version;                /* = SLAB_SHM_VERSION */
+  uint32_t stats_version;              /* = SLAB_STATS_VERSION of the writer */
+  uint64_t segment_bytes;              /* Total mapped size */
+  uint32_t pid;                        /* Writer process */
+  uint32_t num_classes;
+  uint32_t epoch_count;
+  uint32_t class_stride;               /* sizeof(SlabClassStats) of the writer */
+  uint64_t classes_offset;
+  uint64_t epochs_offset;
+  
+  _Atomic uint64_t seq;                /* Seqlock: odd while an update is in progress */
+  uint64_t publish_count;              /* Completed publishes */
+  uint64_t publish_ns;                 /* CLOCK_MONOTONIC of the last publish */
+  SlabGlobalStats global;
+} SlabShmHeader;
+
+static inline const SlabClassStats* slab_shm_class(const SlabShmHeader* h, uint32_t cls) {
+  return (const SlabClassStats*)(const void*)((const char*)h + h->classes_offset +
+                                              (uint64_t)cls * h->class_stride);
+}
+
+static inline const SlabShmEpoch* slab_shm_epoch(const SlabShmHeader* h, uint32_t slot) {
+  return (const SlabShmEpoch*)(const void*)((const char*)h + h->epochs_offset) + slot;
+}
+
+typedef struct SlabStatsShmConfig {
+  const char* path;                    /* NULL: SLAB_SHM_PATH_FMT with getpid() */
+  uint32_t interval_ms;                /* Publisher thread period; 0 = no thread */
+} SlabStatsShmConfig;
+
+/* Start / stop publishing
+ *
+ * slab_stats_shm_start creates the file (mode 0600, O_EXCL), sizes and maps
+ * it, and publishes once. It RETURNS true, or false with errno:
+ *   EALREADY - Already publishing
+ *   EEXIST   - The file exists: another allocator of this process publishes
+ *              there (second allocator on the default path), or a crashed
+ *              process left it behind (remove it first)
+ *   other    - open/ftruncate/mmap/pthread_create failure
+ *
+ * slab_stats_shm_publish RETURNS false (EINVAL) if not started. Calls must
+ * not race with slab_stats_shm_stop(). Concurrent publishes are serialized.
+ *
+ * slab_stats_shm_stop joins the publisher thread, then unmaps and unlinks
+ * the file. No-op if not started. allocator_destroy() calls it.
+ */
+bool slab_stats_shm_start(SlabAllocator* alloc, const SlabStatsShmConfig* config);
+bool slab_stats_shm_publish(SlabAllocator* alloc);
+void slab_stats_shm_stop(SlabAllocator* alloc);
+
+/* Reader side (any process)
+ *
+ * USAGE:
+ *   char path[64];
+ *   snprintf(path, sizeof(path), SLAB_SHM_PATH_FMT, pid);
+ *   SlabShmReader r;
+ *   if (slab_stats_shm_attach(&r, path)) {
+ *     SlabShmHeader* snap = malloc(r.bytes);
+ *     if (slab_stats_shm_read(&r, snap, r.bytes)) {
+ *       printf("slow path hits: %lu\n", snap->global.total_slow_path_hits);
+ *     }
+ *     free(snap);
+ *     slab_stats_shm_detach(&r);
+ *   }
+ *
+ * slab_stats_shm_attach RETURNS false with errno on open/mmap failure, or
+ * EPROTO if the file is not a segment of this SLAB_SHM_VERSION and
+ * SLAB_STATS_VERSION.
+ * slab_stats_shm_read copies a consistent snapshot into buf. It RETURNS
+ * false with EAGAIN if the writer stayed busy through every retry, or
+ * EINVAL if len < r->bytes.
+ */
+typedef struct SlabShmReader {
+  const SlabShmHeader* seg;            /* Read-only mapping */
+  size_t bytes;                        /* Mapping size (buffer size for reads) */
+} SlabShmReader;
+
+bool slab_stats_shm_attach(SlabShmReader* r, const char* path);
+bool slab_stats_shm_read(const SlabShmReader* r, void* buf, size_t len);
+void slab_stats_shm_detach(SlabShmReader* r);
+
 #endif /* SLAB_STATS_H */
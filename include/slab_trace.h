@@ -0,0 +1,139 @@
+#ifndef SLAB_TRACE_H
+#define SLAB_TRACE_H
+
+#include "slab_alloc.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Allocation trace capture for temporal-slab
+ *
+ * Records every allocation, free and epoch transition of one allocator into
+ * a compact binary file. workloads/tslab_replay re-drives such a file against
+ * any allocator configuration (size classes, epoch count, TLS build, reclaim
+ * mode) and reports RSS over time and latency histograms. That gives a
+ * reproducible benchmark built from a real workload, without sharing the
+ * workload itself: records carry sizes, epochs and handles, never contents.
+ *
+ * CAPTURE:
+ * - Each thread appends to its own ring buffer (single producer, no locks,
+ *   no shared cache lines). A background thread drains the rings to the
+ *   file every flush_interval_ms.
+ * - A full ring drops the record and counts it (SlabTraceStats.dropped).
+ *   The allocating thread never waits for the disk.
+ * - Cost while tracing: one clock read plus a 24-byte store per operation.
+ *   While not tracing: one relaxed load per operation. Build with
+ *   -DENABLE_ALLOC_TRACE=0 to compile the hooks out entirely.
+ *
+ * FILE LAYOUT (SLAB_TRACE_VERSION):
+ *   SlabTraceHeader                   at offset 0 (totals final after stop)
+ *   SlabTraceRecord[]                 drained chunks, one thread per chunk
+ *
+ * Records of one thread appear in order, so each thread's timestamps are
+ * rebuilt from its deltas. Threads interleave in chunks. To order the whole
+ * trace, merge by rebuilt timestamp: an ALLOC is stamped after the object
+ * exists and a FREE before it is released, so a handle's free always sorts
+ * after its alloc, even across threads.
+ */
+
+#define SLAB_TRACE_MAGIC   0x31435254424c5354ull  /* "TSLBTRC1" little-endian */
+#define SLAB_TRACE_VERSION 1
+
+/* Record kinds */
+typedef enum SlabTraceOp {
+  SLAB_TRACE_ALLOC         = 1,  /* size, size_class, epoch, handle */
+  SLAB_TRACE_FREE          = 2,  /* handle */
+  SLAB_TRACE_EPOCH_ADVANCE = 3,  /* epoch: era of the epoch just opened */
+  SLAB_TRACE_EPOCH_CLOSE   = 4,  /* epoch (epoch_close, epoch_close_async) */
+  SLAB_TRACE_EPOCH_RELEASE = 5,  /* epoch (epoch_release_all) */
+  SLAB_TRACE_TIME          = 6,  /* handle: absolute CLOCK_MONOTONIC ns */
+} SlabTraceOp;
+
+/* One traced operation (24 bytes)
+ *
+ * delta_ns is the time since the same thread's previous record. Each
+ * thread's first record is a TIME record, and another one is inserted
+ * whenever the delta does not fit in 32 bits (about 4.3 seconds idle).
+ *
+ * epoch is the era of the epoch (low 32 bits of its sequence number), not
+ * its ring slot, so a replay with a different epoch_count can map it.
+ * handle is the SlabHandle the traced allocator returned; 0 if the caller
+ * asked for none (batch allocation without out_handles).
+ */
+typedef struct SlabTraceRecord {
+  uint32_t delta_ns;
+  uint16_t thread;      /* Trace-local thread number */
+  uint8_t op;           /* SlabTraceOp */
+  uint8_t size_class;   /* Class index in the traced allocator (ALLOC) */
+  uint32_t size;        /* Requested bytes (ALLOC) */
+  uint32_t epoch;
+  uint64_t handle;
+} SlabTraceRecord;
+
+_Static_assert(sizeof(SlabTraceRecord) == 24, "SlabTraceRecord must stay 24 bytes");
+
+/* Traced allocator */
+#define SLAB_TRACE_F_TLS_CACHE   (1u << 0)  /* Built with ENABLE_TLS_CACHE */
+#define SLAB_TRACE_F_REMOTE_FREE (1u << 1)  /* SlabAllocatorConfig.remote_free */
+#define SLAB_TRACE_F_HEADER_FREE (1u << 2)  /* SlabAllocatorConfig.header_free */
+
+typedef struct SlabTraceHeader {
+  uint64_t magic;                        /* SLAB_TRACE_MAGIC */
+  uint32_t version;                      /* SLAB_TRACE_VERSION */
+  uint32_t record_size;                  /* sizeof(SlabTraceRecord) */
+  uint64_t start_ns;                     /* CLOCK_MONOTONIC at slab_trace_start() */
+  uint64_t stop_ns;                      /* At slab_trace_stop() (0 = not stopped cleanly) */
+  uint64_t records;                      /* Records in the file (0 = not stopped cleanly) */
+  uint64_t dropped;                      /* Records lost to full rings */
+  uint32_t threads;                      /* Threads that recorded at least once */
+  uint32_t flags;                        /* SLAB_TRACE_F_* */
+  uint32_t epoch_count;                  /* Ring slots of the traced allocator */
+  uint32_t start_era;                    /* Era of the epoch current at start */
+  uint32_t num_classes;
+  uint32_t class_sizes[SLAB_MAX_CLASSES];
+} SlabTraceHeader;
+
+/* Capture configuration
+ *
+ * path              - Output file, created or truncated (mode 0600)
+ * ring_records      - Per-thread ring capacity in records, rounded up to a
+ *                     power of two (0 = 8192, i.e. 192KB per thread)
+ * flush_interval_ms - How often the drainer empties the rings (0 = 20ms).
+ *                     A ring must hold one interval of its thread's
+ *                     operations, or records are dropped.
+ */
+typedef struct SlabTraceConfig {
+  const char* path;
+  uint32_t ring_records;
+  uint32_t flush_interval_ms;
+} SlabTraceConfig;
+
+/* Start / stop capture
+ *
+ * slab_trace_start RETURNS: true, or false with errno:
+ *   EINVAL    - alloc or config->path is NULL
+ *   EALREADY  - Already tracing this allocator
+ *   ENOTSUP   - Built with ENABLE_ALLOC_TRACE=0
+ *   other     - open() or pthread_create() failure
+ *
+ * slab_trace_stop() waits for threads in the middle of a record, drains
+ * every ring, writes the final header totals and closes the file. No-op if
+ * not tracing. allocator_destroy() calls it. Ring memory stays with the
+ * allocator (a thread keeps its ring across sessions) and is freed by
+ * allocator_destroy().
+ */
+bool slab_trace_start(SlabAllocator* alloc, const SlabTraceConfig* config);
+void slab_trace_stop(SlabAllocator* alloc);
+
+/* Capture counters of the current (or last) session */
+typedef struct SlabTraceStats {
+  bool active;
+  uint64_t records;   /* Written to the file so far */
+  uint64_t dropped;   /* Lost to full rings */
+  uint32_t threads;   /* Rings attached (ever, this allocator) */
+  int error;          /* errno of the first failed write (rest of session discarded) */
+} SlabTraceStats;
+
+void slab_trace_stats(SlabAllocator* alloc, SlabTraceStats* out);
+
+#endif /* SLAB_TRACE_H */
@@ -0,0 +1,283 @@
+#define _GNU_SOURCE
+#include "bench_perf.h"
+#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+/* ------------------------------ Event table ------------------------------ */
+
+typedef struct {
+  const char* name;
+  uint32_t type;
+  uint64_t config;
+  bool needs_kernel;  /* Only observable with exclude_kernel=0 */
+} BenchPerfEventDesc;
+
+#ifdef __linux__
+#define HW_CACHE_MISS(id) \
+  ((uint64_t)(id) | ((uint64_t)PERF_COUNT_HW_CACHE_OP_READ << 8) | \
+   ((uint64_t)PERF_COUNT_HW_CACHE_RESULT_MISS << 16))
+
+static const BenchPerfEventDesc k_events[BENCH_PERF_NUM_EVENTS] = {
+  [BENCH_PERF_CYCLES]           = {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, false},
+  [BENCH_PERF_INSTRUCTIONS]     = {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, false},
+  [BENCH_PERF_L1D_MISSES]       = {"l1d_misses", PERF_TYPE_HW_CACHE, HW_CACHE_MISS(PERF_COUNT_HW_CACHE_L1D), false},
+  [BENCH_PERF_LLC_MISSES]       = {"llc_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, false},
+  [BENCH_PERF_DTLB_MISSES]      = {"dtlb_misses", PERF_TYPE_HW_CACHE, HW_CACHE_MISS(PERF_COUNT_HW_CACHE_DTLB), false},
+  [BENCH_PERF_PAGE_FAULTS]      = {"page_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS, false},
+  /* Switches are accounted in kernel context, so exclude_kernel hides them */
+  [BENCH_PERF_CONTEXT_SWITCHES] = {"context_switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, true},
+};
+#else
+static const BenchPerfEventDesc k_events[BENCH_PERF_NUM_EVENTS] = {
+  [BENCH_PERF_CYCLES]           = {"cycles", 0, 0, false},
+  [BENCH_PERF_INSTRUCTIONS]     = {"instructions", 0, 0, false},
+  [BENCH_PERF_L1D_MISSES]       = {"l1d_misses", 0, 0, false},
+  [BENCH_PERF_LLC_MISSES]       = {"llc_misses", 0, 0, false},
+  [BENCH_PERF_DTLB_MISSES]      = {"dtlb_misses", 0, 0, false},
+  [BENCH_PERF_PAGE_FAULTS]      = {"page_faults", 0, 0, false},
+  [BENCH_PERF_CONTEXT_SWITCHES] = {"context_switches", 0, 0, false},
+};
+#endif
+
+const char* bench_perf_event_name(BenchPerfEvent ev) {
+  return (ev < BENCH_PERF_NUM_EVENTS) ? k_events[ev].name : "unknown";
+}
+
+/* ------------------------------ Status ------------------------------ */
+
+/* First failure wins; later threads hitting the same wall don't overwrite it */
+static pthread_mutex_t g_status_lock = PTHREAD_MUTEX_INITIALIZER;
+static char g_status[128] = "ok";
+static bool g_status_set = false;
+
+static void set_status(const char* prefix, const char* reason) {
+  pthread_mutex_lock(&g_status_lock);
+  if (!g_status_set) {
+    snprintf(g_status, sizeof(g_status), "%s%s", prefix, reason);
+    g_status_set = true;
+  }
+  pthread_mutex_unlock(&g_status_lock);
+}
+
+const char* bench_perf_status(void) {
+  return g_status;
+}
+
+static bool perf_disabled_by_env(void) {
+  const char* env = getenv("TSLAB_BENCH_PERF");
+  return env && strcmp(env, "0") == 0;
+}
+
+static uint64_t mono_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* ------------------------------ Counters ------------------------------ */
+
+#ifdef __linux__
+static int open_event(const BenchPerfEventDesc* d) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = d->type;
+  attr.config = d->config;
+  attr.disabled = 1;
+  attr.exclude_kernel = d->needs_kernel ? 0 : 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  /* pid=0, cpu=-1: this thread on whatever CPU it runs */
+  return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC);
+}
+#endif
+
+bool bench_perf_open(BenchPerf* p) {
+  memset(p, 0, sizeof(*p));
+  for (int i = 0; i < BENCH_PERF_NUM_EVENTS; i++) p->fd[i] = -1;
+  p->threads = 1;
+
+  if (perf_disabled_by_env()) {
+    set_status("disabled", "");
+    return false;
+  }
+
+#ifdef __linux__
+  bool any = false;
+  int first_errno = 0;
+  const char* first_failed = NULL;
+  for (int i = 0; i < BENCH_PERF_NUM_EVENTS; i++) {
+    int fd = open_event(&k_events[i]);
+    if (fd < 0) {
+      if (!first_failed) {
+        first_errno = errno;
+        first_failed = k_events[i].name;
+      }
+      continue;
+    }
+    p->fd[i] = fd;
+    p->valid[i] = true;
+    any = true;
+  }
+  if (first_failed) {
+    char reason[96];
+    snprintf(reason, sizeof(reason), "%s: %s", first_failed, strerror(first_errno));
+    set_status(any ? "partial: " : "unavailable: ", reason);
+  }
+  return any;
+#else
+  set_status("unavailable: ", "perf_event_open requires Linux");
+  return false;
+#endif
+}
+
+void bench_perf_start(BenchPerf* p) {
+#ifdef __linux__
+  for (int i = 0; i < BENCH_PERF_NUM_EVENTS; i++) {
+    if (p->fd[i] < 0) continue;
+    ioctl(p->fd[i], PERF_EVENT_IOC_RESET, 0);
+    ioctl(p->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+  }
+#endif
+  p->start_ns = mono_ns();
+}
+
+void bench_perf_stop(BenchPerf* p) {
+  p->wall_ns = mono_ns() - p->start_ns;
+#ifdef __linux__
+  for (int i = 0; i < BENCH_PERF_NUM_EVENTS; i++) {
+    if (p->fd[i] < 0) continue;
+    ioctl(p->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+  }
+  for (int i = 0; i < BENCH_PERF_NUM_EVENTS; i++) {
+    if (p->fd[i] < 0) continue;
+    uint64_t v[3];  /* value, time_enabled, time_running */
+    if (read(p->fd[i], v, sizeof(v)) != (ssize_t)sizeof(v) || v[2] == 0) {
+      /* Never scheduled on the PMU (e.g. all slots taken) */
+      p->valid[i] = false;
+      p->count[i] = 0;
+      continue;
+    }
+    p->count[i] = (v[2] < v[1]) ? (uint64_t)((double)v[0] * ((double)v[1] / (double)v[2]))
+                                : v[0];
+  }
+#endif
+}
+
+void bench_perf_close(BenchPerf* p) {
+  for (int i = 0; i < BENCH_PERF_NUM_EVENTS; i++) {
+    if (p->fd[i] >= 0) {
+      close(p->fd[i]);
+      p->fd[i] = -1;
+    }
+  }
+}
+
+void bench_perf_merge(BenchPerf* dst, const BenchPerf* src) {
+  if (src->threads == 0) return;
+  if (dst->threads == 0) {
+    *dst = *src;
+    for (int i = 0; i < BENCH_PERF_NUM_EVENTS; i++) dst->fd[i] = -1;
+    return;
+  }
+  for (int i = 0; i < BENCH_PERF_NUM_EVENTS; i++) {
+    dst->valid[i] = dst->valid[i] && src->valid[i];
+    dst->count[i] += src->count[i];
+  }
+  if (src->wall_ns > dst->wall_ns) dst->wall_ns = src->wall_ns;
+  dst->threads += src->threads;
+}
+
+/* ------------------------------ Reporting ------------------------------ */
+
+void bench_perf_print(const BenchPerf* p, uint64_t ops) {
+  if (!p || ops == 0) return;
+
+  bool any = false;
+  for (int i = 0; i < BENCH_PERF_NUM_EVENTS; i++) any = any || p->valid[i];
+  if (!any) return;
+
+  printf("HW counters (per op):");
+  for (int i = 0; i < BENCH_PERF_NUM_EVENTS; i++) {
+    if (!p->valid[i]) continue;
+    printf(" %s=%.4g", k_events[i].name, (double)p->count[i] / (double)ops);
+  }
+  if (p->valid[BENCH_PERF_CYCLES] && p->valid[BENCH_PERF_INSTRUCTIONS] &&
+      p->count[BENCH_PERF_CYCLES] > 0) {
+    printf(" ipc=%.2f", (double)p->count[BENCH_PERF_INSTRUCTIONS] /
+                        (double)p->count[BENCH_PERF_CYCLES]);
+  }
+  printf("\n");
+}
+
+static void json_u64_or_null(FILE* f, const char* key, uint64_t v, bool present) {
+  if (present) {
+    fprintf(f, "\"%s\":%" PRIu64, key, v);
+  } else {
+    fprintf(f, "\"%s\":null", key);
+  }
+}
+
+void bench_json_phase(FILE* f, const BenchPhase* ph, const BenchPerf* perf) {
+  if (!f || !ph) return;
+
+  uint64_t wall_ns = ph->wall_ns ? ph->wall_ns : (perf ? perf->wall_ns : 0);
+
+  fprintf(f, "{\"schema\":\"%s\",\"bench\":\"%s\",\"phase\":\"%s\",\"allocator\":\"%s\"",
+          BENCH_SCHEMA, ph->bench, ph->phase,
+          ph->allocator ? ph->allocator : "temporal-slab");
+  fprintf(f, ",\"threads\":%u,\"ops\":%" PRIu64 ",\"wall_ns\":%" PRIu64,
+          ph->threads, ph->ops, wall_ns);
+
+  fprintf(f, ",\"latency_ns\":{");
+  if (ph->avg_ns > 0.0) {
+    fprintf(f, "\"avg\":%.1f,", ph->avg_ns);
+  } else {
+    fprintf(f, "\"avg\":null,");
+  }
+  json_u64_or_null(f, "p50", ph->p50_ns, ph->p50_ns != 0);
+  fputc(',', f);
+  json_u64_or_null(f, "p99", ph->p99_ns, ph->p99_ns != 0);
+  fputc(',', f);
+  json_u64_or_null(f, "p999", ph->p999_ns, ph->p999_ns != 0);
+  fputc('}', f);
+
+  fprintf(f, ",\"perf\":\"%s\",\"counters\":{", bench_perf_status());
+  for (int i = 0; i < BENCH_PERF_NUM_EVENTS; i++) {
+    if (i) fputc(',', f);
+    bool ok = perf && perf->valid[i];
+    json_u64_or_null(f, k_events[i].name, ok ? perf->count[i] : 0, ok);
+  }
+  fputc('}', f);
+
+  fprintf(f, ",\"per_op\":{");
+  for (int i = 0; i < BENCH_PERF_NUM_EVENTS; i++) {
+    if (i) fputc(',', f);
+    if (perf && perf->valid[i] && ph->ops > 0) {
+      fprintf(f, "\"%s\":%.6g", k_events[i].name, (double)perf->count[i] / (double)ph->ops);
+    } else {
+      fprintf(f, "\"%s\":null", k_events[i].name);
+    }
+  }
+  if (perf && perf->valid[BENCH_PERF_CYCLES] && perf->valid[BENCH_PERF_INSTRUCTIONS] &&
+      perf->count[BENCH_PERF_CYCLES] > 0) {
+    fprintf(f, ",\"ipc\":%.3f", (double)perf->count[BENCH_PERF_INSTRUCTIONS] /
+                               (double)perf->count[BENCH_PERF_CYCLES]);
+  } else {
+    fprintf(f, ",\"ipc\":null");
+  }
+  fprintf(f, "}}\n");
+  fflush(f);
+}
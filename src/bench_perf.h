@@ -0,0 +1,101 @@
+/*
+ * bench_perf.h - Hardware counters and JSON results for benchmark harnesses
+ *
+ * Shared by benchmark_accurate, benchmark_threads, workloads/synthetic_bench
+ * and workloads/locality_bench so that every harness explains *why* a phase
+ * got slower, not just that it did.
+ *
+ * Counters are opened per thread with perf_event_open(2) (user space only,
+ * so they work at perf_event_paranoid <= 2). Multi-threaded harnesses open a
+ * BenchPerf in each worker around its timed loop and fold the results with
+ * bench_perf_merge(). Counters the kernel refuses (no PMU in a VM, paranoid
+ * too strict, non-Linux build) are reported as unavailable rather than
+ * failing the benchmark. Set TSLAB_BENCH_PERF=0 to skip them entirely.
+ *
+ * Results are written as JSON Lines, one object per phase, in the
+ * "tslab-bench-v1" schema consumed by tools/plot_bench.py:
+ *
+ *   {"schema":"tslab-bench-v1","bench":"benchmark_accurate","phase":"alloc",
+ *    "allocator":"temporal-slab","threads":1,"ops":1000000,"wall_ns":...,
+ *    "latency_ns":{"avg":..,"p50":..,"p99":..,"p999":..},
+ *    "perf":"ok","counters":{"cycles":..,"instructions":..,"l1d_misses":..,
+ *    "llc_misses":..,"dtlb_misses":..,"page_faults":..,"context_switches":..},
+ *    "per_op":{"cycles":..,...,"ipc":..}}
+ *
+ * Latency fields a harness does not measure and unavailable counters are null.
+ */
+
+#ifndef BENCH_PERF_H
+#define BENCH_PERF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#define BENCH_SCHEMA "tslab-bench-v1"
+
+typedef enum BenchPerfEvent {
+  BENCH_PERF_CYCLES = 0,
+  BENCH_PERF_INSTRUCTIONS,
+  BENCH_PERF_L1D_MISSES,
+  BENCH_PERF_LLC_MISSES,
+  BENCH_PERF_DTLB_MISSES,
+  BENCH_PERF_PAGE_FAULTS,
+  BENCH_PERF_CONTEXT_SWITCHES,
+  BENCH_PERF_NUM_EVENTS
+} BenchPerfEvent;
+
+/* Counter set for one thread (or the merge of several).
+ * count[] is already scaled for multiplexing. */
+typedef struct BenchPerf {
+  int fd[BENCH_PERF_NUM_EVENTS];
+  bool valid[BENCH_PERF_NUM_EVENTS];
+  uint64_t count[BENCH_PERF_NUM_EVENTS];
+  uint64_t start_ns;
+  uint64_t wall_ns;     /* start->stop; max over threads after merge */
+  uint32_t threads;     /* Number of BenchPerf folded in (0 = empty) */
+} BenchPerf;
+
+/* One measured phase of a harness */
+typedef struct BenchPhase {
+  const char* bench;      /* Harness name, e.g. "benchmark_threads" */
+  const char* phase;      /* "alloc", "free", "mixed", pattern name, ... */
+  const char* allocator;  /* NULL = "temporal-slab" */
+  uint32_t threads;
+  uint64_t ops;
+  uint64_t wall_ns;       /* 0 = take perf->wall_ns */
+  double avg_ns;          /* <= 0 = not measured */
+  uint64_t p50_ns;        /* 0 = not measured */
+  uint64_t p99_ns;
+  uint64_t p999_ns;
+} BenchPhase;
+
+/* Short name used as JSON key ("cycles", "l1d_misses", ...) */
+const char* bench_perf_event_name(BenchPerfEvent ev);
+
+/* Open disabled counters for the calling thread. Never fails: counters the
+ * kernel rejects are left invalid. Returns true if at least one opened. */
+bool bench_perf_open(BenchPerf* p);
+
+/* Reset and enable / disable and read. Wall time is tracked even when no
+ * counter could be opened. */
+void bench_perf_start(BenchPerf* p);
+void bench_perf_stop(BenchPerf* p);
+
+void bench_perf_close(BenchPerf* p);
+
+/* Fold src into dst (dst zero-initialised for the first call). A counter
+ * stays valid only if it was valid in every merged thread. */
+void bench_perf_merge(BenchPerf* dst, const BenchPerf* src);
+
+/* "ok", "disabled", or "partial: <event>: <reason>" / "unavailable: ..."
+ * describing the first open that failed */
+const char* bench_perf_status(void);
+
+/* One-line human summary of per-op counters (no-op if none are valid) */
+void bench_perf_print(const BenchPerf* p, uint64_t ops);
+
+/* Append one tslab-bench-v1 JSON line; perf may be NULL */
+void bench_json_phase(FILE* f, const BenchPhase* ph, const BenchPerf* perf);
+
+#endif /* BENCH_PERF_H */
@@ -7,6 +7,7 @@
   3. Uses compiler barriers to prevent optimization
   4. Reports p50/p99/p999 latencies (not just average)
   5. Separates allocator RSS from test infrastructure
+  6. Hardware counters per phase (--json, see bench_perf.h)
 */
 
 #define _GNU_SOURCE
@@ -25,6 +26,7 @@
 #include <unistd.h>
 
 #include "slab_alloc_internal.h"
+#include "bench_perf.h"
 
 /* ------------------------------ Utilities ------------------------------ */
 
@@ -78,6 +80,26 @@ static void csv_write_fragmentation(uint32_t requested, uint32_t rounded, uint32
           rounded, requested, rounded, wasted, efficiency);
 }
 
+/* ------------------------------ JSON Export ------------------------------ */
+
+static FILE* g_json_file = NULL;
+
+static void json_write_phase(const char* phase, uint64_t ops, double avg,
+                             uint64_t p50, uint64_t p99, uint64_t p999,
+                             const BenchPerf* perf) {
+  BenchPhase ph = {
+    .bench = "benchmark_accurate",
+    .phase = phase,
+    .threads = 1,
+    .ops = ops,
+    .avg_ns = avg,
+    .p50_ns = p50,
+    .p99_ns = p99,
+    .p999_ns = p999,
+  };
+  bench_json_phase(g_json_file, &ph, perf);
+}
+
 /* ------------------------------ Accurate RSS Benchmark ------------------------------ */
 
 static void benchmark_rss_accurate(void) {
@@ -114,6 +136,9 @@ static void benchmark_rss_accurate(void) {
 
   /* Allocate objects */
   printf("\nAllocating %d objects of 128 bytes...\n", N);
+  BenchPerf fill_perf;
+  bench_perf_open(&fill_perf);
+  bench_perf_start(&fill_perf);
   for (int i = 0; i < N; i++) {
     void* p = alloc_obj_epoch(&a, 128, 0, &hs[i]);
     if (!p) {
@@ -124,6 +149,11 @@ static void benchmark_rss_accurate(void) {
     ((uint8_t*)p)[0] = 1;
     barrier();
   }
+  bench_perf_stop(&fill_perf);
+  bench_perf_close(&fill_perf);
+  bench_perf_print(&fill_perf, (uint64_t)N);
+  json_write_phase("rss_fill", (uint64_t)N,
+                   (double)fill_perf.wall_ns / (double)N, 0, 0, 0, &fill_perf);
 
   uint64_t rss_with_objects = read_rss_bytes_linux();
   printf("RSS with objects allocated:        %.2f MiB (+%.2f MiB)\n",
@@ -204,6 +234,10 @@ static void benchmark_latency_accurate(void) {
 
   /* Measure allocation latencies */
   printf("Measuring allocation latency (1M iterations)...\n");
+  BenchPerf alloc_perf, free_perf;
+  bench_perf_open(&alloc_perf);
+  bench_perf_open(&free_perf);
+  bench_perf_start(&alloc_perf);
   for (int i = 0; i < N; i++) {
     uint64_t t0 = now_ns();
     void* p = alloc_obj_epoch(&a, 128, 0, &hs[i]);
@@ -219,9 +253,11 @@ static void benchmark_latency_accurate(void) {
     
     alloc_times[i] = t1 - t0;
   }
+  bench_perf_stop(&alloc_perf);
 
   /* Measure free latencies */
   printf("Measuring free latency (1M iterations)...\n");
+  bench_perf_start(&free_perf);
   for (int i = 0; i < N; i++) {
     uint64_t t0 = now_ns();
     bool ok = free_obj(&a, hs[i]);
@@ -236,6 +272,9 @@ static void benchmark_latency_accurate(void) {
     
     free_times[i] = t1 - t0;
   }
+  bench_perf_stop(&free_perf);
+  bench_perf_close(&alloc_perf);
+  bench_perf_close(&free_perf);
 
   /* Sort once for percentile calculations */
   qsort(alloc_times, N, sizeof(uint64_t), compare_uint64);
@@ -264,18 +303,22 @@ static void benchmark_latency_accurate(void) {
   printf("p50:     %" PRIu64 " ns\n", alloc_p50);
   printf("p99:     %" PRIu64 " ns\n", alloc_p99);
   printf("p999:    %" PRIu64 " ns\n", alloc_p999);
+  bench_perf_print(&alloc_perf, (uint64_t)N);
 
   printf("\n--- Free Latency ---\n");
   printf("Average: %.1f ns\n", free_avg);
   printf("p50:     %" PRIu64 " ns\n", free_p50);
   printf("p99:     %" PRIu64 " ns\n", free_p99);
   printf("p999:    %" PRIu64 " ns\n", free_p999);
+  bench_perf_print(&free_perf, (uint64_t)N);
   
   /* Export to CSV if enabled */
   uint64_t alloc_p95 = percentile(alloc_times, N, 0.95);
   uint64_t free_p95 = percentile(free_times, N, 0.95);
   csv_write_latency("alloc", alloc_avg, alloc_p50, alloc_p95, alloc_p99, alloc_p999);
   csv_write_latency("free", free_avg, free_p50, free_p95, free_p99, free_p999);
+  json_write_phase("alloc", (uint64_t)N, alloc_avg, alloc_p50, alloc_p99, alloc_p999, &alloc_perf);
+  json_write_phase("free", (uint64_t)N, free_avg, free_p50, free_p99, free_p999, &free_perf);
 
   /* Get performance counters for 128B size class (index 1) */
   PerfCounters counters;
@@ -390,10 +433,23 @@ static void benchmark_fragmentation(void) {
 int main(int argc, char** argv) {
   /* Parse arguments */
   const char* csv_path = NULL;
+  const char* json_path = NULL;
   for (int i = 1; i < argc; i++) {
     if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
       csv_path = argv[i + 1];
       i++;
+    } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+      json_path = argv[i + 1];
+      i++;
+    }
+  }
+
+  /* JSON Lines output (tslab-bench-v1 schema, one line per phase) */
+  if (json_path) {
+    g_json_file = fopen(json_path, "w");
+    if (!g_json_file) {
+      fprintf(stderr, "Failed to open JSON file: %s\n", json_path);
+      return 1;
     }
   }
   
@@ -430,6 +486,10 @@ int main(int argc, char** argv) {
     fclose(g_csv_file);
     printf("\nCSV written to: %s\n", csv_path);
   }
+  if (g_json_file) {
+    fclose(g_json_file);
+    printf("JSON written to: %s (HW counters: %s)\n", json_path, bench_perf_status());
+  }
   
   printf("\n=== All Benchmarks Complete ===\n");
   return 0;
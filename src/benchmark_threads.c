@@ -8,7 +8,7 @@
  * Measures:
  * - Per-thread p50/p95/p99 latency
  * - Aggregate throughput (ops/sec)
- * - Cache coherence effects
+ * - Cache coherence effects (HW counters per thread, see bench_perf.h)
  */
 
 #define _GNU_SOURCE
@@ -28,6 +28,7 @@
 
 #include "slab_alloc_internal.h"
 #include "slab_stats.h"
+#include "bench_perf.h"
 
 /* Test parameters */
 #define OBJECT_SIZE 128
@@ -42,6 +43,7 @@ typedef struct {
   uint64_t p95;
   uint64_t p99;
   double avg;
+  BenchPerf perf;  /* Counters around the timed allocation loop */
 } ThreadResult;
 
 /* Forward declaration */
@@ -98,12 +100,15 @@ static void* worker_thread(void* arg) {
     return NULL;
   }
   
+  bench_perf_open(&result->perf);
+  
   /* Wait for start signal */
   while (atomic_load(&state->start_flag) == 0) {
     sched_yield();
   }
   
   /* Benchmark allocation */
+  bench_perf_start(&result->perf);
   for (int i = 0; i < OPS_PER_THREAD; i++) {
     uint64_t t0 = now_ns();
     void* p = alloc_obj_epoch(state->alloc, OBJECT_SIZE, 0, &handles[i]);
@@ -117,6 +122,8 @@ static void* worker_thread(void* arg) {
     ((uint8_t*)p)[0] = 1;  /* Touch memory */
     result->latencies[i] = t1 - t0;
   }
+  bench_perf_stop(&result->perf);
+  bench_perf_close(&result->perf);
   
   /* Free all */
   for (int i = 0; i < OPS_PER_THREAD; i++) {
@@ -139,7 +146,7 @@ static void* worker_thread(void* arg) {
   return NULL;
 }
 
-static void run_scaling_test(int num_threads, FILE* csv_file) {
+static void run_scaling_test(int num_threads, FILE* csv_file, FILE* json_file) {
   printf("\n=== Testing with %d thread(s) ===\n", num_threads);
   
   BenchState state;
@@ -180,10 +187,13 @@ static void run_scaling_test(int num_threads, FILE* csv_file) {
   /* Aggregate results */
   uint64_t total_ops = 0;
   double avg_p50 = 0, avg_p95 = 0, avg_p99 = 0, avg_avg = 0;
+  BenchPerf perf;
+  memset(&perf, 0, sizeof(perf));
   
   for (int i = 0; i < num_threads; i++) {
     ThreadResult* r = &state.results[i];
     if (r->count > 0) {
+      bench_perf_merge(&perf, &r->perf);
       total_ops += r->count;
       avg_p50 += r->p50;
       avg_p95 += r->p95;
@@ -210,6 +220,7 @@ static void run_scaling_test(int num_threads, FILE* csv_file) {
   printf("  Avg p50:      %.0f ns\n", avg_p50);
   printf("  Avg p95:      %.0f ns\n", avg_p95);
   printf("  Avg p99:      %.0f ns\n", avg_p99);
+  bench_perf_print(&perf, total_ops);
   
   /* Write CSV */
   if (csv_file) {
@@ -217,6 +228,19 @@ static void run_scaling_test(int num_threads, FILE* csv_file) {
             num_threads, throughput, avg_avg, avg_p50, avg_p95, avg_p99);
   }
   
+  /* JSON: latencies are per-thread averages, counters are summed */
+  BenchPhase ph = {
+    .bench = "benchmark_threads",
+    .phase = "alloc",
+    .threads = (uint32_t)num_threads,
+    .ops = total_ops,
+    .wall_ns = end_time - start_time,
+    .avg_ns = avg_avg,
+    .p50_ns = (uint64_t)avg_p50,
+    .p99_ns = (uint64_t)avg_p99,
+  };
+  bench_json_phase(json_file, &ph, &perf);
+  
   /* Phase 2.2: Dump contention metrics for 128B class */
   SlabClassStats cs;
   slab_stats_class(state.alloc, 2, &cs);  /* class 2 = 128B */
@@ -244,12 +268,16 @@ static void run_scaling_test(int num_threads, FILE* csv_file) {
 int main(int argc, char** argv) {
   /* Parse arguments */
   const char* csv_path = NULL;
+  const char* json_path = NULL;
   int single_thread_count = 0;
   
   for (int i = 1; i < argc; i++) {
     if (strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
       csv_path = argv[i + 1];
       i++;
+    } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+      json_path = argv[i + 1];
+      i++;
     } else if (argv[i][0] != '-') {
       single_thread_count = atoi(argv[i]);
     }
@@ -265,6 +293,15 @@ int main(int argc, char** argv) {
     fprintf(csv_file, "allocator,threads,throughput_ops_sec,avg_ns,p50_ns,p95_ns,p99_ns\n");
   }
   
+  FILE* json_file = NULL;
+  if (json_path) {
+    json_file = fopen(json_path, "w");
+    if (!json_file) {
+      fprintf(stderr, "Failed to open JSON file: %s\n", json_path);
+      return 1;
+    }
+  }
+  
   printf("temporal-slab Multi-threaded Scaling Benchmark\n");
   printf("==============================================\n");
   printf("Object size: %d bytes\n", OBJECT_SIZE);
@@ -272,11 +309,11 @@ int main(int argc, char** argv) {
   
   /* Test thread counts: either single specified count or full sweep */
   if (single_thread_count > 0) {
-    run_scaling_test(single_thread_count, csv_file);
+    run_scaling_test(single_thread_count, csv_file, json_file);
   } else {
     int thread_counts[] = {1, 2, 4, 8, 16};
     for (size_t i = 0; i < sizeof(thread_counts) / sizeof(thread_counts[0]); i++) {
-      run_scaling_test(thread_counts[i], csv_file);
+      run_scaling_test(thread_counts[i], csv_file, json_file);
     }
   }
   
@@ -284,6 +321,10 @@ int main(int argc, char** argv) {
     fclose(csv_file);
     printf("\nCSV written to: %s\n", csv_path);
   }
+  if (json_file) {
+    fclose(json_file);
+    printf("JSON written to: %s (HW counters: %s)\n", json_path, bench_perf_status());
+  }
   
   printf("\n=== Scaling Benchmark Complete ===\n");
   return 0;
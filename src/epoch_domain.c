@@ -31,6 +31,24 @@ static inline void tls_pop_expected(epoch_domain_t* expected) {
     tls_domain_depth--;
 }
 
+/* ------------------------------ TLS epoch binding (epoch_domain_alloc) ------------------------------ */
+
+/* One resolved epoch per thread, for the domain most recently entered or
+ * allocated from. Rebinding is a few dozen stores, so enter always
+ * refreshes it; the last exit and destroy drop it so a freed domain's
+ * address can never match a stale binding. */
+static __thread SlabEpochBinding tls_binding;
+static __thread epoch_domain_t*  tls_bound_domain = NULL;
+
+static inline void binding_refresh(epoch_domain_t* d) {
+    slab_epoch_bind(d->alloc, d->epoch_id, &tls_binding);
+    tls_bound_domain = d;
+}
+
+static inline void binding_drop(epoch_domain_t* d) {
+    if (tls_bound_domain == d) tls_bound_domain = NULL;
+}
+
 /* Debug: ensure a domain isn't still on this thread's TLS stack */
 static inline void tls_assert_not_present(epoch_domain_t* d) {
 #ifndef NDEBUG
@@ -54,10 +72,11 @@ epoch_domain_t* epoch_domain_create(SlabAllocator* alloc) {
 
     /* Wrap current epoch (no advance) - caller controls phase boundaries */
     domain->epoch_id = epoch_current(alloc);
-    domain->epoch_era = atomic_load_explicit(&alloc->epoch_era[domain->epoch_id], memory_order_acquire);
+    domain->epoch_era = atomic_load_explicit(&alloc->epoch_era[SLAB_EPOCH_INDEX(domain->epoch_id)], memory_order_acquire);
 
     domain->refcount = 0;
     domain->auto_close = false;  /* Default: explicit epoch_close (safer) */
+    domain->default_classes = alloc->default_classes;
 
     /* Contract: domain is thread-local scoped. Enforce ownership. */
     domain->owner_tid = pthread_self();
@@ -73,10 +92,11 @@ epoch_domain_t* epoch_domain_wrap(SlabAllocator* alloc, EpochId epoch_id, bool a
 
     domain->alloc = alloc;
     domain->epoch_id = epoch_id;
-    domain->epoch_era = atomic_load_explicit(&alloc->epoch_era[epoch_id], memory_order_acquire);
+    domain->epoch_era = atomic_load_explicit(&alloc->epoch_era[SLAB_EPOCH_INDEX(epoch_id)], memory_order_acquire);
 
     domain->refcount = 0;
     domain->auto_close = auto_close;
+    domain->default_classes = alloc->default_classes;
 
     /* Contract: domain is thread-local scoped. Enforce ownership. */
     domain->owner_tid = pthread_self();
@@ -99,6 +119,9 @@ void epoch_domain_enter(epoch_domain_t* domain) {
 
     /* Always push for nesting correctness (even re-entrance) */
     tls_push(domain);
+
+    /* Resolve the epoch for epoch_domain_alloc() */
+    binding_refresh(domain);
 }
 
 void epoch_domain_exit(epoch_domain_t* domain) {
@@ -117,11 +140,12 @@ void epoch_domain_exit(epoch_domain_t* domain) {
     /* On last exit (1->0 transition), notify allocator and perform cleanup */
     if (domain->refcount == 0) {
         slab_epoch_dec_refcount(domain->alloc, domain->epoch_id);
+        binding_drop(domain);
 
         if (domain->auto_close) {
             /* Validate era before auto-closing (prevent closing wrong epoch after wrap) */
             uint64_t current_era =
-                atomic_load_explicit(&domain->alloc->epoch_era[domain->epoch_id], memory_order_acquire);
+                atomic_load_explicit(&domain->alloc->epoch_era[SLAB_EPOCH_INDEX(domain->epoch_id)], memory_order_acquire);
 
             if (current_era == domain->epoch_era) {
                 /* Era matches - safe to close if no other active domains for this epoch */
@@ -152,11 +176,12 @@ void epoch_domain_destroy(epoch_domain_t* domain) {
 
     assert(domain->refcount == 0 && "epoch_domain_destroy called while domain is active");
     tls_assert_not_present(domain);
+    binding_drop(domain);
 
     if (domain->auto_close) {
         /* Validate era before closing (prevent closing wrong epoch after wrap) */
         uint64_t current_era =
-            atomic_load_explicit(&domain->alloc->epoch_era[domain->epoch_id], memory_order_acquire);
+            atomic_load_explicit(&domain->alloc->epoch_era[SLAB_EPOCH_INDEX(domain->epoch_id)], memory_order_acquire);
 
         if (current_era == domain->epoch_era) {
             epoch_close(domain->alloc, domain->epoch_id);
@@ -179,10 +204,29 @@ void epoch_domain_force_close(epoch_domain_t* domain) {
 
     /* Validate era before closing (prevent closing wrong epoch after wrap) */
     uint64_t current_era =
-        atomic_load_explicit(&domain->alloc->epoch_era[domain->epoch_id], memory_order_acquire);
+        atomic_load_explicit(&domain->alloc->epoch_era[SLAB_EPOCH_INDEX(domain->epoch_id)], memory_order_acquire);
 
     if (current_era == domain->epoch_era) {
         epoch_close(domain->alloc, domain->epoch_id);
     }
     /* Era mismatch: epoch wrapped and reused, skip close */
 }
+
+void* epoch_domain_alloc_class(epoch_domain_t* domain, uint32_t size_class, SlabHandle* out) {
+    if (!domain || size_class >= SLAB_MAX_CLASSES) return NULL;
+
+    assert(pthread_equal(domain->owner_tid, pthread_self()) && "epoch_domain_alloc: domain used from non-owner thread");
+
+    if (tls_bound_domain != domain) {
+        binding_refresh(domain);
+    }
+    return slab_alloc_bound(&tls_binding, size_class, out);
+}
+
+void* epoch_domain_alloc_size(epoch_domain_t* domain, uint32_t size, SlabHandle* out) {
+    if (!domain) return NULL;
+
+    SlabAllocator* a = domain->alloc;
+    if (size == 0 || size > a->max_alloc_size) return NULL;
+    return epoch_domain_alloc_class(domain, a->class_lookup[size], out);
+}
@@ -13,6 +13,7 @@
 #include "slab_stats.h"     /* Phase 2.5: For slowpath sampling */
 #include "epoch_domain.h"  /* Phase 2.3: For TLS label attribution */
 #include <errno.h>
+#include <fcntl.h>
 #include <inttypes.h>
 #include <stdatomic.h>
 #include <stdbool.h>
@@ -23,9 +24,26 @@
 #include <string.h>
 #include <sched.h>
 #include <sys/mman.h>
+#if defined(__linux__)
+#  include <sys/syscall.h>  /* SYS_mbind, SYS_process_madvise */
+#  include <sys/uio.h>      /* struct iovec (batched page return) */
+#endif
+#if defined(__linux__) && defined(__has_include)
+#  if __has_include(<sys/rseq.h>)
+#    include <sys/rseq.h>   /* glibc >= 2.35: registered rseq area (cpu_id) */
+#    define SLAB_HAVE_RSEQ 1
+#  endif
+#endif
 #include <time.h>
 #include <unistd.h>
 #include <assert.h>
+#if SLAB_SIMD_SCAN && defined(__AVX2__)
+#  include <immintrin.h>
+#elif SLAB_SIMD_SCAN && defined(__SSE2__)
+#  include <emmintrin.h>
+#elif SLAB_SIMD_SCAN && defined(__aarch64__) && defined(__ARM_NEON)
+#  include <arm_neon.h>
+#endif
 
 #ifdef ENABLE_DRAINPROF
 #include <drainprof.h>
@@ -50,6 +68,7 @@ drainprof* g_profiler = NULL;
 #ifndef LOCK_RANK_REGISTRY
 #define LOCK_RANK_REGISTRY       10
 #define LOCK_RANK_CACHE          20
+#define LOCK_RANK_ARENA          25
 #define LOCK_RANK_SIZE_CLASS     30
 #define LOCK_RANK_EPOCH_LABEL    40
 #define LOCK_RANK_LABEL_REGISTRY 50
@@ -72,7 +91,7 @@ _Thread_local int _lock_rank_depth = 0;
 static inline uint8_t current_label_id(SlabAllocator* alloc) {
   epoch_domain_t* d = epoch_domain_current();
   if (!d) return 0;  /* No active domain = ID 0 (unlabeled) */
-  return alloc->epoch_meta[d->epoch_id].label_id;
+  return alloc->epoch_meta[SLAB_EPOCH_INDEX(d->epoch_id)].label_id;
 }
 #endif
 
@@ -89,11 +108,11 @@ static inline uint8_t current_label_id(SlabAllocator* alloc) {
 #define LOCK_WITH_PROBE(mutex, sc, rank, name) do { \
   CHECK_LOCK_RANK(rank, name, __FILE__ ":" #rank); \
   if (pthread_mutex_trylock(mutex) == 0) { \
-    atomic_fetch_add_explicit(&(sc)->lock_fast_acquire, 1, memory_order_relaxed); \
+    atomic_fetch_add_explicit(&sc_stripe(sc)->lock_fast_acquire, 1, memory_order_relaxed); \
     uint8_t lid = current_label_id((sc)->parent_alloc); \
     atomic_fetch_add_explicit(&(sc)->lock_fast_acquire_by_label[lid], 1, memory_order_relaxed); \
   } else { \
-    atomic_fetch_add_explicit(&(sc)->lock_contended, 1, memory_order_relaxed); \
+    atomic_fetch_add_explicit(&sc_stripe(sc)->lock_contended, 1, memory_order_relaxed); \
     uint8_t lid = current_label_id((sc)->parent_alloc); \
     atomic_fetch_add_explicit(&(sc)->lock_contended_by_label[lid], 1, memory_order_relaxed); \
     pthread_mutex_lock(mutex); \
@@ -103,9 +122,9 @@ static inline uint8_t current_label_id(SlabAllocator* alloc) {
 #define LOCK_WITH_PROBE(mutex, sc, rank, name) do { \
   CHECK_LOCK_RANK(rank, name, __FILE__ ":" #rank); \
   if (pthread_mutex_trylock(mutex) == 0) { \
-    atomic_fetch_add_explicit(&(sc)->lock_fast_acquire, 1, memory_order_relaxed); \
+    atomic_fetch_add_explicit(&sc_stripe(sc)->lock_fast_acquire, 1, memory_order_relaxed); \
   } else { \
-    atomic_fetch_add_explicit(&(sc)->lock_contended, 1, memory_order_relaxed); \
+    atomic_fetch_add_explicit(&sc_stripe(sc)->lock_contended, 1, memory_order_relaxed); \
     struct timespec timeout; \
     clock_gettime(CLOCK_REALTIME, &timeout); \
     timeout.tv_sec += 5; /* 5 second timeout */ \
@@ -161,17 +180,23 @@ _Static_assert((SLAB_PAGE_SIZE & (SLAB_PAGE_SIZE - 1)) == 0, "SLAB_PAGE_SIZE mus
 #endif
 
 /* Size classes (HFT-optimized: sub-100 byte granularity) */
-static const uint32_t k_size_classes[] = {64u, 96u, 128u, 192u, 256u, 384u, 512u, 768u};
+/* Default size-class table (allocator_init / slab_allocator_create).
+ * allocator_init_with_config() can replace it per allocator instance. */
+static const uint32_t k_size_classes[] = {64u, 96u, 128u, 192u, 256u, 384u, 512u, 768u,
+                                          1024u, 1536u, 2048u, 4096u, 8192u, 16384u};
 static const size_t   k_num_classes   = sizeof(k_size_classes) / sizeof(k_size_classes[0]);
 
-/* O(1) lookup table: maps size -> class index
- * Max supported size: 768 bytes
- * Granularity: 1 byte (768 entries)
- * Memory cost: 768 bytes (fits in L1 cache)
+_Static_assert(sizeof(k_size_classes) / sizeof(k_size_classes[0]) == SLAB_NUM_CLASSES,
+               "k_size_classes must have SLAB_NUM_CLASSES entries");
+
+/* O(1) lookup table: maps size -> class index (SlabAllocator.class_lookup)
+ * Built per allocator instance from its size-class table.
+ * Max supported size: SLAB_MAX_OBJECT_SIZE (16KB)
+ * Granularity: 1 byte (16K entries)
+ * Memory cost: 16KB, but small-object lookups only touch the first 768 bytes
+ * (12 cache lines), so the hot footprint is unchanged by the large tier.
  */
-#define MAX_ALLOC_SIZE 768u
-static uint8_t k_class_lookup[MAX_ALLOC_SIZE + 1];
-static pthread_once_t k_lookup_once = PTHREAD_ONCE_INIT;
+#define MAX_ALLOC_SIZE SLAB_MAX_OBJECT_SIZE
 
 /* Phase 2.2+: Adaptive bitmap scanning helpers (HFT-friendly: no clocks, windowed deltas)
  *
@@ -211,9 +236,9 @@ static inline void scan_adapt_check(SizeClassAlloc* sc) {
     return; /* Another thread is already running the controller */
   }
 
-  /* Snapshot global counters (monotonic) */
-  uint64_t attempts = atomic_load_explicit(&sc->bitmap_alloc_attempts, memory_order_relaxed);
-  uint64_t retries  = atomic_load_explicit(&sc->bitmap_alloc_cas_retries, memory_order_relaxed);
+  /* Snapshot counters (monotonic, summed over stripes) */
+  uint64_t attempts = SC_COUNTER_SUM(sc, bitmap_alloc_attempts);
+  uint64_t retries  = SC_COUNTER_SUM(sc, bitmap_alloc_cas_retries);
 
   /* Load previous window endpoints */
   uint64_t last_a = atomic_load_explicit(&sc->scan_adapt.last_attempts, memory_order_relaxed);
@@ -285,11 +310,572 @@ uint64_t now_ns(void) {
   return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
 }
 
+/* Millisecond clock for cache windows and trim grace: the coarse clock is a
+ * vDSO read of the last tick, cheap enough for slow paths. Wraps every ~49
+ * days; callers only compare differences. */
+static inline uint32_t coarse_ms(void) {
+  struct timespec ts;
+#ifdef CLOCK_MONOTONIC_COARSE
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+#else
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000u + (uint64_t)ts.tv_nsec / 1000000u);
+}
+
 /* Helper: Get epoch state for a given size class and epoch */
 static inline EpochState* get_epoch_state(SizeClassAlloc* sc, uint32_t epoch_id) {
   return &sc->epochs[epoch_id];
 }
 
+/* ------------------------------ Per-CPU slot selection ------------------------------ */
+
+/* Fallback id for threads without a usable CPU id: assigned round robin
+ * on first use so that N threads spread over N slots and stripes. */
+static _Atomic uint32_t g_percpu_next_slot = 0;
+static __thread uint32_t tls_percpu_slot = UINT32_MAX;
+
+/* CPU id of the calling thread, or a per-thread ordinal when none is known.
+ *
+ * Preference order:
+ * 1. rseq cpu_id: glibc registers an rseq area per thread; cpu_id is kept
+ *    current by the kernel on every migration. One TLS load (~1ns).
+ * 2. sched_getcpu(): vDSO call (~10-20ns), used if rseq is unavailable or
+ *    registration was disabled (glibc.pthread.rseq=0 tunable).
+ * 3. Round-robin per-thread ordinal (non-Linux, or both of the above failed).
+ *
+ * The result is only a placement hint: callers mask it to their own array
+ * size, and migrating right after the load is harmless.
+ */
+static inline uint32_t slab_cpu_id(void) {
+#if defined(SLAB_HAVE_RSEQ)
+  if (__rseq_size > 0) {
+    const struct rseq* rs = (const struct rseq*)((char*)__builtin_thread_pointer() + __rseq_offset);
+    int32_t cpu = (int32_t)(*(volatile const uint32_t*)&rs->cpu_id);
+    if (cpu >= 0) return (uint32_t)cpu;
+  }
+#endif
+#if defined(__linux__)
+  int cpu = sched_getcpu();
+  if (cpu >= 0) return (uint32_t)cpu;
+#endif
+  if (tls_percpu_slot == UINT32_MAX) {
+    tls_percpu_slot = atomic_fetch_add_explicit(&g_percpu_next_slot, 1, memory_order_relaxed);
+  }
+  return tls_percpu_slot;
+}
+
+/* Map the calling thread to one of SLAB_PERCPU_SLOTS current_partial slots.
+ * Every slot is safe to use from any CPU. */
+static inline uint32_t percpu_slot(void) {
+#if SLAB_PERCPU_SLOTS == 1
+  return 0;
+#else
+  return slab_cpu_id() & (SLAB_PERCPU_SLOTS - 1u);
+#endif
+}
+
+/* Counter stripe for the calling CPU (see SlabCounterStripe) */
+static inline SlabCounterStripe* sc_stripe(SizeClassAlloc* sc) {
+  return &sc->stripes[slab_cpu_id() & (SLAB_COUNTER_STRIPES - 1u)];
+}
+
+uint64_t sc_counter_sum(const SizeClassAlloc* sc, size_t field_offset) {
+  uint64_t sum = 0;
+  if (!sc->stripes) return 0;
+  for (uint32_t i = 0; i < SLAB_COUNTER_STRIPES; i++) {
+    const _Atomic uint64_t* c =
+        (const _Atomic uint64_t*)(const void*)((const char*)&sc->stripes[i] + field_offset);
+    sum += atomic_load_explicit(c, memory_order_relaxed);
+  }
+  return sum;
+}
+
+#if ENABLE_LATENCY_HIST
+/* ------------------------------ Latency histograms ------------------------------ */
+
+static __thread uint32_t tls_lat_ctr = 0;      /* Alloc/free sampling counter */
+static __thread bool tls_lat_timing = false;   /* Inside a timed alloc/free */
+static __thread bool tls_lat_slow = false;     /* Timed alloc entered the slow path */
+
+/* Add one latency sample to the calling CPU's stripe */
+static inline void lat_record(SlabAllocator* a, SlabLatencyOp op, uint64_t ns) {
+  SlabLatencyStripe* st = &a->lat_stripes[slab_cpu_id() & (SLAB_LAT_STRIPES - 1u)];
+  atomic_fetch_add_explicit(&st->count[op], 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&st->sum_ns[op], ns, memory_order_relaxed);
+  atomic_fetch_add_explicit(&st->buckets[op][slab_lat_bucket(ns)], 1, memory_order_relaxed);
+}
+
+/* True if this alloc/free should be timed: 1 in 2^SLAB_LAT_SAMPLE_SHIFT
+ * calls, and never a call nested in a timed one (TLS refill allocates). */
+static inline bool lat_sample(void) {
+  if (tls_lat_timing) return false;
+  return (++tls_lat_ctr & ((1u << SLAB_LAT_SAMPLE_SHIFT) - 1u)) == 0;
+}
+#endif
+
+#if ENABLE_ALLOC_TRACE
+/* ------------------------------ Allocation trace ------------------------------ */
+
+#define TRACE_DEFAULT_RING_RECORDS 8192u
+#define TRACE_DEFAULT_FLUSH_MS     20u
+#define TRACE_MAX_THREADS          65536u  /* SlabTraceRecord.thread is 16 bits */
+
+/* Set while a traced public call runs its body: the nested calls it makes
+ * (batch slow path, TLS refill and flush) are not user operations. */
+__thread bool _tls_trace_mute = false;
+
+/* The calling thread's ring, valid while tls_trace_alloc/instance match */
+static __thread SlabAllocator* tls_trace_alloc = NULL;
+static __thread uint64_t tls_trace_instance = 0;
+static __thread SlabTraceRing* tls_trace_ring = NULL;
+static _Atomic uint64_t g_trace_instance = 0;
+
+static inline bool trace_on(SlabAllocator* a) {
+  return !_tls_trace_mute && atomic_load_explicit(&a->trace.session, memory_order_relaxed) != 0;
+}
+
+/* Era of an epoch ID as recorded in traces (low 32 bits of the sequence) */
+static inline uint32_t trace_era(SlabAllocator* a, EpochId id) {
+  uint32_t q = (uint32_t)(id >> 32);
+  if (q != 0) return q - 1u;
+  uint32_t slot = SLAB_EPOCH_INDEX(id);
+  if (slot >= a->epoch_count) return 0;
+  return (uint32_t)atomic_load_explicit(&a->epoch_era[slot], memory_order_relaxed);
+}
+
+/* Find or create the calling thread's ring. NULL if out of memory or out
+ * of thread numbers (the record is then counted as lost). */
+static SlabTraceRing* trace_ring_attach(SlabAllocator* a) {
+  SlabTrace* t = &a->trace;
+  pthread_t self = pthread_self();
+  SlabTraceRing* ring = NULL;
+
+  pthread_mutex_lock(&t->lock);
+  for (SlabTraceRing* r = atomic_load_explicit(&t->rings, memory_order_relaxed); r; r = r->next) {
+    if (pthread_equal(r->owner, self)) {
+      ring = r;
+      break;
+    }
+  }
+  if (!ring && t->ring_count < TRACE_MAX_THREADS) {
+    size_t bytes = sizeof(SlabTraceRing) + (size_t)t->ring_records * sizeof(SlabTraceRecord);
+    void* mem = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem != MAP_FAILED) {
+      ring = (SlabTraceRing*)mem;  /* Anonymous mapping: counters start at 0 */
+      ring->mask = t->ring_records - 1u;
+      ring->map_bytes = bytes;
+      ring->owner = self;
+      ring->thread = (uint16_t)t->ring_count++;
+      ring->next = atomic_load_explicit(&t->rings, memory_order_relaxed);
+      atomic_store_explicit(&t->rings, ring, memory_order_release);
+    }
+  }
+  pthread_mutex_unlock(&t->lock);
+  return ring;
+}
+
+/* Append one record to the calling thread's ring */
+static void trace_put(SlabAllocator* a, SlabTraceOp op, uint32_t size_class, uint32_t size,
+                      uint32_t epoch, uint64_t handle) {
+  SlabTrace* t = &a->trace;
+  if (tls_trace_alloc != a || tls_trace_instance != t->instance) {
+    SlabTraceRing* r = trace_ring_attach(a);
+    if (!r) {
+      atomic_fetch_add_explicit(&t->lost, 1, memory_order_relaxed);
+      return;
+    }
+    tls_trace_alloc = a;
+    tls_trace_instance = t->instance;
+    tls_trace_ring = r;
+  }
+  SlabTraceRing* r = tls_trace_ring;
+
+  /* Stop handshake (see SlabTrace) */
+  atomic_store_explicit(&r->busy, 1, memory_order_seq_cst);
+  if (atomic_load_explicit(&t->session, memory_order_seq_cst) == 0) {
+    atomic_store_explicit(&r->busy, 0, memory_order_release);
+    return;
+  }
+
+  uint64_t now = now_ns();
+  uint64_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+  uint64_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+  bool stamp = r->last_ns == 0 || now - r->last_ns > UINT32_MAX;
+  if (head - tail + (stamp ? 2u : 1u) > (uint64_t)r->mask + 1u) {
+    atomic_fetch_add_explicit(&r->dropped, 1, memory_order_relaxed);
+    atomic_store_explicit(&r->busy, 0, memory_order_release);
+    return;
+  }
+  if (stamp) {
+    r->rec[head & r->mask] = (SlabTraceRecord){
+      .thread = r->thread, .op = SLAB_TRACE_TIME, .handle = now };
+    head++;
+    r->last_ns = now;
+  }
+  r->rec[head & r->mask] = (SlabTraceRecord){
+    .delta_ns = (uint32_t)(now - r->last_ns), .thread = r->thread, .op = (uint8_t)op,
+    .size_class = (uint8_t)size_class, .size = size, .epoch = epoch, .handle = handle };
+  r->last_ns = now;
+  atomic_store_explicit(&r->head, head + 1u, memory_order_release);
+  atomic_store_explicit(&r->busy, 0, memory_order_release);
+}
+
+/* Write out everything the producers have published. Drainer or stop only
+ * (t->lock not held: write() may block). */
+static void trace_drain(SlabTrace* t) {
+  for (SlabTraceRing* r = atomic_load_explicit(&t->rings, memory_order_acquire); r; r = r->next) {
+    uint64_t tail = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint64_t head = atomic_load_explicit(&r->head, memory_order_acquire);
+    uint64_t n = head - tail;
+    if (n == 0) continue;
+
+    /* At most two contiguous pieces: up to the ring end, then from 0 */
+    uint64_t done = 0;
+    while (done < n && t->error == 0) {
+      uint64_t pos = (tail + done) & r->mask;
+      uint64_t run = (uint64_t)r->mask + 1u - pos;
+      if (run > n - done) run = n - done;
+      const char* p = (const char*)&r->rec[pos];
+      size_t left = (size_t)run * sizeof(SlabTraceRecord);
+      while (left > 0) {
+        ssize_t w = write(t->fd, p, left);
+        if (w < 0) {
+          if (errno == EINTR) continue;
+          t->error = errno;
+          break;
+        }
+        p += w;
+        left -= (size_t)w;
+      }
+      if (t->error == 0) done += run;
+    }
+    /* After a write error the rest is discarded so producers keep going */
+    if (done < n) atomic_fetch_add_explicit(&t->lost, n - done, memory_order_relaxed);
+    atomic_fetch_add_explicit(&t->written, done, memory_order_relaxed);
+    r->drained += done;
+    atomic_store_explicit(&r->tail, head, memory_order_release);
+  }
+}
+
+/* Drainer thread: empty the rings every flush_ms until stop */
+static void* trace_main(void* arg) {
+  SlabTrace* t = (SlabTrace*)arg;
+
+  pthread_mutex_lock(&t->lock);
+  while (!t->stop) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_nsec += (long)t->flush_ms * 1000000L;
+    while (deadline.tv_nsec >= 1000000000L) {
+      deadline.tv_sec++;
+      deadline.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(&t->wake, &t->lock, &deadline);
+    if (t->stop) break;
+    pthread_mutex_unlock(&t->lock);
+    trace_drain(t);
+    pthread_mutex_lock(&t->lock);
+  }
+  pthread_mutex_unlock(&t->lock);
+  return NULL;
+}
+
+static void trace_init(SlabAllocator* a) {
+  SlabTrace* t = &a->trace;
+  memset(t, 0, sizeof(*t));
+  t->fd = -1;
+  t->instance = atomic_fetch_add_explicit(&g_trace_instance, 1, memory_order_relaxed) + 1u;
+  t->ring_records = TRACE_DEFAULT_RING_RECORDS;
+  pthread_mutex_init(&t->lock, NULL);
+  pthread_cond_init(&t->wake, NULL);
+}
+
+static void trace_destroy(SlabAllocator* a) {
+  SlabTrace* t = &a->trace;
+  slab_trace_stop(a);
+  SlabTraceRing* r = atomic_load_explicit(&t->rings, memory_order_relaxed);
+  while (r) {
+    SlabTraceRing* next = r->next;
+    munmap(r, r->map_bytes);
+    r = next;
+  }
+  atomic_store_explicit(&t->rings, NULL, memory_order_relaxed);
+  pthread_mutex_destroy(&t->lock);
+  pthread_cond_destroy(&t->wake);
+}
+
+bool slab_trace_start(SlabAllocator* a, const SlabTraceConfig* config) {
+  if (!a || !config || !config->path) {
+    errno = EINVAL;
+    return false;
+  }
+  SlabTrace* t = &a->trace;
+
+  pthread_mutex_lock(&t->lock);
+  if (t->running) {
+    pthread_mutex_unlock(&t->lock);
+    errno = EALREADY;
+    return false;
+  }
+  int fd = open(config->path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    int err = errno;
+    pthread_mutex_unlock(&t->lock);
+    errno = err;
+    return false;
+  }
+
+  /* Ring capacity applies to rings created from now on; existing rings
+   * keep theirs (they are never resized under a live producer). */
+  uint32_t want = config->ring_records ? config->ring_records : TRACE_DEFAULT_RING_RECORDS;
+  if (want < 2u) want = 2u;
+  if (want > (1u << 24)) want = 1u << 24;
+  uint32_t cap = 2u;
+  while (cap < want) cap <<= 1;
+  t->ring_records = cap;
+  t->flush_ms = config->flush_interval_ms ? config->flush_interval_ms : TRACE_DEFAULT_FLUSH_MS;
+
+  SlabTraceHeader* h = &t->hdr;
+  memset(h, 0, sizeof(*h));
+  h->magic = SLAB_TRACE_MAGIC;
+  h->version = SLAB_TRACE_VERSION;
+  h->record_size = (uint32_t)sizeof(SlabTraceRecord);
+  h->start_ns = now_ns();
+  h->flags = (ENABLE_TLS_CACHE ? SLAB_TRACE_F_TLS_CACHE : 0u) |
+             (a->remote_free ? SLAB_TRACE_F_REMOTE_FREE : 0u) |
+             (a->header_free ? SLAB_TRACE_F_HEADER_FREE : 0u);
+  h->epoch_count = a->epoch_count;
+  h->start_era = (uint32_t)atomic_load_explicit(&a->current_epoch, memory_order_acquire);
+  h->num_classes = (uint32_t)a->num_classes;
+  for (size_t i = 0; i < a->num_classes; i++) h->class_sizes[i] = a->classes[i].object_size;
+  /* Provisional header (records 0 until stop): the file parses even if
+   * the process dies mid-trace */
+  if (pwrite(fd, h, sizeof(*h), 0) != (ssize_t)sizeof(*h) || lseek(fd, sizeof(*h), SEEK_SET) < 0) {
+    int err = errno ? errno : EIO;
+    close(fd);
+    pthread_mutex_unlock(&t->lock);
+    errno = err;
+    return false;
+  }
+
+  /* Fresh counters; no producer is inside a ring (session is 0) */
+  for (SlabTraceRing* r = atomic_load_explicit(&t->rings, memory_order_relaxed); r; r = r->next) {
+    atomic_store_explicit(&r->head, 0, memory_order_relaxed);
+    atomic_store_explicit(&r->tail, 0, memory_order_relaxed);
+    atomic_store_explicit(&r->dropped, 0, memory_order_relaxed);
+    r->last_ns = 0;
+    r->drained = 0;
+  }
+  atomic_store_explicit(&t->written, 0, memory_order_relaxed);
+  atomic_store_explicit(&t->lost, 0, memory_order_relaxed);
+  t->error = 0;
+  t->fd = fd;
+  t->stop = false;
+
+  int rc = pthread_create(&t->thread, NULL, trace_main, t);
+  if (rc != 0) {
+    close(fd);
+    t->fd = -1;
+    pthread_mutex_unlock(&t->lock);
+    errno = rc;
+    return false;
+  }
+  t->running = true;
+  atomic_store_explicit(&t->session, ++t->last_session, memory_order_seq_cst);
+  pthread_mutex_unlock(&t->lock);
+  return true;
+}
+
+void slab_trace_stop(SlabAllocator* a) {
+  if (!a) return;
+  SlabTrace* t = &a->trace;
+
+  pthread_mutex_lock(&t->lock);
+  if (!t->running) {
+    pthread_mutex_unlock(&t->lock);
+    return;
+  }
+  /* No new records, then wait out the ones in flight */
+  atomic_store_explicit(&t->session, 0, memory_order_seq_cst);
+  for (SlabTraceRing* r = atomic_load_explicit(&t->rings, memory_order_relaxed); r; r = r->next) {
+    while (atomic_load_explicit(&r->busy, memory_order_seq_cst)) sched_yield();
+  }
+  t->stop = true;
+  pthread_cond_signal(&t->wake);
+  pthread_mutex_unlock(&t->lock);
+
+  pthread_join(t->thread, NULL);
+  trace_drain(t);
+
+  pthread_mutex_lock(&t->lock);
+  SlabTraceHeader* h = &t->hdr;
+  h->stop_ns = now_ns();
+  h->records = atomic_load_explicit(&t->written, memory_order_relaxed);
+  h->dropped = atomic_load_explicit(&t->lost, memory_order_relaxed);
+  h->threads = 0;
+  for (SlabTraceRing* r = atomic_load_explicit(&t->rings, memory_order_relaxed); r; r = r->next) {
+    h->dropped += atomic_load_explicit(&r->dropped, memory_order_relaxed);
+    if (r->drained > 0) h->threads++;
+  }
+  if (pwrite(t->fd, h, sizeof(*h), 0) != (ssize_t)sizeof(*h) && t->error == 0) t->error = errno ? errno : EIO;
+  close(t->fd);
+  t->fd = -1;
+  t->running = false;
+  t->stop = false;
+  pthread_mutex_unlock(&t->lock);
+}
+
+void slab_trace_stats(SlabAllocator* a, SlabTraceStats* out) {
+  if (!out) return;
+  memset(out, 0, sizeof(*out));
+  if (!a) return;
+  SlabTrace* t = &a->trace;
+
+  pthread_mutex_lock(&t->lock);
+  out->active = t->running;
+  out->records = atomic_load_explicit(&t->written, memory_order_relaxed);
+  out->dropped = atomic_load_explicit(&t->lost, memory_order_relaxed);
+  for (SlabTraceRing* r = atomic_load_explicit(&t->rings, memory_order_relaxed); r; r = r->next) {
+    out->dropped += atomic_load_explicit(&r->dropped, memory_order_relaxed);
+  }
+  out->threads = t->ring_count;
+  out->error = t->error;
+  pthread_mutex_unlock(&t->lock);
+}
+#else
+static inline bool trace_on(SlabAllocator* a) { (void)a; return false; }
+
+bool slab_trace_start(SlabAllocator* a, const SlabTraceConfig* config) {
+  (void)a;
+  (void)config;
+  errno = ENOTSUP;
+  return false;
+}
+
+void slab_trace_stop(SlabAllocator* a) { (void)a; }
+
+void slab_trace_stats(SlabAllocator* a, SlabTraceStats* out) {
+  (void)a;
+  if (out) memset(out, 0, sizeof(*out));
+}
+#endif /* ENABLE_ALLOC_TRACE */
+
+/* True if slab s is the current_partial of any slot other than skip. */
+static inline bool slab_claimed_by_other_slot(EpochState* es, Slab* s, uint32_t skip) {
+  for (uint32_t i = 0; i < SLAB_PERCPU_SLOTS; i++) {
+    if (i == skip) continue;
+    if (atomic_load_explicit(&es->current_partial[i], memory_order_relaxed) == s) return true;
+  }
+  return false;
+}
+
+/* Pin slot `slot` of es for a lock-free claim on s, just loaded from it.
+ *
+ * The loaded pointer can go stale at any time: epoch_close() may unpublish
+ * the slab, recycle it and new_slab() reinitialize it for another epoch,
+ * wiping or duplicating a claim made in between. So the claimer pins its
+ * slot first and then re-reads it, and recyclers (epoch_unpinned) unpublish
+ * first and then read every slot's pins. Both sides are seq_cst, so at
+ * least one sees the other: either the slot no longer holds s here
+ * (returns false, unpinned) or the recycler sees the pin and leaves the
+ * epoch's slabs alone. If the slot holds s again because it was recycled
+ * and republished meanwhile, the claim lands in the new incarnation, which
+ * is published and therefore fine.
+ *
+ * The count lives in the EpochState, not the slab, so returning a cached
+ * slab's pages can't reset it under a stale claimer.
+ *
+ * Hold the pin across the claim RMW only, and never while taking a lock. */
+static inline bool slab_pin_published(EpochState* es, uint32_t slot, Slab* s) {
+  atomic_fetch_add_explicit(&es->pins[slot].n, 1u, memory_order_seq_cst);
+  if (atomic_load_explicit(&es->current_partial[slot], memory_order_seq_cst) == s) return true;
+  atomic_fetch_sub_explicit(&es->pins[slot].n, 1u, memory_order_release);
+  return false;
+}
+
+static inline void slab_unpin(EpochState* es, uint32_t slot) {
+  atomic_fetch_sub_explicit(&es->pins[slot].n, 1u, memory_order_release);
+}
+
+/* May the epoch's slabs be recycled? Call after clearing every slot. True
+ * means no claimer is in flight and any later one fails its re-check;
+ * claims that already finished are visible to the caller's free slot
+ * counts from here on. */
+static inline bool epoch_unpinned(EpochState* es) {
+  atomic_thread_fence(memory_order_seq_cst);
+  for (uint32_t i = 0; i < SLAB_PERCPU_SLOTS; i++) {
+    if (atomic_load_explicit(&es->pins[i].n, memory_order_acquire) != 0u) return false;
+  }
+  return true;
+}
+
+/* Wait out claimers that pinned before the slots were cleared (epoch
+ * release and compaction, which recycle without asking). A pin covers one
+ * RMW, so this only spins while a claimer is descheduled inside that window. */
+static void epoch_wait_unpinned(EpochState* es) {
+  while (!epoch_unpinned(es)) sched_yield();
+}
+
+/* Free slots in s, counting an unretired bump reserve (see Slab.bump_next).
+ * Use this, not free_count alone, wherever "is the slab full/empty?" is
+ * asked: a fresh slab has free_count == 0 until its first free. */
+static inline uint32_t slab_free_slots(Slab* s) {
+  uint32_t fc = atomic_load_explicit(&s->free_count, memory_order_relaxed);
+  uint32_t b = atomic_load_explicit(&s->bump_next, memory_order_relaxed);
+  return b < s->object_count ? fc + (s->object_count - b) : fc;
+}
+
+/* Bound on partial slabs inspected when choosing a slab for a slot.
+ * Keeps the choice O(1) under sc->lock even with long partial lists. */
+#define PERCPU_PICK_SCAN_LIMIT 8u
+
+/* Choose a partial slab to publish into slot (caller holds sc->lock).
+ *
+ * Returns a partial slab with free slots that no other slot has published,
+ * scanning at most PERCPU_PICK_SCAN_LIMIT slabs. Among those, a slab whose
+ * memory is on `node` (the caller's NUMA node) wins; otherwise the first
+ * unclaimed one. If every inspected slab is claimed, returns the head
+ * (shared, still correct) unless the whole list was inspected, in which case
+ * returns NULL and sets *want_fresh so the caller can give this CPU its own
+ * new slab.
+ *
+ * The chosen slab is marked was_published (monotonic safety flag).
+ */
+static Slab* pick_partial_for_slot(EpochState* es, uint32_t slot, uint32_t node, bool* want_fresh) {
+  if (want_fresh) *want_fresh = false;
+  Slab* head = es->partial.head;
+  Slab* fallback = NULL;  /* First unclaimed slab on another node */
+  uint32_t seen = 0;
+  for (Slab* s = head; s && seen < PERCPU_PICK_SCAN_LIMIT; s = s->next, seen++) {
+    if (slab_free_slots(s) == 0) continue;
+    if (slab_claimed_by_other_slot(es, s, slot)) continue;
+    if (s->numa_node == node) {
+      s->was_published = true;
+      return s;
+    }
+    if (!fallback) fallback = s;
+  }
+  if (fallback) {
+    fallback->was_published = true;
+    return fallback;
+  }
+  if (seen < PERCPU_PICK_SCAN_LIMIT && want_fresh) {
+    /* Whole list inspected and every slab is taken (or full) */
+    *want_fresh = true;
+    return NULL;
+  }
+  if (head) head->was_published = true;
+  return head;
+}
+
+/* Null every slot's current_partial (epoch advance/close/destroy). */
+static inline void percpu_clear_all(EpochState* es, memory_order mo) {
+  for (uint32_t i = 0; i < SLAB_PERCPU_SLOTS; i++) {
+    atomic_store_explicit(&es->current_partial[i], NULL, mo);
+  }
+}
+
 static inline uint32_t ctz32(uint32_t x) {
 #if defined(__GNUC__) || defined(__clang__)
   return (uint32_t)__builtin_ctz(x);
@@ -300,30 +886,32 @@ static inline uint32_t ctz32(uint32_t x) {
 #endif
 }
 
-/* Initialize O(1) class lookup table (thread-safe via pthread_once) */
-static void init_class_lookup_impl(void) {
-  /* For each byte size, find smallest class that fits */
-  for (uint32_t sz = 1; sz <= MAX_ALLOC_SIZE; sz++) {
-    uint8_t class_idx = 0xFF; /* invalid */
-    for (size_t i = 0; i < k_num_classes; i++) {
-      if (sz <= k_size_classes[i]) {
-        class_idx = (uint8_t)i;
-        break;
-      }
-    }
-    k_class_lookup[sz] = class_idx;
-  }
-  k_class_lookup[0] = 0xFF; /* zero-size is invalid */
+static inline uint32_t popcount32(uint32_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+  return (uint32_t)__builtin_popcount(x);
+#else
+  uint32_t n = 0;
+  while (x) { x &= x - 1u; n++; }
+  return n;
+#endif
 }
 
-static void init_class_lookup(void) {
-  pthread_once(&k_lookup_once, init_class_lookup_impl);
+/* Build the allocator's O(1) class lookup table from its size-class table.
+ * Single pass: sizes are ascending, so each byte size maps to the first
+ * class that fits. Sizes above the largest class map to 0xFF (rejected). */
+static void build_class_lookup(SlabAllocator* a, const uint32_t* sizes, uint32_t n) {
+  uint32_t ci = 0;
+  a->class_lookup[0] = 0xFF; /* zero-size is invalid */
+  for (uint32_t sz = 1; sz <= MAX_ALLOC_SIZE; sz++) {
+    while (ci < n && sz > sizes[ci]) ci++;
+    a->class_lookup[sz] = (ci < n) ? (uint8_t)ci : 0xFF;
+  }
 }
 
 /* O(1) class index lookup (deterministic, no branches per class) */
-static inline int class_index_for_size(uint32_t sz) {
-  if (sz == 0 || sz > MAX_ALLOC_SIZE) return -1;
-  return (int)k_class_lookup[sz];
+static inline int class_index_for_size(const SlabAllocator* a, uint32_t sz) {
+  if (sz == 0 || sz > a->max_alloc_size) return -1;
+  return (int)a->class_lookup[sz];
 }
 
 /* ------------------------------ Slab Registry (ABA Protection) ------------------------------ */
@@ -333,98 +921,156 @@ static inline int class_index_for_size(uint32_t sz) {
  * Registry maps slab_id (compact integer) to (slab pointer, generation counter).
  * This enables portable handle encoding without embedding raw pointers.
  *
- * Initial capacity: 1024 entries (allocated on first reg_alloc_id call).
- * Growth strategy: Double on overflow (exponential growth, amortized O(1)).
+ * Storage is a fixed directory of REG_SEGMENTS segments, allocated on demand:
+ * segment 0 holds 1024 entries and each later segment doubles the previous
+ * one (1024 → 2048 → 4096 → ...), so capacity still grows geometrically but
+ * nothing is ever copied. An entry's address is stable for the allocator's
+ * lifetime, which is what lets reg_lookup_validate() run without the lock
+ * while reg_alloc_id() grows the registry.
  */
 static void reg_init(SlabRegistry* r) {
-  r->metas = NULL;       /* Allocated on demand */
-  r->cap = 0;            /* No capacity yet */
-  r->free_ids = NULL;    /* Free list (currently unused, reserved for future) */
-  r->free_count = 0;
-  r->next_id = 0;        /* Bump allocator starts at ID 0 */
+  for (uint32_t k = 0; k < REG_SEGMENTS; k++) {
+    atomic_store_explicit(&r->segs[k], NULL, memory_order_relaxed);  /* Allocated on demand */
+  }
+  r->free_head = REG_ID_NONE;  /* No recycled IDs yet */
+  atomic_store_explicit(&r->free_count, 0u, memory_order_relaxed);
+  atomic_store_explicit(&r->next_id, 0u, memory_order_relaxed);  /* Bump allocator starts at ID 0 */
+  atomic_store_explicit(&r->ids_recycled, 0u, memory_order_relaxed);
+  r->id_limit = REG_MAX_IDS;  /* Whole slab_id field, no shard tag */
+  r->id_tag = 0;
   pthread_mutex_init(&r->lock, NULL);
 }
 
 /* Destroy slab registry.
  *
- * Frees all registry metadata. Slab pages themselves are freed separately
+ * Frees all registry segments. Slab pages themselves are freed separately
  * during allocator_destroy() when walking partial/full/cache lists.
  */
 static void reg_destroy(SlabRegistry* r) {
-  free(r->metas);
-  free(r->free_ids);
+  for (uint32_t k = 0; k < REG_SEGMENTS; k++) {
+    free(atomic_load_explicit(&r->segs[k], memory_order_relaxed));
+  }
   pthread_mutex_destroy(&r->lock);
 }
 
-/* Allocate a new slab_id from registry.
+/* First ID stored in segment k: REG_SEG_BASE * (2^k - 1) */
+static inline uint32_t reg_seg_first(uint32_t k) {
+  return REG_SEG_BASE * ((1u << k) - 1u);
+}
+
+/* Entries in segment k. The last segment is trimmed to REG_MAX_IDS so the
+ * directory never allocates entries no handle could name. */
+static inline uint32_t reg_seg_len(uint32_t k) {
+  uint32_t len = REG_SEG_BASE << k;
+  uint32_t room = REG_MAX_IDS - reg_seg_first(k);
+  return len < room ? len : room;
+}
+
+/* Segment holding an ID: floor(log2(id + REG_SEG_BASE)) - REG_SEG_BASE_SHIFT.
+ * One clz, no loop. id must be < REG_MAX_IDS. */
+static inline uint32_t reg_seg_index(uint32_t id) {
+  return 31u - (uint32_t)__builtin_clz(id + REG_SEG_BASE) - REG_SEG_BASE_SHIFT;
+}
+
+/* Locate an ID's metadata (lock-free).
+ *
+ * Returns NULL if the ID is outside handle range or its segment has not been
+ * published yet. Acquire pairs with the release in reg_alloc_id(), so a
+ * reader that sees the segment also sees its zeroed contents.
+ */
+static inline SlabMeta* reg_meta(SlabRegistry* r, uint32_t id) {
+  if (id >= REG_MAX_IDS) return NULL;
+  uint32_t k = reg_seg_index(id);
+  SlabMeta* seg = atomic_load_explicit(&r->segs[k], memory_order_acquire);
+  if (!seg) return NULL;
+  return &seg[id - reg_seg_first(k)];
+}
+
+/* Allocate a slab_id from registry.
  *
  * Two-tier allocation:
- * 1. Reuse free IDs (currently unused, infrastructure exists for future)
- * 2. Bump allocate from next_id (simple, fast, no fragmentation)
+ * 1. Reuse a released ID (LIFO free list, generation kept: reg_free_id()
+ *    already bumped it, so handles from the previous owner stay invalid)
+ * 2. Bump allocate from next_id, installing the next segment when the
+ *    current one is exhausted (once per doubling)
  *
- * Registry grows dynamically (starts at 1024, doubles on overflow).
- * Returns UINT32_MAX on allocation failure (out of memory for registry growth).
+ * Returns UINT32_MAX on failure: ID space exhausted (id_limit live IDs,
+ * REG_MAX_IDS unless the allocator is a group shard) or out of memory for
+ * a new segment.
  *
  * Concurrency: Protected by registry lock (cold path, allocation only).
+ * Readers never take the lock; they see a segment only after its release.
  */
 static uint32_t reg_alloc_id(SlabRegistry* r) {
   LOCK_WITHOUT_PROBE(&r->lock, LOCK_RANK_REGISTRY, "registry.lock");
   
-  uint32_t id;
-  if (r->free_count > 0) {
-    /* Try free list first (currently always empty, reserved for future) */
-    id = r->free_ids[--r->free_count];
+  uint32_t id = r->free_head;
+  SlabMeta* m;
+  if (id != REG_ID_NONE) {
+    /* Recycle: pop the free list */
+    m = reg_meta(r, id);
+    r->free_head = m->next_free;
+    m->next_free = REG_ID_NONE;
+    atomic_fetch_sub_explicit(&r->free_count, 1u, memory_order_relaxed);
+    atomic_fetch_add_explicit(&r->ids_recycled, 1u, memory_order_relaxed);
   } else {
     /* Bump allocate: monotonically increasing IDs */
-    id = r->next_id++;
-  }
-  
-  /* Check if registry needs to grow to accommodate this ID */
-  if (id >= r->cap) {
-    /* Exponential growth: start at 1024, double each time.
-     * Example: 1024 → 2048 → 4096 → 8192 → ...
-     * Max 4M slabs (22-bit slab_id in handle encoding). */
-    uint32_t new_cap = r->cap ? r->cap * 2 : 1024;
-    while (new_cap <= id) new_cap *= 2;  /* Handle large jumps */
-    
-    /* Allocate new metadata array */
-    SlabMeta* nm = (SlabMeta*)calloc(new_cap, sizeof(SlabMeta));
-    if (!nm) {
+    id = atomic_load_explicit(&r->next_id, memory_order_relaxed);
+    if (id >= r->id_limit) {
       UNLOCK_WITH_RANK(&r->lock);
-      return UINT32_MAX;  /* Out of memory */
+      return UINT32_MAX;  /* Every ID a handle can encode is live */
     }
     
-    /* Copy existing metadata (preserve generation counters and pointers) */
-    for (uint32_t i = 0; i < r->cap; i++) {
-      nm[i] = r->metas[i];
+    uint32_t k = reg_seg_index(id);
+    SlabMeta* seg = atomic_load_explicit(&r->segs[k], memory_order_relaxed);
+    if (!seg) {
+      /* Grow: new segment, existing ones stay where they are */
+      seg = (SlabMeta*)calloc(reg_seg_len(k), sizeof(SlabMeta));
+      if (!seg) {
+        UNLOCK_WITH_RANK(&r->lock);
+        return UINT32_MAX;  /* Out of memory */
+      }
+      atomic_store_explicit(&r->segs[k], seg, memory_order_release);
     }
-    free(r->metas);
-    r->metas = nm;
-    r->cap = new_cap;
+    atomic_store_explicit(&r->next_id, id + 1u, memory_order_relaxed);
     
-    /* Grow free_ids array to match (preserve existing free list) */
-    uint32_t* nf = (uint32_t*)calloc(new_cap, sizeof(uint32_t));
-    if (!nf) {
-      UNLOCK_WITH_RANK(&r->lock);
-      return UINT32_MAX;
-    }
-    for (size_t i = 0; i < r->free_count; i++) {
-      nf[i] = r->free_ids[i];
-    }
-    free(r->free_ids);
-    r->free_ids = nf;
+    /* Generation starts at 1 (0 reserved for NULL handle) */
+    m = &seg[id - reg_seg_first(k)];
+    m->next_free = REG_ID_NONE;
+    atomic_store_explicit(&m->gen, 1u, memory_order_relaxed);
   }
   
-  /* Initialize metadata for new ID.
-   * Generation starts at 1 (0 reserved for NULL handle).
-   * Pointer starts NULL (set later via reg_set_ptr). */
-  atomic_store_explicit(&r->metas[id].gen, 1u, memory_order_relaxed);
-  atomic_store_explicit(&r->metas[id].ptr, NULL, memory_order_relaxed);
+  /* Pointer starts NULL (set later via reg_set_ptr) */
+  atomic_store_explicit(&m->ptr, NULL, memory_order_relaxed);
   
   UNLOCK_WITH_RANK(&r->lock);
   return id;
 }
 
+/* Return a slab_id to the registry for reuse.
+ *
+ * Unpublishes the pointer and bumps the generation first, so every handle
+ * minted under this ID fails validation from here on, whichever slab the ID
+ * is handed to next. The generation then keeps counting across owners: an
+ * ID's 24-bit budget is shared by all slabs that ever hold it.
+ *
+ * Caller must guarantee no thread can still mint handles from the slab
+ * (i.e. it was never reachable through current_partial).
+ */
+static void reg_free_id(SlabRegistry* r, uint32_t id) {
+  SlabMeta* m = reg_meta(r, id);
+  if (!m) return;
+  
+  atomic_store_explicit(&m->ptr, NULL, memory_order_release);
+  atomic_fetch_add_explicit(&m->gen, 1u, memory_order_relaxed);
+  
+  LOCK_WITHOUT_PROBE(&r->lock, LOCK_RANK_REGISTRY, "registry.lock");
+  m->next_free = r->free_head;
+  r->free_head = id;
+  atomic_fetch_add_explicit(&r->free_count, 1u, memory_order_relaxed);
+  UNLOCK_WITH_RANK(&r->lock);
+}
+
 /* Publish slab pointer in registry.
  *
  * Makes slab findable via handle lookup (used in free_obj validation).
@@ -433,11 +1079,20 @@ static uint32_t reg_alloc_id(SlabRegistry* r) {
  * Called after slab creation (new mmap) or reinitialization (cache hit).
  */
 static void reg_set_ptr(SlabRegistry* r, uint32_t id, Slab* s) {
-  if (id < r->cap) {
-    atomic_store_explicit(&r->metas[id].ptr, s, memory_order_release);
+  SlabMeta* m = reg_meta(r, id);
+  if (m) {
+    atomic_store_explicit(&m->ptr, s, memory_order_release);
   }
 }
 
+/* Truncate a raw generation to handle width. After 16M reuses (2^24) the
+ * value wraps to 0; we skip 0 and use 1 instead since 0 is reserved for
+ * NULL handle. */
+static inline uint32_t reg_gen_trunc(uint32_t g) {
+  uint32_t g24 = g & ((1u << HANDLE_GEN_BITS) - 1u);
+  return g24 ? g24 : 1u;
+}
+
 /* Bump generation on slab reuse (ABA protection).
  *
  * Increments generation counter to invalidate old handles pointing to this slab.
@@ -461,17 +1116,12 @@ static void reg_set_ptr(SlabRegistry* r, uint32_t id, Slab* s) {
  * the ptr (release/acquire) handshake, not gen ordering.
  */
 static uint32_t reg_bump_gen(SlabRegistry* r, uint32_t id) {
-  if (id >= r->cap) return 0;
+  SlabMeta* m = reg_meta(r, id);
+  if (!m) return 0;
   
   /* Atomically increment and get new value */
-  uint32_t g = atomic_fetch_add_explicit(&r->metas[id].gen, 1u, memory_order_relaxed) + 1u;
-  
-  /* Truncate to 24 bits for handle encoding.
-   * After 16M reuses (2^24), generation wraps to 0. We skip 0 and use 1 instead
-   * since 0 is reserved for NULL handle. */
-  uint32_t g24 = g & 0xFFFFFFu;
-  if (g24 == 0) g24 = 1;
-  return g24;
+  uint32_t g = atomic_fetch_add_explicit(&m->gen, 1u, memory_order_relaxed) + 1u;
+  return reg_gen_trunc(g);
 }
 
 /* Get current generation for handle encoding.
@@ -480,12 +1130,10 @@ static uint32_t reg_bump_gen(SlabRegistry* r, uint32_t id) {
  * Acquire ordering ensures we see the generation that was current when ptr was published.
  */
 static uint32_t reg_get_gen24(SlabRegistry* r, uint32_t id) {
-  if (id >= r->cap) return 0;
+  SlabMeta* m = reg_meta(r, id);
+  if (!m) return 0;
   
-  uint32_t g = atomic_load_explicit(&r->metas[id].gen, memory_order_acquire);
-  uint32_t g24 = g & 0xFFFFFFu;  /* Truncate to 24 bits */
-  if (g24 == 0) g24 = 1;         /* Skip 0 (reserved for NULL) */
-  return g24;
+  return reg_gen_trunc(atomic_load_explicit(&m->gen, memory_order_acquire));
 }
 
 /* Lookup and validate slab by handle (returns NULL if invalid).
@@ -496,26 +1144,28 @@ static uint32_t reg_get_gen24(SlabRegistry* r, uint32_t id) {
  * 3. Compare handle generation with current generation
  *
  * Failure modes (all return NULL, safe):
- * - id out of bounds: Invalid handle (corrupted or wrong allocator)
- * - ptr is NULL: Slab not yet published or already recycled
+ * - id out of range or segment unpublished: Invalid handle (corrupted or wrong allocator)
+ * - ptr is NULL: Slab not yet published, or its ID was released to the free list
  * - gen mismatch: Stale handle from old incarnation (ABA detected)
  *
- * Safety invariant: Slabs are never unmapped (only madvised).
- * If ptr is non-NULL, the virtual mapping is valid—safe to dereference after validation.
+ * Safety invariant: Slabs are never unmapped (only madvised), and registry
+ * segments never move. If ptr is non-NULL, the virtual mapping is valid—safe
+ * to dereference after validation. No lock: growth only publishes new segments.
  *
  * Spurious failures are safe:
  * If we observe new ptr but old gen (or vice versa) due to independent atomics,
  * validation fails and returns NULL early. Caller retries or treats as invalid.
  */
 Slab* reg_lookup_validate(SlabRegistry* r, uint32_t id, uint32_t gen24) {
-  if (id >= r->cap) return NULL;  /* Out of bounds */
+  SlabMeta* m = reg_meta(r, id);
+  if (!m) return NULL;  /* Out of bounds */
   
   /* Step 1: Load ptr with acquire (synchronizes with reg_set_ptr release) */
-  Slab* s = atomic_load_explicit(&r->metas[id].ptr, memory_order_acquire);
+  Slab* s = atomic_load_explicit(&m->ptr, memory_order_acquire);
   if (!s) return NULL;  /* Not published yet or NULL-ed during recycling */
   
   /* Step 2: Load current generation with acquire */
-  uint32_t cur = reg_get_gen24(r, id);
+  uint32_t cur = reg_gen_trunc(atomic_load_explicit(&m->gen, memory_order_acquire));
   
   /* Step 3: Validate generation from handle matches current generation */
   if (cur != gen24) return NULL;  /* ABA detected: handle from old incarnation */
@@ -556,6 +1206,67 @@ static inline void list_remove(SlabList* l, Slab* s) {
   if (l->len > 0) l->len--;
 }
 
+/* Is s on es's list_id list? Call with sc->lock held.
+ *
+ * list_id alone does not say WHICH epoch's list: a thread can still hold a
+ * slab (published current_partial, or a handle validated just before) that
+ * epoch_close() recycled and new_slab() then handed to another epoch. */
+static inline bool slab_on_list_locked(SizeClassAlloc* sc, EpochState* es, const Slab* s,
+                                       uint32_t list_id) {
+  return s->list_id == list_id && get_epoch_state(sc, s->epoch_id) == es;
+}
+
+/* Park s on es->empty if every slot is free and no current_partial slot
+ * publishes it (caller holds sc->lock). A published slab stays on partial
+ * because the fast path may refill it without the lock; it is parked when
+ * its slot lets go of it. Returns true if s moved. */
+static bool slab_park_empty_locked(SizeClassAlloc* sc, EpochState* es, Slab* s) {
+  if (s->list_id != SLAB_LIST_PARTIAL && s->list_id != SLAB_LIST_FULL) return false;
+  if (get_epoch_state(sc, s->epoch_id) != es) return false;
+  if (slab_free_slots(s) != s->object_count) return false;
+  if (slab_claimed_by_other_slot(es, s, UINT32_MAX)) return false;
+  list_remove(s->list_id == SLAB_LIST_FULL ? &es->full : &es->partial, s);
+  s->list_id = SLAB_LIST_EMPTY;
+  list_push_back(&es->empty, s);
+  return true;
+}
+
+/* Move a parked slab back to partial for the slow path (caller holds
+ * sc->lock). A stale fast-path claim can refill a parked slab; any left
+ * without a free slot goes to full instead. Returns NULL if none is left. */
+static Slab* slab_unpark_locked(EpochState* es) {
+  Slab* s;
+  while ((s = es->empty.head) != NULL) {
+    list_remove(&es->empty, s);
+    if (slab_free_slots(s) == 0) {
+      s->list_id = SLAB_LIST_FULL;
+      list_push_back(&es->full, s);
+      continue;
+    }
+    s->list_id = SLAB_LIST_PARTIAL;
+    list_push_back(&es->partial, s);
+    return s;
+  }
+  return NULL;
+}
+
+/* Publish s in slot cp (caller holds sc->lock), parking the slab it
+ * replaces if that one went empty while published. */
+static inline void percpu_publish_locked(SizeClassAlloc* sc, EpochState* es,
+                                         _Atomic(Slab*)* cp, Slab* s) {
+  Slab* old = atomic_exchange_explicit(cp, s, memory_order_seq_cst);  /* See slab_pin_published() */
+  if (old && old != s) (void)slab_park_empty_locked(sc, es, old);
+}
+
+/* percpu_clear_all() under sc->lock, parking slabs that went empty while
+ * published so epoch_close() finds them on the empty list. */
+static void percpu_clear_all_locked(SizeClassAlloc* sc, EpochState* es) {
+  for (uint32_t i = 0; i < SLAB_PERCPU_SLOTS; i++) {
+    Slab* old = atomic_exchange_explicit(&es->current_partial[i], NULL, memory_order_seq_cst);
+    if (old) (void)slab_park_empty_locked(sc, es, old);
+  }
+}
+
 /* ------------------------------ Slab helper functions ------------------------------ */
 
 static inline size_t slab_header_size(void) {
@@ -571,24 +1282,35 @@ static inline _Atomic uint32_t* slab_bitmap_ptr(Slab* s) {
   return (_Atomic uint32_t*)((uint8_t*)s + slab_header_size());
 }
 
+/* Slot 0 starts SLAB_DATA_ALIGN-aligned after the bitmap. Object sizes are
+ * multiples of 16 in every default class, so all slots inherit malloc's
+ * alignment guarantee (max_align_t), not just whatever the bitmap length
+ * leaves (68 bytes in: 4-byte aligned). */
+#define SLAB_DATA_ALIGN 16u
+
+static inline size_t slab_bitmap_bytes(uint32_t words) {
+  return ((size_t)words * 4u + (SLAB_DATA_ALIGN - 1u)) & ~(size_t)(SLAB_DATA_ALIGN - 1u);
+}
+
 static inline uint8_t* slab_data_ptr(Slab* s) {
   uint32_t words = slab_bitmap_words(s->object_count);
-  return (uint8_t*)slab_bitmap_ptr(s) + ((size_t)words * 4u);
+  return (uint8_t*)slab_bitmap_ptr(s) + slab_bitmap_bytes(words);
 }
 
 inline void* slab_slot_ptr(Slab* s, uint32_t slot_index) {
   return (void*)(slab_data_ptr(s) + ((size_t)slot_index * (size_t)s->object_size));
 }
 
-uint32_t slab_object_count(uint32_t obj_size) {
+/* Objects that fit in a slab of slab_bytes (header + bitmap + slots). */
+static uint32_t slab_object_count_in(uint32_t obj_size, size_t slab_bytes) {
   const size_t hdr = slab_header_size();
-  size_t available = SLAB_PAGE_SIZE - hdr;
+  size_t available = slab_bytes - hdr;
   uint32_t count = (uint32_t)(available / obj_size);
   if (count == 0) return 0;
 
   for (int iter = 0; iter < 8; iter++) {
     uint32_t words = (count + 31u) / 32u;
-    size_t bitmap_bytes = (size_t)words * 4u;
+    size_t bitmap_bytes = slab_bitmap_bytes(words);
     if (bitmap_bytes > available) return 0;
     size_t data_bytes = available - bitmap_bytes;
     uint32_t new_count = (uint32_t)(data_bytes / obj_size);
@@ -599,57 +1321,460 @@ uint32_t slab_object_count(uint32_t obj_size) {
   return count;
 }
 
-/* ------------------------------ mmap ------------------------------ */
+/* Slab size for an object size (large-object tier).
+ *
+ * Small classes stay on one page as long as SLAB_SMALL_MIN_OBJECTS fit
+ * (up to 768B: 5 objects per 4KB page). Beyond that a single page wastes
+ * 25%+ to tail slack, so the slab grows to the smallest power-of-two page
+ * multiple that holds SLAB_LARGE_TARGET_OBJECTS objects:
+ *
+ *   1KB → 16KB (15 objs)   1.5KB → 32KB (21)   2KB → 32KB (15)
+ *   4KB → 64KB (15)        8KB → 128KB (15)    16KB → 256KB (15)
+ *
+ * Power of two so that slabs carved back to back from an arena aligned
+ * to SLAB_ARENA_SIZE are naturally aligned to their own size.
+ * Capped at SLAB_ARENA_SIZE (a slab never spans arenas).
+ */
+#define SLAB_SMALL_MIN_OBJECTS     4u
+#define SLAB_LARGE_TARGET_OBJECTS 16u
 
-static void* map_one_page(void) {
-  void* p = mmap(NULL, SLAB_PAGE_SIZE,
-                 PROT_READ | PROT_WRITE,
-                 MAP_PRIVATE | MAP_ANONYMOUS,
-                 -1, 0);
-  if (p == MAP_FAILED) return NULL;
+static size_t slab_bytes_for_size(uint32_t obj_size) {
+  size_t bytes = SLAB_PAGE_SIZE;
+  if (slab_object_count_in(obj_size, bytes) >= SLAB_SMALL_MIN_OBJECTS) return bytes;
 
-  if (((uintptr_t)p & (SLAB_PAGE_SIZE - 1u)) != 0u) {
-    munmap(p, SLAB_PAGE_SIZE);
-    errno = EINVAL;
-    return NULL;
-  }
-  return p;
+  size_t want = (size_t)obj_size * SLAB_LARGE_TARGET_OBJECTS;
+  while (bytes < want && bytes < SLAB_ARENA_SIZE) bytes <<= 1;
+  return bytes;
 }
 
-static void unmap_one_page(void* p) {
-  if (p) munmap(p, SLAB_PAGE_SIZE);
+uint32_t slab_object_count(uint32_t obj_size) {
+  if (obj_size == 0) return 0;
+  return slab_object_count_in(obj_size, slab_bytes_for_size(obj_size));
 }
 
-/* ------------------------------ Atomic bitmap ops ------------------------------ */
+/* ------------------------------ NUMA topology ------------------------------ */
 
-/*
-  Returns slot index (0..object_count-1) on success, UINT32_MAX on failure.
-  If out_prev_fc is non-NULL, stores previous free_count (for transition detection).
-  If out_retries is non-NULL, stores CAS retry count (for contention tracking).
-*/
-/* Helper: compute the "full" bitmask for a given word in the allocation bitmap.
- * 
- * For all words except possibly the last, a full word is 0xFFFFFFFF (all 32 bits set).
- * For the last word, only (object_count % 32) bits are valid; higher bits are unused.
- * 
- * CRITICAL: Handles edge case where object_count % 32 == 0 (all 32 bits valid).
- * Without this, (1u << 32) would be undefined behavior, and (1u << 0) - 1 == 0
- * would incorrectly treat an empty word (0x00000000) as "full".
+/* Number of NUMA nodes to keep slab pools for.
+ *
+ * Parses /sys/devices/system/node/possible ("0", "0-1", "0,2-3"): highest
+ * node id + 1, capped at SLAB_MAX_NUMA_NODES. 1 if unavailable or non-Linux.
  */
-static inline uint32_t full_mask_for_word(uint32_t obj_count, uint32_t w, uint32_t words) {
-  if (w != words - 1u) return 0xFFFFFFFFu;  /* Not last word: all 32 bits valid */
-  uint32_t rem = obj_count & 31u;            /* obj_count % 32 */
-  if (rem == 0u) return 0xFFFFFFFFu;         /* Last word uses all 32 bits */
-  return (1u << rem) - 1u;                   /* Last word uses only 'rem' bits */
+static uint32_t numa_detect_nodes(void) {
+#if defined(__linux__)
+  FILE* f = fopen("/sys/devices/system/node/possible", "r");
+  if (!f) return 1;
+  char buf[128];
+  uint32_t max_id = 0;
+  if (fgets(buf, sizeof(buf), f)) {
+    uint32_t cur = 0;
+    bool in_num = false;
+    for (char* p = buf; ; p++) {
+      if (*p >= '0' && *p <= '9') {
+        cur = cur * 10u + (uint32_t)(*p - '0');
+        in_num = true;
+      } else {
+        if (in_num && cur > max_id) max_id = cur;
+        cur = 0;
+        in_num = false;
+        if (*p == '\0') break;
+      }
+    }
+  }
+  fclose(f);
+  uint32_t n = max_id + 1u;
+  return n > SLAB_MAX_NUMA_NODES ? SLAB_MAX_NUMA_NODES : n;
+#else
+  return 1;
+#endif
 }
 
-/* Lock-free bitmap allocation: find and mark first free slot.
- *
- * Returns slot index on success, UINT32_MAX if slab is full.
- * Outputs previous free_count (for transition detection) and retry count (for contention tracking).
- *
- * Scans bitmap word-by-word looking for a zero bit (free slot).
- * Uses atomic CAS to claim the slot without holding a lock.
+/* NUMA node of the calling thread, folded into [0, a->numa_nodes).
+ * getcpu() is a vDSO call (~20ns); only reached on slow paths and only when
+ * the host actually has more than one node. */
+static inline uint32_t numa_current_node(const SlabAllocator* a) {
+  if (a->numa_nodes <= 1) return 0;
+#if defined(__linux__)
+  unsigned cpu = 0, node = 0;
+  if (getcpu(&cpu, &node) == 0) return node % a->numa_nodes;
+#endif
+  return 0;
+}
+
+/* Prefer node for an arena's pages (mbind MPOL_PREFERRED).
+ * Raw syscall so we don't depend on libnuma/numaif.h. */
+static void numa_bind_region(SlabNodePool* pool, void* base, size_t len, uint32_t node) {
+#if ENABLE_NUMA_BIND && defined(__linux__) && defined(SYS_mbind)
+  const int mpol_preferred = 1;  /* MPOL_PREFERRED from <linux/mempolicy.h> */
+  unsigned long mask = 1ul << node;
+  if (syscall(SYS_mbind, base, len, mpol_preferred, &mask, (unsigned long)(sizeof(mask) * 8u), 0u) != 0) {
+    atomic_fetch_add_explicit(&pool->bind_failures, 1, memory_order_relaxed);
+  }
+#else
+  (void)pool; (void)base; (void)len; (void)node;
+#endif
+}
+
+/* ------------------------------ Page geometry ------------------------------ */
+
+/* OS page size: 4KB on x86-64, 16KB on Apple silicon, 4KB or 64KB on arm64
+ * depending on the kernel. Slab sizes never follow it, only page return
+ * does (SizeClassAlloc.release_bytes). */
+static uint32_t os_page_size(void) {
+  long page = sysconf(_SC_PAGESIZE);
+  return page > 0 ? (uint32_t)page : SLAB_PAGE_SIZE;
+}
+
+/* Transparent huge page size to back arenas with (hugepage_slabs), or 0.
+ * THP must not be disabled, and a huge page must tile an arena: the 2MB
+ * PMD of x86-64 and 4KB-page arm64 does, the 512MB one of 64KB-page arm64
+ * does not. */
+static uint32_t hugepage_detect(uint32_t page) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  char buf[64];
+  FILE* f = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+  if (!f) return 0;
+  bool never = fgets(buf, sizeof(buf), f) && strstr(buf, "[never]");
+  fclose(f);
+  if (never) return 0;
+  unsigned long size = 0;
+  f = fopen("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r");
+  if (!f) return 0;
+  if (fscanf(f, "%lu", &size) != 1) size = 0;
+  fclose(f);
+  if (size <= page || size > SLAB_ARENA_SIZE || (size & (size - 1u)) != 0) return 0;
+  return (uint32_t)size;
+#else
+  (void)page;
+  return 0;
+#endif
+}
+
+/* ------------------------------ Arena reservation ------------------------------ */
+
+/* Reserve one SLAB_ARENA_SIZE region aligned to its own size.
+ *
+ * mmap() only guarantees page alignment, so we over-reserve by one arena and
+ * trim the misaligned head and tail. Alignment keeps every slab inside a
+ * single naturally aligned region, which lets later code map an address back
+ * to its arena with a mask instead of a search.
+ *
+ * MAP_NORESERVE: no swap/overcommit accounting for the uncarved remainder.
+ * Physical pages are committed lazily on first touch (slab header init).
+ */
+static void* arena_reserve_region(void) {
+  size_t span = (size_t)SLAB_ARENA_SIZE * 2u;
+  uint8_t* raw = (uint8_t*)mmap(NULL, span,
+                                PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                                -1, 0);
+  if (raw == MAP_FAILED) return NULL;
+
+  uintptr_t addr = (uintptr_t)raw;
+  uintptr_t aligned = (addr + (SLAB_ARENA_SIZE - 1u)) & ~(uintptr_t)(SLAB_ARENA_SIZE - 1u);
+  size_t head = (size_t)(aligned - addr);
+  size_t tail = span - head - SLAB_ARENA_SIZE;
+
+  if (head) munmap(raw, head);
+  if (tail) munmap((uint8_t*)aligned + SLAB_ARENA_SIZE, tail);
+  return (void*)aligned;
+}
+
+/* Back a fresh arena with transparent huge pages (hugepage_slabs). Done
+ * before any slab is carved, so the first fault in each huge-page-aligned
+ * block can take a whole huge page. Failure leaves 4KB pages; the class
+ * still returns memory per huge-page unit. */
+static void arena_advise_hugepage(SizeClassAlloc* sc, void* base) {
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+  if (madvise(base, SLAB_ARENA_SIZE, MADV_HUGEPAGE) == 0) {
+    atomic_fetch_add_explicit(&sc->hugepage_arenas, 1, memory_order_relaxed);
+  }
+#else
+  (void)sc; (void)base;
+#endif
+}
+
+/* Record an arena region in the allocator's ownership map.
+ *
+ * Levels are installed with CAS so arenas of different classes and nodes
+ * (different arena_locks) can be recorded concurrently. Returns false if a
+ * level can't be allocated or the region is outside ARENA_MAP_VA_BITS; the
+ * caller then gives the region back, since slab_owns() must never miss.
+ */
+static bool arena_map_mark(SlabAllocator* a, const void* base) {
+  const uintptr_t idx = (uintptr_t)base >> ARENA_MAP_SHIFT;
+  if (((uintptr_t)base >> ARENA_MAP_VA_BITS) != 0) return false;
+  const uintptr_t top_i = idx >> ARENA_MAP_LEAF_BITS;
+  const uintptr_t bit = idx & ((1u << ARENA_MAP_LEAF_BITS) - 1u);
+
+  _Atomic(_Atomic uint64_t*)* top = atomic_load_explicit(&a->arena_map, memory_order_acquire);
+  if (!top) {
+    _Atomic(_Atomic uint64_t*)* fresh = calloc(ARENA_MAP_TOP, sizeof(*fresh));
+    if (!fresh) return false;
+    if (atomic_compare_exchange_strong_explicit(&a->arena_map, &top, fresh,
+                                                memory_order_acq_rel, memory_order_acquire)) {
+      top = fresh;
+    } else {
+      free(fresh);  /* Lost the race: top now holds the winner */
+    }
+  }
+
+  _Atomic uint64_t* leaf = atomic_load_explicit(&top[top_i], memory_order_acquire);
+  if (!leaf) {
+    _Atomic uint64_t* fresh = calloc((1u << ARENA_MAP_LEAF_BITS) / 64u, sizeof(*fresh));
+    if (!fresh) return false;
+    if (atomic_compare_exchange_strong_explicit(&top[top_i], &leaf, fresh,
+                                                memory_order_acq_rel, memory_order_acquire)) {
+      leaf = fresh;
+    } else {
+      free(fresh);
+    }
+  }
+
+  atomic_fetch_or_explicit(&leaf[bit / 64u], 1ull << (bit % 64u), memory_order_release);
+  return true;
+}
+
+/* Does ptr lie inside one of this allocator's arenas? (lock-free) */
+bool slab_owns(SlabAllocator* a, const void* ptr) {
+  const uintptr_t addr = (uintptr_t)ptr;
+  if ((addr >> ARENA_MAP_VA_BITS) != 0) return false;
+  _Atomic(_Atomic uint64_t*)* top = atomic_load_explicit(&a->arena_map, memory_order_acquire);
+  if (!top) return false;
+  const uintptr_t idx = addr >> ARENA_MAP_SHIFT;
+  _Atomic uint64_t* leaf = atomic_load_explicit(&top[idx >> ARENA_MAP_LEAF_BITS], memory_order_acquire);
+  if (!leaf) return false;
+  const uintptr_t bit = idx & ((1u << ARENA_MAP_LEAF_BITS) - 1u);
+  return (atomic_load_explicit(&leaf[bit / 64u], memory_order_acquire) >> (bit % 64u)) & 1u;
+}
+
+/* Carve one slab from a node pool's current arena.
+ *
+ * Fast case is a bump of carved_bytes under arena_lock (~20ns).
+ * When the head arena is exhausted, reserve a new one (bound to the pool's
+ * node on multi-node hosts) and push it on the list. Each arena brings the
+ * off-page cache nodes for every slab it can hold, registered in the pool's
+ * ordinal directory, so recycling never allocates.
+ * Older arenas are never revisited: freed slabs come back through the slab
+ * cache, not the arena, so the bump offset only ever moves forward.
+ *
+ * Returns NULL with errno=ENOMEM if the reservation fails or the pool's
+ * directory is full (SLAB_ARENA_MAX_ORDS arenas). *out_ord receives the
+ * arena ordinal on success.
+ *
+ * Concurrency: Takes pool->arena_lock (rank 25). Caller must not hold sc->lock.
+ */
+static void* arena_carve_slab(SlabAllocator* a, SizeClassAlloc* sc, uint32_t node, uint16_t* out_ord) {
+  const size_t slab_bytes = sc->slab_bytes;
+  SlabNodePool* pool = &sc->pools[node];
+
+  LOCK_WITHOUT_PROBE(&pool->arena_lock, LOCK_RANK_ARENA, "pool->arena_lock");
+
+  SlabArena* ar = pool->arenas;
+  if (!ar || ar->reserved_bytes - ar->carved_bytes < slab_bytes) {
+    /* Head arena exhausted (or none yet): reserve a fresh region */
+    const uint32_t ord = pool->arena_ords;
+    SlabArena** block = NULL;
+    SlabArena* fresh = NULL;
+    CachedSlab* nodes = NULL;
+    void* base = NULL;
+    if (ord < SLAB_ARENA_MAX_ORDS) {
+      block = pool->arena_dir[ord / SLAB_ARENA_DIR_BLOCK];
+      if (!block) {
+        block = (SlabArena**)calloc(SLAB_ARENA_DIR_BLOCK, sizeof(SlabArena*));
+        pool->arena_dir[ord / SLAB_ARENA_DIR_BLOCK] = block;
+      }
+      fresh = (SlabArena*)malloc(sizeof(SlabArena));
+      nodes = (CachedSlab*)calloc(SLAB_ARENA_SIZE / slab_bytes, sizeof(CachedSlab));
+      if (block && fresh && nodes) base = arena_reserve_region();
+      if (base && !arena_map_mark(a, base)) {
+        munmap(base, SLAB_ARENA_SIZE);
+        base = NULL;
+      }
+    }
+    if (!base) {
+      free(nodes);
+      free(fresh);  /* Directory block (if any) stays for the next attempt */
+      UNLOCK_WITH_RANK(&pool->arena_lock);
+      errno = ENOMEM;
+      return NULL;
+    }
+    if (a->numa_nodes > 1) {
+      numa_bind_region(pool, base, SLAB_ARENA_SIZE, node);
+    }
+    if (a->hugepage_bytes) arena_advise_hugepage(sc, base);
+    for (size_t i = 0; i < SLAB_ARENA_SIZE / slab_bytes; i++) {
+      nodes[i].slab = (Slab*)((uint8_t*)base + i * slab_bytes);
+      atomic_store_explicit(&nodes[i].next, SLAB_CACHE_NIL, memory_order_relaxed);
+      nodes[i].arena_ord = (uint16_t)ord;
+    }
+    fresh->base = (uint8_t*)base;
+    fresh->reserved_bytes = SLAB_ARENA_SIZE;
+    fresh->carved_bytes = 0;
+    fresh->nodes = nodes;
+    fresh->next = pool->arenas;
+    pool->arenas = fresh;
+    block[ord % SLAB_ARENA_DIR_BLOCK] = fresh;
+    pool->arena_ords = ord + 1u;
+    ar = fresh;
+
+    atomic_fetch_add_explicit(&sc->arena_count, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&sc->arena_reserved_bytes, SLAB_ARENA_SIZE, memory_order_relaxed);
+  }
+
+  void* p = ar->base + ar->carved_bytes;
+  ar->carved_bytes += slab_bytes;
+  *out_ord = ar->nodes[0].arena_ord;
+  atomic_fetch_add_explicit(&sc->arena_committed_bytes, slab_bytes, memory_order_relaxed);
+  atomic_fetch_add_explicit(&pool->slabs_carved, 1, memory_order_relaxed);
+
+  UNLOCK_WITH_RANK(&pool->arena_lock);
+  return p;
+}
+
+/* Give back a slab carved by arena_carve_slab() that was never used.
+ *
+ * Only the most recently carved slab of the pool's head arena can be
+ * un-carved (bump allocators can't fill holes). Anything else stays carved
+ * but idle until allocator_destroy() unmaps the region. Error paths only.
+ */
+static void arena_uncarve_slab(SizeClassAlloc* sc, uint32_t node, void* p) {
+  const size_t slab_bytes = sc->slab_bytes;
+  SlabNodePool* pool = &sc->pools[node];
+
+  LOCK_WITHOUT_PROBE(&pool->arena_lock, LOCK_RANK_ARENA, "pool->arena_lock");
+  SlabArena* ar = pool->arenas;
+  if (ar && ar->carved_bytes >= slab_bytes &&
+      (uint8_t*)p == ar->base + ar->carved_bytes - slab_bytes) {
+    ar->carved_bytes -= slab_bytes;
+    atomic_fetch_sub_explicit(&sc->arena_committed_bytes, slab_bytes, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&pool->slabs_carved, 1, memory_order_relaxed);
+  }
+  UNLOCK_WITH_RANK(&pool->arena_lock);
+}
+
+/* Unmap every arena region of a size class, all nodes, along with their
+ * cache nodes and directories (allocator_destroy only). */
+static void arena_release_all(SizeClassAlloc* sc, uint32_t nodes) {
+  for (uint32_t n = 0; n < nodes; n++) {
+    SlabNodePool* pool = &sc->pools[n];
+    SlabArena* ar = pool->arenas;
+    while (ar) {
+      SlabArena* next = ar->next;
+      munmap(ar->base, ar->reserved_bytes);
+      free(ar->nodes);
+      free(ar);
+      ar = next;
+    }
+    pool->arenas = NULL;
+    for (uint32_t b = 0; b < SLAB_ARENA_DIR_BLOCKS; b++) {
+      free(pool->arena_dir[b]);
+      pool->arena_dir[b] = NULL;
+    }
+    pool->arena_ords = 0;
+  }
+  atomic_store_explicit(&sc->arena_count, 0, memory_order_relaxed);
+  atomic_store_explicit(&sc->arena_reserved_bytes, 0, memory_order_relaxed);
+  atomic_store_explicit(&sc->arena_committed_bytes, 0, memory_order_relaxed);
+}
+
+/* ------------------------------ Atomic bitmap ops ------------------------------ */
+
+/*
+  Returns slot index (0..object_count-1) on success, UINT32_MAX on failure.
+  If out_prev_fc is non-NULL, stores previous free_count (for transition detection).
+  If out_retries is non-NULL, stores CAS retry count (for contention tracking).
+*/
+/* Helper: compute the "full" bitmask for a given word in the allocation bitmap.
+ * 
+ * For all words except possibly the last, a full word is 0xFFFFFFFF (all 32 bits set).
+ * For the last word, only (object_count % 32) bits are valid; higher bits are unused.
+ * 
+ * CRITICAL: Handles edge case where object_count % 32 == 0 (all 32 bits valid).
+ * Without this, (1u << 32) would be undefined behavior, and (1u << 0) - 1 == 0
+ * would incorrectly treat an empty word (0x00000000) as "full".
+ */
+static inline uint32_t full_mask_for_word(uint32_t obj_count, uint32_t w, uint32_t words) {
+  if (w != words - 1u) return 0xFFFFFFFFu;  /* Not last word: all 32 bits valid */
+  uint32_t rem = obj_count & 31u;            /* obj_count % 32 */
+  if (rem == 0u) return 0xFFFFFFFFu;         /* Last word uses all 32 bits */
+  return (1u << rem) - 1u;                   /* Last word uses only 'rem' bits */
+}
+
+_Static_assert(SLAB_BITMAP_MAX_WORDS <= 8u, "bitmap free-word mask is built for at most 8 words");
+_Static_assert(SLAB_DATA_ALIGN % 16u == 0u, "vector scan loads whole 16-byte chunks of the padded bitmap");
+
+/* Summary of s's bitmap: bit w set iff word w has a free valid bit.
+ *
+ * One vector compare of the whole bitmap against all-ones (it is at most
+ * two 16-byte chunks, both inside the padding slab_bitmap_bytes() adds and
+ * 16-byte aligned behind the 64-byte header). Lanes past `words` are masked
+ * off. The last word's unused high bits are always 0, so it never compares
+ * equal to all-ones; one scalar check against full_mask_for_word() fixes
+ * that lane up.
+ *
+ * Plain (non-atomic) vector loads: the result is only a hint for which
+ * word to CAS, exactly like the relaxed load it replaces. */
+static inline uint32_t slab_bitmap_free_words(Slab* s, uint32_t words) {
+  _Atomic uint32_t* bm = slab_bitmap_ptr(s);
+  const uint32_t lanes = (1u << words) - 1u;  /* words <= 8 */
+  uint32_t full;
+
+#if SLAB_SIMD_SCAN && defined(__AVX2__)
+  if (words > 4u) {
+    __m256i v = _mm256_load_si256((const __m256i*)(const void*)bm);
+    full = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, _mm256_set1_epi32(-1))));
+  } else {
+    __m128i v = _mm_load_si128((const __m128i*)(const void*)bm);
+    full = (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, _mm_set1_epi32(-1))));
+  }
+#elif SLAB_SIMD_SCAN && defined(__SSE2__)
+  const __m128i ones = _mm_set1_epi32(-1);
+  __m128i v = _mm_load_si128((const __m128i*)(const void*)bm);
+  full = (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, ones)));
+  if (words > 4u) {
+    v = _mm_load_si128((const __m128i*)(const void*)(bm + 4));
+    full |= (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, ones))) << 4;
+  }
+#elif SLAB_SIMD_SCAN && defined(__aarch64__) && defined(__ARM_NEON)
+  static const uint32_t lane_bit[4] = {1u, 2u, 4u, 8u};
+  const uint32x4_t lb = vld1q_u32(lane_bit);
+  uint32x4_t eq = vceqq_u32(vld1q_u32((const uint32_t*)(const void*)bm), vdupq_n_u32(0xFFFFFFFFu));
+  full = vaddvq_u32(vandq_u32(eq, lb));
+  if (words > 4u) {
+    eq = vceqq_u32(vld1q_u32((const uint32_t*)(const void*)(bm + 4)), vdupq_n_u32(0xFFFFFFFFu));
+    full |= vaddvq_u32(vandq_u32(eq, lb)) << 4;
+  }
+#else
+  full = 0u;
+  for (uint32_t w = 0; w < words; w++) {
+    if (atomic_load_explicit(&bm[w], memory_order_relaxed) == 0xFFFFFFFFu) full |= 1u << w;
+  }
+#endif
+
+  uint32_t free_words = ~full & lanes;
+  const uint32_t last = words - 1u;
+  const uint32_t last_full = full_mask_for_word(s->object_count, last, words);
+  if (last_full != 0xFFFFFFFFu && (free_words >> last) & 1u &&
+      atomic_load_explicit(&bm[last], memory_order_relaxed) == last_full) {
+    free_words &= ~(1u << last);
+  }
+  return free_words;
+}
+
+/* Next word to try from a free-word mask: the first at or after start,
+ * wrapping around (same order as the old start_word..words loop). */
+static inline uint32_t free_words_next(uint32_t free_words, uint32_t start) {
+  uint32_t hi = free_words & ~((1u << start) - 1u);
+  return ctz32(hi ? hi : free_words);
+}
+
+/* Lock-free bitmap allocation: find and mark first free slot.
+ *
+ * Returns slot index on success, UINT32_MAX if slab is full.
+ * Outputs previous free_count (for transition detection) and retry count (for contention tracking).
+ *
+ * Scans bitmap word-by-word looking for a zero bit (free slot).
+ * Uses atomic CAS to claim the slot without holding a lock.
  * May retry if another thread claims the slot first (thundering herd).
  *
  * Adaptive scanning reduces retries under contention:
@@ -670,10 +1795,12 @@ static uint32_t slab_alloc_slot_atomic(Slab* s, SizeClassAlloc* sc, uint32_t* ou
     start_word = get_tls_scan_offset(words);  /* Hash thread ID, modulo words */
   }
   
-  /* Scan bitmap words starting from start_word, wrapping around.
-   * Example: If start_word=5 and words=8, scan order is 5,6,7,0,1,2,3,4 */
-  for (uint32_t i = 0; i < words; i++) {
-    uint32_t w = (start_word + i) % words;
+  /* Visit words that had a free bit, starting from start_word, wrapping around.
+   * Example: If start_word=5 and words=8, scan order is 5,6,7,0,1,2,3,4
+   * minus the words the summary already showed full. */
+  for (uint32_t cand = slab_bitmap_free_words(s, words); cand; ) {
+    uint32_t w = free_words_next(cand, start_word);
+    cand &= ~(1u << w);
     
     while (1) {  /* Retry loop in case of CAS failure */
       uint32_t x = atomic_load_explicit(&bm[w], memory_order_relaxed);
@@ -737,6 +1864,72 @@ static uint32_t slab_alloc_slot_atomic(Slab* s, SizeClassAlloc* sc, uint32_t* ou
   return UINT32_MAX;
 }
 
+/* Lock-free bitmap allocation, batched: claim up to want slots.
+ *
+ * Same scan order as slab_alloc_slot_atomic(), but each successful CAS sets
+ * every free bit it needs from the word at once (up to 32 slots per CAS),
+ * and free_count is adjusted with a single fetch_sub for the whole batch.
+ *
+ * Writes claimed slot indices to out_idx and returns how many were claimed
+ * (0 if the slab is full). *out_prev_fc is free_count before the batch:
+ * prev_fc == claimed means the batch took the last free slot (partial→full).
+ */
+static uint32_t slab_alloc_slots_atomic(Slab* s, SizeClassAlloc* sc, uint32_t want, uint32_t* out_idx,
+                                        uint32_t* out_prev_fc, uint32_t* out_retries) {
+  _Atomic uint32_t* bm = slab_bitmap_ptr(s);
+  const uint32_t words = slab_bitmap_words(s->object_count);
+  uint32_t retries = 0;
+  uint32_t got = 0;
+
+  uint32_t start_word = 0;
+  if (atomic_load_explicit(&sc->scan_adapt.mode, memory_order_relaxed) == 1) {
+    start_word = get_tls_scan_offset(words);
+  }
+
+  for (uint32_t cand = slab_bitmap_free_words(s, words); cand && got < want; ) {
+    uint32_t w = free_words_next(cand, start_word);
+    cand &= ~(1u << w);
+    uint32_t x = atomic_load_explicit(&bm[w], memory_order_relaxed);
+
+    for (;;) {
+      uint32_t free_mask = ~x & full_mask_for_word(s->object_count, w, words);
+      if (free_mask == 0u) break;  /* Word full (or no valid free bits) */
+
+      /* Take the lowest (want - got) free bits, or all of them */
+      uint32_t take = free_mask;
+      uint32_t need = want - got;
+      if (popcount32(free_mask) > need) {
+        take = 0u;
+        for (uint32_t k = 0; k < need; k++) {
+          uint32_t low = free_mask & (~free_mask + 1u);  /* Isolate lowest set bit */
+          take |= low;
+          free_mask &= ~low;
+        }
+      }
+
+      if (atomic_compare_exchange_weak_explicit(
+              &bm[w], &x, x | take,
+              memory_order_acq_rel,
+              memory_order_relaxed)) {
+        while (take) {
+          out_idx[got++] = w * 32u + ctz32(take);
+          take &= take - 1u;
+        }
+        break;
+      }
+      retries++;  /* x reloaded by failed CAS; recompute from fresh word */
+    }
+  }
+
+  uint32_t prev_fc = 0;
+  if (got > 0) {
+    prev_fc = atomic_fetch_sub_explicit(&s->free_count, got, memory_order_relaxed);
+  }
+  if (out_prev_fc) *out_prev_fc = prev_fc;
+  if (out_retries) *out_retries = retries;
+  return got;
+}
+
 /* Lock-free bitmap free: mark a slot as free.
  *
  * Returns true on success, false if slot was already free (double-free detection).
@@ -799,13 +1992,165 @@ static bool slab_free_slot_atomic(Slab* s, uint32_t idx, uint32_t* out_prev_fc,
   }
 }
 
+/* ------------------------------ Bump reserve ------------------------------ */
+
+/* Fresh-slab allocation: take the next slot of the bump reserve.
+ *
+ * A slab from new_slab() starts with every bitmap bit set and free_count 0,
+ * so to the bitmap code the whole reserve is "allocated" and nothing else
+ * needs to know about it. Claiming a slot is one uncontended fetch_add: no
+ * bitmap scan, no CAS retry loop, no free_count RMW. The relaxed pre-check
+ * keeps exhausted/retired slabs from incrementing bump_next forever.
+ *
+ * Returns the slot index, or UINT32_MAX if the reserve is exhausted or
+ * retired (caller falls back to slab_alloc_slot_atomic()). */
+static inline uint32_t slab_bump_alloc(Slab* s) {
+  if (atomic_load_explicit(&s->bump_next, memory_order_relaxed) >= s->object_count) return UINT32_MAX;
+  uint32_t b = atomic_fetch_add_explicit(&s->bump_next, 1u, memory_order_relaxed);
+  return b < s->object_count ? b : UINT32_MAX;
+}
+
+/* Batched slab_bump_alloc(): up to want consecutive slots into out_idx.
+ * Returns the number taken; *out_left gets the reserve left before the call. */
+static inline uint32_t slab_bump_alloc_n(Slab* s, uint32_t want, uint32_t* out_idx, uint32_t* out_left) {
+  if (atomic_load_explicit(&s->bump_next, memory_order_relaxed) >= s->object_count) return 0;
+  uint32_t b = atomic_fetch_add_explicit(&s->bump_next, want, memory_order_relaxed);
+  if (b >= s->object_count) return 0;
+  uint32_t got = s->object_count - b;
+  if (got > want) got = want;
+  for (uint32_t k = 0; k < got; k++) out_idx[k] = b + k;
+  *out_left = s->object_count - b;
+  return got;
+}
+
+/* Hand the untouched reserve back to the bitmap before the first free.
+ *
+ * Frees validate against bitmap bits and drive list transitions off
+ * free_count, so both must describe real slots from here on: seal the
+ * reserve (later bumps fail and fall back to the bitmap), clear the bits
+ * of slots [b, object_count) and add them to free_count. Runs at most
+ * once per slab incarnation, under sc->lock so that no allocator decides
+ * "bitmap full → FULL list" from the half-retired state. One relaxed load
+ * for every free after that (or for slabs whose reserve ran out).
+ * Caller holds sc->lock; slab_bump_retire() below takes it. */
+static void slab_bump_retire_locked(SizeClassAlloc* sc, Slab* s) {
+  uint32_t b = atomic_fetch_or_explicit(&s->bump_next, SLAB_BUMP_RETIRED, memory_order_acq_rel);
+  if (b < s->object_count) {
+    _Atomic uint32_t* bm = slab_bitmap_ptr(s);
+    const uint32_t words = slab_bitmap_words(s->object_count);
+    for (uint32_t w = b / 32u; w < words; w++) {
+      uint32_t keep = (w == b / 32u) ? (1u << (b % 32u)) - 1u : 0u;  /* Bits below b were bumped */
+      atomic_fetch_and_explicit(&bm[w], keep, memory_order_release);
+    }
+    atomic_fetch_add_explicit(&s->free_count, s->object_count - b, memory_order_release);
+    atomic_fetch_add_explicit(&sc->bump_retires, 1, memory_order_relaxed);
+  }
+}
+
+/* Lock-taking wrapper: the common "first free" case costs one relaxed load */
+static void slab_bump_retire(SizeClassAlloc* sc, Slab* s) {
+  if (atomic_load_explicit(&s->bump_next, memory_order_relaxed) >= s->object_count) return;
+
+  LOCK_WITH_PROBE(&sc->lock, sc, LOCK_RANK_SIZE_CLASS, "sc->lock");
+  slab_bump_retire_locked(sc, s);
+  UNLOCK_WITH_RANK(&sc->lock);
+}
+
+/* ------------------------------ Remote frees ------------------------------ */
+
+/* Defer a free onto the slab's remote stack (SlabAllocatorConfig.remote_free).
+ *
+ * One release CAS on remote_head replaces the bitmap CAS, the free_count RMW
+ * and any list transition, so a consumer thread freeing a producer's objects
+ * no longer pulls the bitmap line across cores on every object. The freed
+ * object's first 4 bytes hold the link (classes are >= 16 bytes).
+ *
+ * Double-free detection is best effort: a slot already clear in the bitmap
+ * is rejected, but two frees of a slot still on the stack are not caught.
+ */
+static bool slab_free_remote(SizeClassAlloc* sc, Slab* s, uint32_t idx) {
+  if (idx >= s->object_count) return false;
+  _Atomic uint32_t* bm = slab_bitmap_ptr(s);
+  if ((atomic_load_explicit(&bm[idx / 32u], memory_order_relaxed) & (1u << (idx % 32u))) == 0u) {
+    return false;  /* Already free */
+  }
+
+  uint32_t* link = (uint32_t*)slab_slot_ptr(s, idx);
+  uint32_t head = atomic_load_explicit(&s->remote_head, memory_order_relaxed);
+  do {
+    *link = head;
+  } while (!atomic_compare_exchange_weak_explicit(&s->remote_head, &head, idx + 1u,
+                                                  memory_order_release, memory_order_relaxed));
+  atomic_fetch_add_explicit(&sc->remote_frees, 1, memory_order_relaxed);
+  return true;
+}
+
+/* Take the whole remote stack and apply it: one fetch_and per bitmap word,
+ * one free_count add. No list transition - callers decide (they usually hold
+ * sc->lock and were about to retire the slab as full). Returns slots freed;
+ * *out_prev_fc gets free_count before the add. */
+static uint32_t slab_drain_remote(SizeClassAlloc* sc, Slab* s, uint32_t* out_prev_fc) {
+  if (atomic_load_explicit(&s->remote_head, memory_order_relaxed) == 0u) return 0;
+  uint32_t head = atomic_exchange_explicit(&s->remote_head, 0u, memory_order_acquire);
+
+  uint32_t clear[256u / 32u] = {0};  /* slot field is 8 bits: <= 256 slots */
+  for (uint32_t n = 0; head != 0u && n < s->object_count; n++) {
+    uint32_t idx = head - 1u;
+    if (idx >= s->object_count) break;  /* Corrupted link: keep what we have */
+    clear[idx / 32u] |= 1u << (idx % 32u);
+    head = *(uint32_t*)slab_slot_ptr(s, idx);
+  }
+
+  _Atomic uint32_t* bm = slab_bitmap_ptr(s);
+  const uint32_t words = slab_bitmap_words(s->object_count);
+  uint32_t freed = 0;
+  for (uint32_t w = 0; w < words; w++) {
+    if (clear[w] == 0u) continue;
+    uint32_t old = atomic_fetch_and_explicit(&bm[w], ~clear[w], memory_order_acq_rel);
+    freed += popcount32(old & clear[w]);
+  }
+  if (freed == 0) return 0;
+
+  uint32_t prev_fc = atomic_fetch_add_explicit(&s->free_count, freed, memory_order_relaxed);
+  if (out_prev_fc) *out_prev_fc = prev_fc;
+  atomic_fetch_add_explicit(&sc->remote_drains, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&sc->remote_drained_objects, freed, memory_order_relaxed);
+#if ENABLE_DIAGNOSTIC_COUNTERS
+  atomic_fetch_sub_explicit(&sc->live_bytes, (uint64_t)sc->object_size * freed, memory_order_relaxed);
+#endif
+  return freed;
+}
+
+/* Caller holds sc->lock and is about to retire PARTIAL slab s to FULL.
+ * Returns true if pending remote frees refilled it (keep it on PARTIAL). */
+static bool slab_absorb_remote_locked(SizeClassAlloc* sc, EpochState* es, Slab* s) {
+  uint32_t prev_fc = 0;
+  uint32_t got = slab_drain_remote(sc, s, &prev_fc);
+  if (got == 0) return false;
+  if (prev_fc + got == s->object_count) {
+    atomic_fetch_add_explicit(&es->empty_partial_count, 1, memory_order_relaxed);
+  }
+  return true;
+}
+
 /* ------------------------------ Allocator Lifetime ------------------------------ */
 
 /* Opaque API: create/free for external users */
 SlabAllocator* slab_allocator_create(void) {
-  SlabAllocator* a = (SlabAllocator*)calloc(1, sizeof(SlabAllocator));
+  return slab_allocator_create_with_config(NULL);
+}
+
+SlabAllocator* slab_allocator_create_with_config(const SlabAllocatorConfig* config) {
+  /* Cache-line aligned: SizeClassAlloc splits its fields on line boundaries */
+  SlabAllocator* a = (SlabAllocator*)aligned_alloc(_Alignof(SlabAllocator), sizeof(SlabAllocator));
   if (!a) return NULL;
-  allocator_init(a);
+  memset(a, 0, sizeof(*a));
+  if (!allocator_init_with_config(a, config)) {
+    int saved = errno;
+    free(a);
+    errno = saved;
+    return NULL;
+  }
   return a;
 }
 
@@ -815,32 +2160,175 @@ void slab_allocator_free(SlabAllocator* a) {
   free(a);
 }
 
+/* Validate a caller-supplied size-class table.
+ *
+ * Rules (each protects an invariant elsewhere in the allocator):
+ * - 1..SLAB_MAX_CLASSES entries: classes[] capacity, 8-bit handle cls field
+ * - Strictly ascending: build_class_lookup() maps each size to first fit
+ * - SLAB_MIN_OBJECT_SIZE..SLAB_MAX_OBJECT_SIZE: lookup table bound, and the
+ *   8-bit handle slot field (object_count <= 255 per slab)
+ * - Multiple of 8: keeps every slot 8-byte aligned within the slab
+ */
+static bool size_classes_valid(const uint32_t* sizes, uint32_t n) {
+  if (!sizes || n == 0 || n > SLAB_MAX_CLASSES) return false;
+  for (uint32_t i = 0; i < n; i++) {
+    uint32_t sz = sizes[i];
+    if (sz < SLAB_MIN_OBJECT_SIZE || sz > SLAB_MAX_OBJECT_SIZE) return false;
+    if ((sz & 7u) != 0) return false;
+    if (i > 0 && sz <= sizes[i - 1]) return false;
+    uint32_t count = slab_object_count(sz);
+    if (count == 0 || count > 255) return false;
+  }
+  return true;
+}
+
+/* Per-epoch arrays, sized by the ring chosen at init.
+ *
+ * calloc leaves every slot ACTIVE (0), era 0, unlabeled and not pending;
+ * allocator_init_with_config() still stores the atomics explicitly. */
+static bool epoch_ring_alloc(SlabAllocator* a, uint32_t count) {
+  a->epoch_count = count;
+  a->epoch_mask = count - 1u;
+  a->epoch_state = (_Atomic uint32_t*)calloc(count, sizeof(*a->epoch_state));
+  a->epoch_era = (_Atomic uint64_t*)calloc(count, sizeof(*a->epoch_era));
+  a->epoch_meta = (EpochMetadata*)calloc(count, sizeof(*a->epoch_meta));
+  a->reclaimer.queue = (uint32_t*)calloc(count, sizeof(*a->reclaimer.queue));
+  a->reclaimer.pending = (_Atomic uint8_t*)calloc(count, sizeof(*a->reclaimer.pending));
+  a->reclaimer.jobs = (SlabReclaimJob*)calloc(count, sizeof(*a->reclaimer.jobs));
+  bool ok = a->epoch_state && a->epoch_era && a->epoch_meta &&
+            a->reclaimer.queue && a->reclaimer.pending && a->reclaimer.jobs;
+#if ENABLE_TLS_CACHE
+  a->tls_flush_gen = (_Atomic uint32_t*)calloc(count, sizeof(*a->tls_flush_gen));
+  ok = ok && a->tls_flush_gen;
+#endif
+#if ENABLE_LATENCY_HIST
+  /* Not per-epoch, but allocator-wide with the same lifetime and failure paths */
+  a->lat_stripes = (SlabLatencyStripe*)aligned_alloc(
+      SLAB_CACHE_LINE, SLAB_LAT_STRIPES * sizeof(SlabLatencyStripe));
+  if (a->lat_stripes) {
+    memset(a->lat_stripes, 0, SLAB_LAT_STRIPES * sizeof(SlabLatencyStripe));
+  }
+  ok = ok && a->lat_stripes;
+#endif
+  return ok;
+}
+
+static void epoch_ring_free(SlabAllocator* a) {
+  free(a->epoch_state);
+  free(a->epoch_era);
+  free(a->epoch_meta);
+  free(a->reclaimer.queue);
+  free((void*)a->reclaimer.pending);
+  free(a->reclaimer.jobs);
+  a->epoch_state = NULL;
+  a->epoch_era = NULL;
+  a->epoch_meta = NULL;
+  a->reclaimer.queue = NULL;
+  a->reclaimer.pending = NULL;
+  a->reclaimer.jobs = NULL;
+#if ENABLE_TLS_CACHE
+  free((void*)a->tls_flush_gen);
+  a->tls_flush_gen = NULL;
+#endif
+#if ENABLE_LATENCY_HIST
+  free(a->lat_stripes);
+  a->lat_stripes = NULL;
+#endif
+}
+
 /* Init/destroy: for internal use or when caller provides storage */
 void allocator_init(SlabAllocator* a) {
-  /* Initialize O(1) class lookup table (once per process) */
-  init_class_lookup();
+  (void)allocator_init_with_config(a, NULL);
+}
+
+bool allocator_init_with_config(SlabAllocator* a, const SlabAllocatorConfig* config) {
+  /* Resolve size-class table: caller's (validated) or the built-in default */
+  const uint32_t* sizes = k_size_classes;
+  uint32_t nsizes = (uint32_t)k_num_classes;
+  if (config && config->size_classes) {
+    if (!size_classes_valid(config->size_classes, config->num_classes)) {
+      errno = EINVAL;
+      return false;
+    }
+    sizes = config->size_classes;
+    nsizes = config->num_classes;
+  }
+  if (config && (uint32_t)config->reclaim_mode > SLAB_RECLAIM_LAZY) {
+    errno = EINVAL;
+    return false;
+  }
+  /* Epoch ring: power of two so the sequence maps to a slot with a mask */
+  uint32_t ring = EPOCH_COUNT;
+  if (config && config->epoch_count) {
+    if (config->epoch_count > SLAB_MAX_EPOCHS) {
+      errno = EINVAL;
+      return false;
+    }
+    ring = 1u;
+    while (ring < config->epoch_count) ring <<= 1;
+  }
+  /* Release units (a slab's OS page at least) must not span arenas */
+  const uint32_t page = os_page_size();
+  if (page > SLAB_ARENA_SIZE) {
+    errno = EINVAL;
+    return false;
+  }
+  atomic_store_explicit(&a->reclaim_mode, config ? (uint32_t)config->reclaim_mode : SLAB_RECLAIM_IMMEDIATE,
+                        memory_order_relaxed);
+  a->remote_free = config && config->remote_free;
+  a->header_free = config && config->header_free;
+  a->slab_size_shifts = 0;
+  a->os_page_size = page;
+  a->hugepage_bytes = config && config->hugepage_slabs ? hugepage_detect(page) : 0;
+  atomic_store_explicit(&a->arena_map, NULL, memory_order_relaxed);
+  
+  /* NUMA topology: one slab pool per node (detected once per allocator) */
+  a->numa_nodes = numa_detect_nodes();
+  
+  /* Initialize O(1) class lookup table for this instance */
+  a->num_classes = nsizes;
+  a->max_alloc_size = sizes[nsizes - 1];
+  a->default_classes = nsizes == SLAB_NUM_CLASSES &&
+                       memcmp(sizes, k_size_classes, sizeof(k_size_classes)) == 0;
+  build_class_lookup(a, sizes, nsizes);
   
   /* Initialize slab registry for portable handle encoding */
   reg_init(&a->reg);
   
+  /* Background reclaimer: idle until slab_reclaimer_start(). Its per-epoch
+   * arrays come with the ring below, so clear it first. */
+  memset(&a->reclaimer, 0, sizeof(a->reclaimer));
+  
+  /* Per-epoch arrays for the configured ring */
+  if (!epoch_ring_alloc(a, ring)) {
+    epoch_ring_free(a);
+    reg_destroy(&a->reg);
+    a->num_classes = 0;
+    errno = ENOMEM;
+    return false;
+  }
+  
   /* IMPORTANT: Initialize atomics BEFORE memset (memset on atomics is UB) */
-  a->epoch_count = EPOCH_COUNT;
   atomic_store_explicit(&a->current_epoch, 0, memory_order_relaxed);
   
   /* Initialize all epochs as ACTIVE (MUST be before memset) */
-  for (uint32_t e = 0; e < EPOCH_COUNT; e++) {
+  for (uint32_t e = 0; e < a->epoch_count; e++) {
     atomic_store_explicit(&a->epoch_state[e], EPOCH_ACTIVE, memory_order_relaxed);
   }
   
   /* Phase 2.2: Initialize era tracking for monotonic observability */
   atomic_store_explicit(&a->epoch_era_counter, 0, memory_order_relaxed);
-  for (uint32_t e = 0; e < EPOCH_COUNT; e++) {
+  atomic_store_explicit(&a->epoch_stale_rejects, 0, memory_order_relaxed);
+  atomic_store_explicit(&a->memory_budget, 0, memory_order_relaxed);
+  atomic_store_explicit(&a->budget_check_ms, 0u, memory_order_relaxed);
+  atomic_store_explicit(&a->budget_enforcements, 0, memory_order_relaxed);
+  for (uint32_t e = 0; e < a->epoch_count; e++) {
     atomic_store_explicit(&a->epoch_era[e], 0, memory_order_relaxed);  /* Era 0 for all epochs at startup */
   }
   
   /* Phase 2.3: Initialize epoch metadata for rich observability */
   pthread_mutex_init(&a->epoch_label_lock, NULL);
-  for (uint32_t e = 0; e < EPOCH_COUNT; e++) {
+  for (uint32_t e = 0; e < a->epoch_count; e++) {
     a->epoch_meta[e].open_since_ns = 0;  /* 0 = never opened */
     atomic_store_explicit(&a->epoch_meta[e].domain_refcount, 0, memory_order_relaxed);
     a->epoch_meta[e].label[0] = '\0';  /* Empty label */
@@ -856,37 +2344,99 @@ void allocator_init(SlabAllocator* a) {
   a->label_registry.count = 1;  /* ID 0 reserved for unlabeled */
   memset(a->label_registry.labels, 0, sizeof(a->label_registry.labels));
   strncpy(a->label_registry.labels[0], "(unlabeled)", 31);
+  for (uint32_t lid = 0; lid < MAX_LABEL_IDS; lid++) {
+    LabelQuota* q = &a->label_quota[lid];
+    atomic_store_explicit(&q->committed, 0, memory_order_relaxed);
+    atomic_store_explicit(&q->peak, 0, memory_order_relaxed);
+    atomic_store_explicit(&q->quota, 0, memory_order_relaxed);
+    atomic_store_explicit(&q->denials, 0, memory_order_relaxed);
+    q->cb = NULL;
+    q->cb_arg = NULL;
+  }
+  
+  /* Background reclaimer (cleared above) */
+  pthread_mutex_init(&a->reclaimer.lock, NULL);
+  pthread_cond_init(&a->reclaimer.wake, NULL);
+  
+#if ENABLE_ALLOC_TRACE
+  /* Allocation trace: off until slab_trace_start() */
+  trace_init(a);
+#endif
+  
+  /* Shared-memory stats segment: not published until slab_stats_shm_start() */
+  atomic_store_explicit(&a->stats_shm, NULL, memory_order_relaxed);
+  a->stats_shm_stop = NULL;
+  
+  /* Standalone until slab_group_create() adopts it as a shard */
+  a->group = NULL;
+  a->group_shard = 0;
+  a->group_tick = NULL;
   
   /* Zero out non-atomic fields (classes array) */
-  for (size_t i = 0; i < k_num_classes; i++) {
+  for (size_t i = 0; i < a->num_classes; i++) {
     a->classes[i].epochs = NULL;
-    a->classes[i].slab_cache = NULL;
-    a->classes[i].cache_size = 0;
-    a->classes[i].cache_capacity = 0;
+    a->classes[i].stripes = NULL;
+    a->classes[i].pools = NULL;
+    atomic_store_explicit(&a->classes[i].cache_capacity, 0u, memory_order_relaxed);
     a->classes[i].total_slabs = 0;
+    a->classes[i].forward_free = NULL;
+    memset(&a->classes[i].cache_adapt, 0, sizeof(a->classes[i].cache_adapt));
+    atomic_store_explicit(&a->classes[i].cache_trims, 0, memory_order_relaxed);
+    atomic_store_explicit(&a->classes[i].cache_trimmed_slabs, 0, memory_order_relaxed);
+    atomic_store_explicit(&a->classes[i].release_units, 0, memory_order_relaxed);
+    atomic_store_explicit(&a->classes[i].hugepage_arenas, 0, memory_order_relaxed);
   }
   
-  for (size_t i = 0; i < k_num_classes; i++) {
-    a->classes[i].object_size = k_size_classes[i];
+  for (size_t i = 0; i < a->num_classes; i++) {
+    a->classes[i].object_size = sizes[i];
+    a->classes[i].slab_bytes = (uint32_t)slab_bytes_for_size(sizes[i]);
+    a->slab_size_shifts |= 1u << __builtin_ctz(a->classes[i].slab_bytes);
+    /* Pages go back in units no smaller than an OS (or huge) page; a
+     * smaller slab shares its unit with neighbours (all powers of two) */
+    uint32_t unit = a->classes[i].slab_bytes;
+    if (unit < a->os_page_size) unit = a->os_page_size;
+    if (unit < a->hugepage_bytes) unit = a->hugepage_bytes;
+    a->classes[i].release_bytes = unit;
     a->classes[i].parent_alloc = a;  /* Phase 2.3: Backpointer for label_id lookup */
     pthread_mutex_init(&a->classes[i].lock, NULL);
     a->classes[i].total_slabs = 0;
 
-    /* Allocate per-epoch state arrays */
-    a->classes[i].epochs = (EpochState*)calloc(EPOCH_COUNT, sizeof(EpochState));
-    if (!a->classes[i].epochs) {
+    /* Allocate per-epoch state arrays (line-aligned for the slot pins) */
+    a->classes[i].epochs = (EpochState*)aligned_alloc(
+        SLAB_CACHE_LINE, a->epoch_count * sizeof(EpochState));
+    if (a->classes[i].epochs) {
+      memset(a->classes[i].epochs, 0, a->epoch_count * sizeof(EpochState));
+    }
+    
+    /* Hot-path counter stripes, zeroed like the epoch array */
+    a->classes[i].stripes = (SlabCounterStripe*)aligned_alloc(
+        SLAB_CACHE_LINE, SLAB_COUNTER_STRIPES * sizeof(SlabCounterStripe));
+    if (a->classes[i].stripes) {
+      memset(a->classes[i].stripes, 0, SLAB_COUNTER_STRIPES * sizeof(SlabCounterStripe));
+    }
+    
+    if (!a->classes[i].epochs || !a->classes[i].stripes) {
       /* Allocation failure - clean up and abort */
+      free(a->classes[i].epochs);
+      free(a->classes[i].stripes);
+      a->classes[i].epochs = NULL;
+      a->classes[i].stripes = NULL;
       for (size_t j = 0; j < i; j++) {
         free(a->classes[j].epochs);
+        free(a->classes[j].stripes);
       }
-      return;
+      epoch_ring_free(a);
+      a->num_classes = 0;
+      errno = ENOMEM;
+      return false;
     }
     
     /* Initialize each epoch's state */
-    for (uint32_t e = 0; e < EPOCH_COUNT; e++) {
+    for (uint32_t e = 0; e < a->epoch_count; e++) {
       list_init(&a->classes[i].epochs[e].partial);
       list_init(&a->classes[i].epochs[e].full);
-      atomic_store_explicit(&a->classes[i].epochs[e].current_partial, NULL, memory_order_relaxed);
+      list_init(&a->classes[i].epochs[e].empty);
+      percpu_clear_all(&a->classes[i].epochs[e], memory_order_relaxed);
       atomic_store_explicit(&a->classes[i].epochs[e].empty_partial_count, 0, memory_order_relaxed);
     }
 
@@ -895,8 +2445,6 @@ void allocator_init(SlabAllocator* a) {
     atomic_store_explicit(&a->classes[i].new_slab_count, 0, memory_order_relaxed);
     atomic_store_explicit(&a->classes[i].list_move_partial_to_full, 0, memory_order_relaxed);
     atomic_store_explicit(&a->classes[i].list_move_full_to_partial, 0, memory_order_relaxed);
-    atomic_store_explicit(&a->classes[i].current_partial_null, 0, memory_order_relaxed);
-    atomic_store_explicit(&a->classes[i].current_partial_full, 0, memory_order_relaxed);
     atomic_store_explicit(&a->classes[i].empty_slab_recycled, 0, memory_order_relaxed);
     atomic_store_explicit(&a->classes[i].empty_slab_overflowed, 0, memory_order_relaxed);
     
@@ -908,16 +2456,16 @@ void allocator_init(SlabAllocator* a) {
     atomic_store_explicit(&a->classes[i].madvise_calls, 0, memory_order_relaxed);
     atomic_store_explicit(&a->classes[i].madvise_bytes, 0, memory_order_relaxed);
     atomic_store_explicit(&a->classes[i].madvise_failures, 0, memory_order_relaxed);
+    atomic_store_explicit(&a->classes[i].madvise_batches, 0, memory_order_relaxed);
+    atomic_store_explicit(&a->classes[i].madvise_ranges, 0, memory_order_relaxed);
+    atomic_store_explicit(&a->classes[i].remote_frees, 0, memory_order_relaxed);
+    atomic_store_explicit(&a->classes[i].remote_drains, 0, memory_order_relaxed);
+    atomic_store_explicit(&a->classes[i].remote_drained_objects, 0, memory_order_relaxed);
     
-    /* Phase 2.2: Initialize lock-free contention counters */
-    atomic_store_explicit(&a->classes[i].bitmap_alloc_cas_retries, 0, memory_order_relaxed);
-    atomic_store_explicit(&a->classes[i].bitmap_free_cas_retries, 0, memory_order_relaxed);
-    atomic_store_explicit(&a->classes[i].current_partial_cas_failures, 0, memory_order_relaxed);
-    atomic_store_explicit(&a->classes[i].bitmap_alloc_attempts, 0, memory_order_relaxed);
-    atomic_store_explicit(&a->classes[i].bitmap_free_attempts, 0, memory_order_relaxed);
-    atomic_store_explicit(&a->classes[i].current_partial_cas_attempts, 0, memory_order_relaxed);
-    atomic_store_explicit(&a->classes[i].lock_fast_acquire, 0, memory_order_relaxed);
-    atomic_store_explicit(&a->classes[i].lock_contended, 0, memory_order_relaxed);
+    /* Bulk epoch release telemetry */
+    atomic_store_explicit(&a->classes[i].epoch_release_calls, 0, memory_order_relaxed);
+    atomic_store_explicit(&a->classes[i].epoch_release_slabs, 0, memory_order_relaxed);
+    atomic_store_explicit(&a->classes[i].epoch_release_objects, 0, memory_order_relaxed);
     
 #ifdef ENABLE_LABEL_CONTENTION
     /* Phase 2.3: Initialize per-label contention counters */
@@ -929,30 +2477,195 @@ void allocator_init(SlabAllocator* a) {
     }
 #endif
 
-    /* Initialize slab cache (32 pages per size class = 128KB) */
-    a->classes[i].cache_capacity = 32;
-    a->classes[i].cache_size = 0;
-    a->classes[i].slab_cache = (CachedSlab*)calloc(a->classes[i].cache_capacity, sizeof(CachedSlab));
-    pthread_mutex_init(&a->classes[i].cache_lock, NULL);
-    
-    /* Initialize overflow list (CachedNode for madvise safety) */
-    a->classes[i].cache_overflow_head = NULL;
-    a->classes[i].cache_overflow_tail = NULL;
-    a->classes[i].cache_overflow_len = 0;
-    
+    /* Initialize one slab pool per NUMA node: empty lock-free cache stack
+     * (soft bound starts at SLAB_CACHE_TARGET_INIT slabs each and then
+     * follows demand). Arena regions and their cache nodes are reserved
+     * lazily on the first cache miss. */
+    atomic_store_explicit(&a->classes[i].cache_capacity, SLAB_CACHE_TARGET_INIT, memory_order_relaxed);
+    atomic_store_explicit(&a->classes[i].cache_adapt.window_start_ms, coarse_ms(), memory_order_relaxed);
+    atomic_store_explicit(&a->classes[i].warm_floor, 0u, memory_order_relaxed);
+    atomic_store_explicit(&a->classes[i].reserved_slabs, 0, memory_order_relaxed);
+    atomic_store_explicit(&a->classes[i].warm_madvise_skips, 0, memory_order_relaxed);
+    a->classes[i].pools = (SlabNodePool*)calloc(a->numa_nodes, sizeof(SlabNodePool));
+    if (!a->classes[i].pools) {
+      free(a->classes[i].epochs);
+      free(a->classes[i].stripes);
+      a->classes[i].epochs = NULL;
+      a->classes[i].stripes = NULL;
+      for (size_t j = 0; j < i; j++) {
+        free(a->classes[j].epochs);
+        free(a->classes[j].stripes);
+        free(a->classes[j].pools);
+      }
+      epoch_ring_free(a);
+      a->num_classes = 0;
+      errno = ENOMEM;
+      return false;
+    }
+    for (uint32_t n = 0; n < a->numa_nodes; n++) {
+      SlabNodePool* pool = &a->classes[i].pools[n];
+      atomic_store_explicit(&pool->cache_head, (uint64_t)SLAB_CACHE_NIL, memory_order_relaxed);
+      atomic_store_explicit(&pool->cache_count, 0u, memory_order_relaxed);
+      atomic_store_explicit(&pool->cache_clean, 0u, memory_order_relaxed);
+      atomic_store_explicit(&pool->cache_cas_retries, 0, memory_order_relaxed);
+      pool->arenas = NULL;
+      pool->arena_ords = 0;  /* arena_dir zeroed by calloc */
+      pthread_mutex_init(&pool->arena_lock, NULL);
+      atomic_store_explicit(&pool->slabs_carved, 0, memory_order_relaxed);
+      atomic_store_explicit(&pool->cache_pops_local, 0, memory_order_relaxed);
+      atomic_store_explicit(&pool->cache_pops_remote, 0, memory_order_relaxed);
+      atomic_store_explicit(&pool->bind_failures, 0, memory_order_relaxed);
+    }
+    atomic_store_explicit(&a->classes[i].arena_count, 0, memory_order_relaxed);
+    atomic_store_explicit(&a->classes[i].arena_reserved_bytes, 0, memory_order_relaxed);
+    atomic_store_explicit(&a->classes[i].arena_committed_bytes, 0, memory_order_relaxed);
   }
+  
+#if ENABLE_TLS_CACHE
+  tls_allocator_register(a);
+#endif
+  
+  return true;
+}
+
+/* ------------------------------ Size-class suggestion ------------------------------ */
+
+/* Suggest a size-class table from a sampled request-size histogram.
+ *
+ * Minimizes expected internal fragmentation: sum over requests of
+ * (class_size - request_size), with at most max_classes classes.
+ *
+ * Candidate class sizes are the observed request sizes rounded up to the
+ * 8-byte class granularity (an optimal table never places a class boundary
+ * between two observed sizes). Exact dynamic program over candidates:
+ *
+ *   best[m][j] = min waste covering candidates 0..j with m classes, the
+ *                last of which is cand[j]
+ *   best[m][j] = min over i<j of best[m-1][i] + waste(i+1..j → cand[j])
+ *
+ * waste() is O(1) from prefix sums of counts and count*size, so the whole
+ * search is O(max_classes * K^2), K = distinct rounded sizes (<= 2047).
+ * Offline helper (feed it a histogram from a profiling run), not a hot path.
+ *
+ * Sizes above SLAB_MAX_OBJECT_SIZE are ignored (no class can serve them).
+ * Returns number of classes written to out_classes, 0 on empty histogram,
+ * invalid arguments (errno=EINVAL) or allocation failure (errno=ENOMEM).
+ */
+uint32_t slab_suggest_size_classes(const uint64_t* hist, uint32_t hist_len,
+                                   uint32_t max_classes, uint32_t* out_classes) {
+  if (!hist || !out_classes || max_classes == 0) {
+    errno = EINVAL;
+    return 0;
+  }
+  if (max_classes > SLAB_MAX_CLASSES) max_classes = SLAB_MAX_CLASSES;
+  if (hist_len > SLAB_MAX_OBJECT_SIZE + 1u) hist_len = SLAB_MAX_OBJECT_SIZE + 1u;
+
+  /* Collapse histogram into candidate buckets (rounded class sizes) */
+  const uint32_t max_cand = SLAB_MAX_OBJECT_SIZE / 8u;
+  uint32_t* cand = (uint32_t*)malloc(max_cand * sizeof(uint32_t));
+  uint64_t* cnt = (uint64_t*)calloc(max_cand + 1u, sizeof(uint64_t));  /* prefix: counts */
+  uint64_t* sum = (uint64_t*)calloc(max_cand + 1u, sizeof(uint64_t));  /* prefix: count*size */
+  if (!cand || !cnt || !sum) {
+    free(cand); free(cnt); free(sum);
+    errno = ENOMEM;
+    return 0;
+  }
+
+  uint32_t k = 0;
+  for (uint32_t sz = 1; sz < hist_len; sz++) {
+    if (hist[sz] == 0) continue;
+    uint32_t cls = (sz + 7u) & ~7u;
+    if (cls < SLAB_MIN_OBJECT_SIZE) cls = SLAB_MIN_OBJECT_SIZE;
+    if (k == 0 || cand[k - 1] != cls) {
+      cand[k] = cls;
+      cnt[k + 1] = cnt[k];
+      sum[k + 1] = sum[k];
+      k++;
+    }
+    cnt[k] += hist[sz];
+    sum[k] += hist[sz] * (uint64_t)sz;
+  }
+
+  if (k == 0) {
+    free(cand); free(cnt); free(sum);
+    return 0;
+  }
+  if (max_classes > k) max_classes = k;
+
+  /* best/prev are (max_classes x k), row-major */
+  uint64_t* best = (uint64_t*)malloc((size_t)max_classes * k * sizeof(uint64_t));
+  uint16_t* prev = (uint16_t*)malloc((size_t)max_classes * k * sizeof(uint16_t));
+  if (!best || !prev) {
+    free(cand); free(cnt); free(sum); free(best); free(prev);
+    errno = ENOMEM;
+    return 0;
+  }
+
+  /* waste of serving candidates (i, j] with class cand[j-1] (1-based prefix) */
+#define SUGGEST_WASTE(i, j) \
+  ((uint64_t)cand[(j) - 1] * (cnt[(j)] - cnt[(i)]) - (sum[(j)] - sum[(i)]))
+
+  for (uint32_t j = 0; j < k; j++) {
+    best[j] = SUGGEST_WASTE(0, j + 1);  /* One class covering 0..j */
+    prev[j] = UINT16_MAX;
+  }
+  for (uint32_t m = 1; m < max_classes; m++) {
+    uint64_t* row = best + (size_t)m * k;
+    const uint64_t* up = best + (size_t)(m - 1) * k;
+    for (uint32_t j = 0; j < k; j++) {
+      row[j] = UINT64_MAX;
+      prev[(size_t)m * k + j] = UINT16_MAX;
+      for (uint32_t i = (m - 1); i < j; i++) {
+        if (up[i] == UINT64_MAX) continue;
+        uint64_t w = up[i] + SUGGEST_WASTE(i + 1, j + 1);
+        if (w < row[j]) {
+          row[j] = w;
+          prev[(size_t)m * k + j] = (uint16_t)i;
+        }
+      }
+    }
+  }
+#undef SUGGEST_WASTE
+
+  /* More classes never hurt; pick the best row that covers the largest size */
+  uint32_t m_best = 0;
+  for (uint32_t m = 1; m < max_classes; m++) {
+    if (best[(size_t)m * k + (k - 1)] < best[(size_t)m_best * k + (k - 1)]) m_best = m;
+  }
+
+  /* Walk back-pointers from the largest candidate */
+  uint32_t n = m_best + 1;
+  uint32_t j = k - 1;
+  for (uint32_t m = m_best + 1; m-- > 0; ) {
+    out_classes[m] = cand[j];
+    if (m > 0) j = prev[(size_t)m * k + j];
+  }
+
+  free(cand); free(cnt); free(sum); free(best); free(prev);
+  return n;
 }
 
 /* ------------------------------ Slab cache operations ------------------------------ */
 
-/* Pop a recycled slab from cache.
+/* Resolve a cache node index ([31:16] arena ordinal, [15:0] position). */
+static inline CachedSlab* cache_node_at(SlabNodePool* pool, uint32_t idx) {
+  uint32_t ord = idx >> SLAB_CACHE_POS_BITS;
+  SlabArena* ar = pool->arena_dir[ord / SLAB_ARENA_DIR_BLOCK][ord % SLAB_ARENA_DIR_BLOCK];
+  return &ar->nodes[idx & ((1u << SLAB_CACHE_POS_BITS) - 1u)];
+}
+
+/* Pop a recycled slab from one node pool's cache.
  *
- * Two-tier cache structure:
- * 1. Array cache (32 entries): Fast, no malloc/free overhead
- * 2. Overflow list (unbounded): Handles cache pressure, uses heap nodes
+ * Lock-free Treiber stack over off-page CachedSlab nodes:
+ * - Head packs (tag, index) into one 64-bit word; every successful CAS bumps
+ *   the tag, so a pop that read a stale `next` (node popped and re-pushed
+ *   meanwhile) fails instead of corrupting the stack (ABA)
+ * - Nodes outlive every pop that can observe them (freed only at destroy),
+ *   so reading node->next after losing a race is always safe
+ * - LIFO: the most recently retired slab is the one most likely still warm
  *
- * Returns slab pointer and slab_id via out parameter.
- * Returns NULL if cache is empty (forces new_slab to call mmap).
+ * Returns the node (owned by the caller until it is pushed again) or NULL if
+ * the pool is empty (forces new_slab to carve).
  *
  * Why off-page storage matters:
  * - madvise(MADV_DONTNEED) zeros the slab header when recycling
@@ -960,63 +2673,74 @@ void allocator_init(SlabAllocator* a) {
  * - We store slab_id alongside the pointer (off-page) so it survives
  * - This enables generation bumping and registry updates on reuse
  */
-static Slab* cache_pop(SizeClassAlloc* sc, uint32_t* out_slab_id, bool* out_was_published) {
-  LOCK_WITHOUT_PROBE(&sc->cache_lock, LOCK_RANK_CACHE, "sc->cache_lock");
-  Slab* s = NULL;
-  uint32_t id = UINT32_MAX;
-  bool was_pub = false;
-  
-  if (sc->cache_size > 0) {
-    /* Pop from array cache (fast path).
-     * CachedSlab stores pointer, ID, and was_published off-page. */
-    CachedSlab* entry = &sc->slab_cache[--sc->cache_size];
-    s = entry->slab;
-    id = entry->slab_id;  /* Survived madvise because stored off-page */
-    was_pub = entry->was_published;  /* Also survives madvise */
-  } else if (sc->cache_overflow_head) {
-    /* Array cache empty, try overflow list (slower, but avoids mmap).
-     * CachedNode is a heap-allocated doubly-linked list node. */
-    CachedNode* node = sc->cache_overflow_head;
-    s = node->slab;
-    id = node->slab_id;  /* Survived madvise because stored in node */
-    was_pub = node->was_published;  /* Also survives madvise */
-    
-    /* Unlink from head of list */
-    sc->cache_overflow_head = node->next;
-    if (sc->cache_overflow_head) {
-      sc->cache_overflow_head->prev = NULL;
-    } else {
-      sc->cache_overflow_tail = NULL;  /* List now empty */
+static CachedSlab* cache_pop_pool(SlabNodePool* pool) {
+  uint64_t head = atomic_load_explicit(&pool->cache_head, memory_order_acquire);
+  for (;;) {
+    uint32_t idx = (uint32_t)head;
+    if (idx == SLAB_CACHE_NIL) return NULL;
+
+    CachedSlab* node = cache_node_at(pool, idx);
+    uint32_t next = atomic_load_explicit(&node->next, memory_order_relaxed);
+    uint64_t want = ((head >> 32) + 1u) << 32 | next;
+    if (atomic_compare_exchange_weak_explicit(&pool->cache_head, &head, want,
+                                              memory_order_acquire, memory_order_acquire)) {
+      if (node->clean) atomic_fetch_sub_explicit(&pool->cache_clean, 1u, memory_order_relaxed);
+      atomic_fetch_sub_explicit(&pool->cache_count, 1u, memory_order_relaxed);
+      return node;
     }
-    sc->cache_overflow_len--;
-    
-    /* Free the node (slab itself stays mapped, just releasing metadata) */
-    free(node);
+    atomic_fetch_add_explicit(&pool->cache_cas_retries, 1, memory_order_relaxed);
   }
-  
-  UNLOCK_WITH_RANK(&sc->cache_lock);
-  
-  if (out_slab_id) *out_slab_id = id;
-  if (out_was_published) *out_was_published = was_pub;
-  return s;  /* NULL if both cache and overflow are empty */
 }
 
-/* Push empty slab to cache for reuse.
+/* Pop a recycled slab for a thread on `node`.
  *
- * Two-tier caching to balance performance vs memory:
- * 1. Array cache (32 entries): Fast, LIFO, no malloc overhead
- * 2. Overflow list (unbounded): Handles bursty workloads, uses heap nodes
- *
- * Critical design decision: madvise AFTER releasing lock.
- * - madvise() can take 5-50µs (variable, depends on kernel state)
- * - Holding lock during madvise adds jitter to all allocating threads
- * - Release lock first → predictable critical section latency
- * - madvise outside lock → only affects recycling thread
+ * Local pool first. On miss, default policy takes a slab from another
+ * node's pool before the caller carves fresh memory (reuse beats growth);
+ * SLAB_NUMA_STRICT leaves remote pools for new_slab() to try only after a
+ * local carve fails. *out_node is the pool (memory node) the slab came from.
+ */
+static CachedSlab* cache_pop(SlabAllocator* a, SizeClassAlloc* sc, uint32_t node, bool allow_remote,
+                             uint32_t* out_node) {
+  CachedSlab* c = cache_pop_pool(&sc->pools[node]);
+  if (c) {
+    if (a->numa_nodes > 1) {
+      atomic_fetch_add_explicit(&sc->pools[node].cache_pops_local, 1, memory_order_relaxed);
+    }
+    *out_node = node;
+    return c;
+  }
+  if (!allow_remote) return NULL;
+
+  for (uint32_t i = 1; i < a->numa_nodes; i++) {
+    uint32_t n = (node + i) % a->numa_nodes;
+    c = cache_pop_pool(&sc->pools[n]);
+    if (c) {
+      atomic_fetch_add_explicit(&sc->pools[node].cache_pops_remote, 1, memory_order_relaxed);
+      *out_node = n;
+      return c;
+    }
+  }
+  return NULL;
+}
+
+/* A slab being pushed: the off-page node it will be linked by, plus the
+ * pool and index computed from the header while it is still readable. */
+typedef struct CachePushItem {
+  Slab* slab;
+  SlabNodePool* pool;
+  CachedSlab* node;
+  uint32_t idx;
+  uint32_t depth;  /* Pool depth below this slab (warm floor check) */
+} CachePushItem;
+
+/* First half of a push: runs while the caller still owns the slab and its
+ * header is intact. `recycled` is false for slab_reserve() pushes, which
+ * must not count towards empty_slab_recycled/overflowed.
  *
  * Safety invariant: Slab must be fully unlinked from partial/full lists
  * before calling this function. Asserted defensively.
  */
-static void cache_push(SizeClassAlloc* sc, Slab* s) {
+static void cache_push_prepare(SizeClassAlloc* sc, Slab* s, CachePushItem* it, bool recycled) {
   /* Verify slab was properly unlinked from epoch lists.
    * Caching a slab that's still on a list would corrupt the list structure
    * and allow concurrent allocation/free races. */
@@ -1028,11 +2752,118 @@ static void cache_push(SizeClassAlloc* sc, Slab* s) {
   s->prev = NULL;  /* Defensive: ensure no dangling pointers */
   s->next = NULL;
   
-  /* Snapshot slab_id and was_published from header NOW, before madvise.
-   * After madvise zeros the header, these fields become unreadable.
-   * We must store them off-page in the cache entry. */
-  uint32_t id_snapshot = s->slab_id;
-  bool was_pub_snapshot = s->was_published;
+  /* Recycled slabs go back to the pool of the node backing their memory.
+   * The slab's cache node is addressed by (arena ordinal, position); read
+   * both from the header NOW, before madvise zeros it. */
+  SlabNodePool* pool = &sc->pools[s->numa_node];
+  SlabArena* ar = pool->arena_dir[s->arena_ord / SLAB_ARENA_DIR_BLOCK][s->arena_ord % SLAB_ARENA_DIR_BLOCK];
+  uint32_t pos = (uint32_t)(((uint8_t*)s - ar->base) / sc->slab_bytes);
+  it->slab = s;
+  it->pool = pool;
+  it->node = &ar->nodes[pos];
+  it->idx = ((uint32_t)s->arena_ord << SLAB_CACHE_POS_BITS) | pos;
+  
+  /* Snapshot slab_id and was_published into the off-page node. After
+   * madvise zeros the header, these fields become unreadable there. */
+  it->node->slab_id = s->slab_id;
+  it->node->was_published = s->was_published;
+  it->node->clean = false;  /* Set again only once its pages are returned */
+  it->node->cached_ms = coarse_ms();
+  if (s->quota_label) {
+    atomic_fetch_sub_explicit(&sc->parent_alloc->label_quota[s->quota_label - 1u].committed,
+                              sc->slab_bytes, memory_order_relaxed);
+    s->quota_label = 0;
+  }
+
+  /* A slab that was never reachable through current_partial can't have a
+   * lock-free allocator still minting handles from it, so its ID goes back
+   * to the registry (generation bumped) and new_slab() takes one again on
+   * reuse. Published slabs keep theirs: a stale fast-path reader may still
+   * encode s->slab_id, and that must never name some other slab. */
+  if (!s->was_published) {
+    reg_free_id(&sc->parent_alloc->reg, s->slab_id);
+    it->node->slab_id = REG_ID_NONE;
+  }
+  
+  /* Classify against the soft capacity and stamp cache_state now: writing
+   * the header after madvise would fault the first page straight back in. */
+  uint32_t depth = atomic_fetch_add_explicit(&pool->cache_count, 1u, memory_order_relaxed);
+  uint32_t capacity = atomic_load_explicit(&sc->cache_capacity, memory_order_relaxed);
+  it->depth = depth;
+  s->cache_state = depth < capacity ? SLAB_CACHED : SLAB_OVERFLOWED;
+  if (!recycled) return;
+  if (depth < capacity) {
+    atomic_fetch_add_explicit(&sc->empty_slab_recycled, 1, memory_order_relaxed);
+  } else {
+    atomic_fetch_add_explicit(&sc->empty_slab_overflowed, 1, memory_order_relaxed);
+  }
+}
+
+/* Should a never-published slab being pushed return its pages?
+ * No while its pool holds fewer than warm_floor slabs (slab_reserve's
+ * SLAB_RESERVE_KEEP_WARM): the bottom of each stack stays resident.
+ * Never for grouped classes: the slab shares its pages with neighbours
+ * that may be in use, so only a trim can return them. */
+static inline bool cache_push_wants_madvise(SizeClassAlloc* sc, const CachePushItem* it) {
+  if (sc->release_bytes > sc->slab_bytes) return false;  /* Grouped: cache_trim_units() */
+  if (it->node->was_published) return false;
+  if (it->depth < atomic_load_explicit(&sc->warm_floor, memory_order_relaxed)) {
+    atomic_fetch_add_explicit(&sc->warm_madvise_skips, 1, memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+/* The node's slab pages were returned: counted until the node is popped.
+ * Called while the node is still private (before linking, or detached). */
+static inline void cache_mark_clean(SlabNodePool* pool, CachedSlab* node) {
+  node->clean = true;
+  atomic_fetch_add_explicit(&pool->cache_clean, 1u, memory_order_relaxed);
+}
+
+/* Second half of a push: link the node on top of its pool's stack.
+ * Release publishes the node fields (and any madvise) to the acquiring pop.
+ * After this point, another thread can pop and reinitialize the slab. */
+static void cache_push_link(const CachePushItem* it) {
+  SlabNodePool* pool = it->pool;
+  uint64_t head = atomic_load_explicit(&pool->cache_head, memory_order_relaxed);
+  for (;;) {
+    atomic_store_explicit(&it->node->next, (uint32_t)head, memory_order_relaxed);
+    uint64_t want = ((head >> 32) + 1u) << 32 | it->idx;
+    if (atomic_compare_exchange_weak_explicit(&pool->cache_head, &head, want,
+                                              memory_order_release, memory_order_relaxed)) {
+      return;
+    }
+    atomic_fetch_add_explicit(&pool->cache_cas_retries, 1, memory_order_relaxed);
+  }
+}
+
+/* Push empty slab to cache for reuse.
+ *
+ * Lock-free: fill the slab's own off-page node, then one CAS links it on
+ * top of the pool stack. Epoch rotation bursts that retire thousands of
+ * slabs no longer serialize on a cache mutex, and nothing is malloc'd.
+ * cache_capacity is a soft bound: pushes beyond it still succeed (the old
+ * overflow list was unbounded too) but are counted as overflow.
+ *
+ * Critical design decision: madvise BEFORE the slab becomes reachable.
+ * - madvise() can take 5-50µs (variable, depends on kernel state)
+ * - Only the recycling thread pays for it; no lock is held meanwhile
+ *
+ * BATCHED/LAZY reclaim modes route through cache_push_batch() (batch of one)
+ * so single recycles honour the allocator's advice too.
+ */
+static void cache_push_batch(SizeClassAlloc* sc, Slab** slabs, size_t n);
+static void cache_adapt_tick(SizeClassAlloc* sc, uint32_t now_ms);
+
+static void cache_push(SizeClassAlloc* sc, Slab* s) {
+  if (atomic_load_explicit(&sc->parent_alloc->reclaim_mode, memory_order_relaxed) != SLAB_RECLAIM_IMMEDIATE) {
+    cache_push_batch(sc, &s, 1);
+    return;
+  }
+  
+  CachePushItem it;
+  cache_push_prepare(sc, s, &it, true);
   
   /* RSS reclamation: madvise BEFORE making slab reachable via cache.
    *
@@ -1042,7 +2873,7 @@ static void cache_push(SizeClassAlloc* sc, Slab* s) {
    * BEFORE the original thread completes madvise, causing catastrophic
    * header corruption (free_count=UINT32_MAX, object_count=0).
    *
-   * New code: madvise → lock → insert into cache → unlock
+   * New code: madvise → push onto cache stack
    * This eliminates the reuse-before-madvise race entirely.
    *
    * Only madvise slabs that were NEVER published to current_partial
@@ -1050,252 +2881,959 @@ static void cache_push(SizeClassAlloc* sc, Slab* s) {
    * pointers even after retirement, so they must never be madvised.
    *
    * Trade-off: Published slabs keep RSS, but never-published slabs reclaim pages.
+   * Slabs under the class's warm floor are kept resident too.
    * Gated by ENABLE_RSS_RECLAMATION compile flag.
    */
   #if ENABLE_RSS_RECLAMATION && defined(__linux__)
-  if (!was_pub_snapshot) {
+  if (cache_push_wants_madvise(sc, &it)) {
     atomic_fetch_add_explicit(&sc->madvise_calls, 1, memory_order_relaxed);
-    int ret = madvise(s, SLAB_PAGE_SIZE, MADV_DONTNEED);
+    int ret = madvise(s, sc->slab_bytes, MADV_DONTNEED);
     if (ret == 0) {
-      atomic_fetch_add_explicit(&sc->madvise_bytes, SLAB_PAGE_SIZE, memory_order_relaxed);
+      atomic_fetch_add_explicit(&sc->madvise_bytes, sc->slab_bytes, memory_order_relaxed);
+      cache_mark_clean(it.pool, it.node);
     } else {
       atomic_fetch_add_explicit(&sc->madvise_failures, 1, memory_order_relaxed);
     }
   }
   #endif
   
-  /* Now insert into cache. After this point, another thread can pop this slab.
-   * If we madvised above, the header is already zeroed and we rely on the
-   * off-page snapshots (id_snapshot, was_pub_snapshot) for metadata. */
-  LOCK_WITHOUT_PROBE(&sc->cache_lock, LOCK_RANK_CACHE, "sc->cache_lock");
-  
-  if (sc->cache_size < sc->cache_capacity) {
-    /* Fast path: array cache has space (common case, 32 entries).
-     * Store slab pointer and snapshots (not header fields, which may be zero). */
-    sc->slab_cache[sc->cache_size].slab = s;
-    sc->slab_cache[sc->cache_size].slab_id = id_snapshot;
-    sc->slab_cache[sc->cache_size].was_published = was_pub_snapshot;
-    sc->cache_size++;
-    s->cache_state = SLAB_CACHED;  /* Safe: cache_state not in madvised region */
-    atomic_fetch_add_explicit(&sc->empty_slab_recycled, 1, memory_order_relaxed);
-  } else {
-    /* Slow path: array cache full, push to overflow list.
-     * Allocate heap node to store slab metadata. If malloc fails, we skip
-     * caching this slab (it leaks until allocator_destroy, but better than crashing). */
-    CachedNode* node = (CachedNode*)malloc(sizeof(CachedNode));
-    if (!node) {
-      /* Out of memory for overflow node. Skip caching.
-       * Slab stays mapped but unusable until allocator shutdown. */
-      UNLOCK_WITH_RANK(&sc->cache_lock);
-      return;
+  cache_push_link(&it);
+  cache_adapt_tick(sc, coarse_ms());
+}
+
+/* ------------------------------ Batched page return ------------------------------ */
+
+/* Slabs handled per cache_push_batch() chunk (bounds the stack arrays) */
+#define RECLAIM_BATCH_MAX 256u
+
+#if ENABLE_RSS_RECLAMATION && defined(__linux__)
+
+#if defined(SYS_process_madvise) && defined(SYS_pidfd_open)
+/* pidfd for our own process, reopened after fork (a cached fd would
+ * otherwise point at the parent). -1 once the kernel rejected
+ * process_madvise for this advice; callers then fall back to madvise(). */
+static pthread_mutex_t g_self_pidfd_lock = PTHREAD_MUTEX_INITIALIZER;
+static int g_self_pidfd = -1;
+static pid_t g_self_pidfd_pid = 0;
+static _Atomic int g_process_madvise_unsupported = 0;
+
+static int self_pidfd(void) {
+  pid_t pid = getpid();
+  pthread_mutex_lock(&g_self_pidfd_lock);
+  if (g_self_pidfd_pid != pid) {
+    /* Never close an fd inherited across fork: the child may have reused
+     * the number. Just forget it and open our own. */
+    g_self_pidfd = (int)syscall(SYS_pidfd_open, pid, 0u);
+    g_self_pidfd_pid = pid;
+  }
+  int fd = g_self_pidfd;
+  pthread_mutex_unlock(&g_self_pidfd_lock);
+  return fd;
+}
+#endif
+
+/* Return ranges[0..nr) to the kernel with `advice`.
+ *
+ * One process_madvise() covers up to UIO_MAXIOV (1024) ranges. Kernels that
+ * refuse MADV_DONTNEED/MADV_FREE through process_madvise (older than 6.13
+ * for self-targeting) report EINVAL/EPERM once; from then on, and for any
+ * ranges a partial call left over, plain madvise() per range is used. */
+static void reclaim_ranges(SizeClassAlloc* sc, struct iovec* ranges, size_t nr, int advice) {
+  size_t done = 0;
+#if defined(SYS_process_madvise) && defined(SYS_pidfd_open)
+  if (nr > 1 && !atomic_load_explicit(&g_process_madvise_unsupported, memory_order_relaxed)) {
+    int fd = self_pidfd();
+    while (fd >= 0 && done < nr) {
+      size_t cnt = nr - done > 1024u ? 1024u : nr - done;
+      size_t want = 0;
+      for (size_t i = 0; i < cnt; i++) want += ranges[done + i].iov_len;
+      atomic_fetch_add_explicit(&sc->madvise_calls, 1, memory_order_relaxed);
+      long got = syscall(SYS_process_madvise, fd, &ranges[done], cnt, advice, 0u);
+      if (got < 0) {
+        if (errno == EINVAL || errno == EPERM || errno == ENOSYS || errno == EBADF) {
+          atomic_store_explicit(&g_process_madvise_unsupported, 1, memory_order_relaxed);
+        } else {
+          atomic_fetch_add_explicit(&sc->madvise_failures, 1, memory_order_relaxed);
+        }
+        break;
+      }
+      atomic_fetch_add_explicit(&sc->madvise_bytes, (uint64_t)got, memory_order_relaxed);
+      if ((size_t)got < want) {
+        /* Partial: skip fully advised ranges, redo the rest with madvise */
+        size_t left = (size_t)got;
+        while (left >= ranges[done].iov_len) left -= ranges[done++].iov_len;
+        break;
+      }
+      done += cnt;
     }
-    
-    /* Store slab pointer and snapshots in heap node (not header fields). */
-    node->slab = s;
-    node->slab_id = id_snapshot;
-    node->was_published = was_pub_snapshot;
-    node->prev = sc->cache_overflow_tail;
-    node->next = NULL;
-    
-    /* Append to tail of doubly-linked list */
-    if (sc->cache_overflow_tail) {
-      sc->cache_overflow_tail->next = node;
+  }
+#endif
+  for (; done < nr; done++) {
+    atomic_fetch_add_explicit(&sc->madvise_calls, 1, memory_order_relaxed);
+    if (madvise(ranges[done].iov_base, ranges[done].iov_len, advice) == 0) {
+      atomic_fetch_add_explicit(&sc->madvise_bytes, ranges[done].iov_len, memory_order_relaxed);
     } else {
-      sc->cache_overflow_head = node;  /* First node in list */
+      atomic_fetch_add_explicit(&sc->madvise_failures, 1, memory_order_relaxed);
     }
-    sc->cache_overflow_tail = node;
-    sc->cache_overflow_len++;
-    
-    s->cache_state = SLAB_OVERFLOWED;  /* Safe: cache_state not in madvised region */
-    atomic_fetch_add_explicit(&sc->empty_slab_overflowed, 1, memory_order_relaxed);
   }
-  
-  UNLOCK_WITH_RANK(&sc->cache_lock);
 }
 
-/* ------------------------------ Slab allocation ------------------------------ */
+static int cmp_slab_addr(const void* x, const void* y) {
+  uintptr_t a = (uintptr_t)*(Slab* const*)x, b = (uintptr_t)*(Slab* const*)y;
+  return (a > b) - (a < b);
+}
+#endif /* ENABLE_RSS_RECLAMATION && __linux__ */
 
-/* Allocate a new slab for a size class and epoch.
- *
- * Two-path allocation strategy:
- * 1. Cache hit: Pop recycled slab from cache (cheap, no syscall)
- * 2. Cache miss: Allocate fresh page via mmap (expensive, ~2µs)
- *
- * Cache-first avoids mmap overhead. Cache hit rate >97% in production.
- * Recycled slabs may have been madvised, so all metadata must be reinitialized.
+/* Push many empty slabs of one class (epoch_close, epoch_release_all).
  *
- * Generation bumping on reuse provides ABA protection:
- * - Old handles encode old generation number
- * - After reuse, generation increments
- * - Old handles fail validation (generation mismatch)
- * - Prevents use-after-free even if handle references same slab_id
+ * IMMEDIATE mode: plain cache_push() per slab.
+ * BATCHED/LAZY: prepare every slab, sort the never-published ones by address
+ * and merge neighbours into ranges (slabs carved back to back from an arena
+ * coalesce into one range), return the ranges in one vectored call, then
+ * link all slabs. Same madvise-before-reachable ordering as cache_push().
  */
-static Slab* new_slab(SlabAllocator* a, SizeClassAlloc* sc, uint32_t epoch_id) {
-  uint32_t obj_size = sc->object_size;
-
-  /* Try cache first. Avoids mmap syscall if we have recycled slabs available.
-   * cache_pop() returns slab pointer, slab_id, and was_published (stored off-page). */
-  uint32_t cached_id = UINT32_MAX;
-  bool cached_was_published = false;
-  Slab* s = cache_pop(sc, &cached_id, &cached_was_published);
-  
-  if (s) {
-    /* Cache hit! Bump generation to invalidate old handles.
-     * Without this, a handle from the slab's previous incarnation would
-     * still validate, leading to use-after-free. */
-    (void)reg_bump_gen(&a->reg, cached_id);
-    
-    /* Reinitialize all slab metadata.
-     * If RSS reclamation is enabled, madvise() zeroed the header when this
-     * slab was recycled. Even without madvise, defensive reinitialization
-     * ensures clean state (prevents stale list pointers, corrupted counts). */
-    uint32_t expected_count = slab_object_count(obj_size);
-    
-    /* CRITICAL: Handle slot field is only 8 bits (bits [17:10] in handle encoding).
-     * If object_count > 255, handle encoding silently truncates slot index,
-     * causing free_obj() to free wrong slot and corrupt bitmap. */
-    assert(expected_count <= 255 && "handle slot field is 8-bit; object_count must be <=255");
-    
-    s->prev = NULL;
-    s->next = NULL;
-    atomic_store_explicit(&s->magic, SLAB_MAGIC, memory_order_relaxed);
-    s->object_size = obj_size;
-    s->object_count = expected_count;
-    s->list_id = SLAB_LIST_NONE;
-    s->cache_state = SLAB_ACTIVE;
-    s->epoch_id = epoch_id;
-    s->era = atomic_load_explicit(&a->epoch_era[epoch_id], memory_order_acquire);
-    s->was_published = cached_was_published;   /* Restore from off-page cache (survived madvise) */
-    s->slab_id = cached_id;  /* Restore ID from cache (survived madvise) */
-    atomic_store_explicit(&s->free_count, expected_count, memory_order_relaxed);
-    
-    /* Clear allocation bitmap.
-     * Each bit represents one slot: 0=free, 1=allocated.
-     * Start with all zeros (all slots free). */
-    _Atomic uint32_t* bm = slab_bitmap_ptr(s);
-    uint32_t words = slab_bitmap_words(expected_count);
-    for (uint32_t i = 0; i < words; i++) {
-      atomic_store_explicit(&bm[i], 0u, memory_order_relaxed);
-    }
-    
-    /* Republish slab pointer in registry.
-     * The pointer may have been set to NULL during recycling, or this may
-     * be the first time we're publishing it. Either way, make it findable. */
-    reg_set_ptr(&a->reg, cached_id, s);
-    
-    return s;  /* Cache hit path complete */
+static void cache_push_batch(SizeClassAlloc* sc, Slab** slabs, size_t n) {
+  const uint32_t mode = atomic_load_explicit(&sc->parent_alloc->reclaim_mode, memory_order_relaxed);
+  if (mode == SLAB_RECLAIM_IMMEDIATE) {
+    for (size_t i = 0; i < n; i++) cache_push(sc, slabs[i]);
+    return;
   }
 
-  /* Cache miss: no recycled slabs available, must allocate fresh page.
-   * This path is ~100x slower than cache hit due to mmap syscall.
-   * Counter helps diagnose "why is allocation slow?" (cache pressure). */
-  atomic_fetch_add_explicit(&sc->new_slab_count, 1, memory_order_relaxed);
-  atomic_fetch_add_explicit(&sc->slow_path_cache_miss, 1, memory_order_relaxed);
-  
-  /* Allocate 4KB page from kernel via mmap.
-   * Page-aligned for fast address arithmetic: (ptr & ~4095) recovers header. */
-  void* page = map_one_page();
-  if (!page) return NULL;  /* mmap failed (out of memory) */
-
-#if ENABLE_DIAGNOSTIC_COUNTERS
-  /* Track committed bytes (mmap'd memory) for RSS analysis */
-  atomic_fetch_add_explicit(&sc->committed_bytes, SLAB_PAGE_SIZE, memory_order_relaxed);
+  CachePushItem items[RECLAIM_BATCH_MAX];
+#if ENABLE_RSS_RECLAMATION && defined(__linux__)
+  Slab* unpub[RECLAIM_BATCH_MAX];
+  struct iovec ranges[RECLAIM_BATCH_MAX];
+  const int advice = mode == SLAB_RECLAIM_LAZY ? MADV_FREE : MADV_DONTNEED;
 #endif
 
-  s = (Slab*)page;  /* Slab header lives at start of page */
+  for (size_t off = 0; off < n; off += RECLAIM_BATCH_MAX) {
+    size_t cnt = n - off < RECLAIM_BATCH_MAX ? n - off : RECLAIM_BATCH_MAX;
+#if ENABLE_RSS_RECLAMATION && defined(__linux__)
+    size_t nunpub = 0;
+#endif
+    for (size_t i = 0; i < cnt; i++) {
+      cache_push_prepare(sc, slabs[off + i], &items[i], true);
+#if ENABLE_RSS_RECLAMATION && defined(__linux__)
+      if (cache_push_wants_madvise(sc, &items[i])) {
+        unpub[nunpub++] = slabs[off + i];
+        cache_mark_clean(items[i].pool, items[i].node);
+      }
+#endif
+    }
 
-  /* Calculate how many objects fit in this page.
-   * Formula accounts for: slab header + bitmap + alignment → usable space → object count.
-   * Example: 4096B page, 128B objects → 64B header + 4B bitmap → ~3968B usable → 31 objects */
-  uint32_t count = slab_object_count(obj_size);
-  
-  /* CRITICAL: Handle slot field is only 8 bits (bits [17:10] in handle encoding).
-   * If object_count > 255, handle encoding silently truncates slot index,
-   * causing free_obj() to free wrong slot and corrupt bitmap. */
-  assert(count <= 255 && "handle slot field is 8-bit; object_count must be <=255");
-  
-  if (count == 0) {
-    /* Pathological case: object too large to fit even one slot after header.
-     * Should never happen with our size classes (64-768 bytes). */
-    unmap_one_page(page);
-    errno = EINVAL;
-    return NULL;
-  }
+#if ENABLE_RSS_RECLAMATION && defined(__linux__)
+    if (nunpub > 0) {
+      qsort(unpub, nunpub, sizeof(Slab*), cmp_slab_addr);
+      size_t nr = 0;
+      for (size_t i = 0; i < nunpub; i++) {
+        uint8_t* p = (uint8_t*)unpub[i];
+        if (nr > 0 && (uint8_t*)ranges[nr - 1].iov_base + ranges[nr - 1].iov_len == p) {
+          ranges[nr - 1].iov_len += sc->slab_bytes;
+        } else {
+          ranges[nr].iov_base = p;
+          ranges[nr].iov_len = sc->slab_bytes;
+          nr++;
+        }
+      }
+      atomic_fetch_add_explicit(&sc->madvise_batches, 1, memory_order_relaxed);
+      atomic_fetch_add_explicit(&sc->madvise_ranges, nr, memory_order_relaxed);
+      reclaim_ranges(sc, ranges, nr, advice);
+    }
+#endif
 
-  /* Allocate registry ID for handle encoding.
-   * Registry maps slab_id → (slab pointer, generation counter).
-   * Enables portable handles and ABA protection. */
-  uint32_t id = reg_alloc_id(&a->reg);
-  if (id == UINT32_MAX) {
-    /* Registry allocation failed (out of memory for registry growth) */
-    unmap_one_page(page);
-    errno = ENOMEM;
-    return NULL;
+    for (size_t i = 0; i < cnt; i++) cache_push_link(&items[i]);
   }
+  cache_adapt_tick(sc, coarse_ms());
+}
 
-  /* Initialize slab header with metadata */
-  s->prev = NULL;  /* Not on any list yet */
-  s->next = NULL;
-  atomic_store_explicit(&s->magic, SLAB_MAGIC, memory_order_relaxed);  /* "SLAB" in ASCII */
-  s->object_size = obj_size;   /* Which size class: 64, 96, 128, etc. */
-  s->object_count = count;      /* How many slots calculated above */
-  atomic_store_explicit(&s->free_count, count, memory_order_relaxed);  /* All slots free initially */
-  s->list_id = SLAB_LIST_NONE;  /* Not on partial/full list until added */
-  s->cache_state = SLAB_ACTIVE; /* In use (not cached) */
-  s->epoch_id = epoch_id;       /* Temporal grouping: objects from this epoch */
-  s->era = a->epoch_era[epoch_id];  /* Monotonic timestamp for observability */
-  s->was_published = false;     /* Fresh slab not yet reachable lock-free */
-  s->slab_id = id;              /* Registry ID for handle encoding */
+/* ------------------------------ Cache sizing and trimming ------------------------------ */
 
-  /* Initialize allocation bitmap to all zeros (all slots free) */
-  _Atomic uint32_t* bm = slab_bitmap_ptr(s);
-  uint32_t words = slab_bitmap_words(count);
-  for (uint32_t i = 0; i < words; i++) {
-    atomic_store_explicit(&bm[i], 0u, memory_order_relaxed);
+#if ENABLE_RSS_RECLAMATION && defined(__linux__)
+/* Relink a private chain first..tail on top of a pool's stack (one CAS). */
+static void cache_push_chain(SlabNodePool* pool, uint32_t first, CachedSlab* tail) {
+  uint64_t head = atomic_load_explicit(&pool->cache_head, memory_order_relaxed);
+  for (;;) {
+    atomic_store_explicit(&tail->next, (uint32_t)head, memory_order_relaxed);
+    uint64_t want = ((head >> 32) + 1u) << 32 | first;
+    if (atomic_compare_exchange_weak_explicit(&pool->cache_head, &head, want,
+                                              memory_order_release, memory_order_relaxed)) {
+      return;
+    }
+    atomic_fetch_add_explicit(&pool->cache_cas_retries, 1, memory_order_relaxed);
   }
-
-  /* Publish slab in registry so handles can find it */
-  reg_set_ptr(&a->reg, id, s);
-
-  return s;  /* Fresh slab ready for allocation */
 }
 
-/* ------------------------------ Handle encoding (Portable, ABA-safe) ------------------------------ */
+/* Return one batch of detached cached slabs (sorted, coalesced like
+ * cache_push_batch()). */
+static void cache_trim_flush(SizeClassAlloc* sc, Slab** slabs, size_t n, int advice) {
+  struct iovec ranges[RECLAIM_BATCH_MAX];
+  qsort(slabs, n, sizeof(Slab*), cmp_slab_addr);
+  size_t nr = 0;
+  for (size_t i = 0; i < n; i++) {
+    uint8_t* p = (uint8_t*)slabs[i];
+    if (nr > 0 && (uint8_t*)ranges[nr - 1].iov_base + ranges[nr - 1].iov_len == p) {
+      ranges[nr - 1].iov_len += sc->slab_bytes;
+    } else {
+      ranges[nr].iov_base = p;
+      ranges[nr].iov_len = sc->slab_bytes;
+      nr++;
+    }
+  }
+  atomic_fetch_add_explicit(&sc->madvise_batches, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&sc->madvise_ranges, nr, memory_order_relaxed);
+  reclaim_ranges(sc, ranges, nr, advice);
+}
 
-/* Portable handle encoding v1: slab_id + generation + slot + class + version
- * 
- * Layout (64-bit):
- *   [63:42] slab_id (22 bits) - registry index (max 4M slabs)
- *   [41:18] generation (24 bits) - ABA protection (wraps after 16M reuses)
- *   [17:10] slot (8 bits) - object index within slab (max 255 objects)
- *   [9:2]   size_class (8 bits) - 0-255 size classes
- *   [1:0]   version (2 bits) - handle format version (v1=0b01)
- * 
- * Key properties:
- * - No raw pointers (portable across all platforms)
- * - Generation stored in registry (survives madvise)
- * - 24-bit generation: safe against ABA even under pathological churn
- * - 2-bit version field allows future format changes
- * 
- * Design constraints:
- * - 8-bit slot limits max objects per slab to 255
- * - This bounds min object size to ~16 bytes (4096 / 255)
- * - Current size classes (64-768 bytes) well within limits
- * - If smaller classes needed, must rev handle format (use version bits)
- */
-#define HANDLE_VERSION_V1 0x1u
+/* May a trim return this cached slab's pages? Dirty never-published slabs
+ * at once, published ones after SLAB_CACHE_TRIM_GRACE_MS in the cache (they
+ * were hot a moment ago and tend to be popped again soon). */
+static inline bool cache_trim_eligible(const CachedSlab* node, uint32_t now_ms) {
+  return !node->clean &&
+         (!node->was_published || now_ms - node->cached_ms >= SLAB_CACHE_TRIM_GRACE_MS);
+}
 
-static inline SlabHandle handle_pack(uint32_t slab_id, uint32_t gen, uint8_t slot, uint8_t cls) {
-  return ((uint64_t)(slab_id & 0x3FFFFFu) << 42)  /* 22 bits */
-       | ((uint64_t)(gen & 0xFFFFFFu) << 18)      /* 24 bits */
-       | ((uint64_t)slot << 10)                   /* 8 bits */
-       | ((uint64_t)cls << 2)                     /* 8 bits */
-       | (uint64_t)HANDLE_VERSION_V1;             /* 2 bits */
+static int cmp_node_slab_addr(const void* x, const void* y) {
+  uintptr_t a = (uintptr_t)(*(CachedSlab* const*)x)->slab;
+  uintptr_t b = (uintptr_t)(*(CachedSlab* const*)y)->slab;
+  return (a > b) - (a < b);
 }
 
-inline void handle_unpack(SlabHandle h, uint32_t* slab_id, uint32_t* gen, uint32_t* slot, uint32_t* cls) {
-  uint32_t version = (uint32_t)(h & 0x3u);
-  if (version != HANDLE_VERSION_V1) {
+/* Trim pass of a grouped class (release_bytes > slab_bytes: sub-page slabs
+ * on 16KB/64KB-page kernels, or huge-page-backed arenas).
+ *
+ * A release unit is shared by release_bytes / slab_bytes slabs, so it is
+ * returned only when every one of them is eligible AND on the detached
+ * chain starting at idx. That chain is private to this trim, so no pop can
+ * reinitialize a neighbour while the unit is advised. Units with a slab in
+ * use, among the kept nodes, or detached by a concurrent trim stay
+ * resident. Marks the nodes of returned units clean; returns their count.
+ */
+static uint32_t cache_trim_units(SizeClassAlloc* sc, SlabNodePool* pool, uint32_t idx,
+                                 uint32_t now_ms, int advice) {
+  const size_t per_unit = sc->release_bytes / sc->slab_bytes;
+  size_t n = 0;
+  for (uint32_t i = idx; i != SLAB_CACHE_NIL;) {
+    CachedSlab* node = cache_node_at(pool, i);
+    if (cache_trim_eligible(node, now_ms)) n++;
+    i = atomic_load_explicit(&node->next, memory_order_relaxed);
+  }
+  if (n < per_unit) return 0;
+  CachedSlab** cand = (CachedSlab**)malloc(n * sizeof(CachedSlab*));
+  if (!cand) return 0;  /* Next trim tries again */
+  n = 0;
+  for (uint32_t i = idx; i != SLAB_CACHE_NIL;) {
+    CachedSlab* node = cache_node_at(pool, i);
+    if (cache_trim_eligible(node, now_ms)) cand[n++] = node;
+    i = atomic_load_explicit(&node->next, memory_order_relaxed);
+  }
+  qsort(cand, n, sizeof(CachedSlab*), cmp_node_slab_addr);
+
+  /* Sorted and distinct: a unit is complete iff the per_unit candidates
+   * starting at its first one all lie in it */
+  const uintptr_t unit_mask = ~(uintptr_t)(sc->release_bytes - 1u);
+  struct iovec ranges[RECLAIM_BATCH_MAX];
+  size_t nr = 0;
+  uint32_t trimmed = 0;
+  uint64_t units = 0;
+  size_t i = 0;
+  while (i < n) {
+    const uintptr_t unit = (uintptr_t)cand[i]->slab & unit_mask;
+    if (i + per_unit > n || ((uintptr_t)cand[i + per_unit - 1u]->slab & unit_mask) != unit) {
+      while (i < n && ((uintptr_t)cand[i]->slab & unit_mask) == unit) i++;
+      continue;
+    }
+    for (size_t j = i; j < i + per_unit; j++) cache_mark_clean(pool, cand[j]);
+    i += per_unit;
+    trimmed += (uint32_t)per_unit;
+    units++;
+    if (nr > 0 && (uintptr_t)ranges[nr - 1].iov_base + ranges[nr - 1].iov_len == unit) {
+      ranges[nr - 1].iov_len += sc->release_bytes;
+      continue;
+    }
+    if (nr == RECLAIM_BATCH_MAX) {
+      atomic_fetch_add_explicit(&sc->madvise_batches, 1, memory_order_relaxed);
+      atomic_fetch_add_explicit(&sc->madvise_ranges, nr, memory_order_relaxed);
+      reclaim_ranges(sc, ranges, nr, advice);
+      nr = 0;
+    }
+    ranges[nr].iov_base = (void*)unit;
+    ranges[nr].iov_len = sc->release_bytes;
+    nr++;
+  }
+  if (nr > 0) {
+    atomic_fetch_add_explicit(&sc->madvise_batches, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&sc->madvise_ranges, nr, memory_order_relaxed);
+    reclaim_ranges(sc, ranges, nr, advice);
+  }
+  free(cand);
+  if (units) atomic_fetch_add_explicit(&sc->release_units, units, memory_order_relaxed);
+  return trimmed;
+}
+#endif
+
+/* Return the pages of cached slabs below the newest `keep` of one pool.
+ *
+ * The push path only madvises never-published slabs, so a cache that grew
+ * during a burst otherwise stays resident forever. Trimming detaches the
+ * whole stack with one CAS (pushes and pops meanwhile see an empty or fresh
+ * stack), puts the newest `keep` nodes straight back, and walks the rest:
+ * - Never-published dirty slabs are returned at once, as on push
+ * - Published ones after SLAB_CACHE_TRIM_GRACE_MS in the cache. That is
+ *   residency, not safety: a stale fast-path claimer pins its slot in the
+ *   EpochState, never the slab, and fails its re-check of the slot, so it
+ *   doesn't touch the zeroed header again
+ * Grouped classes return whole release units instead (cache_trim_units).
+ * The remainder goes back dirty-first, so pops keep preferring resident
+ * slabs. keep is raised to the class's warm floor. Returns slabs trimmed.
+ * Caller must not hold sc->lock.
+ */
+static uint32_t cache_trim_pool(SizeClassAlloc* sc, SlabNodePool* pool, uint32_t keep, uint32_t now_ms) {
+#if ENABLE_RSS_RECLAMATION && defined(__linux__)
+  uint32_t floor = atomic_load_explicit(&sc->warm_floor, memory_order_relaxed);
+  if (keep < floor) keep = floor;
+  uint32_t count = atomic_load_explicit(&pool->cache_count, memory_order_relaxed);
+  uint32_t clean = atomic_load_explicit(&pool->cache_clean, memory_order_relaxed);
+  if (count <= keep || count - clean <= keep) return 0;
+
+  /* Detach */
+  uint64_t head = atomic_load_explicit(&pool->cache_head, memory_order_acquire);
+  for (;;) {
+    if ((uint32_t)head == SLAB_CACHE_NIL) return 0;
+    uint64_t want = ((head >> 32) + 1u) << 32 | SLAB_CACHE_NIL;
+    if (atomic_compare_exchange_weak_explicit(&pool->cache_head, &head, want,
+                                              memory_order_acquire, memory_order_acquire)) {
+      break;
+    }
+  }
+
+  /* Newest `keep` nodes go back untouched */
+  uint32_t first = (uint32_t)head;
+  uint32_t idx = first;
+  CachedSlab* last = NULL;
+  for (uint32_t i = 0; i < keep && idx != SLAB_CACHE_NIL; i++) {
+    last = cache_node_at(pool, idx);
+    idx = atomic_load_explicit(&last->next, memory_order_relaxed);
+  }
+  if (last) cache_push_chain(pool, first, last);
+  if (idx == SLAB_CACHE_NIL) return 0;
+
+  const int advice = atomic_load_explicit(&sc->parent_alloc->reclaim_mode, memory_order_relaxed) ==
+                     SLAB_RECLAIM_LAZY ? MADV_FREE : MADV_DONTNEED;
+  const bool grouped = sc->release_bytes > sc->slab_bytes;
+  Slab* batch[RECLAIM_BATCH_MAX];
+  size_t nb = 0;
+  uint32_t trimmed = grouped ? cache_trim_units(sc, pool, idx, now_ms, advice) : 0;
+  uint32_t dirty_first = SLAB_CACHE_NIL, clean_first = SLAB_CACHE_NIL;
+  CachedSlab *dirty_tail = NULL, *clean_tail = NULL;
+  while (idx != SLAB_CACHE_NIL) {
+    CachedSlab* node = cache_node_at(pool, idx);
+    uint32_t next = atomic_load_explicit(&node->next, memory_order_relaxed);
+    if (!grouped && cache_trim_eligible(node, now_ms)) {
+      batch[nb++] = node->slab;
+      cache_mark_clean(pool, node);
+      trimmed++;
+      if (nb == RECLAIM_BATCH_MAX) {
+        cache_trim_flush(sc, batch, nb, advice);
+        nb = 0;
+      }
+    }
+    /* Append to the dirty or clean sublist, keeping relative order */
+    if (node->clean) {
+      if (clean_tail) atomic_store_explicit(&clean_tail->next, idx, memory_order_relaxed);
+      else clean_first = idx;
+      clean_tail = node;
+    } else {
+      if (dirty_tail) atomic_store_explicit(&dirty_tail->next, idx, memory_order_relaxed);
+      else dirty_first = idx;
+      dirty_tail = node;
+    }
+    idx = next;
+  }
+  if (nb > 0) cache_trim_flush(sc, batch, nb, advice);
+
+  if (dirty_tail && clean_tail) {
+    atomic_store_explicit(&dirty_tail->next, clean_first, memory_order_relaxed);
+    cache_push_chain(pool, dirty_first, clean_tail);
+  } else if (dirty_tail) {
+    cache_push_chain(pool, dirty_first, dirty_tail);
+  } else {
+    cache_push_chain(pool, clean_first, clean_tail);
+  }
+
+  if (trimmed > 0) {
+    atomic_fetch_add_explicit(&sc->cache_trims, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&sc->cache_trimmed_slabs, trimmed, memory_order_relaxed);
+  }
+  return trimmed;
+#else
+  (void)sc; (void)pool; (void)keep; (void)now_ms;
+  return 0;
+#endif
+}
+
+/* Adaptive cache target, run at most once per SLAB_CACHE_WINDOW_MS per class
+ * (new_slab, cache pushes, and the reclaimer's idle tick).
+ *
+ * Demand is slabs taken per window per pool, smoothed by an EWMA (1/4 per
+ * window; windows that passed with no tick at all count as idle). The
+ * target grows to cover the larger of the EWMA and the last window at once,
+ * so a burst is absorbed from the next epoch on. It shrinks - halving,
+ * never below demand - only after SLAB_CACHE_SHRINK_DWELL windows in a row
+ * wanted less than half of it, so a periodic workload doesn't saw the cache
+ * up and down. Pools holding more resident slabs than the target are then
+ * trimmed down to it.
+ */
+static void cache_adapt_tick(SizeClassAlloc* sc, uint32_t now_ms) {
+  uint32_t start = atomic_load_explicit(&sc->cache_adapt.window_start_ms, memory_order_relaxed);
+  if (now_ms - start < SLAB_CACHE_WINDOW_MS) return;
+  uint32_t expected = 0;
+  if (!atomic_compare_exchange_strong_explicit(&sc->cache_adapt.in_check, &expected, 1,
+                                               memory_order_acquire, memory_order_relaxed)) {
+    return;  /* Another thread runs this window */
+  }
+  start = atomic_load_explicit(&sc->cache_adapt.window_start_ms, memory_order_relaxed);
+  if (now_ms - start < SLAB_CACHE_WINDOW_MS) {
+    atomic_store_explicit(&sc->cache_adapt.in_check, 0, memory_order_release);
+    return;
+  }
+
+  SlabAllocator* a = sc->parent_alloc;
+  const uint32_t pools = a->numa_nodes ? a->numa_nodes : 1u;
+  uint64_t demand = atomic_load_explicit(&sc->cache_adapt.demand, memory_order_relaxed);
+  uint64_t taken = demand - sc->cache_adapt.window_base;
+  uint32_t windows = (now_ms - start) / SLAB_CACHE_WINDOW_MS;
+  uint64_t last_x16 = (taken << 4) / pools;
+  if (last_x16 > ((uint64_t)SLAB_CACHE_TARGET_MAX << 4)) last_x16 = (uint64_t)SLAB_CACHE_TARGET_MAX << 4;
+
+  /* One sampled window, then decay for the ones nobody ticked */
+  uint32_t ewma = sc->cache_adapt.ewma_x16;
+  ewma = ewma - ewma / 4u + (uint32_t)last_x16 / 4u;
+  for (uint32_t i = 1; i < windows && i < 32u && ewma; i++) ewma -= (ewma + 3u) / 4u;
+  sc->cache_adapt.ewma_x16 = ewma;
+  sc->cache_adapt.window_base = demand;
+  atomic_store_explicit(&sc->cache_adapt.window_start_ms, now_ms, memory_order_relaxed);
+
+  uint32_t want = (ewma + 15u) >> 4;
+  if (windows <= 1 && (uint32_t)((last_x16 + 15u) >> 4) > want) want = (uint32_t)((last_x16 + 15u) >> 4);
+  if (want < SLAB_CACHE_TARGET_MIN) want = SLAB_CACHE_TARGET_MIN;
+  if (want > SLAB_CACHE_TARGET_MAX) want = SLAB_CACHE_TARGET_MAX;
+
+  uint32_t target = atomic_load_explicit(&sc->cache_capacity, memory_order_relaxed);
+  if (want > target) {
+    target = want;
+    sc->cache_adapt.shrink_dwell = 0;
+    atomic_fetch_add_explicit(&sc->cache_adapt.grows, 1, memory_order_relaxed);
+  } else if (want < target / 2u) {
+    sc->cache_adapt.shrink_dwell += windows;
+    if (sc->cache_adapt.shrink_dwell >= SLAB_CACHE_SHRINK_DWELL) {
+      target = target / 2u > want ? target / 2u : want;
+      sc->cache_adapt.shrink_dwell = 0;
+      atomic_fetch_add_explicit(&sc->cache_adapt.shrinks, 1, memory_order_relaxed);
+    }
+  } else {
+    sc->cache_adapt.shrink_dwell = 0;
+  }
+  atomic_store_explicit(&sc->cache_capacity, target, memory_order_relaxed);
+
+  for (uint32_t n = 0; sc->pools && n < a->numa_nodes; n++) {
+    SlabNodePool* pool = &sc->pools[n];
+    uint32_t count = atomic_load_explicit(&pool->cache_count, memory_order_relaxed);
+    uint32_t clean = atomic_load_explicit(&pool->cache_clean, memory_order_relaxed);
+    if (count > clean && count - clean > target) (void)cache_trim_pool(sc, pool, target, now_ms);
+  }
+
+  atomic_store_explicit(&sc->cache_adapt.in_check, 0, memory_order_release);
+}
+
+/* ------------------------------ Memory budget ------------------------------ */
+
+/* Resident estimate for the budget: carved arena bytes minus cached slabs
+ * whose pages were returned. Slack of cached published slabs, partially
+ * advised ranges, and MADV_FREE pages not yet taken back by the kernel are
+ * all counted as resident, so this errs high. */
+uint64_t slab_resident_estimate(const SlabAllocator* a) {
+  uint64_t total = 0;
+  for (size_t i = 0; i < a->num_classes; i++) {
+    const SizeClassAlloc* sc = &a->classes[i];
+    uint64_t carved = atomic_load_explicit(&sc->arena_committed_bytes, memory_order_relaxed);
+    uint64_t clean = 0;
+    for (uint32_t n = 0; sc->pools && n < a->numa_nodes; n++) {
+      clean += atomic_load_explicit(&sc->pools[n].cache_clean, memory_order_relaxed);
+    }
+    clean *= sc->slab_bytes;
+    total += carved > clean ? carved - clean : 0;
+  }
+  return total;
+}
+
+/* Cached slabs still holding their pages. Published slabs in their trim
+ * grace count too, so a trim may give back less than this. */
+uint64_t slab_cache_idle_bytes(const SlabAllocator* a) {
+  uint64_t total = 0;
+  for (size_t i = 0; i < a->num_classes; i++) {
+    const SizeClassAlloc* sc = &a->classes[i];
+    uint64_t dirty = 0;
+    for (uint32_t n = 0; sc->pools && n < a->numa_nodes; n++) {
+      uint32_t count = atomic_load_explicit(&sc->pools[n].cache_count, memory_order_relaxed);
+      uint32_t clean = atomic_load_explicit(&sc->pools[n].cache_clean, memory_order_relaxed);
+      dirty += count > clean ? count - clean : 0;
+    }
+    total += dirty * sc->slab_bytes;
+  }
+  return total;
+}
+
+uint64_t slab_cache_demand(const SlabAllocator* a) {
+  uint64_t total = 0;
+  for (size_t i = 0; i < a->num_classes; i++) {
+    total += atomic_load_explicit(&a->classes[i].cache_adapt.demand, memory_order_relaxed);
+  }
+  return total;
+}
+
+uint64_t slab_cache_trim_idle(SlabAllocator* a) {
+  const uint32_t now_ms = coarse_ms();
+  uint64_t bytes = 0;
+  for (size_t i = 0; i < a->num_classes; i++) {
+    SizeClassAlloc* sc = &a->classes[i];
+    for (uint32_t n = 0; sc->pools && n < a->numa_nodes; n++) {
+      bytes += (uint64_t)cache_trim_pool(sc, &sc->pools[n], 0, now_ms) * sc->slab_bytes;
+    }
+  }
+  return bytes;
+}
+
+/* Over budget: trim every cache to its warm floor (published slabs still
+ * honour the trim grace), then hand CLOSING epochs to the reclaimer so
+ * slabs emptied by late frees get recycled too. Runs at most once per
+ * SLAB_CACHE_WINDOW_MS unless forced (slab_set_memory_budget). Never
+ * closes epochs synchronously: callers include the allocation slow path.
+ * A group shard first runs its group's depot check (rate-limited there). */
+static void budget_enforce(SlabAllocator* a, uint32_t now_ms, bool force) {
+  if (a->group_tick) a->group_tick(a);
+  uint64_t budget = atomic_load_explicit(&a->memory_budget, memory_order_relaxed);
+  if (budget == 0) return;
+  uint32_t last = atomic_load_explicit(&a->budget_check_ms, memory_order_relaxed);
+  if (!force) {
+    if (now_ms - last < SLAB_CACHE_WINDOW_MS) return;
+    if (!atomic_compare_exchange_strong_explicit(&a->budget_check_ms, &last, now_ms,
+                                                 memory_order_relaxed, memory_order_relaxed)) {
+      return;  /* Another thread took this window */
+    }
+  } else {
+    atomic_store_explicit(&a->budget_check_ms, now_ms, memory_order_relaxed);
+  }
+  if (slab_resident_estimate(a) <= budget) return;
+
+  atomic_fetch_add_explicit(&a->budget_enforcements, 1, memory_order_relaxed);
+  for (size_t i = 0; i < a->num_classes; i++) {
+    SizeClassAlloc* sc = &a->classes[i];
+    for (uint32_t n = 0; sc->pools && n < a->numa_nodes; n++) {
+      (void)cache_trim_pool(sc, &sc->pools[n], 0, now_ms);
+    }
+  }
+
+  SlabReclaimer* r = &a->reclaimer;
+  pthread_mutex_lock(&r->lock);
+  bool async = r->running && !r->stop;
+  pthread_mutex_unlock(&r->lock);
+  if (!async) return;
+  for (uint32_t e = 0; e < a->epoch_count; e++) {
+    if (atomic_load_explicit(&a->epoch_state[e], memory_order_acquire) != EPOCH_CLOSING) continue;
+    if (atomic_load_explicit(&a->reclaimer.pending[e], memory_order_relaxed)) continue;
+    EpochId id = epoch_make_id(e, atomic_load_explicit(&a->epoch_era[e], memory_order_acquire));
+    (void)epoch_close_async(a, id, NULL, NULL);  /* EBUSY/ESTALE: raced, skip */
+  }
+}
+
+bool slab_set_memory_budget(SlabAllocator* a, uint64_t bytes) {
+  if (!a) {
+    errno = EINVAL;
+    return false;
+  }
+  atomic_store_explicit(&a->memory_budget, bytes, memory_order_relaxed);
+  budget_enforce(a, coarse_ms(), true);
+  return true;
+}
+
+/* ------------------------------ Slab allocation ------------------------------ */
+
+/* Carve and initialize a fresh slab on `node` (new_slab cache miss,
+ * slab_reserve). Returns NULL with errno set if the arena or the registry
+ * can't grow. Caller must not hold sc->lock (takes pool->arena_lock). */
+static Slab* slab_carve_fresh(SlabAllocator* a, SizeClassAlloc* sc, uint32_t node, uint32_t epoch_id) {
+  uint32_t obj_size = sc->object_size;
+
+  /* Calculate how many objects fit in this slab.
+   * Formula accounts for: slab header + bitmap + alignment → usable space → object count.
+   * Example: 4096B page, 128B objects → 64B header + 4B bitmap → ~3968B usable → 31 objects
+   * Large tier: 65536B slab, 4096B objects → 15 objects */
+  uint32_t count = slab_object_count_in(obj_size, sc->slab_bytes);
+  
+  /* CRITICAL: Handle slot field is only 8 bits (bits [14:7] in handle encoding).
+   * If object_count > 255, handle encoding silently truncates slot index,
+   * causing free_obj() to free wrong slot and corrupt bitmap. */
+  assert(count <= 255 && "handle slot field is 8-bit; object_count must be <=255");
+  
+  if (count == 0) {
+    /* Pathological case: object too large to fit even one slot after header.
+     * Should never happen with our size classes (64-16384 bytes).
+     * Checked before carving so we never waste arena space on it. */
+    errno = EINVAL;
+    return NULL;
+  }
+
+  /* Carve a slab from this node's arena (sc->slab_bytes, aligned to its own size). */
+  uint16_t arena_ord = 0;
+  void* page = arena_carve_slab(a, sc, node, &arena_ord);
+  if (!page) return NULL;  /* Arena reservation failed (out of address space) */
+
+#if ENABLE_DIAGNOSTIC_COUNTERS
+  /* Track committed bytes (carved memory) for RSS analysis */
+  atomic_fetch_add_explicit(&sc->committed_bytes, sc->slab_bytes, memory_order_relaxed);
+#endif
+
+  Slab* s = (Slab*)page;  /* Slab header lives at start of page */
+
+  /* Allocate registry ID for handle encoding.
+   * Registry maps slab_id → (slab pointer, generation counter).
+   * Enables portable handles and ABA protection. */
+  uint32_t id = reg_alloc_id(&a->reg);
+  if (id == UINT32_MAX) {
+    /* Registry allocation failed (out of memory for registry growth) */
+    arena_uncarve_slab(sc, node, page);
+#if ENABLE_DIAGNOSTIC_COUNTERS
+    atomic_fetch_sub_explicit(&sc->committed_bytes, sc->slab_bytes, memory_order_relaxed);
+#endif
+    errno = ENOMEM;
+    return NULL;
+  }
+
+  /* Initialize slab header with metadata */
+  s->prev = NULL;  /* Not on any list yet */
+  s->next = NULL;
+  atomic_store_explicit(&s->magic, SLAB_MAGIC, memory_order_relaxed);  /* "SLAB" in ASCII */
+  s->object_size = obj_size;   /* Which size class: 64, 96, 128, etc. */
+  s->object_count = count;      /* How many slots calculated above */
+  atomic_store_explicit(&s->free_count, 0u, memory_order_relaxed);   /* All slots in the bump reserve */
+  atomic_store_explicit(&s->bump_next, 0u, memory_order_relaxed);    /* Nothing handed out yet */
+  atomic_store_explicit(&s->remote_head, 0u, memory_order_relaxed);   /* No deferred frees */
+  s->list_id = SLAB_LIST_NONE;  /* Not on partial/full list until added */
+  s->cache_state = SLAB_ACTIVE; /* In use (not cached) */
+  s->quota_label = 0;           /* new_slab() charges it, slab_reserve() doesn't */
+  s->epoch_id = epoch_id;       /* Temporal grouping: objects from this epoch */
+  s->era = a->epoch_era[epoch_id];  /* Monotonic timestamp for observability */
+  s->was_published = false;     /* Fresh slab not yet reachable lock-free */
+  s->numa_node = (uint8_t)node; /* Arena (and pool) this slab belongs to */
+  s->arena_ord = arena_ord;     /* Locates the slab's cache node */
+  s->slab_id = id;              /* Registry ID for handle encoding */
+
+  /* Initialize allocation bitmap to all valid bits set (reserved for bump) */
+  _Atomic uint32_t* bm = slab_bitmap_ptr(s);
+  uint32_t words = slab_bitmap_words(count);
+  for (uint32_t i = 0; i < words; i++) {
+    atomic_store_explicit(&bm[i], full_mask_for_word(count, i, words), memory_order_relaxed);
+  }
+
+  /* Publish slab in registry so handles can find it */
+  reg_set_ptr(&a->reg, id, s);
+
+  return s;  /* Fresh slab ready for allocation */
+}
+
+/* ------------------------------ Label quotas ------------------------------ */
+
+/* Charge one slab to label `lid` (new_slab). Over quota: undo, count the
+ * denial, run the label's callback and fail with EDQUOT. A TLS refill's
+ * denial is only a prefetch cut short: the caller's own slow-path retry
+ * reports the refusal, so it is counted once. */
+static bool label_charge(SlabAllocator* a, uint8_t lid, uint32_t bytes) {
+  LabelQuota* q = &a->label_quota[lid];
+  uint64_t committed = atomic_fetch_add_explicit(&q->committed, bytes, memory_order_relaxed) + bytes;
+  uint64_t quota = atomic_load_explicit(&q->quota, memory_order_relaxed);
+  if (quota == 0 || committed <= quota) {
+    uint64_t peak = atomic_load_explicit(&q->peak, memory_order_relaxed);
+    while (committed > peak &&
+           !atomic_compare_exchange_weak_explicit(&q->peak, &peak, committed,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+    return true;
+  }
+  atomic_fetch_sub_explicit(&q->committed, bytes, memory_order_relaxed);
+#if ENABLE_TLS_CACHE
+  extern __thread bool _tls_in_refill;
+  if (_tls_in_refill) {
+    errno = EDQUOT;
+    return false;
+  }
+#endif
+  atomic_fetch_add_explicit(&q->denials, 1, memory_order_relaxed);
+
+  LOCK_WITHOUT_PROBE(&a->label_registry.lock, LOCK_RANK_LABEL_REGISTRY, "label_registry.lock");
+  SlabQuotaCallback cb = q->cb;
+  void* cb_arg = q->cb_arg;
+  char label[32];
+  memcpy(label, a->label_registry.labels[lid], sizeof(label));
+  UNLOCK_WITH_RANK(&a->label_registry.lock);
+  if (cb) cb(a, label, committed - bytes, quota, cb_arg);
+
+  errno = EDQUOT;
+  return false;
+}
+
+static inline void label_uncharge(SlabAllocator* a, uint8_t lid, uint32_t bytes) {
+  atomic_fetch_sub_explicit(&a->label_quota[lid].committed, bytes, memory_order_relaxed);
+}
+
+/* Allocate a new slab for a size class and epoch.
+ *
+ * Two-path allocation strategy:
+ * 1. Cache hit: Pop recycled slab from cache (cheap, no syscall)
+ * 2. Cache miss: Allocate fresh page via mmap (expensive, ~2µs)
+ *
+ * Cache-first avoids mmap overhead. Cache hit rate >97% in production.
+ * Recycled slabs may have been madvised, so all metadata must be reinitialized.
+ *
+ * Generation bumping on reuse provides ABA protection:
+ * - Old handles encode old generation number
+ * - After reuse, generation increments
+ * - Old handles fail validation (generation mismatch)
+ * - Prevents use-after-free even if handle references same slab_id
+ */
+static Slab* new_slab(SlabAllocator* a, SizeClassAlloc* sc, uint32_t epoch_id) {
+  uint32_t obj_size = sc->object_size;
+
+  /* Try cache first. Avoids mmap syscall if we have recycled slabs available.
+   * cache_pop() returns the slab's off-page node: pointer, slab_id and
+   * was_published all survive madvise there.
+   * Pools are per NUMA node: prefer slabs whose memory is on our node. */
+  const uint32_t node = numa_current_node(a);
+  const uint32_t now_ms = coarse_ms();
+  
+  /* Charge the epoch's label before taking anything (per slab, not per object) */
+  const uint8_t lid = atomic_load_explicit(&a->epoch_meta[epoch_id].label_id, memory_order_relaxed);
+  if (!label_charge(a, lid, sc->slab_bytes)) return NULL;
+  atomic_fetch_add_explicit(&sc->cache_adapt.demand, 1, memory_order_relaxed);
+  cache_adapt_tick(sc, now_ms);
+  uint32_t cached_node = node;
+  CachedSlab* cached = cache_pop(a, sc, node, !SLAB_NUMA_STRICT, &cached_node);
+  Slab* s = NULL;
+  
+#if SLAB_NUMA_STRICT
+reuse_cached:
+#endif
+  if (cached) {
+    s = cached->slab;
+    uint32_t cached_id = cached->slab_id;
+    if (cached_id == REG_ID_NONE) {
+      /* ID was given back when the slab was cached: take one again (likely
+       * recycled). On failure the slab stays idle until allocator_destroy(). */
+      cached_id = reg_alloc_id(&a->reg);
+      if (cached_id == UINT32_MAX) {
+        label_uncharge(a, lid, sc->slab_bytes);
+        errno = ENOMEM;
+        return NULL;
+      }
+      cached->slab_id = cached_id;
+    }
+
+    /* Cache hit! Bump generation to invalidate old handles.
+     * Without this, a handle from the slab's previous incarnation would
+     * still validate, leading to use-after-free. */
+    (void)reg_bump_gen(&a->reg, cached_id);
+    
+    /* Reinitialize all slab metadata.
+     * If RSS reclamation is enabled, madvise() zeroed the header when this
+     * slab was recycled. Even without madvise, defensive reinitialization
+     * ensures clean state (prevents stale list pointers, corrupted counts). */
+    uint32_t expected_count = slab_object_count_in(obj_size, sc->slab_bytes);
+    
+    /* CRITICAL: Handle slot field is only 8 bits (bits [14:7] in handle encoding).
+     * If object_count > 255, handle encoding silently truncates slot index,
+     * causing free_obj() to free wrong slot and corrupt bitmap. */
+    assert(expected_count <= 255 && "handle slot field is 8-bit; object_count must be <=255");
+    
+    s->prev = NULL;
+    s->next = NULL;
+    atomic_store_explicit(&s->magic, SLAB_MAGIC, memory_order_relaxed);
+    s->object_size = obj_size;
+    s->object_count = expected_count;
+    s->list_id = SLAB_LIST_NONE;
+    s->cache_state = SLAB_ACTIVE;
+    s->quota_label = (uint8_t)(lid + 1u);
+    s->epoch_id = epoch_id;
+    s->era = atomic_load_explicit(&a->epoch_era[epoch_id], memory_order_acquire);
+    s->was_published = cached->was_published;  /* Restore from off-page cache (survived madvise) */
+    s->numa_node = (uint8_t)cached_node;       /* Pool index = memory node (survives madvise) */
+    s->arena_ord = cached->arena_ord;          /* Immutable in the node */
+    s->slab_id = cached_id;  /* Restore ID from cache (survived madvise) */
+    atomic_store_explicit(&s->free_count, 0u, memory_order_relaxed);  /* Whole slab is bump reserve */
+    atomic_store_explicit(&s->bump_next, 0u, memory_order_relaxed);
+    atomic_store_explicit(&s->remote_head, 0u, memory_order_relaxed);  /* Published slabs skip madvise */
+    
+    /* Reset allocation bitmap.
+     * Each bit represents one slot: 0=free, 1=allocated.
+     * Start with all valid bits set: the bump reserve owns every slot until
+     * slab_bump_alloc() hands it out or slab_bump_retire() clears it. */
+    _Atomic uint32_t* bm = slab_bitmap_ptr(s);
+    uint32_t words = slab_bitmap_words(expected_count);
+    for (uint32_t i = 0; i < words; i++) {
+      atomic_store_explicit(&bm[i], full_mask_for_word(expected_count, i, words), memory_order_relaxed);
+    }
+    
+    /* Republish slab pointer in registry.
+     * The pointer may have been set to NULL during recycling, or this may
+     * be the first time we're publishing it. Either way, make it findable. */
+    reg_set_ptr(&a->reg, cached_id, s);
+    
+    return s;  /* Cache hit path complete */
+  }
+
+  /* Cache miss: no recycled slabs available, must carve a fresh slab.
+   * Usually a pointer bump in the class's arena; a syscall only when the
+   * arena is exhausted (once per SLAB_ARENA_SIZE / slab_bytes slabs).
+   * Counter helps diagnose "why is allocation slow?" (cache pressure). */
+  atomic_fetch_add_explicit(&sc->new_slab_count, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&sc->slow_path_cache_miss, 1, memory_order_relaxed);
+  
+  /* Growing: the one place the footprint rises, so check the budget here */
+  budget_enforce(a, now_ms, false);
+  s = slab_carve_fresh(a, sc, node, epoch_id);
+#if SLAB_NUMA_STRICT
+  if (!s && errno == ENOMEM && a->numa_nodes > 1) {
+    /* Strict mode: remote cached slabs are the fallback, not the first choice */
+    cached = cache_pop(a, sc, node, true, &cached_node);
+    if (cached) goto reuse_cached;
+  }
+#endif
+  if (s) {
+    s->quota_label = (uint8_t)(lid + 1u);
+  } else {
+    label_uncharge(a, lid, sc->slab_bytes);
+  }
+  return s;  /* Fresh slab ready for allocation, or NULL (errno set) */
+}
+
+/* ------------------------------ Warm-up (slab_reserve) ------------------------------ */
+
+/* Fault in every page of a slab about to be cached (SLAB_RESERVE_PREFAULT).
+ * MADV_POPULATE_WRITE (Linux 5.14+) does it in one call; otherwise rewrite
+ * one byte per page. The header page is already resident. */
+static void slab_prefault(Slab* s, size_t bytes) {
+#if defined(__linux__) && defined(MADV_POPULATE_WRITE)
+  if (madvise(s, bytes, MADV_POPULATE_WRITE) == 0) return;
+#endif
+  volatile uint8_t* p = (volatile uint8_t*)s;
+  for (size_t off = SLAB_PAGE_SIZE; off < bytes; off += SLAB_PAGE_SIZE) p[off] = p[off];
+}
+
+/* Pre-create n_slabs cached slabs for one class (see slab_alloc.h).
+ *
+ * All slabs are carved before any is pushed, so each holds its own
+ * registry ID and the registry grows to n_slabs IDs now. The pushes then
+ * hand the IDs back (never-published slabs always do), where new_slab()
+ * picks them up again off the free list. Pushes skip madvise, and with
+ * SLAB_RESERVE_KEEP_WARM later recycles keep that many slabs resident. */
+uint32_t slab_reserve(SlabAllocator* a, uint32_t size_class, uint32_t n_slabs, uint32_t flags) {
+  if (!a || size_class >= a->num_classes) {
+    errno = EINVAL;
+    return 0;
+  }
+  SizeClassAlloc* sc = &a->classes[size_class];
+  const uint32_t node = numa_current_node(a);
+  const uint32_t epoch = SLAB_EPOCH_INDEX(epoch_current(a));
+
+  if (flags & SLAB_RESERVE_KEEP_WARM) {
+    /* Raise only: concurrent reservations keep the larger floor */
+    uint32_t floor = atomic_load_explicit(&sc->warm_floor, memory_order_relaxed);
+    while (floor < n_slabs &&
+           !atomic_compare_exchange_weak_explicit(&sc->warm_floor, &floor, n_slabs,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+  }
+
+  /* Carve everything first, chained through the (still unused) list links */
+  Slab* head = NULL;
+  uint32_t done = 0;
+  int saved_errno = 0;
+  while (done < n_slabs) {
+    Slab* s = slab_carve_fresh(a, sc, node, epoch);
+    if (!s) {
+      saved_errno = errno;
+      break;
+    }
+    if (flags & SLAB_RESERVE_PREFAULT) slab_prefault(s, sc->slab_bytes);
+    s->next = head;
+    head = s;
+    done++;
+  }
+
+  while (head) {
+    Slab* s = head;
+    head = s->next;
+    s->next = NULL;
+    CachePushItem it;
+    cache_push_prepare(sc, s, &it, false);
+    cache_push_link(&it);
+  }
+
+  atomic_fetch_add_explicit(&sc->reserved_slabs, done, memory_order_relaxed);
+  if (done < n_slabs) errno = saved_errno;
+  return done;
+}
+
+/* ------------------------------ Handle encoding (Portable, ABA-safe) ------------------------------ */
+
+/* Portable handle encoding v2: slab_id + generation + slot + class + version
+ * 
+ * Layout (64-bit):
+ *   [63:39] slab_id (25 bits) - registry index (max 32M slabs)
+ *   [38:15] generation (24 bits) - ABA protection (wraps after 16M reuses)
+ *   [14:7]  slot (8 bits) - object index within slab (max 255 objects)
+ *   [6:2]   size_class (5 bits) - 0-31 size classes (SLAB_MAX_CLASSES)
+ *   [1:0]   version (2 bits) - handle format version (v2=0b10)
+ * 
+ * Key properties:
+ * - No raw pointers (portable across all platforms)
+ * - Generation stored in registry (survives madvise)
+ * - 24-bit generation: safe against ABA even under pathological churn
+ * - 2-bit version field allows future format changes
+ * 
+ * v1 spent 8 bits on size_class, of which SLAB_MAX_CLASSES (32) only ever
+ * used 5; v2 moves the spare 3 bits to slab_id (22 → 25 bits, 4M → 32M
+ * slabs, i.e. 16GB → 128GB of 4KB slabs or 2TB of 64KB large-tier slabs).
+ * Handles are only meaningful to the allocator that minted them, so v1
+ * handles cannot reach this decoder and are rejected like any bad version.
+ * 
+ * Design constraints:
+ * - 8-bit slot limits max objects per slab to 255
+ * - This bounds min object size to ~16 bytes (4096 / 255)
+ * - Current size classes (64-768 bytes) well within limits
+ * - If smaller classes needed, must rev handle format (use version bits)
+ */
+#define HANDLE_VERSION_V1 0x1u  /* Retired: 22-bit slab_id, 8-bit class */
+#define HANDLE_VERSION_V2 0x2u
+#define HANDLE_VERSION    HANDLE_VERSION_V2
+
+#define HANDLE_CLASS_SHIFT 2u
+#define HANDLE_SLOT_SHIFT  (HANDLE_CLASS_SHIFT + HANDLE_CLASS_BITS)
+#define HANDLE_GEN_SHIFT   (HANDLE_SLOT_SHIFT + HANDLE_SLOT_BITS)
+#define HANDLE_SLAB_SHIFT  (HANDLE_GEN_SHIFT + HANDLE_GEN_BITS)
+
+_Static_assert(HANDLE_SLAB_SHIFT + HANDLE_SLAB_ID_BITS == 64, "handle v2 fields must fill 64 bits");
+_Static_assert(SLAB_MAX_CLASSES <= (1u << HANDLE_CLASS_BITS), "size_class field too narrow for SLAB_MAX_CLASSES");
+
+static inline SlabHandle handle_pack(uint32_t slab_id, uint32_t gen, uint8_t slot, uint8_t cls) {
+  return ((uint64_t)slab_id << HANDLE_SLAB_SHIFT)                                      /* 25 bits */
+       | ((uint64_t)(gen & ((1u << HANDLE_GEN_BITS) - 1u)) << HANDLE_GEN_SHIFT)        /* 24 bits */
+       | ((uint64_t)slot << HANDLE_SLOT_SHIFT)                                          /* 8 bits */
+       | ((uint64_t)(cls & ((1u << HANDLE_CLASS_BITS) - 1u)) << HANDLE_CLASS_SHIFT)    /* 5 bits */
+       | (uint64_t)HANDLE_VERSION;                                                      /* 2 bits */
+}
+
+inline void handle_unpack(SlabHandle h, uint32_t* slab_id, uint32_t* gen, uint32_t* slot, uint32_t* cls) {
+  uint32_t version = (uint32_t)(h & 0x3u);
+  if (version != HANDLE_VERSION) {
     /* Invalid version - set sentinel values that will fail validation */
     *slab_id = UINT32_MAX;  /* Will fail bounds check */
     *gen = 0;               /* Generation 0 never used */
@@ -1304,21 +3842,139 @@ inline void handle_unpack(SlabHandle h, uint32_t* slab_id, uint32_t* gen, uint32
     return;
   }
   
-  *cls     = (uint32_t)((h >> 2) & 0xFFu);
-  *slot    = (uint32_t)((h >> 10) & 0xFFu);
-  *gen     = (uint32_t)((h >> 18) & 0xFFFFFFu);
-  *slab_id = (uint32_t)(h >> 42);
+  *cls     = (uint32_t)((h >> HANDLE_CLASS_SHIFT) & ((1u << HANDLE_CLASS_BITS) - 1u));
+  *slot    = (uint32_t)((h >> HANDLE_SLOT_SHIFT) & ((1u << HANDLE_SLOT_BITS) - 1u));
+  *gen     = (uint32_t)((h >> HANDLE_GEN_SHIFT) & ((1u << HANDLE_GEN_BITS) - 1u));
+  *slab_id = (uint32_t)(h >> HANDLE_SLAB_SHIFT);
+}
+
+/* Unpack a handle minted by the allocator owning `r`.
+ *
+ * Group shards keep their shard index in the top bits of the slab_id field
+ * (SlabRegistry.id_tag). A handle whose tag is not this shard's (another
+ * shard's handle, or a bad version) gets slab_id UINT32_MAX, which fails
+ * validation like any unknown ID. */
+static inline void handle_decode(const SlabRegistry* r, SlabHandle h, uint32_t* slab_id,
+                                 uint32_t* gen, uint32_t* slot, uint32_t* cls) {
+  handle_unpack(h, slab_id, gen, slot, cls);
+  const uint32_t id = *slab_id - r->id_tag;
+  *slab_id = id < r->id_limit ? id : UINT32_MAX;
 }
 
 /* Encode handle from slab (reads slab_id from slab, generation from registry) */
 static inline SlabHandle encode_handle(Slab* slab, SlabRegistry* reg, uint32_t slot, uint32_t size_class) {
   uint32_t id = slab->slab_id;
   uint32_t gen = reg_get_gen24(reg, id);
-  return handle_pack(id, gen, (uint8_t)slot, (uint8_t)size_class);
+  return handle_pack(id | reg->id_tag, gen, (uint8_t)slot, (uint8_t)size_class);
 }
 
 /* ------------------------------ Allocation ------------------------------ */
 
+/* Claim one slot from `cur`, the slab published in this CPU's
+ * current_partial slot `cp` of epoch state `es`: bump reserve first, then
+ * the bitmap. Moves the slab to FULL if the claim exhausted it and encodes
+ * the handle into `out`. Returns NULL if the slab was already full or no
+ * longer published in `cp`; the caller decides how to recover
+ * (alloc_obj_epoch_impl repairs the slot). */
+static inline void* slab_claim_current(SlabAllocator* a, SizeClassAlloc* sc, EpochState* es,
+                                       uint32_t ci, uint32_t slot, _Atomic(Slab*)* cp,
+                                       Slab* cur, SlabHandle* out) {
+  uint32_t prev_fc = 0;  /* Previous free_count, for transition detection */
+  uint32_t retries = 0;  /* CAS retry count, for contention tracking */
+  
+  /* cur may have been unpublished (and recycled) since it was loaded */
+  if (!slab_pin_published(es, slot, cur)) return NULL;
+
+  /* Fresh slab (warm-up, right after epoch_advance): bump its reserve,
+   * one fetch_add and nothing else. Otherwise claim a bitmap slot. */
+  uint32_t idx = slab_bump_alloc(cur);
+  const bool bumped = idx != UINT32_MAX;
+  if (!bumped) idx = slab_alloc_slot_atomic(cur, sc, &prev_fc, &retries);
+  slab_unpin(es, slot);  /* A claimed slot keeps the slab off every recycle path */
+
+  if (bumped) {
+    /* Reserve left before this slot. Until the first free the reserve is
+     * the slab's only free space, so 1 means we just filled it. */
+    prev_fc = cur->object_count - idx;
+    if (prev_fc == 1) {
+      atomic_fetch_add_explicit(&sc->bump_allocs, cur->object_count, memory_order_relaxed);
+    }
+  } else if (idx != UINT32_MAX) {
+    /* Phase 2.2: Record successful allocation + CAS retries (this CPU's stripe) */
+    SlabCounterStripe* st = sc_stripe(sc);
+    uint64_t prev_attempts =
+        atomic_fetch_add_explicit(&st->bitmap_alloc_attempts, 1, memory_order_relaxed);
+    uint64_t cur_attempts = prev_attempts + 1;
+    
+    if (retries > 0) {
+      atomic_fetch_add_explicit(&st->bitmap_alloc_cas_retries, retries, memory_order_relaxed);
+#ifdef ENABLE_LABEL_CONTENTION
+      /* Phase 2.3: Attribute CAS retries to current label */
+      uint8_t lid = current_label_id(sc->parent_alloc);
+      atomic_fetch_add_explicit(&sc->bitmap_alloc_cas_retries_by_label[lid], retries, memory_order_relaxed);
+#endif
+    }
+    
+    /* Adaptive controller heartbeat: every 262,144 allocations on this stripe,
+     * check retry rate and potentially switch scanning mode. Uses allocation
+     * count instead of time to avoid clock syscalls in the hot path. */
+    if ((cur_attempts & ((1u << 18) - 1u)) == 0u) {
+      scan_adapt_check(sc);  /* May switch sequential↔randomized based on contention */
+    }
+    
+    /* If we just allocated from a fully empty slab, decrement the empty counter.
+     * prev_fc == object_count means the slab had all slots free before our allocation.
+     * (Fresh slabs are never counted as empty, and their reserve goes through
+     * the bump branch above.) */
+    if (prev_fc == cur->object_count) {
+      atomic_fetch_sub_explicit(&es->empty_partial_count, 1, memory_order_relaxed);
+    }
+  }
+  
+  if (idx == UINT32_MAX) return NULL;  /* Slab filled between load and claim */
+  
+  /* Transition detection: did our allocation exhaust the last free slot?
+   * prev_fc==1 means there was one free slot before our allocation, now zero.
+   * Must move slab from PARTIAL to FULL list and select a new current_partial. */
+  if (prev_fc == 1) {
+    LOCK_WITH_PROBE(&sc->lock, sc, LOCK_RANK_SIZE_CLASS, "sc->lock");  /* Need mutex to mutate lists */
+    
+    /* Re-check list_id under lock (may have been moved by another thread).
+     * Pending remote frees refill the slab in place instead. */
+    if (slab_on_list_locked(sc, es, cur, SLAB_LIST_PARTIAL) && !slab_absorb_remote_locked(sc, es, cur)) {
+      atomic_fetch_add_explicit(&sc->list_move_partial_to_full, 1, memory_order_relaxed);
+      list_remove(&es->partial, cur);
+      cur->list_id = SLAB_LIST_FULL;
+      list_push_back(&es->full, cur);
+      
+      /* Publish next slab from partial list (NULL if list is empty).
+       * Prefer one no other CPU is using so slots stay disjoint.
+       * Other slots still pointing at cur will miss and self-heal. */
+      Slab* next = pick_partial_for_slot(es, slot, numa_current_node(a), NULL);
+      percpu_publish_locked(sc, es, cp, next);
+    }
+    UNLOCK_WITH_RANK(&sc->lock);
+  }
+  
+  /* Convert slot index to actual memory address.
+   * Address = slab_base + (slot_index × object_size). */
+  void* p = slab_slot_ptr(cur, idx);
+  
+  /* Encode portable handle if requested.
+   * Handle contains: slab_id (registry lookup), generation (ABA protection),
+   * slot index, and size class. Avoids embedding raw pointers. */
+  if (out) {
+    *out = encode_handle(cur, &a->reg, idx, ci);
+  }
+  
+#if ENABLE_DIAGNOSTIC_COUNTERS
+  /* Track live bytes (bytes allocated to live objects) for leak detection */
+  atomic_fetch_add_explicit(&sc->live_bytes, sc->object_size, memory_order_relaxed);
+#endif
+  
+  return p;
+}
+
 /* Main allocation function: allocate an object from a specific epoch.
  *
  * Two-tier allocation strategy:
@@ -1334,8 +3990,47 @@ static inline SlabHandle encode_handle(Slab* slab, SlabRegistry* reg, uint32_t s
  * - Out of memory (mmap failed)
  *
  * If out is non-NULL, writes a portable handle encoding (slab_id, generation, slot, class).
+ *
+ * The body is alloc_obj_epoch_impl(); the wrappers only add the sampled
+ * latency timing of ENABLE_LATENCY_HIST builds and the trace record.
  */
-void* alloc_obj_epoch(SlabAllocator* a, uint32_t size, EpochId epoch, SlabHandle* out) {
+static void* alloc_obj_epoch_impl(SlabAllocator* a, uint32_t size, EpochId epoch_id, SlabHandle* out);
+
+static inline void* alloc_obj_epoch_timed(SlabAllocator* a, uint32_t size, EpochId epoch_id, SlabHandle* out) {
+#if ENABLE_LATENCY_HIST
+  if (lat_sample()) {
+    tls_lat_timing = true;
+    tls_lat_slow = false;
+    uint64_t t0 = now_ns();
+    void* p = alloc_obj_epoch_impl(a, size, epoch_id, out);
+    lat_record(a, tls_lat_slow ? SLAB_LAT_ALLOC_SLOW : SLAB_LAT_ALLOC_FAST, now_ns() - t0);
+    tls_lat_timing = false;
+    return p;
+  }
+#endif
+  return alloc_obj_epoch_impl(a, size, epoch_id, out);
+}
+
+void* alloc_obj_epoch(SlabAllocator* a, uint32_t size, EpochId epoch_id, SlabHandle* out) {
+#if ENABLE_ALLOC_TRACE
+  if (trace_on(a)) {
+    /* Stamped after the object exists, so its free always sorts later */
+    SlabHandle h = 0;
+    _tls_trace_mute = true;
+    void* p = alloc_obj_epoch_timed(a, size, epoch_id, &h);
+    _tls_trace_mute = false;
+    if (p) {
+      trace_put(a, SLAB_TRACE_ALLOC, (uint32_t)class_index_for_size(a, size), size,
+                trace_era(a, epoch_id), h);
+    }
+    if (out) *out = h;
+    return p;
+  }
+#endif
+  return alloc_obj_epoch_timed(a, size, epoch_id, out);
+}
+
+static void* alloc_obj_epoch_impl(SlabAllocator* a, uint32_t size, EpochId epoch_id, SlabHandle* out) {
 #if ENABLE_SLOWPATH_SAMPLING
   /* Phase 2.5: Probabilistic end-to-end sampling (1/1024)
    * Wall vs CPU time split detects WSL2/virtualization interference */
@@ -1364,12 +4059,13 @@ void* alloc_obj_epoch(SlabAllocator* a, uint32_t size, EpochId epoch, SlabHandle
   #define RECORD_SAMPLE() do { } while (0)
 #endif
   
-  /* Map requested size to nearest size class (64, 96, 128, ..., 768).
-   * Uses O(1) lookup table: k_class_lookup[size] → class index. */
-  int ci = class_index_for_size(size);
+  /* Map requested size to nearest size class (64, 96, 128, ..., 16384 by default).
+   * Uses O(1) per-allocator lookup table: a->class_lookup[size] → class index. */
+  int ci = class_index_for_size(a, size);
   if (ci < 0) { RECORD_SAMPLE(); return NULL; }  /* Size too large or zero */
   
-  if (epoch >= a->epoch_count) { RECORD_SAMPLE(); return NULL; }  /* Invalid epoch ID */
+  uint32_t epoch = epoch_slot(a, epoch_id);
+  if (epoch == EPOCH_SLOT_NONE) { RECORD_SAMPLE(); return NULL; }  /* Out of range or stale epoch ID */
   
   SizeClassAlloc* sc = &a->classes[(size_t)ci];
   
@@ -1393,22 +4089,16 @@ void* alloc_obj_epoch(SlabAllocator* a, uint32_t size, EpochId epoch, SlabHandle
   extern __thread bool _tls_in_refill;
   
   if (!_tls_in_refill) {
-    /* Check if TLS bypass is active for this size class */
-    extern __thread TLSCache _tls_cache[8];
-    TLSCache* tls = &_tls_cache[ci];
+    /* TLS fast path: Check thread-local epoch bin first (no atomics, no locks).
+     * Returns NULL without touching a bin when adaptive bypass is active. */
+    void* ptr = tls_try_alloc(a, (uint32_t)ci, epoch, out);
+    if (ptr) return ptr;  /* TLS cache hit - fastest path (~10-15ns) */
     
-    /* HARD BYPASS: skip all TLS logic if bypass is enabled */
-    if (!tls->bypass_alloc) {
-      /* TLS fast path: Check thread-local handle cache first (no atomics, no locks) */
-      void* ptr = tls_try_alloc(a, (uint32_t)ci, epoch, out);
-      if (ptr) return ptr;  /* TLS cache hit - fastest path (~10-15ns) */
-      
-      /* TLS miss: Refill from global allocator, then retry */
-      tls_refill(a, (uint32_t)ci, epoch);
+    /* TLS miss: Refill the bin from the global allocator, then retry.
+     * Fall through to the global allocator if refill got nothing. */
+    if (tls_refill(a, (uint32_t)ci, epoch)) {
       ptr = tls_try_alloc(a, (uint32_t)ci, epoch, out);
-      if (ptr) return ptr;  /* Refill succeeded */
-      
-      /* Fall through to global allocator if refill failed (out of memory) */
+      if (ptr) return ptr;
     }
   }
 #endif
@@ -1417,87 +4107,18 @@ void* alloc_obj_epoch(SlabAllocator* a, uint32_t size, EpochId epoch, SlabHandle
 
   /* Fast path: lock-free load of pre-selected slab.
    * current_partial is published by the slow path and points to a slab
-   * with likely free slots. Multiple threads can attempt allocation concurrently
-   * via atomic bitmap CAS. No mutex needed here—this is the hot path. */
-  Slab* cur = atomic_load_explicit(&es->current_partial, memory_order_acquire);
+   * with likely free slots. Each CPU has its own slot, so threads on
+   * different CPUs CAS on different slabs' bitmaps instead of all hammering
+   * one shared slab. No mutex needed here—this is the hot path. */
+  const uint32_t slot = percpu_slot();
+  _Atomic(Slab*)* cp = &es->current_partial[slot];
+  Slab* cur = atomic_load_explicit(cp, memory_order_acquire);
   
   /* Validate pointer before dereferencing.
    * Magic check defends against corruption and stale pointers. */
   if (cur && atomic_load_explicit(&cur->magic, memory_order_relaxed) == SLAB_MAGIC) {
-    uint32_t prev_fc = 0;  /* Previous free_count, for transition detection */
-    uint32_t retries = 0;  /* CAS retry count, for contention tracking */
-    
-    /* Try to allocate a slot from this slab's bitmap atomically */
-    uint32_t idx = slab_alloc_slot_atomic(cur, sc, &prev_fc, &retries);
-    
-    if (idx != UINT32_MAX) {
-      /* Phase 2.2: Record successful allocation + CAS retries */
-      uint64_t prev_attempts =
-          atomic_fetch_add_explicit(&sc->bitmap_alloc_attempts, 1, memory_order_relaxed);
-      uint64_t cur_attempts = prev_attempts + 1;
-      
-      if (retries > 0) {
-        atomic_fetch_add_explicit(&sc->bitmap_alloc_cas_retries, retries, memory_order_relaxed);
-#ifdef ENABLE_LABEL_CONTENTION
-        /* Phase 2.3: Attribute CAS retries to current label */
-        uint8_t lid = current_label_id(sc->parent_alloc);
-        atomic_fetch_add_explicit(&sc->bitmap_alloc_cas_retries_by_label[lid], retries, memory_order_relaxed);
-#endif
-      }
-      
-      /* Adaptive controller heartbeat: every 262,144 allocations, check retry rate
-       * and potentially switch scanning mode. Uses allocation count instead of
-       * time to avoid clock syscalls in the hot path. */
-      if ((cur_attempts & ((1u << 18) - 1u)) == 0u) {
-        scan_adapt_check(sc);  /* May switch sequential↔randomized based on contention */
-      }
-      
-      /* If we just allocated from a fully empty slab, decrement the empty counter.
-       * prev_fc == object_count means the slab had all slots free before our allocation. */
-      if (prev_fc == cur->object_count) {
-        atomic_fetch_sub_explicit(&es->empty_partial_count, 1, memory_order_relaxed);
-      }
-      
-      /* Transition detection: did our allocation exhaust the last free slot?
-       * prev_fc==1 means there was one free slot before our allocation, now zero.
-       * Must move slab from PARTIAL to FULL list and select a new current_partial. */
-      if (prev_fc == 1) {
-        LOCK_WITH_PROBE(&sc->lock, sc, LOCK_RANK_SIZE_CLASS, "sc->lock");  /* Need mutex to mutate lists */
-        
-        /* Re-check list_id under lock (may have been moved by another thread) */
-        if (cur->list_id == SLAB_LIST_PARTIAL) {
-          atomic_fetch_add_explicit(&sc->list_move_partial_to_full, 1, memory_order_relaxed);
-          list_remove(&es->partial, cur);
-          cur->list_id = SLAB_LIST_FULL;
-          list_push_back(&es->full, cur);
-          
-          /* Publish next slab from partial list (NULL if list is empty).
-           * This lets other threads continue on fast path without hitting slow path. */
-          Slab* next = es->partial.head;
-          if (next) {
-            next->was_published = true;
-          }
-          atomic_store_explicit(&es->current_partial, next, memory_order_release);
-        }
-        UNLOCK_WITH_RANK(&sc->lock);
-      }
-      
-      /* Convert slot index to actual memory address.
-       * Address = slab_base + (slot_index × object_size). */
-      void* p = slab_slot_ptr(cur, idx);
-      
-      /* Encode portable handle if requested.
-       * Handle contains: slab_id (registry lookup), generation (ABA protection),
-       * slot index, and size class. Avoids embedding raw pointers. */
-      if (out) {
-        *out = encode_handle(cur, &a->reg, idx, (uint32_t)ci);
-      }
-      
-#if ENABLE_DIAGNOSTIC_COUNTERS
-      /* Track live bytes (bytes allocated to live objects) for leak detection */
-      atomic_fetch_add_explicit(&sc->live_bytes, sc->object_size, memory_order_relaxed);
-#endif
-
+    void* p = slab_claim_current(a, sc, es, (uint32_t)ci, slot, cp, cur, out);
+    if (p) {
       /* Drainability profiler: Track allocation in epoch */
 #ifdef ENABLE_DRAINPROF
       if (g_profiler) {
@@ -1510,54 +4131,41 @@ void* alloc_obj_epoch(SlabAllocator* a, uint32_t size, EpochId epoch, SlabHandle
     }
     
     /* Fast path failed: slab was full between load and allocation attempt.
-     * This is a race—another thread exhausted the slab first.
+     * This is a race—another thread exhausted the slab first (or the slot
+     * let go of it, in which case the CAS below just fails).
      * Null out current_partial so next thread goes to slow path.
      * 
      * ROBUSTNESS FIX: Also move slab to FULL list if bitmap is truly full.
      * This prevents "zombie partial" syndrome where free_count divergence
      * causes prev_fc==1 transition to never fire, leaving full slab on PARTIAL forever. */
-    atomic_fetch_add_explicit(&sc->current_partial_full, 1, memory_order_relaxed);
+    SlabCounterStripe* st = sc_stripe(sc);
+    atomic_fetch_add_explicit(&st->current_partial_full, 1, memory_order_relaxed);
     
-    atomic_fetch_add_explicit(&sc->current_partial_cas_attempts, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&st->current_partial_cas_attempts, 1, memory_order_relaxed);
     Slab* expected = cur;
     bool swapped = atomic_compare_exchange_strong_explicit(
-      &es->current_partial, &expected, NULL,
-      memory_order_release, memory_order_relaxed);
+      cp, &expected, NULL,
+      memory_order_seq_cst, memory_order_relaxed);  /* Unpublishes: see slab_pin_published() */
     if (!swapped) {
       /* Another thread already nulled it—fine, contention is expected */
-      atomic_fetch_add_explicit(&sc->current_partial_cas_failures, 1, memory_order_relaxed);
+      atomic_fetch_add_explicit(&st->current_partial_cas_failures, 1, memory_order_relaxed);
     }
     
     /* Additional robustness: If slab is still on PARTIAL list and bitmap is full,
      * move it to FULL list now. This ensures we don't depend on prev_fc==1 being
      * correct forever (handles free_count divergence gracefully). */
     LOCK_WITH_PROBE(&sc->lock, sc, LOCK_RANK_SIZE_CLASS, "sc->lock");
-    if (cur->list_id == SLAB_LIST_PARTIAL) {
+    if (slab_on_list_locked(sc, es, cur, SLAB_LIST_PARTIAL)) {
       /* Verify bitmap is truly full (with double-check to avoid transient views) */
-      _Atomic uint32_t* bm = slab_bitmap_ptr(cur);
       uint32_t words = slab_bitmap_words(cur->object_count);
-      bool bitmap_full = true;
-      
-      for (uint32_t i = 0; i < words; i++) {
-        uint32_t x = atomic_load_explicit(&bm[i], memory_order_relaxed);
-        if (x != full_mask_for_word(cur->object_count, i, words)) {
-          bitmap_full = false;
-          break;
-        }
-      }
+      bool bitmap_full = slab_bitmap_free_words(cur, words) == 0;
       
       if (bitmap_full) {
-        atomic_thread_fence(memory_order_acquire);
-        for (uint32_t i = 0; i < words; i++) {
-          uint32_t x = atomic_load_explicit(&bm[i], memory_order_relaxed);
-          if (x != full_mask_for_word(cur->object_count, i, words)) {
-            bitmap_full = false;
-            break;
-          }
-        }
+        atomic_thread_fence(memory_order_acquire);
+        bitmap_full = slab_bitmap_free_words(cur, words) == 0;
       }
       
-      if (bitmap_full) {
+      if (bitmap_full && !slab_absorb_remote_locked(sc, es, cur)) {
         /* Bitmap stably full: move PARTIAL → FULL */
         list_remove(&es->partial, cur);
         cur->list_id = SLAB_LIST_FULL;
@@ -1565,18 +4173,18 @@ void* alloc_obj_epoch(SlabAllocator* a, uint32_t size, EpochId epoch, SlabHandle
         atomic_fetch_add_explicit(&sc->list_move_partial_to_full, 1, memory_order_relaxed);
         
         /* Publish next partial if available */
-        Slab* next = es->partial.head;
-        if (next) {
-          next->was_published = true;
-        }
-        atomic_store_explicit(&es->current_partial, next, memory_order_release);
+        Slab* next = pick_partial_for_slot(es, slot, numa_current_node(a), NULL);
+        percpu_publish_locked(sc, es, cp, next);
       }
     }
+    /* Frees may have emptied it since it was seen full; the CAS above
+     * unpublished it, so it can wait on the empty list now. */
+    (void)slab_park_empty_locked(sc, es, cur);
     UNLOCK_WITH_RANK(&sc->lock);
   } else if (!cur) {
     /* current_partial was NULL—no slab selected yet, or previous was exhausted.
      * Will proceed to slow path to select a new slab. */
-    atomic_fetch_add_explicit(&sc->current_partial_null, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&sc_stripe(sc)->current_partial_null, 1, memory_order_relaxed);
   }
 
   /* Slow path: lock-protected allocation when fast path unavailable.
@@ -1585,6 +4193,9 @@ void* alloc_obj_epoch(SlabAllocator* a, uint32_t size, EpochId epoch, SlabHandle
    * allocation attempt, retry instead of failing. */
   const uint32_t SLOW_PATH_TRIPWIRE = 1000;  /* 1000 retries = something is deeply wrong */
   uint32_t slow_path_attempts = 0;
+#if ENABLE_LATENCY_HIST
+  tls_lat_slow = true;
+#endif
   
   for (;;) {
     /* Re-check epoch state (might have closed while we waited for lock) */
@@ -1604,17 +4215,17 @@ void* alloc_obj_epoch(SlabAllocator* a, uint32_t size, EpochId epoch, SlabHandle
               (unsigned long)pthread_self(), slow_path_attempts);
       fprintf(stderr, "Size class: %d, epoch: %u, state: %u\n",
               ci, epoch, state);
-      fprintf(stderr, "Partial list length: %zu, current_partial: %p\n",
-              es->partial.len, (void*)atomic_load_explicit(&es->current_partial, memory_order_relaxed));
+      fprintf(stderr, "Partial list length: %zu, current_partial[%u]: %p\n",
+              es->partial.len, slot, (void*)atomic_load_explicit(cp, memory_order_relaxed));
       fflush(stderr);
       abort();
     }
     
     /* Try to allocate a new slab if needed (cache or mmap).
      * CRITICAL: Must call new_slab() BEFORE acquiring sc->lock to avoid
-     * lock rank violation. new_slab() calls cache_pop() which acquires
-     * cache_lock (rank 20), and we need sc->lock (rank 30) after.
-     * Rank ordering requires: cache_lock → sc->lock, never reversed. */
+     * lock rank violation. new_slab() may call arena_carve_slab() which
+     * acquires arena_lock (rank 25), and we need sc->lock (rank 30) after.
+     * Rank ordering requires: arena_lock → sc->lock, never reversed. */
     Slab* new_s = NULL;
     
     LOCK_WITH_PROBE(&sc->lock, sc, LOCK_RANK_SIZE_CLASS, "sc->lock");  /* Take mutex, track contention */
@@ -1625,7 +4236,7 @@ void* alloc_obj_epoch(SlabAllocator* a, uint32_t size, EpochId epoch, SlabHandle
     /* ZOMBIE PARTIAL REPAIR: If head slab is actually full, move it to FULL list
      * Check both free_count and bitmap to catch divergence cases */
     while (s) {
-      uint32_t fc = atomic_load_explicit(&s->free_count, memory_order_relaxed);
+      uint32_t fc = slab_free_slots(s);  /* Includes a fresh slab's bump reserve */
       
       /* Quick check: if free_count >= 2, slab is definitely not full */
       if (fc >= 2) break;
@@ -1634,34 +4245,17 @@ void* alloc_obj_epoch(SlabAllocator* a, uint32_t size, EpochId epoch, SlabHandle
        * 
        * CRITICAL: Use full_mask_for_word() to avoid UB when object_count % 32 == 0.
        * Double-check with memory fence to reduce false positives from transient views. */
-      _Atomic uint32_t* bm = slab_bitmap_ptr(s);
       uint32_t words = slab_bitmap_words(s->object_count);
-      bool bitmap_full = true;
-      
-      for (uint32_t i = 0; i < words; i++) {
-        uint32_t x = atomic_load_explicit(&bm[i], memory_order_relaxed);
-        uint32_t expected_full = full_mask_for_word(s->object_count, i, words);
-        if (x != expected_full) {
-          bitmap_full = false;
-          break;
-        }
-      }
+      bool bitmap_full = slab_bitmap_free_words(s, words) == 0;
       
       /* Double-check with acquire fence to synchronize with concurrent bitmap updates */
       if (bitmap_full) {
         atomic_thread_fence(memory_order_acquire);
-        bitmap_full = true;  /* Reset and re-scan */
-        for (uint32_t i = 0; i < words; i++) {
-          uint32_t x = atomic_load_explicit(&bm[i], memory_order_relaxed);
-          uint32_t expected_full = full_mask_for_word(s->object_count, i, words);
-          if (x != expected_full) {
-            bitmap_full = false;
-            break;
-          }
-        }
+        bitmap_full = slab_bitmap_free_words(s, words) == 0;
       }
       
       if (!bitmap_full) break;  /* Slab has free slots, use it */
+      if (slab_absorb_remote_locked(sc, es, s)) break;  /* Remote frees refilled it */
       
       /* Bitmap is stably full - move to FULL list.
        * DO NOT mutate free_count here: if there's divergence, the bug is in
@@ -1706,14 +4300,36 @@ void* alloc_obj_epoch(SlabAllocator* a, uint32_t size, EpochId epoch, SlabHandle
       
       s = es->partial.head;  /* Try next partial slab */
     }
+
+    /* Per-CPU placement: if the head is already another CPU's current_partial
+     * (or lives on another NUMA node), look for an unclaimed, preferably
+     * node-local partial slab. If every partial slab is claimed,
+     * give this CPU a fresh slab rather than sharing (bounded by
+     * SLAB_PERCPU_SLOTS extra slabs per epoch). */
+    bool want_fresh = false;
+    const uint32_t node = numa_current_node(a);
+    if (s && (slab_claimed_by_other_slot(es, s, slot) || s->numa_node != node)) {
+      s = pick_partial_for_slot(es, slot, node, &want_fresh);
+    }
+    if (!s) {
+      /* A parked empty slab is unclaimed by construction: reuse it before
+       * going to the cache or the arena. */
+      s = slab_unpark_locked(es);
+    }
     if (!s) {
       /* No partial slab available. Release lock, allocate new slab, reacquire lock.
-       * This avoids holding sc->lock while calling new_slab() → cache_pop() → cache_lock.
+       * This avoids holding sc->lock while calling new_slab() → arena_carve_slab() → arena_lock.
        * Small race window: another thread might add a slab to partial list while
        * we're unlocked, but that's fine—we'll just have one extra slab. */
       UNLOCK_WITH_RANK(&sc->lock);
       
+#if ENABLE_LATENCY_HIST
+      uint64_t ns_t0 = now_ns();
+      new_s = new_slab(a, sc, epoch);  /* Cache hit or mmap + setup */
+      lat_record(a, SLAB_LAT_NEW_SLAB, now_ns() - ns_t0);
+#else
       new_s = new_slab(a, sc, epoch);  /* Cache hit or mmap + setup */
+#endif
       if (!new_s) {
         RECORD_SAMPLE();
         return NULL;  /* Out of memory */
@@ -1721,8 +4337,9 @@ void* alloc_obj_epoch(SlabAllocator* a, uint32_t size, EpochId epoch, SlabHandle
       
       LOCK_WITH_PROBE(&sc->lock, sc, LOCK_RANK_SIZE_CLASS, "sc->lock");  /* Reacquire */
       
-      /* Check again if partial list is still empty (another thread might have added one) */
-      s = es->partial.head;
+      /* Check again if partial list is still empty (another thread might have added one).
+       * When we came here for a dedicated slab, use it regardless. */
+      s = want_fresh ? NULL : es->partial.head;
       if (!s) {
         /* Still empty, use our newly allocated slab */
         s = new_s;
@@ -1741,8 +4358,11 @@ void* alloc_obj_epoch(SlabAllocator* a, uint32_t size, EpochId epoch, SlabHandle
     assert(s->list_id == SLAB_LIST_PARTIAL);
     /* IMPORTANT: mark published before exposing via current_partial */
     s->was_published = true;
-    atomic_store_explicit(&es->current_partial, s, memory_order_release);
+    percpu_publish_locked(sc, es, cp, s);
 
+    /* The claim below runs without the lock: pin the slot before dropping
+     * it so no close can recycle s first (see slab_pin_published()) */
+    atomic_fetch_add_explicit(&es->pins[slot].n, 1u, memory_order_relaxed);
     UNLOCK_WITH_RANK(&sc->lock);
     
     /* If we allocated a slab but didn't need it (race condition), recycle it.
@@ -1752,62 +4372,71 @@ void* alloc_obj_epoch(SlabAllocator* a, uint32_t size, EpochId epoch, SlabHandle
     }
 
     /* Allocate from the slab we just published.
-     * Should almost always succeed since we just picked/created this slab. */
+     * Should almost always succeed since we just picked/created this slab.
+     * A new slab serves from its bump reserve (see the fast path). */
     uint32_t prev_fc = 0;
     uint32_t retries = 0;
-    uint32_t idx = slab_alloc_slot_atomic(s, sc, &prev_fc, &retries);
-    
-    if (idx == UINT32_MAX) {
-      /* Race: slab filled between our publish and allocation attempt.
-       * Loop back and try again with a different slab. */
-      continue;
-    }
-    
-    /* Phase 2.2: Record successful allocation + CAS retries */
-    uint64_t prev_attempts =
-        atomic_fetch_add_explicit(&sc->bitmap_alloc_attempts, 1, memory_order_relaxed);
-    uint64_t cur_attempts = prev_attempts + 1;
-    
-    if (retries > 0) {
-      atomic_fetch_add_explicit(&sc->bitmap_alloc_cas_retries, retries, memory_order_relaxed);
+    uint32_t idx = slab_bump_alloc(s);
+    const bool bumped = idx != UINT32_MAX;
+    if (!bumped) idx = slab_alloc_slot_atomic(s, sc, &prev_fc, &retries);
+    slab_unpin(es, slot);
+    if (bumped) {
+      prev_fc = s->object_count - idx;
+      if (prev_fc == 1) {
+        atomic_fetch_add_explicit(&sc->bump_allocs, s->object_count, memory_order_relaxed);
+      }
+    } else {
+      if (idx == UINT32_MAX) {
+        /* Race: slab filled between our publish and allocation attempt.
+         * Loop back and try again with a different slab. */
+        continue;
+      }
+
+      /* Phase 2.2: Record successful allocation + CAS retries */
+      SlabCounterStripe* st = sc_stripe(sc);
+      uint64_t prev_attempts =
+          atomic_fetch_add_explicit(&st->bitmap_alloc_attempts, 1, memory_order_relaxed);
+      uint64_t cur_attempts = prev_attempts + 1;
+
+      if (retries > 0) {
+        atomic_fetch_add_explicit(&st->bitmap_alloc_cas_retries, retries, memory_order_relaxed);
 #ifdef ENABLE_LABEL_CONTENTION
-      /* Phase 2.3: Attribute CAS retries to current label */
-      uint8_t lid = current_label_id(sc->parent_alloc);
-      atomic_fetch_add_explicit(&sc->bitmap_alloc_cas_retries_by_label[lid], retries, memory_order_relaxed);
+        /* Phase 2.3: Attribute CAS retries to current label */
+        uint8_t lid = current_label_id(sc->parent_alloc);
+        atomic_fetch_add_explicit(&sc->bitmap_alloc_cas_retries_by_label[lid], retries, memory_order_relaxed);
 #endif
-    }
-    
-    /* Phase 2.2+: Adaptive controller heartbeat (every 2^18 successful allocs) */
-    if ((cur_attempts & ((1u << 18) - 1u)) == 0u) {
-      scan_adapt_check(sc);
-    }
-    
-    /* Phase 2.1: If allocating from empty slab, decrement empty counter */
-    if (prev_fc == s->object_count) {
-      atomic_fetch_sub_explicit(&es->empty_partial_count, 1, memory_order_relaxed);
+      }
+
+      /* Phase 2.2+: Adaptive controller heartbeat (every 2^18 successful allocs per stripe) */
+      if ((cur_attempts & ((1u << 18) - 1u)) == 0u) {
+        scan_adapt_check(sc);
+      }
+
+      /* Phase 2.1: If allocating from empty slab, decrement empty counter */
+      if (prev_fc == s->object_count) {
+        atomic_fetch_sub_explicit(&es->empty_partial_count, 1, memory_order_relaxed);
+      }
     }
 
     /* Check if slab is now full. We check the *actual* final free_count rather than
      * relying solely on prev_fc==1, to handle cases where free_count diverged from
-     * bitmap state (e.g., due to concurrent operations or stale handle frees). */
-    uint32_t final_fc = atomic_load_explicit(&s->free_count, memory_order_acquire);
+     * bitmap state (e.g., due to concurrent operations or stale handle frees).
+     * slab_free_slots() counts the bump reserve, which free_count does not. */
+    uint32_t final_fc = slab_free_slots(s);
     if (final_fc == 0 || prev_fc == 1) {
       LOCK_WITH_PROBE(&sc->lock, sc, LOCK_RANK_SIZE_CLASS, "sc->lock");  /* Phase 2.2: Trylock probe (hot path) */
-      if (s->list_id == SLAB_LIST_PARTIAL) {
+      if (slab_on_list_locked(sc, es, s, SLAB_LIST_PARTIAL)) {
         /* Double-check free_count under lock to avoid spurious transitions */
-        final_fc = atomic_load_explicit(&s->free_count, memory_order_relaxed);
-        if (final_fc == 0) {
+        final_fc = slab_free_slots(s);
+        if (final_fc == 0 && !slab_absorb_remote_locked(sc, es, s)) {
           atomic_fetch_add_explicit(&sc->list_move_partial_to_full, 1, memory_order_relaxed);
           list_remove(&es->partial, s);
           s->list_id = SLAB_LIST_FULL;
           list_push_back(&es->full, s);
           
           /* Publish next partial if available */
-          Slab* next = es->partial.head;
-          if (next) {
-            next->was_published = true;
-          }
-          atomic_store_explicit(&es->current_partial, next, memory_order_release);
+          Slab* next = pick_partial_for_slot(es, slot, numa_current_node(a), NULL);
+          percpu_publish_locked(sc, es, cp, next);
         }
       }
       UNLOCK_WITH_RANK(&sc->lock);
@@ -1836,6 +4465,269 @@ void* alloc_obj_epoch(SlabAllocator* a, uint32_t size, EpochId epoch, SlabHandle
   #undef RECORD_SAMPLE
 }
 
+/* ------------------------------ Bound epochs (epoch_domain_alloc) ------------------------------ */
+
+/* Resolve `epoch` for slab_alloc_bound() (see SlabEpochBinding).
+ *
+ * Qualified IDs keep their own era tag, so a binding to a stale ID never
+ * claims from the slot's newer epoch. Bare indices are pinned to the era
+ * the slot has now; once it is reopened every call falls back, and
+ * alloc_obj_epoch() follows the bare index to the new epoch as usual. */
+void slab_epoch_bind(SlabAllocator* a, EpochId epoch, SlabEpochBinding* b) {
+  memset(b, 0, sizeof(*b));
+  b->alloc = a;
+  b->epoch_id = epoch;
+  b->slot = SLAB_EPOCH_INDEX(epoch);
+  if (b->slot >= a->epoch_count) {
+    b->slot = EPOCH_SLOT_NONE;
+    return;
+  }
+  
+  uint32_t q = (uint32_t)(epoch >> 32);
+  b->era_tag = q != 0 ? q
+                      : (uint32_t)(atomic_load_explicit(&a->epoch_era[b->slot], memory_order_acquire) + 1u);
+  for (uint32_t ci = 0; ci < a->num_classes; ci++) {
+    b->states[ci] = get_epoch_state(&a->classes[ci], b->slot);
+  }
+}
+
+/* Allocate one object of class `ci` from a bound epoch.
+ *
+ * Per call this is the epoch_state acquire load (same pairing with
+ * epoch_close() as alloc_obj_epoch_impl), the era compare, and the
+ * current-slab claim. No size lookup, no range check, no TLS refill
+ * bookkeeping. Not sampled by ENABLE_LATENCY_HIST or
+ * ENABLE_SLOWPATH_SAMPLING unless it falls back. */
+void* slab_alloc_bound(const SlabEpochBinding* b, uint32_t ci, SlabHandle* out) {
+  SlabAllocator* a = b->alloc;
+  SizeClassAlloc* sc = &a->classes[ci];
+  EpochState* es = b->states[ci];
+  uint32_t epoch = b->slot;
+  
+  /* Traced allocations all go through alloc_obj_epoch() */
+  if (es && !trace_on(a) &&
+      atomic_load_explicit(&a->epoch_state[epoch], memory_order_acquire) == EPOCH_ACTIVE &&
+      (uint32_t)(atomic_load_explicit(&a->epoch_era[epoch], memory_order_acquire) + 1u) == b->era_tag) {
+#if ENABLE_TLS_CACHE
+    /* Thread-cache builds serve from the bin; misses refill via the fallback */
+    void* p = tls_try_alloc(a, ci, epoch, out);
+    if (p) return p;
+#else
+    const uint32_t slot = percpu_slot();
+    _Atomic(Slab*)* cp = &es->current_partial[slot];
+    Slab* cur = atomic_load_explicit(cp, memory_order_acquire);
+    if (cur && atomic_load_explicit(&cur->magic, memory_order_relaxed) == SLAB_MAGIC) {
+      void* p = slab_claim_current(a, sc, es, ci, slot, cp, cur, out);
+      if (p) {
+#ifdef ENABLE_DRAINPROF
+        if (g_profiler) {
+          DRAINPROF_ALLOC_REGISTER(g_profiler, epoch, (uintptr_t)p, sc->object_size);
+        }
+#endif
+        return p;
+      }
+    }
+#endif
+  }
+  
+  /* Miss: the full path repairs current_partial, opens slabs, and rejects
+   * closed or stale epochs (and, as size 0, classes the table lacks). */
+  return alloc_obj_epoch(a, ci < a->num_classes ? sc->object_size : 0u, b->epoch_id, out);
+}
+
+/* List bookkeeping after freeing `freed` slots from slab s.
+ *
+ * prev_fc is free_count before the free(s). Shared by free_obj() (freed=1)
+ * and free_obj_batch() (one call per slab group).
+ */
+static void free_obj_transition(SizeClassAlloc* sc, EpochState* es, Slab* s,
+                                uint32_t prev_fc, uint32_t freed) {
+  uint32_t new_fc = prev_fc + freed;  /* New free_count after our free(s) */
+
+  /* Check if slab just became fully empty (all slots free).
+   * 
+   * SAFETY: Do NOT immediately recycle empty slabs!
+   * Other threads may still hold handles to slots in this slab.
+   * Recycling would invalidate those handles (generation mismatch).
+   * 
+   * Instead: Park it on the epoch's empty list, where the slow path reuses
+   * it before taking a new slab and epoch_close() recycles it without
+   * walking the partial and full lists. A slab some current_partial slot
+   * still publishes stays on partial (the fast path may refill it without
+   * the lock) and is parked when its slot lets go of it.
+   * 
+   * The empty_partial_count tracks these for O(1) reclaimable queries.
+   */
+  if (new_fc == s->object_count) {
+    if (s->list_id == SLAB_LIST_NONE) return;  /* Closed under us */
+    atomic_fetch_add_explicit(&es->empty_partial_count, 1, memory_order_relaxed);
+    if (s->list_id == SLAB_LIST_EMPTY || slab_claimed_by_other_slot(es, s, UINT32_MAX)) {
+      return;
+    }
+
+    LOCK_WITH_PROBE(&sc->lock, sc, LOCK_RANK_SIZE_CLASS, "sc->lock");
+    /* Re-check under lock: a concurrent epoch_close() may already have
+     * recycled it, or a slot published it meanwhile. */
+    (void)slab_park_empty_locked(sc, es, s);
+    UNLOCK_WITH_RANK(&sc->lock);
+    return;
+  }
+
+  /* Transition detection: did we just free the last allocated slot?
+   * prev_fc==0 means slab was full before our free, now it has free slots.
+   * Must move slab from FULL to PARTIAL list so it can be allocated from again. */
+  if (prev_fc == 0) {
+    LOCK_WITH_PROBE(&sc->lock, sc, LOCK_RANK_SIZE_CLASS, "sc->lock");  /* Need mutex to mutate lists */
+    
+    /* Re-check list membership under lock (defensive against races) */
+    if (slab_on_list_locked(sc, es, s, SLAB_LIST_FULL)) {
+      atomic_fetch_add_explicit(&sc->list_move_full_to_partial, 1, memory_order_relaxed);
+      list_remove(&es->full, s);
+      s->list_id = SLAB_LIST_PARTIAL;
+      list_push_back(&es->partial, s);
+      
+      /* Try to publish this slab as the freeing CPU's current_partial if that
+       * slot is NULL. This helps other threads avoid the slow path. If CAS
+       * fails, another thread already published a different slab—that's fine. */
+      assert(s->list_id == SLAB_LIST_PARTIAL);
+      /* Mark as published even if CAS fails (monotonic safety flag). */
+      s->was_published = true;
+      SlabCounterStripe* st = sc_stripe(sc);
+      atomic_fetch_add_explicit(&st->current_partial_cas_attempts, 1, memory_order_relaxed);
+      Slab* expected = NULL;
+      bool swapped = atomic_compare_exchange_strong_explicit(
+        &es->current_partial[percpu_slot()], &expected, s,
+        memory_order_release, memory_order_relaxed);
+      if (!swapped) {
+        atomic_fetch_add_explicit(&st->current_partial_cas_failures, 1, memory_order_relaxed);
+      }
+    }
+    UNLOCK_WITH_RANK(&sc->lock);
+  }
+}
+
+/* ------------------------------ Forwarding tables ------------------------------ */
+
+static bool free_obj_impl(SlabAllocator* a, SlabHandle h);
+
+/* Take a forwarding table for a slab of sc's class (caller holds sc->lock):
+ * a retired one from forward_free, else a fresh allocation. slots and
+ * size_class are fixed at allocation (readers check them without the lock);
+ * every class slab has the same object_count. Entries start at 0. */
+static SlabForward* forward_get(SizeClassAlloc* sc, uint32_t size_class, uint32_t slots) {
+  SlabForward* f = sc->forward_free;
+  if (f) {
+    sc->forward_free = f->next;
+  } else {
+    f = (SlabForward*)malloc(sizeof(SlabForward) + (size_t)slots * sizeof(SlabHandle));
+    if (!f) return NULL;
+    f->size_class = size_class;
+    f->slots = slots;
+  }
+  f->next = NULL;
+  f->prev = NULL;
+  f->live = 0;
+  for (uint32_t i = 0; i < f->slots; i++) {
+    atomic_store_explicit(&f->to[i], 0, memory_order_release);
+  }
+  return f;
+}
+
+static void forward_link(EpochState* es, SlabForward* f) {
+  f->prev = NULL;
+  f->next = es->forwards;
+  if (es->forwards) es->forwards->prev = f;
+  es->forwards = f;
+}
+
+static void forward_unlink(EpochState* es, SlabForward* f) {
+  if (f->prev) f->prev->next = f->next;
+  else es->forwards = f->next;
+  if (f->next) f->next->prev = f->prev;
+  f->prev = NULL;
+  f->next = NULL;
+}
+
+/* Retire a chain of tables (linked through next) already unlinked and
+ * unpublished from SlabMeta.fwd: their IDs go back to the registry
+ * (generation bumped, so the old handles fail from now on) and the tables
+ * onto forward_free. Called without sc->lock - the registry lock ranks
+ * below it. */
+static void forward_retire(SlabAllocator* a, SizeClassAlloc* sc, SlabForward* chain) {
+  if (!chain) return;
+  SlabForward* tail = chain;
+  for (SlabForward* f = chain; f; f = f->next) {
+    reg_free_id(&a->reg, f->slab_id);
+    tail = f;
+  }
+  LOCK_WITH_PROBE(&sc->lock, sc, LOCK_RANK_SIZE_CLASS, "sc->lock");
+  tail->next = sc->forward_free;
+  sc->forward_free = chain;
+  UNLOCK_WITH_RANK(&sc->lock);
+}
+
+/* Free a chain of tables (allocator_destroy) */
+static void forward_free_chain(SlabForward* f) {
+  while (f) {
+    SlabForward* next = f->next;
+    free(f);
+    f = next;
+  }
+}
+
+/* Next hop of (slab_id, gen, slot) through its slab's forwarding table, or 0.
+ *
+ * Lock-free (slab_handle_deref). The table may be retired and reused for
+ * another slab while we read it, so the entry only counts if the registry
+ * still forwards through the same table under the same generation after
+ * the load. */
+static SlabHandle forward_peek(SlabRegistry* r, uint32_t slab_id, uint32_t gen, uint32_t slot) {
+  SlabMeta* m = reg_meta(r, slab_id);
+  if (!m) return 0;
+  SlabForward* f = atomic_load_explicit(&m->fwd, memory_order_acquire);
+  if (!f || slot >= f->slots) return 0;
+  if (reg_gen_trunc(atomic_load_explicit(&m->gen, memory_order_acquire)) != gen) return 0;
+
+  SlabHandle to = atomic_load_explicit(&f->to[slot], memory_order_acquire);
+
+  if (atomic_load_explicit(&m->fwd, memory_order_acquire) != f) return 0;
+  if (reg_gen_trunc(atomic_load_explicit(&m->gen, memory_order_acquire)) != gen) return 0;
+  return to;
+}
+
+/* free_obj() of a handle whose slab was evacuated by slab_compact_epoch():
+ * clear the forwarding entry, retire the table with its last entry, then
+ * free the object where it lives now (which may forward again). */
+static bool free_obj_forward(SlabAllocator* a, uint32_t slab_id, uint32_t gen,
+                             uint32_t slot, uint32_t size_class) {
+  SlabMeta* m = reg_meta(&a->reg, slab_id);
+  if (!m || !atomic_load_explicit(&m->fwd, memory_order_relaxed)) return false;
+
+  SizeClassAlloc* sc = &a->classes[size_class];
+  LOCK_WITH_PROBE(&sc->lock, sc, LOCK_RANK_SIZE_CLASS, "sc->lock");
+  SlabForward* f = atomic_load_explicit(&m->fwd, memory_order_relaxed);
+  SlabHandle to = 0;
+  if (f && f->size_class == size_class && slot < f->slots &&
+      reg_gen_trunc(atomic_load_explicit(&m->gen, memory_order_relaxed)) == gen) {
+    to = atomic_load_explicit(&f->to[slot], memory_order_relaxed);
+  }
+  if (to == 0) {
+    UNLOCK_WITH_RANK(&sc->lock);
+    return false;  /* Stale handle, wrong class or double free */
+  }
+
+  atomic_store_explicit(&f->to[slot], 0, memory_order_release);
+  bool retire = --f->live == 0;
+  if (retire) {
+    forward_unlink(&sc->epochs[f->epoch], f);
+    atomic_store_explicit(&m->fwd, NULL, memory_order_release);
+  }
+  UNLOCK_WITH_RANK(&sc->lock);
+
+  if (retire) forward_retire(a, sc, f);
+  return free_obj_impl(a, to);
+}
+
 /* Free an object using its handle.
  *
  * Handle-based free is safe:
@@ -1850,153 +4742,463 @@ void* alloc_obj_epoch(SlabAllocator* a, uint32_t size, EpochId epoch, SlabHandle
  * - If slab becomes empty AND is on FULL list: recycle to cache (conservative recycling)
  * - If slab was full and now has free space: move FULL→PARTIAL
  * - Empty slabs on PARTIAL list are NOT recycled (they may be held by lock-free threads)
+ *
+ * Body in free_obj_impl(); the wrapper adds ENABLE_LATENCY_HIST timing and
+ * the trace record.
  */
 bool free_obj(SlabAllocator* a, SlabHandle h) {
+#if ENABLE_ALLOC_TRACE
+  if (h != 0 && trace_on(a)) trace_put(a, SLAB_TRACE_FREE, 0, 0, 0, h);
+#endif
+#if ENABLE_LATENCY_HIST
+  if (lat_sample()) {
+    tls_lat_timing = true;
+    uint64_t t0 = now_ns();
+    bool ok = free_obj_impl(a, h);
+    lat_record(a, SLAB_LAT_FREE, now_ns() - t0);
+    tls_lat_timing = false;
+    return ok;
+  }
+#endif
+  return free_obj_impl(a, h);
+}
+
+static bool free_obj_impl(SlabAllocator* a, SlabHandle h) {
   if (h == 0) return false;  /* NULL handle */
   
   /* Decode handle fields: slab_id (registry key), generation (ABA check),
    * slot (which slot to free), size_class (which allocator). */
   uint32_t slab_id, slot, size_class, gen;
-  handle_unpack(h, &slab_id, &gen, &slot, &size_class);
+  handle_decode(&a->reg, h, &slab_id, &gen, &slot, &size_class);
   
   /* Bounds check catches handles with invalid version bits or corrupted fields */
-  if (slab_id == UINT32_MAX || size_class >= (uint32_t)k_num_classes) return false;
+  if (slab_id == UINT32_MAX || size_class >= a->num_classes) return false;
+
+#if ENABLE_TLS_CACHE
+  /* TLS free caching removed due to metadata divergence problem:
+   * 
+   * If TLS caches frees locally without updating global bitmap/free_count,
+   * the global allocator believes slots are still allocated. This causes:
+   * - Slabs appear artificially full (free_count stays at 0)
+   * - Global selection logic makes wrong decisions
+   * - Zombie partial slabs (free_count=0, but slots available in TLS)
+   * 
+   * Option A: Update global state during TLS free (makes handles "hints" - can be stolen)
+   * Option B: Per-thread slab ownership with explicit reservation (major redesign)
+   * 
+   * Current choice: TLS alloc-only caching. Frees always update global state.
+   * This avoids metadata divergence while preserving alloc fast path benefits. */
+#endif
+
+  SizeClassAlloc* sc = &a->classes[size_class];
+  
+  /* Validate through registry: checks generation counter for ABA safety.
+   * Returns NULL if slab_id is out of bounds, generation mismatches, or slab was unmapped. */
+  Slab* s = reg_lookup_validate(&a->reg, slab_id, gen);
+  if (!s) {
+    /* Stale or invalid - unless the slab was evacuated by compaction */
+    return free_obj_forward(a, slab_id, gen, slot, size_class);
+  }
+  
+  /* Paranoid magic check (should never fail if registry validation passed) */
+  if (atomic_load_explicit(&s->magic, memory_order_relaxed) != SLAB_MAGIC) return false;
+  
+  /* Look up epoch state for this slab's epoch */
+  uint32_t epoch = s->epoch_id;
+  if (epoch >= a->epoch_count) return false;
+  EpochState* es = get_epoch_state(sc, epoch);
+
+  /* Remote-free mode: a slab this CPU slot is not allocating from belongs to
+   * some other allocating thread - defer onto its remote stack. Slabs that
+   * look full take the direct path so the FULL→PARTIAL transition (which
+   * makes the slots reachable again) still happens. So do fresh slabs
+   * (free_count 0 until the bump reserve is retired by a direct free). */
+  if (a->remote_free &&
+      atomic_load_explicit(&es->current_partial[percpu_slot()], memory_order_relaxed) != s &&
+      atomic_load_explicit(&s->free_count, memory_order_relaxed) != 0u) {
+    if (!slab_free_remote(sc, s, slot)) return false;
+#ifdef ENABLE_DRAINPROF
+    if (g_profiler) {
+      drainprof_alloc_deregister(g_profiler, epoch, (uintptr_t)slab_slot_ptr(s, slot));
+    }
+#endif
+    return true;
+  }
+
+  /* First free into a fresh slab hands its bump reserve back to the bitmap */
+  slab_bump_retire(sc, s);
+
+  /* Free the slot atomically.
+   * Returns false if slot was already free (double-free), true on success.
+   * Outputs prev_fc (previous free_count) for transition detection. */
+  uint32_t prev_fc = 0;
+  uint32_t retries = 0;
+  if (!slab_free_slot_atomic(s, slot, &prev_fc, &retries)) return false;
+  
+  /* Record free and contention metrics */
+  SlabCounterStripe* st = sc_stripe(sc);
+  atomic_fetch_add_explicit(&st->bitmap_free_attempts, 1, memory_order_relaxed);
+  if (retries > 0) {
+    atomic_fetch_add_explicit(&st->bitmap_free_cas_retries, retries, memory_order_relaxed);
+  }
+
+#if ENABLE_DIAGNOSTIC_COUNTERS
+  /* Track live bytes decrement (only reached after successful free at line 1444) */
+  atomic_fetch_sub_explicit(&sc->live_bytes, sc->object_size, memory_order_relaxed);
+#endif
+
+  /* Drainability profiler: Track deallocation from epoch */
+#ifdef ENABLE_DRAINPROF
+  if (g_profiler) {
+    void* ptr = slab_slot_ptr(s, slot);
+    drainprof_alloc_deregister(g_profiler, epoch, (uintptr_t)ptr);
+  }
+#endif
+
+  free_obj_transition(sc, es, s, prev_fc, 1);
+
+  return true;
+}
+
+/* ------------------------------ Batch API ------------------------------ */
+
+/* Slots claimed per slab_alloc_slots_atomic() call (slot field is 8 bits) */
+#define SLAB_BATCH_MAX_SLOTS 256u
+
+/* Handles sorted and grouped per free_obj_batch() chunk */
+#define FREE_BATCH_CHUNK 64u
+
+/* Batch allocation: up to count objects of one size from one epoch.
+ *
+ * Fast path works on the published current_partial slab like
+ * alloc_obj_epoch(), but claims as many slots as possible per bitmap CAS
+ * and touches free_count, the stats counters and the list transition once
+ * per slab rather than once per object. When no slab is published (or it is
+ * full), one alloc_obj_epoch() call runs the slow path (zombie repair, new
+ * slab, publish) and the loop resumes on the fast path.
+ *
+ * Returns the number of objects allocated (< count on OOM or closed epoch).
+ */
+static uint32_t alloc_obj_epoch_batch_impl(SlabAllocator* a, uint32_t size, EpochId epoch_id,
+                                           void** out_ptrs, SlabHandle* out_handles, uint32_t count);
+
+uint32_t alloc_obj_epoch_batch(SlabAllocator* a, uint32_t size, EpochId epoch_id,
+                               void** out_ptrs, SlabHandle* out_handles, uint32_t count) {
+#if ENABLE_ALLOC_TRACE
+  if (out_ptrs && trace_on(a)) {
+    _tls_trace_mute = true;
+    uint32_t n = alloc_obj_epoch_batch_impl(a, size, epoch_id, out_ptrs, out_handles, count);
+    _tls_trace_mute = false;
+    uint32_t ci = (uint32_t)class_index_for_size(a, size);
+    uint32_t era = trace_era(a, epoch_id);
+    for (uint32_t i = 0; i < n; i++) {
+      trace_put(a, SLAB_TRACE_ALLOC, ci, size, era, out_handles ? out_handles[i] : 0);
+    }
+    return n;
+  }
+#endif
+  return alloc_obj_epoch_batch_impl(a, size, epoch_id, out_ptrs, out_handles, count);
+}
+
+static uint32_t alloc_obj_epoch_batch_impl(SlabAllocator* a, uint32_t size, EpochId epoch_id,
+                                           void** out_ptrs, SlabHandle* out_handles, uint32_t count) {
+  if (!out_ptrs || count == 0) return 0;
+
+  int ci = class_index_for_size(a, size);
+  uint32_t epoch = epoch_slot(a, epoch_id);
+  if (ci < 0 || epoch == EPOCH_SLOT_NONE) return 0;
+
+  SizeClassAlloc* sc = &a->classes[(size_t)ci];
+  EpochState* es = get_epoch_state(sc, epoch);
+  uint32_t idx[SLAB_BATCH_MAX_SLOTS];
+  uint32_t n = 0;
+
+  while (n < count) {
+    uint32_t state = atomic_load_explicit(&a->epoch_state[epoch], memory_order_acquire);
+    if (state != EPOCH_ACTIVE) {
+      atomic_fetch_add_explicit(&sc->slow_path_epoch_closed, 1, memory_order_relaxed);
+      break;
+    }
+
+    const uint32_t slot = percpu_slot();
+    _Atomic(Slab*)* cp = &es->current_partial[slot];
+    Slab* cur = atomic_load_explicit(cp, memory_order_acquire);
+
+    if (cur && atomic_load_explicit(&cur->magic, memory_order_relaxed) == SLAB_MAGIC &&
+        slab_pin_published(es, slot, cur)) {
+      uint32_t want = count - n;
+      if (want > SLAB_BATCH_MAX_SLOTS) want = SLAB_BATCH_MAX_SLOTS;
+
+      uint32_t prev_fc = 0;
+      uint32_t retries = 0;
+      /* Fresh slab: one fetch_add claims a run of the bump reserve.
+       * prev_fc is then the reserve left, as with the bitmap path. */
+      uint32_t got = slab_bump_alloc_n(cur, want, idx, &prev_fc);
+      const bool bumped = got > 0;
+      if (!bumped) got = slab_alloc_slots_atomic(cur, sc, want, idx, &prev_fc, &retries);
+      slab_unpin(es, slot);
+      if (bumped) {
+        if (prev_fc == got) {
+          atomic_fetch_add_explicit(&sc->bump_allocs, cur->object_count, memory_order_relaxed);
+        }
+      } else if (got > 0) {
+        SlabCounterStripe* st = sc_stripe(sc);
+        uint64_t prev_attempts =
+            atomic_fetch_add_explicit(&st->bitmap_alloc_attempts, got, memory_order_relaxed);
+        if (retries > 0) {
+          atomic_fetch_add_explicit(&st->bitmap_alloc_cas_retries, retries, memory_order_relaxed);
+        }
+        /* Adaptive controller heartbeat: batch crossed a 2^18 boundary */
+        if (((prev_attempts + got) >> 18) != (prev_attempts >> 18)) {
+          scan_adapt_check(sc);
+        }
+
+        if (prev_fc == cur->object_count) {
+          atomic_fetch_sub_explicit(&es->empty_partial_count, 1, memory_order_relaxed);
+        }
+      }
+
+      if (got > 0) {
+        /* Batch took the last free slot: PARTIAL → FULL, publish next */
+        if (prev_fc == got) {
+          LOCK_WITH_PROBE(&sc->lock, sc, LOCK_RANK_SIZE_CLASS, "sc->lock");
+          if (slab_on_list_locked(sc, es, cur, SLAB_LIST_PARTIAL) && !slab_absorb_remote_locked(sc, es, cur)) {
+            atomic_fetch_add_explicit(&sc->list_move_partial_to_full, 1, memory_order_relaxed);
+            list_remove(&es->partial, cur);
+            cur->list_id = SLAB_LIST_FULL;
+            list_push_back(&es->full, cur);
+            percpu_publish_locked(sc, es, cp, pick_partial_for_slot(es, slot, numa_current_node(a), NULL));
+          }
+          UNLOCK_WITH_RANK(&sc->lock);
+        }
 
-#if ENABLE_TLS_CACHE
-  /* TLS free caching removed due to metadata divergence problem:
-   * 
-   * If TLS caches frees locally without updating global bitmap/free_count,
-   * the global allocator believes slots are still allocated. This causes:
-   * - Slabs appear artificially full (free_count stays at 0)
-   * - Global selection logic makes wrong decisions
-   * - Zombie partial slabs (free_count=0, but slots available in TLS)
-   * 
-   * Option A: Update global state during TLS free (makes handles "hints" - can be stolen)
-   * Option B: Per-thread slab ownership with explicit reservation (major redesign)
-   * 
-   * Current choice: TLS alloc-only caching. Frees always update global state.
-   * This avoids metadata divergence while preserving alloc fast path benefits. */
+        /* Generation is per slab: one registry read for the whole batch */
+        uint32_t id = cur->slab_id;
+        uint32_t gen = reg_get_gen24(&a->reg, id);
+        for (uint32_t k = 0; k < got; k++, n++) {
+          out_ptrs[n] = slab_slot_ptr(cur, idx[k]);
+          if (out_handles) {
+            out_handles[n] = handle_pack(id | a->reg.id_tag, gen, (uint8_t)idx[k], (uint8_t)ci);
+          }
+#ifdef ENABLE_DRAINPROF
+          if (g_profiler) {
+            DRAINPROF_ALLOC_REGISTER(g_profiler, epoch, (uintptr_t)out_ptrs[n], size);
+          }
+#endif
+        }
+
+#if ENABLE_DIAGNOSTIC_COUNTERS
+        atomic_fetch_add_explicit(&sc->live_bytes, (uint64_t)sc->object_size * got, memory_order_relaxed);
 #endif
+        continue;
+      }
+    }
+
+    /* No usable published slab: single allocation takes the slow path */
+    SlabHandle h = 0;
+    void* p = alloc_obj_epoch(a, size, epoch, &h);
+    if (!p) break;
+    out_ptrs[n] = p;
+    if (out_handles) out_handles[n] = h;
+    n++;
+  }
+
+  return n;
+}
+
+/* Free one group of handles that all name the same slab (same slab_id+gen).
+ * Clears each bitmap word with one CAS and free_count with one RMW.
+ * Returns the number of slots actually freed. */
+static uint32_t free_obj_group(SlabAllocator* a, const SlabHandle* hs, uint32_t n) {
+  /* Reference handle: first one with a valid version (sort order is arbitrary) */
+  uint32_t slab_id = UINT32_MAX, gen = 0, slot = 0, size_class = UINT32_MAX;
+  for (uint32_t i = 0; i < n && slab_id == UINT32_MAX; i++) {
+    handle_decode(&a->reg, hs[i], &slab_id, &gen, &slot, &size_class);
+  }
+  if (slab_id == UINT32_MAX || size_class >= a->num_classes) return 0;
 
   SizeClassAlloc* sc = &a->classes[size_class];
-  
-  /* Validate through registry: checks generation counter for ABA safety.
-   * Returns NULL if slab_id is out of bounds, generation mismatches, or slab was unmapped. */
   Slab* s = reg_lookup_validate(&a->reg, slab_id, gen);
-  if (!s) return false;  /* Handle is stale or invalid */
-  
-  /* Paranoid magic check (should never fail if registry validation passed) */
-  if (atomic_load_explicit(&s->magic, memory_order_relaxed) != SLAB_MAGIC) return false;
-  
-  /* Look up epoch state for this slab's epoch */
+  if (!s) {
+    /* Evacuated by compaction: each handle follows its own forwarding entry */
+    uint32_t freed = 0;
+    for (uint32_t i = 0; i < n; i++) {
+      if (free_obj_impl(a, hs[i])) freed++;
+    }
+    return freed;
+  }
+  if (atomic_load_explicit(&s->magic, memory_order_relaxed) != SLAB_MAGIC) return 0;
+
   uint32_t epoch = s->epoch_id;
-  if (epoch >= a->epoch_count) return false;
+  if (epoch >= a->epoch_count) return 0;
   EpochState* es = get_epoch_state(sc, epoch);
 
-  /* Free the slot atomically.
-   * Returns false if slot was already free (double-free), true on success.
-   * Outputs prev_fc (previous free_count) for transition detection. */
-  uint32_t prev_fc = 0;
+  slab_bump_retire(sc, s);  /* Reserve bits must not look like live slots */
+
+  /* Build per-word clear masks; duplicates within the batch are double frees */
+  const uint32_t words = slab_bitmap_words(s->object_count);
+  uint32_t clear[(SLAB_BATCH_MAX_SLOTS + 31u) / 32u] = {0};
+  for (uint32_t i = 0; i < n; i++) {
+    uint32_t sid, g, sl, cls;
+    handle_decode(&a->reg, hs[i], &sid, &g, &sl, &cls);
+    if (sid != slab_id || cls != size_class || sl >= s->object_count) continue;
+    clear[sl / 32u] |= 1u << (sl % 32u);
+  }
+
+  _Atomic uint32_t* bm = slab_bitmap_ptr(s);
+  uint32_t freed = 0;
   uint32_t retries = 0;
-  if (!slab_free_slot_atomic(s, slot, &prev_fc, &retries)) return false;
-  
-  /* Record free and contention metrics */
-  atomic_fetch_add_explicit(&sc->bitmap_free_attempts, 1, memory_order_relaxed);
+  for (uint32_t w = 0; w < words; w++) {
+    if (clear[w] == 0u) continue;
+    uint32_t x = atomic_load_explicit(&bm[w], memory_order_relaxed);
+    uint32_t m;
+    for (;;) {
+      m = clear[w] & x;  /* Bits already clear are double frees: skip them */
+      if (m == 0u) break;
+      if (atomic_compare_exchange_weak_explicit(
+              &bm[w], &x, x & ~m,
+              memory_order_acq_rel,
+              memory_order_relaxed)) {
+        break;
+      }
+      retries++;
+    }
+    clear[w] = m;  /* Now: bits this call actually freed */
+    freed += popcount32(m);
+  }
+  if (freed == 0) return 0;
+
+  uint32_t prev_fc = atomic_fetch_add_explicit(&s->free_count, freed, memory_order_relaxed);
+
+  SlabCounterStripe* st = sc_stripe(sc);
+  atomic_fetch_add_explicit(&st->bitmap_free_attempts, freed, memory_order_relaxed);
   if (retries > 0) {
-    atomic_fetch_add_explicit(&sc->bitmap_free_cas_retries, retries, memory_order_relaxed);
+    atomic_fetch_add_explicit(&st->bitmap_free_cas_retries, retries, memory_order_relaxed);
   }
 
 #if ENABLE_DIAGNOSTIC_COUNTERS
-  /* Track live bytes decrement (only reached after successful free at line 1444) */
-  atomic_fetch_sub_explicit(&sc->live_bytes, sc->object_size, memory_order_relaxed);
+  atomic_fetch_sub_explicit(&sc->live_bytes, (uint64_t)sc->object_size * freed, memory_order_relaxed);
 #endif
 
-  /* Drainability profiler: Track deallocation from epoch */
 #ifdef ENABLE_DRAINPROF
   if (g_profiler) {
-    void* ptr = slab_slot_ptr(s, slot);
-    drainprof_alloc_deregister(g_profiler, epoch, (uintptr_t)ptr);
+    for (uint32_t w = 0; w < words; w++) {
+      for (uint32_t m = clear[w]; m; m &= m - 1u) {
+        void* ptr = slab_slot_ptr(s, w * 32u + ctz32(m));
+        drainprof_alloc_deregister(g_profiler, epoch, (uintptr_t)ptr);
+      }
+    }
   }
 #endif
 
-  uint32_t new_fc = prev_fc + 1;  /* New free_count after our free */
+  free_obj_transition(sc, es, s, prev_fc, freed);
+  return freed;
+}
 
-  /* Check if slab just became fully empty (all slots free).
-   * 
-   * SAFETY: Do NOT immediately recycle empty slabs!
-   * Other threads may still hold handles to slots in this slab.
-   * Recycling would invalidate those handles (generation mismatch).
-   * 
-   * Instead: Keep empty slabs on the partial list until epoch_close()
-   * or explicit cleanup. This ensures all outstanding handles remain valid.
-   * 
-   * The empty_partial_count tracks these for potential trimming during
-   * epoch_close() when it's safe (no outstanding allocations from that epoch).
-   */
-  if (new_fc == s->object_count) {
-    /* Slab is now fully empty. Two cases:
-     * 1. Was on FULL list → move to PARTIAL (so it can be reused)
-     * 2. Was on PARTIAL list → already correct, just increment empty counter
-     */
-    if (s->list_id == SLAB_LIST_FULL) {
-      LOCK_WITH_PROBE(&sc->lock, sc, LOCK_RANK_SIZE_CLASS, "sc->lock");
-      
-      /* Move from full→partial */
-      list_remove(&es->full, s);
-      list_push_back(&es->partial, s);
-      s->list_id = SLAB_LIST_PARTIAL;
-      
-      /* Track as empty partial */
-      atomic_fetch_add_explicit(&es->empty_partial_count, 1, memory_order_relaxed);
-      
-      UNLOCK_WITH_RANK(&sc->lock);
-    } else if (s->list_id == SLAB_LIST_PARTIAL) {
-      /* Already on partial list, just became fully empty */
-      atomic_fetch_add_explicit(&es->empty_partial_count, 1, memory_order_relaxed);
+/* Batch free: handles in any order, from any slabs, classes and epochs.
+ *
+ * Each chunk of FREE_BATCH_CHUNK handles is sorted so handles for the same
+ * slab are adjacent (slab_id and generation are the high handle bits), then
+ * each slab group is freed with free_obj_group().
+ *
+ * Returns the number of objects freed. Invalid, stale and double-freed
+ * handles are skipped (free_obj() would return false for them).
+ */
+uint32_t free_obj_batch(SlabAllocator* a, const SlabHandle* handles, uint32_t count) {
+  if (!handles) return 0;
+
+#if ENABLE_ALLOC_TRACE
+  if (trace_on(a)) {
+    for (uint32_t i = 0; i < count; i++) {
+      if (handles[i] != 0) trace_put(a, SLAB_TRACE_FREE, 0, 0, 0, handles[i]);
     }
-    
-    return true;
   }
+#endif
 
-  /* Transition detection: did we just free the last allocated slot?
-   * prev_fc==0 means slab was full before our free, now it has one free slot.
-   * Must move slab from FULL to PARTIAL list so it can be allocated from again. */
-  if (prev_fc == 0) {
-    LOCK_WITH_PROBE(&sc->lock, sc, LOCK_RANK_SIZE_CLASS, "sc->lock");  /* Need mutex to mutate lists */
-    
-    /* Re-check list membership under lock (defensive against races) */
-    if (s->list_id == SLAB_LIST_FULL) {
-      atomic_fetch_add_explicit(&sc->list_move_full_to_partial, 1, memory_order_relaxed);
-      list_remove(&es->full, s);
-      s->list_id = SLAB_LIST_PARTIAL;
-      list_push_back(&es->partial, s);
-      
-      /* Try to publish this slab as current_partial if it's currently NULL.
-       * This helps other threads avoid the slow path. If CAS fails, another
-       * thread already published a different slab—that's fine. */
-      assert(s->list_id == SLAB_LIST_PARTIAL);
-      /* Mark as published even if CAS fails (monotonic safety flag). */
-      s->was_published = true;
-      atomic_fetch_add_explicit(&sc->current_partial_cas_attempts, 1, memory_order_relaxed);
-      Slab* expected = NULL;
-      bool swapped = atomic_compare_exchange_strong_explicit(
-        &es->current_partial, &expected, s,
-        memory_order_release, memory_order_relaxed);
-      if (!swapped) {
-        atomic_fetch_add_explicit(&sc->current_partial_cas_failures, 1, memory_order_relaxed);
+  SlabHandle chunk[FREE_BATCH_CHUNK];
+  uint32_t freed = 0;
+
+  for (uint32_t base = 0; base < count; base += FREE_BATCH_CHUNK) {
+    uint32_t m = count - base;
+    if (m > FREE_BATCH_CHUNK) m = FREE_BATCH_CHUNK;
+
+    /* Insertion sort: chunks are small and often already grouped */
+    for (uint32_t i = 0; i < m; i++) {
+      SlabHandle h = handles[base + i];
+      uint32_t j = i;
+      while (j > 0 && chunk[j - 1] > h) {
+        chunk[j] = chunk[j - 1];
+        j--;
       }
+      chunk[j] = h;
+    }
+
+    for (uint32_t i = 0; i < m; ) {
+      uint32_t j = i + 1;
+      while (j < m && (chunk[j] >> HANDLE_GEN_SHIFT) == (chunk[i] >> HANDLE_GEN_SHIFT)) j++;  /* Same slab_id + gen */
+      if (chunk[i] != 0) freed += free_obj_group(a, &chunk[i], j - i);
+      i = j;
     }
-    UNLOCK_WITH_RANK(&sc->lock);
   }
 
-  return true;
+  return freed;
 }
 
 /* ------------------------------ Malloc-style wrapper ------------------------------ */
 
+/* Recover the slab and slot behind a bare object pointer (header_free mode).
+ *
+ * Slabs are aligned to their own size and start with their header, so for
+ * each slab size in use (smallest first) p & ~(size - 1) is a candidate
+ * header. A candidate is accepted only if its magic matches AND the registry
+ * entry for its slab_id points back at it: object bytes that merely look
+ * like a header can't pass the second test. An object in the first page of
+ * a multi-page slab resolves at the smallest size already, which is fine—
+ * it is the same header.
+ *
+ * Returns NULL for pointers into recycled slabs (magic cleared), interior
+ * pointers, and anything outside this allocator's arenas. The arena check
+ * comes first, so candidate headers are only ever read inside our own
+ * mappings and foreign pointers are safe to pass.
+ */
+static Slab* slab_from_ptr(SlabAllocator* a, const void* p, uint32_t* out_slot) {
+  const uintptr_t addr = (uintptr_t)p;
+  if (!slab_owns(a, p)) return NULL;
+  uint32_t shifts = a->slab_size_shifts;
+  while (shifts) {
+    const uint32_t k = (uint32_t)__builtin_ctz(shifts);
+    shifts &= shifts - 1u;
+    
+    Slab* s = (Slab*)(addr & ~(((uintptr_t)1 << k) - 1u));
+    if (addr < (uintptr_t)s + slab_header_size()) continue;  /* Header bytes: not a slot here */
+    if (atomic_load_explicit(&s->magic, memory_order_acquire) != SLAB_MAGIC) continue;
+    
+    SlabMeta* m = reg_meta(&a->reg, s->slab_id);
+    if (!m || atomic_load_explicit(&m->ptr, memory_order_acquire) != s) continue;
+    
+    /* Genuine header: the pointer must name a slot start */
+    uintptr_t data = (uintptr_t)slab_data_ptr(s);
+    if (addr < data) return NULL;
+    uintptr_t off = addr - data;
+    if (off % s->object_size != 0) return NULL;
+    uint32_t slot = (uint32_t)(off / s->object_size);
+    if (slot >= s->object_count) return NULL;
+    *out_slot = slot;
+    return s;
+  }
+  return NULL;
+}
+
 void* slab_malloc_epoch(SlabAllocator* a, size_t size, EpochId epoch) {
+  if (a->header_free) {
+    /* No prefix: the object is the allocation, up to the largest class */
+    if (size == 0 || size > a->max_alloc_size) return NULL;
+    SlabHandle h;  /* Discarded: slab_free() rebuilds it from the pointer */
+    return alloc_obj_epoch(a, (uint32_t)size, epoch, &h);
+  }
+  
   /* Reserve 8 bytes for handle header */
-  if (size == 0 || size > 504) return NULL;  /* Max: 512 - 8 = 504 bytes */
+  if (size == 0 || size > a->max_alloc_size - sizeof(SlabHandle)) return NULL;  /* Default max: 16384 - 8 = 16376 bytes */
   
   /* Round up to ensure SlabHandle and user pointer are both 8-byte aligned */
   uint32_t alloc_size = (uint32_t)((size + sizeof(SlabHandle) + 7) & ~7u);
@@ -2012,9 +5214,39 @@ void* slab_malloc_epoch(SlabAllocator* a, size_t size, EpochId epoch) {
 }
 
 
+size_t slab_usable_size(SlabAllocator* a, const void* ptr) {
+  if (!ptr) return 0;
+  const uint8_t* obj = (const uint8_t*)ptr;
+  if (!a->header_free) obj -= sizeof(SlabHandle);  /* Slot starts at the prefix */
+  
+  uint32_t slot;
+  Slab* s = slab_from_ptr(a, obj, &slot);
+  if (!s) return 0;
+  
+  /* Only live objects have a size: the slot's bitmap bit must be set and
+   * the slot must not still be in a fresh slab's bump reserve */
+  uint32_t w = atomic_load_explicit(&slab_bitmap_ptr(s)[slot / 32u], memory_order_relaxed);
+  if (!((w >> (slot % 32u)) & 1u)) return 0;
+  if (slot >= atomic_load_explicit(&s->bump_next, memory_order_relaxed)) return 0;
+  return s->object_size - (size_t)((const uint8_t*)ptr - obj);
+}
+
 void slab_free(SlabAllocator* a, void* ptr) {
   if (!ptr) return;
   
+  if (a->header_free) {
+    /* Rebuild the handle from the slab header (current generation) and take
+     * the normal validated path: the bitmap still rejects double frees */
+    uint32_t slot;
+    Slab* s = slab_from_ptr(a, ptr, &slot);
+    if (!s) return;
+    int ci = class_index_for_size(a, s->object_size);
+    if (ci < 0) return;
+    uint32_t id = s->slab_id;
+    free_obj(a, handle_pack(id | a->reg.id_tag, reg_get_gen24(&a->reg, id), (uint8_t)slot, (uint8_t)ci));
+    return;
+  }
+  
   /* Read handle from 8 bytes before user pointer (use memcpy for unaligned safety) */
   SlabHandle h;
   memcpy(&h, (uint8_t*)ptr - sizeof(SlabHandle), sizeof(SlabHandle));
@@ -2026,34 +5258,43 @@ void slab_free(SlabAllocator* a, void* ptr) {
 /* ------------------------------ Cleanup ------------------------------ */
 
 void allocator_destroy(SlabAllocator* a) {
-  for (size_t i = 0; i < k_num_classes; i++) {
+#if ENABLE_TLS_CACHE
+  /* Thread bins still referencing us are discarded by their owners from now on */
+  tls_allocator_unregister(a);
+#endif
+
+  /* The stats publisher reads class counters: stop it first */
+  if (a->stats_shm_stop) a->stats_shm_stop(a);
+
+  /* Queued async closes touch class lists: finish them before tearing down */
+  slab_reclaimer_stop(a);
+  pthread_mutex_destroy(&a->reclaimer.lock);
+  pthread_cond_destroy(&a->reclaimer.wake);
+
+#if ENABLE_ALLOC_TRACE
+  /* Final trace header, then the rings */
+  trace_destroy(a);
+#endif
+
+  for (size_t i = 0; i < a->num_classes; i++) {
     SizeClassAlloc* sc = &a->classes[i];
 
     LOCK_WITHOUT_PROBE(&sc->lock, LOCK_RANK_SIZE_CLASS, "sc->lock");
 
     /* Destroy all per-epoch state */
     if (sc->epochs) {
-      for (uint32_t e = 0; e < EPOCH_COUNT; e++) {
+      for (uint32_t e = 0; e < a->epoch_count; e++) {
         EpochState* es = &sc->epochs[e];
         
-        Slab* cur = es->partial.head;
-        while (cur) {
-          Slab* next = cur->next;
-          unmap_one_page(cur);
-          cur = next;
-        }
-
-        cur = es->full.head;
-        while (cur) {
-          Slab* next = cur->next;
-          unmap_one_page(cur);
-          cur = next;
-        }
-
+        /* Slab memory belongs to the arenas (unmapped below), so the
+         * lists only need to be forgotten, not walked. */
         list_init(&es->partial);
         list_init(&es->full);
-        atomic_store_explicit(&es->current_partial, NULL, memory_order_relaxed);
+        list_init(&es->empty);
+        percpu_clear_all(es, memory_order_relaxed);
         atomic_store_explicit(&es->empty_partial_count, 0, memory_order_relaxed);
+        forward_free_chain(es->forwards);
+        es->forwards = NULL;
       }
       
       free(sc->epochs);
@@ -2061,58 +5302,75 @@ void allocator_destroy(SlabAllocator* a) {
     }
     
     sc->total_slabs = 0;
+    forward_free_chain(sc->forward_free);
+    sc->forward_free = NULL;
 
     UNLOCK_WITH_RANK(&sc->lock);
     pthread_mutex_destroy(&sc->lock);
 
-    /* Drain slab cache (now storing CachedSlab entries) */
-    LOCK_WITHOUT_PROBE(&sc->cache_lock, LOCK_RANK_CACHE, "sc->cache_lock");
-    for (size_t j = 0; j < sc->cache_size; j++) {
+    /* Drain every node pool's slab cache. Nodes and slab memory go with the
+     * arenas below; only the stack heads and diagnostics need resetting. */
+    for (uint32_t n = 0; sc->pools && n < a->numa_nodes; n++) {
+      SlabNodePool* pool = &sc->pools[n];
 #if ENABLE_DIAGNOSTIC_COUNTERS
-      /* Decrement committed_bytes before munmap for accurate cleanup tracking */
-      atomic_fetch_sub_explicit(&sc->committed_bytes, SLAB_PAGE_SIZE, memory_order_relaxed);
+      /* Decrement committed_bytes for cached slabs for accurate cleanup tracking */
+      uint32_t cached = atomic_load_explicit(&pool->cache_count, memory_order_relaxed);
+      atomic_fetch_sub_explicit(&sc->committed_bytes, (uint64_t)cached * sc->slab_bytes,
+                                memory_order_relaxed);
 #endif
-      unmap_one_page(sc->slab_cache[j].slab);
+      atomic_store_explicit(&pool->cache_head, (uint64_t)SLAB_CACHE_NIL, memory_order_relaxed);
+      atomic_store_explicit(&pool->cache_count, 0u, memory_order_relaxed);
+      atomic_store_explicit(&pool->cache_clean, 0u, memory_order_relaxed);
     }
-    free(sc->slab_cache);
-    sc->cache_size = 0;
-    sc->cache_capacity = 0;
+    atomic_store_explicit(&sc->cache_capacity, 0u, memory_order_relaxed);
     
-    /* Drain overflow list (free nodes and unmap slabs) */
-    CachedNode* node = sc->cache_overflow_head;
-    while (node) {
-      CachedNode* next = node->next;
-      unmap_one_page(node->slab);
-      free(node);
-      node = next;
-    }
-    sc->cache_overflow_head = NULL;
-    sc->cache_overflow_tail = NULL;
-    sc->cache_overflow_len = 0;
+    /* Unmap whole arena regions: one munmap per region instead of per slab.
+     * Covers every slab ever carved (partial, full, cached, overflowed). */
+    if (sc->pools) {
+      arena_release_all(sc, a->numa_nodes);
+      for (uint32_t n = 0; n < a->numa_nodes; n++) {
+        pthread_mutex_destroy(&sc->pools[n].arena_lock);
+      }
+      free(sc->pools);
+      sc->pools = NULL;
+    }
     
-    UNLOCK_WITH_RANK(&sc->cache_lock);
-    pthread_mutex_destroy(&sc->cache_lock);
+    free(sc->stripes);
+    sc->stripes = NULL;
   }
   
   /* Destroy label lock */
   pthread_mutex_destroy(&a->epoch_label_lock);
   
+  /* Per-epoch arrays (the reclaimer was stopped above) */
+  epoch_ring_free(a);
+  
   /* Destroy slab registry */
   reg_destroy(&a->reg);
+  
+  /* Arena ownership map (regions were unmapped above) */
+  _Atomic(_Atomic uint64_t*)* top = atomic_load_explicit(&a->arena_map, memory_order_relaxed);
+  if (top) {
+    for (uint32_t i = 0; i < ARENA_MAP_TOP; i++) {
+      free(atomic_load_explicit(&top[i], memory_order_relaxed));
+    }
+    free(top);
+    atomic_store_explicit(&a->arena_map, NULL, memory_order_relaxed);
+  }
 }
 
 /* ------------------------------ Performance counters ------------------------------ */
 
 void get_perf_counters(SlabAllocator* a, uint32_t size_class, PerfCounters* out) {
-  if (size_class >= k_num_classes || !out) return;
+  if (size_class >= a->num_classes || !out) return;
   
   SizeClassAlloc* sc = &a->classes[size_class];
   out->slow_path_hits = atomic_load_explicit(&sc->slow_path_hits, memory_order_relaxed);
   out->new_slab_count = atomic_load_explicit(&sc->new_slab_count, memory_order_relaxed);
   out->list_move_partial_to_full = atomic_load_explicit(&sc->list_move_partial_to_full, memory_order_relaxed);
   out->list_move_full_to_partial = atomic_load_explicit(&sc->list_move_full_to_partial, memory_order_relaxed);
-  out->current_partial_null = atomic_load_explicit(&sc->current_partial_null, memory_order_relaxed);
-  out->current_partial_full = atomic_load_explicit(&sc->current_partial_full, memory_order_relaxed);
+  out->current_partial_null = SC_COUNTER_SUM(sc, current_partial_null);
+  out->current_partial_full = SC_COUNTER_SUM(sc, current_partial_full);
   out->empty_slab_recycled = atomic_load_explicit(&sc->empty_slab_recycled, memory_order_relaxed);
   out->empty_slab_overflowed = atomic_load_explicit(&sc->empty_slab_overflowed, memory_order_relaxed);
 }
@@ -2141,12 +5399,32 @@ uint64_t read_rss_bytes_linux(void) {
 
 /* Get current active epoch ID.
  *
- * Returns ring index (0-15), not the raw monotonic counter.
- * This is the epoch where new allocations go.
+ * Returns the era-qualified ID: ring slot in the low half, era + 1 in the
+ * high half. The era is the epoch sequence itself, and epoch_advance()
+ * stamps a slot's era before publishing the sequence, so the ID returned
+ * here always validates until the ring wraps onto its slot again.
  */
 EpochId epoch_current(SlabAllocator* a) {
-  uint32_t raw = atomic_load_explicit(&a->current_epoch, memory_order_relaxed);
-  return raw % a->epoch_count;  /* Modulo wraps to ring: 16→0, 17→1, etc. */
+  uint64_t seq = atomic_load_explicit(&a->current_epoch, memory_order_acquire);
+  return epoch_make_id((uint32_t)seq & a->epoch_mask, seq);
+}
+
+uint32_t slab_epoch_count(SlabAllocator* a) {
+  return a->epoch_count;
+}
+
+bool epoch_id_valid(SlabAllocator* a, EpochId epoch) {
+  return epoch_slot(a, epoch) != EPOCH_SLOT_NONE;
+}
+
+/* Raise a slot's era, never lower it: an advancer that lost the sequence
+ * race must not overwrite the era a later lap already stamped. */
+static void epoch_era_raise(SlabAllocator* a, uint32_t slot, uint64_t era) {
+  uint64_t cur = atomic_load_explicit(&a->epoch_era[slot], memory_order_relaxed);
+  while (cur < era &&
+         !atomic_compare_exchange_weak_explicit(&a->epoch_era[slot], &cur, era,
+                                                memory_order_release, memory_order_relaxed)) {
+  }
 }
 
 /* Advance to next epoch (rotate ring buffer).
@@ -2163,15 +5441,23 @@ EpochId epoch_current(SlabAllocator* a) {
  * Typical usage: Call every ~1 second to rotate generations.
  * With 16 epochs, this gives ~16 seconds for objects to drain before wraparound.
  *
- * Ring wraparound: After epoch 15, advances to epoch 0 (overwrites oldest generation).
- * This is safe because applications should have drained old epochs via epoch_close().
+ * Ring wraparound: After the last slot, advances to slot 0 (overwrites oldest
+ * generation). Qualified IDs of the overwritten epoch go stale at this point.
  */
 void epoch_advance(SlabAllocator* a) {
-  /* Atomically increment and capture both old and new epoch IDs.
-   * current_epoch is a monotonic counter (never decreases), we modulo to get ring index. */
-  uint32_t old_epoch_raw = atomic_fetch_add_explicit(&a->current_epoch, 1, memory_order_relaxed);
-  uint32_t old_epoch = old_epoch_raw % a->epoch_count;      /* Ring index: 0-15 */
-  uint32_t new_epoch = (old_epoch_raw + 1) % a->epoch_count;  /* Next ring slot */
+  /* Claim the next sequence number. current_epoch is monotonic (never
+   * decreases); the ring slot is its low bits. The new slot's era is stamped
+   * BEFORE the sequence is published, so epoch_current() never hands out an
+   * ID that its own slot would reject as stale. */
+  uint64_t old_seq = atomic_load_explicit(&a->current_epoch, memory_order_relaxed);
+  uint64_t new_seq;
+  do {
+    new_seq = old_seq + 1u;
+    epoch_era_raise(a, (uint32_t)new_seq & a->epoch_mask, new_seq);
+  } while (!atomic_compare_exchange_weak_explicit(&a->current_epoch, &old_seq, new_seq,
+                                                  memory_order_acq_rel, memory_order_relaxed));
+  uint32_t old_epoch = (uint32_t)old_seq & a->epoch_mask;  /* Ring slot being closed */
+  uint32_t new_epoch = (uint32_t)new_seq & a->epoch_mask;  /* Next ring slot */
   
   /* Phase 1: Close old epoch.
    * Mark CLOSING to reject new allocations (checked in alloc_obj_epoch).
@@ -2180,7 +5466,7 @@ void epoch_advance(SlabAllocator* a) {
   
   /* Phase 2: Open new epoch.
    * Mark ACTIVE to accept allocations. On wraparound, this overwrites CLOSING
-   * state from 16 rotations ago (epoch 0 after 15→0 wrap). */
+   * state from epoch_count rotations ago. */
   atomic_store_explicit(&a->epoch_state[new_epoch], EPOCH_ACTIVE, memory_order_relaxed);
 
   /* Drainability profiler: Track new epoch opening */
@@ -2190,43 +5476,270 @@ void epoch_advance(SlabAllocator* a) {
   }
 #endif
 
-  /* Stamp monotonic era for observability.
-   * Helps distinguish "epoch 5 at era 100" from "epoch 5 at era 116" after wraparound.
-   * Useful for correlating allocator events with application logs. */
-  uint64_t era = atomic_fetch_add_explicit(&a->epoch_era_counter, 1, memory_order_relaxed);
-  atomic_store_explicit(&a->epoch_era[new_epoch], era + 1, memory_order_release);
+  /* Monotonic era counter for observability (the slot itself was stamped
+   * above). Helps distinguish "epoch 5 at era 100" from "epoch 5 at era 116"
+   * after wraparound, and correlate allocator events with application logs. */
+  atomic_fetch_add_explicit(&a->epoch_era_counter, 1, memory_order_relaxed);
+#if ENABLE_ALLOC_TRACE
+  if (trace_on(a)) trace_put(a, SLAB_TRACE_EPOCH_ADVANCE, 0, 0, (uint32_t)new_seq, 0);
+#endif
   
   /* Reset metadata for new epoch (overwrites data from previous rotation).
    * Timestamp lets us measure epoch lifetime. Label cleared for fresh annotation. */
   a->epoch_meta[new_epoch].open_since_ns = now_ns();
   atomic_store_explicit(&a->epoch_meta[new_epoch].domain_refcount, 0, memory_order_relaxed);
   a->epoch_meta[new_epoch].label[0] = '\0';
+  atomic_store_explicit(&a->epoch_meta[new_epoch].label_id, 0, memory_order_relaxed);  /* Quota charges too */
   
   /* Phase 3: Null current_partial for old epoch across all size classes.
    * Prevents fast-path threads from allocating into CLOSING epoch.
-   * Threads will see NULL and fall back to slow path, which checks epoch state. */
-  for (size_t i = 0; i < k_num_classes; i++) {
-    EpochState* es = &a->classes[i].epochs[old_epoch];
-    atomic_store_explicit(&es->current_partial, NULL, memory_order_release);
+   * Threads will see NULL and fall back to slow path, which checks epoch state.
+   * Under the lock so slabs that went empty while published are parked. */
+  for (size_t i = 0; i < a->num_classes; i++) {
+    SizeClassAlloc* sc = &a->classes[i];
+    LOCK_WITH_PROBE(&sc->lock, sc, LOCK_RANK_SIZE_CLASS, "sc->lock");
+    percpu_clear_all_locked(sc, &sc->epochs[old_epoch]);
+    UNLOCK_WITH_RANK(&sc->lock);
+  }
+  
+  /* Old epoch now drains passively.
+   * - Frees continue normally (decrement free_count, transition tracking)
+   * - Empty slabs recycled immediately (CLOSING triggers aggressive recycling in free_obj)
+   * - No new allocations refill partially-empty slabs (CLOSING check rejects them)
+   *
+   * To force immediate reclamation, call epoch_close(old_epoch) explicitly. */
+}
+
+/* Recycle the already-empty slabs of one (class, epoch).
+ *
+ * Slabs that went empty while the epoch was open were parked on es->empty
+ * (by free_obj_transition, or when their current_partial slot let go), so
+ * the close detaches that list instead of searching partial and full.
+ *
+ * Cost: O(e) where e = parked empty slabs of this class in the epoch; the
+ * lock is held only to unlink them and madvise happens outside it. With
+ * remote_free the partial and full lists are also walked once to absorb
+ * deferred frees, which is O(n) in the epoch's slabs of this class.
+ * One call is the reclaimer's unit of work (budget is checked between classes).
+ */
+static void epoch_close_class(SlabAllocator* a, uint32_t epoch, size_t i) {
+  SizeClassAlloc* sc = &a->classes[i];
+  EpochState* es = &sc->epochs[epoch];
+  
+  /* Recycle the slabs parked on the empty list.
+   *
+   * Slabs are parked as they go empty (free_obj_transition) or as the slot
+   * publishing an empty one lets go of it, so close cost is proportional
+   * to the reclaimable slabs, not to every slab the epoch holds.
+   * Collect under the lock, recycle outside it (cache_push does madvise),
+   * so there are no syscalls inside the critical section. */
+  LOCK_WITH_PROBE(&sc->lock, sc, LOCK_RANK_SIZE_CLASS, "sc->lock");
+  
+  /* Null current_partial (all CPU slots) to prevent fast-path allocations into this epoch.
+   * Threads will see NULL and fall to slow path, which checks CLOSING state.
+   * Slabs that went empty while published are parked as their slot clears. */
+  percpu_clear_all_locked(sc, es);
+  
+  /* Pass 0: Absorb remote frees nobody collected (remote_free mode only).
+   * Deferred frees are invisible until drained, so this mode still walks
+   * the partial and full lists. FULL slabs that regain free slots move
+   * back to PARTIAL; slabs the drain empties are parked. */
+  if (a->remote_free) {
+    for (Slab* s = es->partial.head; s;) {
+      Slab* next = s->next;
+      (void)slab_absorb_remote_locked(sc, es, s);
+      (void)slab_park_empty_locked(sc, es, s);
+      s = next;
+    }
+    for (Slab* s = es->full.head; s;) {
+      Slab* next = s->next;
+      uint32_t prev_fc = 0;
+      uint32_t got = slab_drain_remote(sc, s, &prev_fc);
+      if (got > 0) {
+        list_remove(&es->full, s);
+        list_push_back(&es->partial, s);
+        s->list_id = SLAB_LIST_PARTIAL;
+        atomic_fetch_add_explicit(&sc->list_move_full_to_partial, 1, memory_order_relaxed);
+        if (prev_fc + got == s->object_count) {
+          atomic_fetch_add_explicit(&es->empty_partial_count, 1, memory_order_relaxed);
+          (void)slab_park_empty_locked(sc, es, s);
+        }
+      }
+      s = next;
+    }
+  }
+  
+  /* Update telemetry: how many slabs scanned (recycled is added below) */
+  size_t scanned_count = es->empty.len;
+  atomic_fetch_add_explicit(&sc->epoch_close_scanned_slabs, scanned_count, memory_order_relaxed);
+  if (scanned_count == 0) {
+    UNLOCK_WITH_RANK(&sc->lock);
+    return;
+  }
+  
+  /* Optimization: Use stack allocation for common case (<= 32 slabs).
+   * Avoids malloc overhead when closing small epochs. Fall back to heap
+   * for large epochs (e.g., long-running batch processing). */
+  Slab** empty_slabs = NULL;
+  Slab* stack_buf[32];
+  
+  if (scanned_count <= 32) {
+    empty_slabs = stack_buf;  /* Fast path: stack allocation */
+  } else {
+    empty_slabs = (Slab**)malloc(scanned_count * sizeof(Slab*));
+    if (!empty_slabs) {
+      /* Malloc failed. Skip recycling for this size class.
+       * Memory stays allocated but epoch still marked CLOSING. */
+      UNLOCK_WITH_RANK(&sc->lock);
+      return;
+    }
+  }
+  
+  /* Detach the empty list and mark SLAB_LIST_NONE so the slabs can be
+   * recycled safely. A stale fast-path claim (a pointer loaded before its
+   * slot was cleared) may have refilled a parked slab: those go back to
+   * partial or full instead. While one is still in flight it pins its
+   * slot, and the parked slabs wait for a later close or the slow path's
+   * unpark. */
+  size_t idx = 0;
+  const bool pinned = !epoch_unpinned(es);
+  Slab* cur;
+  while (!pinned && (cur = es->empty.head) != NULL) {
+    list_remove(&es->empty, cur);
+    uint32_t fc = slab_free_slots(cur);
+    if (fc == cur->object_count) {
+      cur->list_id = SLAB_LIST_NONE;
+      sc->total_slabs--;
+      empty_slabs[idx++] = cur;
+    } else if (fc == 0) {
+      cur->list_id = SLAB_LIST_FULL;
+      list_push_back(&es->full, cur);
+    } else {
+      cur->list_id = SLAB_LIST_PARTIAL;
+      list_push_back(&es->partial, cur);
+    }
+  }
+  if (idx > 0) {
+    atomic_fetch_add_explicit(&sc->epoch_close_recycled_slabs, idx, memory_order_relaxed);
+  }
+  
+  UNLOCK_WITH_RANK(&sc->lock);
+  
+  /* Recycle all collected slabs immediately.
+   * cache_push_batch() skips madvise for slabs ever published lock-free and,
+   * in BATCHED/LAZY mode, coalesces the rest into vectored range returns. */
+  cache_push_batch(sc, empty_slabs, idx);
+  
+  /* Clean up heap allocation if we used it */
+  if (empty_slabs != stack_buf) {
+    free(empty_slabs);
+  }
+}
+
+/* Everything epoch_close() does after the CLOSING store: TLS flush, per-class
+ * empty-list drain + recycle, RSS before/after and latency telemetry.
+ *
+ * r == NULL: run to completion on the caller's thread (epoch_close()).
+ * r != NULL: reclaimer thread. Pauses pause_us whenever a slice exceeds
+ * slice_budget_ns, and stops early if the epoch was reopened (ACTIVE) in the
+ * meantime, since scanning an epoch that accepts allocations again would hand
+ * its newly emptied slabs back to the cache under the allocating threads.
+ *
+ * Returns false if the work was abandoned because the epoch reopened.
+ */
+static bool epoch_close_work(SlabAllocator* a, uint32_t epoch, SlabReclaimer* r) {
+  /* Capture start time for latency telemetry.
+   * Helps answer "how long does epoch_close take?" for capacity planning. */
+  uint64_t start_ns = now_ns();
+  
+  /* Capture RSS before reclaiming to measure reclamation effectiveness.
+   * Delta (before - after) shows MB returned to OS. */
+  uint64_t rss_before = read_rss_bytes_linux();
+  a->epoch_meta[epoch].rss_before_close = rss_before;
+  
+#if ENABLE_TLS_CACHE
+  /* TLS Cache: Ask every thread to drop its bins for this epoch.
+   * 
+   * O(1): bumps the epoch's flush generation so no bin of it serves another
+   * allocation; owners hand the cached slots back at their next alloc (see
+   * tls_request_epoch_flush). Slots still parked in idle threads' bins are
+   * not counted free by the scan below - they come back to the slab later. */
+  tls_request_epoch_flush(a, epoch);
+#endif
+  
+  /* Phase 2: Recycle each class's parked empty slabs. */
+  bool finished = true;
+  uint64_t slice_start = start_ns;
+  for (size_t i = 0; i < a->num_classes; i++) {
+    if (r) {
+      if (atomic_load_explicit(&a->epoch_state[epoch], memory_order_acquire) != EPOCH_CLOSING) {
+        finished = false;
+        break;
+      }
+      if (r->slice_budget_ns && now_ns() - slice_start > r->slice_budget_ns) {
+        atomic_fetch_add_explicit(&r->budget_pauses, 1, memory_order_relaxed);
+        struct timespec pause = { (time_t)(r->pause_us / 1000000u), (long)(r->pause_us % 1000000u) * 1000L };
+        nanosleep(&pause, NULL);
+        slice_start = now_ns();
+      }
+    }
+    epoch_close_class(a, epoch, i);
+  }
+  
+  /* Phase 3: Measure reclamation impact.
+   *
+   * Capture RSS after recycling to quantify how much memory was returned.
+   * Delta (rss_before - rss_after) shows effectiveness of epoch_close.
+   * Applications can export this to track memory efficiency. */
+  uint64_t rss_after = read_rss_bytes_linux();
+  a->epoch_meta[epoch].rss_after_close = rss_after;
+  
+  /* Update latency telemetry. Helps capacity planning: "How long does
+   * epoch_close take?" Async closes include budget pauses (wall time). */
+  uint64_t elapsed_ns = now_ns() - start_ns;
+#if ENABLE_LATENCY_HIST
+  lat_record(a, SLAB_LAT_EPOCH_CLOSE, elapsed_ns);
+#endif
+  
+  /* Update per-class counters (aggregate, not per-epoch).
+   * Same elapsed_ns added to all size classes—represents total epoch_close cost. */
+  for (size_t i = 0; i < a->num_classes; i++) {
+    atomic_fetch_add_explicit(&a->classes[i].epoch_close_calls, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&a->classes[i].epoch_close_total_ns, elapsed_ns, memory_order_relaxed);
+  }
+  return finished;
+}
+
+/* Phase 1 of a close: mark epoch CLOSING to reject new allocations.
+ * This is the gate that enables aggressive recycling:
+ * - free_obj() checks epoch state and recycles empty slabs immediately
+ * - alloc_obj_epoch() checks epoch state and rejects allocations
+ *
+ * CRITICAL: Use memory_order_release to ensure all threads observe CLOSING
+ * before we flush their TLS caches. With relaxed ordering, threads could
+ * refill caches from this epoch even after flush completes (race condition).
+ *
+ * current_partial slots are nulled later by epoch_close_class(); until then
+ * the fast path's own CLOSING check turns allocations away. */
+static void epoch_close_mark(SlabAllocator* a, uint32_t epoch) {
+  /* Drainability profiler: Track epoch closing (measures drainability) */
+#ifdef ENABLE_DRAINPROF
+  if (g_profiler) {
+    drainprof_granule_close(g_profiler, epoch);
   }
-  
-  /* Old epoch now drains passively.
-   * - Frees continue normally (decrement free_count, transition tracking)
-   * - Empty slabs recycled immediately (CLOSING triggers aggressive recycling in free_obj)
-   * - No new allocations refill partially-empty slabs (CLOSING check rejects them)
-   *
-   * To force immediate reclamation, call epoch_close(old_epoch) explicitly. */
+#endif
+  atomic_store_explicit(&a->epoch_state[epoch], EPOCH_CLOSING, memory_order_release);
 }
 
 /* Force immediate reclamation of an epoch's memory.
  *
- * Unlike epoch_advance (which passively drains), epoch_close actively scans
- * for empty slabs and recycles them immediately. This triggers RSS drops when
+ * Unlike epoch_advance (which passively drains), epoch_close actively
+ * recycles the epoch's empty slabs right away. This triggers RSS drops when
  * ENABLE_RSS_RECLAMATION is enabled.
  *
  * Two-phase reclamation:
  * 1. Mark epoch CLOSING (reject new allocations)
- * 2. Proactively scan partial/full lists for already-empty slabs
+ * 2. Drain each class's empty list into the slab cache
  *
  * Use cases:
  * - End of request: Close request epoch to reclaim memory immediately
@@ -2234,248 +5747,592 @@ void epoch_advance(SlabAllocator* a) {
  * - Memory pressure: Reclaim idle generations to stay under RSS limit
  *
  * Performance characteristics:
- * - Scans all slabs in epoch (O(n) where n = total slabs)
+ * - O(empty slabs): only the empty lists are walked, not partial/full
+ *   (remote_free mode also walks partial/full, see epoch_close_class)
  * - Recycling happens outside lock (madvise doesn't block allocations)
- * - Typical latency: 50-500µs depending on slab count
+ * - Latency is dominated by madvise, so it scales with the slabs returned
  *
  * Difference from epoch_advance:
  * - epoch_advance: Rotates to next epoch (implicit close of old epoch)
  * - epoch_close: Explicit close without rotation (target specific epoch)
  *
- * Safety: Can be called on any epoch, even current or future ones.
- * Calling on current epoch stops further allocation into it.
+ * Safety: Can be called on any live epoch, including the current one,
+ * which stops further allocation into it. Stale or out-of-range ids are
+ * ignored, so a late close never hits the epoch that reused the slot.
  */
-void epoch_close(SlabAllocator* a, EpochId epoch) {
-  if (!a || epoch >= a->epoch_count) return;
+void epoch_close(SlabAllocator* a, EpochId epoch_id) {
+  if (!a) return;
+  uint32_t epoch = epoch_slot(a, epoch_id);
+  if (epoch == EPOCH_SLOT_NONE) return;  /* Out of range, or stale: never close a newer epoch */
+#if ENABLE_ALLOC_TRACE
+  if (trace_on(a)) trace_put(a, SLAB_TRACE_EPOCH_CLOSE, 0, 0, trace_era(a, epoch_id), 0);
+#endif
+
+  epoch_close_mark(a, epoch);
+  (void)epoch_close_work(a, epoch, NULL);
+  
+  /* Epoch now fully closed and drained.
+   *
+   * Future frees into this epoch:
+   * - Continue normally (bitmap clear, free_count increment)
+   * - Empty slabs recycled immediately (CLOSING triggers aggressive recycling)
+   *
+   * Future allocations into this epoch:
+   * - Rejected (alloc_obj_epoch checks CLOSING state)
+   *
+   * Expected RSS behavior with ENABLE_RSS_RECLAMATION=1:
+   * - RSS drops immediately after epoch_close returns
+   * - Delta visible in rss_before_close - rss_after_close
+   * - Physical pages returned to kernel, available for other processes */
+}
+
+/* ------------------------------ Background reclamation ------------------------------ */
+
+#define RECLAIMER_DEFAULT_BUDGET_NS 1000000ull  /* 1ms of work per slice */
+#define RECLAIMER_DEFAULT_PAUSE_US  200u        /* then yield the CPU for 200µs */
+
+/* Idle tick (every SLAB_CACHE_WINDOW_MS with an empty queue): caches of
+ * classes nobody allocates from still decay and get trimmed, and the
+ * memory budget is checked without waiting for the next carve. */
+static void reclaimer_tick(SlabAllocator* a) {
+  uint32_t now_ms = coarse_ms();
+  for (size_t i = 0; i < a->num_classes; i++) cache_adapt_tick(&a->classes[i], now_ms);
+  budget_enforce(a, now_ms, false);
+}
+
+/* Reclaimer thread: pop queued epochs FIFO and run epoch_close_work() on
+ * each with the configured budget. Callbacks run without r->lock so they may
+ * resubmit. Exits once stop is set and the queue is empty. */
+static void* reclaimer_main(void* arg) {
+  SlabAllocator* a = (SlabAllocator*)arg;
+  SlabReclaimer* r = &a->reclaimer;
+
+  pthread_mutex_lock(&r->lock);
+  for (;;) {
+    while (r->queue_len == 0 && !r->stop) {
+      struct timespec deadline;
+      clock_gettime(CLOCK_REALTIME, &deadline);
+      deadline.tv_nsec += (long)SLAB_CACHE_WINDOW_MS * 1000000L;
+      if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+      }
+      if (pthread_cond_timedwait(&r->wake, &r->lock, &deadline) == ETIMEDOUT) {
+        pthread_mutex_unlock(&r->lock);
+        reclaimer_tick(a);
+        pthread_mutex_lock(&r->lock);
+      }
+    }
+    if (r->queue_len == 0) break;  /* stop requested, queue drained */
+
+    uint32_t epoch = r->queue[r->queue_head];
+    r->queue_head = (r->queue_head + 1u) & a->epoch_mask;
+    r->queue_len--;
+    SlabReclaimJob job = r->jobs[epoch];
+    pthread_mutex_unlock(&r->lock);
+
+    if (!epoch_close_work(a, epoch, r)) {
+      atomic_fetch_add_explicit(&r->abandoned, 1, memory_order_relaxed);
+    }
+    atomic_fetch_add_explicit(&r->completed, 1, memory_order_relaxed);
+    /* Clear before the callback: cb may queue the same epoch again */
+    atomic_fetch_sub_explicit(&r->pending_count, 1, memory_order_relaxed);
+    atomic_store_explicit(&r->pending[epoch], 0, memory_order_release);
+    if (job.cb) job.cb(a, job.id, job.cb_arg);
+
+    pthread_mutex_lock(&r->lock);
+  }
+  pthread_mutex_unlock(&r->lock);
+  return NULL;
+}
+
+bool slab_reclaimer_start(SlabAllocator* a, const SlabReclaimerConfig* config) {
+  SlabReclaimer* r = &a->reclaimer;
+
+  pthread_mutex_lock(&r->lock);
+  if (r->running) {
+    pthread_mutex_unlock(&r->lock);
+    errno = EALREADY;
+    return false;
+  }
+  r->slice_budget_ns = config ? config->slice_budget_ns : RECLAIMER_DEFAULT_BUDGET_NS;
+  r->pause_us = config ? config->pause_us : RECLAIMER_DEFAULT_PAUSE_US;
+  r->stop = false;
+  int rc = pthread_create(&r->thread, NULL, reclaimer_main, a);
+  if (rc != 0) {
+    pthread_mutex_unlock(&r->lock);
+    errno = rc;
+    return false;
+  }
+  r->running = true;
+  pthread_mutex_unlock(&r->lock);
+  return true;
+}
+
+void slab_reclaimer_stop(SlabAllocator* a) {
+  SlabReclaimer* r = &a->reclaimer;
+
+  pthread_mutex_lock(&r->lock);
+  if (!r->running) {
+    pthread_mutex_unlock(&r->lock);
+    return;
+  }
+  r->stop = true;
+  pthread_cond_signal(&r->wake);
+  pthread_mutex_unlock(&r->lock);
+
+  pthread_join(r->thread, NULL);
+
+  pthread_mutex_lock(&r->lock);
+  r->running = false;
+  r->stop = false;
+  pthread_mutex_unlock(&r->lock);
+}
+
+bool epoch_close_async(SlabAllocator* a, EpochId epoch_id, EpochCloseCallback cb, void* arg) {
+  if (!a || SLAB_EPOCH_INDEX(epoch_id) >= a->epoch_count) {
+    errno = EINVAL;
+    return false;
+  }
+  uint32_t epoch = epoch_slot(a, epoch_id);
+  if (epoch == EPOCH_SLOT_NONE) {
+    errno = ESTALE;
+    return false;
+  }
+  SlabReclaimer* r = &a->reclaimer;
+
+  pthread_mutex_lock(&r->lock);
+  if (atomic_load_explicit(&r->pending[epoch], memory_order_relaxed)) {
+    pthread_mutex_unlock(&r->lock);
+    errno = EBUSY;
+    return false;
+  }
+  if (!r->running || r->stop) {
+    /* No reclaimer: synchronous close, callback inline */
+    pthread_mutex_unlock(&r->lock);
+    epoch_close(a, epoch_id);
+    if (cb) cb(a, epoch_id, arg);
+    return true;
+  }
+
+#if ENABLE_ALLOC_TRACE
+  if (trace_on(a)) trace_put(a, SLAB_TRACE_EPOCH_CLOSE, 0, 0, trace_era(a, epoch_id), 0);
+#endif
+  epoch_close_mark(a, epoch);
+  atomic_store_explicit(&r->pending[epoch], 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&r->pending_count, 1, memory_order_relaxed);
+  r->jobs[epoch] = (SlabReclaimJob){ .cb = cb, .cb_arg = arg, .id = epoch_id };
+  r->queue[(r->queue_head + r->queue_len) & a->epoch_mask] = epoch;
+  r->queue_len++;
+  atomic_fetch_add_explicit(&r->submitted, 1, memory_order_relaxed);
+  pthread_cond_signal(&r->wake);
+  pthread_mutex_unlock(&r->lock);
+  return true;
+}
+
+/* Checks the ring slot only: for a stale ID this may report a newer close
+ * of the same slot as still pending, never the reverse. */
+bool epoch_close_done(SlabAllocator* a, EpochId epoch_id) {
+  uint32_t epoch = SLAB_EPOCH_INDEX(epoch_id);
+  if (!a || epoch >= a->epoch_count) return true;
+  return atomic_load_explicit(&a->reclaimer.pending[epoch], memory_order_acquire) == 0;
+}
+
+bool slab_set_reclaim_mode(SlabAllocator* a, SlabReclaimMode mode) {
+  if (!a || (uint32_t)mode > SLAB_RECLAIM_LAZY) {
+    errno = EINVAL;
+    return false;
+  }
+  atomic_store_explicit(&a->reclaim_mode, (uint32_t)mode, memory_order_relaxed);
+  return true;
+}
+
+/* Bulk-release every slab of an epoch without per-object frees.
+ *
+ * For arena-style epochs where every object is dead at once (request
+ * teardown), this replaces N free_obj() calls + epoch_close() with one
+ * O(slabs) pass:
+ * 1. Mark CLOSING and null every current_partial slot (as epoch_close)
+ * 2. Under sc->lock, detach the whole partial and full lists
+ * 3. Outside the lock, bump each slab's registry generation (outstanding
+ *    handles now fail validation) and cache_push() it (madvise path for
+ *    never-published slabs)
+ *
+ * Objects that were still live are discarded, not freed: their bitmap and
+ * free_count are rebuilt by new_slab() on reuse.
+ *
+ * Caller contract: no thread is allocating into or freeing from this epoch
+ * concurrently. A racing free_obj() with a pre-release handle fails
+ * validation once the generation is bumped; one already past validation
+ * touches a slab that is no longer on any list (list_id NONE, so no list
+ * moves), which new_slab() reinitializes anyway.
+ *
+ * Returns the number of slabs released.
+ */
+size_t epoch_release_all(SlabAllocator* a, EpochId epoch_id) {
+  if (!a) return 0;
+  uint32_t epoch = epoch_slot(a, epoch_id);
+  if (epoch == EPOCH_SLOT_NONE) return 0;  /* A stale ID must not release the newer epoch */
+#if ENABLE_ALLOC_TRACE
+  if (trace_on(a)) trace_put(a, SLAB_TRACE_EPOCH_RELEASE, 0, 0, trace_era(a, epoch_id), 0);
+#endif
 
-  /* Drainability profiler: Track epoch closing (measures drainability) */
 #ifdef ENABLE_DRAINPROF
   if (g_profiler) {
     drainprof_granule_close(g_profiler, epoch);
   }
 #endif
 
-  /* Capture start time for latency telemetry.
-   * Helps answer "how long does epoch_close take?" for capacity planning. */
-  struct timespec start_ts;
-  clock_gettime(CLOCK_MONOTONIC, &start_ts);
-  uint64_t start_ns = (uint64_t)start_ts.tv_sec * 1000000000ULL + (uint64_t)start_ts.tv_nsec;
-  
-  /* Capture RSS before closing to measure reclamation effectiveness.
-   * Delta (before - after) shows MB returned to OS. */
-  uint64_t rss_before = read_rss_bytes_linux();
-  a->epoch_meta[epoch].rss_before_close = rss_before;
-  
-  /* Phase 1: Mark epoch CLOSING to reject new allocations.
-   * This is the gate that enables aggressive recycling:
-   * - free_obj() checks epoch state and recycles empty slabs immediately
-   * - alloc_obj_epoch() checks epoch state and rejects allocations
-   *
-   * CRITICAL: Use memory_order_release to ensure all threads observe CLOSING
-   * before we flush their TLS caches. With relaxed ordering, threads could
-   * refill caches from this epoch even after flush completes (race condition). */
+  /* Same gate as epoch_close(): release store before TLS flush */
   atomic_store_explicit(&a->epoch_state[epoch], EPOCH_CLOSING, memory_order_release);
-  
+
 #if ENABLE_TLS_CACHE
-  /* TLS Cache: Flush all handles from this epoch across all threads.
-   * 
-   * CRITICAL: Must happen BEFORE slab reclamation scanning to ensure accurate
-   * free_count and empty slab detection. If TLS caches hold handles from this
-   * epoch, those handles represent allocated slots that haven't been freed yet.
-   * 
-   * Thread registry lock ensures no threads modify their TLS caches during flush. */
-  tls_flush_epoch_all_threads(a, epoch);
+  /* Cached handles from this epoch must never be served after the generation
+   * bump: the flush generation changes, so every bin of it reads as stale */
+  tls_request_epoch_flush(a, epoch);
 #endif
-  
-  /* Phase 2: Proactively scan for already-empty slabs and recycle them.
-   *
-   * Problem: Slabs that became empty BEFORE epoch_close() was called are sitting
-   * on the partial list. The free_obj() reactive path only recycles slabs at the
-   * moment they transition to empty, so we need proactive scanning.
-   *
-   * Without this scan, empty slabs would stay allocated until the next free into
-   * that epoch, causing RSS to stay elevated unnecessarily.
-   *
-   * Algorithm complexity: O(n) where n = total slabs in epoch across all size classes.
-   * Lock hold time: O(n) for scan + unlink, but madvise happens outside lock.
-   */
-  for (size_t i = 0; i < k_num_classes; i++) {
+
+  size_t released = 0;
+
+  for (size_t i = 0; i < a->num_classes; i++) {
     SizeClassAlloc* sc = &a->classes[i];
     EpochState* es = &sc->epochs[epoch];
-    
-    /* Null current_partial to prevent fast-path allocations into this epoch.
-     * Threads will see NULL and fall to slow path, which checks CLOSING state. */
-    atomic_store_explicit(&es->current_partial, NULL, memory_order_release);
-    
-    /* Scan both partial and full lists for empty slabs.
-     *
-     * Strategy: Two-pass algorithm to avoid O(n²) restart pattern.
-     * Pass 1: Count empty slabs (quick, read-only)
-     * Pass 2: Collect empty slabs into array (remove from lists)
-     * Pass 3: Recycle outside lock (call cache_push, which does madvise)
-     *
-     * This minimizes lock hold time—no syscalls inside critical section. */
+
+    percpu_clear_all(es, memory_order_seq_cst);
+
+    /* Detach all three lists in O(1) + mark nodes off-list in O(slabs).
+     * Slabs stay chained through next until recycled below. */
     LOCK_WITH_PROBE(&sc->lock, sc, LOCK_RANK_SIZE_CLASS, "sc->lock");
-    
-    /* Pass 1: Count empty slabs for array allocation */
-    size_t empty_count = 0;
-    size_t scanned_count = 0;
-    for (Slab* s = es->partial.head; s; s = s->next) {
-      scanned_count++;
-      /* Empty check: free_count == object_count means all slots free */
-      if (atomic_load_explicit(&s->free_count, memory_order_relaxed) == s->object_count) {
-        empty_count++;
+    Slab* chain = NULL;
+    Slab* tail = NULL;
+    SlabList* lists[3] = {&es->partial, &es->full, &es->empty};
+    for (int l = 0; l < 3; l++) {
+      if (!lists[l]->head) continue;
+      if (tail) {
+        tail->next = lists[l]->head;
+      } else {
+        chain = lists[l]->head;
       }
+      tail = lists[l]->tail;
     }
-    for (Slab* s = es->full.head; s; s = s->next) {
-      scanned_count++;
-      if (atomic_load_explicit(&s->free_count, memory_order_relaxed) == s->object_count) {
-        empty_count++;
-      }
+    size_t n = es->partial.len + es->full.len + es->empty.len;
+    list_init(&es->partial);
+    list_init(&es->full);
+    list_init(&es->empty);
+    atomic_store_explicit(&es->empty_partial_count, 0, memory_order_relaxed);
+    for (Slab* s = chain; s; s = s->next) {
+      s->list_id = SLAB_LIST_NONE;
     }
-    
-    /* Update telemetry: how many slabs scanned, how many recycled */
-    atomic_fetch_add_explicit(&sc->epoch_close_scanned_slabs, scanned_count, memory_order_relaxed);
-    if (empty_count > 0) {
-      atomic_fetch_add_explicit(&sc->epoch_close_recycled_slabs, empty_count, memory_order_relaxed);
+    sc->total_slabs -= n;
+
+    /* Moved objects die with their new slabs: stop forwarding to them */
+    SlabForward* fwd = es->forwards;
+    es->forwards = NULL;
+    for (SlabForward* f = fwd; f; f = f->next) {
+      atomic_store_explicit(&reg_meta(&a->reg, f->slab_id)->fwd, NULL, memory_order_release);
     }
-    
-    if (empty_count > 0) {
-      /* Pass 2: Allocate temporary array to collect empty slabs.
-       *
-       * Optimization: Use stack allocation for common case (<= 32 slabs).
-       * Avoids malloc overhead when closing small epochs. Fall back to heap
-       * for large epochs (e.g., long-running batch processing). */
-      Slab** empty_slabs = NULL;
-      Slab* stack_buf[32];
-      
-      if (empty_count <= 32) {
-        empty_slabs = stack_buf;  /* Fast path: stack allocation */
-      } else {
-        empty_slabs = (Slab**)malloc(empty_count * sizeof(Slab*));
-        if (!empty_slabs) {
-          /* Malloc failed. Skip recycling for this size class.
-           * Memory stays allocated but epoch still marked CLOSING. */
-          UNLOCK_WITH_RANK(&sc->lock);
-          return;
-        }
+    UNLOCK_WITH_RANK(&sc->lock);
+    forward_retire(a, sc, fwd);
+
+    /* Gather the chain into fixed-size batches so BATCHED/LAZY reclaim can
+     * coalesce neighbouring slabs into one range per run. */
+    uint64_t live_objects = 0;
+    Slab* batch[64];
+    size_t nb = 0;
+    Slab* s = chain;
+    if (s) epoch_wait_unpinned(es);  /* A stale claimer must finish before reuse */
+    while (s) {
+      Slab* next = s->next;
+      s->prev = NULL;
+      s->next = NULL;
+
+      live_objects += s->object_count - slab_free_slots(s);
+
+      /* Invalidate outstanding handles now, not at reuse time */
+      (void)reg_bump_gen(&a->reg, s->slab_id);
+      batch[nb++] = s;
+      if (nb == sizeof(batch) / sizeof(batch[0])) {
+        cache_push_batch(sc, batch, nb);
+        nb = 0;
       }
-      
-      /* Pass 2: Collect empty slabs from both lists.
-       * Unlink from lists and mark SLAB_LIST_NONE so they can be recycled safely. */
-      size_t idx = 0;
-      Slab* cur = es->partial.head;
-      while (cur) {
-        Slab* next = cur->next;  /* Save next before unlinking */
-        if (atomic_load_explicit(&cur->free_count, memory_order_relaxed) == cur->object_count) {
-          list_remove(&es->partial, cur);
-          cur->list_id = SLAB_LIST_NONE;
-          sc->total_slabs--;
-          empty_slabs[idx++] = cur;
-        }
-        cur = next;
+      s = next;
+    }
+    cache_push_batch(sc, batch, nb);
+
+#if ENABLE_DIAGNOSTIC_COUNTERS
+    atomic_fetch_sub_explicit(&sc->live_bytes, live_objects * sc->object_size, memory_order_relaxed);
+#endif
+
+    atomic_fetch_add_explicit(&sc->epoch_release_calls, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&sc->epoch_release_slabs, n, memory_order_relaxed);
+    atomic_fetch_add_explicit(&sc->epoch_release_objects, live_objects, memory_order_relaxed);
+    released += n;
+  }
+
+  a->epoch_meta[epoch].rss_after_close = read_rss_bytes_linux();
+  return released;
+}
+
+/* ------------------------------ Compaction ------------------------------ */
+
+/* Slab and its live count, sorted sparsest first */
+typedef struct CompactSlab {
+  Slab* slab;
+  uint32_t live;
+} CompactSlab;
+
+static int cmp_compact_live(const void* x, const void* y) {
+  uint32_t a = ((const CompactSlab*)x)->live;
+  uint32_t b = ((const CompactSlab*)y)->live;
+  return (a > b) - (a < b);
+}
+
+/* Compact one class of a CLOSING epoch (see slab_compact_epoch()).
+ *
+ * Under sc->lock: detach all three lists, absorb remote frees and retire bump
+ * reserves so every slab's bitmap says exactly which slots are live, then
+ * sort by live count. Sources are the longest sparsest-first prefix whose
+ * live objects fit into the free slots of the remaining slabs; their
+ * objects are copied into the densest slabs first, so the least occupied
+ * survivors keep the free space. Survivors are re-filed PARTIAL/FULL/EMPTY by
+ * occupancy and sources recycled outside the lock, like epoch_close().
+ *
+ * Returns slabs released; on allocation failure nothing more is moved. */
+static uint32_t compact_class(SlabAllocator* a, uint32_t epoch, uint32_t ci, SlabCompactStats* st) {
+  SizeClassAlloc* sc = &a->classes[ci];
+  EpochState* es = &sc->epochs[epoch];
+
+  percpu_clear_all(es, memory_order_seq_cst);
+
+  LOCK_WITH_PROBE(&sc->lock, sc, LOCK_RANK_SIZE_CLASS, "sc->lock");
+  size_t n = es->partial.len + es->full.len + es->empty.len;
+  if (n == 0) {
+    UNLOCK_WITH_RANK(&sc->lock);
+    return 0;
+  }
+  CompactSlab* v = (CompactSlab*)malloc(n * sizeof(CompactSlab));
+  Slab** out = (Slab**)malloc(n * sizeof(Slab*));
+  if (!v || !out) {
+    UNLOCK_WITH_RANK(&sc->lock);
+    free(v);
+    free(out);
+    return 0;
+  }
+
+  size_t k = 0;
+  Slab* s;
+  while ((s = es->partial.head) != NULL) {
+    list_remove(&es->partial, s);
+    v[k++].slab = s;
+  }
+  while ((s = es->full.head) != NULL) {
+    list_remove(&es->full, s);
+    v[k++].slab = s;
+  }
+  while ((s = es->empty.head) != NULL) {
+    list_remove(&es->empty, s);
+    v[k++].slab = s;
+  }
+  atomic_store_explicit(&es->empty_partial_count, 0, memory_order_relaxed);
+
+  uint64_t total_free = 0;
+  epoch_wait_unpinned(es);  /* Stale claims land before the census */
+  for (size_t i = 0; i < n; i++) {
+    s = v[i].slab;
+    (void)slab_drain_remote(sc, s, NULL);  /* Deferred frees are dead objects */
+    slab_bump_retire_locked(sc, s);        /* Reserve bits must not look live */
+    uint32_t fc = atomic_load_explicit(&s->free_count, memory_order_relaxed);
+    v[i].live = s->object_count - fc;
+    total_free += fc;
+  }
+  qsort(v, n, sizeof(CompactSlab), cmp_compact_live);
+
+  /* Largest m such that the m sparsest slabs' objects fit in the others */
+  size_t m = 0;
+  uint64_t src_live = 0, src_free = 0;
+  while (m < n) {
+    uint64_t live = src_live + v[m].live;
+    uint64_t fc = v[m].slab->object_count - v[m].live;
+    if (live > total_free - src_free - fc) break;
+    src_live = live;
+    src_free += fc;
+    m++;
+  }
+
+  size_t d = n;  /* Destination cursor: v[d - 1], densest first */
+  size_t nout = 0;
+  for (size_t i = 0; i < m; i++) {
+    s = v[i].slab;
+    if (v[i].live > 0) {
+      SlabForward* f = forward_get(sc, ci, s->object_count);
+      if (!f) {
+        m = i;  /* This slab and the rest stay where they are */
+        break;
       }
-      
-      /* Also scan full list (slabs can be on full list if they were filled,
-       * then fully freed but not yet moved to partial). */
-      cur = es->full.head;
-      while (cur) {
-        Slab* next = cur->next;
-        if (atomic_load_explicit(&cur->free_count, memory_order_relaxed) == cur->object_count) {
-          list_remove(&es->full, cur);
-          cur->list_id = SLAB_LIST_NONE;
-          sc->total_slabs--;
-          empty_slabs[idx++] = cur;
+      f->slab_id = s->slab_id;
+      f->epoch = epoch;
+
+      _Atomic uint32_t* bm = slab_bitmap_ptr(s);
+      const uint32_t words = slab_bitmap_words(s->object_count);
+      for (uint32_t w = 0; w < words; w++) {
+        uint32_t x = atomic_load_explicit(&bm[w], memory_order_relaxed);
+        while (x) {
+          uint32_t slot = w * 32u + ctz32(x);
+          x &= x - 1u;
+          if (slot >= s->object_count) break;  /* Padding bits of the last word */
+
+          /* The fit check guarantees a free slot before d reaches m */
+          uint32_t j = UINT32_MAX;
+          while (j == UINT32_MAX) {
+            assert(d > m);
+            uint32_t prev_fc = 0, retries = 0;
+            j = slab_alloc_slot_atomic(v[d - 1].slab, sc, &prev_fc, &retries);
+            if (j == UINT32_MAX) d--;
+          }
+          Slab* t = v[d - 1].slab;
+          memcpy(slab_slot_ptr(t, j), slab_slot_ptr(s, slot), sc->object_size);
+          atomic_store_explicit(&f->to[slot], encode_handle(t, &a->reg, j, ci), memory_order_release);
+          f->live++;
         }
-        cur = next;
-      }
-      
-      UNLOCK_WITH_RANK(&sc->lock);
-      
-      /* Pass 3: Recycle all collected slabs immediately.
-       * cache_push() will skip madvise if slab was ever published lock-free. */
-      for (size_t j = 0; j < idx; j++) {
-        cache_push(sc, empty_slabs[j]);
-      }
-      
-      /* Clean up heap allocation if we used it */
-      if (empty_slabs != stack_buf) {
-        free(empty_slabs);
       }
+
+      /* Publish the table, then unpublish the slab: a handle that stops
+       * validating finds the forward already in place. The ID now belongs
+       * to the table; the slab leaves without it and, holding nothing,
+       * returns its pages on the way into the cache. */
+      SlabMeta* meta = reg_meta(&a->reg, s->slab_id);
+      forward_link(es, f);
+      atomic_store_explicit(&meta->fwd, f, memory_order_release);
+      atomic_store_explicit(&meta->ptr, NULL, memory_order_release);
+      s->slab_id = REG_ID_NONE;
+      s->was_published = false;
+
+      st->objects_moved += f->live;
+      st->forward_tables++;
+    }
+    s->list_id = SLAB_LIST_NONE;
+    out[nout++] = s;
+  }
+
+  for (size_t i = m; i < n; i++) {
+    s = v[i].slab;
+    uint32_t fc = atomic_load_explicit(&s->free_count, memory_order_relaxed);
+    if (fc == 0) {
+      s->list_id = SLAB_LIST_FULL;
+      list_push_back(&es->full, s);
+    } else if (fc == s->object_count) {
+      /* Slots were cleared above, so nothing publishes it */
+      s->list_id = SLAB_LIST_EMPTY;
+      list_push_back(&es->empty, s);
+      atomic_fetch_add_explicit(&es->empty_partial_count, 1, memory_order_relaxed);
     } else {
-      /* No empty slabs found, just release lock */
-      UNLOCK_WITH_RANK(&sc->lock);
+      s->list_id = SLAB_LIST_PARTIAL;
+      list_push_back(&es->partial, s);
     }
   }
-  
-  /* Phase 3: Measure reclamation impact.
-   *
-   * Capture RSS after recycling to quantify how much memory was returned.
-   * Delta (rss_before - rss_after) shows effectiveness of epoch_close.
-   * Applications can export this to track memory efficiency. */
-  uint64_t rss_after = read_rss_bytes_linux();
-  a->epoch_meta[epoch].rss_after_close = rss_after;
-  
-  /* Capture end time and update latency telemetry.
-   * Helps capacity planning: "How long does epoch_close take?" */
-  struct timespec end_ts;
-  clock_gettime(CLOCK_MONOTONIC, &end_ts);
-  uint64_t end_ns = (uint64_t)end_ts.tv_sec * 1000000000ULL + (uint64_t)end_ts.tv_nsec;
-  uint64_t elapsed_ns = end_ns - start_ns;
-  
-  /* Update per-class counters (aggregate, not per-epoch).
-   * Same elapsed_ns added to all size classes—represents total epoch_close cost. */
-  for (size_t i = 0; i < k_num_classes; i++) {
-    atomic_fetch_add_explicit(&a->classes[i].epoch_close_calls, 1, memory_order_relaxed);
-    atomic_fetch_add_explicit(&a->classes[i].epoch_close_total_ns, elapsed_ns, memory_order_relaxed);
+  sc->total_slabs -= nout;
+  UNLOCK_WITH_RANK(&sc->lock);
+
+  cache_push_batch(sc, out, nout);
+
+  st->slabs_scanned += (uint32_t)n;
+  st->slabs_released += (uint32_t)nout;
+  st->bytes_released += (uint64_t)nout * sc->slab_bytes;
+  free(v);
+  free(out);
+  return (uint32_t)nout;
+}
+
+uint32_t slab_compact_epoch(SlabAllocator* a, EpochId epoch_id, SlabCompactStats* out_stats) {
+  SlabCompactStats st = {0};
+  if (out_stats) *out_stats = st;
+  if (!a) {
+    errno = EINVAL;
+    return 0;
   }
-  
-  /* Epoch now fully closed and drained.
-   *
-   * Future frees into this epoch:
-   * - Continue normally (bitmap clear, free_count increment)
-   * - Empty slabs recycled immediately (CLOSING triggers aggressive recycling)
-   *
-   * Future allocations into this epoch:
-   * - Rejected (alloc_obj_epoch checks CLOSING state)
-   *
-   * Expected RSS behavior with ENABLE_RSS_RECLAMATION=1:
-   * - RSS drops immediately after epoch_close returns
-   * - Delta visible in rss_before_close - rss_after_close
-   * - Physical pages returned to kernel, available for other processes */
+  uint32_t epoch = epoch_slot(a, epoch_id);
+  if (epoch == EPOCH_SLOT_NONE) {
+    errno = EINVAL;
+    return 0;
+  }
+  if (a->header_free) {
+    errno = ENOTSUP;  /* Callers hold raw pointers, nothing could follow a move */
+    return 0;
+  }
+  if (atomic_load_explicit(&a->epoch_state[epoch], memory_order_acquire) != EPOCH_CLOSING) {
+    errno = EBUSY;
+    return 0;
+  }
+
+  uint32_t released = 0;
+  for (uint32_t i = 0; i < a->num_classes; i++) {
+    released += compact_class(a, epoch, i, &st);
+  }
+  if (out_stats) *out_stats = st;
+  return released;
+}
+
+/* Hop limit: an object moves once per compaction of its epoch */
+#define SLAB_FORWARD_MAX_HOPS 64u
+
+void* slab_handle_deref(SlabAllocator* a, SlabHandle h) {
+  if (!a) return NULL;
+  for (uint32_t hop = 0; hop < SLAB_FORWARD_MAX_HOPS && h != 0; hop++) {
+    uint32_t slab_id, gen, slot, size_class;
+    handle_decode(&a->reg, h, &slab_id, &gen, &slot, &size_class);
+    if (slab_id == UINT32_MAX || size_class >= a->num_classes) return NULL;
+
+    Slab* s = reg_lookup_validate(&a->reg, slab_id, gen);
+    if (s) {
+      if (atomic_load_explicit(&s->magic, memory_order_relaxed) != SLAB_MAGIC) return NULL;
+      if (slot >= s->object_count) return NULL;
+      _Atomic uint32_t* bm = slab_bitmap_ptr(s);
+      if ((atomic_load_explicit(&bm[slot / 32u], memory_order_relaxed) & (1u << (slot % 32u))) == 0u) {
+        return NULL;  /* Freed */
+      }
+      return slab_slot_ptr(s, slot);
+    }
+    h = forward_peek(&a->reg, slab_id, gen, slot);
+  }
+  return NULL;
 }
 
 /* ------------------------------ Phase 2.3: Semantic Attribution APIs ------------------------------ */
 
-void slab_epoch_set_label(SlabAllocator* a, EpochId epoch, const char* label) {
-  if (!a || epoch >= a->epoch_count || !label) return;
-  
-  EpochMetadata* meta = &a->epoch_meta[epoch];
-  
-  /* Phase 2.3: Assign or reuse label ID (bounded cardinality) */
-  LOCK_WITHOUT_PROBE(&a->label_registry.lock, LOCK_RANK_LABEL_REGISTRY, "label_registry.lock");
-  
-  uint8_t label_id = 0;  /* Default: unlabeled */
+/* Label ID for a string: 0 for "(unlabeled)", an existing ID, or (create)
+ * a new one while IDs remain. -1 if absent / registry full.
+ * Caller holds label_registry.lock. */
+static int label_lookup_locked(SlabAllocator* a, const char* label, bool create) {
+  if (strncmp(a->label_registry.labels[0], label, 31) == 0) return 0;
   
   /* Search for existing label (reuse ID) */
   for (uint8_t i = 1; i < a->label_registry.count; i++) {
-    if (strncmp(a->label_registry.labels[i], label, 31) == 0) {
-      label_id = i;
-      break;
-    }
+    if (strncmp(a->label_registry.labels[i], label, 31) == 0) return i;
   }
   
   /* If not found and space available, allocate new ID */
-  if (label_id == 0 && a->label_registry.count < MAX_LABEL_IDS) {
-    label_id = a->label_registry.count++;
-    strncpy(a->label_registry.labels[label_id], label, 31);
-    a->label_registry.labels[label_id][31] = '\0';
-  }
+  if (!create || a->label_registry.count >= MAX_LABEL_IDS) return -1;
+  uint8_t id = a->label_registry.count++;
+  strncpy(a->label_registry.labels[id], label, 31);
+  a->label_registry.labels[id][31] = '\0';
+  return id;
+}
+
+void slab_epoch_set_label(SlabAllocator* a, EpochId epoch_id, const char* label) {
+  if (!a || !label) return;
+  uint32_t epoch = epoch_slot(a, epoch_id);
+  if (epoch == EPOCH_SLOT_NONE) return;
   
-  /* If registry full, label_id remains 0 (unlabeled / other bucket) */
+  EpochMetadata* meta = &a->epoch_meta[epoch];
   
+  /* Phase 2.3: Assign or reuse label ID (bounded cardinality) */
+  LOCK_WITHOUT_PROBE(&a->label_registry.lock, LOCK_RANK_LABEL_REGISTRY, "label_registry.lock");
+  int found = label_lookup_locked(a, label, true);
   UNLOCK_WITH_RANK(&a->label_registry.lock);
   
+  /* If registry full, label_id remains 0 (unlabeled / other bucket) */
+  uint8_t label_id = found < 0 ? 0 : (uint8_t)found;
+  
   /* Update epoch metadata (no lock needed, rarely written) */
   LOCK_WITHOUT_PROBE(&a->epoch_label_lock, LOCK_RANK_EPOCH_LABEL, "epoch_label_lock");
   strncpy(meta->label, label, sizeof(meta->label) - 1);
@@ -2484,14 +6341,48 @@ void slab_epoch_set_label(SlabAllocator* a, EpochId epoch, const char* label) {
   UNLOCK_WITH_RANK(&a->epoch_label_lock);
 }
 
-void slab_epoch_inc_refcount(SlabAllocator* a, EpochId epoch) {
-  if (!a || epoch >= a->epoch_count) return;
+bool slab_label_set_quota(SlabAllocator* a, const char* label, uint64_t bytes,
+                          SlabQuotaCallback cb, void* arg) {
+  if (!a || !label) {
+    errno = EINVAL;
+    return false;
+  }
+  LOCK_WITHOUT_PROBE(&a->label_registry.lock, LOCK_RANK_LABEL_REGISTRY, "label_registry.lock");
+  int lid = label_lookup_locked(a, label, true);
+  if (lid >= 0) {
+    LabelQuota* q = &a->label_quota[lid];
+    q->cb = cb;
+    q->cb_arg = arg;
+    atomic_store_explicit(&q->quota, bytes, memory_order_relaxed);
+  }
+  UNLOCK_WITH_RANK(&a->label_registry.lock);
+  if (lid < 0) {
+    errno = ENOSPC;
+    return false;
+  }
+  return true;
+}
+
+uint64_t slab_label_committed(SlabAllocator* a, const char* label) {
+  if (!a || !label) return 0;
+  LOCK_WITHOUT_PROBE(&a->label_registry.lock, LOCK_RANK_LABEL_REGISTRY, "label_registry.lock");
+  int lid = label_lookup_locked(a, label, false);
+  UNLOCK_WITH_RANK(&a->label_registry.lock);
+  return lid < 0 ? 0 : atomic_load_explicit(&a->label_quota[lid].committed, memory_order_relaxed);
+}
+
+void slab_epoch_inc_refcount(SlabAllocator* a, EpochId epoch_id) {
+  if (!a) return;
+  uint32_t epoch = epoch_slot(a, epoch_id);
+  if (epoch == EPOCH_SLOT_NONE) return;
   
   atomic_fetch_add_explicit(&a->epoch_meta[epoch].domain_refcount, 1, memory_order_relaxed);
 }
 
-void slab_epoch_dec_refcount(SlabAllocator* a, EpochId epoch) {
-  if (!a || epoch >= a->epoch_count) return;
+void slab_epoch_dec_refcount(SlabAllocator* a, EpochId epoch_id) {
+  if (!a) return;
+  uint32_t epoch = epoch_slot(a, epoch_id);
+  if (epoch == EPOCH_SLOT_NONE) return;
   
   /* Atomic decrement with saturation at 0 (prevent underflow) */
   uint64_t prev = atomic_load_explicit(&a->epoch_meta[epoch].domain_refcount, memory_order_relaxed);
@@ -2505,8 +6396,10 @@ void slab_epoch_dec_refcount(SlabAllocator* a, EpochId epoch) {
   }
 }
 
-uint64_t slab_epoch_get_refcount(SlabAllocator* a, EpochId epoch) {
-  if (!a || epoch >= a->epoch_count) return 0;
+uint64_t slab_epoch_get_refcount(SlabAllocator* a, EpochId epoch_id) {
+  if (!a) return 0;
+  uint32_t epoch = epoch_slot(a, epoch_id);
+  if (epoch == EPOCH_SLOT_NONE) return 0;
   
   return atomic_load_explicit(&a->epoch_meta[epoch].domain_refcount, memory_order_relaxed);
 }
@@ -7,6 +7,7 @@
  */
 
 #include <slab_alloc.h>
+#include <slab_trace.h>  /* SlabTraceRecord, SlabTraceHeader */
 #include <stdatomic.h>
 #include <pthread.h>
 #include <stdint.h>
@@ -20,15 +21,132 @@
 
 /* Internal configuration */
 #ifndef SLAB_PAGE_SIZE
-#define SLAB_PAGE_SIZE 4096u  /* Matches x86-64 Linux page size. Must be power of 2
+#define SLAB_PAGE_SIZE 4096u  /* Base slab size, not the OS page size. Must be power of 2
                                 * for fast address arithmetic (ptr & ~(PAGE_SIZE-1)).
-                                * Larger pages (64KB on some ARM) increase RSS granularity. */
+                                * On 16KB/64KB-page kernels slabs share an OS page and
+                                * pages are returned per SizeClassAlloc.release_bytes. */
 #endif
 
 /* Compile-time assertion that SLAB_PAGE_SIZE is power of 2 */
 _Static_assert((SLAB_PAGE_SIZE & (SLAB_PAGE_SIZE - 1)) == 0, 
                "SLAB_PAGE_SIZE must be power of 2 for fast address masking");
 
+/* Arena reservation size (per size class, per region)
+ *
+ * Slabs are carved out of large contiguous virtual reservations instead of
+ * one mmap() per slab. A 2MB arena holds 512 4KB slabs, so a cache miss costs
+ * a pointer bump under arena_lock and only every 512th miss costs a syscall.
+ *
+ * Reservations use MAP_NORESERVE and are aligned to SLAB_ARENA_SIZE. Pages are
+ * committed by the kernel on first touch, so an arena that is mostly uncarved
+ * costs address space, not RSS.
+ *
+ * Usage:
+ *   make CFLAGS="$(CFLAGS) -DSLAB_ARENA_SIZE=8388608"  # 8MB regions
+ */
+#ifndef SLAB_ARENA_SIZE
+#define SLAB_ARENA_SIZE (2u * 1024u * 1024u)  /* 2MB: matches x86-64 huge page size */
+#endif
+
+_Static_assert((SLAB_ARENA_SIZE & (SLAB_ARENA_SIZE - 1)) == 0,
+               "SLAB_ARENA_SIZE must be power of 2 for aligned reservation");
+_Static_assert(SLAB_ARENA_SIZE >= SLAB_PAGE_SIZE,
+               "SLAB_ARENA_SIZE must hold at least one slab");
+
+/* Arena ownership map (slab_owns)
+ *
+ * One bit per SLAB_ARENA_SIZE-aligned region of a 48-bit address space, set
+ * when this allocator reserves the region. Two-level: a top table of
+ * ARENA_MAP_TOP leaf pointers, each leaf a bitmap of 2^ARENA_MAP_LEAF_BITS
+ * regions (4KB, covering 64GB at 2MB arenas). Both levels are allocated on
+ * first use and only ever filled in, so lookups are two acquire loads.
+ */
+#define ARENA_MAP_VA_BITS   48u
+#define ARENA_MAP_LEAF_BITS 15u
+#define ARENA_MAP_SHIFT     ((uint32_t)__builtin_ctz(SLAB_ARENA_SIZE))
+#define ARENA_MAP_TOP       (1u << (ARENA_MAP_VA_BITS - ARENA_MAP_SHIFT - ARENA_MAP_LEAF_BITS))
+
+/* NUMA node-local slab pools
+ *
+ * Each size class keeps one slab pool (slab cache + arena list) per NUMA
+ * node. Fresh slabs are carved from arenas bound to the caller's node, and
+ * recycled slabs return to the pool of the node that backs their memory, so
+ * cache_pop() hands a thread slabs that live on its own socket. The slow path
+ * also prefers partial slabs on the caller's node.
+ *
+ * ENABLE_NUMA_BIND applies mbind(MPOL_PREFERRED) to each arena so first
+ * touch lands on the pool's node even if another CPU faults the page in.
+ * No libnuma dependency: raw syscall, failures are counted and ignored.
+ *
+ * SLAB_NUMA_STRICT=1 carves a local slab before taking one from another
+ * node's pool (lower latency, more RSS). Default reuses remote cached slabs
+ * first (counted as remote pops in stats).
+ *
+ * Single-node machines (or non-Linux) use pool 0 only: no behavior change.
+ *
+ * Usage:
+ *   make CFLAGS="$(CFLAGS) -DENABLE_NUMA_BIND=0"   # rely on first-touch only
+ *   make CFLAGS="$(CFLAGS) -DSLAB_NUMA_STRICT=1"   # never reuse remote slabs first
+ */
+#ifndef ENABLE_NUMA_BIND
+#define ENABLE_NUMA_BIND 1
+#endif
+
+#ifndef SLAB_NUMA_STRICT
+#define SLAB_NUMA_STRICT 0
+#endif
+
+/* Bitmap scan kernel
+ *
+ * Slot indices are 8 bits (handle v2), so a slab bitmap is at most 8 words
+ * and slab_bitmap_bytes() pads it to whole 16-byte vectors. Allocation
+ * first builds a mask of the words that still have a free bit - one
+ * compare of the whole bitmap against all-ones (SSE2, AVX2 when built with
+ * -mavx2, NEON on arm64) - then picks a word with ctz instead of loading
+ * and testing full words one by one. The mask is a hint: the chosen word
+ * is still claimed with an atomic CAS.
+ *
+ * SLAB_SIMD_SCAN=0 selects the portable scalar loop (also forced under
+ * ThreadSanitizer, which would flag the plain vector loads).
+ *
+ * Usage:
+ *   make CFLAGS="$(CFLAGS) -DSLAB_SIMD_SCAN=0"   # scalar word scan only
+ */
+#ifndef SLAB_SIMD_SCAN
+#if defined(__SANITIZE_THREAD__)
+#define SLAB_SIMD_SCAN 0
+#else
+#define SLAB_SIMD_SCAN 1
+#endif
+#endif
+
+#define SLAB_BITMAP_MAX_WORDS ((1u << HANDLE_SLOT_BITS) / 32u)
+
+/* Per-CPU fast-path slots
+ * 
+ * SLAB_PERCPU_SLOTS sets how many current_partial pointers each EpochState
+ * carries. Threads index the array by CPU id (glibc rseq area on Linux,
+ * sched_getcpu() fallback, per-thread round robin elsewhere) modulo the slot
+ * count, and the slow path prefers a partial slab no other slot is using.
+ * Concurrent allocators on different CPUs therefore CAS different slabs'
+ * bitmap words and free_count instead of one shared cache line.
+ * 
+ * Cost: up to SLAB_PERCPU_SLOTS partially filled slabs per (class, epoch)
+ * instead of one. SLAB_PERCPU_SLOTS=1 restores the single shared pointer.
+ * 
+ * Usage:
+ *   make CFLAGS="$(CFLAGS) -DSLAB_PERCPU_SLOTS=64"  # many-core hosts
+ */
+#ifndef SLAB_PERCPU_SLOTS
+#define SLAB_PERCPU_SLOTS 16u
+#endif
+
+_Static_assert(SLAB_PERCPU_SLOTS > 0 && (SLAB_PERCPU_SLOTS & (SLAB_PERCPU_SLOTS - 1)) == 0,
+               "SLAB_PERCPU_SLOTS must be a power of 2");
+
+/* Alignment used to keep independently written fields off each other's lines */
+#define SLAB_CACHE_LINE 64u
+
 /* Diagnostic instrumentation (compile-time optional)
  * 
  * ENABLE_DIAGNOSTIC_COUNTERS adds live_bytes/committed_bytes tracking for proving
@@ -106,6 +224,26 @@ void slowpath_timing_end(SlabAllocator* a, uint64_t wall_start, uint64_t cpu_sta
 void slowpath_print_samples(SlabAllocator* a);
 #endif
 
+/* Latency histograms (compile-time optional)
+ *
+ * ENABLE_LATENCY_HIST records per-operation latencies into log-bucketed
+ * histograms (see SlabLatencyHist): alloc fast path, alloc slow path, free,
+ * new_slab() and epoch_close(). Merged on read by slab_stats_global().
+ *
+ * Alloc and free are timed 1 in 2^SLAB_LAT_SAMPLE_SHIFT calls (two
+ * clock_gettime vDSO calls per sample); new_slab and epoch_close always.
+ *
+ * Usage:
+ *   make CFLAGS="$(CFLAGS) -DENABLE_LATENCY_HIST=1 -DSLAB_LAT_SAMPLE_SHIFT=0"
+ */
+#ifndef ENABLE_LATENCY_HIST
+#define ENABLE_LATENCY_HIST 0  /* Default: disabled */
+#endif
+
+#ifndef SLAB_LAT_SAMPLE_SHIFT
+#define SLAB_LAT_SAMPLE_SHIFT 4u  /* Time 1 in 16 allocs/frees */
+#endif
+
 /* Thread-local handle cache (compile-time optional)
  * 
  * ENABLE_TLS_CACHE adds per-thread handle caches to eliminate atomic operations
@@ -128,6 +266,19 @@ void slowpath_print_samples(SlabAllocator* a);
 #define ENABLE_TLS_CACHE 0  /* Default: disabled (opt-in performance feature) */
 #endif
 
+/* Allocation trace hooks (see slab_trace.h)
+ *
+ * Tracing is switched on at runtime with slab_trace_start(). With the hooks
+ * compiled in, an untraced allocator pays one relaxed load per alloc/free.
+ * ENABLE_ALLOC_TRACE=0 removes them (slab_trace_start fails with ENOTSUP).
+ *
+ * Usage:
+ *   make CFLAGS="-DENABLE_ALLOC_TRACE=0"  # No trace hooks at all
+ */
+#ifndef ENABLE_ALLOC_TRACE
+#define ENABLE_ALLOC_TRACE 1  /* Default: compiled in, off until started */
+#endif
+
 /* Lock rank debugging (compile-time optional)
  * 
  * ENABLE_LOCK_RANK_DEBUG adds assertions to detect lock order inversions.
@@ -147,7 +298,8 @@ void slowpath_print_samples(SlabAllocator* a);
 #if ENABLE_LOCK_RANK_DEBUG
 /* Lock ranks - must be acquired in strictly increasing order */
 #define LOCK_RANK_REGISTRY       10  /* SlabRegistry lock (rare) */
-#define LOCK_RANK_CACHE          20  /* sc->cache_lock (slab cache) */
+#define LOCK_RANK_CACHE          20  /* Unused: slab cache is lock-free (rank kept for numbering) */
+#define LOCK_RANK_ARENA          25  /* sc->arena_lock (arena carving) */
 #define LOCK_RANK_SIZE_CLASS     30  /* sc->lock (per-size-class) */
 #define LOCK_RANK_EPOCH_LABEL    40  /* epoch_label_lock (epoch metadata) */
 #define LOCK_RANK_LABEL_REGISTRY 50  /* label_registry.lock (label mapping) */
@@ -207,18 +359,23 @@ extern _Thread_local int _lock_rank_depth;
 #endif
 
 #define SLAB_MAGIC   0x534C4142u /* "SLAB" in ASCII, used to detect corruption */
-#define SLAB_VERSION 1u          /* Handle format version for future compatibility */
+#define SLAB_VERSION 2u          /* Handle format version for future compatibility */
+
+/* Handle v2 field widths (see handle_pack() in slab_alloc.c).
+ * slab_id bounds the registry; the directory below is sized from it. */
+#define HANDLE_SLAB_ID_BITS 25u  /* 32M slabs per allocator (128GB of 4KB slabs) */
+#define HANDLE_GEN_BITS     24u  /* ABA budget: 16M reuses per slab_id */
+#define HANDLE_SLOT_BITS    8u   /* Max 255 objects per slab */
+#define HANDLE_CLASS_BITS   5u   /* SLAB_MAX_CLASSES size classes */
 
 /* Thread-local handle cache structures */
 #if ENABLE_TLS_CACHE
 
 /* TLS cache tuning parameters */
-#define TLS_CACHE_CAP 256        /* Total capacity per size class */
-#define TLS_REFILL_BATCH 32      /* Handles to allocate when cache empty */
-#define TLS_FLUSH_HI 256         /* Trigger flush when count reaches this */
-#define TLS_FLUSH_LO 192         /* Flush down to this watermark */
-#define TLS_FLUSH_DRIBBLE 4      /* Handles to flush per dribble (spreads cost) */
-#define MAX_THREADS 128          /* Maximum threads for registry */
+#define TLS_EPOCH_BINS 4         /* Bins per size class, each holding one (allocator, epoch) */
+#define TLS_BIN_CAP 64           /* Handles per bin */
+#define TLS_REFILL_BATCH 32      /* Handles to allocate when a bin is empty */
+#define TLS_REFILL_BYTES 16384   /* ...but no more object bytes than this, nor one slab's worth */
 #define TLS_DEBUG_VALIDATE 1     /* Enable validation tripwire on cache hits */
 
 /* Adaptive bypass parameters (shortened for fast response to phasey workloads) */
@@ -226,17 +383,31 @@ extern _Thread_local int _lock_rank_depth;
 #define TLS_BYPASS_OPS 8192      /* Disable TLS for N ops when hit rate too low (was 65536) */
 #define TLS_MIN_HIT_PCT 2        /* Minimum hit rate % to keep TLS enabled */
 
-/* TLS cache item: stores handle, pointer, and epoch for validation */
+/* TLS cache item: handle plus pre-validated pointer (epoch is the bin's) */
 typedef struct {
     SlabHandle h;      /* Handle for free_obj */
     void* p;           /* Pre-validated pointer for immediate return */
-    uint32_t epoch_id; /* Epoch this handle was allocated from (for staleness check) */
-    uint32_t padding;  /* Align to 24 bytes */
 } TLSItem;
 
+/* Epoch-partitioned bin: every cached handle of one (allocator, epoch).
+ *
+ * Flushing an epoch drops whole bins in one free_obj_batch() instead of
+ * filtering a mixed stack. flush_gen snapshots alloc->tls_flush_gen[epoch]
+ * at refill; a mismatch means the epoch was closed (or bulk-released) since,
+ * so the bin is stale and must not serve allocations. alloc_instance guards
+ * against a destroyed allocator whose address was reused. */
+typedef struct {
+    SlabAllocator* alloc;     /* Owner allocator (NULL = unused bin) */
+    uint64_t alloc_instance;  /* alloc->tls_instance at refill */
+    uint32_t epoch_id;
+    uint32_t flush_gen;
+    uint32_t count;           /* Stack depth [0, TLS_BIN_CAP] */
+    uint32_t last_use;        /* window_ops stamp of last hit/refill (eviction order) */
+    TLSItem items[TLS_BIN_CAP];
+} TLSBin;
+
 typedef struct {
-    TLSItem items[TLS_CACHE_CAP];  /* Handle+pointer stack */
-    uint32_t count;                 /* Current stack depth [0, TLS_CACHE_CAP] */
+    TLSBin bins[TLS_EPOCH_BINS];
     
     /* Adaptive bypass (alloc only - free caching disabled) */
     uint32_t window_ops;            /* Ops in current measurement window */
@@ -252,45 +423,64 @@ typedef struct {
     uint32_t tls_alloc_refills;     /* Cache refill operations */
     uint32_t tls_popped;            /* Entries consumed (one-shot invariant) */
     uint32_t tls_refilled_added;    /* Entries added via refill */
-    uint32_t tls_epoch_rejects;     /* Cached entries rejected (stale epoch) */
-    uint32_t padding_stats[1];      /* Reserved */
+    uint32_t tls_epoch_rejects;     /* Bins dropped because their epoch was flushed */
+    uint32_t tls_bin_evictions;     /* Live bins evicted to make room for another epoch */
 } TLSCache;
 
-typedef struct {
+/* Per-thread cache record, heap-allocated on the thread's first TLS alloc.
+ *
+ * Linked into the global registry so tls_print_stats() and allocator
+ * teardown can find it; unlinked (and its bins flushed) by a pthread key
+ * destructor when the thread exits, so the registry tracks live threads
+ * only and has no fixed capacity. Only the owning thread touches caches[]. */
+typedef struct TLSThread {
+    TLSCache caches[SLAB_MAX_CLASSES];
+    uint64_t flush_seen;            /* _tls_flush_seq last acted on */
     pthread_t tid;
-    TLSCache* caches;  /* Pointer to thread's TLS cache array [8] */
-} ThreadRegistryEntry;
-
-/* Thread-local cache (one per size class) */
-extern __thread TLSCache _tls_cache[8];
-extern __thread bool _tls_initialized;
-
-/* Global thread registry for epoch_close() flush */
-extern ThreadRegistryEntry _thread_registry[MAX_THREADS];
+    struct TLSThread* prev;
+    struct TLSThread* next;
+} TLSThread;
+
+/* Calling thread's record (NULL until first use, and again after exit) */
+extern __thread TLSThread* _tls_self;
+
+/* Flush-request sequence: bumped by every epoch flush request. An owner that
+ * sees a value other than its flush_seen sweeps its own stale bins at its
+ * next alloc. Closers never touch another thread's bins. */
+extern _Atomic uint64_t _tls_flush_seq;
+
+/* Global thread registry (doubly linked, growable). Its rwlock lives in
+ * slab_tls_cache.c: write-locked to link/unlink threads and allocators,
+ * read-locked while an owner sweeps bins (so their allocators cannot be
+ * destroyed meanwhile). */
+extern TLSThread* _thread_registry;
 extern uint32_t _thread_count;
-extern pthread_mutex_t _thread_registry_lock;
 
 /* TLS cache operations */
 void tls_init_thread(void);
 void* tls_try_alloc(SlabAllocator* a, uint32_t sc, uint32_t epoch_id, SlabHandle* out_h);
 bool tls_try_free(SlabAllocator* a, uint32_t sc, SlabHandle h);
-void tls_refill(SlabAllocator* a, uint32_t sc, uint32_t epoch_id);
-void tls_flush_batch(SlabAllocator* a, uint32_t sc, uint32_t batch_size);
-void tls_flush_epoch_all_threads(SlabAllocator* a, uint32_t epoch_id);
+bool tls_refill(SlabAllocator* a, uint32_t sc, uint32_t epoch_id);
+void tls_request_epoch_flush(SlabAllocator* a, uint32_t epoch_id);  /* O(1), any thread */
+void tls_allocator_register(SlabAllocator* a);    /* allocator_init */
+void tls_allocator_unregister(SlabAllocator* a);  /* allocator_destroy */
 void tls_print_stats(void);  /* Print aggregate stats across all threads */
 
 #endif /* ENABLE_TLS_CACHE */
 
 /* Epoch configuration */
-#define EPOCH_COUNT 16u  /* Ring buffer size. Power of 2 enables fast modulo via bitwise AND.
-                          * 16 epochs provides ~16s drain window if epochs rotate every ~1s.
-                          * Too small risks premature wraparound; too large holds memory longer. */
+#define EPOCH_COUNT SLAB_DEFAULT_EPOCHS  /* Default ring size (SlabAllocatorConfig.epoch_count).
+                                       * 16 epochs provides ~16s drain window if epochs rotate every ~1s.
+                                       * Too small risks premature wraparound; too large holds memory longer. */
+#define EPOCH_SLOT_NONE UINT32_MAX     /* epoch_slot(): out of range or stale */
 
-/* Slab list membership (partial/full lists, protected by sc->lock)
+/* Slab list membership (partial/full/empty lists, protected by sc->lock)
  *
- * Slabs move between two lists based on free slot availability:
+ * Slabs move between three lists based on free slot availability:
  * - PARTIAL: Has free slots, actively used for allocations
  * - FULL: No free slots, parked until something is freed
+ * - EMPTY: Every slot free and no current_partial slot publishes it;
+ *   reused before a new slab, recycled by epoch_close()
  *
  * Conservative recycling safety: Only FULL slabs are recycled when empty.
  * PARTIAL slabs may be held by threads via the lock-free current_partial
@@ -300,13 +490,14 @@ typedef enum SlabListId {
   SLAB_LIST_PARTIAL = 0,  /* Has free slots, may be visible to lock-free path */
   SLAB_LIST_FULL    = 1,  /* No free slots, never published (safe to recycle) */
   SLAB_LIST_NONE    = 2,  /* Not on any list (in cache or being destroyed) */
+  SLAB_LIST_EMPTY   = 3,  /* All slots free, unpublished (close recycles these) */
 } SlabListId;
 
-/* Slab cache state (lifecycle, protected by cache_lock or sc->lock) */
+/* Slab cache state (lifecycle, written by the slab's current owner) */
 typedef enum SlabCacheState {
   SLAB_ACTIVE      = 0,  /* In use (on partial/full list) */
-  SLAB_CACHED      = 1,  /* In slab_cache array */
-  SLAB_OVERFLOWED  = 2,  /* In cache_overflow list */
+  SLAB_CACHED      = 1,  /* In cache stack, within cache_capacity */
+  SLAB_OVERFLOWED  = 2,  /* In cache stack, beyond cache_capacity */
 } SlabCacheState;
 
 /* Forward declarations */
@@ -316,6 +507,7 @@ typedef struct SizeClassAlloc SizeClassAlloc;
 typedef struct SlabRegistry SlabRegistry;
 typedef struct SlabMeta SlabMeta;
 typedef struct CachedSlab CachedSlab;
+typedef struct SlabArena SlabArena;
 
 /* Internal slab structure stored at the start of each page.
  *
@@ -341,18 +533,38 @@ struct Slab {
    * Atomic because lock-free path reads it and concurrent frees update it. */
   _Atomic uint32_t free_count;
 
-  /* Current list membership (PARTIAL/FULL/NONE).
-   * Tracked for safety: prevents double-insert, enables clean removal. */
-  SlabListId list_id;
+  /* Current list membership (SlabListId: PARTIAL/FULL/NONE/EMPTY).
+   * Tracked for safety: prevents double-insert, enables clean removal.
+   * Stored as uint8_t so bump_next fits without growing the header. */
+  uint8_t list_id;
   
-  /* Cache lifecycle state (ACTIVE/CACHED/OVERFLOWED).
+  /* Cache lifecycle state (SlabCacheState: ACTIVE/CACHED/OVERFLOWED).
    * Prevents recycling slabs that are still in active use. */
-  SlabCacheState cache_state;
+  uint8_t cache_state;
+  
+  /* Label charged for this slab's bytes in new_slab() (label_id + 1, 0 =
+   * uncharged, e.g. slab_reserve). Credited back when the slab is cached.
+   * Fits in padding. */
+  uint8_t quota_label;
   
   /* Epoch this slab belongs to. Objects with similar lifetimes get grouped
    * in the same epoch's slabs so they can drain together without fragmentation. */
   uint32_t epoch_id;
   
+  /* Remote-free stack (SlabAllocatorConfig.remote_free): slot index + 1 of
+   * the most recent deferred free, 0 = empty. Each freed object's first 4
+   * bytes link to the next. Many pushers, drained all at once by exchange,
+   * so no ABA tag is needed. Occupies what was padding before `era`. */
+  _Atomic uint32_t remote_head;
+  
+  /* Bump reserve of a fresh slab: slots [bump_next, object_count) have not
+   * been handed out yet. new_slab() sets every bitmap bit and free_count = 0,
+   * so the reserve looks allocated to the bitmap code and a fresh-slab
+   * allocation is a single fetch_add here. The first free retires the
+   * reserve (SLAB_BUMP_RETIRED, bits cleared, free_count += reserve);
+   * any value >= object_count means plain bitmap mode. */
+  _Atomic uint32_t bump_next;
+  
   /* Monotonic era counter stamped when slab was created.
    * Helps distinguish "epoch 5 at era 100" from "epoch 5 at era 105" after wraparound.
    * Useful for correlating allocator state with application logs. */
@@ -363,12 +575,25 @@ struct Slab {
    * If false, safe to madvise (never accessible lock-free). */
   bool was_published;
   
+  /* NUMA node whose pool/arena backs this slab (fits in existing padding,
+   * header stays 64 bytes). Restored from the pool index after madvise. */
+  uint8_t numa_node;
+  
+  /* Ordinal of the arena this slab was carved from within its node pool.
+   * Locates the slab's off-page cache node on push (also fits in padding). */
+  uint16_t arena_ord;
+  
   /* Registry ID for portable handle encoding.
    * Handles store this ID instead of raw pointers, enabling validation
    * and ABA protection via generation counters. */
   uint32_t slab_id;
 };
 
+_Static_assert(sizeof(struct Slab) <= 64, "slab header must stay within one 64-byte line");
+
+/* Slab.bump_next flag: reserve handed back to the bitmap (see slab_bump_retire()) */
+#define SLAB_BUMP_RETIRED 0x80000000u
+
 /* Slab registry metadata stored off-page.
  *
  * Generation counter provides ABA protection: if a handle references slab_id=42
@@ -378,50 +603,162 @@ struct Slab {
 struct SlabMeta {
   _Atomic(Slab*) ptr;        /* Pointer to slab, NULL if recycled or unmapped */
   _Atomic uint32_t gen;      /* Generation counter, incremented on each reuse */
+  uint32_t next_free;        /* Free-ID list link (registry lock), REG_ID_NONE = end */
+  _Atomic(struct SlabForward*) fwd;  /* Set while the ID's slab is evacuated (ptr NULL) */
 };
 
+/* Forwarding table of a slab evacuated by slab_compact_epoch().
+ *
+ * The evacuated slab's registry ID stays reserved (ptr NULL, generation
+ * unchanged) and SlabMeta.fwd points here, so handles minted from it keep
+ * resolving: to[slot] is the handle of the slot's object in its new slab,
+ * 0 once that object is freed. When live drops to zero the table is
+ * retired and the ID goes back to the registry free list.
+ *
+ * Tables are type-stable: retired ones park on their class's forward_free
+ * list and are only freed by allocator_destroy(), so a lock-free
+ * slab_handle_deref() that loses a race reads a stale table, never freed
+ * memory. Fields other than to[] are protected by the class's sc->lock.
+ */
+typedef struct SlabForward {
+  struct SlabForward* next;  /* Epoch forwards list / class free list */
+  struct SlabForward* prev;
+  uint32_t slab_id;          /* Registry ID being forwarded */
+  uint32_t epoch;            /* Epoch slot (forwards list owner) */
+  uint32_t size_class;
+  uint32_t live;             /* Entries of to[] still non-zero */
+  uint32_t slots;            /* Capacity of to[] (class object_count) */
+  _Atomic SlabHandle to[];   /* Per source slot: new handle, 0 = none */
+} SlabForward;
+
+/* Registry segments: segment k holds REG_SEG_BASE << k entries, so the
+ * directory covers [0, REG_SEG_BASE * (2^REG_SEGMENTS - 1)) ids, which is
+ * at least the 2^HANDLE_SLAB_ID_BITS ids a handle can name. */
+#define REG_SEG_BASE_SHIFT 10u
+#define REG_SEG_BASE       (1u << REG_SEG_BASE_SHIFT)  /* First segment: 1024 ids */
+#define REG_SEGMENTS       (HANDLE_SLAB_ID_BITS - REG_SEG_BASE_SHIFT + 1u)
+#define REG_MAX_IDS        (1u << HANDLE_SLAB_ID_BITS)
+#define REG_ID_NONE        UINT32_MAX
+
 /* Slab registry: central table mapping slab_id to slab pointer + generation.
  * 
  * Handles encode slab_id instead of raw pointers for portability and ABA protection.
- * Registry grows dynamically as slabs are allocated (starts at 128, doubles on growth).
+ * Segmented: each segment doubles the previous one and is published once,
+ * never moved or freed before reg_destroy(), so lookups take no lock even
+ * while another thread grows the registry.
  */
 struct SlabRegistry {
-  SlabMeta* metas;   /* Array of (pointer, generation) pairs */
-  uint32_t cap;      /* Current capacity (grows via realloc) */
+  _Atomic(SlabMeta*) segs[REG_SEGMENTS];  /* Published with release, NULL = not yet */
+  
+  /* ID allocator: reuse from the free list first, else bump next_id.
+   * IDs are returned by reg_free_id() when a slab parks in the cache
+   * without ever being published lock-free (see cache_push_prepare()). */
+  uint32_t free_head;            /* Free-ID list head, REG_ID_NONE = empty */
+  _Atomic uint32_t free_count;   /* Length of the free list (stats) */
+  _Atomic uint32_t next_id;      /* Next never-issued ID (stats: high-water mark) */
+  _Atomic uint64_t ids_recycled; /* IDs handed out again from the free list */
   
-  /* Simple ID allocator: bump-allocate from next_id, or reuse from free_ids.
-   * Free list currently unused (IDs never freed), but infrastructure exists. */
-  uint32_t* free_ids;    /* Array of recycled IDs (currently always empty) */
-  uint32_t free_count;   /* Number of IDs in free_ids (currently always 0) */
-  uint32_t next_id;      /* Next unused ID to allocate */
+  /* Shard tag (slab_group.c): a shard of a group of 2^b shards issues IDs
+   * below id_limit = REG_MAX_IDS >> b and puts its shard index in the top b
+   * bits of the handle's slab_id field (id_tag). Standalone allocators use
+   * REG_MAX_IDS and 0. Set before the first allocation, immutable after. */
+  uint32_t id_limit;
+  uint32_t id_tag;
   
-  pthread_mutex_t lock;  /* Protects registry growth and ID allocation */
+  pthread_mutex_t lock;  /* Protects segment installation and the free list */
 };
 
-/* Cache entry storing both slab pointer and ID off-page.
+/* Off-page cache node, one per slab position in an arena.
  *
  * When a slab is madvised, the kernel zeros its memory, destroying the header.
  * We store slab_id here (off-page) so we can still identify and reuse the slab
  * after madvise. Never read slab_id from the slab header during reuse—it's been zeroed.
+ *
+ * Nodes are allocated with their arena and live until allocator_destroy(), so
+ * the lock-free cache stack can link them by index and never frees a node a
+ * concurrent pop might still be reading. slab and arena_ord are immutable.
  */
 struct CachedSlab {
-  Slab* slab;        /* Virtual address (still mapped after madvise) */
-  uint32_t slab_id;  /* Registry ID, survives madvise */
-  bool was_published; /* Track if ever exposed lock-free, survives madvise */
+  Slab* slab;              /* Virtual address (still mapped after madvise) */
+  _Atomic uint32_t next;   /* Cache stack link (node index, SLAB_CACHE_NIL = end) */
+  uint32_t slab_id;        /* Registry ID (survives madvise), REG_ID_NONE once released */
+  uint32_t cached_ms;      /* coarse_ms() at push (trim grace for published slabs) */
+  bool was_published;      /* Track if ever exposed lock-free, survives madvise */
+  bool clean;              /* Pages returned while cached (counted in pool cache_clean) */
+  uint16_t arena_ord;      /* Arena ordinal within the pool */
 };
 
-/* Overflow cache node for when array cache fills up.
- * 
- * Like CachedSlab, stores slab_id off-page since madvise zeros the slab header.
- * Forms a doubly-linked list of cached slabs beyond the 32-entry array cache.
+/* Cache node index: [31:16] arena ordinal, [15:0] slab position in arena.
+ * Arena ordinals resolve through a two-level directory per pool, so a pool
+ * can hold SLAB_ARENA_DIR_BLOCKS * SLAB_ARENA_DIR_BLOCK arenas
+ * (65536 × 2MB = 128GB per class per node with default sizes). */
+#define SLAB_CACHE_NIL        UINT32_MAX
+#define SLAB_CACHE_POS_BITS   16u
+#define SLAB_ARENA_DIR_BLOCK  256u
+#define SLAB_ARENA_DIR_BLOCKS 256u
+#define SLAB_ARENA_MAX_ORDS   (SLAB_ARENA_DIR_BLOCK * SLAB_ARENA_DIR_BLOCKS)
+
+_Static_assert(SLAB_ARENA_SIZE / SLAB_PAGE_SIZE <= (1u << SLAB_CACHE_POS_BITS),
+               "arena slab positions must fit the cache node index");
+
+/* Adaptive cache sizing and trimming (cache_adapt_tick, cache_trim_pool) */
+#define SLAB_CACHE_TARGET_INIT   32u    /* cache_capacity before any demand is seen */
+#define SLAB_CACHE_TARGET_MIN    4u     /* Per node pool */
+#define SLAB_CACHE_TARGET_MAX    4096u
+#define SLAB_CACHE_WINDOW_MS     100u   /* Demand sampling window */
+#define SLAB_CACHE_SHRINK_DWELL  3u     /* Quiet windows before the target drops */
+#define SLAB_CACHE_TRIM_GRACE_MS 1000u  /* Published slabs stay resident this long once cached */
+
+/* Contiguous virtual region that slabs are carved from.
+ *
+ * One arena list per size class keeps slabs of a class adjacent in memory
+ * (TLB reach, hardware prefetch) and turns per-slab mmap() into a bump of
+ * carved_bytes. Arenas are never unmapped while the allocator is alive:
+ * individual slabs are only madvised, so stale handles stay safe to validate.
+ *
+ * Descriptor lives off-region (malloc'd) so madvise never touches it.
+ * All fields protected by sc->arena_lock.
  */
-typedef struct CachedNode {
-  struct CachedNode* prev;
-  struct CachedNode* next;
-  Slab* slab;        /* Virtual address */
-  uint32_t slab_id;  /* Registry ID, survives madvise */
-  bool was_published; /* Track if ever exposed lock-free, survives madvise */
-} CachedNode;
+struct SlabArena {
+  SlabArena* next;        /* Older arenas (list head is the one being carved) */
+  uint8_t* base;          /* Start of reservation, aligned to SLAB_ARENA_SIZE */
+  size_t reserved_bytes;  /* Size of reservation (SLAB_ARENA_SIZE) */
+  size_t carved_bytes;    /* Bump offset: bytes handed out as slabs so far */
+  CachedSlab* nodes;      /* Cache node per slab position [reserved_bytes / slab_bytes] */
+};
+
+/* Per-NUMA-node slab pool within a size class.
+ *
+ * Recycled slabs (lock-free cache stack) and the arena regions fresh
+ * slabs are carved from. Pools are independent, so sockets don't share a
+ * cache line on the recycle path.
+ */
+typedef struct SlabNodePool {
+  /* Slab cache: Treiber stack of CachedSlab nodes linked by index.
+   * [63:32] ABA tag (bumped on every successful push/pop), [31:0] top index.
+   * One 64-bit CAS per push/pop; no mutex, no per-slab malloc. */
+  _Atomic uint64_t cache_head;
+  _Atomic uint32_t cache_count;   /* Slabs on the stack (split at cache_capacity for stats) */
+  _Atomic uint32_t cache_clean;   /* Of those, slabs whose pages were returned (clean nodes) */
+  
+  /* Arena regions for this node (newest first) */
+  SlabArena* arenas;
+  pthread_mutex_t arena_lock;     /* Protects arena list, directory growth and carving */
+  
+  /* Ordinal → arena directory for resolving cache node indices.
+   * Blocks are allocated on demand under arena_lock and never move; readers
+   * only resolve indices of nodes already pushed, which happens-after the
+   * directory store (push release → pop acquire on cache_head). */
+  SlabArena** arena_dir[SLAB_ARENA_DIR_BLOCKS];
+  uint32_t arena_ords;            /* Next arena ordinal */
+  
+  /* Per-node counters (exported via SlabClassStats.numa_*) */
+  _Atomic uint64_t slabs_carved;      /* Fresh slabs carved from this node's arenas */
+  _Atomic uint64_t cache_pops_local;  /* Cache hits for a thread on this node */
+  _Atomic uint64_t cache_pops_remote; /* Thread on this node took another node's slab */
+  _Atomic uint64_t bind_failures;     /* mbind() rejected for this node's arenas */
+  _Atomic uint64_t cache_cas_retries; /* Failed cache_head CAS (push + pop) */
+} SlabNodePool;
 
 /* Intrusive doubly-linked list */
 struct SlabList {
@@ -435,21 +772,41 @@ struct SlabList {
  * Each (size_class, epoch) pair has its own slab lists and lock-free pointer.
  * This temporal partitioning keeps objects with similar lifetimes together.
  */
+/* Lock-free claimers in flight on one current_partial slot, between
+ * slab_pin_published() and slab_unpin(). Kept here rather than in the slab
+ * header: a cached slab's pages may be returned (zeroed) while a stale
+ * claimer is still between pin and unpin. One line per slot, so CPUs
+ * pinning their own slots don't share one. */
+typedef struct SlabSlotPins {
+  _Alignas(SLAB_CACHE_LINE) _Atomic uint32_t n;
+} SlabSlotPins;
+
 typedef struct EpochState {
   /* Slab lists protected by parent size-class mutex.
-   * Allocations scan partial list, move slabs to full list when exhausted. */
+   * Allocations scan partial list, move slabs to full list when exhausted.
+   * Empty slabs nobody has published wait on `empty`, so epoch_close()
+   * visits only what it can reclaim instead of every slab of the epoch. */
   SlabList partial;
   SlabList full;
+  SlabList empty;
+
+  /* Lock-free fast-path pointers, one per CPU slot.
+   * Each points to a slab on the partial list with likely free slots.
+   * Atomic for lock-free loads and CAS updates. Written only on slab
+   * transitions (slow path), so the array itself stays read-mostly. */
+  _Atomic(Slab*) current_partial[SLAB_PERCPU_SLOTS];
 
-  /* Lock-free fast-path pointer.
-   * Points to a slab on the partial list with likely free slots.
-   * Atomic for lock-free loads and CAS updates. */
-  _Atomic(Slab*) current_partial;
+  /* Claims in flight per slot (see slab_pin_published()). Never reset. */
+  SlabSlotPins pins[SLAB_PERCPU_SLOTS];
   
-  /* Count of empty slabs on the partial list.
-   * Enables O(1) query of reclaimable memory without scanning the list.
+  /* Count of empty slabs (on the empty list, or on partial while published).
+   * Enables O(1) query of reclaimable memory without scanning the lists.
    * Incremented when a slab becomes empty, decremented when it gets its first allocation. */
   _Atomic uint32_t empty_partial_count;
+
+  /* Forwarding tables of slabs evacuated from this epoch
+   * (slab_compact_epoch), protected by sc->lock */
+  struct SlabForward* forwards;
 } EpochState;
 
 /* Label registry for semantic attribution in observability.
@@ -463,50 +820,195 @@ typedef struct LabelRegistry {
   pthread_mutex_t lock;            /* Protects registration, cold path only */
 } LabelRegistry;
 
+/* Slab bytes held per label and its quota (slab_label_set_quota).
+ * committed moves once per slab (new_slab() / cache_push_prepare()), never
+ * per object. cb and cb_arg are protected by label_registry.lock. */
+typedef struct LabelQuota {
+  _Atomic uint64_t committed;      /* Bytes of slabs held by epochs with this label */
+  _Atomic uint64_t peak;           /* High-water mark of committed */
+  _Atomic uint64_t quota;          /* 0 = unlimited */
+  _Atomic uint64_t denials;        /* Slab requests refused over quota */
+  SlabQuotaCallback cb;
+  void* cb_arg;
+} LabelQuota;
+
+/* Striped hot-path counters
+ *
+ * Counters bumped on every allocation, free or lock acquire. Each
+ * SizeClassAlloc owns SLAB_COUNTER_STRIPES of these, one cache line apart,
+ * and a thread adds to the stripe of the CPU it runs on (same CPU id as
+ * percpu_slot(), without the slot mask). Concurrent allocators on different
+ * CPUs thus never write the same counter line. Increments stay relaxed
+ * atomic RMWs: a thread may migrate between picking a stripe and adding.
+ *
+ * Readers (slab_stats_*, the scan_adapt controller) sum all stripes with
+ * SC_COUNTER_SUM(); like the other counters, the sum is not a snapshot.
+ *
+ * Usage:
+ *   make CFLAGS="$(CFLAGS) -DSLAB_COUNTER_STRIPES=128"  # >64-CPU hosts
+ */
+#ifndef SLAB_COUNTER_STRIPES
+#define SLAB_COUNTER_STRIPES 64u
+#endif
+
+_Static_assert(SLAB_COUNTER_STRIPES > 0 && (SLAB_COUNTER_STRIPES & (SLAB_COUNTER_STRIPES - 1)) == 0,
+               "SLAB_COUNTER_STRIPES must be a power of 2");
+
+typedef struct SlabCounterStripe {
+  /* Lock-free contention: how often does CAS retry?
+   * High retry rates indicate thundering herd (adaptive scanning mitigates this). */
+  _Alignas(SLAB_CACHE_LINE) _Atomic uint64_t bitmap_alloc_cas_retries; /* Bitmap CAS retries during allocation */
+  _Atomic uint64_t bitmap_free_cas_retries;      /* Bitmap CAS retries during free */
+  _Atomic uint64_t current_partial_cas_failures; /* Failed to update current_partial pointer */
+
+  /* Denominators for computing retry rates.
+   * Example: bitmap_alloc_cas_retries / bitmap_alloc_attempts = retries per operation */
+  _Atomic uint64_t bitmap_alloc_attempts;        /* Total successful allocations */
+  _Atomic uint64_t bitmap_free_attempts;         /* Total successful frees */
+  _Atomic uint64_t current_partial_cas_attempts; /* Total current_partial CAS attempts */
+
+  /* Lock contention: trylock-based probe with ~2ns overhead.
+   * Answers "are threads blocking?" without expensive clock syscalls. */
+  _Atomic uint64_t lock_fast_acquire;            /* Trylock succeeded immediately */
+  _Atomic uint64_t lock_contended;               /* Trylock failed, had to block */
+
+  /* Fast-path misses */
+  _Atomic uint64_t current_partial_null;         /* Fast path saw NULL (no slab selected yet) */
+  _Atomic uint64_t current_partial_full;         /* Fast path saw full slab (race with other thread) */
+} SlabCounterStripe;
+
+#if ENABLE_LATENCY_HIST
+#include <slab_stats.h>  /* SlabLatencyOp, SLAB_LAT_BUCKETS */
+
+/* Latency histogram stripe
+ *
+ * The allocator owns SLAB_LAT_STRIPES of these; a thread records into the
+ * stripe of the CPU it runs on, like SlabCounterStripe, so concurrent
+ * recorders rarely share a line. Each stripe is ~5KB, hence fewer stripes
+ * than the counter stripes.
+ */
+#ifndef SLAB_LAT_STRIPES
+#define SLAB_LAT_STRIPES 16u
+#endif
+
+_Static_assert(SLAB_LAT_STRIPES > 0 && (SLAB_LAT_STRIPES & (SLAB_LAT_STRIPES - 1)) == 0,
+               "SLAB_LAT_STRIPES must be a power of 2");
+
+typedef struct SlabLatencyStripe {
+  _Alignas(SLAB_CACHE_LINE) _Atomic uint64_t count[SLAB_LAT_OPS];
+  _Atomic uint64_t sum_ns[SLAB_LAT_OPS];
+  _Atomic uint64_t buckets[SLAB_LAT_OPS][SLAB_LAT_BUCKETS];
+} SlabLatencyStripe;
+#endif
+
+/* Sum one SlabCounterStripe field across a class's stripes */
+uint64_t sc_counter_sum(const SizeClassAlloc* sc, size_t field_offset);
+#define SC_COUNTER_SUM(sc, field) sc_counter_sum((sc), offsetof(SlabCounterStripe, field))
+
 /* Per-size-class allocator state.
  * 
  * One instance per size class (64B, 96B, 128B, etc.).
  * Manages slab allocation, caching, and recycling for that size.
+ *
+ * Layout: fields the fast path only reads come first; the lock and the
+ * slow-path counters start on the next cache line, so list mutations and
+ * counter updates do not invalidate the line every allocating core reads.
+ * Counters bumped on every alloc/free live in per-CPU stripes instead.
  */
 struct SizeClassAlloc {
-  uint32_t object_size;  /* Size class: 64, 96, 128, ... 768 */
+  /* ---- Read-mostly: written at init, read on every alloc/free ---- */
+  uint32_t object_size;  /* Size class: 64, 96, 128, ... 16384 */
+  uint32_t slab_bytes;   /* Bytes per slab: SLAB_PAGE_SIZE for small classes,
+                          * power-of-two page multiple for the large tier */
+  uint32_t release_bytes; /* Page-return unit, max(slab_bytes, OS page, huge page).
+                          * Above slab_bytes the class is grouped: pushes never
+                          * madvise, cache_trim_pool() returns whole units */
 
   /* Array of per-epoch state (16 epochs).
    * Each epoch has its own partial/full lists and lock-free pointer.
    * Dynamically allocated to keep this struct smaller. */
   EpochState* epochs;
 
-  /* Protects partial/full list mutations and cache operations.
-   * Fast path (current_partial) is lock-free; slow path takes this lock. */
-  pthread_mutex_t lock;
-  
   /* Backpointer to parent allocator.
    * Used in hot path for label_id lookup when ENABLE_LABEL_CONTENTION is on. */
   struct SlabAllocator* parent_alloc;
 
+  /* Hot-path counters, SLAB_COUNTER_STRIPES cache-line-sized stripes
+   * (see SlabCounterStripe). Summed by SC_COUNTER_SUM() for stats. */
+  SlabCounterStripe* stripes;
+
+  /* Slab pools, one per NUMA node (parent_alloc->numa_nodes entries).
+   * Each holds a recycled-slab cache (adaptive target per node, cache hit rate
+   * >97% in benchmarks) plus the arenas fresh slabs are carved from. */
+  SlabNodePool* pools;
+  _Atomic uint32_t cache_capacity; /* Adaptive soft bound per pool: pushes beyond it count as
+                                    * overflow and are trimmed (see cache_adapt_tick()) */
+  _Atomic uint32_t warm_floor;    /* Per pool: recycling below this depth skips madvise (slab_reserve) */
+
+  /* ---- Write-heavy: slow-path state, starts on its own cache line ---- */
+
+  /* Protects partial/full list mutations and cache operations.
+   * Fast path (current_partial) is lock-free; slow path takes this lock. */
+  _Alignas(SLAB_CACHE_LINE) pthread_mutex_t lock;
+
   size_t total_slabs;  /* Total slabs allocated for this size class (lifetime counter) */
+  struct SlabForward* forward_free;  /* Retired forwarding tables for reuse */
 
   /* Performance counters answer "why is allocation slow?"
-   * All atomic with relaxed ordering—eventual consistency is fine for diagnostics. */
+   * All atomic with relaxed ordering—eventual consistency is fine for diagnostics.
+   * Only slow-path events are counted here; see SlabCounterStripe for the rest. */
   _Atomic uint64_t slow_path_hits;              /* Lock-free path failed, took slow path */
-  _Atomic uint64_t new_slab_count;              /* Created new slab (mmap syscall) */
+  _Atomic uint64_t new_slab_count;              /* Created new slab (carved from arena) */
   _Atomic uint64_t list_move_partial_to_full;   /* Slab exhausted, moved to full list */
   _Atomic uint64_t list_move_full_to_partial;   /* First free in full slab, moved to partial */
-  _Atomic uint64_t current_partial_null;        /* Fast path saw NULL (no slab selected yet) */
-  _Atomic uint64_t current_partial_full;        /* Fast path saw full slab (race with other thread) */
   
   /* Empty slab recycling: tracks cache hit rate */
   _Atomic uint64_t empty_slab_recycled;         /* Empty slab pushed to cache for reuse */
   _Atomic uint64_t empty_slab_overflowed;       /* Cache full, pushed to overflow list */
   
+  /* Warm-up (slab_reserve) */
+  _Atomic uint64_t reserved_slabs;              /* Slabs pre-created into the cache */
+  _Atomic uint64_t warm_madvise_skips;          /* Recycles left resident by the warm floor */
+  
   /* Slow-path attribution: answers "why did we hit slow path?" */
   _Atomic uint64_t slow_path_cache_miss;        /* Cache empty, needed mmap */
   _Atomic uint64_t slow_path_epoch_closed;      /* Epoch in CLOSING state, allocation rejected */
   
   /* RSS reclamation: how much memory returned to OS via madvise */
-  _Atomic uint64_t madvise_calls;               /* Number of madvise(MADV_DONTNEED) calls */
+  _Atomic uint64_t madvise_calls;               /* madvise()/process_madvise() syscalls issued */
   _Atomic uint64_t madvise_bytes;               /* Total bytes madvised */
   _Atomic uint64_t madvise_failures;            /* madvise() system call failures */
+  _Atomic uint64_t madvise_batches;             /* Batched reclaims (BATCHED/LAZY modes) */
+  _Atomic uint64_t madvise_ranges;              /* Coalesced ranges across those batches */
+  
+  /* Remote-free lists (SlabAllocatorConfig.remote_free) */
+  _Atomic uint64_t remote_frees;                /* Frees deferred onto a slab's remote stack */
+  _Atomic uint64_t remote_drains;               /* Remote stacks absorbed (non-empty) */
+  _Atomic uint64_t remote_drained_objects;      /* Objects returned by those drains */
+  
+  /* Bump allocation from fresh slabs (see Slab.bump_next) */
+  _Atomic uint64_t bump_allocs;                 /* Slots taken from a bump reserve */
+  _Atomic uint64_t bump_retires;                /* Reserves handed back to the bitmap by a free */
+  
+  /* Cache trimming (cache_trim_pool) */
+  _Atomic uint64_t cache_trims;                 /* Trim passes that returned pages */
+  _Atomic uint64_t cache_trimmed_slabs;         /* Cached slabs madvised by those passes */
+  _Atomic uint64_t release_units;               /* Whole release units returned (grouped classes) */
+  _Atomic uint64_t hugepage_arenas;             /* Arenas advised MADV_HUGEPAGE */
+  
+  /* Adaptive cache sizing: slabs taken per SLAB_CACHE_WINDOW_MS window drive
+   * cache_capacity up at once and down after SLAB_CACHE_SHRINK_DWELL quiet
+   * windows. One runner at a time (in_check), like scan_adapt. */
+  struct {
+    _Atomic uint64_t demand;          /* new_slab() calls (cache pops + carves), lifetime */
+    uint64_t window_base;             /* demand when the window opened */
+    _Atomic uint32_t window_start_ms; /* coarse_ms() when the window opened */
+    uint32_t ewma_x16;                /* Demand per window per pool, 1/16 fixed point */
+    uint32_t shrink_dwell;            /* Consecutive windows wanting a smaller cache */
+    _Atomic uint32_t in_check;
+    _Atomic uint32_t grows;           /* Target raises */
+    _Atomic uint32_t shrinks;         /* Target cuts */
+  } cache_adapt;
   
 #if ENABLE_DIAGNOSTIC_COUNTERS
   /* Diagnostic counters for RSS analysis (compile-time optional, ~1-2% overhead)
@@ -516,7 +1018,7 @@ struct SizeClassAlloc {
    * 
    * Production recommendation: Disable unless actively debugging RSS behavior.
    */
-  _Atomic uint64_t committed_bytes;             /* Total bytes mmap'd (slabs * SLAB_PAGE_SIZE) */
+  _Atomic uint64_t committed_bytes;             /* Total bytes carved into slabs (slabs * slab_bytes) */
   _Atomic uint64_t live_bytes;                  /* Bytes currently allocated to live objects */
   _Atomic uint64_t empty_slabs;                 /* Number of slabs currently empty (all slots free) */
 #endif
@@ -527,22 +1029,10 @@ struct SizeClassAlloc {
   _Atomic uint64_t epoch_close_recycled_slabs;  /* Slabs actually recycled */
   _Atomic uint64_t epoch_close_total_ns;        /* Total time spent in epoch_close() */
   
-  /* Lock-free contention: how often does CAS retry?
-   * High retry rates indicate thundering herd (adaptive scanning mitigates this). */
-  _Atomic uint64_t bitmap_alloc_cas_retries;     /* Bitmap CAS retries during allocation */
-  _Atomic uint64_t bitmap_free_cas_retries;      /* Bitmap CAS retries during free */
-  _Atomic uint64_t current_partial_cas_failures; /* Failed to update current_partial pointer */
-  
-  /* Denominators for computing retry rates.
-   * Example: bitmap_alloc_cas_retries / bitmap_alloc_attempts = retries per operation */
-  _Atomic uint64_t bitmap_alloc_attempts;        /* Total successful allocations */
-  _Atomic uint64_t bitmap_free_attempts;         /* Total successful frees */
-  _Atomic uint64_t current_partial_cas_attempts; /* Total current_partial CAS attempts */
-  
-  /* Lock contention: trylock-based probe with ~2ns overhead.
-   * Answers "are threads blocking?" without expensive clock syscalls. */
-  _Atomic uint64_t lock_fast_acquire;            /* Trylock succeeded immediately */
-  _Atomic uint64_t lock_contended;               /* Trylock failed, had to block */
+  /* Bulk epoch release telemetry (epoch_release_all) */
+  _Atomic uint64_t epoch_release_calls;         /* epoch_release_all() passes over this class */
+  _Atomic uint64_t epoch_release_slabs;         /* Slabs released without per-object frees */
+  _Atomic uint64_t epoch_release_objects;       /* Live objects discarded by bulk release */
   
 #ifdef ENABLE_LABEL_CONTENTION
   /* Phase 2.3: Per-label contention attribution (compile-time optional) */
@@ -577,19 +1067,12 @@ struct SizeClassAlloc {
     _Atomic uint32_t in_check;
   } scan_adapt;
 
-  /* Slab cache: array of recycled slabs to avoid mmap() syscalls.
-   * 32 entries per size class. Cache hit rate >97% in benchmarks.
-   * Stores (Slab*, slab_id) pairs off-page so IDs survive madvise. */
-  CachedSlab* slab_cache;         /* Fixed-size array [32] */
-  size_t cache_capacity;          /* Always 32 */
-  size_t cache_size;              /* Current fill level (0-32) */
-  pthread_mutex_t cache_lock;     /* Protects cache array */
-  
-  /* Overflow list: doubly-linked list of slabs beyond the 32-entry cache.
-   * Unbounded, but typically small. Stores slab_id off-page like array cache. */
-  CachedNode* cache_overflow_head;
-  CachedNode* cache_overflow_tail;
-  size_t cache_overflow_len;      /* Number of nodes in overflow list */
+  /* Arena totals across all pools.
+   * Reserved = virtual address space held; committed = bytes carved into slabs.
+   * Counters mirror the arena lists so stats readers don't need arena_lock. */
+  _Atomic uint64_t arena_count;           /* Regions reserved (one mmap each) */
+  _Atomic uint64_t arena_reserved_bytes;  /* Sum of reserved_bytes */
+  _Atomic uint64_t arena_committed_bytes; /* Sum of carved_bytes */
   
   /* (Protocol Z retired list removed - using was_published flag instead) */
 };
@@ -606,7 +1089,7 @@ typedef struct EpochMetadata {
   uint64_t open_since_ns;           /* nanoseconds since boot, set by epoch_advance() */
   _Atomic uint64_t domain_refcount; /* Number of active epoch_domain_enter() calls */
   char label[32];                   /* Human-readable label like "request" or "batch_42" */
-  uint8_t label_id;                 /* Compact ID (0=unlabeled, 1-15=registered labels) */
+  _Atomic uint8_t label_id;         /* Compact ID (0=unlabeled, 1-15=registered labels) */
   
   /* RSS snapshots before/after epoch_close() to measure reclamation effectiveness.
    * Both zero if epoch never closed. Delta shows MB returned to OS. */
@@ -614,50 +1097,276 @@ typedef struct EpochMetadata {
   uint64_t rss_after_close;
 } EpochMetadata;
 
+/* Background reclaimer (slab_reclaimer_start / epoch_close_async).
+ *
+ * One optional thread per allocator runs the scan/madvise/RSS part of
+ * epoch_close() for epochs queued by epoch_close_async(). Each ring slot is
+ * queued at most once (pending[]), so the FIFO never holds more than
+ * epoch_count entries. Queue fields are protected by lock; pending[] is also
+ * read lock-free by epoch_close_done(). The arrays have epoch_count entries
+ * and are allocated with the epoch ring.
+ */
+typedef struct SlabReclaimJob {
+  EpochCloseCallback cb;
+  void* cb_arg;
+  EpochId id;                       /* As passed to epoch_close_async() */
+} SlabReclaimJob;
+
+typedef struct SlabReclaimer {
+  pthread_mutex_t lock;
+  pthread_cond_t wake;              /* Signalled on enqueue and stop */
+  pthread_t thread;
+  bool running;                     /* Thread started, not yet joined */
+  bool stop;                        /* Drain the queue, then exit */
+  
+  uint32_t* queue;                  /* FIFO of ring slots */
+  uint32_t queue_head;
+  uint32_t queue_len;
+  _Atomic uint8_t* pending;         /* pending[e]: slot e queued or being reclaimed */
+  _Atomic uint32_t pending_count;   /* Slots with pending[e] set */
+  SlabReclaimJob* jobs;             /* jobs[e]: callback of slot e's queued close */
+  
+  /* Budget (SlabReclaimerConfig) */
+  uint64_t slice_budget_ns;         /* Work per slice before pausing (0 = unlimited) */
+  uint32_t pause_us;                /* Sleep between slices */
+  
+  /* Telemetry (SlabGlobalStats.reclaim_*) */
+  _Atomic uint64_t submitted;       /* epoch_close_async() calls handed to the thread */
+  _Atomic uint64_t completed;       /* Jobs finished (including abandoned) */
+  _Atomic uint64_t abandoned;       /* Jobs stopped early: epoch reopened */
+  _Atomic uint64_t budget_pauses;   /* Slices cut short by slice_budget_ns */
+} SlabReclaimer;
+
+
+/* Allocation trace capture (slab_trace_start / slab_trace_stop).
+ *
+ * Each traced thread owns one SlabTraceRing: it is the only producer, the
+ * drainer thread (or slab_trace_stop) the only consumer. Rings are mmapped
+ * on a thread's first record, linked at the head of `rings` under lock and
+ * never unlinked or freed before allocator_destroy(), so a producer that
+ * raced with stop still writes into valid memory. A thread keeps its ring
+ * across sessions; a new thread that reuses a dead thread's pthread_t
+ * adopts its ring.
+ *
+ * Stop protocol: the producer sets busy, then re-reads session; stop clears
+ * session, then waits for busy to drop on every ring (both seq_cst). Either
+ * the producer sees session 0 and backs out, or stop waits for its record.
+ */
+typedef struct SlabTraceRing {
+  _Atomic uint64_t head;            /* Records written (producer) */
+  _Atomic uint64_t tail;            /* Records drained (consumer) */
+  _Atomic uint32_t busy;            /* Producer is inside a record */
+  uint32_t mask;                    /* Capacity - 1 (power of 2) */
+  uint64_t last_ns;                 /* Producer's previous stamp, 0 = none this session */
+  _Atomic uint64_t dropped;         /* Ring full (producer only, read by stats) */
+  uint64_t drained;                 /* Consumer: records drained this session */
+  size_t map_bytes;                 /* Mapping size, for munmap */
+  pthread_t owner;
+  uint16_t thread;                  /* SlabTraceRecord.thread */
+  struct SlabTraceRing* next;       /* Immutable once linked */
+  SlabTraceRecord rec[];
+} SlabTraceRing;
+
+typedef struct SlabTrace {
+  _Atomic uint64_t session;         /* Nonzero while tracing (session number) */
+  uint64_t last_session;
+  uint64_t instance;                /* Unique per allocator_init (TLS ring cache key) */
+  pthread_mutex_t lock;             /* start/stop state, ring attach */
+  pthread_cond_t wake;              /* Signalled on stop */
+  pthread_t thread;                 /* Drainer */
+  bool running;                     /* Drainer started, not yet joined */
+  bool stop;
+  int fd;
+  int error;                        /* errno of the first failed write, 0 = none */
+  uint32_t ring_records;            /* Capacity of rings created from now on */
+  uint32_t flush_ms;
+  _Atomic(SlabTraceRing*) rings;
+  uint32_t ring_count;              /* Rings ever attached (thread numbers handed out) */
+  _Atomic uint64_t written;         /* Records written this session */
+  _Atomic uint64_t lost;            /* Dropped: write failure, or no ring (thread table full) */
+  SlabTraceHeader hdr;
+} SlabTrace;
+
+#if ENABLE_ALLOC_TRACE
+/* Set by the thread cache around the batch calls it makes on its own
+ * behalf (bin flush), so they are not traced as user frees. */
+extern __thread bool _tls_trace_mute;
+#endif
+
+_Static_assert((SLAB_MAX_EPOCHS & (SLAB_MAX_EPOCHS - 1)) == 0, "SLAB_MAX_EPOCHS must be a power of 2");
+
 /* Main allocator structure: one per allocator instance.
  * 
- * Manages 8 size classes (64B to 768B), 16 epochs, and global registry.
+ * Manages up to SLAB_MAX_CLASSES size classes (default 14: 64B to 16KB),
+ * a ring of epoch_count epochs (default 16), and global registry.
  * All size classes share the same epoch state for temporal grouping.
  */
 struct SlabAllocator {
-  SizeClassAlloc classes[8];  /* One per size class: 64, 96, 128, 192, 256, 384, 512, 768 bytes */
+  SizeClassAlloc classes[SLAB_MAX_CLASSES];  /* First num_classes entries in use (default: 64B ... 16KB) */
+  
+  /* Size-class table for this instance (allocator_init_with_config).
+   * class_lookup maps request size → class index (0xFF = unsupported). */
+  uint32_t num_classes;                            /* Active entries in classes[] */
+  uint32_t max_alloc_size;                         /* Largest configured class */
+  bool default_classes;                            /* Table is k_size_classes (slab_default_class_index) */
+  uint8_t class_lookup[SLAB_MAX_OBJECT_SIZE + 1];  /* O(1) size → class lookup */
+  
+  /* NUMA nodes with their own slab pools (1 on single-node/non-Linux hosts) */
+  uint32_t numa_nodes;
+  
+  /* SlabReclaimMode for recycled slabs (slab_set_reclaim_mode) */
+  _Atomic uint32_t reclaim_mode;
+  
+  /* Non-owner frees go to per-slab remote stacks (immutable after init) */
+  bool remote_free;
+  
+  /* slab_malloc_epoch() returns bare objects; slab_free() finds the slab by
+   * masking the pointer (immutable after init) */
+  bool header_free;
+  uint32_t slab_size_shifts;  /* Bit k set: some class uses 2^k-byte slabs */
+  
+  /* Page geometry, fixed at init: OS page size (runtime, not SLAB_PAGE_SIZE)
+   * and the THP size arenas are advised for (0 = hugepage_slabs off) */
+  uint32_t os_page_size;
+  uint32_t hugepage_bytes;
+  
+  /* Arena ownership map (see ARENA_MAP_*): top table of leaf bitmaps */
+  _Atomic(_Atomic uint64_t*)* _Atomic arena_map;
   
   /* Global epoch state shared across all size classes.
-   * epoch_advance() increments current_epoch and marks old epoch CLOSING. */
-  _Atomic uint32_t current_epoch;  /* Ring index (0-15), points to active epoch */
-  uint32_t epoch_count;            /* Always EPOCH_COUNT (16) */
+   * current_epoch is the monotonic epoch sequence: epoch_advance() increments
+   * it and marks the old epoch CLOSING. Its ring slot is the low bits. */
+  _Atomic uint64_t current_epoch;  /* Sequence of the active epoch (== its era) */
+  uint32_t epoch_count;            /* Ring slots, power of 2 (default EPOCH_COUNT) */
+  uint32_t epoch_mask;             /* epoch_count - 1 */
+  
+  /* Per-epoch arrays below have epoch_count entries (allocated in init). */
   
   /* Per-epoch lifecycle: ACTIVE (0) or CLOSING (1).
    * CLOSING epochs reject new allocations and enable aggressive recycling. */
-  _Atomic uint32_t epoch_state[EPOCH_COUNT];
+  _Atomic uint32_t* epoch_state;
   
-  /* Monotonic era counter for observability.
+  /* Monotonic era counter.
    * Increments on every epoch_advance(), never wraps (64-bit).
    * Each epoch stores its era so we can distinguish "epoch 5 generation 100"
-   * from "epoch 5 generation 105" after ring wraparound. */
+   * from "epoch 5 generation 105" after ring wraparound. Qualified EpochIds
+   * carry era + 1 and are checked against epoch_era[] (see epoch_slot). */
   _Atomic uint64_t epoch_era_counter;      /* Global counter */
-  _Atomic uint64_t epoch_era[EPOCH_COUNT]; /* Era stamp per epoch */
+  _Atomic uint64_t* epoch_era;             /* Era stamp per epoch */
+  _Atomic uint64_t epoch_stale_rejects;    /* Stale qualified IDs turned away */
+  
+  /* Soft memory budget (slab_set_memory_budget), 0 = none */
+  _Atomic uint64_t memory_budget;
+  _Atomic uint32_t budget_check_ms;        /* coarse_ms() of the last enforcement */
+  _Atomic uint64_t budget_enforcements;    /* Passes run while over budget */
   
   /* Rich metadata per epoch: timestamps, labels, RSS deltas.
    * Used for debugging and correlating with application logs. */
-  EpochMetadata epoch_meta[EPOCH_COUNT];
+  EpochMetadata* epoch_meta;
   pthread_mutex_t epoch_label_lock;        /* Protects label writes (cold path) */
   
   /* Global label registry maps strings to compact IDs (0-15).
    * Example: "request" → ID 1, "batch" → ID 2.
    * Enables fast label lookup in hot path for contention attribution. */
   LabelRegistry label_registry;
+  LabelQuota label_quota[MAX_LABEL_IDS];   /* Indexed by label ID */
   
   /* Slab registry maps slab_id to (Slab*, generation) pairs.
    * Enables portable handle encoding and ABA protection for safe recycling. */
   SlabRegistry reg;
   
+  /* Optional background reclamation thread (idle unless started) */
+  SlabReclaimer reclaimer;
+  
+  /* Allocation trace capture (idle unless started) */
+  SlabTrace trace;
+  
+  /* Shared-memory stats segment (slab_stats_shm_start; lives in slab_stats.c).
+   * Teardown goes through the hook: not every binary links slab_stats.o. */
+  _Atomic(struct SlabStatsShm*) stats_shm;
+  void (*stats_shm_stop)(struct SlabAllocator* a);
+  
+  /* Shard group membership (slab_group.c, NULL = standalone). The group's
+   * depot check runs from budget_enforce() through the hook: not every
+   * binary links slab_group.o. */
+  struct SlabGroup* group;
+  uint32_t group_shard;
+  void (*group_tick)(struct SlabAllocator* a);
+  
+#if ENABLE_TLS_CACHE
+  /* Thread-cache coordination (see TLSBin). tls_flush_gen[e] is bumped
+   * whenever epoch e must stop being served from thread caches. */
+  uint64_t tls_instance;                     /* Unique per allocator lifetime */
+  _Atomic uint32_t* tls_flush_gen;           /* epoch_count entries */
+  struct SlabAllocator* tls_live_next;       /* Live allocator list (registry lock) */
+#endif
+  
+#if ENABLE_LATENCY_HIST
+  /* Latency histograms, SLAB_LAT_STRIPES entries (see SlabLatencyStripe) */
+  SlabLatencyStripe* lat_stripes;
+#endif
+  
 #if ENABLE_SLOWPATH_SAMPLING
   /* Slowpath sampling for tail latency diagnosis (WSL2/VM detection) */
   SlowpathSampler slowpath_sampler;
 #endif
 };
 
+/* Resolve an EpochId to its ring slot.
+ *
+ * Returns EPOCH_SLOT_NONE if the index is out of range, or if the ID is
+ * era-qualified and its slot has been reopened since (counted in
+ * epoch_stale_rejects). Bare indices skip the era check. */
+static inline uint32_t epoch_slot(SlabAllocator* a, EpochId id) {
+  uint32_t slot = SLAB_EPOCH_INDEX(id);
+  if (slot >= a->epoch_count) return EPOCH_SLOT_NONE;
+  uint32_t q = (uint32_t)(id >> 32);
+  if (q != 0 &&
+      q != (uint32_t)(atomic_load_explicit(&a->epoch_era[slot], memory_order_acquire) + 1u)) {
+    atomic_fetch_add_explicit(&a->epoch_stale_rejects, 1, memory_order_relaxed);
+    return EPOCH_SLOT_NONE;
+  }
+  return slot;
+}
+
+/* Qualified ID of the epoch that opened ring slot `slot` at era `era` */
+static inline EpochId epoch_make_id(uint32_t slot, uint64_t era) {
+  return ((EpochId)(uint32_t)(era + 1u) << 32) | slot;
+}
+
+/* An epoch resolved once for repeated allocation (epoch_domain_alloc).
+ *
+ * slab_epoch_bind() does the per-call work of alloc_obj_epoch() up front:
+ * ring slot, era tag and each class's EpochState. slab_alloc_bound() then
+ * rechecks only that the slot is still ACTIVE and still at the bound era,
+ * and claims from the current slab. Anything else (closed or reopened
+ * epoch, empty current_partial, full slab) goes through alloc_obj_epoch()
+ * with epoch_id, so results match the unbound path exactly.
+ *
+ * A binding is plain data owned by one thread; it never needs releasing. */
+typedef struct SlabEpochBinding {
+  SlabAllocator* alloc;
+  EpochId epoch_id;                      /* Fallback ID for alloc_obj_epoch() */
+  uint32_t slot;                         /* Ring slot (EPOCH_SLOT_NONE: always fall back) */
+  uint32_t era_tag;                      /* Expected epoch_era[slot] + 1, truncated */
+  EpochState* states[SLAB_MAX_CLASSES];  /* &classes[ci].epochs[slot], NULL if unused */
+} SlabEpochBinding;
+
+/* Carved slab bytes minus cached slabs whose pages were returned
+ * (slab_set_memory_budget, SlabGlobalStats.resident_estimate_bytes) */
+uint64_t slab_resident_estimate(const SlabAllocator* a);
+
+/* Idle slab memory for the group depot (slab_group.c): bytes of cached
+ * slabs whose pages are still resident, slabs ever taken from the cache or
+ * carved (cache demand), and a trim of every cache pool to its warm floor
+ * (as budget enforcement) returning the bytes given back */
+uint64_t slab_cache_idle_bytes(const SlabAllocator* a);
+uint64_t slab_cache_demand(const SlabAllocator* a);
+uint64_t slab_cache_trim_idle(SlabAllocator* a);
+
+void slab_epoch_bind(SlabAllocator* a, EpochId epoch, SlabEpochBinding* b);
+void* slab_alloc_bound(const SlabEpochBinding* b, uint32_t ci, SlabHandle* out);
+
 /* Internal helper functions needed by TLS cache (exposed for slab_tls_cache.c) */
 #if ENABLE_TLS_CACHE
 void handle_unpack(SlabHandle h, uint32_t* slab_id, uint32_t* gen, uint32_t* slot, uint32_t* cls);
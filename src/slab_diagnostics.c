@@ -40,16 +40,17 @@ uint32_t slab_detect_epoch_leaks(SlabAllocator* alloc, uint32_t threshold_sec,
   out->top_count = 0;
   out->candidates = NULL;
   
-  /* Allocate temp buffer for all potential candidates (8 classes × 16 epochs = 128) */
-  EpochLeakCandidate* temp = (EpochLeakCandidate*)calloc(8 * 16, sizeof(EpochLeakCandidate));
+  /* Allocate temp buffer for all potential candidates (classes × ring slots) */
+  const uint32_t epochs = slab_epoch_count(alloc);
+  EpochLeakCandidate* temp = (EpochLeakCandidate*)calloc((size_t)alloc->num_classes * epochs, sizeof(EpochLeakCandidate));
   if (!temp) return 0;
   
   uint64_t current_time_ns = now_ns();
   uint32_t count = 0;
   
   /* Scan all size classes and epochs for leak candidates */
-  for (uint32_t cls = 0; cls < 8; cls++) {
-    for (uint32_t epoch = 0; epoch < 16; epoch++) {
+  for (uint32_t cls = 0; cls < alloc->num_classes; cls++) {
+    for (uint32_t epoch = 0; epoch < epochs; epoch++) {
       SlabEpochStats es;
       slab_stats_epoch(alloc, cls, epoch, &es);
       
@@ -108,14 +109,14 @@ void slab_analyze_slow_path(SlabAllocator* alloc, SlowPathReport* out) {
   if (!alloc || !out) return;
   
   out->version = SLAB_DIAGNOSTICS_VERSION;
-  out->class_count = 8;
-  out->classes = (SlowPathAttribution*)calloc(8, sizeof(SlowPathAttribution));
+  out->class_count = alloc->num_classes;
+  out->classes = (SlowPathAttribution*)calloc(alloc->num_classes, sizeof(SlowPathAttribution));
   if (!out->classes) {
     out->class_count = 0;
     return;
   }
   
-  for (uint32_t cls = 0; cls < 8; cls++) {
+  for (uint32_t cls = 0; cls < alloc->num_classes; cls++) {
     SlabClassStats cs;
     slab_stats_class(alloc, cls, &cs);
     
@@ -160,7 +161,7 @@ void slab_analyze_slow_path(SlabAllocator* alloc, SlowPathReport* out) {
                attr->epoch_closed_pct);
     } else if (attr->cache_miss_pct > 50.0) {
       snprintf(attr->recommendation, sizeof(attr->recommendation),
-               "%.0f%% cache misses - consider increasing cache_capacity from 32",
+               "%.0f%% cache misses - growth outpaces recycling (slab_reserve to pre-warm)",
                attr->cache_miss_pct);
     } else if (attr->partial_null_pct > 50.0) {
       snprintf(attr->recommendation, sizeof(attr->recommendation),
@@ -193,16 +194,17 @@ void slab_analyze_reclamation(SlabAllocator* alloc, ReclamationReport* out) {
   out->total_madvise_bytes = gs.total_madvise_bytes;
   out->total_madvise_failures = gs.total_madvise_failures;
   
-  /* Allocate buffer for per-epoch data (8 classes × 16 epochs = 128) */
+  /* Allocate buffer for per-epoch data (classes × ring slots) */
+  const uint32_t epochs = slab_epoch_count(alloc);
   out->epoch_count = 0;
-  out->epochs = (EpochReclamation*)calloc(8 * 16, sizeof(EpochReclamation));
+  out->epochs = (EpochReclamation*)calloc((size_t)alloc->num_classes * epochs, sizeof(EpochReclamation));
   if (!out->epochs) return;
   
   uint32_t count = 0;
   
   /* Collect per-epoch reclamation data */
-  for (uint32_t cls = 0; cls < 8; cls++) {
-    for (uint32_t epoch = 0; epoch < 16; epoch++) {
+  for (uint32_t cls = 0; cls < alloc->num_classes; cls++) {
+    for (uint32_t epoch = 0; epoch < epochs; epoch++) {
       SlabEpochStats es;
       slab_stats_epoch(alloc, cls, epoch, &es);
       
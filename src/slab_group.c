@@ -0,0 +1,379 @@
+/* slab_group.c - Sharded allocator groups (see slab_group.h) */
+
+#include "slab_group.h"
+#include "slab_alloc_internal.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+struct SlabGroup {
+  uint32_t shards;
+  uint32_t shard_bits;                 /* ceil(log2(shards)) */
+  bool header_free;                    /* Shards' SlabAllocatorConfig.header_free */
+  SlabAllocator* shard[SLAB_GROUP_MAX_SHARDS];
+
+  /* Depot. One check at a time (in_check); demand_base is its private
+   * snapshot of each shard's slab demand at the previous check. */
+  _Atomic uint64_t depot_bytes;
+  _Atomic uint32_t depot_check_ms;
+  _Atomic uint32_t in_check;
+  uint64_t demand_base[SLAB_GROUP_MAX_SHARDS];
+  _Atomic uint64_t shard_trimmed[SLAB_GROUP_MAX_SHARDS];
+  _Atomic uint64_t depot_checks;
+  _Atomic uint64_t depot_passes;
+  _Atomic uint64_t misrouted_frees;
+};
+
+static inline uint32_t group_ms(void) {
+  return (uint32_t)(now_ns() / 1000000u);
+}
+
+static inline uint64_t depot_default(uint32_t shards) {
+  return SLAB_GROUP_DEPOT_PER_SHARD * shards;
+}
+
+/* ------------------------------ Depot ------------------------------ */
+
+/* Bring the group's idle (cached, resident) slab memory under depot_bytes.
+ *
+ * Shards are drained coldest first: fewest slabs taken since the previous
+ * check, then most idle bytes. Each one trims every cache pool to its warm
+ * floor (cache_trim_pool, honouring the trim grace of published slabs)
+ * until the group fits. Returns the bytes given back. */
+static uint64_t depot_check(SlabGroup* g, bool force) {
+  uint32_t now_ms = group_ms();
+  uint32_t last = atomic_load_explicit(&g->depot_check_ms, memory_order_relaxed);
+  if (!force) {
+    if (now_ms - last < SLAB_CACHE_WINDOW_MS) return 0;
+    if (!atomic_compare_exchange_strong_explicit(&g->depot_check_ms, &last, now_ms,
+                                                 memory_order_relaxed, memory_order_relaxed)) {
+      return 0;  /* Another shard took this window */
+    }
+  } else {
+    atomic_store_explicit(&g->depot_check_ms, now_ms, memory_order_relaxed);
+  }
+  uint32_t expected = 0;
+  if (!atomic_compare_exchange_strong_explicit(&g->in_check, &expected, 1,
+                                               memory_order_acquire, memory_order_relaxed)) {
+    return 0;
+  }
+  atomic_fetch_add_explicit(&g->depot_checks, 1, memory_order_relaxed);
+
+  uint64_t idle[SLAB_GROUP_MAX_SHARDS];
+  uint64_t recent[SLAB_GROUP_MAX_SHARDS];
+  uint32_t order[SLAB_GROUP_MAX_SHARDS];
+  uint64_t total = 0;
+  for (uint32_t i = 0; i < g->shards; i++) {
+    uint64_t demand = slab_cache_demand(g->shard[i]);
+    recent[i] = demand - g->demand_base[i];
+    g->demand_base[i] = demand;
+    idle[i] = slab_cache_idle_bytes(g->shard[i]);
+    total += idle[i];
+  }
+
+  uint64_t returned = 0;
+  const uint64_t cap = atomic_load_explicit(&g->depot_bytes, memory_order_relaxed);
+  if (total > cap) {
+    atomic_fetch_add_explicit(&g->depot_passes, 1, memory_order_relaxed);
+    /* Insertion sort, at most SLAB_GROUP_MAX_SHARDS entries */
+    for (uint32_t i = 0; i < g->shards; i++) {
+      uint32_t j = i;
+      while (j > 0 && (recent[order[j - 1]] > recent[i] ||
+                       (recent[order[j - 1]] == recent[i] && idle[order[j - 1]] < idle[i]))) {
+        order[j] = order[j - 1];
+        j--;
+      }
+      order[j] = i;
+    }
+    for (uint32_t k = 0; k < g->shards && total > cap; k++) {
+      const uint32_t i = order[k];
+      if (idle[i] == 0) continue;
+      uint64_t got = slab_cache_trim_idle(g->shard[i]);
+      if (got == 0) continue;
+      atomic_fetch_add_explicit(&g->shard_trimmed[i], got, memory_order_relaxed);
+      returned += got;
+      total -= got < total ? got : total;
+    }
+  }
+
+  atomic_store_explicit(&g->in_check, 0, memory_order_release);
+  return returned;
+}
+
+/* SlabAllocator.group_tick: called from the shard's budget_enforce() */
+static void group_tick(SlabAllocator* a) {
+  (void)depot_check(a->group, false);
+}
+
+/* ------------------------------ Lifetime ------------------------------ */
+
+SlabGroup* slab_group_create(const SlabGroupConfig* config) {
+  uint32_t n = config ? config->shards : 0;
+  if (n == 0) {
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    n = cpus > 0 ? (uint32_t)cpus : 1u;
+    if (n > SLAB_GROUP_MAX_SHARDS) n = SLAB_GROUP_MAX_SHARDS;
+  }
+  if (n > SLAB_GROUP_MAX_SHARDS) {
+    errno = EINVAL;
+    return NULL;
+  }
+
+  SlabGroup* g = (SlabGroup*)calloc(1, sizeof(*g));
+  if (!g) {
+    errno = ENOMEM;
+    return NULL;
+  }
+  g->shards = n;
+  while ((1u << g->shard_bits) < n) g->shard_bits++;
+  uint64_t depot = config ? config->depot_bytes : 0;
+  atomic_store_explicit(&g->depot_bytes, depot ? depot : depot_default(n), memory_order_relaxed);
+
+  for (uint32_t i = 0; i < n; i++) {
+    SlabAllocator* a = slab_allocator_create_with_config(config ? config->shard_config : NULL);
+    if (!a) {
+      int saved = errno;
+      slab_group_destroy(g);
+      errno = saved;
+      return NULL;
+    }
+    /* Tag the shard's ID space before its first slab: local IDs below
+     * id_limit, shard index in the top shard_bits of the slab_id field */
+    a->reg.id_limit = REG_MAX_IDS >> g->shard_bits;
+    a->reg.id_tag = i << (HANDLE_SLAB_ID_BITS - g->shard_bits);
+    a->group = g;
+    a->group_shard = i;
+    a->group_tick = group_tick;
+    g->shard[i] = a;
+  }
+  g->header_free = g->shard[0]->header_free;
+  return g;
+}
+
+void slab_group_destroy(SlabGroup* g) {
+  if (!g) return;
+  /* Unhook everything first: a shard being torn down must not trim another */
+  for (uint32_t i = 0; i < g->shards; i++) {
+    if (g->shard[i]) g->shard[i]->group_tick = NULL;
+  }
+  for (uint32_t i = 0; i < g->shards; i++) {
+    slab_allocator_free(g->shard[i]);
+  }
+  free(g);
+}
+
+uint32_t slab_group_shards(const SlabGroup* g) {
+  return g ? g->shards : 0;
+}
+
+SlabAllocator* slab_group_shard(SlabGroup* g, uint32_t index) {
+  if (!g || index >= g->shards) return NULL;
+  return g->shard[index];
+}
+
+/* ------------------------------ Routing ------------------------------ */
+
+/* The slab_id field is the top HANDLE_SLAB_ID_BITS of a handle, so the
+ * shard index is its top shard_bits */
+static inline uint32_t shard_of(const SlabGroup* g, SlabHandle h) {
+  if ((h & 0x3u) != SLAB_VERSION) return UINT32_MAX;
+  uint32_t s = g->shard_bits ? (uint32_t)(h >> (64u - g->shard_bits)) : 0u;
+  return s < g->shards ? s : UINT32_MAX;
+}
+
+uint32_t slab_group_shard_of(const SlabGroup* g, SlabHandle h) {
+  return g ? shard_of(g, h) : UINT32_MAX;
+}
+
+bool slab_group_free(SlabGroup* g, SlabHandle h) {
+  if (!g || h == 0) return false;
+  uint32_t s = shard_of(g, h);
+  if (s == UINT32_MAX) {
+    atomic_fetch_add_explicit(&g->misrouted_frees, 1, memory_order_relaxed);
+    return false;
+  }
+  return free_obj(g->shard[s], h);
+}
+
+uint32_t slab_group_free_batch(SlabGroup* g, const SlabHandle* hs, uint32_t n) {
+  if (!g || !hs) return 0;
+  uint32_t freed = 0;
+  uint32_t i = 0;
+  while (i < n) {
+    uint32_t s = shard_of(g, hs[i]);
+    uint32_t j = i + 1;
+    while (j < n && shard_of(g, hs[j]) == s) j++;
+    if (s != UINT32_MAX) {
+      freed += free_obj_batch(g->shard[s], hs + i, j - i);
+    } else {
+      /* NULL handles are skipped like free_obj_batch() does, not misrouted */
+      uint64_t bad = 0;
+      for (uint32_t k = i; k < j; k++) bad += hs[k] != 0;
+      if (bad) atomic_fetch_add_explicit(&g->misrouted_frees, bad, memory_order_relaxed);
+    }
+    i = j;
+  }
+  return freed;
+}
+
+void slab_group_slab_free(SlabGroup* g, void* ptr) {
+  if (!g || !ptr) return;
+  if (g->header_free) {
+    for (uint32_t i = 0; i < g->shards; i++) {
+      if (slab_owns(g->shard[i], ptr)) {
+        slab_free(g->shard[i], ptr);
+        return;
+      }
+    }
+    return;  /* Not ours: ignored, as slab_free() does */
+  }
+  SlabHandle h;
+  memcpy(&h, (uint8_t*)ptr - sizeof(SlabHandle), sizeof(SlabHandle));
+  uint32_t s = shard_of(g, h);
+  if (s == UINT32_MAX) {
+    atomic_fetch_add_explicit(&g->misrouted_frees, 1, memory_order_relaxed);
+    return;
+  }
+  slab_free(g->shard[s], ptr);
+}
+
+/* ------------------------------ Depot control ------------------------------ */
+
+bool slab_group_set_depot(SlabGroup* g, uint64_t bytes) {
+  if (!g) {
+    errno = EINVAL;
+    return false;
+  }
+  atomic_store_explicit(&g->depot_bytes, bytes ? bytes : depot_default(g->shards),
+                        memory_order_relaxed);
+  (void)depot_check(g, true);
+  return true;
+}
+
+uint64_t slab_group_rebalance(SlabGroup* g) {
+  return g ? depot_check(g, true) : 0;
+}
+
+/* ------------------------------ Statistics ------------------------------ */
+
+void slab_group_stats(SlabGroup* g, SlabGroupStats* out) {
+  memset(out, 0, sizeof(*out));
+  if (!g) return;
+  out->shards = g->shards;
+  out->shard_bits = g->shard_bits;
+  out->shard_max_slabs = REG_MAX_IDS >> g->shard_bits;
+  out->depot_bytes = atomic_load_explicit(&g->depot_bytes, memory_order_relaxed);
+  out->depot_checks = atomic_load_explicit(&g->depot_checks, memory_order_relaxed);
+  out->depot_passes = atomic_load_explicit(&g->depot_passes, memory_order_relaxed);
+  out->misrouted_frees = atomic_load_explicit(&g->misrouted_frees, memory_order_relaxed);
+  for (uint32_t i = 0; i < g->shards; i++) {
+    SlabGroupShardStats* s = &out->shard[i];
+    s->resident_estimate_bytes = slab_resident_estimate(g->shard[i]);
+    s->idle_bytes = slab_cache_idle_bytes(g->shard[i]);
+    s->slab_demand = slab_cache_demand(g->shard[i]);
+    s->depot_trimmed_bytes = atomic_load_explicit(&g->shard_trimmed[i], memory_order_relaxed);
+    out->idle_bytes += s->idle_bytes;
+    out->depot_trimmed_bytes += s->depot_trimmed_bytes;
+  }
+}
+
+/* Group-wide ID of a shard's label `lid`: position of its name in
+ * names[0, *count), appended if new. Returns MAX_LABEL_IDS if full. */
+static uint32_t label_merge_id(SlabAllocator* a, uint32_t lid, char (*names)[32], uint32_t* count) {
+  char name[32];
+  pthread_mutex_lock(&a->label_registry.lock);
+  memcpy(name, a->label_registry.labels[lid], sizeof(name));
+  pthread_mutex_unlock(&a->label_registry.lock);
+  name[sizeof(name) - 1] = '\0';
+  for (uint32_t k = 0; k < *count; k++) {
+    if (strcmp(names[k], name) == 0) return k;
+  }
+  if (*count == MAX_LABEL_IDS) return MAX_LABEL_IDS;
+  memcpy(names[*count], name, sizeof(name));
+  return (*count)++;
+}
+
+void slab_group_stats_global(SlabGroup* g, SlabGlobalStats* out) {
+  memset(out, 0, sizeof(*out));
+  if (!g) return;
+  char names[MAX_LABEL_IDS][32];
+  uint32_t label_count = 0;
+  SlabGlobalStats* s = (SlabGlobalStats*)malloc(sizeof(*s));  /* ~5KB of histograms */
+  if (!s) return;
+
+  for (uint32_t i = 0; i < g->shards; i++) {
+    slab_stats_global(g->shard[i], s);
+    if (i == 0) {
+      out->version = s->version;
+      out->current_epoch = s->current_epoch;
+      out->epoch_count = s->epoch_count;
+      out->rss_bytes_current = s->rss_bytes_current;
+      out->reclaim_mode = s->reclaim_mode;
+      out->os_page_size = s->os_page_size;
+      out->hugepage_bytes = s->hugepage_bytes;
+      out->latency_enabled = s->latency_enabled;
+      out->latency_sample_shift = s->latency_sample_shift;
+    }
+    out->epoch_stale_rejects += s->epoch_stale_rejects;
+    out->active_epoch_count += s->active_epoch_count;
+    out->closing_epoch_count += s->closing_epoch_count;
+    out->total_slabs_allocated += s->total_slabs_allocated;
+    out->total_slabs_recycled += s->total_slabs_recycled;
+    out->net_slabs += s->net_slabs;
+    out->estimated_slab_rss_bytes += s->estimated_slab_rss_bytes;
+    out->total_slow_path_hits += s->total_slow_path_hits;
+    out->total_cache_overflows += s->total_cache_overflows;
+    out->total_slow_cache_miss += s->total_slow_cache_miss;
+    out->total_slow_epoch_closed += s->total_slow_epoch_closed;
+    out->total_madvise_calls += s->total_madvise_calls;
+    out->total_madvise_bytes += s->total_madvise_bytes;
+    out->total_madvise_failures += s->total_madvise_failures;
+    out->total_madvise_batches += s->total_madvise_batches;
+    out->total_madvise_ranges += s->total_madvise_ranges;
+    out->total_remote_frees += s->total_remote_frees;
+    out->total_remote_drains += s->total_remote_drains;
+    out->total_remote_drained_objects += s->total_remote_drained_objects;
+    out->total_bump_allocs += s->total_bump_allocs;
+    out->registry_ids_issued += s->registry_ids_issued;
+    out->registry_ids_free += s->registry_ids_free;
+    out->registry_ids_recycled += s->registry_ids_recycled;
+    out->total_bitmap_alloc_cas_retries += s->total_bitmap_alloc_cas_retries;
+    out->total_bitmap_free_cas_retries += s->total_bitmap_free_cas_retries;
+    out->total_current_partial_cas_failures += s->total_current_partial_cas_failures;
+    out->total_bitmap_alloc_attempts += s->total_bitmap_alloc_attempts;
+    out->total_bitmap_free_attempts += s->total_bitmap_free_attempts;
+    out->total_current_partial_cas_attempts += s->total_current_partial_cas_attempts;
+    out->total_arena_count += s->total_arena_count;
+    out->total_arena_reserved_bytes += s->total_arena_reserved_bytes;
+    out->total_arena_committed_bytes += s->total_arena_committed_bytes;
+    out->memory_budget_bytes += s->memory_budget_bytes;
+    out->resident_estimate_bytes += s->resident_estimate_bytes;
+    out->budget_enforcements += s->budget_enforcements;
+    out->reclaim_running += s->reclaim_running;
+    out->reclaim_pending += s->reclaim_pending;
+    out->reclaim_submitted += s->reclaim_submitted;
+    out->reclaim_completed += s->reclaim_completed;
+    out->reclaim_abandoned += s->reclaim_abandoned;
+    out->reclaim_budget_pauses += s->reclaim_budget_pauses;
+
+    for (uint32_t lid = 0; lid < s->label_count && lid < MAX_LABEL_IDS; lid++) {
+      uint32_t k = label_merge_id(g->shard[i], lid, names, &label_count);
+      if (k == MAX_LABEL_IDS) continue;
+      out->label_committed_bytes[k] += s->label_committed_bytes[lid];
+      out->label_peak_bytes[k] += s->label_peak_bytes[lid];  /* Sum of shard peaks: an upper bound */
+      out->label_quota_bytes[k] += s->label_quota_bytes[lid];
+      out->label_quota_denials[k] += s->label_quota_denials[lid];
+    }
+
+    for (uint32_t op = 0; op < SLAB_LAT_OPS; op++) {
+      out->latency[op].count += s->latency[op].count;
+      out->latency[op].sum_ns += s->latency[op].sum_ns;
+      for (uint32_t b = 0; b < SLAB_LAT_BUCKETS; b++) {
+        out->latency[op].buckets[b] += s->latency[op].buckets[b];
+      }
+    }
+  }
+  out->label_count = label_count;
+  free(s);
+}
@@ -1,6 +1,15 @@
+#define _GNU_SOURCE
 #include "slab_stats.h"
 #include "slab_alloc_internal.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
 
 /* Phase 2.5: TLS storage for slowpath sampling */
 #if ENABLE_SLOWPATH_SAMPLING
@@ -14,10 +23,12 @@ void slab_stats_global(SlabAllocator* alloc, SlabGlobalStats* out) {
   out->version = SLAB_STATS_VERSION;
   
   /* Read global epoch state */
-  out->current_epoch = atomic_load_explicit(&alloc->current_epoch, memory_order_relaxed);
+  out->current_epoch = (uint32_t)atomic_load_explicit(&alloc->current_epoch, memory_order_relaxed);
+  out->epoch_count = alloc->epoch_count;
+  out->epoch_stale_rejects = atomic_load_explicit(&alloc->epoch_stale_rejects, memory_order_relaxed);
   
   /* Count active vs closing epochs */
-  for (uint32_t e = 0; e < EPOCH_COUNT; e++) {
+  for (uint32_t e = 0; e < alloc->epoch_count; e++) {
     EpochLifecycleState state = atomic_load_explicit(&alloc->epoch_state[e], memory_order_relaxed);
     if (state == EPOCH_ACTIVE) {
       out->active_epoch_count++;
@@ -27,7 +38,7 @@ void slab_stats_global(SlabAllocator* alloc, SlabGlobalStats* out) {
   }
   
   /* Aggregate counters across all size classes */
-  for (uint32_t cls = 0; cls < 8; cls++) {
+  for (uint32_t cls = 0; cls < alloc->num_classes; cls++) {
     SizeClassAlloc* sc = &alloc->classes[cls];
     
     /* Slab lifecycle totals */
@@ -36,6 +47,11 @@ void slab_stats_global(SlabAllocator* alloc, SlabGlobalStats* out) {
     out->total_slabs_allocated += allocated;
     out->total_slabs_recycled += recycled;
     
+    /* Large-tier classes use multi-page slabs: weight by per-class slab size */
+    if (allocated > recycled) {
+      out->estimated_slab_rss_bytes += (allocated - recycled) * sc->slab_bytes;
+    }
+    
     /* Performance totals */
     out->total_slow_path_hits += atomic_load_explicit(&sc->slow_path_hits, memory_order_relaxed);
     out->total_cache_overflows += atomic_load_explicit(&sc->empty_slab_overflowed, memory_order_relaxed);
@@ -48,14 +64,38 @@ void slab_stats_global(SlabAllocator* alloc, SlabGlobalStats* out) {
     out->total_madvise_calls += atomic_load_explicit(&sc->madvise_calls, memory_order_relaxed);
     out->total_madvise_bytes += atomic_load_explicit(&sc->madvise_bytes, memory_order_relaxed);
     out->total_madvise_failures += atomic_load_explicit(&sc->madvise_failures, memory_order_relaxed);
+    out->total_madvise_batches += atomic_load_explicit(&sc->madvise_batches, memory_order_relaxed);
+    out->total_madvise_ranges += atomic_load_explicit(&sc->madvise_ranges, memory_order_relaxed);
+    out->total_remote_frees += atomic_load_explicit(&sc->remote_frees, memory_order_relaxed);
+    out->total_remote_drains += atomic_load_explicit(&sc->remote_drains, memory_order_relaxed);
+    out->total_remote_drained_objects += atomic_load_explicit(&sc->remote_drained_objects, memory_order_relaxed);
+    out->total_bump_allocs += atomic_load_explicit(&sc->bump_allocs, memory_order_relaxed);
     
     /* Phase 2.2: Lock-free contention totals */
-    out->total_bitmap_alloc_cas_retries += atomic_load_explicit(&sc->bitmap_alloc_cas_retries, memory_order_relaxed);
-    out->total_bitmap_free_cas_retries += atomic_load_explicit(&sc->bitmap_free_cas_retries, memory_order_relaxed);
-    out->total_current_partial_cas_failures += atomic_load_explicit(&sc->current_partial_cas_failures, memory_order_relaxed);
-    out->total_bitmap_alloc_attempts += atomic_load_explicit(&sc->bitmap_alloc_attempts, memory_order_relaxed);
-    out->total_bitmap_free_attempts += atomic_load_explicit(&sc->bitmap_free_attempts, memory_order_relaxed);
-    out->total_current_partial_cas_attempts += atomic_load_explicit(&sc->current_partial_cas_attempts, memory_order_relaxed);
+    out->total_bitmap_alloc_cas_retries += SC_COUNTER_SUM(sc, bitmap_alloc_cas_retries);
+    out->total_bitmap_free_cas_retries += SC_COUNTER_SUM(sc, bitmap_free_cas_retries);
+    out->total_current_partial_cas_failures += SC_COUNTER_SUM(sc, current_partial_cas_failures);
+    out->total_bitmap_alloc_attempts += SC_COUNTER_SUM(sc, bitmap_alloc_attempts);
+    out->total_bitmap_free_attempts += SC_COUNTER_SUM(sc, bitmap_free_attempts);
+    out->total_current_partial_cas_attempts += SC_COUNTER_SUM(sc, current_partial_cas_attempts);
+    
+    /* Arena reservation totals */
+    out->total_arena_count += atomic_load_explicit(&sc->arena_count, memory_order_relaxed);
+    out->total_arena_reserved_bytes += atomic_load_explicit(&sc->arena_reserved_bytes, memory_order_relaxed);
+    out->total_arena_committed_bytes += atomic_load_explicit(&sc->arena_committed_bytes, memory_order_relaxed);
+  }
+  out->os_page_size = alloc->os_page_size;
+  out->hugepage_bytes = alloc->hugepage_bytes;
+  out->memory_budget_bytes = atomic_load_explicit(&alloc->memory_budget, memory_order_relaxed);
+  out->resident_estimate_bytes = slab_resident_estimate(alloc);
+  out->budget_enforcements = atomic_load_explicit(&alloc->budget_enforcements, memory_order_relaxed);
+  out->label_count = alloc->label_registry.count;
+  for (uint32_t lid = 0; lid < MAX_LABEL_IDS; lid++) {
+    const LabelQuota* q = &alloc->label_quota[lid];
+    out->label_committed_bytes[lid] = atomic_load_explicit(&q->committed, memory_order_relaxed);
+    out->label_peak_bytes[lid] = atomic_load_explicit(&q->peak, memory_order_relaxed);
+    out->label_quota_bytes[lid] = atomic_load_explicit(&q->quota, memory_order_relaxed);
+    out->label_quota_denials[lid] = atomic_load_explicit(&q->denials, memory_order_relaxed);
   }
   
   /* Derived metrics (handle underflow gracefully) */
@@ -64,31 +104,82 @@ void slab_stats_global(SlabAllocator* alloc, SlabGlobalStats* out) {
   } else {
     out->net_slabs = out->total_slabs_allocated - out->total_slabs_recycled;
   }
-  out->estimated_slab_rss_bytes = out->net_slabs * SLAB_PAGE_SIZE;
+  
+  out->reclaim_mode = atomic_load_explicit(&alloc->reclaim_mode, memory_order_relaxed);
+  
+  /* Slab registry occupancy */
+  out->registry_ids_issued = atomic_load_explicit(&alloc->reg.next_id, memory_order_relaxed);
+  out->registry_ids_free = atomic_load_explicit(&alloc->reg.free_count, memory_order_relaxed);
+  out->registry_ids_recycled = atomic_load_explicit(&alloc->reg.ids_recycled, memory_order_relaxed);
+  
+  /* Background reclaimer */
+  const SlabReclaimer* r = &alloc->reclaimer;
+  out->reclaim_running = r->running ? 1u : 0u;
+  out->reclaim_pending = atomic_load_explicit(&r->pending_count, memory_order_relaxed);
+  out->reclaim_submitted = atomic_load_explicit(&r->submitted, memory_order_relaxed);
+  out->reclaim_completed = atomic_load_explicit(&r->completed, memory_order_relaxed);
+  out->reclaim_abandoned = atomic_load_explicit(&r->abandoned, memory_order_relaxed);
+  out->reclaim_budget_pauses = atomic_load_explicit(&r->budget_pauses, memory_order_relaxed);
+  
+  /* Latency histograms: merge the per-CPU stripes */
+#if ENABLE_LATENCY_HIST
+  out->latency_enabled = 1;
+  out->latency_sample_shift = SLAB_LAT_SAMPLE_SHIFT;
+  for (uint32_t i = 0; i < SLAB_LAT_STRIPES; i++) {
+    const SlabLatencyStripe* st = &alloc->lat_stripes[i];
+    for (uint32_t op = 0; op < SLAB_LAT_OPS; op++) {
+      SlabLatencyHist* h = &out->latency[op];
+      h->count += atomic_load_explicit(&st->count[op], memory_order_relaxed);
+      h->sum_ns += atomic_load_explicit(&st->sum_ns[op], memory_order_relaxed);
+      for (uint32_t b = 0; b < SLAB_LAT_BUCKETS; b++) {
+        h->buckets[b] += atomic_load_explicit(&st->buckets[op][b], memory_order_relaxed);
+      }
+    }
+  }
+#endif
   
   /* Actual RSS from OS */
   out->rss_bytes_current = read_rss_bytes_linux();
 }
 
-void slab_stats_class(SlabAllocator* alloc, uint32_t size_class, SlabClassStats* out) {
-  if (size_class >= 8) {
-    memset(out, 0, sizeof(*out));
-    return;
+uint64_t slab_latency_percentile(const SlabLatencyHist* h, double q) {
+  /* Bucket totals, not count: a concurrent merge may see them disagree */
+  uint64_t total = 0;
+  for (uint32_t b = 0; b < SLAB_LAT_BUCKETS; b++) total += h->buckets[b];
+  if (total == 0) return 0;
+  
+  if (q < 0.0) q = 0.0;
+  if (q > 1.0) q = 1.0;
+  uint64_t rank = (uint64_t)(q * (double)total + 0.5);
+  if (rank == 0) rank = 1;
+  
+  uint64_t seen = 0;
+  for (uint32_t b = 0; b < SLAB_LAT_BUCKETS; b++) {
+    seen += h->buckets[b];
+    if (seen >= rank) return slab_lat_bucket_max_ns(b);
   }
-  
+  return slab_lat_bucket_max_ns(SLAB_LAT_BUCKETS - 1u);
+}
+
+/* Fill a class snapshot. with_lists counts partial/full slabs under
+ * sc->lock; the shared-memory publisher skips that and leaves them 0. */
+static void stats_class_fill(SlabAllocator* alloc, uint32_t size_class, SlabClassStats* out,
+                             bool with_lists) {
   SizeClassAlloc* sc = &alloc->classes[size_class];
   
   out->version = SLAB_STATS_VERSION;
   out->class_index = size_class;
   out->object_size = sc->object_size;
+  out->slab_bytes = sc->slab_bytes;
+  out->release_bytes = sc->release_bytes;
   
   /* Read atomic counters (relaxed ordering, non-atomic snapshot) */
   out->slow_path_hits = atomic_load_explicit(&sc->slow_path_hits, memory_order_relaxed);
   out->new_slab_count = atomic_load_explicit(&sc->new_slab_count, memory_order_relaxed);
   out->list_move_partial_to_full = atomic_load_explicit(&sc->list_move_partial_to_full, memory_order_relaxed);
   out->list_move_full_to_partial = atomic_load_explicit(&sc->list_move_full_to_partial, memory_order_relaxed);
-  out->current_partial_null = atomic_load_explicit(&sc->current_partial_null, memory_order_relaxed);
-  out->current_partial_full = atomic_load_explicit(&sc->current_partial_full, memory_order_relaxed);
+  out->current_partial_null = SC_COUNTER_SUM(sc, current_partial_null);
+  out->current_partial_full = SC_COUNTER_SUM(sc, current_partial_full);
   out->empty_slab_recycled = atomic_load_explicit(&sc->empty_slab_recycled, memory_order_relaxed);
   out->empty_slab_overflowed = atomic_load_explicit(&sc->empty_slab_overflowed, memory_order_relaxed);
   
@@ -100,6 +191,13 @@ void slab_stats_class(SlabAllocator* alloc, uint32_t size_class, SlabClassStats*
   out->madvise_calls = atomic_load_explicit(&sc->madvise_calls, memory_order_relaxed);
   out->madvise_bytes = atomic_load_explicit(&sc->madvise_bytes, memory_order_relaxed);
   out->madvise_failures = atomic_load_explicit(&sc->madvise_failures, memory_order_relaxed);
+  out->madvise_batches = atomic_load_explicit(&sc->madvise_batches, memory_order_relaxed);
+  out->madvise_ranges = atomic_load_explicit(&sc->madvise_ranges, memory_order_relaxed);
+  out->remote_frees = atomic_load_explicit(&sc->remote_frees, memory_order_relaxed);
+  out->remote_drains = atomic_load_explicit(&sc->remote_drains, memory_order_relaxed);
+  out->remote_drained_objects = atomic_load_explicit(&sc->remote_drained_objects, memory_order_relaxed);
+  out->bump_allocs = atomic_load_explicit(&sc->bump_allocs, memory_order_relaxed);
+  out->bump_retires = atomic_load_explicit(&sc->bump_retires, memory_order_relaxed);
   
   /* Phase 2.1: Epoch-close telemetry */
   out->epoch_close_calls = atomic_load_explicit(&sc->epoch_close_calls, memory_order_relaxed);
@@ -107,17 +205,22 @@ void slab_stats_class(SlabAllocator* alloc, uint32_t size_class, SlabClassStats*
   out->epoch_close_recycled_slabs = atomic_load_explicit(&sc->epoch_close_recycled_slabs, memory_order_relaxed);
   out->epoch_close_total_ns = atomic_load_explicit(&sc->epoch_close_total_ns, memory_order_relaxed);
   
+  /* Bulk epoch release */
+  out->epoch_release_calls = atomic_load_explicit(&sc->epoch_release_calls, memory_order_relaxed);
+  out->epoch_release_slabs = atomic_load_explicit(&sc->epoch_release_slabs, memory_order_relaxed);
+  out->epoch_release_objects = atomic_load_explicit(&sc->epoch_release_objects, memory_order_relaxed);
+  
   /* Phase 2.2: Lock-free contention metrics */
-  out->bitmap_alloc_cas_retries = atomic_load_explicit(&sc->bitmap_alloc_cas_retries, memory_order_relaxed);
-  out->bitmap_free_cas_retries = atomic_load_explicit(&sc->bitmap_free_cas_retries, memory_order_relaxed);
-  out->current_partial_cas_failures = atomic_load_explicit(&sc->current_partial_cas_failures, memory_order_relaxed);
-  out->bitmap_alloc_attempts = atomic_load_explicit(&sc->bitmap_alloc_attempts, memory_order_relaxed);
-  out->bitmap_free_attempts = atomic_load_explicit(&sc->bitmap_free_attempts, memory_order_relaxed);
-  out->current_partial_cas_attempts = atomic_load_explicit(&sc->current_partial_cas_attempts, memory_order_relaxed);
+  out->bitmap_alloc_cas_retries = SC_COUNTER_SUM(sc, bitmap_alloc_cas_retries);
+  out->bitmap_free_cas_retries = SC_COUNTER_SUM(sc, bitmap_free_cas_retries);
+  out->current_partial_cas_failures = SC_COUNTER_SUM(sc, current_partial_cas_failures);
+  out->bitmap_alloc_attempts = SC_COUNTER_SUM(sc, bitmap_alloc_attempts);
+  out->bitmap_free_attempts = SC_COUNTER_SUM(sc, bitmap_free_attempts);
+  out->current_partial_cas_attempts = SC_COUNTER_SUM(sc, current_partial_cas_attempts);
   
   /* Phase 2.2: Lock contention (Tier 0 trylock probe) */
-  out->lock_fast_acquire = atomic_load_explicit(&sc->lock_fast_acquire, memory_order_relaxed);
-  out->lock_contended = atomic_load_explicit(&sc->lock_contended, memory_order_relaxed);
+  out->lock_fast_acquire = SC_COUNTER_SUM(sc, lock_fast_acquire);
+  out->lock_contended = SC_COUNTER_SUM(sc, lock_contended);
   
   /* Phase 2.2+: Adaptive bitmap scanning observability */
   out->scan_adapt_checks = atomic_load_explicit(&sc->scan_adapt.checks, memory_order_relaxed);
@@ -136,6 +239,11 @@ void slab_stats_class(SlabAllocator* alloc, uint32_t size_class, SlabClassStats*
   out->empty_slabs_count = 0;
 #endif
   
+  /* Arena reservation counters */
+  out->arena_count = atomic_load_explicit(&sc->arena_count, memory_order_relaxed);
+  out->arena_reserved_bytes = atomic_load_explicit(&sc->arena_reserved_bytes, memory_order_relaxed);
+  out->arena_committed_bytes = atomic_load_explicit(&sc->arena_committed_bytes, memory_order_relaxed);
+  
   /* Phase 2.2: Compute derived contention metrics (avoid divide by zero) */
   if (out->bitmap_alloc_attempts > 0) {
     out->avg_alloc_cas_retries_per_attempt = (double)out->bitmap_alloc_cas_retries / out->bitmap_alloc_attempts;
@@ -172,23 +280,58 @@ void slab_stats_class(SlabAllocator* alloc, uint32_t size_class, SlabClassStats*
   }
 #endif
   
-  /* Cache state snapshot (brief lock) */
-  pthread_mutex_lock(&sc->cache_lock);
-  out->cache_size = (uint32_t)sc->cache_size;
-  out->cache_capacity = (uint32_t)sc->cache_capacity;
-  out->cache_overflow_len = (uint32_t)sc->cache_overflow_len;
-  pthread_mutex_unlock(&sc->cache_lock);
+  /* Cache state snapshot (lock-free; depth beyond cache_capacity reports as overflow) */
+  out->cache_size = 0;
+  out->cache_capacity = atomic_load_explicit(&sc->cache_capacity, memory_order_relaxed);
+  out->cache_overflow_len = 0;
+  out->cache_cas_retries = 0;
+  out->cache_clean_slabs = 0;
+  out->cache_target_grows = atomic_load_explicit(&sc->cache_adapt.grows, memory_order_relaxed);
+  out->cache_target_shrinks = atomic_load_explicit(&sc->cache_adapt.shrinks, memory_order_relaxed);
+  out->cache_trims = atomic_load_explicit(&sc->cache_trims, memory_order_relaxed);
+  out->cache_trimmed_slabs = atomic_load_explicit(&sc->cache_trimmed_slabs, memory_order_relaxed);
+  out->release_units = atomic_load_explicit(&sc->release_units, memory_order_relaxed);
+  out->hugepage_arenas = atomic_load_explicit(&sc->hugepage_arenas, memory_order_relaxed);
+  out->reserved_slabs = atomic_load_explicit(&sc->reserved_slabs, memory_order_relaxed);
+  out->warm_floor = atomic_load_explicit(&sc->warm_floor, memory_order_relaxed);
+  out->warm_madvise_skips = atomic_load_explicit(&sc->warm_madvise_skips, memory_order_relaxed);
+  out->numa_nodes = alloc->numa_nodes;
+  out->numa_bind_failures = 0;
+  for (uint32_t n = 0; n < alloc->numa_nodes; n++) {
+    SlabNodePool* pool = &sc->pools[n];
+    uint32_t depth = atomic_load_explicit(&pool->cache_count, memory_order_relaxed);
+    uint32_t cached = depth < out->cache_capacity ? depth : out->cache_capacity;
+    out->cache_size += cached;
+    out->cache_overflow_len += depth - cached;
+    out->cache_cas_retries += atomic_load_explicit(&pool->cache_cas_retries, memory_order_relaxed);
+    out->cache_clean_slabs += atomic_load_explicit(&pool->cache_clean, memory_order_relaxed);
+    out->numa_cached_slabs[n] = depth;
+    out->numa_slabs_carved[n] = atomic_load_explicit(&pool->slabs_carved, memory_order_relaxed);
+    out->numa_cache_pops_local[n] = atomic_load_explicit(&pool->cache_pops_local, memory_order_relaxed);
+    out->numa_cache_pops_remote[n] = atomic_load_explicit(&pool->cache_pops_remote, memory_order_relaxed);
+    out->numa_bind_failures += atomic_load_explicit(&pool->bind_failures, memory_order_relaxed);
+  }
+  for (uint32_t n = alloc->numa_nodes; n < SLAB_MAX_NUMA_NODES; n++) {
+    out->numa_cached_slabs[n] = 0;
+    out->numa_slabs_carved[n] = 0;
+    out->numa_cache_pops_local[n] = 0;
+    out->numa_cache_pops_remote[n] = 0;
+  }
   
   /* Aggregate slab counts across all epochs (brief lock) */
   out->total_partial_slabs = 0;
   out->total_full_slabs = 0;
-  
-  pthread_mutex_lock(&sc->lock);
-  for (uint32_t e = 0; e < EPOCH_COUNT; e++) {
-    out->total_partial_slabs += (uint32_t)sc->epochs[e].partial.len;
-    out->total_full_slabs += (uint32_t)sc->epochs[e].full.len;
+  out->total_empty_slabs = 0;
+  
+  if (with_lists) {
+    pthread_mutex_lock(&sc->lock);
+    for (uint32_t e = 0; e < alloc->epoch_count; e++) {
+      out->total_partial_slabs += (uint32_t)sc->epochs[e].partial.len;
+      out->total_full_slabs += (uint32_t)sc->epochs[e].full.len;
+      out->total_empty_slabs += (uint32_t)sc->epochs[e].empty.len;
+    }
+    pthread_mutex_unlock(&sc->lock);
   }
-  pthread_mutex_unlock(&sc->lock);
   
   /* Derived metrics */
   uint64_t total_recycled_or_overflowed = out->empty_slab_recycled + out->empty_slab_overflowed;
@@ -204,11 +347,20 @@ void slab_stats_class(SlabAllocator* alloc, uint32_t size_class, SlabClassStats*
   } else {
     out->net_slabs = out->new_slab_count - out->empty_slab_recycled;
   }
-  out->estimated_rss_bytes = out->net_slabs * SLAB_PAGE_SIZE;
+  out->estimated_rss_bytes = out->net_slabs * sc->slab_bytes;
+}
+
+void slab_stats_class(SlabAllocator* alloc, uint32_t size_class, SlabClassStats* out) {
+  if (size_class >= alloc->num_classes) {
+    memset(out, 0, sizeof(*out));
+    return;
+  }
+  stats_class_fill(alloc, size_class, out, true);
 }
 
-void slab_stats_epoch(SlabAllocator* alloc, uint32_t size_class, EpochId epoch, SlabEpochStats* out) {
-  if (size_class >= 8 || epoch >= EPOCH_COUNT) {
+void slab_stats_epoch(SlabAllocator* alloc, uint32_t size_class, EpochId epoch_id, SlabEpochStats* out) {
+  uint32_t epoch = epoch_slot(alloc, epoch_id);
+  if (size_class >= alloc->num_classes || epoch == EPOCH_SLOT_NONE) {
     memset(out, 0, sizeof(*out));
     return;
   }
@@ -241,6 +393,7 @@ void slab_stats_epoch(SlabAllocator* alloc, uint32_t size_class, EpochId epoch,
   EpochState* es = &sc->epochs[epoch];
   out->partial_slab_count = (uint32_t)es->partial.len;
   out->full_slab_count = (uint32_t)es->full.len;
+  out->empty_slab_count = (uint32_t)es->empty.len;
   
   pthread_mutex_unlock(&sc->lock);
   
@@ -248,8 +401,9 @@ void slab_stats_epoch(SlabAllocator* alloc, uint32_t size_class, EpochId epoch,
   out->reclaimable_slab_count = atomic_load_explicit(&es->empty_partial_count, memory_order_relaxed);
   
   /* Derived metrics */
-  out->estimated_rss_bytes = (uint64_t)(out->partial_slab_count + out->full_slab_count) * SLAB_PAGE_SIZE;
-  out->reclaimable_bytes = (uint64_t)out->reclaimable_slab_count * SLAB_PAGE_SIZE;
+  out->estimated_rss_bytes =
+      (uint64_t)(out->partial_slab_count + out->full_slab_count + out->empty_slab_count) * sc->slab_bytes;
+  out->reclaimable_bytes = (uint64_t)out->reclaimable_slab_count * sc->slab_bytes;
 }
 
 /* Phase 2.5: Thread-local sampling statistics */
@@ -258,3 +412,312 @@ ThreadStats slab_stats_thread(void) {
   return tls_stats;
 }
 #endif
+
+/* ==================== Shared-Memory Stats Segment ==================== */
+
+#define SHM_READ_RETRIES 10000u  /* Reader attempts before giving up (EAGAIN) */
+
+/* Publisher state, owned through SlabAllocator.stats_shm */
+struct SlabStatsShm {
+  SlabAllocator* alloc;
+  char path[256];
+  SlabShmHeader* seg;          /* Shared mapping */
+  SlabShmHeader* stage;        /* Private buffer, same layout, filled outside the seqlock */
+  size_t bytes;
+  uint64_t publish_count;
+  pthread_mutex_t publish_lock;  /* Serializes publishes */
+  
+  /* Optional publisher thread */
+  pthread_mutex_t wake_lock;
+  pthread_cond_t wake;
+  pthread_t thread;
+  bool has_thread;
+  bool stop;
+  uint32_t interval_ms;
+};
+
+static size_t shm_align(size_t n) {
+  return (n + SLAB_CACHE_LINE - 1u) & ~(size_t)(SLAB_CACHE_LINE - 1u);
+}
+
+/* Build a complete snapshot in st->stage. Counters only: no sc->lock */
+static void shm_fill_stage(struct SlabStatsShm* st) {
+  SlabAllocator* a = st->alloc;
+  SlabShmHeader* h = st->stage;
+  
+  slab_stats_global(a, &h->global);
+  
+  for (uint32_t cls = 0; cls < a->num_classes; cls++) {
+    SlabClassStats* cs = (SlabClassStats*)(void*)((char*)h + h->classes_offset +
+                                                  (size_t)cls * h->class_stride);
+    memset(cs, 0, sizeof(*cs));
+    stats_class_fill(a, cls, cs, false);
+  }
+  
+  /* Labels are written under epoch_label_lock (cold path, never taken by alloc/free) */
+  SlabShmEpoch* eps = (SlabShmEpoch*)(void*)((char*)h + h->epochs_offset);
+  pthread_mutex_lock(&a->epoch_label_lock);
+  for (uint32_t e = 0; e < a->epoch_count; e++) {
+    SlabShmEpoch* ep = &eps[e];
+    const EpochMetadata* m = &a->epoch_meta[e];
+    ep->slot = e;
+    ep->state = atomic_load_explicit(&a->epoch_state[e], memory_order_relaxed);
+    ep->era = atomic_load_explicit(&a->epoch_era[e], memory_order_relaxed);
+    ep->open_since_ns = m->open_since_ns;
+    ep->domain_refcount = atomic_load_explicit(&m->domain_refcount, memory_order_relaxed);
+    ep->rss_before_close = m->rss_before_close;
+    ep->rss_after_close = m->rss_after_close;
+    ep->label_id = m->label_id;
+    memcpy(ep->label, m->label, sizeof(ep->label));
+    ep->label[sizeof(ep->label) - 1] = '\0';
+  }
+  pthread_mutex_unlock(&a->epoch_label_lock);
+  
+  h->publish_count = ++st->publish_count;
+  h->publish_ns = now_ns();
+}
+
+/* Copy the stage into the segment inside one seqlock write section.
+ * The fixed header prefix (magic .. seq) is never rewritten. */
+static void shm_commit(struct SlabStatsShm* st) {
+  SlabShmHeader* seg = st->seg;
+  const size_t head = offsetof(SlabShmHeader, publish_count);
+  
+  uint64_t seq = atomic_load_explicit(&seg->seq, memory_order_relaxed);
+  atomic_store_explicit(&seg->seq, seq + 1u, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  
+  memcpy((char*)seg + head, (const char*)st->stage + head, sizeof(SlabShmHeader) - head);
+  memcpy((char*)seg + seg->classes_offset, (const char*)st->stage + seg->classes_offset,
+         st->bytes - seg->classes_offset);
+  
+  atomic_store_explicit(&seg->seq, seq + 2u, memory_order_release);
+}
+
+static bool shm_publish(struct SlabStatsShm* st) {
+  pthread_mutex_lock(&st->publish_lock);
+  shm_fill_stage(st);
+  shm_commit(st);
+  pthread_mutex_unlock(&st->publish_lock);
+  return true;
+}
+
+static void* shm_publisher_main(void* arg) {
+  struct SlabStatsShm* st = (struct SlabStatsShm*)arg;
+  
+  pthread_mutex_lock(&st->wake_lock);
+  while (!st->stop) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    uint64_t ns = (uint64_t)deadline.tv_nsec + (uint64_t)st->interval_ms * 1000000ull;
+    deadline.tv_sec += (time_t)(ns / 1000000000ull);
+    deadline.tv_nsec = (long)(ns % 1000000000ull);
+    while (!st->stop && pthread_cond_timedwait(&st->wake, &st->wake_lock, &deadline) != ETIMEDOUT) {
+    }
+    if (st->stop) break;
+    pthread_mutex_unlock(&st->wake_lock);
+    shm_publish(st);
+    pthread_mutex_lock(&st->wake_lock);
+  }
+  pthread_mutex_unlock(&st->wake_lock);
+  return NULL;
+}
+
+static void shm_destroy(struct SlabStatsShm* st) {
+  if (st->seg) {
+    munmap(st->seg, st->bytes);
+    unlink(st->path);
+  }
+  free(st->stage);
+  pthread_mutex_destroy(&st->publish_lock);
+  pthread_mutex_destroy(&st->wake_lock);
+  pthread_cond_destroy(&st->wake);
+  free(st);
+}
+
+bool slab_stats_shm_start(SlabAllocator* alloc, const SlabStatsShmConfig* config) {
+  if (atomic_load_explicit(&alloc->stats_shm, memory_order_acquire)) {
+    errno = EALREADY;
+    return false;
+  }
+  
+  struct SlabStatsShm* st = (struct SlabStatsShm*)calloc(1, sizeof(*st));
+  if (!st) {
+    errno = ENOMEM;
+    return false;
+  }
+  st->alloc = alloc;
+  st->interval_ms = config ? config->interval_ms : 0;
+  pthread_mutex_init(&st->publish_lock, NULL);
+  pthread_mutex_init(&st->wake_lock, NULL);
+  pthread_condattr_t ca;
+  pthread_condattr_init(&ca);
+  pthread_condattr_setclock(&ca, CLOCK_MONOTONIC);
+  pthread_cond_init(&st->wake, &ca);
+  pthread_condattr_destroy(&ca);
+  
+  if (config && config->path) {
+    snprintf(st->path, sizeof(st->path), "%s", config->path);
+  } else {
+    snprintf(st->path, sizeof(st->path), SLAB_SHM_PATH_FMT, (unsigned)getpid());
+  }
+  
+  const size_t classes_offset = shm_align(sizeof(SlabShmHeader));
+  const size_t epochs_offset = shm_align(classes_offset + alloc->num_classes * sizeof(SlabClassStats));
+  st->bytes = epochs_offset + (size_t)alloc->epoch_count * sizeof(SlabShmEpoch);
+  st->stage = (SlabShmHeader*)calloc(1, st->bytes);
+  if (!st->stage) {
+    shm_destroy(st);
+    errno = ENOMEM;
+    return false;
+  }
+  
+  /* Exclusive: another allocator's live segment (the default path is per
+   * process, not per allocator) must not be truncated and later unlinked */
+  int fd = open(st->path, O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    int err = errno;
+    shm_destroy(st);
+    errno = err;
+    return false;
+  }
+  void* seg = MAP_FAILED;
+  if (ftruncate(fd, (off_t)st->bytes) == 0) {
+    seg = mmap(NULL, st->bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  int err = errno;
+  close(fd);
+  if (seg == MAP_FAILED) {
+    unlink(st->path);
+    shm_destroy(st);
+    errno = err;
+    return false;
+  }
+  st->seg = (SlabShmHeader*)seg;
+  
+  /* Layout fields, identical in stage and segment */
+  SlabShmHeader* hs[2] = { st->stage, st->seg };
+  for (int i = 0; i < 2; i++) {
+    hs[i]->shm_version = SLAB_SHM_VERSION;
+    hs[i]->stats_version = SLAB_STATS_VERSION;
+    hs[i]->segment_bytes = st->bytes;
+    hs[i]->pid = (uint32_t)getpid();
+    hs[i]->num_classes = alloc->num_classes;
+    hs[i]->epoch_count = alloc->epoch_count;
+    hs[i]->class_stride = (uint32_t)sizeof(SlabClassStats);
+    hs[i]->classes_offset = classes_offset;
+    hs[i]->epochs_offset = epochs_offset;
+  }
+  
+  struct SlabStatsShm* expected = NULL;
+  if (!atomic_compare_exchange_strong_explicit(&alloc->stats_shm, &expected, st,
+                                               memory_order_acq_rel, memory_order_acquire)) {
+    shm_destroy(st);
+    errno = EALREADY;
+    return false;
+  }
+  alloc->stats_shm_stop = slab_stats_shm_stop;
+  
+  /* First snapshot, then the magic: attachers never see an empty segment */
+  shm_publish(st);
+  atomic_thread_fence(memory_order_release);
+  st->seg->magic = SLAB_SHM_MAGIC;
+  
+  if (st->interval_ms > 0) {
+    int rc = pthread_create(&st->thread, NULL, shm_publisher_main, st);
+    if (rc != 0) {
+      slab_stats_shm_stop(alloc);
+      errno = rc;
+      return false;
+    }
+    st->has_thread = true;
+  }
+  return true;
+}
+
+bool slab_stats_shm_publish(SlabAllocator* alloc) {
+  struct SlabStatsShm* st = atomic_load_explicit(&alloc->stats_shm, memory_order_acquire);
+  if (!st) {
+    errno = EINVAL;
+    return false;
+  }
+  return shm_publish(st);
+}
+
+void slab_stats_shm_stop(SlabAllocator* alloc) {
+  struct SlabStatsShm* st = atomic_exchange_explicit(&alloc->stats_shm, NULL, memory_order_acq_rel);
+  if (!st) return;
+  
+  if (st->has_thread) {
+    pthread_mutex_lock(&st->wake_lock);
+    st->stop = true;
+    pthread_cond_signal(&st->wake);
+    pthread_mutex_unlock(&st->wake_lock);
+    pthread_join(st->thread, NULL);
+  }
+  shm_destroy(st);
+}
+
+bool slab_stats_shm_attach(SlabShmReader* r, const char* path) {
+  r->seg = NULL;
+  r->bytes = 0;
+  
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) return false;
+  struct stat sb;
+  if (fstat(fd, &sb) != 0) {
+    int err = errno;
+    close(fd);
+    errno = err;
+    return false;
+  }
+  if ((size_t)sb.st_size < sizeof(SlabShmHeader)) {
+    close(fd);
+    errno = EPROTO;
+    return false;
+  }
+  void* seg = mmap(NULL, (size_t)sb.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  int err = errno;
+  close(fd);
+  if (seg == MAP_FAILED) {
+    errno = err;
+    return false;
+  }
+  
+  const SlabShmHeader* h = (const SlabShmHeader*)seg;
+  if (h->magic != SLAB_SHM_MAGIC || h->shm_version != SLAB_SHM_VERSION ||
+      h->stats_version != SLAB_STATS_VERSION || h->segment_bytes != (uint64_t)sb.st_size ||
+      h->class_stride != sizeof(SlabClassStats)) {
+    munmap(seg, (size_t)sb.st_size);
+    errno = EPROTO;
+    return false;
+  }
+  atomic_thread_fence(memory_order_acquire);
+  r->seg = h;
+  r->bytes = (size_t)sb.st_size;
+  return true;
+}
+
+bool slab_stats_shm_read(const SlabShmReader* r, void* buf, size_t len) {
+  if (!r->seg || len < r->bytes) {
+    errno = EINVAL;
+    return false;
+  }
+  
+  _Atomic uint64_t* seqp = (_Atomic uint64_t*)(uintptr_t)&r->seg->seq;
+  for (uint32_t i = 0; i < SHM_READ_RETRIES; i++) {
+    uint64_t s1 = atomic_load_explicit(seqp, memory_order_acquire);
+    if (s1 & 1u) continue;  /* Update in progress */
+    memcpy(buf, r->seg, r->bytes);
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(seqp, memory_order_relaxed) == s1) return true;
+  }
+  errno = EAGAIN;
+  return false;
+}
+
+void slab_stats_shm_detach(SlabShmReader* r) {
+  if (r->seg) munmap((void*)(uintptr_t)r->seg, r->bytes);
+  r->seg = NULL;
+  r->bytes = 0;
+}
@@ -1,42 +1,192 @@
+#define _GNU_SOURCE  /* pthread_rwlock_t */
 #include "slab_alloc_internal.h"
 #include <string.h>
 #include <errno.h>
 #include <stdio.h>
+#include <stdlib.h>
 
 #if ENABLE_TLS_CACHE
 
-__thread TLSCache _tls_cache[8];
-__thread bool _tls_initialized = false;
+__thread TLSThread* _tls_self = NULL;
 __thread bool _tls_in_refill = false;  /* Prevent recursion during refill */
-__thread bool _tls_in_flush = false;   /* Prevent recursion during flush */
-__thread bool _tls_bypass = false;     /* Bypass TLS during flush to prevent deadlock */
+static __thread bool _tls_exited = false;  /* Key destructor ran: never re-register */
 
-ThreadRegistryEntry _thread_registry[MAX_THREADS];
+_Atomic uint64_t _tls_flush_seq = 0;
+
+TLSThread* _thread_registry = NULL;
 uint32_t _thread_count = 0;
-pthread_mutex_t _thread_registry_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_rwlock_t _thread_registry_lock = PTHREAD_RWLOCK_INITIALIZER;
 
-void tls_init_thread(void) {
-    if (_tls_initialized) return;
-    
-    memset(_tls_cache, 0, sizeof(_tls_cache));
-    
-    pthread_mutex_lock(&_thread_registry_lock);
-    
-    if (_thread_count < MAX_THREADS) {
-        _thread_registry[_thread_count].tid = pthread_self();
-        _thread_registry[_thread_count].caches = _tls_cache;
-        _thread_count++;
+/* Live allocators (registry lock). Bins are only flushed into allocators
+ * found here, so a thread exiting after its allocator was destroyed just
+ * discards the handles instead of touching freed memory. */
+static SlabAllocator* g_live_allocs = NULL;
+static _Atomic uint64_t g_next_instance = 1;
+
+/* Stats of exited threads, folded in by tls_thread_exit() */
+static uint64_t g_retired_stats[9];
+
+static pthread_key_t g_tls_key;
+static pthread_once_t g_tls_key_once = PTHREAD_ONCE_INIT;
+
+/* ------------------------------ Allocator tracking ------------------------------ */
+
+void tls_allocator_register(SlabAllocator* a) {
+    a->tls_instance = atomic_fetch_add_explicit(&g_next_instance, 1, memory_order_relaxed);
+    for (uint32_t e = 0; e < a->epoch_count; e++) {
+        atomic_store_explicit(&a->tls_flush_gen[e], 0, memory_order_relaxed);
+    }
+    pthread_rwlock_wrlock(&_thread_registry_lock);
+    a->tls_live_next = g_live_allocs;
+    g_live_allocs = a;
+    pthread_rwlock_unlock(&_thread_registry_lock);
+}
+
+void tls_allocator_unregister(SlabAllocator* a) {
+    /* Write lock waits out any owner mid-sweep into this allocator */
+    pthread_rwlock_wrlock(&_thread_registry_lock);
+    for (SlabAllocator** pp = &g_live_allocs; *pp; pp = &(*pp)->tls_live_next) {
+        if (*pp == a) {
+            *pp = a->tls_live_next;
+            break;
+        }
+    }
+    a->tls_live_next = NULL;
+    pthread_rwlock_unlock(&_thread_registry_lock);
+    /* Owners sweep at their next alloc and release bins pinned by `a` */
+    atomic_fetch_add_explicit(&_tls_flush_seq, 1, memory_order_release);
+}
+
+/* Caller holds the registry lock (read or write) */
+static bool tls_allocator_live(const TLSBin* bin) {
+    for (SlabAllocator* a = g_live_allocs; a; a = a->tls_live_next) {
+        if (a == bin->alloc) return a->tls_instance == bin->alloc_instance;
+    }
+    return false;
+}
+
+/* ------------------------------ Bins ------------------------------ */
+
+/* Return every handle in a bin to its allocator and mark the bin unused.
+ * Caller guarantees bin->alloc is alive. */
+static void tls_drop_bin(TLSBin* bin) {
+    SlabHandle hs[TLS_BIN_CAP];
+    for (uint32_t i = 0; i < bin->count; i++) hs[i] = bin->items[i].h;
+    if (bin->count > 0) {
+#if ENABLE_ALLOC_TRACE
+        /* Cached handles were never handed out: not user frees */
+        bool mute = _tls_trace_mute;
+        _tls_trace_mute = true;
+        free_obj_batch(bin->alloc, hs, bin->count);
+        _tls_trace_mute = mute;
+#else
+        free_obj_batch(bin->alloc, hs, bin->count);
+#endif
+    }
+    bin->count = 0;
+    bin->alloc = NULL;
+}
+
+/* Stale = epoch no longer ACTIVE, or flushed (closed/released) since refill */
+static inline bool tls_bin_stale(const TLSBin* bin) {
+    SlabAllocator* a = bin->alloc;
+    return atomic_load_explicit(&a->epoch_state[bin->epoch_id], memory_order_acquire) != EPOCH_ACTIVE ||
+           atomic_load_explicit(&a->tls_flush_gen[bin->epoch_id], memory_order_acquire) != bin->flush_gen;
+}
+
+static inline bool tls_bin_owned_by(const TLSBin* bin, const SlabAllocator* a) {
+    return bin->alloc == a && bin->alloc_instance == a->tls_instance;
+}
+
+/* Owner-side half of the flush handshake: act on requests posted since
+ * flush_seen. Read lock keeps the bins' allocators alive while we free into
+ * them; sweeps from many threads run concurrently. */
+static void tls_service_flush(TLSThread* t) {
+    uint64_t seq = atomic_load_explicit(&_tls_flush_seq, memory_order_acquire);
+    pthread_rwlock_rdlock(&_thread_registry_lock);
+    for (uint32_t sc = 0; sc < SLAB_MAX_CLASSES; sc++) {
+        TLSCache* tls = &t->caches[sc];
+        for (uint32_t b = 0; b < TLS_EPOCH_BINS; b++) {
+            TLSBin* bin = &tls->bins[b];
+            if (!bin->alloc) continue;
+            if (!tls_allocator_live(bin)) {
+                bin->count = 0;  /* Allocator destroyed: handles died with it */
+                bin->alloc = NULL;
+            } else if (tls_bin_stale(bin)) {
+                tls_drop_bin(bin);
+                tls->tls_epoch_rejects++;
+            }
+        }
+    }
+    pthread_rwlock_unlock(&_thread_registry_lock);
+    t->flush_seen = seq;
+}
+
+/* ------------------------------ Thread registry ------------------------------ */
+
+static void tls_thread_exit(void* arg) {
+    TLSThread* t = (TLSThread*)arg;
+
+    pthread_rwlock_wrlock(&_thread_registry_lock);
+    for (uint32_t sc = 0; sc < SLAB_MAX_CLASSES; sc++) {
+        TLSCache* tls = &t->caches[sc];
+        for (uint32_t b = 0; b < TLS_EPOCH_BINS; b++) {
+            if (tls->bins[b].alloc && tls_allocator_live(&tls->bins[b])) tls_drop_bin(&tls->bins[b]);
+        }
+        g_retired_stats[0] += tls->tls_alloc_attempts;
+        g_retired_stats[1] += tls->tls_alloc_bypassed;
+        g_retired_stats[2] += tls->tls_alloc_hits;
+        g_retired_stats[3] += tls->tls_alloc_refills;
+        g_retired_stats[4] += tls->tls_popped;
+        g_retired_stats[5] += tls->tls_refilled_added;
+        g_retired_stats[6] += tls->tls_epoch_rejects;
+        g_retired_stats[7] += tls->tls_bin_evictions;
     }
-    
-    pthread_mutex_unlock(&_thread_registry_lock);
-    
-    _tls_initialized = true;
+    g_retired_stats[8]++;
+
+    if (t->prev) t->prev->next = t->next;
+    else _thread_registry = t->next;
+    if (t->next) t->next->prev = t->prev;
+    _thread_count--;
+    pthread_rwlock_unlock(&_thread_registry_lock);
+
+    _tls_self = NULL;
+    _tls_exited = true;
+    free(t);
+}
+
+static void tls_make_key(void) {
+    (void)pthread_key_create(&g_tls_key, tls_thread_exit);
+}
+
+void tls_init_thread(void) {
+    if (_tls_self || _tls_exited) return;
+
+    pthread_once(&g_tls_key_once, tls_make_key);
+
+    /* ~135KB, mostly untouched: calloc'd pages fault in per bin on first use */
+    TLSThread* t = (TLSThread*)calloc(1, sizeof(TLSThread));
+    if (!t) return;  /* Run uncached */
+    t->tid = pthread_self();
+    t->flush_seen = atomic_load_explicit(&_tls_flush_seq, memory_order_acquire);
+
+    pthread_rwlock_wrlock(&_thread_registry_lock);
+    t->next = _thread_registry;
+    if (_thread_registry) _thread_registry->prev = t;
+    _thread_registry = t;
+    _thread_count++;
+    pthread_rwlock_unlock(&_thread_registry_lock);
+
+    (void)pthread_setspecific(g_tls_key, t);
+    _tls_self = t;
 }
 
+/* ------------------------------ Adaptive bypass ------------------------------ */
+
 /* Check if TLS alloc should be bypassed due to low hit rate */
 static inline int tls_should_bypass_alloc(TLSCache* tls) {
     if (tls->bypass_alloc) {
-        if (tls->window_ops >= tls->bypass_ends_at) {
+        if (++tls->window_ops >= tls->bypass_ends_at) {
             tls->bypass_alloc = 0;  /* Re-enable after bypass window */
             tls->window_hits = 0;   /* Reset window state for clean measurement */
             tls->window_ops = 0;
@@ -50,12 +200,12 @@ static inline int tls_should_bypass_alloc(TLSCache* tls) {
 static inline void tls_record_alloc(TLSCache* tls, int hit) {
     tls->window_ops++;
     if (hit) tls->window_hits++;
-    
+
     /* Check hit rate every TLS_WINDOW_OPS operations */
     if ((tls->window_ops & (TLS_WINDOW_OPS - 1)) == 0) {
         uint32_t hits = tls->window_hits;
         uint32_t pct = (hits * 100) / TLS_WINDOW_OPS;
-        
+
         /* Warmup protection: Don't enable bypass during first measurement window.
          * Allow at least one refill opportunity before deciding TLS is ineffective. */
         if (tls->window_ops > TLS_WINDOW_OPS && pct < TLS_MIN_HIT_PCT) {
@@ -63,31 +213,47 @@ static inline void tls_record_alloc(TLSCache* tls, int hit) {
             tls->bypass_alloc = 1;
             tls->bypass_ends_at = tls->window_ops + TLS_BYPASS_OPS;
         }
-        
+
         tls->window_hits = 0;
     }
 }
 
+/* ------------------------------ Alloc / refill ------------------------------ */
+
 void* tls_try_alloc(SlabAllocator* a, uint32_t sc, uint32_t epoch_id, SlabHandle* out_h) {
-    if (_tls_bypass) return NULL;  /* Skip TLS during epoch flush */
-    
-    if (!_tls_initialized) {
+    TLSThread* t = _tls_self;
+    if (!t) {
         tls_init_thread();
+        t = _tls_self;
+        if (!t) return NULL;
     }
-    
-    TLSCache* tls = &_tls_cache[sc];
+
+    /* Pending flush request: sweep our own stale bins first (rare) */
+    if (t->flush_seen != atomic_load_explicit(&_tls_flush_seq, memory_order_relaxed)) {
+        tls_service_flush(t);
+    }
+
+    TLSCache* tls = &t->caches[sc];
     tls->tls_alloc_attempts++;
-    
+
     /* HARD BYPASS: first instruction after cache lookup */
-    if (tls->bypass_alloc) {
+    if (tls_should_bypass_alloc(tls)) {
         tls->tls_alloc_bypassed++;
         return NULL;
     }
-    
-    /* Fast path: TLS cache hit */
-    if (tls->count > 0) {
-        TLSItem item = tls->items[tls->count - 1];
-        
+
+    for (uint32_t b = 0; b < TLS_EPOCH_BINS; b++) {
+        TLSBin* bin = &tls->bins[b];
+        if (bin->count == 0 || bin->epoch_id != epoch_id || !tls_bin_owned_by(bin, a)) continue;
+
+        /* Epoch flushed since refill (closed+reopened, or bulk-released):
+         * the handles may already be invalid - drop the bin, treat as miss */
+        if (atomic_load_explicit(&a->tls_flush_gen[epoch_id], memory_order_acquire) != bin->flush_gen) {
+            tls_drop_bin(bin);
+            tls->tls_epoch_rejects++;
+            break;
+        }
+
 #if TLS_DEBUG_VALIDATE
         /* Debug: assert one-shot invariant */
         if (tls->tls_popped > tls->tls_refilled_added) {
@@ -96,34 +262,24 @@ void* tls_try_alloc(SlabAllocator* a, uint32_t sc, uint32_t epoch_id, SlabHandle
             abort();
         }
 #endif
-        
-        /* Epoch check: reject stale cached handles from closed epochs */
-        if (item.h != 0 && item.epoch_id == epoch_id) {
-            /* Valid entry - consume it (one-shot pop) */
-            tls->count--;
-            tls->tls_popped++;
-            *out_h = item.h;
-            tls->tls_alloc_hits++;
-            tls_record_alloc(tls, 1);  /* Count as hit */
-            
+
+        /* Valid entry - consume it (one-shot pop) */
+        TLSItem item = bin->items[--bin->count];
+        tls->tls_popped++;
+        if (out_h) *out_h = item.h;  /* Optional, as for the global path */
+        tls->tls_alloc_hits++;
+        bin->last_use = tls->window_ops;
+        tls_record_alloc(tls, 1);  /* Count as hit */
+
 #if TLS_DEBUG_VALIDATE
-            /* Poison consumed entry to detect double-use */
-            tls->items[tls->count].h = 0xDEADBEEFDEADBEEFULL;
-            tls->items[tls->count].p = (void*)0xDEADBEEFDEADBEEFULL;
-            tls->items[tls->count].epoch_id = 0xDEADBEEF;
+        /* Poison consumed entry to detect double-use */
+        bin->items[bin->count].h = 0xDEADBEEFDEADBEEFULL;
+        bin->items[bin->count].p = (void*)0xDEADBEEFDEADBEEFULL;
 #endif
-            
-            return item.p;  /* Zero-overhead return: no unpack, no validation */
-        }
-        
-        /* Entry failed validation (wrong epoch) - discard it and treat as miss */
-        if (tls->count > 0 && item.epoch_id != epoch_id) {
-            tls->count--;
-            tls->tls_popped++;
-            tls->tls_epoch_rejects++;
-        }
+
+        return item.p;  /* Zero-overhead return: no unpack, no validation */
     }
-    
+
     /* Cache miss: fall through to global allocator */
     tls_record_alloc(tls, 0);
     return NULL;
@@ -131,116 +287,141 @@ void* tls_try_alloc(SlabAllocator* a, uint32_t sc, uint32_t epoch_id, SlabHandle
 
 bool tls_try_free(SlabAllocator* a, uint32_t sc, SlabHandle h) {
     /* TLS free caching disabled - always return false to use global free path.
-     * 
+     *
      * Why: Caching frees locally creates metadata divergence. The global allocator
      * believes slots are allocated when TLS has them cached, causing:
      * - Slabs appear artificially full (free_count=0, but slots in TLS cache)
      * - Zombie partial slabs (metadata lies about availability)
      * - Global selection logic breaks
-     * 
+     *
      * Solution: TLS alloc-only caching. Frees always update global state. */
     (void)a; (void)sc; (void)h;
     return false;
 }
 
-void tls_refill(SlabAllocator* a, uint32_t sc, uint32_t epoch_id) {
-    TLSCache* tls = &_tls_cache[sc];
-    
+/* Pick the bin to refill for (a, epoch): an unused bin, else one of a's own
+ * bins (stale first, then least recently used). Bins of other allocators are
+ * never evicted here - their allocator may be gone, and checking would need
+ * the registry lock on the refill path. */
+static TLSBin* tls_pick_bin(TLSCache* tls, SlabAllocator* a) {
+    TLSBin* victim = NULL;
+    for (uint32_t b = 0; b < TLS_EPOCH_BINS; b++) {
+        TLSBin* bin = &tls->bins[b];
+        if (!bin->alloc || bin->count == 0) return bin;
+        if (!tls_bin_owned_by(bin, a)) continue;
+        if (tls_bin_stale(bin)) return bin;
+        if (!victim || (int32_t)(bin->last_use - victim->last_use) < 0) victim = bin;
+    }
+    if (victim) tls->tls_bin_evictions++;
+    return victim;
+}
+
+/* Handles per refill of a class. A fixed TLS_REFILL_BATCH would carve two
+ * or three slabs for one allocation of a large class (32 x 16KB) and park
+ * them in this thread's bin, so it is capped at one slab's worth of slots
+ * and at TLS_REFILL_BYTES of objects. */
+static uint32_t tls_refill_count(uint32_t object_size) {
+    uint32_t n = TLS_REFILL_BATCH;
+    uint32_t per_slab = slab_object_count(object_size);
+    if (per_slab < n) n = per_slab;
+    uint32_t by_bytes = TLS_REFILL_BYTES / object_size;
+    if (by_bytes < n) n = by_bytes;
+    return n > 0 ? n : 1;
+}
+
+bool tls_refill(SlabAllocator* a, uint32_t sc, uint32_t epoch_id) {
+    TLSThread* t = _tls_self;
+    if (!t) return false;
+    TLSCache* tls = &t->caches[sc];
+    if (tls->bypass_alloc) return false;
+
+    TLSBin* bin = tls_pick_bin(tls, a);
+    if (!bin) return false;
+    if (bin->alloc && bin->count > 0) tls_drop_bin(bin);  /* a's own bin: a is alive */
+
+    /* Snapshot the flush generation BEFORE claiming slots: a close that lands
+     * mid-refill changes it, and the batch is handed straight back below. */
+    uint32_t gen = atomic_load_explicit(&a->tls_flush_gen[epoch_id], memory_order_acquire);
+
     /* Set flag to prevent recursive TLS lookup during refill */
     _tls_in_refill = true;
-    
-    for (uint32_t i = 0; i < TLS_REFILL_BATCH && tls->count < TLS_CACHE_CAP; i++) {
-        SlabHandle h;
-        SizeClassAlloc* sca = &a->classes[sc];
-        uint32_t size = sca->object_size;
-        void* ptr = alloc_obj_epoch(a, size, epoch_id, &h);
-        
-        if (!ptr) break;
-        
-        /* Re-check epoch state before caching.
-         * Race: epoch_close() could have marked CLOSING after our initial check.
-         * If so, free immediately instead of caching to prevent zombie slabs. */
-        uint32_t state = atomic_load_explicit(&a->epoch_state[epoch_id], memory_order_acquire);
-        if (state != EPOCH_ACTIVE) {
-            free_obj(a, h);
-            break;
-        }
-        
-        /* Store handle, pointer, and epoch for validation at pop time */
-        tls->items[tls->count].h = h;
-        tls->items[tls->count].p = ptr;
-        tls->items[tls->count].epoch_id = epoch_id;
-        tls->count++;
+
+    /* One batch call: slots claimed several per bitmap CAS */
+    void* ptrs[TLS_REFILL_BATCH];
+    SlabHandle hs[TLS_REFILL_BATCH];
+    const uint32_t size = a->classes[sc].object_size;
+    uint32_t got = alloc_obj_epoch_batch(a, size, epoch_id, ptrs, hs, tls_refill_count(size));
+
+    /* Re-check epoch state before caching.
+     * Race: epoch_close() could have marked CLOSING after our initial check.
+     * If so, free immediately instead of caching to prevent zombie slabs. */
+    uint32_t state = atomic_load_explicit(&a->epoch_state[epoch_id], memory_order_acquire);
+    if (state != EPOCH_ACTIVE || atomic_load_explicit(&a->tls_flush_gen[epoch_id], memory_order_acquire) != gen) {
+        free_obj_batch(a, hs, got);
+        got = 0;
+    }
+
+    bin->alloc = a;
+    bin->alloc_instance = a->tls_instance;
+    bin->epoch_id = epoch_id;
+    bin->flush_gen = gen;
+    bin->last_use = tls->window_ops;
+    bin->count = 0;
+    for (uint32_t i = 0; i < got; i++) {
+        /* Store handle and pointer; the bin carries the epoch */
+        bin->items[bin->count].h = hs[i];
+        bin->items[bin->count].p = ptrs[i];
+        bin->count++;
         tls->tls_refilled_added++;
     }
-    
+    if (got == 0) bin->alloc = NULL;
+
     tls->tls_alloc_refills++;
     _tls_in_refill = false;
+    return got > 0;
 }
 
-void tls_flush_batch(SlabAllocator* a, uint32_t sc, uint32_t batch_size) {
-    TLSCache* tls = &_tls_cache[sc];
-    
-    uint32_t to_flush = (batch_size < tls->count) ? batch_size : tls->count;
-    
-    for (uint32_t i = 0; i < to_flush; i++) {
-        free_obj(a, tls->items[--tls->count].h);
-    }
-}
+/* ------------------------------ Epoch flush ------------------------------ */
 
-void tls_flush_epoch_all_threads(SlabAllocator* a, uint32_t epoch_id) {
-    pthread_mutex_lock(&_thread_registry_lock);
-    
-    /* Bypass TLS caching during flush to prevent deadlock.
-     * If free_obj() tried to call tls_try_free(), it would attempt to acquire
-     * _thread_registry_lock again (for thread init), causing deadlock. */
-    _tls_bypass = true;
-    
-    for (uint32_t t = 0; t < _thread_count; t++) {
-        TLSCache* caches = _thread_registry[t].caches;
-        
-        for (uint32_t sc = 0; sc < 8; sc++) {
-            TLSCache* tls = &caches[sc];
-            
-            /* Flush handles from this epoch */
-            for (uint32_t i = 0; i < tls->count; ) {
-                uint32_t item_epoch = (uint32_t)(tls->items[i].h >> 32);
-                if (item_epoch == epoch_id) {
-                    free_obj(a, tls->items[i].h);
-                    
-                    /* Remove by swapping with last item */
-                    tls->items[i] = tls->items[--tls->count];
-                } else {
-                    i++;
-                }
-            }
-        }
-    }
-    
-    _tls_bypass = false;
-    pthread_mutex_unlock(&_thread_registry_lock);
+/* Closer-side half of the flush handshake.
+ *
+ * O(1) regardless of thread count: bump the epoch's flush generation (every
+ * bin of it is now stale and will never serve another allocation) and the
+ * global request sequence. Each owner drops its stale bins at its next
+ * alloc; exiting threads drop theirs in tls_thread_exit(). No thread ever
+ * reads or writes another thread's bins.
+ *
+ * Consequence: slots parked in the bins of idle threads are not free when
+ * epoch_close() scans. They are returned when the owner next allocates (or
+ * exits), at which point free_obj() recycles the slab or the next close of
+ * this ring slot picks it up. At most TLS_BIN_CAP slots per thread per class.
+ */
+void tls_request_epoch_flush(SlabAllocator* a, uint32_t epoch_id) {
+    atomic_fetch_add_explicit(&a->tls_flush_gen[epoch_id], 1, memory_order_release);
+    atomic_fetch_add_explicit(&_tls_flush_seq, 1, memory_order_release);
 }
 
 void tls_print_stats(void) {
-    pthread_mutex_lock(&_thread_registry_lock);
-    
+    pthread_rwlock_rdlock(&_thread_registry_lock);
+
     printf("\n=== TLS Cache Statistics ===\n");
-    
-    /* Aggregate across all threads and size classes (alloc only) */
-    uint64_t total_alloc_attempts = 0;
-    uint64_t total_alloc_bypassed = 0;
-    uint64_t total_alloc_hits = 0;
-    uint64_t total_alloc_refills = 0;
-    uint64_t total_popped = 0;
-    uint64_t total_refilled_added = 0;
-    uint64_t total_epoch_rejects = 0;
-    
-    for (uint32_t t = 0; t < _thread_count; t++) {
-        TLSCache* caches = _thread_registry[t].caches;
-        
-        for (uint32_t sc = 0; sc < 8; sc++) {
-            TLSCache* tls = &caches[sc];
-            
+
+    /* Aggregate across all threads (live and exited) and size classes (alloc only) */
+    uint64_t total_alloc_attempts = g_retired_stats[0];
+    uint64_t total_alloc_bypassed = g_retired_stats[1];
+    uint64_t total_alloc_hits = g_retired_stats[2];
+    uint64_t total_alloc_refills = g_retired_stats[3];
+    uint64_t total_popped = g_retired_stats[4];
+    uint64_t total_refilled_added = g_retired_stats[5];
+    uint64_t total_epoch_rejects = g_retired_stats[6];
+    uint64_t total_bin_evictions = g_retired_stats[7];
+    uint64_t exited = g_retired_stats[8];
+    uint32_t live = _thread_count;
+
+    for (TLSThread* t = _thread_registry; t; t = t->next) {
+        for (uint32_t sc = 0; sc < SLAB_MAX_CLASSES; sc++) {
+            TLSCache* tls = &t->caches[sc];
+
             total_alloc_attempts += tls->tls_alloc_attempts;
             total_alloc_bypassed += tls->tls_alloc_bypassed;
             total_alloc_hits += tls->tls_alloc_hits;
@@ -248,27 +429,29 @@ void tls_print_stats(void) {
             total_popped += tls->tls_popped;
             total_refilled_added += tls->tls_refilled_added;
             total_epoch_rejects += tls->tls_epoch_rejects;
+            total_bin_evictions += tls->tls_bin_evictions;
         }
     }
-    
-    pthread_mutex_unlock(&_thread_registry_lock);
-    
+
+    pthread_rwlock_unlock(&_thread_registry_lock);
+
     /* Print aggregate summary */
-    double hit_rate = total_alloc_attempts > 0 
-        ? (100.0 * total_alloc_hits) / total_alloc_attempts 
+    double hit_rate = total_alloc_attempts > 0
+        ? (100.0 * total_alloc_hits) / total_alloc_attempts
         : 0.0;
     double bypass_rate = total_alloc_attempts > 0
         ? (100.0 * total_alloc_bypassed) / total_alloc_attempts
         : 0.0;
-    
+
+    printf("Threads: live=%u exited=%lu\n", live, exited);
     printf("Alloc: attempts=%lu bypassed=%lu (%.1f%%) hits=%lu (%.1f%%) refills=%lu\n",
            total_alloc_attempts, total_alloc_bypassed, bypass_rate,
            total_alloc_hits, hit_rate, total_alloc_refills);
-    printf("Free:  TLS disabled (metadata divergence - see slab_alloc.c:1779)\n");
+    printf("Free:  TLS disabled (metadata divergence - see free_obj())\n");
     printf("\nOne-shot invariant: popped=%lu added=%lu (delta=%ld)\n",
-           total_popped, total_refilled_added, 
+           total_popped, total_refilled_added,
            (int64_t)total_refilled_added - (int64_t)total_popped);
-    printf("Epoch rejects: %lu (stale cached handles discarded)\n", total_epoch_rejects);
+    printf("Epoch bins dropped: %lu (flushed epochs)  evicted: %lu\n", total_epoch_rejects, total_bin_evictions);
     printf("=============================\n\n");
 }
 
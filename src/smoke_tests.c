@@ -3,18 +3,47 @@
  * 
  * Basic correctness tests:
  * - Single-threaded alloc/free
- * - Multi-threaded alloc/free (8 threads x 500K ops)
+ * - Multi-threaded alloc/free (8 threads x 500K ops, striped counter totals)
+ * - Per-CPU current_partial slots (slot per CPU, claimed slabs passed over)
+ * - Arena carving (slabs bump-allocated from aligned reservations)
+ * - Large-object tier (multi-page slabs, epoch_close reclamation)
+ * - Lock-free slab cache under concurrent recycle/reuse
+ * - Background reclaimer (epoch_close_async, budget, callbacks)
+ * - Batched / lazy page return (range coalescing, MADV_FREE)
+ * - Remote-free lists (deferred cross-thread frees, producer/consumer)
+ * - Segmented slab registry (lookups during growth, ID reuse, handle v2)
+ * - Bump allocation from fresh slabs (reserve retire on first free)
+ * - Bitmap free-word scan (2/3/8-word bitmaps, sequential and randomized)
+ * - Latency histograms (bucket math; recording in ENABLE_LATENCY_HIST builds)
+ * - Shared-memory stats segment (publish, attach, seqlock read, publisher thread)
+ * - Concurrent per-request epochs (advance/close racing allocation and free)
+ * - Domain-bound allocation (epoch_domain_alloc vs closed / reopened epochs)
+ * - Epoch compaction (relocation, forwarded deref/free, release of forwards)
+ * - Adaptive slab cache target, idle trimming, soft memory budget
+ * - Per-label slab accounting and quotas (EDQUOT refusal, callback)
+ * - Empty-slab list (reuse before new slabs, epoch_close visits only empties)
+ * - Allocation trace capture (file header, per-thread clocks, alloc/free order)
+ * - Page geometry (release units vs OS page, huge-page arenas returned whole)
+ * - Shard groups (handle routing, cross-shard frees, depot, merged stats)
+ * - TLS builds: thread registry churn and async epoch-bin flush
  * - Simple micro-benchmark
  */
 
 #define _GNU_SOURCE
 #include "slab_alloc_internal.h"
+#include "slab_stats.h"
+#include "epoch_domain.h"
+#include "slab_trace.h"
+#include "slab_group.h"
 #include <errno.h>
 #include <inttypes.h>
 #include <pthread.h>
+#include <sched.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <unistd.h>
 
 /* ------------------------------ Single-thread smoke test ------------------------------ */
 
@@ -123,10 +152,2792 @@ void smoke_test_multi_thread(void) {
     }
   }
 
+#if !ENABLE_TLS_CACHE
+  /* Per-CPU counter stripes must add up to every free, whichever CPU ran it */
+  for (uint32_t ci = 0; ci < a.num_classes; ci++) {
+    if (a.classes[ci].object_size != 128) continue;
+    SlabClassStats cs;
+    slab_stats_class(&a, ci, &cs);
+    if (cs.bitmap_free_attempts != (uint64_t)threads * (uint64_t)iters_per) {
+      fprintf(stderr, "striped counters: bitmap_free_attempts %" PRIu64 ", expected %" PRIu64 "\n",
+              cs.bitmap_free_attempts, (uint64_t)threads * (uint64_t)iters_per);
+      exit(1);
+    }
+  }
+#endif
+
   allocator_destroy(&a);
   printf("smoke_test_multi_thread: OK (%d threads x %d iters)\n", threads, iters_per);
 }
 
+/* ------------------------------ Per-CPU current_partial ------------------------------ */
+
+/* Small-class slabs are aligned to their size */
+static Slab* percpu_slab_of(SizeClassAlloc* sc, void* p) {
+  return (Slab*)((uintptr_t)p & ~(uintptr_t)(sc->slab_bytes - 1u));
+}
+
+static bool pin_self(int cpu) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0 && sched_getcpu() == cpu;
+}
+
+typedef struct PercpuArgs {
+  SlabAllocator* alloc;
+  EpochId epoch;
+  int cpu;
+  void* p;
+  SlabHandle h;
+} PercpuArgs;
+
+static void* percpu_pinned_worker(void* arg) {
+  PercpuArgs* pa = (PercpuArgs*)arg;
+  if (!pin_self(pa->cpu)) return (void*)1;
+  pa->p = alloc_obj_epoch(pa->alloc, 128, pa->epoch, &pa->h);
+  return pa->p ? NULL : (void*)1;
+}
+
+static void percpu_run_pinned(PercpuArgs* pa) {
+  pthread_t th;
+  void* ret = (void*)1;
+  if (pthread_create(&th, NULL, percpu_pinned_worker, pa) != 0 || pthread_join(th, &ret) != 0 || ret) {
+    fprintf(stderr, "percpu: worker pinned to CPU %d failed\n", pa->cpu);
+    exit(1);
+  }
+}
+
+/* Slot choice and slow-path placement. Another CPU's claim is simulated
+ * by publishing a slab into a second slot, so this part runs on one CPU;
+ * two threads pinned to different CPUs are checked when the host has them.
+ * Run with GLIBC_TUNABLES=glibc.pthread.rseq=0 to take the sched_getcpu()
+ * path instead of rseq. */
+void smoke_test_percpu_slots(void) {
+#if ENABLE_TLS_CACHE
+  /* Refills claim whole batches, so slabs don't fill in order */
+  printf("smoke_test_percpu_slots: SKIP (TLS cache build)\n");
+  return;
+#endif
+  if (SLAB_PERCPU_SLOTS < 2) {
+    printf("smoke_test_percpu_slots: SKIP (SLAB_PERCPU_SLOTS=1)\n");
+    return;
+  }
+  const uint32_t mask = SLAB_PERCPU_SLOTS - 1u;
+  SlabAllocator* a = slab_allocator_create();
+  if (!a) exit(1);
+  SizeClassAlloc* sc = &a->classes[a->class_lookup[128]];
+  const uint32_t per_slab = slab_object_count(128);
+
+  /* Stay on one CPU so the slot doesn't move under the checks below */
+  cpu_set_t saved;
+  if (pthread_getaffinity_np(pthread_self(), sizeof(saved), &saved) != 0) exit(1);
+  const int cpu = sched_getcpu();
+  const bool pinned = cpu >= 0 && pin_self(cpu);
+
+  /* Three full slabs, filled in order; only this thread's slot is used */
+  EpochId e = epoch_current(a);
+  EpochState* es = &sc->epochs[epoch_slot(a, e)];
+  const uint32_t N = 3u * per_slab;
+  SlabHandle* hs = (SlabHandle*)calloc(N + 2u, sizeof(SlabHandle));
+  if (!hs) exit(1);
+  void* first = alloc_obj_epoch(a, 128, e, &hs[0]);
+  if (!first) exit(1);
+  uint32_t mine = SLAB_PERCPU_SLOTS;
+  for (uint32_t i = 0; i < SLAB_PERCPU_SLOTS; i++) {
+    if (atomic_load(&es->current_partial[i]) == NULL) continue;
+    if (mine != SLAB_PERCPU_SLOTS) exit(1);
+    mine = i;
+  }
+  if (mine == SLAB_PERCPU_SLOTS || (pinned && mine != ((uint32_t)cpu & mask))) {
+    fprintf(stderr, "percpu: first slab published in slot %u on CPU %d\n", mine, cpu);
+    exit(1);
+  }
+  void* mid = NULL;
+  void* last = NULL;
+  for (uint32_t i = 1; i < N; i++) {
+    void* p = alloc_obj_epoch(a, 128, e, &hs[i]);
+    if (!p) exit(1);
+    if (i == per_slab) mid = p;
+    if (i == N - 1u) last = p;
+  }
+  Slab* sa = percpu_slab_of(sc, first);
+  Slab* sb = percpu_slab_of(sc, mid);
+  Slab* sz = percpu_slab_of(sc, last);
+  if (sa == sb || sb == sz || sa == sz || es->partial.head != NULL) exit(1);
+
+  /* Reopen a and b (a first on the partial list); hand a to another slot */
+  if (!free_obj(a, hs[0]) || !free_obj(a, hs[per_slab])) exit(1);
+  if (es->partial.head != sa || sa->next != sb) exit(1);
+  const uint32_t other = (mine + 1u) & mask;
+  atomic_store(&es->current_partial[other], sa);
+  atomic_store(&es->current_partial[mine], NULL);
+
+  /* Slow path passes over the claimed head for the unpublished slab */
+  void* p = alloc_obj_epoch(a, 128, e, &hs[N]);
+  if (!p || percpu_slab_of(sc, p) != sb || atomic_load(&es->current_partial[other]) != sa) {
+    fprintf(stderr, "percpu: slow path took %p (claimed %p, unclaimed %p)\n",
+            p ? (void*)percpu_slab_of(sc, p) : NULL, (void*)sa, (void*)sb);
+    exit(1);
+  }
+
+  /* Every partial slab claimed elsewhere: this slot gets its own slab */
+  atomic_store(&es->current_partial[mine], NULL);
+  p = alloc_obj_epoch(a, 128, e, &hs[N + 1u]);
+  Slab* sd = p ? percpu_slab_of(sc, p) : NULL;
+  if (!sd || sd == sa || sd == sb || sd == sz || atomic_load(&es->current_partial[mine]) != sd ||
+      atomic_load(&es->current_partial[other]) != sa) {
+    fprintf(stderr, "percpu: fresh-slab fallback took %p\n", (void*)sd);
+    exit(1);
+  }
+  hs[0] = hs[per_slab] = 0;
+  for (uint32_t i = 0; i < N + 2u; i++) {
+    if (hs[i] && !free_obj(a, hs[i])) exit(1);
+  }
+  epoch_close(a, e);
+
+  /* Two threads pinned to CPUs that map to different slots */
+  int cpus[2] = { -1, -1 };
+  for (int c = 0, n = 0; c < CPU_SETSIZE && n < 2; c++) {
+    if (!CPU_ISSET(c, &saved)) continue;
+    if (n == 1 && ((uint32_t)c & mask) == ((uint32_t)cpus[0] & mask)) continue;
+    cpus[n++] = c;
+  }
+  bool two = cpus[1] >= 0;
+  if (two) {
+    epoch_advance(a);
+    PercpuArgs pa[2];
+    for (int t = 0; t < 2; t++) {
+      pa[t] = (PercpuArgs){ .alloc = a, .epoch = epoch_current(a), .cpu = cpus[t] };
+      percpu_run_pinned(&pa[t]);
+    }
+    es = &sc->epochs[epoch_slot(a, pa[0].epoch)];
+    Slab* s0 = percpu_slab_of(sc, pa[0].p);
+    Slab* s1 = percpu_slab_of(sc, pa[1].p);
+    if (s0 == s1 || atomic_load(&es->current_partial[(uint32_t)cpus[0] & mask]) != s0 ||
+        atomic_load(&es->current_partial[(uint32_t)cpus[1] & mask]) != s1) {
+      fprintf(stderr, "percpu: CPUs %d and %d share slab %p\n", cpus[0], cpus[1], (void*)s0);
+      exit(1);
+    }
+    if (!free_obj(a, pa[0].h) || !free_obj(a, pa[1].h)) exit(1);
+  }
+
+  pthread_setaffinity_np(pthread_self(), sizeof(saved), &saved);
+  free(hs);
+  slab_allocator_free(a);
+  if (two) {
+    printf("smoke_test_percpu_slots: PASS (slot %u, claimed head skipped, CPUs %d/%d on separate slabs)\n",
+           mine, cpus[0], cpus[1]);
+  } else {
+    printf("smoke_test_percpu_slots: PASS (slot %u, claimed head skipped; one CPU, pinned pair skipped)\n",
+           mine);
+  }
+}
+
+/* ------------------------------ Arena carving test ------------------------------ */
+
+void smoke_test_arena_carving(void) {
+  SlabAllocator a;
+  allocator_init(&a);
+
+  SizeClassAlloc* sc = NULL;
+  for (size_t c = 0; c < 8; c++) {
+    if (a.classes[c].object_size == 128) sc = &a.classes[c];
+  }
+  if (!sc) exit(1);
+  const uint32_t per_slab = slab_object_count(128);
+  const uint32_t slabs_per_arena = SLAB_ARENA_SIZE / SLAB_PAGE_SIZE;
+
+  /* Enough objects to spill into a second arena */
+  const int N = (int)(per_slab * (slabs_per_arena + 1));
+  SlabHandle* hs = (SlabHandle*)calloc((size_t)N, sizeof(SlabHandle));
+  if (!hs) exit(1);
+
+  for (int i = 0; i < N; i++) {
+    if (!alloc_obj_epoch(&a, 128, 0, &hs[i])) {
+      fprintf(stderr, "arena alloc failed at %d (errno=%d)\n", i, errno);
+      exit(1);
+    }
+  }
+
+  uint64_t slabs = atomic_load(&sc->new_slab_count);
+  uint64_t arenas = atomic_load(&sc->arena_count);
+  uint64_t reserved = atomic_load(&sc->arena_reserved_bytes);
+  uint64_t carved = atomic_load(&sc->arena_committed_bytes);
+
+  if (arenas != 2 || reserved != 2u * SLAB_ARENA_SIZE || carved != slabs * sc->slab_bytes) {
+    fprintf(stderr, "arena accounting mismatch: arenas=%" PRIu64 " reserved=%" PRIu64
+            " carved=%" PRIu64 " slabs=%" PRIu64 "\n", arenas, reserved, carved, slabs);
+    exit(1);
+  }
+
+  /* Every arena is aligned to its own size and carved front to back;
+   * per-node carve counters add up to the class total */
+  uint64_t node_carved = 0;
+  for (uint32_t n = 0; n < a.numa_nodes; n++) {
+    node_carved += atomic_load(&sc->pools[n].slabs_carved);
+    for (SlabArena* ar = sc->pools[n].arenas; ar; ar = ar->next) {
+      if (((uintptr_t)ar->base & (SLAB_ARENA_SIZE - 1u)) != 0 || ar->carved_bytes > ar->reserved_bytes) {
+        fprintf(stderr, "bad arena base=%p carved=%zu\n", (void*)ar->base, ar->carved_bytes);
+        exit(1);
+      }
+    }
+  }
+  if (node_carved != slabs) {
+    fprintf(stderr, "numa carve mismatch: nodes=%" PRIu64 " total=%" PRIu64 "\n", node_carved, slabs);
+    exit(1);
+  }
+
+  for (int i = 0; i < N; i++) {
+    if (!free_obj(&a, hs[i])) {
+      fprintf(stderr, "arena free failed at %d\n", i);
+      exit(1);
+    }
+  }
+
+  free(hs);
+  allocator_destroy(&a);
+
+  printf("smoke_test_arena_carving: OK\n");
+}
+
+/* ------------------------------ Large-object tier test ------------------------------ */
+
+void smoke_test_large_objects(void) {
+  SlabAllocator a;
+  allocator_init(&a);
+
+  const uint32_t sizes[] = {769, 1024, 1500, 2048, 4096, 6000, 8192, 16384};
+  const int N = 200;
+  SlabHandle* hs = (SlabHandle*)calloc((size_t)N, sizeof(SlabHandle));
+  if (!hs) exit(1);
+
+  for (size_t k = 0; k < sizeof(sizes) / sizeof(sizes[0]); k++) {
+    EpochId e = epoch_current(&a);
+
+    for (int i = 0; i < N; i++) {
+      void* p = alloc_obj_epoch(&a, sizes[k], e, &hs[i]);
+      if (!p) {
+        fprintf(stderr, "large alloc %u failed at %d (errno=%d)\n", sizes[k], i, errno);
+        exit(1);
+      }
+      memset(p, (unsigned char)(i & 0xFF), sizes[k]);
+    }
+
+    /* Multi-page slabs must be aligned to their own size and hold >1 object */
+    SizeClassAlloc* sc = NULL;
+    for (size_t c = 0; c < SLAB_NUM_CLASSES; c++) {
+      if (a.classes[c].object_size >= sizes[k]) { sc = &a.classes[c]; break; }
+    }
+    if (!sc || sc->slab_bytes <= SLAB_PAGE_SIZE || slab_object_count(sc->object_size) < 2) {
+      fprintf(stderr, "size %u did not land in a multi-page class\n", sizes[k]);
+      exit(1);
+    }
+    for (uint32_t slot = 0; slot < SLAB_PERCPU_SLOTS; slot++) {
+      Slab* s = atomic_load(&sc->epochs[SLAB_EPOCH_INDEX(e)].current_partial[slot]);
+      if (s && ((uintptr_t)s & (sc->slab_bytes - 1u)) != 0) {
+        fprintf(stderr, "slab %p not aligned to %u\n", (void*)s, sc->slab_bytes);
+        exit(1);
+      }
+    }
+
+    for (int i = 0; i < N; i++) {
+      if (!free_obj(&a, hs[i])) {
+        fprintf(stderr, "large free %u failed at %d\n", sizes[k], i);
+        exit(1);
+      }
+    }
+
+    /* Drained epoch: epoch_close() must recycle the multi-page slabs */
+    uint64_t recycled_before = atomic_load(&sc->empty_slab_recycled) + atomic_load(&sc->empty_slab_overflowed);
+    epoch_advance(&a);
+    epoch_close(&a, e);
+    uint64_t recycled_after = atomic_load(&sc->empty_slab_recycled) + atomic_load(&sc->empty_slab_overflowed);
+    if (recycled_after == recycled_before) {
+      fprintf(stderr, "epoch_close recycled no %u-byte slabs\n", sc->object_size);
+      exit(1);
+    }
+  }
+
+  /* Above the largest class is still rejected */
+  SlabHandle h;
+  if (alloc_obj_epoch(&a, SLAB_MAX_OBJECT_SIZE + 1, 0, &h) != NULL) {
+    fprintf(stderr, "oversized alloc unexpectedly succeeded\n");
+    exit(1);
+  }
+
+  free(hs);
+  allocator_destroy(&a);
+
+  printf("smoke_test_large_objects: OK\n");
+}
+
+/* ------------------------------ Batch API test ------------------------------ */
+
+void smoke_test_batch_api(void) {
+  SlabAllocator a;
+  allocator_init(&a);
+
+  /* Spans several 128B slabs so the batch crosses PARTIAL→FULL transitions */
+  const uint32_t N = 1000;
+  void** ps = (void**)calloc(N, sizeof(void*));
+  SlabHandle* hs = (SlabHandle*)calloc(N, sizeof(SlabHandle));
+  if (!ps || !hs) exit(1);
+
+  uint32_t got = alloc_obj_epoch_batch(&a, 128, 0, ps, hs, N);
+  if (got != N) {
+    fprintf(stderr, "batch alloc returned %u of %u\n", got, N);
+    exit(1);
+  }
+  for (uint32_t i = 0; i < N; i++) {
+    memset(ps[i], (int)(i & 0xFF), 128);
+  }
+  for (uint32_t i = 0; i < N; i++) {
+    if (((uint8_t*)ps[i])[0] != (uint8_t)(i & 0xFF) || ((uint8_t*)ps[i])[127] != (uint8_t)(i & 0xFF)) {
+      fprintf(stderr, "batch objects overlap at %u\n", i);
+      exit(1);
+    }
+  }
+
+  /* Interleave with single-object API: handles are interchangeable */
+  if (!free_obj(&a, hs[0]) || free_obj_batch(&a, &hs[0], 1) != 0) {
+    fprintf(stderr, "single free of batch handle / double free via batch\n");
+    exit(1);
+  }
+
+  /* Reverse order + duplicate: grouped by slab, duplicate counted once */
+  SlabHandle* rev = (SlabHandle*)calloc(N, sizeof(SlabHandle));
+  if (!rev) exit(1);
+  for (uint32_t i = 1; i < N; i++) rev[i - 1] = hs[N - i];
+  rev[N - 1] = hs[1];
+  uint32_t freed = free_obj_batch(&a, rev, N);
+  if (freed != N - 1) {
+    fprintf(stderr, "batch free freed %u, expected %u\n", freed, N - 1);
+    exit(1);
+  }
+
+  /* Everything is free again: re-allocating the same count reuses slabs */
+  uint64_t slabs_before = atomic_load(&a.classes[2].new_slab_count);
+  got = alloc_obj_epoch_batch(&a, 128, 0, ps, hs, N);
+  if (got != N || atomic_load(&a.classes[2].new_slab_count) != slabs_before) {
+    fprintf(stderr, "batch realloc got %u, new slabs %" PRIu64 " -> %" PRIu64 "\n",
+            got, slabs_before, atomic_load(&a.classes[2].new_slab_count));
+    exit(1);
+  }
+  if (free_obj_batch(&a, hs, N) != N) {
+    fprintf(stderr, "batch free after realloc failed\n");
+    exit(1);
+  }
+
+  /* Closed epoch and invalid sizes allocate nothing */
+  epoch_close(&a, 0);
+  if (alloc_obj_epoch_batch(&a, 128, 0, ps, hs, 4) != 0 ||
+      alloc_obj_epoch_batch(&a, SLAB_MAX_OBJECT_SIZE + 1, 1, ps, hs, 4) != 0) {
+    fprintf(stderr, "batch alloc ignored closed epoch / oversized request\n");
+    exit(1);
+  }
+
+  free(rev);
+  free(hs);
+  free(ps);
+  allocator_destroy(&a);
+
+  printf("smoke_test_batch_api: OK\n");
+}
+
+/* ------------------------------ Bulk epoch release test ------------------------------ */
+
+void smoke_test_epoch_release_all(void) {
+  SlabAllocator a;
+  allocator_init(&a);
+
+  /* Mixed classes, nothing freed individually */
+  const int N = 5000;
+  SlabHandle* hs = (SlabHandle*)calloc((size_t)N, sizeof(SlabHandle));
+  if (!hs) exit(1);
+  EpochId e = epoch_current(&a);
+  for (int i = 0; i < N; i++) {
+    uint32_t sz = (i % 3 == 0) ? 64u : (i % 3 == 1) ? 200u : 2048u;
+    void* p = alloc_obj_epoch(&a, sz, e, &hs[i]);
+    if (!p) {
+      fprintf(stderr, "release_all setup alloc failed at %d\n", i);
+      exit(1);
+    }
+    memset(p, 0xCD, sz);
+  }
+
+  size_t slabs = 0;
+  for (size_t c = 0; c < a.num_classes; c++) slabs += a.classes[c].total_slabs;
+
+  size_t released = epoch_release_all(&a, e);
+  if (released != slabs || released == 0) {
+    fprintf(stderr, "epoch_release_all released %zu of %zu slabs\n", released, slabs);
+    exit(1);
+  }
+
+  /* Every outstanding handle is now stale */
+  for (int i = 0; i < N; i++) {
+    if (free_obj(&a, hs[i])) {
+      fprintf(stderr, "stale handle %d freed after epoch_release_all\n", i);
+      exit(1);
+    }
+  }
+
+  /* Epoch is CLOSING; released slabs serve the next epoch from cache */
+  SlabHandle h;
+  if (alloc_obj_epoch(&a, 64, e, &h) != NULL) {
+    fprintf(stderr, "allocation into released epoch succeeded\n");
+    exit(1);
+  }
+  epoch_advance(&a);
+  EpochId e2 = epoch_current(&a);
+  uint64_t fresh_before = 0;
+  for (size_t c = 0; c < a.num_classes; c++) fresh_before += atomic_load(&a.classes[c].new_slab_count);
+  for (int i = 0; i < N; i++) {
+    uint32_t sz = (i % 3 == 0) ? 64u : (i % 3 == 1) ? 200u : 2048u;
+    if (!alloc_obj_epoch(&a, sz, e2, &hs[i])) {
+      fprintf(stderr, "post-release alloc failed at %d\n", i);
+      exit(1);
+    }
+  }
+  uint64_t fresh_after = 0;
+  for (size_t c = 0; c < a.num_classes; c++) fresh_after += atomic_load(&a.classes[c].new_slab_count);
+  if (fresh_after != fresh_before) {
+    fprintf(stderr, "post-release allocs carved %" PRIu64 " new slabs (expected cache reuse)\n",
+            fresh_after - fresh_before);
+    exit(1);
+  }
+  for (int i = 0; i < N; i++) {
+    if (!free_obj(&a, hs[i])) {
+      fprintf(stderr, "free of reused-slab handle %d failed\n", i);
+      exit(1);
+    }
+  }
+
+  free(hs);
+  allocator_destroy(&a);
+
+  printf("smoke_test_epoch_release_all: OK\n");
+}
+
+/* ------------------------------ Lock-free slab cache test ------------------------------ */
+
+typedef struct CacheChurnArgs {
+  SlabAllocator* alloc;
+  _Atomic int* done;
+  int thread_id;
+} CacheChurnArgs;
+
+#define CACHE_CHURN_OBJS   600
+#define CACHE_CHURN_ROUNDS 150
+
+/* Fill ~40 slabs in whatever epoch is current, free them all, repeat.
+ * Emptied slabs are recycled by the main thread's epoch_close() while other
+ * workers pop the same pool in new_slab(). Every exit counts in done: the
+ * main thread rotates epochs until all workers are out, then joins them. */
+static void* worker_cache_churn(void* arg) {
+  CacheChurnArgs* c = (CacheChurnArgs*)arg;
+  void* ret = NULL;
+  SlabHandle* hs = (SlabHandle*)malloc(CACHE_CHURN_OBJS * sizeof(SlabHandle));
+  if (!hs) {
+    ret = (void*)1;
+    goto out;
+  }
+
+  for (int r = 0; r < CACHE_CHURN_ROUNDS; r++) {
+    for (int i = 0; i < CACHE_CHURN_OBJS; i++) {
+      void* p = NULL;
+      /* Epoch may close under us; retry in the new current epoch. Yield
+       * between tries: epoch_current() can name a slot the main thread's
+       * epoch_advance() has not marked ACTIVE yet, and on one CPU it only
+       * gets there if we let it run. */
+      for (int tries = 0; !p && tries < 1000; tries++) {
+        if (tries > 0) sched_yield();
+        p = alloc_obj_epoch(c->alloc, 256, epoch_current(c->alloc), &hs[i]);
+      }
+      if (!p) {
+        fprintf(stderr, "Thread %d: churn alloc failed (errno=%d)\n", c->thread_id, errno);
+        ret = (void*)1;
+        goto out;
+      }
+      memset(p, c->thread_id, 256);
+    }
+    for (int i = 0; i < CACHE_CHURN_OBJS; i++) {
+      if (!free_obj(c->alloc, hs[i])) {
+        fprintf(stderr, "Thread %d: churn free failed at %d\n", c->thread_id, i);
+        ret = (void*)1;
+        goto out;
+      }
+    }
+  }
+
+out:
+  free(hs);
+  atomic_fetch_add(c->done, 1);
+  return ret;
+}
+
+static int cmp_ptr(const void* x, const void* y) {
+  uintptr_t a = (uintptr_t)*(void* const*)x, b = (uintptr_t)*(void* const*)y;
+  return (a > b) - (a < b);
+}
+
+void smoke_test_cache_concurrent(void) {
+  SlabAllocator a;
+  allocator_init(&a);
+
+  const int threads = 4;
+  _Atomic int done = 0;
+  pthread_t th[threads];
+  CacheChurnArgs args[threads];
+  for (int i = 0; i < threads; i++) {
+    args[i].alloc = &a;
+    args[i].done = &done;
+    args[i].thread_id = i;
+    if (pthread_create(&th[i], NULL, worker_cache_churn, &args[i]) != 0) {
+      fprintf(stderr, "pthread_create failed\n");
+      exit(1);
+    }
+  }
+
+  /* Rotate and close trailing epochs until every worker finishes */
+  while (atomic_load(&done) < threads) {
+    epoch_advance(&a);
+    EpochId cur = epoch_current(&a);
+    epoch_close(&a, (cur + a.epoch_count - 2u) % a.epoch_count);
+  }
+  for (int i = 0; i < threads; i++) {
+    void* ret = NULL;
+    pthread_join(th[i], &ret);
+    if (ret != NULL) {
+      fprintf(stderr, "cache churn worker %d failed\n", i);
+      exit(1);
+    }
+  }
+  for (uint32_t e = 0; e < a.epoch_count; e++) epoch_close(&a, e);
+
+  /* Quiescent: walk every cache stack. Each carved slab is either on exactly
+   * one epoch list or cached exactly once; nothing lost or duplicated. */
+  uint32_t ci = 0;
+  while (a.classes[ci].object_size < 256) ci++;
+  SizeClassAlloc* sc = &a.classes[ci];
+  uint64_t carved = 0, counted = 0;
+  for (uint32_t n = 0; n < a.numa_nodes; n++) carved += atomic_load(&sc->pools[n].slabs_carved);
+
+  void** seen = (void**)calloc((size_t)carved + 1u, sizeof(void*));
+  if (!seen) exit(1);
+  size_t nseen = 0;
+  for (uint32_t n = 0; n < a.numa_nodes; n++) {
+    SlabNodePool* pool = &sc->pools[n];
+    uint32_t depth = 0;
+    for (uint32_t idx = (uint32_t)atomic_load(&pool->cache_head); idx != SLAB_CACHE_NIL && nseen <= carved; depth++) {
+      uint32_t ord = idx >> SLAB_CACHE_POS_BITS;
+      CachedSlab* node = &pool->arena_dir[ord / SLAB_ARENA_DIR_BLOCK][ord % SLAB_ARENA_DIR_BLOCK]
+                              ->nodes[idx & ((1u << SLAB_CACHE_POS_BITS) - 1u)];
+      seen[nseen++] = node->slab;
+      idx = atomic_load(&node->next);
+    }
+    if (depth != atomic_load(&pool->cache_count)) {
+      fprintf(stderr, "cache stack depth %u != cache_count %u\n", depth, atomic_load(&pool->cache_count));
+      exit(1);
+    }
+  }
+  counted = nseen;
+  for (uint32_t e = 0; e < a.epoch_count; e++) {
+    for (Slab* s = sc->epochs[e].partial.head; s && nseen <= carved; s = s->next) seen[nseen++] = s;
+    for (Slab* s = sc->epochs[e].full.head; s && nseen <= carved; s = s->next) seen[nseen++] = s;
+    for (Slab* s = sc->epochs[e].empty.head; s && nseen <= carved; s = s->next) seen[nseen++] = s;
+  }
+  if (nseen != carved) {
+    fprintf(stderr, "slab census %zu != carved %" PRIu64 " (%" PRIu64 " cached)\n", nseen, carved, counted);
+    exit(1);
+  }
+  qsort(seen, nseen, sizeof(void*), cmp_ptr);
+  for (size_t i = 1; i < nseen; i++) {
+    if (seen[i] == seen[i - 1]) {
+      fprintf(stderr, "slab %p reachable twice\n", seen[i]);
+      exit(1);
+    }
+  }
+
+  free(seen);
+  allocator_destroy(&a);
+  printf("smoke_test_cache_concurrent: OK (%" PRIu64 " slabs, %" PRIu64 " cached)\n", carved, counted);
+}
+
+/* ------------------------------ Background reclaimer test ------------------------------ */
+
+typedef struct ReclaimDone {
+  _Atomic int calls;
+  _Atomic uint32_t epoch;
+} ReclaimDone;
+
+static void on_epoch_reclaimed(SlabAllocator* a, EpochId epoch, void* arg) {
+  (void)a;
+  ReclaimDone* d = (ReclaimDone*)arg;
+  atomic_store(&d->epoch, epoch);
+  atomic_fetch_add(&d->calls, 1);
+}
+
+void smoke_test_reclaimer(void) {
+  SlabAllocator a;
+  allocator_init(&a);
+
+  /* Without a reclaimer: inline close, callback before return */
+  ReclaimDone d = { 0, 0 };
+  if (!epoch_close_async(&a, 3, on_epoch_reclaimed, &d) || atomic_load(&d.calls) != 1 ||
+      !epoch_close_done(&a, 3)) {
+    fprintf(stderr, "inline epoch_close_async did not complete\n");
+    exit(1);
+  }
+
+  /* Tiny budget + long pauses so the close is still running when we retry */
+  SlabReclaimerConfig cfg = { .slice_budget_ns = 1, .pause_us = 20000 };
+  if (!slab_reclaimer_start(&a, &cfg)) {
+    fprintf(stderr, "slab_reclaimer_start failed (errno=%d)\n", errno);
+    exit(1);
+  }
+  if (slab_reclaimer_start(&a, &cfg) || errno != EALREADY) {
+    fprintf(stderr, "second slab_reclaimer_start not rejected\n");
+    exit(1);
+  }
+
+  /* Fill then empty slabs in several classes of epoch 0 */
+  const int N = 3000;
+  SlabHandle* hs = (SlabHandle*)calloc((size_t)N, sizeof(SlabHandle));
+  if (!hs) exit(1);
+  for (int i = 0; i < N; i++) {
+    uint32_t sz = (i % 3 == 0) ? 64u : (i % 3 == 1) ? 512u : 4096u;
+    if (!alloc_obj_epoch(&a, sz, 0, &hs[i])) {
+      fprintf(stderr, "reclaimer setup alloc failed at %d\n", i);
+      exit(1);
+    }
+  }
+  for (int i = 0; i < N; i++) {
+    if (!free_obj(&a, hs[i])) {
+      fprintf(stderr, "reclaimer setup free failed at %d\n", i);
+      exit(1);
+    }
+  }
+
+  uint64_t recycled_before = 0;
+  for (size_t c = 0; c < a.num_classes; c++) recycled_before += atomic_load(&a.classes[c].epoch_close_recycled_slabs);
+
+  memset(&d, 0, sizeof(d));
+  if (!epoch_close_async(&a, 0, on_epoch_reclaimed, &d)) {
+    fprintf(stderr, "epoch_close_async failed (errno=%d)\n", errno);
+    exit(1);
+  }
+  /* Caller-side effect is immediate: the epoch rejects allocations */
+  SlabHandle h;
+  if (alloc_obj_epoch(&a, 64, 0, &h) != NULL) {
+    fprintf(stderr, "allocation into async-closed epoch succeeded\n");
+    exit(1);
+  }
+  if (epoch_close_async(&a, 0, on_epoch_reclaimed, &d) || errno != EBUSY) {
+    fprintf(stderr, "duplicate epoch_close_async not rejected with EBUSY\n");
+    exit(1);
+  }
+
+  for (int spin = 0; !epoch_close_done(&a, 0); spin++) {
+    if (spin > 5000) {
+      fprintf(stderr, "async close of epoch 0 never completed\n");
+      exit(1);
+    }
+    struct timespec ts = { 0, 1000000 };
+    nanosleep(&ts, NULL);
+  }
+  /* pending_mask clears just before the callback runs: stop() joins past it */
+  slab_reclaimer_stop(&a);
+  if (atomic_load(&d.calls) != 1 || atomic_load(&d.epoch) != 0) {
+    fprintf(stderr, "reclaimer callback calls=%d epoch=%u\n", atomic_load(&d.calls), atomic_load(&d.epoch));
+    exit(1);
+  }
+
+  uint64_t recycled_after = 0;
+  for (size_t c = 0; c < a.num_classes; c++) recycled_after += atomic_load(&a.classes[c].epoch_close_recycled_slabs);
+  SlabGlobalStats gs;
+  slab_stats_global(&a, &gs);
+  if (recycled_after <= recycled_before || gs.reclaim_submitted != 1 || gs.reclaim_completed != 1 ||
+      gs.reclaim_budget_pauses == 0 || gs.reclaim_running != 0 || gs.reclaim_pending != 0) {
+    fprintf(stderr, "reclaimer stats: recycled=%" PRIu64 " submitted=%" PRIu64 " completed=%" PRIu64
+            " pauses=%" PRIu64 "\n", recycled_after - recycled_before, gs.reclaim_submitted,
+            gs.reclaim_completed, gs.reclaim_budget_pauses);
+    exit(1);
+  }
+
+  free(hs);
+  allocator_destroy(&a);
+  printf("smoke_test_reclaimer: OK (%" PRIu64 " slabs recycled off-thread, %" PRIu64 " pauses)\n",
+         recycled_after - recycled_before, gs.reclaim_budget_pauses);
+}
+
+/* ------------------------------ Batched / lazy page return ------------------------------ */
+
+/* Mark every slab of (class, epoch) never-published so recycling madvises
+ * them. Only valid single-threaded: nothing else holds slab pointers. */
+static size_t mark_epoch_unpublished(SlabAllocator* a, size_t cls, uint32_t epoch) {
+  EpochState* es = &a->classes[cls].epochs[epoch];
+  size_t n = 0;
+  for (Slab* s = es->partial.head; s; s = s->next, n++) s->was_published = false;
+  for (Slab* s = es->full.head; s; s = s->next, n++) s->was_published = false;
+  for (Slab* s = es->empty.head; s; s = s->next, n++) s->was_published = false;
+  return n;
+}
+
+static void reclaim_mode_round(SlabAllocator* a, uint32_t epoch, SlabClassStats* out) {
+  const int N = 4000;  /* 64B class: ~63 objects per slab -> ~64 slabs */
+  SlabHandle* hs = (SlabHandle*)calloc((size_t)N, sizeof(SlabHandle));
+  if (!hs) exit(1);
+  for (int i = 0; i < N; i++) {
+    if (!alloc_obj_epoch(a, 64, epoch, &hs[i])) {
+      fprintf(stderr, "reclaim mode alloc failed at %d\n", i);
+      exit(1);
+    }
+  }
+  if (mark_epoch_unpublished(a, 0, epoch) < 2) {
+    fprintf(stderr, "reclaim mode test needs several slabs\n");
+    exit(1);
+  }
+  epoch_release_all(a, epoch);
+  slab_stats_class(a, 0, out);
+  free(hs);
+}
+
+void smoke_test_reclaim_modes(void) {
+  SlabAllocatorConfig cfg = { .reclaim_mode = SLAB_RECLAIM_BATCHED };
+  SlabAllocator* a = slab_allocator_create_with_config(&cfg);
+  if (!a) {
+    fprintf(stderr, "create_with_config(BATCHED) failed (errno=%d)\n", errno);
+    exit(1);
+  }
+
+  SlabClassStats cs;
+  reclaim_mode_round(a, 1, &cs);
+  /* Slabs carved back to back coalesce: fewer ranges than slabs returned */
+  uint64_t slabs_returned = cs.madvise_bytes / cs.slab_bytes;
+  if (cs.madvise_batches == 0 || cs.madvise_ranges == 0 || slabs_returned < 2 ||
+      cs.madvise_ranges >= slabs_returned || cs.madvise_failures != 0) {
+    fprintf(stderr, "batched reclaim: batches=%" PRIu64 " ranges=%" PRIu64 " slabs=%" PRIu64 " failures=%" PRIu64 "\n",
+            cs.madvise_batches, cs.madvise_ranges, slabs_returned, cs.madvise_failures);
+    exit(1);
+  }
+
+  /* LAZY at runtime: MADV_FREE through the same batch path */
+  if (!slab_set_reclaim_mode(a, SLAB_RECLAIM_LAZY)) {
+    fprintf(stderr, "slab_set_reclaim_mode(LAZY) failed\n");
+    exit(1);
+  }
+  uint64_t batches_before = cs.madvise_batches;
+  uint64_t bytes_before = cs.madvise_bytes;
+  reclaim_mode_round(a, 2, &cs);
+  if (cs.madvise_batches <= batches_before || cs.madvise_bytes <= bytes_before || cs.madvise_failures != 0) {
+    fprintf(stderr, "lazy reclaim did not return pages\n");
+    exit(1);
+  }
+  SlabGlobalStats gs;
+  slab_stats_global(a, &gs);
+  if (gs.reclaim_mode != SLAB_RECLAIM_LAZY) {
+    fprintf(stderr, "global stats reclaim_mode=%u\n", gs.reclaim_mode);
+    exit(1);
+  }
+
+  /* Recycled slabs are still reusable after a batched return */
+  SlabHandle h;
+  void* p = alloc_obj_epoch(a, 64, 3, &h);
+  if (!p || !free_obj(a, h)) {
+    fprintf(stderr, "alloc after batched return failed\n");
+    exit(1);
+  }
+
+  errno = 0;
+  if (slab_set_reclaim_mode(a, (SlabReclaimMode)99) || errno != EINVAL) {
+    fprintf(stderr, "unknown reclaim mode not rejected\n");
+    exit(1);
+  }
+  SlabAllocatorConfig bad = { .reclaim_mode = (SlabReclaimMode)99 };
+  errno = 0;
+  if (slab_allocator_create_with_config(&bad) != NULL || errno != EINVAL) {
+    fprintf(stderr, "unknown reclaim_mode in config not rejected\n");
+    exit(1);
+  }
+
+  slab_allocator_free(a);
+  printf("smoke_test_reclaim_modes: PASS (ranges=%" PRIu64 " for %" PRIu64 " slabs)\n",
+         cs.madvise_ranges, cs.madvise_bytes / cs.slab_bytes);
+}
+
+/* ------------------------------ Remote-free lists ------------------------------ */
+
+#define RF_RING 1024u
+#define RF_OBJECTS 200000u
+
+typedef struct {
+  SlabAllocator* a;
+  _Atomic uint64_t ring[RF_RING];  /* 0 = empty slot */
+  _Atomic uint32_t failures;
+} RemoteFreeRing;
+
+static void* rf_producer(void* arg) {
+  RemoteFreeRing* r = (RemoteFreeRing*)arg;
+  for (uint32_t i = 0; i < RF_OBJECTS; i++) {
+    SlabHandle h;
+    uint64_t* p = (uint64_t*)alloc_obj_epoch(r->a, 64, 0, &h);
+    if (!p) {
+      atomic_fetch_add(&r->failures, 1);
+      continue;
+    }
+    *p = i;
+    while (atomic_load_explicit(&r->ring[i % RF_RING], memory_order_acquire) != 0) sched_yield();
+    atomic_store_explicit(&r->ring[i % RF_RING], h, memory_order_release);
+  }
+  return NULL;
+}
+
+static void* rf_consumer(void* arg) {
+  RemoteFreeRing* r = (RemoteFreeRing*)arg;
+  for (uint32_t i = 0; i < RF_OBJECTS; i++) {
+    uint64_t h;
+    while ((h = atomic_load_explicit(&r->ring[i % RF_RING], memory_order_acquire)) == 0) sched_yield();
+    atomic_store_explicit(&r->ring[i % RF_RING], 0, memory_order_release);
+    if (!free_obj(r->a, h)) atomic_fetch_add(&r->failures, 1);
+  }
+  return NULL;
+}
+
+void smoke_test_remote_free(void) {
+  SlabAllocatorConfig cfg = { .remote_free = true };
+  SlabAllocator* a = slab_allocator_create_with_config(&cfg);
+  if (!a) exit(1);
+
+  /* Single thread, deterministic: frees into a slab other than the current
+   * one are deferred, and the close absorbs every one of them */
+  SlabHandle hs[400];
+  for (int i = 0; i < 400; i++) {
+    if (!alloc_obj_epoch(a, 64, 1, &hs[i])) exit(1);
+  }
+  for (int i = 0; i < 400; i++) {
+    if (!free_obj(a, hs[i])) {
+      fprintf(stderr, "remote-mode free %d failed\n", i);
+      exit(1);
+    }
+  }
+  /* hs[0]'s slab was full, so that free went direct: its bit is clear */
+  if (free_obj(a, hs[0])) {
+    fprintf(stderr, "remote-path double free of a freed slot accepted\n");
+    exit(1);
+  }
+  SlabClassStats cs;
+  slab_stats_class(a, 0, &cs);
+  if (cs.remote_frees == 0) {
+    fprintf(stderr, "no free took the remote path\n");
+    exit(1);
+  }
+  uint64_t recycled_before = cs.epoch_close_recycled_slabs;
+  epoch_close(a, 1);
+#if ENABLE_TLS_CACHE
+  /* Slots this thread's epoch-1 bin still parks keep a slab non-empty at the
+   * close. The thread's next allocation (another class and epoch, so no
+   * class-0 slab is opened) hands them back; a second close recycles it. */
+  SlabHandle hflush;
+  if (!alloc_obj_epoch(a, 256, 2, &hflush) || !free_obj(a, hflush)) exit(1);
+  epoch_close(a, 1);
+#endif
+  slab_stats_class(a, 0, &cs);
+  if (cs.remote_drained_objects != cs.remote_frees ||
+      cs.epoch_close_recycled_slabs - recycled_before != cs.new_slab_count) {
+    fprintf(stderr, "remote frees not absorbed: frees=%" PRIu64 " drained=%" PRIu64 " recycled=%" PRIu64 "/%" PRIu64 "\n",
+            cs.remote_frees, cs.remote_drained_objects,
+            cs.epoch_close_recycled_slabs - recycled_before, cs.new_slab_count);
+    exit(1);
+  }
+
+  /* Producer/consumer: consumer frees the producer's live slabs */
+  RemoteFreeRing* r = (RemoteFreeRing*)calloc(1, sizeof(RemoteFreeRing));
+  if (!r) exit(1);
+  r->a = a;
+  pthread_t prod, cons;
+  pthread_create(&prod, NULL, rf_producer, r);
+  pthread_create(&cons, NULL, rf_consumer, r);
+  pthread_join(prod, NULL);
+  pthread_join(cons, NULL);
+  if (atomic_load(&r->failures) != 0) {
+    fprintf(stderr, "producer/consumer: %u failures\n", atomic_load(&r->failures));
+    exit(1);
+  }
+  epoch_close(a, 0);
+  slab_stats_class(a, 0, &cs);
+  if (cs.remote_drained_objects != cs.remote_frees) {
+    fprintf(stderr, "producer/consumer: %" PRIu64 " deferred frees never absorbed\n",
+            cs.remote_frees - cs.remote_drained_objects);
+    exit(1);
+  }
+
+  printf("smoke_test_remote_free: PASS (%" PRIu64 " deferred frees in %" PRIu64 " drains, %" PRIu64 " slabs)\n",
+         cs.remote_frees, cs.remote_drains, cs.new_slab_count);
+  free(r);
+  slab_allocator_free(a);
+}
+
+/* ------------------------------ Segmented slab registry ------------------------------ */
+
+typedef struct {
+  SlabAllocator* a;
+  _Atomic int stop;
+  _Atomic uint32_t failures;
+} RegistryChurn;
+
+/* Handle lookups (every free_obj) racing registry growth on another thread */
+static void* registry_churn_worker(void* arg) {
+  RegistryChurn* rc = (RegistryChurn*)arg;
+  SlabHandle hs[64];
+  while (!atomic_load_explicit(&rc->stop, memory_order_acquire)) {
+    for (int i = 0; i < 64; i++) {
+      if (!alloc_obj_epoch(rc->a, 64, 2, &hs[i])) atomic_fetch_add(&rc->failures, 1);
+    }
+    for (int i = 0; i < 64; i++) {
+      if (!free_obj(rc->a, hs[i])) atomic_fetch_add(&rc->failures, 1);
+    }
+  }
+  return NULL;
+}
+
+void smoke_test_registry(void) {
+  SlabAllocator* a = slab_allocator_create();
+  if (!a) exit(1);
+
+  /* Growth: 768B objects are 5 per slab, so 20000 of them need ~4000 slab
+   * IDs, which installs the first three registry segments (1024+2048+4096) */
+  RegistryChurn rc = { .a = a };
+  pthread_t th[4];
+  for (int t = 0; t < 4; t++) pthread_create(&th[t], NULL, registry_churn_worker, &rc);
+
+  const int N = 20000;
+  SlabHandle* hs = (SlabHandle*)calloc((size_t)N, sizeof(SlabHandle));
+  if (!hs) exit(1);
+  for (int i = 0; i < N; i++) {
+    if (!alloc_obj_epoch(a, 768, 1, &hs[i])) {
+      fprintf(stderr, "registry growth alloc failed at %d\n", i);
+      exit(1);
+    }
+  }
+  atomic_store_explicit(&rc.stop, 1, memory_order_release);
+  for (int t = 0; t < 4; t++) pthread_join(th[t], NULL);
+  if (atomic_load(&rc.failures) != 0) {
+    fprintf(stderr, "registry growth: %u alloc/free failures during growth\n", atomic_load(&rc.failures));
+    exit(1);
+  }
+  for (int i = 0; i < N; i++) {
+    if (!free_obj(a, hs[i])) {
+      fprintf(stderr, "registry growth: free %d failed\n", i);
+      exit(1);
+    }
+  }
+
+  SlabGlobalStats gs;
+  slab_stats_global(a, &gs);
+  if (gs.registry_ids_issued <= 3u * REG_SEG_BASE || atomic_load(&a->reg.segs[2]) == NULL) {
+    fprintf(stderr, "registry growth: only %u IDs issued\n", gs.registry_ids_issued);
+    exit(1);
+  }
+
+  /* Reuse: slabs that were never published give their IDs back when cached,
+   * and the next slabs to come out of the cache take them again */
+  const int M = 2000;  /* ~32 slabs of 64B objects */
+  for (int i = 0; i < M; i++) {
+    if (!alloc_obj_epoch(a, 64, 3, &hs[i])) exit(1);
+  }
+  size_t parked = mark_epoch_unpublished(a, 0, 3);
+  SlabHandle stale = hs[0];
+  slab_stats_global(a, &gs);
+  uint32_t issued_before = gs.registry_ids_issued;
+  epoch_release_all(a, 3);
+  slab_stats_global(a, &gs);
+  if (gs.registry_ids_free < parked) {
+    fprintf(stderr, "registry reuse: %u IDs free after parking %zu slabs\n", gs.registry_ids_free, parked);
+    exit(1);
+  }
+  if (free_obj(a, stale)) {
+    fprintf(stderr, "registry reuse: handle into a released ID accepted\n");
+    exit(1);
+  }
+  for (int i = 0; i < M; i++) {
+    if (!alloc_obj_epoch(a, 64, 4, &hs[i])) exit(1);
+  }
+  slab_stats_global(a, &gs);
+  if (gs.registry_ids_recycled == 0 || gs.registry_ids_issued != issued_before) {
+    fprintf(stderr, "registry reuse: recycled=%" PRIu64 " issued %u -> %u\n",
+            gs.registry_ids_recycled, issued_before, gs.registry_ids_issued);
+    exit(1);
+  }
+  if (free_obj(a, stale)) {
+    fprintf(stderr, "registry reuse: stale handle accepted after its ID was reissued\n");
+    exit(1);
+  }
+  for (int i = 0; i < M; i++) {
+    if (!free_obj(a, hs[i])) exit(1);
+  }
+
+  /* Retired v1 handles are rejected outright */
+  if (free_obj(a, (hs[0] & ~(SlabHandle)0x3u) | 0x1u)) {
+    fprintf(stderr, "registry: v1 handle accepted\n");
+    exit(1);
+  }
+
+  printf("smoke_test_registry: PASS (%u IDs issued, %" PRIu64 " recycled)\n",
+         gs.registry_ids_issued, gs.registry_ids_recycled);
+  free(hs);
+  slab_allocator_free(a);
+}
+
+/* ------------------------------ Fresh-slab bump allocation ------------------------------ */
+
+/* Slab header of a small-class object (4KB slabs are aligned to their size) */
+static Slab* bump_slab_of(void* p) {
+  return (Slab*)((uintptr_t)p & ~(uintptr_t)(SLAB_PAGE_SIZE - 1u));
+}
+
+void smoke_test_bump_alloc(void) {
+#if ENABLE_TLS_CACHE
+  /* Refills pull reserve slots into thread bins, so exact counts don't hold */
+  printf("smoke_test_bump_alloc: SKIP (TLS cache build)\n");
+  return;
+#endif
+  SlabAllocator* a = slab_allocator_create();
+  if (!a) exit(1);
+
+  /* Fresh slabs hand out consecutive slots without touching the bitmap path */
+  SlabHandle h0 = 0;
+  void* first = alloc_obj_epoch(a, 64, 1, &h0);
+  if (!first) exit(1);
+  Slab* s = bump_slab_of(first);
+  const uint32_t count = s->object_count;
+  const uint32_t N = count * 3u + count / 2u;  /* Three full slabs and a half */
+  SlabHandle* hs = (SlabHandle*)calloc(N, sizeof(SlabHandle));
+  void** ps = (void**)calloc(N, sizeof(void*));
+  if (!hs || !ps) exit(1);
+  ps[0] = first;
+  hs[0] = h0;
+  for (uint32_t i = 1; i < N; i++) {
+    ps[i] = alloc_obj_epoch(a, 64, 1, &hs[i]);
+    if (!ps[i]) exit(1);
+  }
+  SlabClassStats cs;
+  slab_stats_class(a, 0, &cs);
+  if (cs.bitmap_alloc_attempts != 0 || cs.bump_allocs < 3u * count) {
+    fprintf(stderr, "bump: %" PRIu64 " bitmap allocs, %" PRIu64 " bump allocs on fresh slabs\n",
+            cs.bitmap_alloc_attempts, cs.bump_allocs);
+    exit(1);
+  }
+
+  /* Last slab is half carved: its reserve still owns the upper slots */
+  Slab* tail = bump_slab_of(ps[N - 1]);
+  uint32_t b = atomic_load(&tail->bump_next);
+  if (b >= tail->object_count || atomic_load(&tail->free_count) != 0) {
+    fprintf(stderr, "bump: tail slab bump_next=%u free_count=%u\n", b, atomic_load(&tail->free_count));
+    exit(1);
+  }
+
+  /* First free retires the reserve; a forged handle into it is rejected */
+  SlabHandle forged = (hs[N - 1] & ~((SlabHandle)0xFFu << 7)) | ((SlabHandle)(tail->object_count - 1u) << 7);  /* slot [14:7] */
+  if (!free_obj(a, hs[N - 1])) exit(1);
+  slab_stats_class(a, 0, &cs);
+  if (cs.bump_retires != 1 || !(atomic_load(&tail->bump_next) & SLAB_BUMP_RETIRED) ||
+      atomic_load(&tail->free_count) != tail->object_count - b + 1u) {
+    fprintf(stderr, "bump: retire left bump_next=0x%x free_count=%u (b=%u)\n",
+            atomic_load(&tail->bump_next), atomic_load(&tail->free_count), b);
+    exit(1);
+  }
+  if (free_obj(a, forged)) {
+    fprintf(stderr, "bump: free of a never-allocated reserve slot accepted\n");
+    exit(1);
+  }
+
+  /* Retired slab serves its freed slot and reserve from the bitmap */
+  SlabHandle h2 = 0;
+  if (!alloc_obj_epoch(a, 64, 1, &h2) || !free_obj(a, h2)) exit(1);
+
+  /* Drain and recycle: a slab reused from the cache is in bump mode again */
+  for (uint32_t i = 0; i < N - 1u; i++) {
+    if (!free_obj(a, hs[i])) {
+      fprintf(stderr, "bump: free %u failed\n", i);
+      exit(1);
+    }
+  }
+  epoch_close(a, 1);
+  void* batch[8];
+  SlabHandle bh[8];
+  if (alloc_obj_epoch_batch(a, 64, 2, batch, bh, 8) != 8) exit(1);
+  Slab* reused = bump_slab_of(batch[0]);
+  for (int i = 1; i < 8; i++) {
+    if ((uint8_t*)batch[i] - (uint8_t*)batch[i - 1] != 64 || bump_slab_of(batch[i]) != reused) {
+      fprintf(stderr, "bump: batch from fresh slab not consecutive at %d\n", i);
+      exit(1);
+    }
+  }
+  if (free_obj_batch(a, bh, 8) != 8) exit(1);
+
+  printf("smoke_test_bump_alloc: PASS (%u slots/slab, %" PRIu64 " bump allocs)\n", count, cs.bump_allocs);
+  free(ps);
+  free(hs);
+  slab_allocator_free(a);
+}
+
+/* ------------------------------ Bitmap free-word scan ------------------------------ */
+
+/* Fill one slab, free a scattered set of slots and re-allocate them: the
+ * free-word summary must lead the scan to exactly those slots. */
+static void bitmap_scan_round(SlabAllocator* a, uint32_t ci, EpochId epoch, uint32_t mode) {
+  const uint32_t size = a->classes[ci].object_size;
+  SlabHandle h0 = 0;
+  uint8_t* base = (uint8_t*)alloc_obj_epoch(a, size, epoch, &h0);
+  if (!base) exit(1);
+  Slab* s = bump_slab_of(base);
+  const uint32_t count = s->object_count;
+  const uint32_t words = (count + 31u) / 32u;
+  SlabHandle* hs = (SlabHandle*)calloc(count, sizeof(SlabHandle));
+  if (!hs) exit(1);
+  hs[0] = h0;
+  for (uint32_t i = 1; i < count; i++) {
+    uint8_t* p = (uint8_t*)alloc_obj_epoch(a, size, epoch, &hs[i]);
+    if (p != base + (size_t)i * size) {
+      fprintf(stderr, "bitmap_scan: fresh slab slot %u out of order\n", i);
+      exit(1);
+    }
+  }
+
+  /* One free slot per word (plus slot 0), the last valid slot included */
+  uint32_t freed[SLAB_BITMAP_MAX_WORDS + 2];
+  uint32_t nf = 0;
+  freed[nf++] = 0;
+  for (uint32_t w = 0; w < words; w++) {
+    uint32_t slot = w * 32u + 5u;
+    if (slot < count - 1u) freed[nf++] = slot;
+  }
+  freed[nf++] = count - 1u;
+  for (uint32_t i = 0; i < nf; i++) {
+    if (!free_obj(a, hs[freed[i]])) exit(1);
+  }
+
+  atomic_store(&a->classes[ci].scan_adapt.mode, mode);
+  void* want[SLAB_BITMAP_MAX_WORDS + 2];
+  void* got[SLAB_BITMAP_MAX_WORDS + 2];
+  for (uint32_t i = 0; i < nf; i++) {
+    want[i] = base + (size_t)freed[i] * size;
+    got[i] = alloc_obj_epoch(a, size, epoch, &hs[freed[i]]);
+  }
+  qsort(want, nf, sizeof(void*), cmp_ptr);
+  qsort(got, nf, sizeof(void*), cmp_ptr);
+  if (memcmp(want, got, nf * sizeof(void*)) != 0 || atomic_load(&s->free_count) != 0) {
+    fprintf(stderr, "bitmap_scan: %uB class (%u words, mode %u) did not refill the freed slots\n",
+            size, words, mode);
+    exit(1);
+  }
+  free(hs);
+}
+
+void smoke_test_bitmap_scan(void) {
+#if ENABLE_TLS_CACHE
+  printf("smoke_test_bitmap_scan: SKIP (TLS cache build)\n");
+  return;
+#endif
+  /* 16B: 8-word bitmap, 48B: 3 words, 64B: 2 words (last word partial) */
+  static const uint32_t classes[] = {16, 48, 64};
+  SlabAllocatorConfig cfg = { .size_classes = classes, .num_classes = 3 };
+  SlabAllocator* a = slab_allocator_create_with_config(&cfg);
+  if (!a) exit(1);
+
+  EpochId e = 1;
+  for (uint32_t mode = 0; mode < 2; mode++) {
+    for (uint32_t ci = 0; ci < 3; ci++) bitmap_scan_round(a, ci, e++, mode);
+  }
+
+  printf("smoke_test_bitmap_scan: PASS (SIMD scan %s)\n", SLAB_SIMD_SCAN ? "on" : "off");
+  slab_allocator_free(a);
+}
+
+/* ------------------------------ Pre-reservation (slab_reserve) ------------------------------ */
+
+/* Reserved slabs must serve a burst with no fresh carving, and with
+ * SLAB_RESERVE_KEEP_WARM all of them must come back resident after a
+ * drained epoch_close(). */
+void smoke_test_slab_reserve(void) {
+#if ENABLE_TLS_CACHE
+  printf("smoke_test_slab_reserve: SKIP (TLS cache build)\n");
+  return;
+#endif
+  static const uint32_t classes[] = {128};
+  SlabAllocatorConfig cfg = { .size_classes = classes, .num_classes = 1 };
+  SlabAllocator* a = slab_allocator_create_with_config(&cfg);
+  if (!a) exit(1);
+
+  const uint32_t n = 4;
+  errno = 0;
+  if (slab_reserve(a, 1, n, 0) != 0 || errno != EINVAL) {
+    fprintf(stderr, "slab_reserve: bad class not rejected\n");
+    exit(1);
+  }
+  if (slab_reserve(a, 0, n, SLAB_RESERVE_PREFAULT | SLAB_RESERVE_KEEP_WARM) != n) {
+    fprintf(stderr, "slab_reserve: reserved fewer than %u slabs\n", n);
+    exit(1);
+  }
+  SlabClassStats cs;
+  slab_stats_class(a, 0, &cs);
+  if (cs.reserved_slabs != n || cs.warm_floor != n || cs.cache_size != n || cs.new_slab_count != 0) {
+    fprintf(stderr, "slab_reserve: reserved %" PRIu64 " floor %u cached %u new %" PRIu64 "\n",
+            cs.reserved_slabs, cs.warm_floor, cs.cache_size, cs.new_slab_count);
+    exit(1);
+  }
+
+  /* Fill exactly the reserved slabs: every one comes from the cache */
+  EpochId e = epoch_current(a);
+  SlabHandle h0 = 0;
+  void* p0 = alloc_obj_epoch(a, 128, e, &h0);
+  if (!p0) exit(1);
+  const uint32_t total = bump_slab_of(p0)->object_count * n;
+  SlabHandle* hs = (SlabHandle*)calloc(total, sizeof(SlabHandle));
+  if (!hs) exit(1);
+  hs[0] = h0;
+  for (uint32_t i = 1; i < total; i++) {
+    if (!alloc_obj_epoch(a, 128, e, &hs[i])) exit(1);
+  }
+  slab_stats_class(a, 0, &cs);
+  if (cs.new_slab_count != 0 || cs.cache_size != 0) {
+    fprintf(stderr, "slab_reserve: burst carved %" PRIu64 " fresh slabs (%u still cached)\n",
+            cs.new_slab_count, cs.cache_size);
+    exit(1);
+  }
+
+  /* Drain and close: the warm floor keeps the recycled slabs resident */
+  for (uint32_t i = 0; i < total; i++) {
+    if (!free_obj(a, hs[i])) exit(1);
+  }
+  epoch_advance(a);
+  epoch_close(a, e);
+  slab_stats_class(a, 0, &cs);
+  if (cs.madvise_calls != 0 || cs.cache_size != n || cs.new_slab_count != 0) {
+    fprintf(stderr, "slab_reserve: warm slabs not kept (madvise %" PRIu64 ", cached %u)\n",
+            cs.madvise_calls, cs.cache_size);
+    exit(1);
+  }
+
+  printf("smoke_test_slab_reserve: PASS (%u slabs kept warm)\n", n);
+  free(hs);
+  slab_allocator_free(a);
+}
+
+/* ------------------------------ Configurable epoch ring ------------------------------ */
+
+/* A 300-epoch ring (rounded to 512) keeps every epoch's objects in its own
+ * slabs; once the ring wraps, the first epoch's qualified ID is stale and
+ * must not reach the epoch now occupying its slot. */
+void smoke_test_epoch_ring(void) {
+  SlabAllocatorConfig bad = { .epoch_count = SLAB_MAX_EPOCHS + 1u };
+  errno = 0;
+  if (slab_allocator_create_with_config(&bad) != NULL || errno != EINVAL) {
+    fprintf(stderr, "epoch_ring: oversized ring not rejected\n");
+    exit(1);
+  }
+
+  SlabAllocatorConfig cfg = { .epoch_count = 300 };
+  SlabAllocator* a = slab_allocator_create_with_config(&cfg);
+  if (!a) exit(1);
+  const uint32_t ring = slab_epoch_count(a);
+  if (ring != 512) {
+    fprintf(stderr, "epoch_ring: ring %u, expected 512\n", ring);
+    exit(1);
+  }
+
+  /* 300 epochs open at once, one object each: no two share a slab */
+  const uint32_t open = 300;
+  EpochId* ids = (EpochId*)calloc(open, sizeof(EpochId));
+  SlabHandle* hs = (SlabHandle*)calloc(open, sizeof(SlabHandle));
+  void** ps = (void**)calloc(open, sizeof(void*));
+  if (!ids || !hs || !ps) exit(1);
+  for (uint32_t i = 0; i < open; i++) {
+    ids[i] = epoch_current(a);
+    if (SLAB_EPOCH_INDEX(ids[i]) != i || !SLAB_EPOCH_IS_QUALIFIED(ids[i])) {
+      fprintf(stderr, "epoch_ring: epoch %u has ID %#" PRIx64 "\n", i, ids[i]);
+      exit(1);
+    }
+    ps[i] = alloc_obj_epoch(a, 64, ids[i], &hs[i]);
+    if (!ps[i]) exit(1);
+    epoch_advance(a);
+  }
+  for (uint32_t i = 1; i < open; i++) {
+    if (bump_slab_of(ps[i]) == bump_slab_of(ps[i - 1])) {
+      fprintf(stderr, "epoch_ring: epochs %u and %u share a slab\n", i - 1, i);
+      exit(1);
+    }
+  }
+  for (uint32_t i = 0; i < open; i++) {
+    if (!free_obj(a, hs[i])) exit(1);
+    epoch_close(a, ids[i]);
+  }
+
+  /* Wrap onto slot 0: ids[0] is stale, the new slot-0 epoch is untouched */
+  while (SLAB_EPOCH_INDEX(epoch_current(a)) != 0) epoch_advance(a);
+  EpochId now = epoch_current(a);
+  SlabHandle h;
+  errno = 0;
+  if (now == ids[0] || epoch_id_valid(a, ids[0]) || alloc_obj_epoch(a, 64, ids[0], &h) != NULL ||
+      epoch_release_all(a, ids[0]) != 0 || epoch_close_async(a, ids[0], NULL, NULL) || errno != ESTALE) {
+    fprintf(stderr, "epoch_ring: stale ID %#" PRIx64 " accepted\n", ids[0]);
+    exit(1);
+  }
+  epoch_close(a, ids[0]);
+  void* p = alloc_obj_epoch(a, 64, now, &h);
+  if (!p || atomic_load(&a->epoch_state[0]) != EPOCH_ACTIVE) {
+    fprintf(stderr, "epoch_ring: stale close reached the live epoch\n");
+    exit(1);
+  }
+  if (!free_obj(a, h)) exit(1);
+
+  /* Bare ring indices keep working */
+  if (!alloc_obj_epoch(a, 64, 0, &h) || !free_obj(a, h)) exit(1);
+
+  SlabGlobalStats gs;
+  slab_stats_global(a, &gs);
+  if (gs.epoch_count != ring || gs.epoch_stale_rejects < 5) {
+    fprintf(stderr, "epoch_ring: stats ring %u, stale rejects %" PRIu64 "\n", gs.epoch_count, gs.epoch_stale_rejects);
+    exit(1);
+  }
+
+  printf("smoke_test_epoch_ring: PASS (%u-slot ring, %" PRIu64 " stale IDs rejected)\n", ring, gs.epoch_stale_rejects);
+  free(ps);
+  free(hs);
+  free(ids);
+  slab_allocator_free(a);
+}
+
+/* ------------------------------ Latency histograms ------------------------------ */
+
+void smoke_test_latency_hist(void) {
+  /* Bucket math: every value maps into a bucket whose range contains it */
+  for (uint64_t v = 0; v < (1ull << 36); v = v < 64 ? v + 1 : v + v / 7) {
+    uint32_t b = slab_lat_bucket(v);
+    if (b >= SLAB_LAT_BUCKETS || (b + 1 < SLAB_LAT_BUCKETS && v > slab_lat_bucket_max_ns(b)) ||
+        (b > 0 && v <= slab_lat_bucket_max_ns(b - 1))) {
+      fprintf(stderr, "latency_hist: %" PRIu64 "ns -> bucket %u out of range\n", v, b);
+      exit(1);
+    }
+  }
+
+  /* Percentiles over a synthetic histogram: 90 x 100ns, 9 x 10us, 1 x 1ms */
+  SlabLatencyHist syn;
+  memset(&syn, 0, sizeof(syn));
+  syn.buckets[slab_lat_bucket(100)] = 90;
+  syn.buckets[slab_lat_bucket(10000)] = 9;
+  syn.buckets[slab_lat_bucket(1000000)] = 1;
+  syn.count = 100;
+  if (slab_latency_percentile(&syn, 0.50) != slab_lat_bucket_max_ns(slab_lat_bucket(100)) ||
+      slab_latency_percentile(&syn, 0.99) != slab_lat_bucket_max_ns(slab_lat_bucket(10000)) ||
+      slab_latency_percentile(&syn, 1.0) != slab_lat_bucket_max_ns(slab_lat_bucket(1000000))) {
+    fprintf(stderr, "latency_hist: wrong synthetic percentiles\n");
+    exit(1);
+  }
+
+  SlabAllocator* a = slab_allocator_create();
+  if (!a) exit(1);
+  const uint32_t N = 8192;
+  SlabHandle* hs = (SlabHandle*)calloc(N, sizeof(SlabHandle));
+  if (!hs) exit(1);
+  EpochId e = epoch_current(a);
+  for (uint32_t i = 0; i < N; i++) {
+    if (!alloc_obj_epoch(a, 128, e, &hs[i])) exit(1);
+  }
+  for (uint32_t i = 0; i < N; i++) {
+    if (!free_obj(a, hs[i])) exit(1);
+  }
+  epoch_advance(a);
+  epoch_close(a, e);
+
+  SlabGlobalStats gs;
+  slab_stats_global(a, &gs);
+#if ENABLE_LATENCY_HIST
+  const SlabLatencyHist* lat = gs.latency;
+  uint64_t allocs = lat[SLAB_LAT_ALLOC_FAST].count + lat[SLAB_LAT_ALLOC_SLOW].count;
+  uint64_t expect = N >> gs.latency_sample_shift;
+  if (!gs.latency_enabled || allocs < expect / 2 || lat[SLAB_LAT_FREE].count < expect / 2 ||
+      lat[SLAB_LAT_NEW_SLAB].count == 0 || lat[SLAB_LAT_EPOCH_CLOSE].count != 1) {
+    fprintf(stderr, "latency_hist: counts alloc %" PRIu64 " free %" PRIu64 " new_slab %" PRIu64
+            " epoch_close %" PRIu64 " (expected ~%" PRIu64 ")\n", allocs, lat[SLAB_LAT_FREE].count,
+            lat[SLAB_LAT_NEW_SLAB].count, lat[SLAB_LAT_EPOCH_CLOSE].count, expect);
+    exit(1);
+  }
+  for (uint32_t op = 0; op < SLAB_LAT_OPS; op++) {
+    uint64_t in_buckets = 0;
+    for (uint32_t b = 0; b < SLAB_LAT_BUCKETS; b++) in_buckets += lat[op].buckets[b];
+    uint64_t p50 = slab_latency_percentile(&lat[op], 0.50);
+    uint64_t p99 = slab_latency_percentile(&lat[op], 0.99);
+    uint64_t max = slab_latency_percentile(&lat[op], 1.0);
+    if (in_buckets != lat[op].count || p50 > p99 || p99 > max ||
+        (lat[op].count && lat[op].sum_ns / lat[op].count > max)) {
+      fprintf(stderr, "latency_hist: op %u inconsistent (%" PRIu64 "/%" PRIu64 " in buckets)\n",
+              op, in_buckets, lat[op].count);
+      exit(1);
+    }
+  }
+  printf("smoke_test_latency_hist: PASS (alloc p99 %" PRIu64 " ns, free p99 %" PRIu64
+         " ns, epoch_close %" PRIu64 " ns)\n",
+         slab_latency_percentile(&lat[SLAB_LAT_ALLOC_FAST], 0.99),
+         slab_latency_percentile(&lat[SLAB_LAT_FREE], 0.99),
+         lat[SLAB_LAT_EPOCH_CLOSE].sum_ns);
+#else
+  for (uint32_t op = 0; op < SLAB_LAT_OPS; op++) {
+    if (gs.latency_enabled || gs.latency[op].count != 0) {
+      fprintf(stderr, "latency_hist: histograms populated without ENABLE_LATENCY_HIST\n");
+      exit(1);
+    }
+  }
+  printf("smoke_test_latency_hist: PASS (bucket math only; ENABLE_LATENCY_HIST=0)\n");
+#endif
+  free(hs);
+  slab_allocator_free(a);
+}
+
+/* ------------------------------ Shared-memory stats segment ------------------------------ */
+
+void smoke_test_stats_shm(void) {
+  char path[64];
+  snprintf(path, sizeof(path), "/tmp/tslab_smoke.%u", (unsigned)getpid());
+  
+  SlabAllocatorConfig cfg = { .epoch_count = 32 };
+  SlabAllocator* a = slab_allocator_create_with_config(&cfg);
+  if (!a) exit(1);
+  SlabStatsShmConfig sc = { .path = path, .interval_ms = 0 };
+  if (!slab_stats_shm_start(a, &sc)) {
+    fprintf(stderr, "stats_shm: start failed: %s\n", strerror(errno));
+    exit(1);
+  }
+  errno = 0;
+  if (slab_stats_shm_start(a, &sc) || errno != EALREADY) {
+    fprintf(stderr, "stats_shm: second start not rejected\n");
+    exit(1);
+  }
+  
+  /* A second allocator on the same path must not take over the segment */
+  SlabAllocator* b = slab_allocator_create();
+  if (!b) exit(1);
+  errno = 0;
+  if (slab_stats_shm_start(b, &sc) || errno != EEXIST) {
+    fprintf(stderr, "stats_shm: second allocator not refused (errno %d)\n", errno);
+    exit(1);
+  }
+  slab_allocator_free(b);
+  if (access(path, F_OK) != 0) {
+    fprintf(stderr, "stats_shm: refused allocator removed the segment\n");
+    exit(1);
+  }
+  
+  /* Some traffic and a labeled, closed epoch */
+  EpochId e = epoch_current(a);
+  slab_epoch_set_label(a, e, "shm\"test");
+  SlabHandle hs[500];
+  for (int i = 0; i < 500; i++) {
+    if (!alloc_obj_epoch(a, 96, e, &hs[i])) exit(1);
+  }
+  for (int i = 0; i < 500; i++) free_obj(a, hs[i]);
+  epoch_advance(a);
+  epoch_close(a, e);
+  if (!slab_stats_shm_publish(a)) exit(1);
+  
+  SlabShmReader r;
+  if (!slab_stats_shm_attach(&r, path)) {
+    fprintf(stderr, "stats_shm: attach failed: %s\n", strerror(errno));
+    exit(1);
+  }
+  SlabShmHeader* snap = (SlabShmHeader*)malloc(r.bytes);
+  if (!snap || !slab_stats_shm_read(&r, snap, r.bytes)) exit(1);
+  
+  SlabGlobalStats gs;
+  slab_stats_global(a, &gs);
+  SlabClassStats cs;
+  slab_stats_class(a, 1, &cs);
+  const SlabShmEpoch* ep = slab_shm_epoch(snap, SLAB_EPOCH_INDEX(e));
+  if (snap->publish_count != 2 || snap->num_classes != a->num_classes || snap->epoch_count != 32 ||
+      snap->global.total_slabs_allocated != gs.total_slabs_allocated ||
+      slab_shm_class(snap, 1)->new_slab_count != cs.new_slab_count ||
+      slab_shm_class(snap, 1)->total_partial_slabs != 0 ||
+      strcmp(ep->label, "shm\"test") != 0 || ep->state != EPOCH_CLOSING ||
+      ep->rss_before_close == 0 || ep->era != (uint64_t)(e >> 32) - 1u) {
+    fprintf(stderr, "stats_shm: snapshot mismatch (publishes %" PRIu64 ", slabs %" PRIu64 "/%" PRIu64
+            ", label '%s')\n", snap->publish_count, snap->global.total_slabs_allocated,
+            gs.total_slabs_allocated, ep->label);
+    exit(1);
+  }
+  
+  /* Short buffers are refused; a wrong file is not a segment */
+  errno = 0;
+  if (slab_stats_shm_read(&r, snap, r.bytes - 1) || errno != EINVAL) exit(1);
+  SlabShmReader bogus;
+  errno = 0;
+  if (slab_stats_shm_attach(&bogus, "/proc/self/cmdline") || errno != EPROTO) {
+    fprintf(stderr, "stats_shm: non-segment attached (errno %d)\n", errno);
+    exit(1);
+  }
+  slab_stats_shm_detach(&r);
+  slab_stats_shm_stop(a);
+  if (access(path, F_OK) == 0) {
+    fprintf(stderr, "stats_shm: segment not unlinked\n");
+    exit(1);
+  }
+  
+  /* Publisher thread: snapshots advance on their own; destroy stops it */
+  sc.interval_ms = 2;
+  if (!slab_stats_shm_start(a, &sc)) exit(1);
+  if (!slab_stats_shm_attach(&r, path)) exit(1);
+  uint64_t first = 0;
+  uint64_t last = 0;
+  for (int i = 0; i < 500 && last < first + 3; i++) {
+    if (!slab_stats_shm_read(&r, snap, r.bytes)) exit(1);
+    if (i == 0) first = snap->publish_count;
+    last = snap->publish_count;
+    struct timespec ts = { 0, 2000000 };
+    nanosleep(&ts, NULL);
+  }
+  if (last < first + 3) {
+    fprintf(stderr, "stats_shm: publisher stalled at %" PRIu64 "\n", last);
+    exit(1);
+  }
+  const size_t seg_bytes = r.bytes;
+  slab_stats_shm_detach(&r);
+  slab_allocator_free(a);
+  if (access(path, F_OK) == 0) {
+    fprintf(stderr, "stats_shm: destroy left the segment behind\n");
+    exit(1);
+  }
+  
+  printf("smoke_test_stats_shm: PASS (%zu-byte segment, publisher %" PRIu64 " -> %" PRIu64 ")\n",
+         seg_bytes, first, last);
+  free(snap);
+}
+
+/* ------------------------------ Concurrent epoch churn ------------------------------ */
+
+typedef struct {
+  SlabAllocator* a;
+  uint8_t tag;
+  uint32_t requests;
+  uint32_t objects;
+  uint32_t overwritten;
+  uint32_t nofree;
+} EpochChurnArgs;
+
+/* Per-request epochs on a shared ring: another thread's advance or close
+ * can retire this thread's epoch mid-request, so empty slabs get recycled
+ * (and handed to other epochs) while fast-path threads and frees still hold
+ * them. A claim in flight must keep its slab from being recycled under it
+ * (else two threads get the same slot), and the list transitions must
+ * notice instead of unlinking the slab from the wrong epoch's list. */
+static void* epoch_churn_worker(void* arg) {
+  EpochChurnArgs* w = (EpochChurnArgs*)arg;
+  void* ps[150];
+  SlabHandle hs[150];
+  for (uint32_t r = 0; r < w->requests; r++) {
+    epoch_advance(w->a);
+    EpochId e = epoch_current(w->a);
+    const uint8_t fill = (uint8_t)(w->tag ^ r);
+    int n = 0;
+    while (n < 150) {
+      ps[n] = alloc_obj_epoch(w->a, 128, e, &hs[n]);
+      if (!ps[n]) break;  /* Epoch closed under us */
+      memset(ps[n], fill, 128);
+      n++;
+    }
+    for (int i = 0; i < n; i++) {
+      const uint8_t* b = (const uint8_t*)ps[i];
+      if (b[0] != fill || b[127] != fill) w->overwritten++;
+      if (!free_obj(w->a, hs[i])) w->nofree++;
+    }
+    w->objects += (uint32_t)n;
+    epoch_close(w->a, e);
+  }
+  return NULL;
+}
+
+void smoke_test_epoch_churn(void) {
+  /* Room for every thread's epoch most of the time. A worker descheduled
+   * across 64 advances by the others still finds its slot reopened. */
+  SlabAllocatorConfig cfg = { .epoch_count = 64 };
+  SlabAllocator* a = slab_allocator_create_with_config(&cfg);
+  if (!a) exit(1);
+
+  enum { T = 8 };
+  pthread_t th[T];
+  EpochChurnArgs args[T];
+  for (int i = 0; i < T; i++) {
+    args[i] = (EpochChurnArgs){ .a = a, .tag = (uint8_t)(0x11 * (i + 1)), .requests = 3000 };
+    if (pthread_create(&th[i], NULL, epoch_churn_worker, &args[i]) != 0) {
+      fprintf(stderr, "pthread_create failed\n");
+      exit(1);
+    }
+  }
+  uint64_t objects = 0;
+  uint32_t overwritten = 0, nofree = 0;
+  for (int i = 0; i < T; i++) {
+    pthread_join(th[i], NULL);
+    objects += args[i].objects;
+    overwritten += args[i].overwritten;
+    nofree += args[i].nofree;
+  }
+  if (overwritten != 0 || nofree != 0) {
+    fprintf(stderr, "epoch_churn: objects overwritten=%u not freeable=%u\n", overwritten, nofree);
+    exit(1);
+  }
+
+  printf("smoke_test_epoch_churn: PASS (%d threads, %" PRIu64 " objects)\n", T, objects);
+  slab_allocator_free(a);
+}
+
+/* ------------------------------ Domain-bound allocation ------------------------------ */
+
+/* epoch_domain_alloc() skips the per-call epoch and class resolution but must
+ * behave exactly like alloc_obj_epoch() on the domain's epoch: same classes,
+ * same epoch, NULL once the epoch closes or its slot is reopened. */
+void smoke_test_domain_alloc(void) {
+  SlabAllocator* a = slab_allocator_create();
+  if (!a) exit(1);
+
+  /* The constant-folding table must agree with the allocator's lookup */
+  for (uint32_t sz = 0; sz <= SLAB_MAX_OBJECT_SIZE + 1u; sz++) {
+    int want = (sz == 0 || sz > a->max_alloc_size) ? -1 : (int)a->class_lookup[sz];
+    if (slab_default_class_index(sz) != want) {
+      fprintf(stderr, "domain_alloc: default class of %u is %d, lookup says %d\n",
+              sz, slab_default_class_index(sz), want);
+      exit(1);
+    }
+  }
+
+  epoch_domain_t* d = epoch_domain_create(a);
+  if (!d || !d->default_classes) exit(1);
+
+  /* Constant and runtime sizes, all in the domain's epoch */
+  enum { N = 4096 };
+  static const uint32_t sizes[] = { 24, 200, 3000 };
+  SlabHandle* hs = (SlabHandle*)calloc(N, sizeof(SlabHandle));
+  void** ps = (void**)calloc(N, sizeof(void*));
+  uint32_t* len = (uint32_t*)calloc(N, sizeof(uint32_t));
+  if (!hs || !ps || !len) exit(1);
+  epoch_domain_enter(d);
+  for (int i = 0; i < N; i++) {
+    if (i & 1) {
+      len[i] = 128;
+      ps[i] = epoch_domain_alloc(d, 128, &hs[i]);
+    } else {
+      len[i] = sizes[(i / 2) % 3];
+      ps[i] = epoch_domain_alloc(d, len[i], &hs[i]);
+    }
+    if (!ps[i]) {
+      fprintf(stderr, "domain_alloc: alloc %d (%u bytes) failed\n", i, len[i]);
+      exit(1);
+    }
+    memset(ps[i], i & 0xFF, len[i]);
+  }
+  epoch_domain_exit(d);
+  for (int i = 0; i < N; i++) {
+    const unsigned char* b = (const unsigned char*)ps[i];
+    if (b[0] != (i & 0xFF) || b[len[i] - 1] != (i & 0xFF)) {
+      fprintf(stderr, "domain_alloc: object %d overwritten\n", i);
+      exit(1);
+    }
+  }
+  for (int i = 0; i < N; i += 2) {
+    if (!free_obj(a, hs[i])) exit(1);
+  }
+
+  /* Releasing the domain's epoch invalidates the rest: they came from it */
+  epoch_advance(a);
+  if (epoch_release_all(a, d->epoch_id) == 0) exit(1);
+  for (int i = 1; i < N; i += 2) {
+    if (free_obj(a, hs[i])) {
+      fprintf(stderr, "domain_alloc: object %d outlived its epoch\n", i);
+      exit(1);
+    }
+  }
+
+  /* Closed epoch: the bound path must notice */
+  SlabHandle h;
+  epoch_domain_enter(d);
+  if (epoch_domain_alloc(d, 128, &h) != NULL) {
+    fprintf(stderr, "domain_alloc: allocated from a closed epoch\n");
+    exit(1);
+  }
+  epoch_domain_exit(d);
+  epoch_domain_destroy(d);
+
+  /* A new domain (possibly at the same address) binds its own epoch,
+   * lazily outside a scope */
+  d = epoch_domain_create(a);
+  if (!d) exit(1);
+  void* p = epoch_domain_alloc(d, 128, &h);
+  if (!p || !free_obj(a, h)) {
+    fprintf(stderr, "domain_alloc: new domain reused a dropped binding\n");
+    exit(1);
+  }
+
+  /* The handle is optional: bin hits and misses, bound and per-call sizes */
+  for (int i = 0; i < 64; i++) {
+    if (!epoch_domain_alloc(d, 128, NULL) || !epoch_domain_alloc_size(d, 200, NULL)) {
+      fprintf(stderr, "domain_alloc: handle-less alloc %d failed\n", i);
+      exit(1);
+    }
+  }
+
+  /* Reopened slot: still ACTIVE, but a newer era */
+  epoch_domain_enter(d);
+  for (uint32_t i = 0; i < slab_epoch_count(a); i++) epoch_advance(a);
+  uint64_t rejects = atomic_load(&a->epoch_stale_rejects);
+  if (epoch_domain_alloc(d, 128, &h) != NULL || atomic_load(&a->epoch_stale_rejects) == rejects) {
+    fprintf(stderr, "domain_alloc: stale epoch reached its slot's new epoch\n");
+    exit(1);
+  }
+  epoch_domain_exit(d);
+  epoch_domain_destroy(d);
+  slab_allocator_free(a);
+
+  /* Custom table: no constant folding, lookups per call */
+  static const uint32_t custom[] = { 48, 112, 256, 1000 };
+  SlabAllocatorConfig cfg = { .size_classes = custom, .num_classes = 4 };
+  a = slab_allocator_create_with_config(&cfg);
+  if (!a) exit(1);
+  d = epoch_domain_create(a);
+  if (!d || d->default_classes) exit(1);
+  epoch_domain_enter(d);
+  p = epoch_domain_alloc(d, 100, &h);
+  if (!p || !free_obj(a, h) || epoch_domain_alloc(d, 2000, &h) != NULL ||
+      epoch_domain_alloc_class(d, 4, &h) != NULL || epoch_domain_alloc_class(d, 99, &h) != NULL) {
+    fprintf(stderr, "domain_alloc: custom class table mishandled\n");
+    exit(1);
+  }
+  epoch_domain_exit(d);
+  epoch_domain_destroy(d);
+
+  printf("smoke_test_domain_alloc: PASS (%d objects, stale and closed epochs rejected)\n", N);
+  free(len);
+  free(ps);
+  free(hs);
+  slab_allocator_free(a);
+}
+
+/* ------------------------------ Compaction ------------------------------ */
+
+/* Slabs on the class's partial/full lists */
+static uint32_t compact_live_slabs(SlabAllocator* a, uint32_t ci) {
+  pthread_mutex_lock(&a->classes[ci].lock);
+  uint32_t n = (uint32_t)a->classes[ci].total_slabs;
+  pthread_mutex_unlock(&a->classes[ci].lock);
+  return n;
+}
+
+/* Every live handle resolves to an object still carrying its index
+ * (lost or misplaced copies show up here). With freed_null, freed ones
+ * must resolve to NULL - not after a compaction, which may have moved
+ * another object into their old slot. */
+static bool compact_check(SlabAllocator* a, const SlabHandle* hs, const bool* live, int n,
+                          bool freed_null) {
+  for (int i = 0; i < n; i++) {
+    if (!live[i] && !freed_null) continue;
+    uint32_t* p = (uint32_t*)slab_handle_deref(a, hs[i]);
+    if (live[i] ? (!p || p[0] != (uint32_t)i || p[31] != ~(uint32_t)i) : p != NULL) {
+      fprintf(stderr, "slab_compact: handle %d resolves to %p (live %d)\n", i, (void*)p, live[i]);
+      return false;
+    }
+  }
+  return true;
+}
+
+void smoke_test_slab_compact(void) {
+  SlabAllocator* a = slab_allocator_create();
+  if (!a) exit(1);
+  const uint32_t ci = (uint32_t)a->class_lookup[128];
+
+  enum { N = 6000 };
+  SlabHandle* hs = (SlabHandle*)calloc(N, sizeof(SlabHandle));
+  bool* live = (bool*)calloc(N, sizeof(bool));
+  if (!hs || !live) exit(1);
+
+  EpochId e = epoch_current(a);
+  for (int i = 0; i < N; i++) {
+    uint32_t* p = (uint32_t*)alloc_obj_epoch(a, 128, e, &hs[i]);
+    if (!p) exit(1);
+    p[0] = (uint32_t)i;
+    p[31] = ~(uint32_t)i;
+    live[i] = true;
+  }
+  for (int i = 0; i < N; i++) {
+    if (i % 5 != 0) {
+      if (!free_obj(a, hs[i])) exit(1);
+      live[i] = false;
+    }
+  }
+
+  /* Only closed epochs move */
+  errno = 0;
+  if (slab_compact_epoch(a, e, NULL) != 0 || errno != EBUSY) {
+    fprintf(stderr, "slab_compact: compacted an open epoch\n");
+    exit(1);
+  }
+
+  epoch_advance(a);
+  epoch_close(a, e);
+  uint32_t before = compact_live_slabs(a, ci);
+  SlabCompactStats st;
+  uint32_t released = slab_compact_epoch(a, e, &st);
+  uint32_t after = compact_live_slabs(a, ci);
+  if (released == 0 || st.slabs_released != released || st.objects_moved == 0 ||
+      st.forward_tables == 0 || before - after != released || after > before / 4u + 1u) {
+    fprintf(stderr, "slab_compact: %u -> %u slabs, released %u, moved %u\n",
+            before, after, released, st.objects_moved);
+    exit(1);
+  }
+  if (!compact_check(a, hs, live, N, false)) exit(1);
+
+  /* Frees follow the forward; second free of a moved object is caught */
+  for (int i = 0; i < N; i += 10) {
+    if (!free_obj(a, hs[i]) || free_obj(a, hs[i])) {
+      fprintf(stderr, "slab_compact: forwarded free of %d misbehaved\n", i);
+      exit(1);
+    }
+  }
+  for (int i = 0; i < N; i += 10) {
+    if (slab_handle_deref(a, hs[i]) != NULL) {
+      fprintf(stderr, "slab_compact: freed object %d still resolves\n", i);
+      exit(1);
+    }
+    live[i] = false;
+  }
+  if (!compact_check(a, hs, live, N, false)) exit(1);
+
+  /* Compact again: objects moved twice resolve through both hops */
+  uint32_t again = slab_compact_epoch(a, e, NULL);
+  if (!compact_check(a, hs, live, N, false)) exit(1);
+
+  /* Batched frees of forwarded handles, then nothing is left to forward */
+  SlabHandle* rest = (SlabHandle*)calloc(N, sizeof(SlabHandle));
+  if (!rest) exit(1);
+  uint32_t nrest = 0;
+  for (int i = 0; i < N; i++) {
+    if (live[i]) rest[nrest++] = hs[i];
+    live[i] = false;
+  }
+  if (free_obj_batch(a, rest, nrest) != nrest) {
+    fprintf(stderr, "slab_compact: batch free of %u forwarded handles failed\n", nrest);
+    exit(1);
+  }
+  if (!compact_check(a, hs, live, N, true)) exit(1);
+  for (uint32_t c = 0; c < a->num_classes; c++) {
+    if (a->classes[c].epochs[epoch_slot(a, e)].forwards != NULL) {
+      fprintf(stderr, "slab_compact: class %u kept a forwarding table\n", c);
+      exit(1);
+    }
+  }
+
+  /* Releasing an epoch drops its forwards with the objects */
+  EpochId e2 = epoch_current(a);
+  for (int i = 0; i < N; i++) {
+    if (!alloc_obj_epoch(a, 128, e2, &hs[i])) exit(1);
+  }
+  for (int i = 0; i < N; i++) {
+    if (i % 7 != 0 && !free_obj(a, hs[i])) exit(1);
+  }
+  epoch_advance(a);
+  epoch_close(a, e2);
+  if (slab_compact_epoch(a, e2, NULL) == 0) exit(1);
+  epoch_release_all(a, e2);
+  for (int i = 0; i < N; i += 7) {
+    if (free_obj(a, hs[i]) || slab_handle_deref(a, hs[i]) != NULL) {
+      fprintf(stderr, "slab_compact: object %d outlived its released epoch\n", i);
+      exit(1);
+    }
+  }
+  free(rest);
+  slab_allocator_free(a);
+
+  /* Raw-pointer mode can't follow a move */
+  SlabAllocatorConfig cfg = { .header_free = true };
+  a = slab_allocator_create_with_config(&cfg);
+  if (!a) exit(1);
+  e = epoch_current(a);
+  epoch_close(a, e);
+  errno = 0;
+  if (slab_compact_epoch(a, e, NULL) != 0 || errno != ENOTSUP) {
+    fprintf(stderr, "slab_compact: header_free allocator compacted\n");
+    exit(1);
+  }
+  slab_allocator_free(a);
+
+  printf("smoke_test_slab_compact: PASS (%u -> %u slabs, %u objects moved, second pass released %u)\n",
+         before, after, st.objects_moved, again);
+  free(live);
+  free(hs);
+}
+
+/* ------------------------------ Adaptive cache and memory budget ------------------------------ */
+
+static uint32_t cache_depth(SlabAllocator* a, uint32_t ci, SlabClassStats* cs) {
+  slab_stats_class(a, ci, cs);
+  return cs->cache_size + cs->cache_overflow_len;
+}
+
+void smoke_test_cache_adapt(void) {
+  /* Burst, then idle: the target follows demand up at once and back down
+   * slowly, and the reclaimer's idle tick trims what the target dropped */
+  SlabAllocator* a = slab_allocator_create();
+  if (!a || !slab_reclaimer_start(a, NULL)) exit(1);
+  const uint32_t ci = (uint32_t)a->class_lookup[128];
+
+  enum { N = 20000 };
+  SlabHandle* hs = (SlabHandle*)calloc(N, sizeof(SlabHandle));
+  if (!hs) exit(1);
+  EpochId e = epoch_current(a);
+  for (int i = 0; i < N; i++) {
+    if (!alloc_obj_epoch(a, 128, e, &hs[i])) exit(1);
+  }
+  struct timespec window = { 0, 150 * 1000000L };
+  nanosleep(&window, NULL);
+  SlabClassStats cs;
+  slab_stats_class(a, ci, &cs);
+  if (cs.cache_target_grows == 0 || cs.cache_capacity <= SLAB_CACHE_TARGET_INIT) {
+    fprintf(stderr, "cache_adapt: target %u after a burst (%u grows)\n",
+            cs.cache_capacity, cs.cache_target_grows);
+    exit(1);
+  }
+  uint32_t peak_target = cs.cache_capacity;
+
+  epoch_advance(a);
+  for (int i = 0; i < N; i++) {
+    if (!free_obj(a, hs[i])) exit(1);
+  }
+  epoch_close(a, e);
+  uint32_t cached = cache_depth(a, ci, &cs);
+  uint32_t dirty = cached - cs.cache_clean_slabs;
+
+  /* Halving every SLAB_CACHE_SHRINK_DWELL windows down to the floor, and
+   * published slabs past the trim grace: a few seconds */
+  for (int ms = 0; ms < 8000; ms += 100) {
+    nanosleep(&(struct timespec){ 0, 100 * 1000000L }, NULL);
+    uint32_t depth = cache_depth(a, ci, &cs);
+    if (cs.cache_capacity < 2u * SLAB_CACHE_TARGET_MIN && depth - cs.cache_clean_slabs <= cs.cache_capacity) break;
+  }
+  uint32_t depth = cache_depth(a, ci, &cs);
+  uint32_t idle_target = cs.cache_capacity;
+#if ENABLE_RSS_RECLAMATION && defined(__linux__)
+  if (cs.cache_capacity >= 2u * SLAB_CACHE_TARGET_MIN || cs.cache_target_shrinks == 0 ||
+      depth != cached || depth - cs.cache_clean_slabs > cs.cache_capacity ||
+      cs.cache_trims == 0 || cs.cache_trimmed_slabs == 0) {
+    fprintf(stderr, "cache_adapt: idle cache kept target %u, %u of %u slabs resident (%lu trimmed)\n",
+            cs.cache_capacity, depth - cs.cache_clean_slabs, depth,
+            (unsigned long)cs.cache_trimmed_slabs);
+    exit(1);
+  }
+#endif
+
+  /* Trimmed slabs come back with a fresh header */
+  e = epoch_current(a);
+  for (int i = 0; i < N; i++) {
+    uint32_t* p = (uint32_t*)alloc_obj_epoch(a, 128, e, &hs[i]);
+    if (!p) exit(1);
+    p[0] = (uint32_t)i;
+    p[31] = ~(uint32_t)i;
+  }
+  for (int i = 0; i < N; i++) {
+    uint32_t* p = (uint32_t*)slab_handle_deref(a, hs[i]);
+    if (!p || p[0] != (uint32_t)i || p[31] != ~(uint32_t)i || !free_obj(a, hs[i])) {
+      fprintf(stderr, "cache_adapt: object %d wrong after reuse of trimmed slabs\n", i);
+      exit(1);
+    }
+  }
+  if (cache_depth(a, ci, &cs) < cs.cache_clean_slabs) exit(1);
+  slab_reclaimer_stop(a);
+  slab_allocator_free(a);
+
+  /* Budget: reserved (never-published, resident) slabs are trimmed as soon
+   * as a budget below the footprint is set */
+  a = slab_allocator_create();
+  if (!a) exit(1);
+  const uint32_t reserve = 200;
+  if (slab_reserve(a, ci, reserve, 0) != reserve) exit(1);
+  SlabGlobalStats gs;
+  slab_stats_global(a, &gs);
+  uint64_t before = gs.resident_estimate_bytes;
+  if (before < (uint64_t)reserve * a->classes[ci].slab_bytes || gs.memory_budget_bytes != 0) {
+    fprintf(stderr, "cache_adapt: reserve of %u slabs estimated at %lu bytes\n",
+            reserve, (unsigned long)before);
+    exit(1);
+  }
+  if (!slab_set_memory_budget(a, before / 2)) exit(1);
+  slab_stats_global(a, &gs);
+  slab_stats_class(a, ci, &cs);
+#if ENABLE_RSS_RECLAMATION && defined(__linux__)
+  if (gs.budget_enforcements != 1 || gs.memory_budget_bytes != before / 2 ||
+      gs.resident_estimate_bytes > before / 2 || cs.cache_clean_slabs != reserve) {
+    fprintf(stderr, "cache_adapt: budget %lu left %lu resident (%u clean, %lu enforcements)\n",
+            (unsigned long)(before / 2), (unsigned long)gs.resident_estimate_bytes,
+            cs.cache_clean_slabs, (unsigned long)gs.budget_enforcements);
+    exit(1);
+  }
+#endif
+  /* Under budget: nothing more to do */
+  if (!slab_set_memory_budget(a, before * 2)) exit(1);
+  slab_stats_global(a, &gs);
+  if (gs.budget_enforcements > 1) exit(1);
+
+  /* Clean slabs are popped like any other */
+  e = epoch_current(a);
+  for (int i = 0; i < 2000; i++) {
+    uint32_t* p = (uint32_t*)alloc_obj_epoch(a, 128, e, &hs[i]);
+    if (!p) exit(1);
+    p[0] = (uint32_t)i;
+  }
+  slab_stats_class(a, ci, &cs);
+  if (cs.cache_clean_slabs >= reserve) {
+    fprintf(stderr, "cache_adapt: clean count %u not dropped by pops\n", cs.cache_clean_slabs);
+    exit(1);
+  }
+  errno = 0;
+  if (slab_set_memory_budget(NULL, 1) || errno != EINVAL) exit(1);
+  if (!slab_set_memory_budget(a, 0)) exit(1);
+  slab_allocator_free(a);
+
+  printf("smoke_test_cache_adapt: PASS (target %u -> %u, %u of %u cached slabs trimmed, budget %lu -> %lu bytes)\n",
+         peak_target, idle_target, dirty, depth,
+         (unsigned long)before, (unsigned long)gs.resident_estimate_bytes);
+  free(hs);
+}
+
+/* ------------------------------ Label quotas ------------------------------ */
+
+typedef struct QuotaHits {
+  uint32_t calls;
+  uint64_t quota;
+  char label[32];
+} QuotaHits;
+
+static void quota_cb(SlabAllocator* a, const char* label, uint64_t committed, uint64_t quota, void* arg) {
+  (void)a;
+  (void)committed;
+  QuotaHits* h = (QuotaHits*)arg;
+  h->calls++;
+  h->quota = quota;
+  snprintf(h->label, sizeof(h->label), "%s", label);
+}
+
+void smoke_test_label_quota(void) {
+  SlabAllocator* a = slab_allocator_create();
+  if (!a) exit(1);
+  const uint32_t ci = (uint32_t)a->class_lookup[128];
+  const uint64_t slab = a->classes[ci].slab_bytes;
+  const uint32_t per_slab = slab_object_count(128);
+  const uint32_t max_slabs = 4;
+
+  QuotaHits hits = { 0 };
+  if (!slab_label_set_quota(a, "tenant:a", max_slabs * slab, quota_cb, &hits)) exit(1);
+  EpochId ea = epoch_current(a);
+  slab_epoch_set_label(a, ea, "tenant:a");
+
+  enum { N = 4096 };
+  SlabHandle* hs = (SlabHandle*)calloc(N, sizeof(SlabHandle));
+  if (!hs) exit(1);
+  uint32_t n = 0;
+  errno = 0;
+  while (n < N && alloc_obj_epoch(a, 128, ea, &hs[n])) n++;
+  if (n == N || errno != EDQUOT || n != max_slabs * per_slab ||
+      slab_label_committed(a, "tenant:a") != max_slabs * slab) {
+    fprintf(stderr, "label_quota: %u objects before refusal (errno %d), %lu bytes charged\n",
+            n, errno, (unsigned long)slab_label_committed(a, "tenant:a"));
+    exit(1);
+  }
+  if (hits.calls != 1 || hits.quota != max_slabs * slab || strcmp(hits.label, "tenant:a") != 0) {
+    fprintf(stderr, "label_quota: callback ran %u times for '%s'\n", hits.calls, hits.label);
+    exit(1);
+  }
+
+  /* Other labels are not held back by tenant:a */
+  epoch_advance(a);
+  EpochId eb = epoch_current(a);
+  slab_epoch_set_label(a, eb, "tenant:b");
+  SlabHandle hb[512];
+  for (int i = 0; i < 512; i++) {
+    if (!alloc_obj_epoch(a, 128, eb, &hb[i])) exit(1);
+  }
+  if (slab_label_committed(a, "tenant:b") == 0 || slab_label_committed(a, "(unlabeled)") != 0) exit(1);
+
+  /* Slabs emptied and cached are credited back */
+  for (uint32_t i = 0; i < n; i++) {
+    if (!free_obj(a, hs[i])) exit(1);
+  }
+  epoch_close(a, ea);
+  if (slab_label_committed(a, "tenant:a") != 0) {
+    fprintf(stderr, "label_quota: %lu bytes still charged after close\n",
+            (unsigned long)slab_label_committed(a, "tenant:a"));
+    exit(1);
+  }
+  for (int i = 0; i < 512; i++) {
+    if (!free_obj(a, hb[i])) exit(1);
+  }
+  epoch_release_all(a, eb);
+  if (slab_label_committed(a, "tenant:b") != 0) exit(1);
+
+  /* Lifting the quota lets the label grow again */
+  if (!slab_label_set_quota(a, "tenant:a", 0, NULL, NULL)) exit(1);
+  epoch_advance(a);
+  EpochId ea2 = epoch_current(a);
+  slab_epoch_set_label(a, ea2, "tenant:a");
+  for (uint32_t i = 0; i < max_slabs * per_slab * 2; i++) {
+    if (!alloc_obj_epoch(a, 128, ea2, &hs[i])) exit(1);
+  }
+  SlabGlobalStats gs;
+  slab_stats_global(a, &gs);
+  if (gs.label_count != 3 || gs.label_quota_denials[1] != 1 ||
+      gs.label_committed_bytes[1] < 2 * max_slabs * slab || gs.label_peak_bytes[1] < gs.label_committed_bytes[1]) {
+    fprintf(stderr, "label_quota: stats show %u labels, %lu denials, %lu bytes\n",
+            gs.label_count, (unsigned long)gs.label_quota_denials[1],
+            (unsigned long)gs.label_committed_bytes[1]);
+    exit(1);
+  }
+  epoch_release_all(a, ea2);
+
+  /* Registry full: no quota for a seventeenth label */
+  char name[32];
+  for (int i = 0; i < 13; i++) {
+    snprintf(name, sizeof(name), "filler:%d", i);
+    if (!slab_label_set_quota(a, name, slab, NULL, NULL)) exit(1);
+  }
+  errno = 0;
+  if (slab_label_set_quota(a, "one:too:many", slab, NULL, NULL) || errno != ENOSPC) exit(1);
+  if (slab_label_committed(a, "never:seen") != 0) exit(1);
+  slab_allocator_free(a);
+
+  printf("smoke_test_label_quota: PASS (%u objects / %u slabs under quota, refusal with EDQUOT)\n",
+         n, max_slabs);
+  free(hs);
+}
+
+/* ------------------------------ Empty-slab list ------------------------------ */
+
+/* Slabs freed empty are parked on the epoch's empty list: the slow path
+ * reuses them before taking a new slab, and epoch_close() visits only
+ * them instead of every slab the epoch holds. */
+void smoke_test_empty_list(void) {
+#if ENABLE_TLS_CACHE
+  /* Refills move whole batches into thread bins, so slabs don't fill in order */
+  printf("smoke_test_empty_list: SKIP (TLS cache build)\n");
+  return;
+#endif
+  SlabAllocator* a = slab_allocator_create();
+  if (!a) exit(1);
+  const uint32_t ci = (uint32_t)a->class_lookup[128];
+  const uint32_t per_slab = slab_object_count(128);
+  const uint32_t S = 64;
+  const uint32_t N = S * per_slab + 1;  /* One more: slab S stays published */
+  const uint32_t M = N + 2 * per_slab;
+  SlabHandle* hs = (SlabHandle*)calloc(M, sizeof(SlabHandle));
+  if (!hs) exit(1);
+
+  /* Single-threaded bump allocation fills slab k with objects
+   * [k * per_slab, (k + 1) * per_slab). Empty every even slab; none of
+   * them is published, since slab S holds this CPU's slot. */
+  EpochId e = epoch_current(a);
+  for (uint32_t i = 0; i < N; i++) {
+    if (!alloc_obj_epoch(a, 128, e, &hs[i])) exit(1);
+  }
+  for (uint32_t k = 0; k < S; k += 2) {
+    for (uint32_t i = k * per_slab; i < (k + 1) * per_slab; i++) {
+      if (!free_obj(a, hs[i])) exit(1);
+      hs[i] = 0;
+    }
+  }
+  SlabEpochStats es;
+  slab_stats_epoch(a, ci, e, &es);
+  if (es.empty_slab_count != S / 2 || es.reclaimable_slab_count != S / 2 ||
+      es.partial_slab_count + es.full_slab_count + es.empty_slab_count != S + 1) {
+    fprintf(stderr, "empty_list: %u empty / %u partial / %u full after freeing %u slabs\n",
+            es.empty_slab_count, es.partial_slab_count, es.full_slab_count, S / 2);
+    exit(1);
+  }
+
+  /* The active epoch reuses parked slabs before asking for new ones */
+  SlabClassStats cs0, cs1;
+  slab_stats_class(a, ci, &cs0);
+  for (uint32_t i = N; i < M; i++) {
+    if (!alloc_obj_epoch(a, 128, e, &hs[i])) exit(1);
+  }
+  slab_stats_class(a, ci, &cs1);
+  slab_stats_epoch(a, ci, e, &es);
+  if (cs1.new_slab_count != cs0.new_slab_count || es.empty_slab_count != S / 2 - 2) {
+    fprintf(stderr, "empty_list: %lu new slabs, %u still parked after reuse\n",
+            (unsigned long)(cs1.new_slab_count - cs0.new_slab_count), es.empty_slab_count);
+    exit(1);
+  }
+
+  /* Close scans only the parked slabs, not the live ones */
+  const uint32_t parked = es.empty_slab_count;
+  epoch_close(a, e);
+  SlabClassStats cs2;
+  slab_stats_class(a, ci, &cs2);
+  uint64_t scanned = cs2.epoch_close_scanned_slabs - cs1.epoch_close_scanned_slabs;
+  uint64_t recycled = cs2.epoch_close_recycled_slabs - cs1.epoch_close_recycled_slabs;
+  slab_stats_epoch(a, ci, e, &es);
+  if (scanned != parked || recycled != parked || es.empty_slab_count != 0 ||
+      es.partial_slab_count + es.full_slab_count != S + 1 - parked) {
+    fprintf(stderr, "empty_list: close scanned %lu, recycled %lu of %u parked\n",
+            (unsigned long)scanned, (unsigned long)recycled, parked);
+    exit(1);
+  }
+
+  /* Frees into the closed epoch park the rest; a second close takes them */
+  for (uint32_t i = 0; i < M; i++) {
+    if (hs[i] && !free_obj(a, hs[i])) exit(1);
+  }
+  epoch_close(a, e);
+  slab_stats_epoch(a, ci, e, &es);
+  if (es.partial_slab_count + es.full_slab_count + es.empty_slab_count != 0) {
+    fprintf(stderr, "empty_list: %u partial / %u full / %u empty left after close\n",
+            es.partial_slab_count, es.full_slab_count, es.empty_slab_count);
+    exit(1);
+  }
+  slab_allocator_free(a);
+  free(hs);
+
+  printf("smoke_test_empty_list: PASS (close scanned %lu of %u slabs)\n",
+         (unsigned long)scanned, S + 1);
+}
+
+/* ------------------------------ Allocation trace ------------------------------ */
+
+#define TRACE_TEST_OPS 3000u
+
+#if ENABLE_ALLOC_TRACE
+static void* trace_worker(void* arg) {
+  SlabAllocator* a = (SlabAllocator*)arg;
+  SlabHandle* hs = (SlabHandle*)calloc(TRACE_TEST_OPS, sizeof(SlabHandle));
+  if (!hs) exit(1);
+  EpochId e = epoch_current(a);
+  for (uint32_t i = 0; i < TRACE_TEST_OPS; i++) {
+    if (!alloc_obj_epoch(a, (i & 1) ? 200u : 64u, e, &hs[i])) exit(1);
+  }
+  for (uint32_t i = 0; i < TRACE_TEST_OPS; i++) {
+    if (!free_obj(a, hs[i])) exit(1);
+  }
+  free(hs);
+  return NULL;
+}
+
+static int cmp_trace_ts(const void* x, const void* y) {
+  const uint64_t* a = (const uint64_t*)x;
+  const uint64_t* b = (const uint64_t*)y;
+  if (a[0] != b[0]) return a[0] < b[0] ? -1 : 1;
+  return a[1] < b[1] ? -1 : (a[1] > b[1]);
+}
+#endif
+
+/* Traced threads, batches and epoch transitions come back from the file
+ * complete, and merging threads by rebuilt timestamp orders every free
+ * after the alloc of the same handle. */
+void smoke_test_trace(void) {
+  SlabAllocator* a = slab_allocator_create();
+  if (!a) exit(1);
+  char path[64];
+  snprintf(path, sizeof(path), "/tmp/tslab_smoke_trace_%d.bin", (int)getpid());
+  SlabTraceConfig cfg = { .path = path, .ring_records = 1u << 15, .flush_interval_ms = 5 };
+
+#if !ENABLE_ALLOC_TRACE
+  if (slab_trace_start(a, &cfg) || errno != ENOTSUP) exit(1);
+  slab_allocator_free(a);
+  printf("smoke_test_trace: SKIP (ENABLE_ALLOC_TRACE=0)\n");
+  return;
+#else
+  /* Not traced: before start */
+  SlabHandle h0;
+  if (!alloc_obj_epoch(a, 64, epoch_current(a), &h0)) exit(1);
+
+  if (!slab_trace_start(a, &cfg)) {
+    fprintf(stderr, "trace: start failed (errno=%d)\n", errno);
+    exit(1);
+  }
+  if (slab_trace_start(a, &cfg) || errno != EALREADY) exit(1);
+
+  pthread_t th[2];
+  for (int i = 0; i < 2; i++) pthread_create(&th[i], NULL, trace_worker, a);
+  for (int i = 0; i < 2; i++) pthread_join(th[i], NULL);
+
+  EpochId old = epoch_current(a);
+  epoch_advance(a);
+  EpochId e = epoch_current(a);
+  void* ptrs[16];
+  SlabHandle hs[16];
+  if (alloc_obj_epoch_batch(a, 128, e, ptrs, hs, 16) != 16) exit(1);
+  if (!free_obj(a, h0)) exit(1);  /* Free of an untraced alloc */
+  if (free_obj_batch(a, hs, 16) != 16) exit(1);
+  epoch_close(a, old);
+
+  slab_trace_stop(a);
+  SlabTraceStats ts;
+  slab_trace_stats(a, &ts);
+  /* Not traced: after stop */
+  if (!alloc_obj_epoch(a, 64, e, &h0) || !free_obj(a, h0)) exit(1);
+  slab_allocator_free(a);
+
+  /* 2 x (alloc + free) per worker op, 16 + 16 batch, 1 free, advance, close,
+   * plus one TIME record per thread */
+  const uint64_t ops = 4u * TRACE_TEST_OPS + 32u + 1u + 2u;
+  FILE* f = fopen(path, "rb");
+  if (!f) exit(1);
+  SlabTraceHeader hdr;
+  if (fread(&hdr, sizeof(hdr), 1, f) != 1) exit(1);
+  if (hdr.magic != SLAB_TRACE_MAGIC || hdr.version != SLAB_TRACE_VERSION ||
+      hdr.record_size != sizeof(SlabTraceRecord) || hdr.dropped != 0 || hdr.threads != 3 ||
+      hdr.records != ops + 3u || ts.records != hdr.records || ts.active || ts.error != 0 ||
+      hdr.epoch_count != EPOCH_COUNT || hdr.stop_ns < hdr.start_ns || hdr.num_classes == 0) {
+    fprintf(stderr, "trace: header records %lu (want %lu) dropped %lu threads %u\n",
+            (unsigned long)hdr.records, (unsigned long)(ops + 3u), (unsigned long)hdr.dropped, hdr.threads);
+    exit(1);
+  }
+  SlabTraceRecord* rec = (SlabTraceRecord*)malloc((size_t)hdr.records * sizeof(*rec));
+  uint64_t* order = (uint64_t*)malloc((size_t)hdr.records * 2u * sizeof(uint64_t));
+  if (!rec || !order) exit(1);
+  if (fread(rec, sizeof(*rec), (size_t)hdr.records, f) != hdr.records || fgetc(f) != EOF) exit(1);
+  fclose(f);
+  unlink(path);
+
+  /* Rebuild per-thread clocks, then merge */
+  uint64_t clock[4] = { 0 };
+  uint64_t n_op[8] = { 0 };
+  for (uint64_t i = 0; i < hdr.records; i++) {
+    SlabTraceRecord* r = &rec[i];
+    if (r->thread >= 3 || r->op == 0 || r->op > SLAB_TRACE_TIME) exit(1);
+    if (r->op == SLAB_TRACE_TIME) {
+      clock[r->thread] = r->handle;
+    } else {
+      if (clock[r->thread] == 0) exit(1);  /* First record must be TIME */
+      clock[r->thread] += r->delta_ns;
+    }
+    n_op[r->op]++;
+    order[2 * i] = clock[r->thread];
+    order[2 * i + 1] = i;
+  }
+  if (n_op[SLAB_TRACE_ALLOC] != 2u * TRACE_TEST_OPS + 16u || n_op[SLAB_TRACE_FREE] != 2u * TRACE_TEST_OPS + 17u ||
+      n_op[SLAB_TRACE_EPOCH_ADVANCE] != 1 || n_op[SLAB_TRACE_EPOCH_CLOSE] != 1 || n_op[SLAB_TRACE_TIME] != 3) {
+    fprintf(stderr, "trace: %lu allocs, %lu frees\n",
+            (unsigned long)n_op[SLAB_TRACE_ALLOC], (unsigned long)n_op[SLAB_TRACE_FREE]);
+    exit(1);
+  }
+  qsort(order, (size_t)hdr.records, 2u * sizeof(uint64_t), cmp_trace_ts);
+
+  /* Live-handle set: handles recur once freed, never while live */
+  const size_t cap = 1u << 14;
+  SlabHandle* live = (SlabHandle*)calloc(cap, sizeof(SlabHandle));
+  if (!live) exit(1);
+  uint64_t unmatched = 0;
+  for (uint64_t k = 0; k < hdr.records; k++) {
+    SlabTraceRecord* r = &rec[order[2 * k + 1]];
+    if (r->op != SLAB_TRACE_ALLOC && r->op != SLAB_TRACE_FREE) continue;
+    if (r->op == SLAB_TRACE_ALLOC && (r->handle == 0 || r->size_class >= hdr.num_classes ||
+                                      hdr.class_sizes[r->size_class] < r->size)) {
+      exit(1);
+    }
+    size_t j = (size_t)(r->handle * 0x9E3779B97F4A7C15ull >> 50) & (cap - 1u);
+    while (live[j] != 0 && live[j] != r->handle) j = (j + 1u) & (cap - 1u);
+    if (r->op == SLAB_TRACE_ALLOC) {
+      if (live[j] != 0) exit(1);  /* Handed out twice */
+      live[j] = r->handle;
+    } else if (live[j] == 0) {
+      unmatched++;
+    } else {
+      /* Backward-shift delete keeps probe chains intact */
+      size_t hole = j;
+      for (size_t m = (j + 1u) & (cap - 1u); live[m] != 0; m = (m + 1u) & (cap - 1u)) {
+        size_t home = (size_t)(live[m] * 0x9E3779B97F4A7C15ull >> 50) & (cap - 1u);
+        if (((m - home) & (cap - 1u)) >= ((m - hole) & (cap - 1u))) {
+          live[hole] = live[m];
+          hole = m;
+        }
+      }
+      live[hole] = 0;
+    }
+  }
+  for (size_t j = 0; j < cap; j++) {
+    if (live[j] != 0) exit(1);
+  }
+  if (unmatched != 1) {
+    fprintf(stderr, "trace: %lu frees without a prior alloc (want 1)\n", (unsigned long)unmatched);
+    exit(1);
+  }
+  free(live);
+  free(order);
+  free(rec);
+
+  printf("smoke_test_trace: PASS (%lu records, 3 threads)\n", (unsigned long)hdr.records);
+#endif
+}
+
+/* ------------------------------ Page geometry ------------------------------ */
+
+void smoke_test_page_units(void) {
+  /* Default: slab sizes are fixed, release units follow the OS page */
+  const uint32_t page = (uint32_t)sysconf(_SC_PAGESIZE);
+  SlabAllocator* d = slab_allocator_create();
+  if (!d) exit(1);
+  SlabGlobalStats gs;
+  SlabClassStats cs;
+  slab_stats_global(d, &gs);
+  if (gs.os_page_size != page || gs.hugepage_bytes != 0) {
+    fprintf(stderr, "page_units: os page %u (want %u), hugepage %u\n",
+            gs.os_page_size, page, gs.hugepage_bytes);
+    exit(1);
+  }
+  for (uint32_t ci = 0; ci < d->num_classes; ci++) {
+    slab_stats_class(d, ci, &cs);
+    uint32_t want = cs.slab_bytes > page ? cs.slab_bytes : page;
+    if (cs.release_bytes != want || (cs.object_size <= 768u && cs.slab_bytes != SLAB_PAGE_SIZE)) {
+      fprintf(stderr, "page_units: class %u slab %u release %u (want %u)\n",
+              ci, cs.slab_bytes, cs.release_bytes, want);
+      exit(1);
+    }
+  }
+  slab_allocator_free(d);
+
+  /* Huge-page arenas: every class is grouped, a unit goes back only whole */
+  SlabAllocatorConfig cfg = { .hugepage_slabs = true };
+  SlabAllocator* a = slab_allocator_create_with_config(&cfg);
+  if (!a) exit(1);
+  slab_stats_global(a, &gs);
+  if (gs.hugepage_bytes == 0) {
+    slab_allocator_free(a);
+    printf("smoke_test_page_units: PASS (no THP: huge pages ignored)\n");
+    return;
+  }
+  const uint32_t ci = (uint32_t)a->class_lookup[64];
+  slab_stats_class(a, ci, &cs);
+  const uint32_t per_unit = gs.hugepage_bytes / cs.slab_bytes;
+  if (cs.release_bytes != gs.hugepage_bytes || per_unit < 2) {
+    fprintf(stderr, "page_units: 64B release unit %u with %u huge pages\n",
+            cs.release_bytes, gs.hugepage_bytes);
+    exit(1);
+  }
+
+  /* One and a half units of cached slabs: pushes never advise a grouped
+   * class, and a trim returns the complete unit only */
+  const uint32_t n_slabs = per_unit + per_unit / 2u;
+  if (slab_reserve(a, ci, n_slabs, 0) != n_slabs) exit(1);
+  slab_stats_class(a, ci, &cs);
+  if (cs.cache_clean_slabs != 0 || cs.hugepage_arenas == 0) {
+    fprintf(stderr, "page_units: %u clean after reserve, %lu huge-page arenas\n",
+            cs.cache_clean_slabs, (unsigned long)cs.hugepage_arenas);
+    exit(1);
+  }
+#if ENABLE_RSS_RECLAMATION && defined(__linux__)
+  if (!slab_set_memory_budget(a, 1)) exit(1);
+  slab_stats_class(a, ci, &cs);
+  if (cs.cache_clean_slabs != per_unit || cs.release_units != 1 || cs.madvise_failures != 0 ||
+      cs.madvise_bytes != gs.hugepage_bytes) {
+    fprintf(stderr, "page_units: trim returned %u slabs in %lu units (%lu bytes, %lu failures)\n",
+            cs.cache_clean_slabs, (unsigned long)cs.release_units,
+            (unsigned long)cs.madvise_bytes, (unsigned long)cs.madvise_failures);
+    exit(1);
+  }
+  if (!slab_set_memory_budget(a, 0)) exit(1);
+#endif
+
+  /* Every reserved slab, returned or not, comes back with a fresh header */
+  const uint32_t per_slab = slab_object_count(64);
+  const size_t n = (size_t)n_slabs * per_slab;
+  SlabHandle* hs = (SlabHandle*)calloc(n, sizeof(SlabHandle));
+  if (!hs) exit(1);
+  EpochId e = epoch_current(a);
+  for (size_t i = 0; i < n; i++) {
+    uint32_t* p = (uint32_t*)alloc_obj_epoch(a, 64, e, &hs[i]);
+    if (!p) exit(1);
+    p[0] = (uint32_t)i;
+    p[15] = ~(uint32_t)i;
+  }
+  slab_stats_class(a, ci, &cs);
+  if (cs.new_slab_count != 0) {
+    fprintf(stderr, "page_units: %lu slabs carved past the reserve\n", (unsigned long)cs.new_slab_count);
+    exit(1);
+  }
+  for (size_t i = 0; i < n; i++) {
+    uint32_t* p = (uint32_t*)slab_handle_deref(a, hs[i]);
+    if (!p || p[0] != (uint32_t)i || p[15] != ~(uint32_t)i || !free_obj(a, hs[i])) {
+      fprintf(stderr, "page_units: object %zu wrong after unit reuse\n", i);
+      exit(1);
+    }
+  }
+  free(hs);
+  slab_allocator_free(a);
+  printf("smoke_test_page_units: PASS (%u slabs per %u KB unit)\n", per_unit, gs.hugepage_bytes / 1024u);
+}
+
+/* ------------------------------ Shard groups ------------------------------ */
+
+enum { GROUP_SHARDS = 3, GROUP_OBJS = 5000 };
+
+typedef struct GroupWorker {
+  SlabGroup* g;
+  uint32_t shard;
+  SlabHandle* own;    /* Allocated from this worker's shard */
+  SlabHandle* peer;   /* Next shard's handles, freed by this worker */
+  uint32_t freed;
+} GroupWorker;
+
+static void* group_alloc_worker(void* arg) {
+  GroupWorker* w = (GroupWorker*)arg;
+  SlabAllocator* a = slab_group_shard(w->g, w->shard);
+  EpochId e = epoch_current(a);
+  for (uint32_t i = 0; i < GROUP_OBJS; i++) {
+    uint32_t* p = (uint32_t*)alloc_obj_epoch(a, 128, e, &w->own[i]);
+    if (!p) return (void*)1;
+    p[0] = w->shard;
+    p[1] = i;
+  }
+  return NULL;
+}
+
+static void* group_free_worker(void* arg) {
+  GroupWorker* w = (GroupWorker*)arg;
+  for (uint32_t i = 0; i < GROUP_OBJS; i += 100) {
+    w->freed += slab_group_free_batch(w->g, w->peer + i, 100);
+  }
+  return NULL;
+}
+
+void smoke_test_group(void) {
+  /* Routing: three shards take two bits of the slab_id field */
+  SlabGroupConfig cfg = { .shards = GROUP_SHARDS, .depot_bytes = UINT64_MAX };
+  SlabGroup* g = slab_group_create(&cfg);
+  if (!g || slab_group_shards(g) != GROUP_SHARDS || slab_group_shard(g, GROUP_SHARDS) != NULL) exit(1);
+  slab_epoch_set_label(slab_group_shard(g, 0), epoch_current(slab_group_shard(g, 0)), "req");
+  slab_epoch_set_label(slab_group_shard(g, 1), epoch_current(slab_group_shard(g, 1)), "bg");
+  slab_epoch_set_label(slab_group_shard(g, 2), epoch_current(slab_group_shard(g, 2)), "req");
+
+  GroupWorker w[GROUP_SHARDS];
+  pthread_t th[GROUP_SHARDS];
+  for (uint32_t i = 0; i < GROUP_SHARDS; i++) {
+    w[i] = (GroupWorker){ .g = g, .shard = i };
+    w[i].own = (SlabHandle*)calloc(GROUP_OBJS, sizeof(SlabHandle));
+    if (!w[i].own) exit(1);
+  }
+  for (uint32_t i = 0; i < GROUP_SHARDS; i++) {
+    w[i].peer = w[(i + 1) % GROUP_SHARDS].own;
+    if (pthread_create(&th[i], NULL, group_alloc_worker, &w[i]) != 0) exit(1);
+  }
+  for (uint32_t i = 0; i < GROUP_SHARDS; i++) {
+    void* rc;
+    pthread_join(th[i], &rc);
+    if (rc) exit(1);
+  }
+  for (uint32_t i = 0; i < GROUP_SHARDS; i++) {
+    SlabAllocator* a = slab_group_shard(g, i);
+    SlabAllocator* other = slab_group_shard(g, (i + 1) % GROUP_SHARDS);
+    for (uint32_t k = 0; k < GROUP_OBJS; k++) {
+      SlabHandle h = w[i].own[k];
+      uint32_t* p = (uint32_t*)slab_handle_deref(a, h);
+      if (slab_group_shard_of(g, h) != i || !p || p[0] != i || p[1] != k ||
+          slab_handle_deref(other, h) != NULL) {
+        fprintf(stderr, "group: handle %u of shard %u routes to %u\n", k, i, slab_group_shard_of(g, h));
+        exit(1);
+      }
+    }
+    /* Another shard rejects the handle without touching its slabs */
+    if (free_obj(other, w[i].own[0])) exit(1);
+  }
+
+  /* Merged stats while everything is live: labels matched by name */
+  SlabGlobalStats gs, s0, s2;
+  slab_group_stats_global(g, &gs);
+  slab_stats_global(slab_group_shard(g, 0), &s0);
+  slab_stats_global(slab_group_shard(g, 2), &s2);
+  uint64_t allocated = 0;
+  for (uint32_t i = 0; i < GROUP_SHARDS; i++) {
+    SlabGlobalStats si;
+    slab_stats_global(slab_group_shard(g, i), &si);
+    allocated += si.total_slabs_allocated;
+  }
+  if (gs.total_slabs_allocated != allocated || gs.label_count != 3 ||
+      gs.label_committed_bytes[1] != s0.label_committed_bytes[1] + s2.label_committed_bytes[1] ||
+      gs.label_committed_bytes[1] == 0 || gs.label_committed_bytes[2] == 0) {
+    fprintf(stderr, "group: merged stats %lu slabs (shards %lu), %u labels, req %lu bytes\n",
+            (unsigned long)gs.total_slabs_allocated, (unsigned long)allocated, gs.label_count,
+            (unsigned long)gs.label_committed_bytes[1]);
+    exit(1);
+  }
+
+  /* Cross-shard frees: each worker frees the next shard's objects */
+  for (uint32_t i = 0; i < GROUP_SHARDS; i++) {
+    if (pthread_create(&th[i], NULL, group_free_worker, &w[i]) != 0) exit(1);
+  }
+  for (uint32_t i = 0; i < GROUP_SHARDS; i++) {
+    pthread_join(th[i], NULL);
+    if (w[i].freed != GROUP_OBJS) {
+      fprintf(stderr, "group: worker %u freed %u of the next shard's %u objects\n",
+              i, w[i].freed, (unsigned)GROUP_OBJS);
+      exit(1);
+    }
+  }
+  if (slab_group_free(g, w[0].own[0])) exit(1);  /* Double free */
+
+  /* A shard field naming no shard (index 3 of 3) is counted, not followed */
+  SlabGroupStats st;
+  if (slab_group_free(g, w[0].own[1] | (3ull << 62))) exit(1);
+  slab_group_stats(g, &st);
+  if (st.shard_bits != 2 || st.shard_max_slabs != (1u << 23) || st.misrouted_frees != 1) {
+    fprintf(stderr, "group: %u shard bits, %u slabs per shard, %lu misrouted\n",
+            st.shard_bits, st.shard_max_slabs, (unsigned long)st.misrouted_frees);
+    exit(1);
+  }
+  for (uint32_t i = 0; i < GROUP_SHARDS; i++) free(w[i].own);
+  slab_group_destroy(g);
+
+  /* Depot: shard 0 idles on a reserve, shard 1 keeps taking slabs. A cap
+   * that fits only shard 1's cache drains shard 0 and leaves shard 1 warm. */
+  cfg = (SlabGroupConfig){ .shards = 2, .depot_bytes = UINT64_MAX };
+  g = slab_group_create(&cfg);
+  if (!g) exit(1);
+  SlabAllocator* cold = slab_group_shard(g, 0);
+  SlabAllocator* hot = slab_group_shard(g, 1);
+  const uint32_t ci = (uint32_t)cold->class_lookup[128];
+  const uint32_t reserve = 200;
+  if (slab_reserve(cold, ci, reserve, 0) != reserve || slab_reserve(hot, ci, reserve, 0) != reserve) exit(1);
+  (void)slab_group_rebalance(g);  /* Under the cap: only sets the demand baseline */
+  SlabHandle* hs = (SlabHandle*)calloc(2000, sizeof(SlabHandle));
+  if (!hs) exit(1);
+  for (int i = 0; i < 2000; i++) {
+    if (!alloc_obj_epoch(hot, 128, epoch_current(hot), &hs[i])) exit(1);
+  }
+  slab_group_stats(g, &st);
+  const uint64_t hot_idle = st.shard[1].idle_bytes;
+  const uint64_t slab_bytes = cold->classes[ci].slab_bytes;
+  if (st.depot_trimmed_bytes != 0 || st.shard[0].idle_bytes != reserve * slab_bytes || hot_idle == 0 ||
+      st.shard[1].slab_demand <= st.shard[0].slab_demand) {
+    fprintf(stderr, "group: idle %lu / %lu bytes before the cap\n",
+            (unsigned long)st.shard[0].idle_bytes, (unsigned long)hot_idle);
+    exit(1);
+  }
+  if (!slab_group_set_depot(g, hot_idle)) exit(1);
+  slab_group_stats(g, &st);
+#if ENABLE_RSS_RECLAMATION && defined(__linux__)
+  if (st.depot_passes != 1 || st.shard[0].depot_trimmed_bytes != reserve * slab_bytes ||
+      st.shard[0].idle_bytes != 0 || st.shard[1].depot_trimmed_bytes != 0 ||
+      st.shard[1].idle_bytes != hot_idle || st.idle_bytes > st.depot_bytes) {
+    fprintf(stderr, "group: depot %lu trimmed %lu / %lu bytes, idle %lu / %lu\n",
+            (unsigned long)st.depot_bytes, (unsigned long)st.shard[0].depot_trimmed_bytes,
+            (unsigned long)st.shard[1].depot_trimmed_bytes, (unsigned long)st.shard[0].idle_bytes,
+            (unsigned long)st.shard[1].idle_bytes);
+    exit(1);
+  }
+#endif
+  for (int i = 0; i < 2000; i++) {
+    if (!slab_group_free(g, hs[i])) exit(1);
+  }
+  errno = 0;
+  if (slab_group_set_depot(NULL, 1) || errno != EINVAL) exit(1);
+  if (!slab_group_set_depot(g, 0)) exit(1);
+  slab_group_stats(g, &st);
+  if (st.depot_bytes != 2 * SLAB_GROUP_DEPOT_PER_SHARD) exit(1);
+  free(hs);
+  slab_group_destroy(g);
+
+  /* Cross-shard: shard 0 parks a reserve over the cap and then does
+   * nothing. Shard 1's first carve runs the group check and trims shard 0,
+   * but still carves its own slab (slabs never change shard). */
+  cfg = (SlabGroupConfig){ .shards = 2, .depot_bytes = 1 };
+  g = slab_group_create(&cfg);
+  if (!g) exit(1);
+  cold = slab_group_shard(g, 0);
+  hot = slab_group_shard(g, 1);
+  if (slab_reserve(cold, ci, 64, 0) != 64) exit(1);
+  slab_group_stats(g, &st);
+  if (st.depot_checks != 0 || st.shard[0].idle_bytes != 64 * slab_bytes) exit(1);
+  SlabHandle hh, ch;
+  if (!alloc_obj_epoch(hot, 128, epoch_current(hot), &hh)) exit(1);
+  slab_group_stats(g, &st);
+  const uint64_t hot_carved = atomic_load_explicit(&hot->classes[ci].new_slab_count, memory_order_relaxed);
+  if (st.depot_checks != 1 || st.depot_passes != 1 || hot_carved != 1 ||
+      st.shard[1].depot_trimmed_bytes != 0) {
+    fprintf(stderr, "group: carve on shard 1 ran %lu checks (%lu over), carved %lu slabs\n",
+            (unsigned long)st.depot_checks, (unsigned long)st.depot_passes, (unsigned long)hot_carved);
+    exit(1);
+  }
+#if ENABLE_RSS_RECLAMATION && defined(__linux__)
+  if (st.shard[0].depot_trimmed_bytes != 64 * slab_bytes || st.shard[0].idle_bytes != 0) {
+    fprintf(stderr, "group: shard 1's carve trimmed %lu of shard 0's bytes, %lu still idle\n",
+            (unsigned long)st.shard[0].depot_trimmed_bytes, (unsigned long)st.shard[0].idle_bytes);
+    exit(1);
+  }
+#endif
+  /* The trimmed shard still allocates from its own cache */
+  if (!alloc_obj_epoch(cold, 128, epoch_current(cold), &ch) || slab_group_shard_of(g, ch) != 0 ||
+      slab_group_shard_of(g, hh) != 1 || !slab_group_free(g, ch) || !slab_group_free(g, hh) ||
+      atomic_load_explicit(&cold->classes[ci].new_slab_count, memory_order_relaxed) != 0) {
+    exit(1);
+  }
+  slab_group_destroy(g);
+
+  cfg = (SlabGroupConfig){ .shards = SLAB_GROUP_MAX_SHARDS + 1 };
+  errno = 0;
+  if (slab_group_create(&cfg) != NULL || errno != EINVAL) exit(1);
+
+  printf("smoke_test_group: PASS (%u shards, %u cross-shard frees, depot kept %lu of %lu idle bytes)\n",
+         (unsigned)GROUP_SHARDS, (unsigned)(GROUP_SHARDS * GROUP_OBJS),
+         (unsigned long)hot_idle, (unsigned long)(hot_idle + reserve * slab_bytes));
+}
+
+#if ENABLE_TLS_CACHE
+/* ------------------------------ TLS thread churn ------------------------------ */
+
+static void* tls_churn_worker(void* arg) {
+  SlabAllocator* a = (SlabAllocator*)arg;
+  SlabHandle h[8];
+  for (int i = 0; i < 8; i++) {
+    if (!alloc_obj_epoch(a, 64, 0, &h[i])) return (void*)1;
+  }
+  for (int i = 0; i < 8; i++) {
+    if (!free_obj(a, h[i])) return (void*)1;
+  }
+  return NULL;  /* Exit with a populated bin: key destructor must flush it */
+}
+
+void smoke_test_tls_thread_churn(void) {
+  SlabAllocator* a = slab_allocator_create();
+  if (!a) exit(1);
+
+  /* Far more threads than the old fixed 128-entry registry, in waves */
+  uint32_t base = _thread_count;
+  for (int wave = 0; wave < 10; wave++) {
+    pthread_t th[64];
+    for (int i = 0; i < 64; i++) pthread_create(&th[i], NULL, tls_churn_worker, a);
+    for (int i = 0; i < 64; i++) {
+      void* rc;
+      pthread_join(th[i], &rc);
+      if (rc) {
+        fprintf(stderr, "tls churn worker failed\n");
+        exit(1);
+      }
+    }
+  }
+  if (_thread_count != base) {
+    fprintf(stderr, "thread registry leaked: %u live, expected %u\n", _thread_count, base);
+    exit(1);
+  }
+
+  /* Flush request is async: our own bin for epoch 1 is dropped at our next alloc */
+  SlabHandle h;
+  if (!alloc_obj_epoch(a, 64, 1, &h) || !free_obj(a, h)) exit(1);
+  uint32_t rejects = _tls_self->caches[0].tls_epoch_rejects;
+  epoch_close(a, 1);
+  if (!alloc_obj_epoch(a, 64, 2, &h) || !free_obj(a, h)) exit(1);
+  if (_tls_self->caches[0].tls_epoch_rejects != rejects + 1) {
+    fprintf(stderr, "stale epoch bin not dropped by its owner\n");
+    exit(1);
+  }
+
+  slab_allocator_free(a);
+  printf("smoke_test_tls_thread_churn: PASS (640 threads, registry back to %u)\n", base);
+}
+
+#endif
+
 /* ------------------------------ Micro bench ------------------------------ */
 
 void micro_bench(void) {
@@ -185,6 +2996,112 @@ int main(void) {
   fflush(stdout);
   smoke_test_multi_thread();
   
+  printf("Starting smoke_test_percpu_slots...\n");
+  fflush(stdout);
+  smoke_test_percpu_slots();
+  
+  printf("Starting smoke_test_arena_carving...\n");
+  fflush(stdout);
+  smoke_test_arena_carving();
+  
+  printf("Starting smoke_test_large_objects...\n");
+  fflush(stdout);
+  smoke_test_large_objects();
+  
+  printf("Starting smoke_test_batch_api...\n");
+  fflush(stdout);
+  smoke_test_batch_api();
+  
+  printf("Starting smoke_test_epoch_release_all...\n");
+  fflush(stdout);
+  smoke_test_epoch_release_all();
+  
+  printf("Starting smoke_test_cache_concurrent...\n");
+  fflush(stdout);
+  smoke_test_cache_concurrent();
+  
+  printf("Starting smoke_test_reclaimer...\n");
+  fflush(stdout);
+  smoke_test_reclaimer();
+  
+  printf("Starting smoke_test_reclaim_modes...\n");
+  fflush(stdout);
+  smoke_test_reclaim_modes();
+  
+  printf("Starting smoke_test_remote_free...\n");
+  fflush(stdout);
+  smoke_test_remote_free();
+  
+  printf("Starting smoke_test_registry...\n");
+  fflush(stdout);
+  smoke_test_registry();
+  
+  printf("Starting smoke_test_bump_alloc...\n");
+  fflush(stdout);
+  smoke_test_bump_alloc();
+  
+  printf("Starting smoke_test_bitmap_scan...\n");
+  fflush(stdout);
+  smoke_test_bitmap_scan();
+  
+  printf("Starting smoke_test_slab_reserve...\n");
+  fflush(stdout);
+  smoke_test_slab_reserve();
+  
+  printf("Starting smoke_test_epoch_ring...\n");
+  fflush(stdout);
+  smoke_test_epoch_ring();
+  
+  printf("Starting smoke_test_latency_hist...\n");
+  fflush(stdout);
+  smoke_test_latency_hist();
+  
+  printf("Starting smoke_test_stats_shm...\n");
+  fflush(stdout);
+  smoke_test_stats_shm();
+  
+  printf("Starting smoke_test_epoch_churn...\n");
+  fflush(stdout);
+  smoke_test_epoch_churn();
+  
+  printf("Starting smoke_test_domain_alloc...\n");
+  fflush(stdout);
+  smoke_test_domain_alloc();
+  
+  printf("Starting smoke_test_slab_compact...\n");
+  fflush(stdout);
+  smoke_test_slab_compact();
+  
+  printf("Starting smoke_test_cache_adapt...\n");
+  fflush(stdout);
+  smoke_test_cache_adapt();
+  
+  printf("Starting smoke_test_label_quota...\n");
+  fflush(stdout);
+  smoke_test_label_quota();
+  
+  printf("Starting smoke_test_empty_list...\n");
+  fflush(stdout);
+  smoke_test_empty_list();
+  
+  printf("Starting smoke_test_trace...\n");
+  fflush(stdout);
+  smoke_test_trace();
+  
+  printf("Starting smoke_test_page_units...\n");
+  fflush(stdout);
+  smoke_test_page_units();
+  
+  printf("Starting smoke_test_group...\n");
+  fflush(stdout);
+  smoke_test_group();
+  
+#if ENABLE_TLS_CACHE
+  printf("Starting smoke_test_tls_thread_churn...\n");
+  fflush(stdout);
+  smoke_test_tls_thread_churn();
+  
+#endif
   printf("Starting micro_bench...\n");
   fflush(stdout);
   micro_bench();
@@ -7,8 +7,12 @@
  * 
  * Phase 3: Added --doctor mode for actionable diagnostics
  * 
+ * --attach <pid> reads another process's shared-memory stats segment
+ * (slab_stats_shm_start) instead of running the built-in workload.
+ * 
  * Usage:
  *   ./stats_dump [--json] [--text] [--doctor]
+ *   ./stats_dump --attach <pid> [--json] [--text] [--openmetrics]
  *   Default: --json --text (both outputs)
  *   
  * Examples:
@@ -17,6 +21,7 @@
  *   ./stats_dump --no-json          # Text only to stderr
  *   ./stats_dump 2>/dev/null        # JSON only to stdout
  *   ./stats_dump --doctor           # Actionable diagnostics (Phase 3)
+ *   ./stats_dump --attach 4242 --openmetrics   # Scrape a live process
  */
 
 #include <slab_alloc.h>
@@ -27,6 +32,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <errno.h>
 #include <time.h>
 #include <unistd.h>
 #include <sys/types.h>
@@ -35,10 +41,21 @@
 static bool flag_json = true;
 static bool flag_text = true;
 static bool flag_doctor = false;
+static bool flag_openmetrics = false;
+static long attach_pid = 0;  /* --attach <pid>; 0 = run the built-in workload */
 
 static void parse_args(int argc, char** argv) {
   for (int i = 1; i < argc; i++) {
-    if (strcmp(argv[i], "--json") == 0) {
+    if (strcmp(argv[i], "--attach") == 0 && i + 1 < argc) {
+      attach_pid = strtol(argv[++i], NULL, 10);
+      if (attach_pid <= 0) {
+        fprintf(stderr, "--attach: invalid pid '%s'\n", argv[i]);
+        exit(1);
+      }
+    } else if (strcmp(argv[i], "--openmetrics") == 0) {
+      flag_openmetrics = true;
+      flag_json = false;  /* OpenMetrics replaces JSON on stdout */
+    } else if (strcmp(argv[i], "--json") == 0) {
       flag_json = true;
     } else if (strcmp(argv[i], "--no-json") == 0) {
       flag_json = false;
@@ -51,7 +68,9 @@ static void parse_args(int argc, char** argv) {
       flag_json = false;  /* Doctor mode replaces JSON */
       flag_text = false;  /* Doctor mode replaces text */
     } else {
-      fprintf(stderr, "Usage: %s [--json] [--no-json] [--text] [--no-text] [--doctor]\n", argv[0]);
+      fprintf(stderr, "Usage: %s [--json] [--no-json] [--text] [--no-text] [--doctor]\n"
+                      "       %s --attach <pid> [--json] [--no-json] [--text] [--no-text] [--openmetrics]\n",
+              argv[0], argv[0]);
       exit(1);
     }
   }
@@ -85,6 +104,11 @@ static void print_json_string(const char* s) {
   printf("\"");
 }
 
+/* JSON keys / text labels for SlabLatencyOp */
+static const char* const k_lat_op_names[SLAB_LAT_OPS] = {
+  "alloc_fast", "alloc_slow", "free", "new_slab", "epoch_close"
+};
+
 static void print_json_global(SlabAllocator* alloc) {
   SlabGlobalStats gs;
   slab_stats_global(alloc, &gs);
@@ -101,11 +125,12 @@ static void print_json_global(SlabAllocator* alloc) {
   printf("  \"timestamp_ns\": %lu,\n", timestamp_ns);
   printf("  \"pid\": %d,\n", (int)pid);
   printf("  \"page_size\": %ld,\n", page_size);
-  printf("  \"epoch_count\": 16,\n");  /* Hardcoded: allocator doesn't expose epoch_count publicly */
+  printf("  \"epoch_count\": %u,\n", gs.epoch_count);
   printf("  \"version\": %u,\n", gs.version);
   printf("  \"current_epoch\": %u,\n", gs.current_epoch);
   printf("  \"active_epoch_count\": %u,\n", gs.active_epoch_count);
   printf("  \"closing_epoch_count\": %u,\n", gs.closing_epoch_count);
+  printf("  \"epoch_stale_rejects\": %lu,\n", gs.epoch_stale_rejects);
   printf("  \"total_slabs_allocated\": %lu,\n", gs.total_slabs_allocated);
   printf("  \"total_slabs_recycled\": %lu,\n", gs.total_slabs_recycled);
   printf("  \"net_slabs\": %lu,\n", gs.net_slabs);
@@ -118,12 +143,51 @@ static void print_json_global(SlabAllocator* alloc) {
   printf("  \"total_madvise_calls\": %lu,\n", gs.total_madvise_calls);
   printf("  \"total_madvise_bytes\": %lu,\n", gs.total_madvise_bytes);
   printf("  \"total_madvise_failures\": %lu,\n", gs.total_madvise_failures);
+  printf("  \"total_madvise_batches\": %lu,\n", gs.total_madvise_batches);
+  printf("  \"total_madvise_ranges\": %lu,\n", gs.total_madvise_ranges);
+  printf("  \"reclaim_mode\": %u,\n", gs.reclaim_mode);
+  printf("  \"total_remote_frees\": %lu,\n", gs.total_remote_frees);
+  printf("  \"total_remote_drains\": %lu,\n", gs.total_remote_drains);
+  printf("  \"total_remote_drained_objects\": %lu,\n", gs.total_remote_drained_objects);
+  printf("  \"total_bump_allocs\": %lu,\n", gs.total_bump_allocs);
+  printf("  \"registry_ids_issued\": %u,\n", gs.registry_ids_issued);
+  printf("  \"registry_ids_free\": %u,\n", gs.registry_ids_free);
+  printf("  \"registry_ids_recycled\": %lu,\n", gs.registry_ids_recycled);
   printf("  \"total_bitmap_alloc_cas_retries\": %lu,\n", gs.total_bitmap_alloc_cas_retries);
   printf("  \"total_bitmap_free_cas_retries\": %lu,\n", gs.total_bitmap_free_cas_retries);
   printf("  \"total_current_partial_cas_failures\": %lu,\n", gs.total_current_partial_cas_failures);
   printf("  \"total_bitmap_alloc_attempts\": %lu,\n", gs.total_bitmap_alloc_attempts);
   printf("  \"total_bitmap_free_attempts\": %lu,\n", gs.total_bitmap_free_attempts);
   printf("  \"total_current_partial_cas_attempts\": %lu,\n", gs.total_current_partial_cas_attempts);
+  printf("  \"total_arena_count\": %lu,\n", gs.total_arena_count);
+  printf("  \"total_arena_reserved_bytes\": %lu,\n", gs.total_arena_reserved_bytes);
+  printf("  \"total_arena_committed_bytes\": %lu,\n", gs.total_arena_committed_bytes);
+  printf("  \"os_page_size\": %u,\n", gs.os_page_size);
+  printf("  \"hugepage_bytes\": %u,\n", gs.hugepage_bytes);
+  printf("  \"memory_budget_bytes\": %lu,\n", gs.memory_budget_bytes);
+  printf("  \"resident_estimate_bytes\": %lu,\n", gs.resident_estimate_bytes);
+  printf("  \"budget_enforcements\": %lu,\n", gs.budget_enforcements);
+  printf("  \"reclaim_running\": %u,\n", gs.reclaim_running);
+  printf("  \"reclaim_pending\": %u,\n", gs.reclaim_pending);
+  printf("  \"reclaim_submitted\": %lu,\n", gs.reclaim_submitted);
+  printf("  \"reclaim_completed\": %lu,\n", gs.reclaim_completed);
+  printf("  \"reclaim_abandoned\": %lu,\n", gs.reclaim_abandoned);
+  printf("  \"reclaim_budget_pauses\": %lu,\n", gs.reclaim_budget_pauses);
+  
+  /* Latency histograms (ENABLE_LATENCY_HIST builds), summarized as percentiles */
+  printf("  \"latency_enabled\": %u,\n", gs.latency_enabled);
+  printf("  \"latency_sample_shift\": %u,\n", gs.latency_sample_shift);
+  printf("  \"latency\": {\n");
+  for (uint32_t op = 0; op < SLAB_LAT_OPS; op++) {
+    const SlabLatencyHist* h = &gs.latency[op];
+    printf("    \"%s\": {\"count\": %lu, \"mean_ns\": %lu, \"p50_ns\": %lu, "
+           "\"p99_ns\": %lu, \"p999_ns\": %lu, \"max_ns\": %lu}%s\n",
+           k_lat_op_names[op], h->count, h->count ? h->sum_ns / h->count : 0,
+           slab_latency_percentile(h, 0.50), slab_latency_percentile(h, 0.99),
+           slab_latency_percentile(h, 0.999), slab_latency_percentile(h, 1.0),
+           op + 1 < SLAB_LAT_OPS ? "," : "");
+  }
+  printf("  },\n");
   
   /* Phase 2.3: Label registry export (for decoding label_ids in per-label metrics) */
   printf("  \"label_registry\": {\n");
@@ -139,12 +203,21 @@ static void print_json_global(SlabAllocator* alloc) {
       printf("\n");
     }
   }
+  printf("    },\n");
+  printf("    \"quotas\": {\n");
+  for (uint32_t lid = 0; lid < gs.label_count && lid < MAX_LABEL_IDS; lid++) {
+    printf("      \"%u\": {\"committed_bytes\": %lu, \"peak_bytes\": %lu, "
+           "\"quota_bytes\": %lu, \"denials\": %lu}%s\n",
+           lid, gs.label_committed_bytes[lid], gs.label_peak_bytes[lid],
+           gs.label_quota_bytes[lid], gs.label_quota_denials[lid],
+           lid + 1 < gs.label_count ? "," : "");
+  }
   printf("    }\n");
   printf("  },\n");
   
   printf("  \"classes\": [\n");
   
-  for (uint32_t cls = 0; cls < 8; cls++) {
+  for (uint32_t cls = 0; cls < alloc->num_classes; cls++) {
     SlabClassStats cs;
     slab_stats_class(alloc, cls, &cs);
     
@@ -152,6 +225,8 @@ static void print_json_global(SlabAllocator* alloc) {
     printf("      \"version\": %u,\n", cs.version);
     printf("      \"class_index\": %u,\n", cs.class_index);
     printf("      \"object_size\": %u,\n", cs.object_size);
+    printf("      \"slab_bytes\": %u,\n", cs.slab_bytes);
+    printf("      \"release_bytes\": %u,\n", cs.release_bytes);
     printf("      \"slow_path_hits\": %lu,\n", cs.slow_path_hits);
     printf("      \"new_slab_count\": %lu,\n", cs.new_slab_count);
     printf("      \"list_move_partial_to_full\": %lu,\n", cs.list_move_partial_to_full);
@@ -165,10 +240,19 @@ static void print_json_global(SlabAllocator* alloc) {
     printf("      \"madvise_calls\": %lu,\n", cs.madvise_calls);
     printf("      \"madvise_bytes\": %lu,\n", cs.madvise_bytes);
     printf("      \"madvise_failures\": %lu,\n", cs.madvise_failures);
+    printf("      \"madvise_batches\": %lu,\n", cs.madvise_batches);
+    printf("      \"madvise_ranges\": %lu,\n", cs.madvise_ranges);
+    printf("      \"remote_frees\": %lu,\n", cs.remote_frees);
+    printf("      \"remote_drains\": %lu,\n", cs.remote_drains);
+    printf("      \"remote_drained_objects\": %lu,\n", cs.remote_drained_objects);
+    printf("      \"bump_allocs\": %lu,\n", cs.bump_allocs);
+    printf("      \"bump_retires\": %lu,\n", cs.bump_retires);
     printf("      \"epoch_close_calls\": %lu,\n", cs.epoch_close_calls);
     printf("      \"epoch_close_scanned_slabs\": %lu,\n", cs.epoch_close_scanned_slabs);
     printf("      \"epoch_close_recycled_slabs\": %lu,\n", cs.epoch_close_recycled_slabs);
     printf("      \"epoch_close_total_ns\": %lu,\n", cs.epoch_close_total_ns);
+    printf("      \"epoch_release_slabs\": %lu,\n", cs.epoch_release_slabs);
+    printf("      \"epoch_release_objects\": %lu,\n", cs.epoch_release_objects);
     printf("      \"bitmap_alloc_cas_retries\": %lu,\n", cs.bitmap_alloc_cas_retries);
     printf("      \"bitmap_free_cas_retries\": %lu,\n", cs.bitmap_free_cas_retries);
     printf("      \"current_partial_cas_failures\": %lu,\n", cs.current_partial_cas_failures);
@@ -228,15 +312,40 @@ static void print_json_global(SlabAllocator* alloc) {
     printf("      },\n");
 #endif
     
+    printf("      \"arena_count\": %lu,\n", cs.arena_count);
+    printf("      \"arena_reserved_bytes\": %lu,\n", cs.arena_reserved_bytes);
+    printf("      \"arena_committed_bytes\": %lu,\n", cs.arena_committed_bytes);
     printf("      \"cache_size\": %u,\n", cs.cache_size);
     printf("      \"cache_capacity\": %u,\n", cs.cache_capacity);
     printf("      \"cache_overflow_len\": %u,\n", cs.cache_overflow_len);
+    printf("      \"cache_cas_retries\": %lu,\n", cs.cache_cas_retries);
+    printf("      \"cache_clean_slabs\": %u,\n", cs.cache_clean_slabs);
+    printf("      \"cache_target_grows\": %u,\n", cs.cache_target_grows);
+    printf("      \"cache_target_shrinks\": %u,\n", cs.cache_target_shrinks);
+    printf("      \"cache_trims\": %lu,\n", cs.cache_trims);
+    printf("      \"cache_trimmed_slabs\": %lu,\n", cs.cache_trimmed_slabs);
+    printf("      \"release_units\": %lu,\n", cs.release_units);
+    printf("      \"hugepage_arenas\": %lu,\n", cs.hugepage_arenas);
+    printf("      \"reserved_slabs\": %lu,\n", cs.reserved_slabs);
+    printf("      \"warm_floor\": %u,\n", cs.warm_floor);
+    printf("      \"warm_madvise_skips\": %lu,\n", cs.warm_madvise_skips);
+    printf("      \"numa_nodes\": %u,\n", cs.numa_nodes);
+    printf("      \"numa_slabs_carved\": [");
+    for (uint32_t n = 0; n < cs.numa_nodes; n++) printf("%s%lu", n ? ", " : "", cs.numa_slabs_carved[n]);
+    printf("],\n");
+    printf("      \"numa_cache_pops_local\": [");
+    for (uint32_t n = 0; n < cs.numa_nodes; n++) printf("%s%lu", n ? ", " : "", cs.numa_cache_pops_local[n]);
+    printf("],\n");
+    printf("      \"numa_cache_pops_remote\": [");
+    for (uint32_t n = 0; n < cs.numa_nodes; n++) printf("%s%lu", n ? ", " : "", cs.numa_cache_pops_remote[n]);
+    printf("],\n");
     printf("      \"total_partial_slabs\": %u,\n", cs.total_partial_slabs);
     printf("      \"total_full_slabs\": %u,\n", cs.total_full_slabs);
+    printf("      \"total_empty_slabs\": %u,\n", cs.total_empty_slabs);
     printf("      \"recycle_rate_pct\": %.2f,\n", cs.recycle_rate_pct);
     printf("      \"net_slabs\": %lu,\n", cs.net_slabs);
     printf("      \"estimated_rss_bytes\": %lu\n", cs.estimated_rss_bytes);
-    printf("    }%s\n", cls < 7 ? "," : "");
+    printf("    }%s\n", cls < alloc->num_classes - 1 ? "," : "");
   }
   
   printf("  ],\n");  /* Changed: added comma for epochs array */
@@ -244,19 +353,23 @@ static void print_json_global(SlabAllocator* alloc) {
   /* Phase 2.3: Epochs array (optional field for backward compat) */
   printf("  \"epochs\": [\n");
   
-  for (uint32_t epoch_id = 0; epoch_id < 16; epoch_id++) {
+  for (uint32_t epoch_id = 0; epoch_id < gs.epoch_count; epoch_id++) {
     /* Aggregate epoch stats across all size classes */
     uint64_t total_partial = 0;
     uint64_t total_full = 0;
+    uint64_t total_empty = 0;
     uint64_t total_reclaimable = 0;
+    uint64_t total_rss = 0;
     
-    for (uint32_t cls = 0; cls < 8; cls++) {
+    for (uint32_t cls = 0; cls < alloc->num_classes; cls++) {
       SlabEpochStats es;
       slab_stats_epoch(alloc, cls, epoch_id, &es);
       
       total_partial += es.partial_slab_count;
       total_full += es.full_slab_count;
+      total_empty += es.empty_slab_count;
       total_reclaimable += es.reclaimable_slab_count;
+      total_rss += es.estimated_rss_bytes;  /* Weighted by per-class slab size */
     }
     
     /* Get metadata */
@@ -285,8 +398,9 @@ static void print_json_global(SlabAllocator* alloc) {
     printf(",\n");
     printf("      \"total_partial_slabs\": %lu,\n", total_partial);
     printf("      \"total_full_slabs\": %lu,\n", total_full);
+    printf("      \"total_empty_slabs\": %lu,\n", total_empty);
     printf("      \"total_reclaimable_slabs\": %lu,\n", total_reclaimable);
-    printf("      \"estimated_rss_bytes\": %lu\n", (total_partial + total_full) * 4096);
+    printf("      \"estimated_rss_bytes\": %lu\n", total_rss);
     printf("    }%s\n", epoch_id < 15 ? "," : "");
   }
   
@@ -296,37 +410,65 @@ static void print_json_global(SlabAllocator* alloc) {
 
 /* ==================== Text Output (stderr) ==================== */
 
-static void print_text_global(SlabAllocator* alloc) {
-  SlabGlobalStats gs;
-  slab_stats_global(alloc, &gs);
-  
+static void print_text_global_stats(const SlabGlobalStats* gs) {
   fprintf(stderr, "=== temporal-slab Stats Snapshot ===\n\n");
   
   fprintf(stderr, "Global:\n");
-  fprintf(stderr, "  Current epoch: %u\n", gs.current_epoch);
-  fprintf(stderr, "  Active epochs: %u | Closing: %u\n",
-          gs.active_epoch_count, gs.closing_epoch_count);
+  fprintf(stderr, "  Current epoch: %u\n", gs->current_epoch);
+  fprintf(stderr, "  Active epochs: %u | Closing: %u | Ring: %u (stale IDs rejected: %lu)\n",
+          gs->active_epoch_count, gs->closing_epoch_count, gs->epoch_count, gs->epoch_stale_rejects);
   fprintf(stderr, "  \n");
   fprintf(stderr, "  Total slabs: %lu allocated, %lu recycled (net: %lu = %.2f MB)\n",
-          gs.total_slabs_allocated, gs.total_slabs_recycled, gs.net_slabs,
-          gs.net_slabs * 4096.0 / 1024 / 1024);
+          gs->total_slabs_allocated, gs->total_slabs_recycled, gs->net_slabs,
+          gs->estimated_slab_rss_bytes / 1024.0 / 1024);
   fprintf(stderr, "  RSS: %.2f MB actual | %.2f MB estimated\n",
-          gs.rss_bytes_current / 1024.0 / 1024,
-          gs.estimated_slab_rss_bytes / 1024.0 / 1024);
+          gs->rss_bytes_current / 1024.0 / 1024,
+          gs->estimated_slab_rss_bytes / 1024.0 / 1024);
   fprintf(stderr, "  \n");
-  fprintf(stderr, "  Slow path: %lu hits\n", gs.total_slow_path_hits);
+  fprintf(stderr, "  Slow path: %lu hits\n", gs->total_slow_path_hits);
   fprintf(stderr, "    cache miss: %lu | epoch closed: %lu\n",
-          gs.total_slow_cache_miss, gs.total_slow_epoch_closed);
-  fprintf(stderr, "  Cache overflows: %lu\n", gs.total_cache_overflows);
+          gs->total_slow_cache_miss, gs->total_slow_epoch_closed);
+  fprintf(stderr, "  Cache overflows: %lu\n", gs->total_cache_overflows);
   fprintf(stderr, "  \n");
   fprintf(stderr, "  RSS reclamation:\n");
   fprintf(stderr, "    madvise calls: %lu (%.2f MB reclaimed, %lu failures)\n",
-          gs.total_madvise_calls,
-          gs.total_madvise_bytes / 1024.0 / 1024,
-          gs.total_madvise_failures);
+          gs->total_madvise_calls,
+          gs->total_madvise_bytes / 1024.0 / 1024,
+          gs->total_madvise_failures);
+  fprintf(stderr, "  \n");
+  fprintf(stderr, "  Arenas: %lu (%.2f MB reserved, %.2f MB carved)\n",
+          gs->total_arena_count,
+          gs->total_arena_reserved_bytes / 1024.0 / 1024,
+          gs->total_arena_committed_bytes / 1024.0 / 1024);
+  fprintf(stderr, "  OS page: %u bytes%s\n", gs->os_page_size,
+          gs->hugepage_bytes ? " (huge-page arenas)" : "");
+  if (gs->memory_budget_bytes) {
+    fprintf(stderr, "  Budget: %.2f MB resident of %.2f MB (%lu enforcements)\n",
+            gs->resident_estimate_bytes / 1024.0 / 1024,
+            gs->memory_budget_bytes / 1024.0 / 1024,
+            gs->budget_enforcements);
+  }
+  if (gs->latency_enabled) {
+    fprintf(stderr, "  \n");
+    fprintf(stderr, "  Latency (alloc/free sampled 1/%u):\n", 1u << gs->latency_sample_shift);
+    for (uint32_t op = 0; op < SLAB_LAT_OPS; op++) {
+      const SlabLatencyHist* h = &gs->latency[op];
+      if (h->count == 0) continue;
+      fprintf(stderr, "    %-11s %8lu samples | p50 %lu ns | p99 %lu ns | p999 %lu ns | max %lu ns\n",
+              k_lat_op_names[op], h->count,
+              slab_latency_percentile(h, 0.50), slab_latency_percentile(h, 0.99),
+              slab_latency_percentile(h, 0.999), slab_latency_percentile(h, 1.0));
+    }
+  }
   fprintf(stderr, "\n");
 }
 
+static void print_text_global(SlabAllocator* alloc) {
+  SlabGlobalStats gs;
+  slab_stats_global(alloc, &gs);
+  print_text_global_stats(&gs);
+}
+
 static void print_text_class(SlabAllocator* alloc, uint32_t cls) {
   SlabClassStats cs;
   slab_stats_class(alloc, cls, &cs);
@@ -352,8 +494,8 @@ static void print_text_class(SlabAllocator* alloc, uint32_t cls) {
   }
   
   /* Slab distribution */
-  fprintf(stderr, "  Slabs: %u partial, %u full (%.2f KB RSS)\n",
-          cs.total_partial_slabs, cs.total_full_slabs,
+  fprintf(stderr, "  Slabs: %u partial, %u full, %u empty (%.2f KB RSS)\n",
+          cs.total_partial_slabs, cs.total_full_slabs, cs.total_empty_slabs,
           cs.estimated_rss_bytes / 1024.0);
   
   /* Cache effectiveness */
@@ -537,9 +679,171 @@ static void print_doctor_diagnostics(SlabAllocator* alloc) {
 
 /* ==================== Main ==================== */
 
+/* ==================== Attach Mode (shared-memory segment) ==================== */
+
+/* OpenMetrics: one counter family across all classes */
+#define OM_CLASS_COUNTER(snap, name, help, field) do { \
+    printf("# TYPE tslab_class_%s counter\n# HELP tslab_class_%s %s\n", name, name, help); \
+    for (uint32_t c_ = 0; c_ < (snap)->num_classes; c_++) { \
+      const SlabClassStats* cs_ = slab_shm_class((snap), c_); \
+      printf("tslab_class_%s_total{class=\"%u\",object_size=\"%u\"} %lu\n", \
+             name, c_, cs_->object_size, (unsigned long)cs_->field); \
+    } \
+  } while (0)
+
+static void print_om_counter(const char* name, const char* help, uint64_t v) {
+  printf("# TYPE tslab_%s counter\n# HELP tslab_%s %s\ntslab_%s_total %lu\n",
+         name, name, help, name, (unsigned long)v);
+}
+
+static void print_om_gauge(const char* name, const char* help, uint64_t v) {
+  printf("# TYPE tslab_%s gauge\n# HELP tslab_%s %s\ntslab_%s %lu\n",
+         name, name, help, name, (unsigned long)v);
+}
+
+/* Label values: escape backslash, quote and newline per the text format */
+static void print_om_label_value(const char* s) {
+  for (const char* p = s; *p; p++) {
+    if (*p == '\\' || *p == '"') putchar('\\');
+    if (*p == '\n') {
+      printf("\\n");
+      continue;
+    }
+    putchar(*p);
+  }
+}
+
+static void print_openmetrics(const SlabShmHeader* snap) {
+  const SlabGlobalStats* gs = &snap->global;
+  
+  print_om_gauge("rss_bytes", "Process RSS", gs->rss_bytes_current);
+  print_om_gauge("estimated_slab_rss_bytes", "Slab bytes not recycled", gs->estimated_slab_rss_bytes);
+  print_om_gauge("epoch_current", "Current epoch sequence", gs->current_epoch);
+  print_om_gauge("epochs_closing", "Epochs in CLOSING state", gs->closing_epoch_count);
+  print_om_gauge("resident_estimate_bytes", "Carved slab bytes not returned to the OS", gs->resident_estimate_bytes);
+  print_om_gauge("memory_budget_bytes", "Soft memory budget (0 = none)", gs->memory_budget_bytes);
+  print_om_counter("slabs_allocated", "Slabs carved or reused", gs->total_slabs_allocated);
+  print_om_counter("slabs_recycled", "Empty slabs recycled", gs->total_slabs_recycled);
+  print_om_counter("slow_path_hits", "Allocations that took the slow path", gs->total_slow_path_hits);
+  print_om_counter("madvise_bytes", "Bytes returned to the OS", gs->total_madvise_bytes);
+  print_om_counter("epoch_stale_rejects", "Calls with a stale EpochId", gs->epoch_stale_rejects);
+  print_om_counter("reclaim_completed", "Async epoch closes finished", gs->reclaim_completed);
+  print_om_counter("shm_publishes", "Snapshots published to this segment", snap->publish_count);
+  
+  OM_CLASS_COUNTER(snap, "new_slabs", "Slabs carved or reused per class", new_slab_count);
+  OM_CLASS_COUNTER(snap, "slow_path_hits", "Slow-path allocations per class", slow_path_hits);
+  OM_CLASS_COUNTER(snap, "alloc_attempts", "Bitmap allocations per class", bitmap_alloc_attempts);
+  OM_CLASS_COUNTER(snap, "alloc_cas_retries", "Bitmap CAS retries per class", bitmap_alloc_cas_retries);
+  OM_CLASS_COUNTER(snap, "madvise_bytes", "Bytes returned to the OS per class", madvise_bytes);
+  
+  printf("# TYPE tslab_epoch_open gauge\n# HELP tslab_epoch_open 1 if the ring slot is ACTIVE\n");
+  for (uint32_t e = 0; e < snap->epoch_count; e++) {
+    const SlabShmEpoch* ep = slab_shm_epoch(snap, e);
+    printf("tslab_epoch_open{slot=\"%u\",era=\"%lu\",label=\"", e, (unsigned long)ep->era);
+    print_om_label_value(ep->label);
+    printf("\"} %u\n", ep->state == EPOCH_ACTIVE ? 1u : 0u);
+  }
+  
+  /* Histograms: cumulative buckets at each non-empty bucket bound, in seconds */
+  if (gs->latency_enabled) {
+    printf("# TYPE tslab_latency_seconds histogram\n");
+    printf("# HELP tslab_latency_seconds Operation latency (alloc/free sampled)\n");
+    for (uint32_t op = 0; op < SLAB_LAT_OPS; op++) {
+      const SlabLatencyHist* h = &gs->latency[op];
+      uint64_t cum = 0;
+      for (uint32_t b = 0; b < SLAB_LAT_BUCKETS; b++) {
+        if (!h->buckets[b]) continue;
+        cum += h->buckets[b];
+        printf("tslab_latency_seconds_bucket{op=\"%s\",le=\"%.9f\"} %lu\n",
+               k_lat_op_names[op], (double)slab_lat_bucket_max_ns(b) / 1e9, (unsigned long)cum);
+      }
+      printf("tslab_latency_seconds_bucket{op=\"%s\",le=\"+Inf\"} %lu\n", k_lat_op_names[op], (unsigned long)cum);
+      printf("tslab_latency_seconds_count{op=\"%s\"} %lu\n", k_lat_op_names[op], (unsigned long)cum);
+      printf("tslab_latency_seconds_sum{op=\"%s\"} %.9f\n", k_lat_op_names[op], (double)h->sum_ns / 1e9);
+    }
+  }
+  printf("# EOF\n");
+}
+
+static void print_json_shm(const SlabShmHeader* snap) {
+  const SlabGlobalStats* gs = &snap->global;
+  
+  printf("{\n");
+  printf("  \"schema_version\": 1,\n");
+  printf("  \"pid\": %u,\n", snap->pid);
+  printf("  \"version\": %u,\n", snap->stats_version);
+  printf("  \"publish_count\": %lu,\n", snap->publish_count);
+  printf("  \"publish_ns\": %lu,\n", snap->publish_ns);
+  printf("  \"epoch_count\": %u,\n", gs->epoch_count);
+  printf("  \"current_epoch\": %u,\n", gs->current_epoch);
+  printf("  \"total_slabs_allocated\": %lu,\n", gs->total_slabs_allocated);
+  printf("  \"total_slabs_recycled\": %lu,\n", gs->total_slabs_recycled);
+  printf("  \"rss_bytes_current\": %lu,\n", gs->rss_bytes_current);
+  printf("  \"estimated_slab_rss_bytes\": %lu,\n", gs->estimated_slab_rss_bytes);
+  printf("  \"total_slow_path_hits\": %lu,\n", gs->total_slow_path_hits);
+  printf("  \"total_madvise_bytes\": %lu,\n", gs->total_madvise_bytes);
+  printf("  \"classes\": [\n");
+  for (uint32_t c = 0; c < snap->num_classes; c++) {
+    const SlabClassStats* cs = slab_shm_class(snap, c);
+    printf("    {\"class_index\": %u, \"object_size\": %u, \"new_slab_count\": %lu, "
+           "\"slow_path_hits\": %lu, \"empty_slab_recycled\": %lu, \"cache_size\": %u, "
+           "\"madvise_bytes\": %lu}%s\n",
+           cs->class_index, cs->object_size, cs->new_slab_count, cs->slow_path_hits,
+           cs->empty_slab_recycled, cs->cache_size, cs->madvise_bytes,
+           c + 1 < snap->num_classes ? "," : "");
+  }
+  printf("  ],\n");
+  printf("  \"epochs\": [\n");
+  for (uint32_t e = 0; e < snap->epoch_count; e++) {
+    const SlabShmEpoch* ep = slab_shm_epoch(snap, e);
+    printf("    {\"epoch_id\": %u, \"epoch_era\": %lu, \"state\": \"%s\", \"refcount\": %lu, \"label\": ",
+           ep->slot, ep->era, ep->state == EPOCH_ACTIVE ? "ACTIVE" : "CLOSING", ep->domain_refcount);
+    print_json_string(ep->label);
+    printf(", \"rss_before_close\": %lu, \"rss_after_close\": %lu}%s\n",
+           ep->rss_before_close, ep->rss_after_close, e + 1 < snap->epoch_count ? "," : "");
+  }
+  printf("  ]\n");
+  printf("}\n");
+}
+
+static int run_attach(uint32_t pid) {
+  char path[64];
+  snprintf(path, sizeof(path), SLAB_SHM_PATH_FMT, pid);
+  
+  SlabShmReader r;
+  if (!slab_stats_shm_attach(&r, path)) {
+    fprintf(stderr, "stats_dump: cannot attach %s: %s\n", path, strerror(errno));
+    return 1;
+  }
+  SlabShmHeader* snap = (SlabShmHeader*)malloc(r.bytes);
+  if (!snap || !slab_stats_shm_read(&r, snap, r.bytes)) {
+    fprintf(stderr, "stats_dump: cannot read %s: %s\n", path, strerror(snap ? errno : ENOMEM));
+    free(snap);
+    slab_stats_shm_detach(&r);
+    return 1;
+  }
+  slab_stats_shm_detach(&r);
+  
+  if (flag_openmetrics) {
+    print_openmetrics(snap);
+  } else if (flag_json) {
+    print_json_shm(snap);
+  }
+  if (flag_text) {
+    fprintf(stderr, "[attached to pid %u, snapshot #%lu]\n", snap->pid, snap->publish_count);
+    print_text_global_stats(&snap->global);
+  }
+  free(snap);
+  return 0;
+}
+
 int main(int argc, char** argv) {
   parse_args(argc, argv);
   
+  if (attach_pid > 0) {
+    return run_attach((uint32_t)attach_pid);
+  }
+  
   SlabAllocator* alloc = slab_allocator_create();
   if (!alloc) {
     fprintf(stderr, "Failed to create allocator\n");
@@ -560,7 +864,7 @@ int main(int argc, char** argv) {
     
     if (flag_text) {
       print_text_global(alloc);
-      for (uint32_t cls = 0; cls < 8; cls++) {
+      for (uint32_t cls = 0; cls < alloc->num_classes; cls++) {
         print_text_class(alloc, cls);
       }
     }
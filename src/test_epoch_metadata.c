@@ -76,7 +76,7 @@ static void test_alloc_count_tracking(void) {
   /* Initial state: alloc_count should be 0 */
   SlabEpochStats es;
   slab_stats_epoch(&alloc, 0, epoch, &es);
-  printf("  Initial: epoch=%u, alloc_count=%lu\n", epoch, es.alloc_count);
+  printf("  Initial: epoch=%u, alloc_count=%lu\n", SLAB_EPOCH_INDEX(epoch), es.alloc_count);
   assert(es.alloc_count == 0);
   
   /* Allocate 10 objects - alloc_count should increment */
@@ -187,12 +187,12 @@ static void test_metadata_reset_on_wraparound(void) {
   SlabAllocator alloc;
   allocator_init(&alloc);
   
-  printf("  Initial epoch after init: %u\n", epoch_current(&alloc));
+  printf("  Initial epoch after init: %u\n", SLAB_EPOCH_INDEX(epoch_current(&alloc)));
   
   /* Epoch starts at 0, advance once to epoch 1 for allocation */
   epoch_advance(&alloc);
   EpochId test_epoch = epoch_current(&alloc);
-  printf("  Starting test with epoch: %u\n", test_epoch);
+  printf("  Starting test with epoch: %u\n", SLAB_EPOCH_INDEX(test_epoch));
   
   /* Allocate in current epoch */
   SlabHandle h[5];
@@ -204,7 +204,7 @@ static void test_metadata_reset_on_wraparound(void) {
   SlabEpochStats es;
   slab_stats_epoch(&alloc, 0, test_epoch, &es);
   printf("  Epoch %u (first time): alloc_count=%lu, open_since_ns=%lu\n", 
-         test_epoch, es.alloc_count, es.open_since_ns);
+         SLAB_EPOCH_INDEX(test_epoch), es.alloc_count, es.open_since_ns);
   assert(es.alloc_count == 5);
   uint64_t first_open_time = es.open_since_ns;
   
@@ -220,15 +220,18 @@ static void test_metadata_reset_on_wraparound(void) {
     usleep(1000);  /* 1ms delay to ensure timestamp changes */
   }
   
-  uint32_t current_raw = epoch_current(&alloc);
-  uint32_t current = current_raw % EPOCH_COUNT;  /* epoch_current returns raw counter */
+  uint32_t current_raw = SLAB_EPOCH_INDEX(epoch_current(&alloc));
+  uint32_t current = current_raw % EPOCH_COUNT;
   printf("  Current epoch after wraparound: raw=%u, mod=%u (expected %u)\n", 
-         current_raw, current, test_epoch);
-  assert(current == test_epoch);
+         current_raw, current, SLAB_EPOCH_INDEX(test_epoch));
+  assert(current == SLAB_EPOCH_INDEX(test_epoch));
   
-  /* Check test_epoch metadata was reset */
-  slab_stats_epoch(&alloc, 0, test_epoch, &es);
-  printf("  Epoch %u (after wraparound):\n", test_epoch);
+  /* The old qualified ID is stale now: it must not see the new epoch */
+  assert(!epoch_id_valid(&alloc, test_epoch));
+  
+  /* Check test_epoch's slot metadata was reset (bare ring index) */
+  slab_stats_epoch(&alloc, 0, SLAB_EPOCH_INDEX(test_epoch), &es);
+  printf("  Epoch %u (after wraparound):\n", SLAB_EPOCH_INDEX(test_epoch));
   printf("    alloc_count=%lu (should be 0, reset)\n", es.alloc_count);
   printf("    open_since_ns=%lu (should be different from %lu)\n", 
          es.open_since_ns, first_open_time);
@@ -257,7 +260,7 @@ static void test_label_initialization(void) {
   epoch_advance(&alloc);
   EpochId epoch = epoch_current(&alloc);
   slab_stats_epoch(&alloc, 0, epoch, &es);
-  printf("  Epoch %u (after advance): label='%s' (should be empty)\n", epoch, es.label);
+  printf("  Epoch %u (after advance): label='%s' (should be empty)\n", SLAB_EPOCH_INDEX(epoch), es.label);
   assert(es.label[0] == '\0');
   
   /* Note: We don't test setting labels here because the API for that
@@ -12,7 +12,7 @@ int main(void) {
   
   printf("Test 1: Basic epoch allocation...\n");
   EpochId e0 = epoch_current(a);
-  printf("  Current epoch: %u\n", e0);
+  printf("  Current epoch: %u\n", SLAB_EPOCH_INDEX(e0));
   
   SlabHandle h1, h2;
   void* p1 = alloc_obj_epoch(a, 128, e0, &h1);
@@ -21,7 +21,7 @@ int main(void) {
   
   epoch_advance(a);
   EpochId e1 = epoch_current(a);
-  printf("  Advanced to epoch: %u\n", e1);
+  printf("  Advanced to epoch: %u\n", SLAB_EPOCH_INDEX(e1));
   
   void* p2 = alloc_obj_epoch(a, 128, e1, &h2);
   assert(p2 && "allocation in epoch 1 failed");
@@ -37,7 +37,7 @@ int main(void) {
 
   /* Allocate batch in current epoch (e1 from previous test) */
   EpochId current_epoch = epoch_current(a);
-  printf("  Current epoch: %u\n", current_epoch);
+  printf("  Current epoch: %u\n", SLAB_EPOCH_INDEX(current_epoch));
 
   for (int i = 0; i < OBJECTS_PER_EPOCH; i++) {
     void* p = alloc_obj_epoch(a, 128, current_epoch, &handles_e0[i]);
@@ -48,7 +48,7 @@ int main(void) {
   /* Advance to next epoch and allocate another batch */
   epoch_advance(a);
   EpochId next_epoch = epoch_current(a);
-  printf("  Advanced to epoch: %u\n", next_epoch);
+  printf("  Advanced to epoch: %u\n", SLAB_EPOCH_INDEX(next_epoch));
 
   for (int i = 0; i < OBJECTS_PER_EPOCH; i++) {
     void* p = alloc_obj_epoch(a, 128, next_epoch, &handles_e1[i]);
@@ -80,7 +80,7 @@ int main(void) {
   printf("\nTest 3: Epoch ring buffer wrap...\n");
   for (uint32_t i = 0; i < 20; i++) {
     EpochId e = epoch_current(a);
-    printf("  Epoch %u (should wrap at 16)\n", e);
+    printf("  Epoch %u (should wrap at 16)\n", SLAB_EPOCH_INDEX(e));
 
     SlabHandle h;
     void* p = alloc_obj_epoch(a, 64, e, &h);
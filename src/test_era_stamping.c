@@ -18,7 +18,7 @@ int main(void) {
   
   /* Verify initial state */
   printf("Initial state:\n");
-  printf("  current_epoch: %u\n", epoch_current(alloc));
+  printf("  current_epoch: %u\n", SLAB_EPOCH_INDEX(epoch_current(alloc)));
   printf("  epoch_era_counter: %lu\n", atomic_load_explicit(&alloc->epoch_era_counter, memory_order_relaxed));
   
   /* Verify initial eras are all 0 */
@@ -32,7 +32,7 @@ int main(void) {
   /* Advance through several epochs */
   for (int i = 1; i <= 5; i++) {
     epoch_advance(alloc);
-    EpochId cur = epoch_current(alloc);
+    uint32_t cur = SLAB_EPOCH_INDEX(epoch_current(alloc));
     uint64_t era = alloc->epoch_era[cur];
     uint64_t counter = atomic_load_explicit(&alloc->epoch_era_counter, memory_order_relaxed);
     
@@ -47,22 +47,22 @@ int main(void) {
   
   /* Allocate in current epoch and verify slab era */
   EpochId epoch = epoch_current(alloc);
-  uint64_t expected_era = alloc->epoch_era[epoch];
+  uint64_t expected_era = alloc->epoch_era[SLAB_EPOCH_INDEX(epoch)];
   
   SlabHandle h1;
   void* p1 = alloc_obj_epoch(alloc, 128, epoch, &h1);
   assert(p1 && "allocation failed");
-  printf("  Allocated in epoch %u (era %lu)\n", epoch, expected_era);
+  printf("  Allocated in epoch %u (era %lu)\n", SLAB_EPOCH_INDEX(epoch), expected_era);
   
   /* Advance again and allocate in new epoch */
   epoch_advance(alloc);
   epoch = epoch_current(alloc);
-  expected_era = alloc->epoch_era[epoch];
+  expected_era = alloc->epoch_era[SLAB_EPOCH_INDEX(epoch)];
   
   SlabHandle h2;
   void* p2 = alloc_obj_epoch(alloc, 128, epoch, &h2);
   assert(p2 && "allocation failed");
-  printf("  Allocated in epoch %u (era %lu)\n", epoch, expected_era);
+  printf("  Allocated in epoch %u (era %lu)\n", SLAB_EPOCH_INDEX(epoch), expected_era);
   
   /* Verify era counter incremented */
   uint64_t final_counter = atomic_load_explicit(&alloc->epoch_era_counter, memory_order_relaxed);
@@ -76,7 +76,7 @@ int main(void) {
   }
   
   EpochId final_epoch_raw = epoch_current(alloc);
-  EpochId final_epoch = final_epoch_raw % EPOCH_COUNT;
+  uint32_t final_epoch = SLAB_EPOCH_INDEX(final_epoch_raw) % EPOCH_COUNT;
   uint64_t final_era = alloc->epoch_era[final_epoch];
   final_counter = atomic_load_explicit(&alloc->epoch_era_counter, memory_order_relaxed);
   
@@ -1,4 +1,5 @@
 #include <slab_alloc.h>
+#include <slab_stats.h>
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
@@ -33,14 +34,31 @@ int main(void) {
   slab_free(a, NULL);  /* Should not crash */
   void* p_zero = slab_malloc_epoch(a, 0, 0);
   assert(p_zero == NULL && "malloc(0) should return NULL");
-  void* p_huge = slab_malloc_epoch(a, 505, 0);
-  assert(p_huge == NULL && "malloc(505) should return NULL (max is 504)");
-  void* p_max = slab_malloc_epoch(a, 504, 0);
-  assert(p_max && "malloc(504) should succeed");
+  void* p_huge = slab_malloc_epoch(a, SLAB_MAX_OBJECT_SIZE - 7, 0);
+  assert(p_huge == NULL && "malloc(16377) should return NULL (max is 16376)");
+  void* p_max = slab_malloc_epoch(a, SLAB_MAX_OBJECT_SIZE - 8, 0);
+  assert(p_max && "malloc(16376) should succeed");
+  memset(p_max, 0xCD, SLAB_MAX_OBJECT_SIZE - 8);
   slab_free(a, p_max);
   printf("  PASS: NULL free, malloc(0), oversized, max size\n");
   
-  printf("\nTest 4: Mixed malloc and handle API...\n");
+  printf("\nTest 4: Large-object tier (multi-page slabs)...\n");
+  const size_t large_sizes[] = {505, 1000, 1500, 2040, 4000, 8000, 12000};
+  for (size_t i = 0; i < sizeof(large_sizes) / sizeof(large_sizes[0]); i++) {
+    void* lp[40];
+    for (int j = 0; j < 40; j++) {  /* 40 > objects per large slab: spans slabs */
+      lp[j] = slab_malloc_epoch(a, large_sizes[i], 0);
+      assert(lp[j] && "large malloc failed");
+      memset(lp[j], (int)j, large_sizes[i]);
+    }
+    for (int j = 0; j < 40; j++) {
+      assert(((unsigned char*)lp[j])[large_sizes[i] - 1] == (unsigned char)j && "large data corruption");
+      slab_free(a, lp[j]);
+    }
+  }
+  printf("  PASS: 505B-12KB allocs across multi-page slabs\n");
+  
+  printf("\nTest 5: Mixed malloc and handle API...\n");
   void* pm = slab_malloc_epoch(a, 100, 0);
   SlabHandle h;
   void* ph = alloc_obj_epoch(a, 100, 0, &h);
@@ -51,6 +69,53 @@ int main(void) {
   
   slab_allocator_free(a);
   
+  printf("\nTest 6: Header-free mode (pointer-only free)...\n");
+  SlabAllocatorConfig cfg = { .header_free = true };
+  a = slab_allocator_create_with_config(&cfg);
+  assert(a && "header_free allocator creation failed");
+  void* hp[200];
+  for (int i = 0; i < 200; i++) {
+    hp[i] = slab_malloc_epoch(a, 64, 1);  /* No prefix: fits the 64B class */
+    assert(hp[i] && "header-free malloc failed");
+    memset(hp[i], 0x5A, 64);
+  }
+  SlabClassStats cs;
+  slab_stats_class(a, 0, &cs);
+  assert(cs.object_size == 64 && cs.new_slab_count > 0 && "64B requests must use the 64B class");
+  slab_free(a, (char*)hp[0] + 8);  /* Interior pointer: ignored */
+  for (int i = 0; i < 200; i++) slab_free(a, hp[i]);
+  slab_free(a, hp[0]);             /* Double free: slot already free, ignored */
+  uint64_t slabs_before = cs.new_slab_count;
+  for (int i = 0; i < 200; i++) {
+    hp[i] = slab_malloc_epoch(a, 64, 1);  /* Freed slots come back: no new slabs */
+    assert(hp[i] && "header-free malloc after free failed");
+  }
+  slab_stats_class(a, 0, &cs);
+  assert(cs.new_slab_count == slabs_before && "pointer-only frees must release their slots");
+  for (int i = 0; i < 200; i++) slab_free(a, hp[i]);
+  
+  void* hmax = slab_malloc_epoch(a, SLAB_MAX_OBJECT_SIZE, 0);
+  assert(hmax && "header-free malloc(16384) should succeed");
+  assert(slab_malloc_epoch(a, SLAB_MAX_OBJECT_SIZE + 1, 0) == NULL && "above largest class");
+  slab_free(a, hmax);
+  SlabGlobalStats gs;
+  uint64_t large_slabs = 0;
+  for (int round = 0; round < 2; round++) {
+    for (size_t i = 0; i < sizeof(large_sizes) / sizeof(large_sizes[0]); i++) {
+      void* lp[40];
+      for (int j = 0; j < 40; j++) {
+        lp[j] = slab_malloc_epoch(a, large_sizes[i], 2);
+        assert(lp[j] && "header-free large malloc failed");
+      }
+      for (int j = 0; j < 40; j++) slab_free(a, lp[j]);
+    }
+    slab_stats_global(a, &gs);
+    if (round == 0) large_slabs = gs.total_slabs_allocated;
+  }
+  assert(gs.total_slabs_allocated == large_slabs && "multi-page slabs must resolve by mask");
+  slab_allocator_free(a);
+  printf("  PASS: 64B class, interior/double free ignored, multi-page slabs\n");
+  
   printf("\n=== All malloc wrapper tests PASS ===\n");
   return 0;
 }
@@ -0,0 +1,111 @@
+/*
+ * test_size_classes.c - Runtime size-class configuration tests
+ *
+ * Covers:
+ * - allocator_init_with_config() with a custom table (per-instance lookup)
+ * - Rejection of invalid tables (EINVAL)
+ * - Two allocators with different tables in one process
+ * - slab_suggest_size_classes() on a bimodal histogram
+ */
+
+#include <slab_alloc.h>
+#include <slab_stats.h>
+#include <assert.h>
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+int main(void) {
+  printf("=== Testing runtime size-class configuration ===\n\n");
+
+  printf("Test 1: Custom table routes sizes to configured classes...\n");
+  static const uint32_t custom[] = {40, 64, 144, 192, 2048};
+  SlabAllocatorConfig cfg = { .size_classes = custom, .num_classes = 5 };
+  SlabAllocator* a = slab_allocator_create_with_config(&cfg);
+  assert(a && "create_with_config failed");
+
+  SlabHandle h40, h144, h2k;
+  void* p40 = alloc_obj_epoch(a, 40, 0, &h40);
+  void* p144 = alloc_obj_epoch(a, 130, 0, &h144);
+  void* p2k = alloc_obj_epoch(a, 2048, 0, &h2k);
+  assert(p40 && p144 && p2k && "custom-class allocations failed");
+  memset(p40, 0x11, 40);
+  memset(p144, 0x22, 130);
+  memset(p2k, 0x33, 2048);
+
+  /* One slab per class in every build: a TLS refill claims at most one
+   * slab's worth of slots */
+  SlabClassStats cs;
+  slab_stats_class(a, 0, &cs);
+  assert(cs.object_size == 40 && cs.new_slab_count == 1 && "40B request not in 40B class");
+  slab_stats_class(a, 2, &cs);
+  assert(cs.object_size == 144 && cs.new_slab_count == 1 && "130B request not in 144B class");
+  slab_stats_class(a, 4, &cs);
+  assert(cs.object_size == 2048 && cs.slab_bytes > SLAB_PAGE_SIZE && "2KB class not multi-page");
+  assert(cs.new_slab_count == 1 && "one 2KB allocation carved more than one slab");
+
+  SlabHandle hbig;
+  assert(alloc_obj_epoch(a, 2049, 0, &hbig) == NULL && "size above largest class accepted");
+  assert(slab_malloc_epoch(a, 2041, 0) == NULL && "malloc above largest class - 8 accepted");
+
+  assert(free_obj(a, h40) && free_obj(a, h144) && free_obj(a, h2k));
+  printf("  PASS: 40/144/2048 classes, oversize rejected\n");
+
+  printf("\nTest 2: Default allocator unaffected by custom instance...\n");
+  SlabAllocator* d = slab_allocator_create();
+  assert(d);
+  SlabHandle hd;
+  assert(alloc_obj_epoch(d, 40, 0, &hd) && "default alloc failed");
+  slab_stats_class(d, 0, &cs);
+  assert(cs.object_size == 64 && cs.new_slab_count == 1 && "default table altered");
+  assert(alloc_obj_epoch(d, 16384, 0, &hbig) && "default 16KB class missing");
+  assert(free_obj(d, hd) && free_obj(d, hbig));
+  slab_allocator_free(d);
+  printf("  PASS: per-instance lookup tables\n");
+  slab_allocator_free(a);
+
+  printf("\nTest 3: Invalid tables rejected with EINVAL...\n");
+  static const uint32_t descending[] = {128, 64};
+  static const uint32_t unaligned[] = {44, 128};
+  static const uint32_t too_small[] = {8, 64};
+  static const uint32_t too_big[] = {64, SLAB_MAX_OBJECT_SIZE + 8};
+  const uint32_t* bad[] = {descending, unaligned, too_small, too_big};
+  for (int i = 0; i < 4; i++) {
+    SlabAllocatorConfig bc = { .size_classes = bad[i], .num_classes = 2 };
+    errno = 0;
+    assert(slab_allocator_create_with_config(&bc) == NULL && errno == EINVAL);
+  }
+  SlabAllocatorConfig empty = { .size_classes = custom, .num_classes = 0 };
+  errno = 0;
+  assert(slab_allocator_create_with_config(&empty) == NULL && errno == EINVAL);
+  printf("  PASS: descending, unaligned, too small, too large, empty\n");
+
+  printf("\nTest 4: Histogram suggestion...\n");
+  static uint64_t hist[1025];
+  for (uint32_t s = 36; s <= 40; s++) hist[s] = 1000;    /* Peak at 40B */
+  for (uint32_t s = 140; s <= 144; s++) hist[s] = 1000;  /* Peak at 144B */
+  hist[700] = 10;                                         /* Long tail */
+
+  uint32_t classes[SLAB_MAX_CLASSES];
+  uint32_t n = slab_suggest_size_classes(hist, 1025, 3, classes);
+  assert(n == 3 && "expected 3 classes");
+  assert(classes[0] == 40 && classes[1] == 144 && classes[2] == 704 && "suggested table not optimal");
+
+  SlabAllocatorConfig sc = { .size_classes = classes, .num_classes = n };
+  SlabAllocator* s = slab_allocator_create_with_config(&sc);
+  assert(s && "suggested table rejected");
+  slab_allocator_free(s);
+
+  /* Fewer distinct sizes than classes: one class per observed size */
+  memset(hist, 0, sizeof(hist));
+  hist[100] = 5;
+  n = slab_suggest_size_classes(hist, 1025, 8, classes);
+  assert(n == 1 && classes[0] == 104);
+
+  memset(hist, 0, sizeof(hist));
+  assert(slab_suggest_size_classes(hist, 1025, 8, classes) == 0 && "empty histogram");
+  printf("  PASS: {40, 144, 704} from bimodal histogram\n");
+
+  printf("\n=== All size-class configuration tests PASS ===\n");
+  return 0;
+}
@@ -0,0 +1,258 @@
+/*
+ * tslab_malloc.c - LD_PRELOAD interposer for the malloc family
+ *
+ * Routes malloc/calloc/realloc/free (and the aligned variants) of unmodified
+ * binaries through one process-wide temporal-slab allocator, so RSS and tail
+ * latency can be A/B'd against the system allocator without touching call
+ * sites:
+ *
+ *   make libtslab_malloc.so
+ *   LD_PRELOAD=./libtslab_malloc.so ./your_binary
+ *
+ * Routing:
+ * - Sizes 1..TSLAB_MALLOC_MAX (default SLAB_MAX_OBJECT_SIZE) with alignment
+ *   <= 16 go to slab_malloc_epoch() on a header_free allocator (no per-object
+ *   prefix); everything else goes to glibc.
+ * - Epoch: the thread's current epoch domain if it wraps our allocator (see
+ *   tslab_malloc_allocator()), else epoch_current(). If that epoch is
+ *   closing, the request falls back to glibc.
+ * - free()/realloc()/malloc_usable_size() decide ownership with slab_owns(),
+ *   a lock-free arena bitmap lookup that never touches foreign memory.
+ *
+ * Re-entrancy: the allocator itself calls malloc (registry segments, arena
+ * metadata, stats). A per-thread depth counter sends those inner calls to
+ * glibc, so allocator locks are never re-entered.
+ *
+ * Environment:
+ *   TSLAB_MALLOC_DISABLE=1   pass everything to glibc (same binary, baseline run)
+ *   TSLAB_MALLOC_MAX=<bytes> largest request served by slabs
+ *   TSLAB_MALLOC_STATS=1     print routing counters to stderr at exit
+ *
+ * Limits: glibc only (falls back through __libc_* entry points). The
+ * allocator is never destroyed, since objects can be freed by atexit
+ * handlers and late destructors. fork() in a multi-threaded parent has the
+ * usual caveats for allocator mutexes.
+ */
+
+#define _GNU_SOURCE
+#include <slab_alloc.h>    /* include/, not the legacy src/slab_alloc.h */
+#include <epoch_domain.h>
+
+#include <dlfcn.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* glibc's own entry points: no dlsym() bootstrap needed for these */
+extern void* __libc_malloc(size_t size);
+extern void  __libc_free(void* ptr);
+extern void* __libc_calloc(size_t n, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void* __libc_memalign(size_t align, size_t size);
+
+#define TSLAB_EXPORT __attribute__((visibility("default")))
+
+/* Largest alignment every slab slot has (slab data start and class sizes) */
+#define TSLAB_SLOT_ALIGN 16u
+
+static SlabAllocator* g_alloc;          /* NULL until init (or when disabled) */
+static size_t g_max_size = SLAB_MAX_OBJECT_SIZE;
+static pthread_once_t g_once = PTHREAD_ONCE_INIT;
+static bool g_stats;
+
+static _Atomic uint64_t g_slab_allocs;
+static _Atomic uint64_t g_libc_allocs;
+static _Atomic uint64_t g_slab_frees;
+static _Atomic uint64_t g_libc_frees;
+
+/* Non-zero while this thread is inside the allocator (or initializing it).
+ * initial-exec: dynamic TLS would allocate on first touch. */
+static __thread int t_depth __attribute__((tls_model("initial-exec")));
+
+static void tslab_print_stats(void) {
+  fprintf(stderr, "tslab_malloc: slab allocs=%lu frees=%lu, libc allocs=%lu frees=%lu\n",
+          (unsigned long)atomic_load(&g_slab_allocs), (unsigned long)atomic_load(&g_slab_frees),
+          (unsigned long)atomic_load(&g_libc_allocs), (unsigned long)atomic_load(&g_libc_frees));
+}
+
+static void tslab_init(void) {
+  t_depth++;
+  const char* off = getenv("TSLAB_MALLOC_DISABLE");
+  if (!off || off[0] == '\0' || off[0] == '0') {
+    const char* max = getenv("TSLAB_MALLOC_MAX");
+    if (max) {
+      unsigned long v = strtoul(max, NULL, 10);
+      if (v < g_max_size) g_max_size = (size_t)v;
+    }
+    SlabAllocatorConfig cfg = { .header_free = true };
+    g_alloc = slab_allocator_create_with_config(&cfg);  /* NULL: stay on glibc */
+  }
+  const char* st = getenv("TSLAB_MALLOC_STATS");
+  g_stats = st && st[0] != '\0' && st[0] != '0';
+  if (g_stats) atexit(tslab_print_stats);
+  t_depth--;
+}
+
+/* Allocator to serve this call from, or NULL for glibc */
+static inline SlabAllocator* tslab_get(void) {
+  if (t_depth) return NULL;
+  pthread_once(&g_once, tslab_init);
+  return g_alloc;
+}
+
+/* Allocator behind the interposer (NULL when disabled or not preloaded).
+ * Wrap it in an epoch domain to steer the thread's mallocs into an epoch:
+ *   epoch_domain_t* d = epoch_domain_create(tslab_malloc_allocator()); */
+TSLAB_EXPORT SlabAllocator* tslab_malloc_allocator(void) {
+  return tslab_get();
+}
+
+static inline EpochId tslab_epoch(SlabAllocator* a) {
+  epoch_domain_t* d = epoch_domain_current();
+  if (d && d->alloc == a) return d->epoch_id;
+  return epoch_current(a);
+}
+
+/* Slab allocation for eligible requests; NULL means "use glibc" */
+static void* tslab_try_alloc(size_t size) {
+  if (size == 0 || size > g_max_size) return NULL;
+  SlabAllocator* a = tslab_get();
+  if (!a) return NULL;
+  t_depth++;
+  void* p = slab_malloc_epoch(a, size, tslab_epoch(a));
+  t_depth--;
+  if (p) atomic_fetch_add_explicit(&g_slab_allocs, 1, memory_order_relaxed);
+  return p;
+}
+
+/* Ownership check for free-side entry points (never initializes) */
+static inline SlabAllocator* tslab_owner(const void* ptr) {
+  SlabAllocator* a = g_alloc;
+  if (!ptr || !a || t_depth) return NULL;
+  return slab_owns(a, ptr) ? a : NULL;
+}
+
+static void tslab_release(SlabAllocator* a, void* ptr) {
+  t_depth++;
+  slab_free(a, ptr);
+  t_depth--;
+  atomic_fetch_add_explicit(&g_slab_frees, 1, memory_order_relaxed);
+}
+
+static inline void* tslab_libc_counted(void* p) {
+  if (p && g_stats) atomic_fetch_add_explicit(&g_libc_allocs, 1, memory_order_relaxed);
+  return p;
+}
+
+TSLAB_EXPORT void* malloc(size_t size) {
+  void* p = tslab_try_alloc(size);
+  if (p) return p;
+  return tslab_libc_counted(__libc_malloc(size));
+}
+
+TSLAB_EXPORT void free(void* ptr) {
+  SlabAllocator* a = tslab_owner(ptr);
+  if (a) {
+    tslab_release(a, ptr);
+    return;
+  }
+  if (ptr && g_stats) atomic_fetch_add_explicit(&g_libc_frees, 1, memory_order_relaxed);
+  __libc_free(ptr);
+}
+
+TSLAB_EXPORT void* calloc(size_t n, size_t size) {
+  size_t total;
+  if (__builtin_mul_overflow(n, size, &total)) {
+    errno = ENOMEM;
+    return NULL;
+  }
+  void* p = tslab_try_alloc(total);
+  if (p) {
+    memset(p, 0, total);  /* Recycled slots keep old contents */
+    return p;
+  }
+  return tslab_libc_counted(__libc_calloc(n, size));
+}
+
+TSLAB_EXPORT void* realloc(void* ptr, size_t size) {
+  if (!ptr) return malloc(size);
+  SlabAllocator* a = tslab_owner(ptr);
+  if (!a) return __libc_realloc(ptr, size);  /* glibc memory stays in glibc */
+  if (size == 0) {
+    tslab_release(a, ptr);
+    return NULL;
+  }
+
+  t_depth++;
+  size_t old = slab_usable_size(a, ptr);
+  t_depth--;
+  if (size <= old) return ptr;  /* Fits in the slot: shrink/grow in place */
+
+  void* np = malloc(size);
+  if (!np) return NULL;  /* Old block untouched, as realloc requires */
+  memcpy(np, ptr, old);
+  tslab_release(a, ptr);
+  return np;
+}
+
+static void* tslab_memalign(size_t align, size_t size) {
+  if (align <= TSLAB_SLOT_ALIGN) {
+    void* p = tslab_try_alloc(size);
+    if (p) return p;
+  }
+  return tslab_libc_counted(__libc_memalign(align, size));
+}
+
+TSLAB_EXPORT int posix_memalign(void** memptr, size_t align, size_t size) {
+  if (align < sizeof(void*) || (align & (align - 1)) != 0) return EINVAL;
+  void* p = tslab_memalign(align, size);
+  if (!p && size != 0) return ENOMEM;
+  *memptr = p;
+  return 0;
+}
+
+TSLAB_EXPORT void* aligned_alloc(size_t align, size_t size) {
+  if (align == 0 || (align & (align - 1)) != 0) {
+    errno = EINVAL;
+    return NULL;
+  }
+  return tslab_memalign(align, size);
+}
+
+TSLAB_EXPORT void* memalign(size_t align, size_t size) {
+  return tslab_memalign(align, size);
+}
+
+TSLAB_EXPORT void* valloc(size_t size) {
+  return tslab_libc_counted(__libc_memalign((size_t)sysconf(_SC_PAGESIZE), size));
+}
+
+TSLAB_EXPORT void* pvalloc(size_t size) {
+  size_t page = (size_t)sysconf(_SC_PAGESIZE);
+  return tslab_libc_counted(__libc_memalign(page, (size + page - 1) & ~(page - 1)));
+}
+
+TSLAB_EXPORT size_t malloc_usable_size(void* ptr) {
+  SlabAllocator* a = tslab_owner(ptr);
+  if (a) {
+    t_depth++;
+    size_t n = slab_usable_size(a, ptr);
+    t_depth--;
+    return n;
+  }
+
+  /* glibc's version, resolved once (dlsym may allocate: route that to glibc) */
+  static size_t (*real_usable)(void*);
+  if (!real_usable) {
+    t_depth++;
+    *(void**)&real_usable = dlsym(RTLD_NEXT, "malloc_usable_size");  /* POSIX-sanctioned cast */
+    t_depth--;
+    if (!real_usable) return 0;
+  }
+  return real_usable(ptr);
+}
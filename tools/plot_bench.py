@@ -2,11 +2,16 @@
 """
 Benchmark visualization for temporal-slab
 
-Generates 4 key charts from CSV benchmark output:
+Generates key charts from CSV and tslab-bench-v1 JSON Lines benchmark output:
 1. Latency CDF - Distribution of allocation latency (shows tail behavior)
 2. Fragmentation - Internal fragmentation by size class
 3. RSS over time - Memory stability under churn (when churn_test CSV available)
 4. P99 vs threads - Tail latency scaling (when multi-thread data available)
+5. HW counters per op - cycles/instructions/cache/TLB misses per phase (*.jsonl)
+
+Compares a run against a stored baseline (no matplotlib needed):
+    python3 plot_bench.py --input benchmarks/results \
+        --compare benchmarks/baseline/main/results [--threshold 5] [--fail-on-regression]
 
 Usage:
     python3 plot_bench.py [--input benchmarks/results] [--output docs/images]
@@ -14,6 +19,7 @@ Usage:
 
 import argparse
 import csv
+import json
 import sys
 from pathlib import Path
 from typing import List, Dict, Tuple
@@ -23,10 +29,15 @@ try:
     matplotlib.use('Agg')  # Non-interactive backend
     import matplotlib.pyplot as plt
     import numpy as np
+    HAVE_MATPLOTLIB = True
 except ImportError:
-    print("Error: matplotlib not installed", file=sys.stderr)
-    print("Install with: pip install matplotlib numpy", file=sys.stderr)
-    sys.exit(1)
+    HAVE_MATPLOTLIB = False
+
+BENCH_SCHEMA = 'tslab-bench-v1'
+
+# Per-op counters in tslab-bench-v1 output (see src/bench_perf.h)
+COUNTER_KEYS = ['cycles', 'instructions', 'l1d_misses', 'llc_misses',
+                'dtlb_misses', 'page_faults', 'context_switches']
 
 
 def load_csv(path: Path) -> List[Dict]:
@@ -58,6 +69,128 @@ def load_csv(path: Path) -> List[Dict]:
     return results
 
 
+def load_jsonl(path: Path) -> List[Dict]:
+    """Load tslab-bench-v1 phase records (one JSON object per line)"""
+    rows = []
+    with open(path, 'r') as f:
+        for lineno, line in enumerate(f, 1):
+            line = line.strip()
+            if not line:
+                continue
+            try:
+                row = json.loads(line)
+            except json.JSONDecodeError as e:
+                print(f"{path.name}:{lineno}: skipping malformed line ({e})", file=sys.stderr)
+                continue
+            if row.get('schema') == BENCH_SCHEMA:
+                rows.append(row)
+    return rows
+
+
+def load_phases(input_dir: Path) -> List[Dict]:
+    """Load every *.jsonl file in a results directory"""
+    rows = []
+    for path in sorted(input_dir.glob('*.jsonl')):
+        rows.extend(load_jsonl(path))
+    return rows
+
+
+def phase_key(row: Dict) -> Tuple:
+    return (row['bench'], row['phase'], row.get('allocator', 'temporal-slab'), row.get('threads', 1))
+
+
+def phase_label(key: Tuple) -> str:
+    bench, phase, allocator, threads = key
+    label = f"{bench}/{phase}"
+    if threads != 1:
+        label += f" x{threads}"
+    if allocator != 'temporal-slab':
+        label += f" [{allocator}]"
+    return label
+
+
+def phase_metrics(row: Dict) -> Dict[str, float]:
+    """Flatten a phase record into comparable metrics (None = not measured)"""
+    ops = row.get('ops') or 0
+    metrics = {
+        'wall_ns/op': (row['wall_ns'] / ops) if ops and row.get('wall_ns') else None,
+    }
+    latency = row.get('latency_ns', {})
+    for p in ('p50', 'p99', 'p999'):
+        metrics[f'{p}_ns'] = latency.get(p)
+    per_op = row.get('per_op', {})
+    for k in COUNTER_KEYS:
+        metrics[f'{k}/op'] = per_op.get(k)
+    metrics['ipc'] = per_op.get('ipc')
+    return metrics
+
+
+def compare_phases(current: List[Dict], baseline: List[Dict], threshold_pct: float) -> int:
+    """Print per-phase deltas vs baseline; return number of regressions"""
+    base_by_key = {phase_key(r): r for r in baseline}
+    regressions = 0
+    matched = 0
+
+    for row in current:
+        key = phase_key(row)
+        base = base_by_key.get(key)
+        if base is None:
+            print(f"\n{phase_label(key)}: no baseline")
+            continue
+        matched += 1
+        print(f"\n{phase_label(key)}")
+        print(f"  {'metric':<22} {'baseline':>14} {'current':>14} {'delta':>9}")
+
+        cur_m = phase_metrics(row)
+        base_m = phase_metrics(base)
+        for name, cur in cur_m.items():
+            old = base_m.get(name)
+            if cur is None or old is None:
+                continue
+            if old == 0:
+                delta_str = '    n/a' if cur == 0 else '    new'
+                worse = False
+            else:
+                delta = (cur - old) / old * 100.0
+                delta_str = f"{delta:+8.1f}%"
+                # Higher is worse for everything except IPC
+                worse = (delta < -threshold_pct) if name == 'ipc' else (delta > threshold_pct)
+            flag = '  <-- regression' if worse else ''
+            regressions += int(worse)
+            print(f"  {name:<22} {old:>14.4g} {cur:>14.4g} {delta_str:>9}{flag}")
+
+    print(f"\nCompared {matched} phase(s); {regressions} metric(s) regressed by more than {threshold_pct:g}%")
+    return regressions
+
+
+def plot_counters(rows: List[Dict], output_dir: Path):
+    """Plot hardware counters per op for each measured phase"""
+    keys = ['cycles', 'instructions', 'l1d_misses', 'llc_misses', 'dtlb_misses']
+    rows = [r for r in rows if any(r.get('per_op', {}).get(k) is not None for k in keys)]
+    if not rows:
+        print("No hardware counter data (perf unavailable?)", file=sys.stderr)
+        return
+
+    labels = [phase_label(phase_key(r)) for r in rows]
+    fig, axes = plt.subplots(1, len(keys), figsize=(4 * len(keys), max(4, 0.4 * len(rows) + 2)))
+    y = np.arange(len(rows))
+
+    for ax, k in zip(axes, keys):
+        vals = [r['per_op'].get(k) or 0 for r in rows]
+        ax.barh(y, vals, color='steelblue', alpha=0.8)
+        ax.set_title(f'{k} / op', fontsize=11, fontweight='bold')
+        ax.set_yticks(y)
+        ax.set_yticklabels(labels if ax is axes[0] else [''] * len(rows), fontsize=9)
+        ax.invert_yaxis()
+        ax.grid(axis='x', alpha=0.3)
+
+    plt.tight_layout()
+    output_path = output_dir / 'counters_per_op.png'
+    plt.savefig(output_path, dpi=150, bbox_inches='tight')
+    print(f"Generated: {output_path}")
+    plt.close()
+
+
 def plot_fragmentation(data: List[Dict], output_dir: Path):
     """Plot internal fragmentation by size class"""
     if not data:
@@ -351,19 +484,42 @@ def main():
                         help='Input directory with CSV files')
     parser.add_argument('--output', type=Path, default=Path('docs/images'),
                         help='Output directory for PNG charts')
+    parser.add_argument('--compare', type=Path, metavar='BASELINE_DIR',
+                        help='Compare *.jsonl phases in --input against this directory instead of plotting')
+    parser.add_argument('--threshold', type=float, default=5.0,
+                        help='Percent change flagged as a regression (default: 5)')
+    parser.add_argument('--fail-on-regression', action='store_true',
+                        help='Exit with status 2 if any metric regressed')
     args = parser.parse_args()
     
+    if args.compare:
+        current = load_phases(args.input)
+        baseline = load_phases(args.compare)
+        if not current or not baseline:
+            print(f"No {BENCH_SCHEMA} *.jsonl results in "
+                  f"{args.input if not current else args.compare}", file=sys.stderr)
+            print("Run benchmarks with --json first", file=sys.stderr)
+            sys.exit(1)
+        regressions = compare_phases(current, baseline, args.threshold)
+        sys.exit(2 if regressions and args.fail_on_regression else 0)
+    
+    if not HAVE_MATPLOTLIB:
+        print("Error: matplotlib not installed", file=sys.stderr)
+        print("Install with: pip install matplotlib numpy", file=sys.stderr)
+        sys.exit(1)
+    
     # Ensure output directory exists
     args.output.mkdir(parents=True, exist_ok=True)
     
-    # Find CSV files
+    # Find CSV and JSON Lines files
     csv_files = list(args.input.glob('*.csv'))
-    if not csv_files:
-        print(f"No CSV files found in {args.input}", file=sys.stderr)
-        print("Run benchmarks first with --csv flag", file=sys.stderr)
+    phases = load_phases(args.input)
+    if not csv_files and not phases:
+        print(f"No CSV or JSONL files found in {args.input}", file=sys.stderr)
+        print("Run benchmarks first with --csv / --json flags", file=sys.stderr)
         sys.exit(1)
     
-    print(f"Found {len(csv_files)} CSV file(s) in {args.input}")
+    print(f"Found {len(csv_files)} CSV file(s) and {len(phases)} JSONL phase(s) in {args.input}")
     
     # Load all data
     all_data = []
@@ -371,7 +527,7 @@ def main():
         print(f"Loading {csv_file.name}...")
         all_data.extend(load_csv(csv_file))
     
-    if not all_data:
+    if not all_data and not phases:
         print("No data loaded", file=sys.stderr)
         sys.exit(1)
     
@@ -399,6 +555,9 @@ def main():
     if scaling_data:
         plot_scaling(scaling_data, args.output)
     
+    if phases:
+        plot_counters(phases, args.output)
+    
     if latency_data or frag_data:
         plot_summary_card(latency_data, frag_data, args.output)
     
@@ -11,14 +11,13 @@
  *
  * Build:
  *   cd src/
- *   make CFLAGS="-DENABLE_TLS_CACHE=1 -I../include"
- *   gcc -O3 -pthread -I../include -DENABLE_TLS_CACHE=1 \
- *       ../workloads/locality_bench.c \
- *       slab_alloc.o slab_tls_cache.o epoch_domain.o slab_stats.o \
- *       -o ../workloads/locality_bench
+ *   make locality_bench CFLAGS="$(CFLAGS) -DENABLE_TLS_CACHE=1" TLS_OBJ=slab_tls_cache.o
  *
  * Run:
- *   ./workloads/locality_bench
+ *   ./workloads/locality_bench [--json results.jsonl]
+ *
+ * With --json, the main loop's HW counters (summed over threads) are written
+ * as a tslab-bench-v1 "mixed" phase; see src/bench_perf.h.
  */
 
 #include <slab_alloc.h>
@@ -30,11 +29,19 @@
 #include <time.h>
 #include <pthread.h>
 
+#include "bench_perf.h"
+
 #define WORKING_SET_SIZE 256     /* Small live set per thread */
 #define OPS_PER_THREAD 1000000   /* 1M operations per thread */
 #define OBJECT_SIZE 128          /* Single size class */
 #define NUM_THREADS 4            /* Modest parallelism */
 
+#if ENABLE_TLS_CACHE
+#define ALLOCATOR_NAME "temporal-slab+tls"
+#else
+#define ALLOCATOR_NAME "temporal-slab"
+#endif
+
 typedef struct {
     uint64_t alloc_latency_ns;
     uint64_t free_latency_ns;
@@ -47,6 +54,7 @@ typedef struct {
     uint32_t thread_id;
     uint32_t epoch_id;
     ThreadStats stats;
+    BenchPerf perf;
 } ThreadArg;
 
 static inline uint64_t rdtsc(void) {
@@ -89,6 +97,8 @@ void* worker_thread(void* arg) {
     }
     
     /* Main loop: Random alloc/free within working set */
+    bench_perf_open(&targ->perf);
+    bench_perf_start(&targ->perf);
     for (uint32_t op = 0; op < OPS_PER_THREAD; op++) {
         uint32_t slot = xorshift32(&rng_state) % WORKING_SET_SIZE;
         
@@ -118,6 +128,9 @@ void* worker_thread(void* arg) {
         }
     }
     
+    bench_perf_stop(&targ->perf);
+    bench_perf_close(&targ->perf);
+    
     /* Cleanup: Free all live objects */
     for (uint32_t i = 0; i < WORKING_SET_SIZE; i++) {
         if (working_set[i] != 0) {
@@ -133,7 +146,14 @@ void* worker_thread(void* arg) {
     return NULL;
 }
 
-int main(void) {
+int main(int argc, char** argv) {
+    const char* json_path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            json_path = argv[++i];
+        }
+    }
+    
     printf("=== Locality Benchmark ===\n");
     printf("Working set: %u objects per thread\n", WORKING_SET_SIZE);
     printf("Operations: %u per thread\n", OPS_PER_THREAD);
@@ -174,8 +194,11 @@ int main(void) {
     uint64_t total_free_lat = 0;
     uint64_t total_alloc_count = 0;
     uint64_t total_free_count = 0;
+    BenchPerf perf;
+    memset(&perf, 0, sizeof(perf));
     
     for (uint32_t i = 0; i < NUM_THREADS; i++) {
+        bench_perf_merge(&perf, &thread_args[i].perf);
         total_alloc_lat += thread_args[i].stats.alloc_latency_ns;
         total_free_lat += thread_args[i].stats.free_latency_ns;
         total_alloc_count += thread_args[i].stats.alloc_count;
@@ -187,7 +210,27 @@ int main(void) {
     
     printf("Results:\n");
     printf("  Alloc operations: %lu (avg %.1f cycles)\n", total_alloc_count, avg_alloc_cycles);
-    printf("  Free operations:  %lu (avg %.1f cycles)\n\n", total_free_count, avg_free_cycles);
+    printf("  Free operations:  %lu (avg %.1f cycles)\n", total_free_count, avg_free_cycles);
+    bench_perf_print(&perf, total_alloc_count + total_free_count);
+    printf("\n");
+    
+    if (json_path) {
+        FILE* jf = fopen(json_path, "w");
+        if (!jf) {
+            fprintf(stderr, "Failed to open JSON file: %s\n", json_path);
+        } else {
+            /* Latencies are rdtsc cycles, not ns: left null, see per_op.cycles */
+            BenchPhase ph = {
+                .bench = "locality_bench",
+                .phase = "mixed",
+                .allocator = ALLOCATOR_NAME,
+                .threads = NUM_THREADS,
+                .ops = total_alloc_count + total_free_count,
+            };
+            bench_json_phase(jf, &ph, &perf);
+            fclose(jf);
+        }
+    }
     
 #if ENABLE_TLS_CACHE
     /* Print TLS stats to validate hit rate */
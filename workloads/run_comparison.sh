@@ -1,54 +1,78 @@
 #!/bin/bash
-# run_comparison.sh - Systematic malloc vs tslab comparison
+# run_comparison.sh - Systematic allocator comparison
 #
-# Runs all 5 patterns with both allocators and captures metrics.
-# Assumes observability stack is running and push-metrics.sh is active.
+# Runs every pattern against every allocator and captures metrics.
+# Allocators whose library is not installed exit with status 77 and are
+# skipped. If the observability stack is running (push-metrics.sh active),
+# a Pushgateway snapshot is saved after each run.
+#
+# Environment:
+#   DURATION=60                           seconds per run
+#   THREADS=64                            threads per run
+#   ALLOCATORS="tslab malloc jemalloc mimalloc tcmalloc"
+#   PATTERNS="burst steady leak hotspot kernel handoff_spsc handoff_mpmc inflight sizemix"
+#   EXTRA_ARGS=""                         passed to every synthetic_bench run
+#
+# Results land in comparison_results_<timestamp>/ as <pattern>_<allocator>.txt
+# plus .jsonl (tslab-bench-v1, see src/bench_perf.h) and a summary.tsv.
 
 set -e
 
-DURATION=60  # seconds per run
-PATTERNS=("burst" "steady" "leak" "hotspot" "kernel")
+DURATION=${DURATION:-60}
+THREADS=${THREADS:-64}
+read -r -a ALLOCATORS <<< "${ALLOCATORS:-tslab malloc jemalloc mimalloc tcmalloc}"
+read -r -a PATTERNS <<< "${PATTERNS:-burst steady leak hotspot kernel handoff_spsc handoff_mpmc inflight sizemix}"
+read -r -a EXTRA <<< "${EXTRA_ARGS:-}"
 RESULTS_DIR="comparison_results_$(date +%Y%m%d_%H%M%S)"
 
 mkdir -p "$RESULTS_DIR"
+SUMMARY="$RESULTS_DIR/summary.tsv"
+printf "pattern\tallocator\tthreads\treq_per_s\tobj_per_s\trss_peak_mib\trss_final_mib\n" > "$SUMMARY"
 
-echo "Malloc vs tslab comparison"
-echo "=========================="
-echo "Duration: ${DURATION}s per pattern"
+echo "Allocator comparison"
+echo "===================="
+echo "Allocators: ${ALLOCATORS[*]}"
+echo "Patterns:   ${PATTERNS[*]}"
+echo "Duration:   ${DURATION}s per run, ${THREADS} threads"
 echo "Results directory: $RESULTS_DIR"
 echo ""
 
 for pattern in "${PATTERNS[@]}"; do
     echo "=== Pattern: $pattern ==="
-    
-    # Run with malloc
-    echo "  Running malloc..."
-    ./synthetic_bench --allocator=malloc --pattern="$pattern" --duration_s="$DURATION" \
-        > "$RESULTS_DIR/${pattern}_malloc.txt" 2>&1
-    
-    # Wait for metrics to stabilize
-    sleep 5
-    
-    # Capture malloc metrics snapshot
-    curl -s http://localhost:9091/metrics > "$RESULTS_DIR/${pattern}_malloc_metrics.txt"
-    
-    # Wait between runs
-    sleep 10
-    
-    # Run with tslab
-    echo "  Running tslab..."
-    ./synthetic_bench --allocator=tslab --pattern="$pattern" --duration_s="$DURATION" \
-        > "$RESULTS_DIR/${pattern}_tslab.txt" 2>&1
-    
-    # Wait for metrics to stabilize
-    sleep 5
-    
-    # Capture tslab metrics snapshot
-    curl -s http://localhost:9091/metrics > "$RESULTS_DIR/${pattern}_tslab_metrics.txt"
-    
-    # Wait between patterns
-    sleep 10
-    
+
+    for alloc in "${ALLOCATORS[@]}"; do
+        out="$RESULTS_DIR/${pattern}_${alloc}"
+        echo "  Running $alloc..."
+        rc=0
+        ./synthetic_bench --allocator="$alloc" --pattern="$pattern" \
+            --duration_s="$DURATION" --threads="$THREADS" --json="$out.jsonl" \
+            "${EXTRA[@]}" > "$out.txt" 2>&1 || rc=$?
+
+        if [ "$rc" -eq 77 ]; then
+            echo "    skipped ($alloc not installed)"
+            rm -f "$out.txt" "$out.jsonl"
+            continue
+        elif [ "$rc" -ne 0 ]; then
+            echo "    FAILED (exit $rc), see $out.txt"
+            continue
+        fi
+
+        awk -v p="$pattern" -v a="$alloc" '
+            /^Threads: /           { t = $2 }
+            /^Request rate:/       { r = $3 }
+            /^Allocation rate:/    { o = $3 }
+            /^RSS peak \/ final:/  { pk = $5; fi = $7 }
+            END { printf "%s\t%s\t%s\t%s\t%s\t%s\t%s\n", p, a, t, r, o, pk, fi }
+        ' "$out.txt" >> "$SUMMARY"
+
+        # Wait for metrics to stabilize, then snapshot them if a Pushgateway is up
+        sleep 5
+        curl -s --max-time 5 http://localhost:9091/metrics > "${out}_metrics.txt" 2>/dev/null || rm -f "${out}_metrics.txt"
+
+        # Wait between runs
+        sleep 10
+    done
+
     echo "  Complete"
     echo ""
 done
@@ -56,7 +80,9 @@ done
 echo "=== Comparison complete ==="
 echo "Results saved to: $RESULTS_DIR"
 echo ""
+column -t -s $'\t' "$SUMMARY" 2>/dev/null || cat "$SUMMARY"
+echo ""
 echo "Next steps:"
 echo "1. Analyze results: cd $RESULTS_DIR && ls -lh"
-echo "2. Compare outputs: diff ${pattern}_malloc.txt ${pattern}_tslab.txt"
-echo "3. Extract key metrics: grep 'Request rate\|Allocation rate\|Objects leaked' *.txt"
+echo "2. Per-op HW counters: python3 ../tools/plot_bench.py --input $RESULTS_DIR --output $RESULTS_DIR"
+echo "3. Update COMPARISON_RESULTS.md from summary.tsv"
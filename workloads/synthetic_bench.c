@@ -1,34 +1,59 @@
 /*
  * synthetic_bench.c - Canonical benchmark harness for temporal-slab allocator
  *
- * Parameterized workload generator with 5 built-in patterns designed to
- * demonstrate allocator behavior in Grafana dashboards.
+ * Parameterized workload generator with built-in patterns designed to
+ * demonstrate allocator behavior in Grafana dashboards and to compare
+ * allocators under the traffic shapes we actually run:
+ *
+ *   burst, steady, leak, hotspot, kernel - same-thread request lifecycles
+ *   handoff_spsc  - I/O threads allocate, paired worker threads free (SPSC rings)
+ *   handoff_mpmc  - producers and consumers share one bounded MPMC queue
+ *   inflight      - many requests (and epochs) open per thread at once
+ *   sizemix       - skewed size mix across classes (any pattern: --size_mix)
+ *
+ * Backends: tslab, malloc, and jemalloc/mimalloc/tcmalloc loaded with
+ * dlopen() (--allocator_lib=PATH overrides the library searched for).
  *
  * Compile:
- *   cd /home/blackwd/code/ZNS-Slab/src
- *   make slab_lib.o
- *   gcc -O3 -std=c11 -pthread -Wall -Wextra -pedantic -I../include \
- *       -DENABLE_RSS_RECLAMATION=1 ../workloads/synthetic_bench.c slab_lib.o \
- *       -o ../workloads/synthetic_bench
+ *   cd src && make synthetic_bench
  *
  * Usage:
  *   ./synthetic_bench --allocator=tslab --pattern=burst --duration_s=60
  *   ./synthetic_bench --allocator=malloc --pattern=steady --duration_s=60
+ *   ./synthetic_bench --allocator=jemalloc --pattern=handoff_mpmc --threads=64
+ *   ./synthetic_bench --pattern=steady --duration_s=10 --json=steady.jsonl
+ *   ./synthetic_bench --pattern=steady --duration_s=10 --trace_out=steady.trace
+ *
+ * --json writes the workers' HW counters (summed) for the whole run as one
+ * tslab-bench-v1 phase named after the pattern (see src/bench_perf.h).
+ * --trace_out records the run with slab_trace_start() for tslab_replay.
+ *
+ * Exit status 77 means the requested dlopen backend is not installed.
  */
 
 #define _GNU_SOURCE
 #include <slab_alloc.h>
 #include <slab_stats.h>
+#include <slab_trace.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdint.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 #include <time.h>
 #include <unistd.h>
 #include <getopt.h>
 #include <pthread.h>
+#include <sched.h>
 #include <errno.h>
+#include <dlfcn.h>
+#include <link.h>
+
+#include "bench_perf.h"
+
+#define CACHE_LINE 64
+#define EXIT_BACKEND_UNAVAILABLE 77
 
 /* ============================================================================
  * Configuration
@@ -40,11 +65,18 @@ typedef enum {
     PATTERN_LEAK,
     PATTERN_HOTSPOT,
     PATTERN_KERNEL,
+    PATTERN_HANDOFF_SPSC,
+    PATTERN_HANDOFF_MPMC,
+    PATTERN_INFLIGHT,
+    PATTERN_SIZEMIX,
 } WorkloadPattern;
 
 typedef enum {
     ALLOCATOR_TSLAB,
     ALLOCATOR_MALLOC,
+    ALLOCATOR_JEMALLOC,
+    ALLOCATOR_MIMALLOC,
+    ALLOCATOR_TCMALLOC,
 } AllocatorBackend;
 
 typedef enum {
@@ -59,21 +91,36 @@ typedef enum {
     FREE_POLICY_LEAK,       /* Leak a percentage of objects */
 } FreePolicy;
 
+typedef enum {
+    SIZE_MIX_FIXED,         /* Every object is cfg->size */
+    SIZE_MIX_SKEWED,        /* Zipf-like over k_skewed_sizes, small sizes hot */
+} SizeMix;
+
 typedef struct {
     AllocatorBackend allocator;
+    const char* allocator_lib; /* dlopen path override (NULL = search defaults) */
     WorkloadPattern pattern;
     uint32_t duration_s;
     uint32_t threads;
-    uint32_t req_rate;         /* Requests per second per thread */
+    uint32_t producers;        /* handoff_mpmc: producer threads (0 = threads/2) */
+    uint32_t queue_depth;      /* handoff: queue capacity in objects */
+    uint32_t inflight;         /* inflight: open requests per thread */
+    uint32_t req_rate;         /* Requests per second per thread (0 = unpaced) */
     uint32_t objs_min;
     uint32_t objs_max;
-    size_t size;               /* Object size (single-class for MVP) */
+    size_t size;               /* Object size for SIZE_MIX_FIXED */
+    SizeMix size_mix;
     EpochPolicy epoch_policy;
     uint32_t batch_size;       /* For EPOCH_POLICY_BATCH */
     FreePolicy free_policy;
     uint32_t lag_window;       /* For FREE_POLICY_LAG */
     float leak_pct;            /* For FREE_POLICY_LEAK (0.0-1.0) */
-    uint32_t rss_sample_ms;    /* RSS sampling interval (0 = disabled) */
+    uint32_t epoch_count;      /* tslab epoch ring slots (0 = default/auto) */
+    bool remote_free;          /* tslab SlabAllocatorConfig.remote_free */
+    bool hugepage_slabs;       /* tslab SlabAllocatorConfig.hugepage_slabs */
+    uint32_t rss_sample_ms;    /* RSS sampling interval (0 = once per second) */
+    const char* json_path;     /* tslab-bench-v1 output (NULL = disabled) */
+    const char* trace_path;    /* tslab: capture an allocation trace (NULL = disabled) */
 } BenchConfig;
 
 /* ============================================================================
@@ -81,18 +128,21 @@ typedef struct {
  * ============================================================================ */
 
 typedef struct {
+    const char* name;
     void* ctx;
-    void* (*alloc_fn)(void* ctx, size_t size, uint32_t epoch, SlabHandle* out_handle);
+    bool has_epochs;
+    void* (*alloc_fn)(void* ctx, size_t size, EpochId epoch, SlabHandle* out_handle);
     void (*free_fn)(void* ctx, void* ptr, SlabHandle handle);
-    void (*close_epoch_fn)(void* ctx, uint32_t epoch);
-    uint32_t (*advance_epoch_fn)(void* ctx);
-    uint32_t (*current_epoch_fn)(void* ctx);
+    void (*close_epoch_fn)(void* ctx, EpochId epoch);
+    EpochId (*advance_epoch_fn)(void* ctx);
+    EpochId (*current_epoch_fn)(void* ctx);
+    void (*destroy_fn)(void* ctx);
 } Backend;
 
 /* Temporal-slab backend */
-static void* tslab_alloc(void* ctx, size_t size, uint32_t epoch, SlabHandle* out_handle) {
+static void* tslab_alloc(void* ctx, size_t size, EpochId epoch, SlabHandle* out_handle) {
     SlabAllocator* a = (SlabAllocator*)ctx;
-    return alloc_obj_epoch(a, size, epoch, out_handle);
+    return alloc_obj_epoch(a, (uint32_t)size, epoch, out_handle);
 }
 
 static void tslab_free(void* ctx, void* ptr, SlabHandle handle) {
@@ -101,82 +151,208 @@ static void tslab_free(void* ctx, void* ptr, SlabHandle handle) {
     free_obj(a, handle);
 }
 
-static void tslab_close_epoch(void* ctx, uint32_t epoch) {
+static void tslab_close_epoch(void* ctx, EpochId epoch) {
     SlabAllocator* a = (SlabAllocator*)ctx;
     epoch_close(a, epoch);
 }
 
-static uint32_t tslab_advance_epoch(void* ctx) {
+static EpochId tslab_advance_epoch(void* ctx) {
     SlabAllocator* a = (SlabAllocator*)ctx;
     epoch_advance(a);
     return epoch_current(a);
 }
 
-static uint32_t tslab_current_epoch(void* ctx) {
+static EpochId tslab_current_epoch(void* ctx) {
     SlabAllocator* a = (SlabAllocator*)ctx;
     return epoch_current(a);
 }
 
-/* malloc backend (baseline comparison) */
-static void* malloc_alloc(void* ctx, size_t size, uint32_t epoch, SlabHandle* out_handle) {
-    (void)ctx; (void)epoch; (void)out_handle;
-    return malloc(size);
+static void tslab_destroy(void* ctx) {
+    slab_allocator_free((SlabAllocator*)ctx);
+}
+
+/* malloc-style backends (system malloc, or a dlopen'd library) */
+typedef struct {
+    void* dl;                          /* dlopen handle, NULL for libc */
+    void* (*malloc_fn)(size_t);
+    void (*free_fn)(void*);
+} MallocLib;
+
+static void* malloc_alloc(void* ctx, size_t size, EpochId epoch, SlabHandle* out_handle) {
+    MallocLib* lib = (MallocLib*)ctx;
+    (void)epoch; (void)out_handle;
+    return lib->malloc_fn(size);
 }
 
 static void malloc_free(void* ctx, void* ptr, SlabHandle handle) {
-    (void)ctx; (void)handle;
-    free(ptr);
+    MallocLib* lib = (MallocLib*)ctx;
+    (void)handle;
+    lib->free_fn(ptr);
 }
 
-static void malloc_close_epoch(void* ctx, uint32_t epoch) {
+static void malloc_close_epoch(void* ctx, EpochId epoch) {
     (void)ctx; (void)epoch;
     /* malloc has no epoch concept - no-op */
 }
 
-static uint32_t malloc_advance_epoch(void* ctx) {
+static EpochId malloc_advance_epoch(void* ctx) {
     (void)ctx;
     return 0;  /* malloc has no epochs */
 }
 
-static uint32_t malloc_current_epoch(void* ctx) {
+static EpochId malloc_current_epoch(void* ctx) {
     (void)ctx;
     return 0;
 }
 
+static void malloc_destroy(void* ctx) {
+    MallocLib* lib = (MallocLib*)ctx;
+    /* Never dlclose: allocator libraries keep TLS destructors and atexit
+     * hooks registered that must stay mapped until process exit. */
+    free(lib);
+}
+
+/* dlopen'd allocators. Each library is searched by soname unless
+ * --allocator_lib is given, and the entry points must resolve INSIDE that
+ * library: dlsym() also searches its dependencies, and silently falling back
+ * to libc's malloc would make the comparison meaningless. */
+typedef struct {
+    AllocatorBackend id;
+    const char* name;
+    const char* sonames[4];
+    const char* malloc_sym;
+    const char* free_sym;
+} DlAllocatorDesc;
+
+static const DlAllocatorDesc k_dl_allocators[] = {
+    {ALLOCATOR_JEMALLOC, "jemalloc",
+     {"libjemalloc.so.2", "libjemalloc.so", NULL}, "malloc", "free"},
+    {ALLOCATOR_MIMALLOC, "mimalloc",
+     {"libmimalloc.so.2", "libmimalloc.so", NULL}, "mi_malloc", "mi_free"},
+    {ALLOCATOR_TCMALLOC, "tcmalloc",
+     {"libtcmalloc_minimal.so.4", "libtcmalloc.so.4", "libtcmalloc_minimal.so", NULL},
+     "tc_malloc", "tc_free"},
+};
+
+static bool symbol_in_library(void* dl, void* sym) {
+    struct link_map* lm = NULL;
+    Dl_info info;
+    if (dlinfo(dl, RTLD_DI_LINKMAP, &lm) != 0 || !lm) return false;
+    if (!dladdr(sym, &info) || !info.dli_fname) return false;
+    return strcmp(info.dli_fname, lm->l_name) == 0;
+}
+
+static MallocLib* malloc_lib_open(const DlAllocatorDesc* d, const char* path_override) {
+    void* dl = NULL;
+    if (path_override) {
+        dl = dlopen(path_override, RTLD_NOW | RTLD_LOCAL);
+    } else {
+        for (int i = 0; !dl && d->sonames[i]; i++) {
+            dl = dlopen(d->sonames[i], RTLD_NOW | RTLD_LOCAL);
+        }
+    }
+    if (!dl) {
+        fprintf(stderr, "%s backend unavailable: %s\n", d->name, dlerror());
+        return NULL;
+    }
+
+    void* m = dlsym(dl, d->malloc_sym);
+    void* f = dlsym(dl, d->free_sym);
+    if (!m || !f || !symbol_in_library(dl, m) || !symbol_in_library(dl, f)) {
+        fprintf(stderr, "%s backend unavailable: %s/%s not defined by the library\n",
+                d->name, d->malloc_sym, d->free_sym);
+        return NULL;
+    }
+
+    MallocLib* lib = calloc(1, sizeof(MallocLib));
+    if (!lib) return NULL;
+    lib->dl = dl;
+    /* POSIX dlsym() idiom: object pointer -> function pointer */
+    *(void**)&lib->malloc_fn = m;
+    *(void**)&lib->free_fn = f;
+    return lib;
+}
+
+static const char* allocator_name(AllocatorBackend id) {
+    switch (id) {
+    case ALLOCATOR_TSLAB:    return "tslab";
+    case ALLOCATOR_MALLOC:   return "malloc";
+    case ALLOCATOR_JEMALLOC: return "jemalloc";
+    case ALLOCATOR_MIMALLOC: return "mimalloc";
+    case ALLOCATOR_TCMALLOC: return "tcmalloc";
+    }
+    return "unknown";
+}
+
 static Backend* backend_create(BenchConfig* cfg) {
     Backend* b = calloc(1, sizeof(Backend));
     if (!b) return NULL;
+    b->name = allocator_name(cfg->allocator);
 
     if (cfg->allocator == ALLOCATOR_TSLAB) {
-        SlabAllocator* a = slab_allocator_create();
+        SlabAllocatorConfig sc = {
+            .epoch_count = cfg->epoch_count,
+            .remote_free = cfg->remote_free,
+            .hugepage_slabs = cfg->hugepage_slabs,
+        };
+        SlabAllocator* a = slab_allocator_create_with_config(&sc);
         if (!a) {
+            fprintf(stderr, "slab_allocator_create_with_config: %s\n", strerror(errno));
+            free(b);
+            return NULL;
+        }
+        /* Rings sized for unpaced runs; slab_allocator_free() ends the capture */
+        SlabTraceConfig tc = { .path = cfg->trace_path, .ring_records = 1u << 16 };
+        if (cfg->trace_path && !slab_trace_start(a, &tc)) {
+            fprintf(stderr, "slab_trace_start(%s): %s\n", cfg->trace_path, strerror(errno));
+            slab_allocator_free(a);
             free(b);
             return NULL;
         }
         b->ctx = a;
+        b->has_epochs = true;
         b->alloc_fn = tslab_alloc;
         b->free_fn = tslab_free;
         b->close_epoch_fn = tslab_close_epoch;
         b->advance_epoch_fn = tslab_advance_epoch;
         b->current_epoch_fn = tslab_current_epoch;
+        b->destroy_fn = tslab_destroy;
+        return b;
+    }
+
+    MallocLib* lib = NULL;
+    if (cfg->allocator == ALLOCATOR_MALLOC) {
+        lib = calloc(1, sizeof(MallocLib));
+        if (lib) {
+            lib->malloc_fn = malloc;
+            lib->free_fn = free;
+        }
     } else {
-        b->ctx = NULL;  /* malloc doesn't need context */
-        b->alloc_fn = malloc_alloc;
-        b->free_fn = malloc_free;
-        b->close_epoch_fn = malloc_close_epoch;
-        b->advance_epoch_fn = malloc_advance_epoch;
-        b->current_epoch_fn = malloc_current_epoch;
+        for (size_t i = 0; i < sizeof(k_dl_allocators) / sizeof(k_dl_allocators[0]); i++) {
+            if (k_dl_allocators[i].id == cfg->allocator) {
+                lib = malloc_lib_open(&k_dl_allocators[i], cfg->allocator_lib);
+                break;
+            }
+        }
+    }
+    if (!lib) {
+        free(b);
+        return NULL;
     }
 
+    b->ctx = lib;
+    b->alloc_fn = malloc_alloc;
+    b->free_fn = malloc_free;
+    b->close_epoch_fn = malloc_close_epoch;
+    b->advance_epoch_fn = malloc_advance_epoch;
+    b->current_epoch_fn = malloc_current_epoch;
+    b->destroy_fn = malloc_destroy;
     return b;
 }
 
 static void backend_destroy(Backend* b) {
     if (!b) return;
-    if (b->ctx) {
-        /* Assume temporal-slab if ctx is non-NULL */
-        slab_allocator_free((SlabAllocator*)b->ctx);
-    }
+    b->destroy_fn(b->ctx);
     free(b);
 }
 
@@ -233,139 +409,562 @@ static bool free_buffer_dequeue(FreeBuffer* fb, void** out_ptr, SlabHandle* out_
     return true;
 }
 
+/* ============================================================================
+ * Handoff Queues (producer allocates, consumer frees)
+ * ============================================================================ */
+
+/* Single-producer/single-consumer ring. head and tail live on separate
+ * cache lines so the pair only shares the lines holding the items. */
+typedef struct {
+    _Alignas(CACHE_LINE) _Atomic uint32_t head;   /* Consumer position */
+    _Alignas(CACHE_LINE) _Atomic uint32_t tail;   /* Producer position */
+    _Alignas(CACHE_LINE) uint32_t mask;
+    PendingFree* items;
+} SpscRing;
+
+/* Bounded multi-producer/multi-consumer queue (Vyukov): each cell's
+ * sequence number says whether it is ready for the next enqueue or dequeue. */
+typedef struct {
+    _Atomic size_t seq;
+    PendingFree item;
+} MpmcCell;
+
+typedef struct {
+    _Alignas(CACHE_LINE) _Atomic size_t enqueue_pos;
+    _Alignas(CACHE_LINE) _Atomic size_t dequeue_pos;
+    _Alignas(CACHE_LINE) size_t mask;
+    MpmcCell* cells;
+} MpmcQueue;
+
+static uint32_t round_up_pow2(uint32_t v) {
+    uint32_t p = 1;
+    while (p < v && p < (1u << 31)) p <<= 1;
+    return p;
+}
+
+static void* cache_aligned_calloc(size_t size) {
+    size = (size + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1);
+    void* p = aligned_alloc(CACHE_LINE, size);
+    if (p) memset(p, 0, size);
+    return p;
+}
+
+static SpscRing* spsc_create(uint32_t capacity) {
+    SpscRing* r = cache_aligned_calloc(sizeof(SpscRing));
+    if (!r) return NULL;
+    capacity = round_up_pow2(capacity);
+    r->items = calloc(capacity, sizeof(PendingFree));
+    if (!r->items) {
+        free(r);
+        return NULL;
+    }
+    r->mask = capacity - 1;
+    return r;
+}
+
+static void spsc_destroy(SpscRing* r) {
+    if (!r) return;
+    free(r->items);
+    free(r);
+}
+
+static bool spsc_push(SpscRing* r, PendingFree it) {
+    uint32_t t = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    uint32_t h = atomic_load_explicit(&r->head, memory_order_acquire);
+    if (t - h > r->mask) return false;  /* Full */
+    r->items[t & r->mask] = it;
+    atomic_store_explicit(&r->tail, t + 1, memory_order_release);
+    return true;
+}
+
+static bool spsc_pop(SpscRing* r, PendingFree* out) {
+    uint32_t h = atomic_load_explicit(&r->head, memory_order_relaxed);
+    uint32_t t = atomic_load_explicit(&r->tail, memory_order_acquire);
+    if (h == t) return false;  /* Empty */
+    *out = r->items[h & r->mask];
+    atomic_store_explicit(&r->head, h + 1, memory_order_release);
+    return true;
+}
+
+static MpmcQueue* mpmc_create(uint32_t capacity) {
+    MpmcQueue* q = cache_aligned_calloc(sizeof(MpmcQueue));
+    if (!q) return NULL;
+    capacity = round_up_pow2(capacity < 2 ? 2 : capacity);
+    q->cells = calloc(capacity, sizeof(MpmcCell));
+    if (!q->cells) {
+        free(q);
+        return NULL;
+    }
+    for (size_t i = 0; i < capacity; i++) {
+        atomic_init(&q->cells[i].seq, i);
+    }
+    q->mask = capacity - 1;
+    return q;
+}
+
+static void mpmc_destroy(MpmcQueue* q) {
+    if (!q) return;
+    free(q->cells);
+    free(q);
+}
+
+static bool mpmc_push(MpmcQueue* q, PendingFree it) {
+    size_t pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+    for (;;) {
+        MpmcCell* c = &q->cells[pos & q->mask];
+        size_t seq = atomic_load_explicit(&c->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&q->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                c->item = it;
+                atomic_store_explicit(&c->seq, pos + 1, memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;  /* Full */
+        } else {
+            pos = atomic_load_explicit(&q->enqueue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+static bool mpmc_pop(MpmcQueue* q, PendingFree* out) {
+    size_t pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+    for (;;) {
+        MpmcCell* c = &q->cells[pos & q->mask];
+        size_t seq = atomic_load_explicit(&c->seq, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&q->dequeue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                *out = c->item;
+                atomic_store_explicit(&c->seq, pos + q->mask + 1, memory_order_release);
+                return true;
+            }
+        } else if (diff < 0) {
+            return false;  /* Empty */
+        } else {
+            pos = atomic_load_explicit(&q->dequeue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+/* ============================================================================
+ * Size Mix
+ * ============================================================================ */
+
+/* Skewed mix: weight 1/rank over these sizes, so 32-128B objects make up
+ * ~60% of allocations while the 1K-4K tail still hits the larger classes. */
+static const uint32_t k_skewed_sizes[] = {32, 64, 96, 128, 192, 256, 512, 1024, 2048, 4096};
+#define SKEWED_SIZE_COUNT (sizeof(k_skewed_sizes) / sizeof(k_skewed_sizes[0]))
+static uint32_t g_skewed_cdf[SKEWED_SIZE_COUNT];  /* Cumulative weights, scaled */
+
+static void size_mix_init(void) {
+    double total = 0.0;
+    for (uint32_t i = 0; i < SKEWED_SIZE_COUNT; i++) total += 1.0 / (double)(i + 1);
+    double acc = 0.0;
+    for (uint32_t i = 0; i < SKEWED_SIZE_COUNT; i++) {
+        acc += 1.0 / (double)(i + 1);
+        g_skewed_cdf[i] = (uint32_t)(acc / total * (double)UINT32_MAX);
+    }
+    g_skewed_cdf[SKEWED_SIZE_COUNT - 1] = UINT32_MAX;
+}
+
 /* ============================================================================
  * Request Simulation
  * ============================================================================ */
 
+typedef enum {
+    ROLE_WORKER,    /* Allocates and frees its own requests */
+    ROLE_PRODUCER,  /* Allocates, hands objects to a consumer */
+    ROLE_CONSUMER,  /* Frees objects allocated by producers */
+} WorkerRole;
+
 typedef struct {
-    Backend* backend;
-    BenchConfig* config;
+    EpochId epoch;        /* Epoch the request allocated into last */
+    EpochId first_epoch;  /* Differs from epoch if it was rotated away mid-request */
+    uint32_t count;
+    void** ptrs;
+    SlabHandle* handles;
+} Request;
+
+typedef struct BenchRun BenchRun;
+
+typedef struct {
+    BenchRun* run;
+    uint32_t id;
+    WorkerRole role;
+    uint64_t rng;
     FreeBuffer* free_buffer;
+    SpscRing* spsc;            /* handoff_spsc: this pair's ring */
+    Request* requests;         /* 1 request, or cfg->inflight for inflight */
+    uint32_t inflight_head;
+    uint32_t inflight_count;
+    EpochId current_epoch;
+    uint32_t reqs_in_current_epoch;
     uint64_t requests_completed;
     uint64_t objects_allocated;
     uint64_t objects_freed;
     uint64_t objects_leaked;
-    uint32_t current_epoch;
-    uint32_t reqs_in_current_epoch;
-    volatile bool stop;
+    uint64_t epoch_retries;    /* Allocations retried after the epoch rotated */
+    uint64_t queue_full_waits; /* Producer found the handoff queue full */
+    uint64_t checksum;         /* Consumer reads, keeps the touch observable */
+    BenchPerf perf;            /* Worker's HW counters for the whole run */
 } WorkerState;
 
+struct BenchRun {
+    Backend* backend;
+    BenchConfig* config;
+    WorkerState* workers;
+    uint32_t num_workers;
+    MpmcQueue* mpmc;
+    _Atomic bool stop;
+    _Atomic uint32_t producers_live;
+};
+
 static uint64_t get_time_ns(void) {
     struct timespec ts;
     clock_gettime(CLOCK_MONOTONIC, &ts);
     return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
 }
 
-static void simulate_request(WorkerState* ws) {
-    BenchConfig* cfg = ws->config;
-    Backend* b = ws->backend;
+/* Per-thread PRNG (rand() shares one locked state across threads) */
+static inline uint64_t xorshift64(uint64_t* s) {
+    uint64_t x = *s;
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *s = x;
+    return x;
+}
+
+static size_t pick_size(WorkerState* ws) {
+    BenchConfig* cfg = ws->run->config;
+    if (cfg->size_mix == SIZE_MIX_FIXED) return cfg->size;
+
+    uint32_t r = (uint32_t)(xorshift64(&ws->rng) >> 32);
+    for (uint32_t i = 0; i < SKEWED_SIZE_COUNT; i++) {
+        if (r <= g_skewed_cdf[i]) return k_skewed_sizes[i];
+    }
+    return k_skewed_sizes[SKEWED_SIZE_COUNT - 1];
+}
+
+static bool request_init(Request* r, uint32_t capacity) {
+    r->ptrs = calloc(capacity, sizeof(void*));
+    r->handles = calloc(capacity, sizeof(SlabHandle));
+    return r->ptrs && r->handles;
+}
+
+static void request_destroy(Request* r) {
+    free(r->ptrs);
+    free(r->handles);
+}
+
+/* Pick the request's epoch according to the epoch policy */
+static void request_begin(WorkerState* ws, Request* r) {
+    BenchConfig* cfg = ws->run->config;
+    Backend* b = ws->run->backend;
+
+    if (cfg->epoch_policy == EPOCH_POLICY_PER_REQ) {
+        ws->current_epoch = b->advance_epoch_fn(b->ctx);
+    } else if (cfg->epoch_policy == EPOCH_POLICY_BATCH) {
+        if (ws->reqs_in_current_epoch == 0) {
+            ws->current_epoch = b->advance_epoch_fn(b->ctx);
+        }
+    } else {
+        ws->current_epoch = b->current_epoch_fn(b->ctx);
+    }
+    r->epoch = ws->current_epoch;
+    r->first_epoch = r->epoch;
+    r->count = 0;
+}
+
+/* Allocate one object of the request.
+ *
+ * With several threads sharing the epoch ring, another thread's
+ * epoch_advance()/epoch_close() can retire this request's epoch while it is
+ * still allocating (alloc returns NULL for CLOSING epochs). A real service
+ * would move the rest of the request to the current epoch, so do that; a
+ * NULL from an epoch that is still current is a genuine failure. */
+static void* request_alloc_one(WorkerState* ws, Request* r, size_t size, SlabHandle* out) {
+    Backend* b = ws->run->backend;
+
+    for (int attempt = 0; attempt < 8; attempt++) {
+        void* p = b->alloc_fn(b->ctx, size, r->epoch, out);
+        if (p || !b->has_epochs) return p;
+
+        EpochId cur = b->current_epoch_fn(b->ctx);
+        if (cur == r->epoch) {
+            /* Current epoch closed under us by a finishing request */
+            cur = b->advance_epoch_fn(b->ctx);
+        }
+        r->epoch = cur;
+        ws->current_epoch = cur;
+        ws->epoch_retries++;
+    }
+    return NULL;
+}
+
+static bool request_alloc(WorkerState* ws, Request* r) {
+    BenchConfig* cfg = ws->run->config;
 
     /* Determine object count for this request */
     uint32_t obj_count;
     if (cfg->objs_min == cfg->objs_max) {
         obj_count = cfg->objs_min;
     } else {
-        obj_count = cfg->objs_min + (rand() % (cfg->objs_max - cfg->objs_min + 1));
+        obj_count = cfg->objs_min +
+                    (uint32_t)(xorshift64(&ws->rng) % (cfg->objs_max - cfg->objs_min + 1));
     }
 
-    /* Allocate objects */
-    void** ptrs = alloca(obj_count * sizeof(void*));
-    SlabHandle* handles = alloca(obj_count * sizeof(SlabHandle));
-
     for (uint32_t i = 0; i < obj_count; i++) {
-        ptrs[i] = b->alloc_fn(b->ctx, cfg->size, ws->current_epoch, &handles[i]);
-        if (!ptrs[i]) {
-            fprintf(stderr, "Allocation failed at request %lu, object %u\n",
-                    ws->requests_completed, i);
-            ws->stop = true;
-            return;
+        size_t size = pick_size(ws);
+        r->ptrs[i] = request_alloc_one(ws, r, size, &r->handles[i]);
+        if (!r->ptrs[i]) {
+            fprintf(stderr, "Allocation failed at request %lu, object %u (%zu bytes)\n",
+                    ws->requests_completed, i, size);
+            atomic_store(&ws->run->stop, true);
+            return false;
         }
         /* Touch memory to force RSS */
-        memset(ptrs[i], 0x42, cfg->size);
+        memset(r->ptrs[i], 0x42, size);
+        r->count++;
         ws->objects_allocated++;
     }
+    return true;
+}
 
-    /* Free policy: immediate, lag, or leak */
-    for (uint32_t i = 0; i < obj_count; i++) {
-        bool should_leak = false;
-        if (cfg->free_policy == FREE_POLICY_LEAK && cfg->leak_pct > 0.0f) {
-            float r = (float)rand() / (float)RAND_MAX;
-            should_leak = (r < cfg->leak_pct);
-        }
+/* Apply the free policy to one object: leak it, park it in the lag buffer
+ * (freeing the oldest parked object if the buffer is full), or free it. */
+static void dispose_object(WorkerState* ws, void* ptr, SlabHandle handle) {
+    BenchConfig* cfg = ws->run->config;
+    Backend* b = ws->run->backend;
 
-        if (should_leak) {
+    if (cfg->free_policy == FREE_POLICY_LEAK && cfg->leak_pct > 0.0f) {
+        float r = (float)(xorshift64(&ws->rng) >> 40) / (float)(1u << 24);
+        if (r < cfg->leak_pct) {
             ws->objects_leaked++;
-        } else if (cfg->free_policy == FREE_POLICY_LAG) {
-            if (!free_buffer_enqueue(ws->free_buffer, ptrs[i], handles[i])) {
-                fprintf(stderr, "Free buffer full - increasing lag window\n");
-                b->free_fn(b->ctx, ptrs[i], handles[i]);
-                ws->objects_freed++;
-            }
-        } else {
-            /* FREE_POLICY_WITHIN_REQ or FREE_POLICY_LEAK (non-leaked objects) */
-            b->free_fn(b->ctx, ptrs[i], handles[i]);
-            ws->objects_freed++;
+            return;
         }
     }
 
-    /* Drain lag buffer if applicable */
-    if (cfg->free_policy == FREE_POLICY_LAG) {
-        /* Drain one request worth of frees */
-        for (uint32_t i = 0; i < obj_count; i++) {
-            void* ptr;
-            SlabHandle handle;
-            if (free_buffer_dequeue(ws->free_buffer, &ptr, &handle)) {
-                b->free_fn(b->ctx, ptr, handle);
+    if (cfg->free_policy == FREE_POLICY_LAG && ws->free_buffer) {
+        if (!free_buffer_enqueue(ws->free_buffer, ptr, handle)) {
+            void* old_ptr;
+            SlabHandle old_handle;
+            if (free_buffer_dequeue(ws->free_buffer, &old_ptr, &old_handle)) {
+                b->free_fn(b->ctx, old_ptr, old_handle);
                 ws->objects_freed++;
-            } else {
-                break;  /* Buffer empty */
             }
+            free_buffer_enqueue(ws->free_buffer, ptr, handle);
         }
+        return;
     }
 
+    /* FREE_POLICY_WITHIN_REQ or FREE_POLICY_LEAK (non-leaked objects) */
+    b->free_fn(b->ctx, ptr, handle);
+    ws->objects_freed++;
+}
+
+/* Drain up to n lag-buffered objects (all of them if n == UINT32_MAX) */
+static void drain_lag_buffer(WorkerState* ws, uint32_t n) {
+    Backend* b = ws->run->backend;
+    if (!ws->free_buffer) return;
+
+    for (uint32_t i = 0; i < n; i++) {
+        void* ptr;
+        SlabHandle handle;
+        if (!free_buffer_dequeue(ws->free_buffer, &ptr, &handle)) break;
+        b->free_fn(b->ctx, ptr, handle);
+        ws->objects_freed++;
+    }
+}
+
+static void request_release(WorkerState* ws, Request* r) {
+    for (uint32_t i = 0; i < r->count; i++) {
+        dispose_object(ws, r->ptrs[i], r->handles[i]);
+    }
+
+    /* Drain one request worth of lagged frees */
+    if (ws->run->config->free_policy == FREE_POLICY_LAG) {
+        drain_lag_buffer(ws, r->count);
+    }
+}
+
+/* Close the request's epoch(s) according to the epoch policy */
+static void request_end(WorkerState* ws, Request* r) {
+    BenchConfig* cfg = ws->run->config;
+    Backend* b = ws->run->backend;
+
     ws->requests_completed++;
     ws->reqs_in_current_epoch++;
 
-    /* Epoch policy: per-request, batch, or manual */
     if (cfg->epoch_policy == EPOCH_POLICY_PER_REQ) {
-        b->close_epoch_fn(b->ctx, ws->current_epoch);
-        ws->current_epoch = b->advance_epoch_fn(b->ctx);
+        b->close_epoch_fn(b->ctx, r->epoch);
+        if (r->first_epoch != r->epoch) b->close_epoch_fn(b->ctx, r->first_epoch);
         ws->reqs_in_current_epoch = 0;
     } else if (cfg->epoch_policy == EPOCH_POLICY_BATCH) {
         if (ws->reqs_in_current_epoch >= cfg->batch_size) {
             b->close_epoch_fn(b->ctx, ws->current_epoch);
-            ws->current_epoch = b->advance_epoch_fn(b->ctx);
             ws->reqs_in_current_epoch = 0;
         }
     }
     /* EPOCH_POLICY_MANUAL: never advance automatically */
 }
 
+/* Fixed-rate pacing; returns false once the run is stopping */
+static bool pace(WorkerState* ws, uint64_t* next_req_time) {
+    uint32_t rate = ws->run->config->req_rate;
+    if (rate == 0) return !atomic_load_explicit(&ws->run->stop, memory_order_relaxed);
+
+    uint64_t ns_per_req = 1000000000ULL / rate;
+    while (!atomic_load_explicit(&ws->run->stop, memory_order_relaxed)) {
+        uint64_t now = get_time_ns();
+        if (now >= *next_req_time) {
+            *next_req_time += ns_per_req;
+            return true;
+        }
+        /* Sleep until next request */
+        uint64_t sleep_ns = *next_req_time - now;
+        if (sleep_ns > 1000000) {  /* > 1ms */
+            struct timespec ts = {
+                .tv_sec = 0,
+                .tv_nsec = (long)sleep_ns
+            };
+            nanosleep(&ts, NULL);
+        }
+    }
+    return false;
+}
+
+/* burst/steady/leak/hotspot/kernel/sizemix: allocate and free on one thread */
+static void run_worker(WorkerState* ws) {
+    Request* r = &ws->requests[0];
+    uint64_t next_req_time = get_time_ns();
+
+    while (pace(ws, &next_req_time)) {
+        request_begin(ws, r);
+        bool ok = request_alloc(ws, r);
+        request_release(ws, r);
+        if (!ok) break;
+        request_end(ws, r);
+    }
+}
+
+/* inflight: keep cfg->inflight requests open, each in its own epoch; every
+ * new request retires the oldest one (free its objects, close its epoch). */
+static void run_inflight(WorkerState* ws) {
+    uint32_t depth = ws->run->config->inflight;
+    uint64_t next_req_time = get_time_ns();
+
+    while (pace(ws, &next_req_time)) {
+        if (ws->inflight_count == depth) {
+            Request* oldest = &ws->requests[ws->inflight_head];
+            request_release(ws, oldest);
+            request_end(ws, oldest);
+            ws->inflight_head = (ws->inflight_head + 1) % depth;
+            ws->inflight_count--;
+        }
+        Request* r = &ws->requests[(ws->inflight_head + ws->inflight_count) % depth];
+        request_begin(ws, r);
+        ws->inflight_count++;
+        if (!request_alloc(ws, r)) break;
+    }
+
+    while (ws->inflight_count > 0) {
+        Request* oldest = &ws->requests[ws->inflight_head];
+        request_release(ws, oldest);
+        request_end(ws, oldest);
+        ws->inflight_head = (ws->inflight_head + 1) % depth;
+        ws->inflight_count--;
+    }
+}
+
+static bool handoff_push(WorkerState* ws, PendingFree it) {
+    return ws->spsc ? spsc_push(ws->spsc, it) : mpmc_push(ws->run->mpmc, it);
+}
+
+static bool handoff_pop(WorkerState* ws, PendingFree* out) {
+    return ws->spsc ? spsc_pop(ws->spsc, out) : mpmc_pop(ws->run->mpmc, out);
+}
+
+/* I/O thread: allocate a request's objects and hand every one to a consumer.
+ * Consumers run until all producers have exited, so a full queue only
+ * waits, it never drops objects. */
+static void run_producer(WorkerState* ws) {
+    Request* r = &ws->requests[0];
+    uint64_t next_req_time = get_time_ns();
+
+    while (pace(ws, &next_req_time)) {
+        request_begin(ws, r);
+        if (!request_alloc(ws, r)) {
+            request_release(ws, r);
+            break;
+        }
+        for (uint32_t i = 0; i < r->count; i++) {
+            PendingFree it = { .ptr = r->ptrs[i], .handle = r->handles[i] };
+            while (!handoff_push(ws, it)) {
+                ws->queue_full_waits++;
+                sched_yield();
+            }
+        }
+        request_end(ws, r);
+    }
+    atomic_fetch_sub_explicit(&ws->run->producers_live, 1, memory_order_release);
+}
+
+static void consume(WorkerState* ws, PendingFree it) {
+    /* Read the object: the cross-core cache miss is part of the handoff cost */
+    const volatile uint8_t* p = (const volatile uint8_t*)it.ptr;
+    ws->checksum += p[0];
+    dispose_object(ws, it.ptr, it.handle);
+}
+
+/* Worker thread: free what the producers allocated */
+static void run_consumer(WorkerState* ws) {
+    PendingFree it;
+    for (;;) {
+        if (handoff_pop(ws, &it)) {
+            consume(ws, it);
+            continue;
+        }
+        if (atomic_load_explicit(&ws->run->producers_live, memory_order_acquire) == 0) {
+            while (handoff_pop(ws, &it)) consume(ws, it);
+            break;
+        }
+        sched_yield();
+    }
+}
+
 static void* worker_thread(void* arg) {
     WorkerState* ws = (WorkerState*)arg;
-    BenchConfig* cfg = ws->config;
+    BenchConfig* cfg = ws->run->config;
 
-    uint64_t ns_per_req = 1000000000ULL / cfg->req_rate;
-    uint64_t next_req_time = get_time_ns();
+    bench_perf_open(&ws->perf);
+    bench_perf_start(&ws->perf);
 
-    while (!ws->stop) {
-        uint64_t now = get_time_ns();
-        if (now >= next_req_time) {
-            simulate_request(ws);
-            next_req_time += ns_per_req;
+    switch (ws->role) {
+    case ROLE_PRODUCER:
+        run_producer(ws);
+        break;
+    case ROLE_CONSUMER:
+        run_consumer(ws);
+        break;
+    case ROLE_WORKER:
+        if (cfg->pattern == PATTERN_INFLIGHT) {
+            run_inflight(ws);
         } else {
-            /* Sleep until next request */
-            uint64_t sleep_ns = next_req_time - now;
-            if (sleep_ns > 1000000) {  /* > 1ms */
-                struct timespec ts = {
-                    .tv_sec = 0,
-                    .tv_nsec = sleep_ns
-                };
-                nanosleep(&ts, NULL);
-            }
+            run_worker(ws);
         }
+        break;
     }
 
+    bench_perf_stop(&ws->perf);
+    bench_perf_close(&ws->perf);
+
+    /* Anything still parked in the lag buffer is freed on the way out */
+    drain_lag_buffer(ws, UINT32_MAX);
     return NULL;
 }
 
@@ -375,6 +974,7 @@ static void* worker_thread(void* arg) {
 
 static void apply_pattern_preset(BenchConfig* cfg, WorkloadPattern pattern) {
     cfg->pattern = pattern;
+    cfg->size_mix = SIZE_MIX_FIXED;
 
     switch (pattern) {
     case PATTERN_BURST:
@@ -411,11 +1011,12 @@ static void apply_pattern_preset(BenchConfig* cfg, WorkloadPattern pattern) {
         break;
 
     case PATTERN_HOTSPOT:
-        /* Mixed size-class hotspots (future: multi-size support) */
+        /* Mixed size-class hotspots: skewed sizes, small classes hottest */
         cfg->req_rate = 4000;
         cfg->objs_min = 120;
         cfg->objs_max = 120;
-        cfg->size = 128;  /* MVP: single size */
+        cfg->size = 128;
+        cfg->size_mix = SIZE_MIX_SKEWED;
         cfg->free_policy = FREE_POLICY_WITHIN_REQ;
         cfg->epoch_policy = EPOCH_POLICY_PER_REQ;
         break;
@@ -429,9 +1030,63 @@ static void apply_pattern_preset(BenchConfig* cfg, WorkloadPattern pattern) {
         cfg->free_policy = FREE_POLICY_WITHIN_REQ;
         cfg->epoch_policy = EPOCH_POLICY_PER_REQ;
         break;
+
+    case PATTERN_HANDOFF_SPSC:
+    case PATTERN_HANDOFF_MPMC:
+        /* Allocate on I/O threads, free on worker threads; epochs batch
+         * requests so one close covers many in-flight handoffs */
+        cfg->req_rate = 5000;
+        cfg->objs_min = 16;
+        cfg->objs_max = 64;
+        cfg->size = 256;
+        cfg->free_policy = FREE_POLICY_WITHIN_REQ;
+        cfg->epoch_policy = EPOCH_POLICY_BATCH;
+        cfg->batch_size = 64;
+        cfg->queue_depth = 4096;
+        break;
+
+    case PATTERN_INFLIGHT:
+        /* Long-lived overlapping requests: many epochs open at once */
+        cfg->req_rate = 2000;
+        cfg->objs_min = 40;
+        cfg->objs_max = 120;
+        cfg->size = 128;
+        cfg->inflight = 32;
+        cfg->free_policy = FREE_POLICY_WITHIN_REQ;
+        cfg->epoch_policy = EPOCH_POLICY_PER_REQ;
+        break;
+
+    case PATTERN_SIZEMIX:
+        /* Skewed size mix with short lifetimes: class spread, not lifetime */
+        cfg->req_rate = 4000;
+        cfg->objs_min = 50;
+        cfg->objs_max = 150;
+        cfg->size = 128;
+        cfg->size_mix = SIZE_MIX_SKEWED;
+        cfg->free_policy = FREE_POLICY_LAG;
+        cfg->lag_window = 4;
+        cfg->epoch_policy = EPOCH_POLICY_BATCH;
+        cfg->batch_size = 32;
+        break;
     }
 }
 
+static const char* pattern_name(WorkloadPattern pattern) {
+    switch (pattern) {
+    case PATTERN_BURST:        return "burst";
+    case PATTERN_STEADY:       return "steady";
+    case PATTERN_LEAK:         return "leak";
+    case PATTERN_HOTSPOT:      return "hotspot";
+    case PATTERN_KERNEL:       return "kernel";
+    case PATTERN_HANDOFF_SPSC: return "handoff_spsc";
+    case PATTERN_HANDOFF_MPMC: return "handoff_mpmc";
+    case PATTERN_INFLIGHT:     return "inflight";
+    case PATTERN_SIZEMIX:      return "sizemix";
+    }
+    return "unknown";
+}
+
+
 /* ============================================================================
  * Command-Line Parsing
  * ============================================================================ */
@@ -439,27 +1094,43 @@ static void apply_pattern_preset(BenchConfig* cfg, WorkloadPattern pattern) {
 static void print_usage(const char* prog) {
     printf("Usage: %s [OPTIONS]\n\n", prog);
     printf("Options:\n");
-    printf("  --allocator=<tslab|malloc>     Backend allocator (default: tslab)\n");
-    printf("  --pattern=<burst|steady|leak|hotspot|kernel>\n");
-    printf("                                 Workload pattern (default: burst)\n");
+    printf("  --allocator=<tslab|malloc|jemalloc|mimalloc|tcmalloc>\n");
+    printf("                                 Backend allocator (default: tslab)\n");
+    printf("  --allocator_lib=PATH           Library to dlopen for jemalloc/mimalloc/tcmalloc\n");
+    printf("  --pattern=<burst|steady|leak|hotspot|kernel|handoff_spsc|handoff_mpmc|\n");
+    printf("             inflight|sizemix>   Workload pattern (default: burst)\n");
     printf("  --duration_s=N                 Run duration in seconds (default: 60)\n");
-    printf("  --threads=N                    Number of worker threads (default: 1)\n");
-    printf("  --req_rate=N                   Requests/sec per thread (default: 2000)\n");
+    printf("  --threads=N                    Number of threads (default: 1)\n");
+    printf("  --producers=N                  handoff_mpmc producer threads (default: threads/2)\n");
+    printf("  --queue_depth=N                handoff queue capacity (default: 4096)\n");
+    printf("  --inflight=N                   inflight: open requests per thread (default: 32)\n");
+    printf("  --req_rate=N                   Requests/sec per thread, 0=unpaced (default: 2000)\n");
     printf("  --objs_min=N                   Min objects per request (default: 80)\n");
     printf("  --objs_max=N                   Max objects per request (default: 200)\n");
     printf("  --size=N                       Object size in bytes (default: 128)\n");
+    printf("  --size_mix=<fixed|skewed>      Size distribution (default: per pattern)\n");
     printf("  --epoch_policy=<per_req|batch:N|manual>\n");
     printf("                                 Epoch management policy (default: per_req)\n");
     printf("  --free_policy=<within_req|lag:N|leak:pct>\n");
     printf("                                 Free timing policy (default: within_req)\n");
-    printf("  --rss_sample_ms=N              RSS sampling interval (0=disabled)\n");
+    printf("  --epochs=N                     tslab epoch ring size (default: 2 x open requests)\n");
+    printf("  --remote_free                  tslab: enable remote-free queues\n");
+    printf("  --hugepage_slabs               tslab: back slab arenas with huge pages\n");
+    printf("  --rss_sample_ms=N              RSS sampling interval (0=once per second)\n");
+    printf("  --json=PATH                    Write HW counters as tslab-bench-v1 JSON\n");
+    printf("  --trace_out=PATH               tslab: capture an allocation trace (tslab_replay)\n");
     printf("  --help                         Show this help\n\n");
     printf("Pattern presets:\n");
-    printf("  burst:   RSS sawtooth, madvise spikes\n");
-    printf("  steady:  RSS plateau, stable cache reuse\n");
-    printf("  leak:    Epoch age/refcount anomalies\n");
-    printf("  hotspot: Per-class hotspots\n");
-    printf("  kernel:  Strong madvise→RSS correlation\n");
+    printf("  burst:        RSS sawtooth, madvise spikes\n");
+    printf("  steady:       RSS plateau, stable cache reuse\n");
+    printf("  leak:         Epoch age/refcount anomalies\n");
+    printf("  hotspot:      Per-class hotspots (skewed sizes)\n");
+    printf("  kernel:       Strong madvise→RSS correlation\n");
+    printf("  handoff_spsc: threads/2 producer->consumer pairs, one ring each\n");
+    printf("  handoff_mpmc: producers and consumers share one queue\n");
+    printf("  inflight:     --inflight requests (epochs) open per thread\n");
+    printf("  sizemix:      Skewed sizes with lagged frees\n");
+    printf("\nExit status 77: requested allocator library not available.\n");
 }
 
 static bool parse_args(int argc, char** argv, BenchConfig* cfg) {
@@ -469,23 +1140,40 @@ static bool parse_args(int argc, char** argv, BenchConfig* cfg) {
     cfg->pattern = PATTERN_BURST;
     cfg->duration_s = 60;
     cfg->threads = 1;
+    cfg->queue_depth = 4096;
+    cfg->inflight = 32;
     cfg->rss_sample_ms = 0;
 
     /* Apply default pattern preset */
     apply_pattern_preset(cfg, PATTERN_BURST);
 
+    /* Explicit options override the preset whatever their position */
+    int size_mix = -1;
+    int inflight = -1;
+    int queue_depth = -1;
+
     static struct option long_opts[] = {
         {"allocator", required_argument, 0, 'a'},
+        {"allocator_lib", required_argument, 0, 'L'},
         {"pattern", required_argument, 0, 'p'},
         {"duration_s", required_argument, 0, 'd'},
         {"threads", required_argument, 0, 't'},
+        {"producers", required_argument, 0, 'P'},
+        {"queue_depth", required_argument, 0, 'q'},
+        {"inflight", required_argument, 0, 'i'},
         {"req_rate", required_argument, 0, 'r'},
         {"objs_min", required_argument, 0, 'm'},
         {"objs_max", required_argument, 0, 'M'},
         {"size", required_argument, 0, 's'},
+        {"size_mix", required_argument, 0, 'z'},
         {"epoch_policy", required_argument, 0, 'e'},
         {"free_policy", required_argument, 0, 'f'},
+        {"epochs", required_argument, 0, 'E'},
+        {"remote_free", no_argument, 0, 'F'},
+        {"hugepage_slabs", no_argument, 0, 'H'},
         {"rss_sample_ms", required_argument, 0, 'R'},
+        {"json", required_argument, 0, 'j'},
+        {"trace_out", required_argument, 0, 'T'},
         {"help", no_argument, 0, 'h'},
         {0, 0, 0, 0}
     };
@@ -498,11 +1186,20 @@ static bool parse_args(int argc, char** argv, BenchConfig* cfg) {
                 cfg->allocator = ALLOCATOR_TSLAB;
             } else if (strcmp(optarg, "malloc") == 0) {
                 cfg->allocator = ALLOCATOR_MALLOC;
+            } else if (strcmp(optarg, "jemalloc") == 0) {
+                cfg->allocator = ALLOCATOR_JEMALLOC;
+            } else if (strcmp(optarg, "mimalloc") == 0) {
+                cfg->allocator = ALLOCATOR_MIMALLOC;
+            } else if (strcmp(optarg, "tcmalloc") == 0) {
+                cfg->allocator = ALLOCATOR_TCMALLOC;
             } else {
                 fprintf(stderr, "Unknown allocator: %s\n", optarg);
                 return false;
             }
             break;
+        case 'L':
+            cfg->allocator_lib = optarg;
+            break;
         case 'p':
             if (strcmp(optarg, "burst") == 0) {
                 apply_pattern_preset(cfg, PATTERN_BURST);
@@ -514,6 +1211,14 @@ static bool parse_args(int argc, char** argv, BenchConfig* cfg) {
                 apply_pattern_preset(cfg, PATTERN_HOTSPOT);
             } else if (strcmp(optarg, "kernel") == 0) {
                 apply_pattern_preset(cfg, PATTERN_KERNEL);
+            } else if (strcmp(optarg, "handoff_spsc") == 0) {
+                apply_pattern_preset(cfg, PATTERN_HANDOFF_SPSC);
+            } else if (strcmp(optarg, "handoff_mpmc") == 0) {
+                apply_pattern_preset(cfg, PATTERN_HANDOFF_MPMC);
+            } else if (strcmp(optarg, "inflight") == 0) {
+                apply_pattern_preset(cfg, PATTERN_INFLIGHT);
+            } else if (strcmp(optarg, "sizemix") == 0) {
+                apply_pattern_preset(cfg, PATTERN_SIZEMIX);
             } else {
                 fprintf(stderr, "Unknown pattern: %s\n", optarg);
                 return false;
@@ -525,6 +1230,15 @@ static bool parse_args(int argc, char** argv, BenchConfig* cfg) {
         case 't':
             cfg->threads = atoi(optarg);
             break;
+        case 'P':
+            cfg->producers = atoi(optarg);
+            break;
+        case 'q':
+            queue_depth = atoi(optarg);
+            break;
+        case 'i':
+            inflight = atoi(optarg);
+            break;
         case 'r':
             cfg->req_rate = atoi(optarg);
             break;
@@ -537,6 +1251,16 @@ static bool parse_args(int argc, char** argv, BenchConfig* cfg) {
         case 's':
             cfg->size = atoi(optarg);
             break;
+        case 'z':
+            if (strcmp(optarg, "fixed") == 0) {
+                size_mix = SIZE_MIX_FIXED;
+            } else if (strcmp(optarg, "skewed") == 0) {
+                size_mix = SIZE_MIX_SKEWED;
+            } else {
+                fprintf(stderr, "Unknown size_mix: %s\n", optarg);
+                return false;
+            }
+            break;
         case 'e':
             if (strcmp(optarg, "per_req") == 0) {
                 cfg->epoch_policy = EPOCH_POLICY_PER_REQ;
@@ -564,9 +1288,24 @@ static bool parse_args(int argc, char** argv, BenchConfig* cfg) {
                 return false;
             }
             break;
+        case 'E':
+            cfg->epoch_count = atoi(optarg);
+            break;
+        case 'F':
+            cfg->remote_free = true;
+            break;
+        case 'H':
+            cfg->hugepage_slabs = true;
+            break;
         case 'R':
             cfg->rss_sample_ms = atoi(optarg);
             break;
+        case 'j':
+            cfg->json_path = optarg;
+            break;
+        case 'T':
+            cfg->trace_path = optarg;
+            break;
         case 'h':
             print_usage(argv[0]);
             exit(0);
@@ -575,9 +1314,266 @@ static bool parse_args(int argc, char** argv, BenchConfig* cfg) {
         }
     }
 
+    if (size_mix >= 0) cfg->size_mix = (SizeMix)size_mix;
+    if (inflight >= 0) cfg->inflight = (uint32_t)inflight;
+    if (queue_depth >= 0) cfg->queue_depth = (uint32_t)queue_depth;
+
+    if (cfg->threads == 0 || cfg->objs_min == 0 || cfg->objs_max < cfg->objs_min) {
+        fprintf(stderr, "Need --threads >= 1 and 1 <= objs_min <= objs_max\n");
+        return false;
+    }
+    if (cfg->pattern == PATTERN_INFLIGHT && cfg->inflight == 0) {
+        fprintf(stderr, "--inflight must be >= 1\n");
+        return false;
+    }
+    if (cfg->pattern == PATTERN_HANDOFF_MPMC && cfg->threads < 2) {
+        fprintf(stderr, "handoff_mpmc needs --threads >= 2\n");
+        return false;
+    }
+    if (cfg->pattern == PATTERN_HANDOFF_MPMC && cfg->producers >= cfg->threads) {
+        fprintf(stderr, "--producers must leave at least one consumer thread\n");
+        return false;
+    }
+    if (cfg->epoch_policy == EPOCH_POLICY_BATCH && cfg->batch_size == 0) {
+        cfg->batch_size = 1;
+    }
+
+    /* Every thread keeps one request (inflight: cfg->inflight requests) in
+     * its own epoch. Give the ring room for all of them, twice over so a slot
+     * is not reopened while another thread is still allocating into it,
+     * unless the user sized it explicitly. One thread keeps the default. */
+    if (cfg->epoch_count == 0 && cfg->epoch_policy != EPOCH_POLICY_MANUAL) {
+        uint32_t per_thread = cfg->pattern == PATTERN_INFLIGHT ? cfg->inflight : 1;
+        uint64_t want = 2ULL * per_thread * cfg->threads;
+        if (want > SLAB_MAX_EPOCHS) want = SLAB_MAX_EPOCHS;
+        cfg->epoch_count = round_up_pow2((uint32_t)want);
+        if (cfg->epoch_count < SLAB_DEFAULT_EPOCHS) cfg->epoch_count = SLAB_DEFAULT_EPOCHS;
+    }
+
     return true;
 }
 
+/* ============================================================================
+ * Run Setup
+ * ============================================================================ */
+
+/* Assign roles and per-thread resources. The layout string describes the
+ * thread split for the report. */
+static bool run_setup(BenchRun* run, char* layout, size_t layout_len) {
+    BenchConfig* cfg = run->config;
+    uint32_t n = cfg->threads;
+
+    run->workers = calloc(n, sizeof(WorkerState));
+    if (!run->workers) return false;
+    run->num_workers = n;
+
+    uint32_t producers = 0;
+    if (cfg->pattern == PATTERN_HANDOFF_SPSC) {
+        /* Pairs (2k, 2k+1); an odd last thread produces into nobody's ring,
+         * so run it as a plain worker instead */
+        producers = n / 2;
+        snprintf(layout, layout_len, "%u producer/consumer pairs%s",
+                 producers, (n % 2) ? " + 1 worker" : "");
+    } else if (cfg->pattern == PATTERN_HANDOFF_MPMC) {
+        producers = cfg->producers ? cfg->producers : (n / 2 ? n / 2 : 1);
+        snprintf(layout, layout_len, "%u producers, %u consumers, 1 queue",
+                 producers, n - producers);
+        run->mpmc = mpmc_create(cfg->queue_depth);
+        if (!run->mpmc) return false;
+    } else if (cfg->pattern == PATTERN_INFLIGHT) {
+        snprintf(layout, layout_len, "%u workers x %u open requests",
+                 n, cfg->inflight);
+    } else {
+        snprintf(layout, layout_len, "%u workers", n);
+    }
+    atomic_init(&run->producers_live, producers);
+    atomic_init(&run->stop, false);
+
+    uint32_t req_slots = cfg->pattern == PATTERN_INFLIGHT ? cfg->inflight : 1;
+
+    for (uint32_t i = 0; i < n; i++) {
+        WorkerState* ws = &run->workers[i];
+        ws->run = run;
+        ws->id = i;
+        ws->rng = 0x9E3779B97F4A7C15ULL * (i + 1);
+        ws->current_epoch = run->backend->current_epoch_fn(run->backend->ctx);
+
+        if (cfg->pattern == PATTERN_HANDOFF_SPSC && i < 2 * producers) {
+            ws->role = (i % 2 == 0) ? ROLE_PRODUCER : ROLE_CONSUMER;
+            if (ws->role == ROLE_PRODUCER) {
+                ws->spsc = spsc_create(cfg->queue_depth);
+                if (!ws->spsc) return false;
+            } else {
+                ws->spsc = run->workers[i - 1].spsc;
+            }
+        } else if (cfg->pattern == PATTERN_HANDOFF_MPMC) {
+            ws->role = i < producers ? ROLE_PRODUCER : ROLE_CONSUMER;
+        } else {
+            ws->role = ROLE_WORKER;
+        }
+
+        if (ws->role != ROLE_CONSUMER) {
+            ws->requests = calloc(req_slots, sizeof(Request));
+            if (!ws->requests) return false;
+            for (uint32_t k = 0; k < req_slots; k++) {
+                if (!request_init(&ws->requests[k], cfg->objs_max)) return false;
+            }
+        }
+        if (cfg->free_policy == FREE_POLICY_LAG && cfg->lag_window > 0) {
+            uint32_t buffer_capacity = cfg->lag_window * cfg->objs_max * 2;
+            ws->free_buffer = free_buffer_create(buffer_capacity);
+            if (!ws->free_buffer) return false;
+        }
+    }
+    return true;
+}
+
+static void run_teardown(BenchRun* run) {
+    BenchConfig* cfg = run->config;
+    uint32_t req_slots = cfg->pattern == PATTERN_INFLIGHT ? cfg->inflight : 1;
+
+    for (uint32_t i = 0; i < run->num_workers; i++) {
+        WorkerState* ws = &run->workers[i];
+        if (ws->requests) {
+            for (uint32_t k = 0; k < req_slots; k++) request_destroy(&ws->requests[k]);
+            free(ws->requests);
+        }
+        if (ws->role == ROLE_PRODUCER) spsc_destroy(ws->spsc);
+        free_buffer_destroy(ws->free_buffer);
+    }
+    free(run->workers);
+    mpmc_destroy(run->mpmc);
+}
+
+/* Sum the workers' counters. Read while they run, so each field is only
+ * approximately current - fine for progress lines and the dashboard. */
+static void run_totals(const BenchRun* run, WorkerState* t) {
+    memset(t, 0, sizeof(*t));
+    for (uint32_t i = 0; i < run->num_workers; i++) {
+        const WorkerState* ws = &run->workers[i];
+        t->requests_completed += ws->requests_completed;
+        t->objects_allocated += ws->objects_allocated;
+        t->objects_freed += ws->objects_freed;
+        t->objects_leaked += ws->objects_leaked;
+        t->epoch_retries += ws->epoch_retries;
+        t->queue_full_waits += ws->queue_full_waits;
+        t->checksum += ws->checksum;
+    }
+}
+
+/* ============================================================================
+ * Stats Export
+ * ============================================================================ */
+
+/* Dump allocator stats for the live dashboard (tslab only) */
+static void export_stats_json(Backend* backend, const WorkerState* t, uint64_t now) {
+    FILE* f = fopen("/tmp/synthetic_bench_stats.json", "w");
+    if (!f) return;
+
+    SlabAllocator* a = (SlabAllocator*)backend->ctx;
+    SlabGlobalStats gs;
+    slab_stats_global(a, &gs);
+
+    fprintf(f, "{\n");
+    fprintf(f, "  \"schema_version\": 1,\n");
+    fprintf(f, "  \"timestamp_ns\": %lu,\n", now);
+    fprintf(f, "  \"pid\": %d,\n", getpid());
+    fprintf(f, "  \"page_size\": 4096,\n");
+    fprintf(f, "  \"epoch_count\": %u,\n", gs.epoch_count);
+    fprintf(f, "  \"version\": %u,\n", gs.version);
+    fprintf(f, "  \"current_epoch\": %u,\n", gs.current_epoch);
+    fprintf(f, "  \"active_epoch_count\": %u,\n", gs.active_epoch_count);
+    fprintf(f, "  \"closing_epoch_count\": %u,\n", gs.closing_epoch_count);
+    fprintf(f, "  \"total_slabs_allocated\": %lu,\n", gs.total_slabs_allocated);
+    fprintf(f, "  \"total_slabs_recycled\": %lu,\n", gs.total_slabs_recycled);
+    fprintf(f, "  \"net_slabs\": %lu,\n", gs.net_slabs);
+    fprintf(f, "  \"rss_bytes_current\": %lu,\n", gs.rss_bytes_current);
+    fprintf(f, "  \"estimated_slab_rss_bytes\": %lu,\n", gs.estimated_slab_rss_bytes);
+    fprintf(f, "  \"total_slow_path_hits\": %lu,\n", gs.total_slow_path_hits);
+    fprintf(f, "  \"total_cache_overflows\": %lu,\n", gs.total_cache_overflows);
+    fprintf(f, "  \"total_slow_cache_miss\": %lu,\n", gs.total_slow_cache_miss);
+    fprintf(f, "  \"total_slow_epoch_closed\": %lu,\n", gs.total_slow_epoch_closed);
+    fprintf(f, "  \"total_madvise_calls\": %lu,\n", gs.total_madvise_calls);
+    fprintf(f, "  \"total_madvise_bytes\": %lu,\n", gs.total_madvise_bytes);
+    fprintf(f, "  \"total_madvise_failures\": %lu,\n", gs.total_madvise_failures);
+
+    fprintf(f, "  \"benchmark_requests_completed\": %lu,\n", t->requests_completed);
+    fprintf(f, "  \"benchmark_objects_allocated\": %lu,\n", t->objects_allocated);
+    fprintf(f, "  \"benchmark_objects_freed\": %lu,\n", t->objects_freed);
+    fprintf(f, "  \"benchmark_objects_leaked\": %lu,\n", t->objects_leaked);
+
+    /* Per-class stats */
+    fprintf(f, "  \"classes\": [\n");
+    for (uint32_t cls = 0; cls < SLAB_NUM_CLASSES; cls++) {
+        SlabClassStats cs;
+        slab_stats_class(a, cls, &cs);
+        fprintf(f, "    {\n");
+        fprintf(f, "      \"class_index\": %u,\n", cs.class_index);
+        fprintf(f, "      \"object_size\": %u,\n", cs.object_size);
+        fprintf(f, "      \"slow_path_hits\": %lu,\n", cs.slow_path_hits);
+        fprintf(f, "      \"new_slab_count\": %lu,\n", cs.new_slab_count);
+        fprintf(f, "      \"list_move_partial_to_full\": %lu,\n", cs.list_move_partial_to_full);
+        fprintf(f, "      \"list_move_full_to_partial\": %lu,\n", cs.list_move_full_to_partial);
+        fprintf(f, "      \"current_partial_null\": %lu,\n", cs.current_partial_null);
+        fprintf(f, "      \"current_partial_full\": %lu,\n", cs.current_partial_full);
+        fprintf(f, "      \"empty_slab_recycled\": %lu,\n", cs.empty_slab_recycled);
+        fprintf(f, "      \"empty_slab_overflowed\": %lu,\n", cs.empty_slab_overflowed);
+        fprintf(f, "      \"slow_path_cache_miss\": %lu,\n", cs.slow_path_cache_miss);
+        fprintf(f, "      \"slow_path_epoch_closed\": %lu,\n", cs.slow_path_epoch_closed);
+        fprintf(f, "      \"madvise_calls\": %lu,\n", cs.madvise_calls);
+        fprintf(f, "      \"madvise_bytes\": %lu,\n", cs.madvise_bytes);
+        fprintf(f, "      \"madvise_failures\": %lu,\n", cs.madvise_failures);
+        fprintf(f, "      \"epoch_close_calls\": %lu,\n", cs.epoch_close_calls);
+        fprintf(f, "      \"epoch_close_scanned_slabs\": %lu,\n", cs.epoch_close_scanned_slabs);
+        fprintf(f, "      \"epoch_close_recycled_slabs\": %lu,\n", cs.epoch_close_recycled_slabs);
+        fprintf(f, "      \"epoch_close_total_ns\": %lu,\n", cs.epoch_close_total_ns);
+        fprintf(f, "      \"cache_size\": %u,\n", cs.cache_size);
+        fprintf(f, "      \"cache_capacity\": %u,\n", cs.cache_capacity);
+        fprintf(f, "      \"cache_overflow_len\": %u,\n", cs.cache_overflow_len);
+        fprintf(f, "      \"total_partial_slabs\": %u,\n", cs.total_partial_slabs);
+        fprintf(f, "      \"total_full_slabs\": %u,\n", cs.total_full_slabs);
+        fprintf(f, "      \"recycle_rate_pct\": %.2f,\n", cs.recycle_rate_pct);
+        fprintf(f, "      \"net_slabs\": %lu,\n", cs.net_slabs);
+        fprintf(f, "      \"estimated_rss_bytes\": %lu\n", cs.estimated_rss_bytes);
+        fprintf(f, "    }%s\n", (cls < SLAB_NUM_CLASSES - 1) ? "," : "");
+    }
+    fprintf(f, "  ],\n");
+
+    /* Per-epoch stats */
+    fprintf(f, "  \"epochs\": [\n");
+    int first_epoch = 1;
+    for (uint32_t cls = 0; cls < SLAB_NUM_CLASSES; cls++) {
+        for (uint32_t ep = 0; ep < gs.epoch_count; ep++) {
+            SlabEpochStats es;
+            slab_stats_epoch(a, cls, ep, &es);
+
+            if (!first_epoch) fprintf(f, ",\n");
+            first_epoch = 0;
+
+            fprintf(f, "    {\n");
+            fprintf(f, "      \"class_index\": %u,\n", es.class_index);
+            fprintf(f, "      \"object_size\": %u,\n", es.object_size);
+            fprintf(f, "      \"epoch_id\": %u,\n", es.epoch_id);
+            fprintf(f, "      \"epoch_era\": %lu,\n", es.epoch_era);
+            fprintf(f, "      \"state\": \"%s\",\n", es.state == 0 ? "ACTIVE" : "CLOSING");
+            fprintf(f, "      \"open_since_ns\": %lu,\n", es.open_since_ns);
+            fprintf(f, "      \"alloc_count\": %lu,\n", es.alloc_count);
+            fprintf(f, "      \"label\": \"%s\",\n", es.label);
+            fprintf(f, "      \"rss_before_close\": %lu,\n", es.rss_before_close);
+            fprintf(f, "      \"rss_after_close\": %lu,\n", es.rss_after_close);
+            fprintf(f, "      \"partial_slab_count\": %u,\n", es.partial_slab_count);
+            fprintf(f, "      \"full_slab_count\": %u,\n", es.full_slab_count);
+            fprintf(f, "      \"estimated_rss_bytes\": %lu,\n", es.estimated_rss_bytes);
+            fprintf(f, "      \"reclaimable_slab_count\": %u,\n", es.reclaimable_slab_count);
+            fprintf(f, "      \"reclaimable_bytes\": %lu\n", es.reclaimable_bytes);
+            fprintf(f, "    }");
+        }
+    }
+    fprintf(f, "\n  ]\n");
+    fprintf(f, "}\n");
+    fclose(f);
+}
+
 /* ============================================================================
  * Main
  * ============================================================================ */
@@ -588,217 +1584,193 @@ int main(int argc, char** argv) {
         print_usage(argv[0]);
         return 1;
     }
-
-    /* Print configuration */
-    printf("Synthetic Benchmark Configuration\n");
-    printf("=================================\n");
-    printf("Allocator:      %s\n", cfg.allocator == ALLOCATOR_TSLAB ? "tslab" : "malloc");
-    printf("Pattern:        ");
-    switch (cfg.pattern) {
-    case PATTERN_BURST:   printf("burst\n"); break;
-    case PATTERN_STEADY:  printf("steady\n"); break;
-    case PATTERN_LEAK:    printf("leak\n"); break;
-    case PATTERN_HOTSPOT: printf("hotspot\n"); break;
-    case PATTERN_KERNEL:  printf("kernel\n"); break;
-    }
-    printf("Duration:       %u seconds\n", cfg.duration_s);
-    printf("Threads:        %u\n", cfg.threads);
-    printf("Req rate:       %u req/s per thread\n", cfg.req_rate);
-    printf("Objects/req:    %u-%u\n", cfg.objs_min, cfg.objs_max);
-    printf("Object size:    %zu bytes\n", cfg.size);
-    printf("\n");
+    size_mix_init();
 
     /* Create backend */
     Backend* backend = backend_create(&cfg);
     if (!backend) {
+        if (cfg.allocator != ALLOCATOR_TSLAB && cfg.allocator != ALLOCATOR_MALLOC) {
+            return EXIT_BACKEND_UNAVAILABLE;
+        }
         fprintf(stderr, "Failed to create backend\n");
         return 1;
     }
 
-    /* Create worker state (single-threaded MVP) */
-    WorkerState ws = {
+    BenchRun run = {
         .backend = backend,
         .config = &cfg,
-        .free_buffer = NULL,
-        .requests_completed = 0,
-        .objects_allocated = 0,
-        .objects_freed = 0,
-        .objects_leaked = 0,
-        .current_epoch = backend->current_epoch_fn(backend->ctx),
-        .reqs_in_current_epoch = 0,
-        .stop = false,
     };
+    char layout[96];
+    if (!run_setup(&run, layout, sizeof(layout))) {
+        fprintf(stderr, "Failed to set up worker state\n");
+        run_teardown(&run);
+        backend_destroy(backend);
+        return 1;
+    }
 
-    if (cfg.free_policy == FREE_POLICY_LAG) {
-        uint32_t buffer_capacity = cfg.lag_window * cfg.objs_max * 2;
-        ws.free_buffer = free_buffer_create(buffer_capacity);
-        if (!ws.free_buffer) {
-            fprintf(stderr, "Failed to create free buffer\n");
-            backend_destroy(backend);
-            return 1;
-        }
+    /* Print configuration */
+    printf("Synthetic Benchmark Configuration\n");
+    printf("=================================\n");
+    printf("Allocator:      %s%s%s\n", backend->name,
+           cfg.allocator_lib ? " from " : "", cfg.allocator_lib ? cfg.allocator_lib : "");
+    printf("Pattern:        %s\n", pattern_name(cfg.pattern));
+    printf("Duration:       %u seconds\n", cfg.duration_s);
+    printf("Threads:        %u (%s)\n", cfg.threads, layout);
+    if (cfg.req_rate) {
+        printf("Req rate:       %u req/s per thread\n", cfg.req_rate);
+    } else {
+        printf("Req rate:       unpaced\n");
+    }
+    printf("Objects/req:    %u-%u\n", cfg.objs_min, cfg.objs_max);
+    if (cfg.size_mix == SIZE_MIX_SKEWED) {
+        printf("Object size:    skewed %u-%u bytes\n",
+               k_skewed_sizes[0], k_skewed_sizes[SKEWED_SIZE_COUNT - 1]);
+    } else {
+        printf("Object size:    %zu bytes\n", cfg.size);
+    }
+    if (cfg.allocator == ALLOCATOR_TSLAB) {
+        SlabGlobalStats gs;
+        slab_stats_global((SlabAllocator*)backend->ctx, &gs);
+        printf("Epoch ring:     %u slots%s%s\n", gs.epoch_count,
+               cfg.remote_free ? ", remote free" : "",
+               gs.hugepage_bytes ? ", huge-page arenas" : "");
     }
+    printf("\n");
 
     /* Start benchmark */
     printf("Starting benchmark...\n");
     uint64_t start_time = get_time_ns();
     uint64_t end_time = start_time + (cfg.duration_s * 1000000000ULL);
 
-    pthread_t thread;
-    pthread_create(&thread, NULL, worker_thread, &ws);
+    pthread_t* threads = calloc(cfg.threads, sizeof(pthread_t));
+    if (!threads) {
+        fprintf(stderr, "Failed to allocate thread table\n");
+        run_teardown(&run);
+        backend_destroy(backend);
+        return 1;
+    }
+    uint32_t started = 0;
+    for (; started < cfg.threads; started++) {
+        if (pthread_create(&threads[started], NULL, worker_thread, &run.workers[started]) != 0) {
+            fprintf(stderr, "pthread_create failed for thread %u\n", started);
+            break;
+        }
+    }
+    if (started < cfg.threads) {
+        /* Producers that never started cannot signal their exit */
+        for (uint32_t i = started; i < cfg.threads; i++) {
+            if (run.workers[i].role == ROLE_PRODUCER) {
+                atomic_fetch_sub(&run.producers_live, 1);
+            }
+        }
+        atomic_store(&run.stop, true);
+        end_time = 0;
+    }
 
-    /* Main thread: monitor, export stats, and stop after duration */
+    /* Main thread: monitor, sample RSS, export stats, and stop after duration */
+    uint64_t sample_ns = (cfg.rss_sample_ms ? cfg.rss_sample_ms : 1000) * 1000000ULL;
     uint64_t last_progress = start_time;
     uint64_t last_stats_export = start_time;
-    
+    uint64_t rss_peak = read_rss_bytes_linux();
+    WorkerState totals;
+
     while (get_time_ns() < end_time) {
-        sleep(1);
-        
+        struct timespec ts = {
+            .tv_sec = (time_t)(sample_ns / 1000000000ULL),
+            .tv_nsec = (long)(sample_ns % 1000000000ULL)
+        };
+        nanosleep(&ts, NULL);
+
         uint64_t now = get_time_ns();
-        
+        uint64_t rss = read_rss_bytes_linux();
+        if (rss > rss_peak) rss_peak = rss;
+
         /* Export stats every 5 seconds (for live dashboard) */
         if (cfg.allocator == ALLOCATOR_TSLAB && (now - last_stats_export) >= 5000000000ULL) {
-            FILE* f = fopen("/tmp/synthetic_bench_stats.json", "w");
-            if (f) {
-                SlabAllocator* a = (SlabAllocator*)backend->ctx;
-                SlabGlobalStats gs;
-                slab_stats_global(a, &gs);
-                
-                fprintf(f, "{\n");
-                fprintf(f, "  \"schema_version\": 1,\n");
-                fprintf(f, "  \"timestamp_ns\": %lu,\n", now);
-                fprintf(f, "  \"pid\": %d,\n", getpid());
-                fprintf(f, "  \"page_size\": 4096,\n");
-                fprintf(f, "  \"epoch_count\": 16,\n");
-                fprintf(f, "  \"version\": %u,\n", gs.version);
-                fprintf(f, "  \"current_epoch\": %u,\n", gs.current_epoch);
-                fprintf(f, "  \"active_epoch_count\": %u,\n", gs.active_epoch_count);
-                fprintf(f, "  \"closing_epoch_count\": %u,\n", gs.closing_epoch_count);
-                fprintf(f, "  \"total_slabs_allocated\": %lu,\n", gs.total_slabs_allocated);
-                fprintf(f, "  \"total_slabs_recycled\": %lu,\n", gs.total_slabs_recycled);
-                fprintf(f, "  \"net_slabs\": %lu,\n", gs.net_slabs);
-                fprintf(f, "  \"rss_bytes_current\": %lu,\n", gs.rss_bytes_current);
-                fprintf(f, "  \"estimated_slab_rss_bytes\": %lu,\n", gs.estimated_slab_rss_bytes);
-                fprintf(f, "  \"total_slow_path_hits\": %lu,\n", gs.total_slow_path_hits);
-                fprintf(f, "  \"total_cache_overflows\": %lu,\n", gs.total_cache_overflows);
-                fprintf(f, "  \"total_slow_cache_miss\": %lu,\n", gs.total_slow_cache_miss);
-                fprintf(f, "  \"total_slow_epoch_closed\": %lu,\n", gs.total_slow_epoch_closed);
-                fprintf(f, "  \"total_madvise_calls\": %lu,\n", gs.total_madvise_calls);
-                fprintf(f, "  \"total_madvise_bytes\": %lu,\n", gs.total_madvise_bytes);
-                fprintf(f, "  \"total_madvise_failures\": %lu,\n", gs.total_madvise_failures);
-                
-                fprintf(f, "  \"benchmark_requests_completed\": %lu,\n", ws.requests_completed);
-                fprintf(f, "  \"benchmark_objects_allocated\": %lu,\n", ws.objects_allocated);
-                fprintf(f, "  \"benchmark_objects_freed\": %lu,\n", ws.objects_freed);
-                fprintf(f, "  \"benchmark_objects_leaked\": %lu,\n", ws.objects_leaked);
-                
-                /* Per-class stats */
-                fprintf(f, "  \"classes\": [\n");
-                for (uint32_t cls = 0; cls < 8; cls++) {
-                    SlabClassStats cs;
-                    slab_stats_class(a, cls, &cs);
-                    fprintf(f, "    {\n");
-                    fprintf(f, "      \"class_index\": %u,\n", cs.class_index);
-                    fprintf(f, "      \"object_size\": %u,\n", cs.object_size);
-                    fprintf(f, "      \"slow_path_hits\": %lu,\n", cs.slow_path_hits);
-                    fprintf(f, "      \"new_slab_count\": %lu,\n", cs.new_slab_count);
-                    fprintf(f, "      \"list_move_partial_to_full\": %lu,\n", cs.list_move_partial_to_full);
-                    fprintf(f, "      \"list_move_full_to_partial\": %lu,\n", cs.list_move_full_to_partial);
-                    fprintf(f, "      \"current_partial_null\": %lu,\n", cs.current_partial_null);
-                    fprintf(f, "      \"current_partial_full\": %lu,\n", cs.current_partial_full);
-                    fprintf(f, "      \"empty_slab_recycled\": %lu,\n", cs.empty_slab_recycled);
-                    fprintf(f, "      \"empty_slab_overflowed\": %lu,\n", cs.empty_slab_overflowed);
-                    fprintf(f, "      \"slow_path_cache_miss\": %lu,\n", cs.slow_path_cache_miss);
-                    fprintf(f, "      \"slow_path_epoch_closed\": %lu,\n", cs.slow_path_epoch_closed);
-                    fprintf(f, "      \"madvise_calls\": %lu,\n", cs.madvise_calls);
-                    fprintf(f, "      \"madvise_bytes\": %lu,\n", cs.madvise_bytes);
-                    fprintf(f, "      \"madvise_failures\": %lu,\n", cs.madvise_failures);
-                    fprintf(f, "      \"epoch_close_calls\": %lu,\n", cs.epoch_close_calls);
-                    fprintf(f, "      \"epoch_close_scanned_slabs\": %lu,\n", cs.epoch_close_scanned_slabs);
-                    fprintf(f, "      \"epoch_close_recycled_slabs\": %lu,\n", cs.epoch_close_recycled_slabs);
-                    fprintf(f, "      \"epoch_close_total_ns\": %lu,\n", cs.epoch_close_total_ns);
-                    fprintf(f, "      \"cache_size\": %u,\n", cs.cache_size);
-                    fprintf(f, "      \"cache_capacity\": %u,\n", cs.cache_capacity);
-                    fprintf(f, "      \"cache_overflow_len\": %u,\n", cs.cache_overflow_len);
-                    fprintf(f, "      \"total_partial_slabs\": %u,\n", cs.total_partial_slabs);
-                    fprintf(f, "      \"total_full_slabs\": %u,\n", cs.total_full_slabs);
-                    fprintf(f, "      \"recycle_rate_pct\": %.2f,\n", cs.recycle_rate_pct);
-                    fprintf(f, "      \"net_slabs\": %lu,\n", cs.net_slabs);
-                    fprintf(f, "      \"estimated_rss_bytes\": %lu\n", cs.estimated_rss_bytes);
-                    fprintf(f, "    }%s\n", (cls < 7) ? "," : "");
-                }
-                fprintf(f, "  ],\n");
-                
-                /* Per-epoch stats */
-                fprintf(f, "  \"epochs\": [\n");
-                int first_epoch = 1;
-                for (uint32_t cls = 0; cls < 8; cls++) {
-                    for (uint32_t ep = 0; ep < 16; ep++) {
-                        SlabEpochStats es;
-                        slab_stats_epoch(a, cls, ep, &es);
-                        
-                        if (!first_epoch) fprintf(f, ",\n");
-                        first_epoch = 0;
-                        
-                        fprintf(f, "    {\n");
-                        fprintf(f, "      \"class_index\": %u,\n", es.class_index);
-                        fprintf(f, "      \"object_size\": %u,\n", es.object_size);
-                        fprintf(f, "      \"epoch_id\": %u,\n", es.epoch_id);
-                        fprintf(f, "      \"epoch_era\": %lu,\n", es.epoch_era);
-                        fprintf(f, "      \"state\": \"%s\",\n", es.state == 0 ? "ACTIVE" : "CLOSING");
-                        fprintf(f, "      \"open_since_ns\": %lu,\n", es.open_since_ns);
-                        fprintf(f, "      \"alloc_count\": %lu,\n", es.alloc_count);
-                        fprintf(f, "      \"label\": \"%s\",\n", es.label);
-                        fprintf(f, "      \"rss_before_close\": %lu,\n", es.rss_before_close);
-                        fprintf(f, "      \"rss_after_close\": %lu,\n", es.rss_after_close);
-                        fprintf(f, "      \"partial_slab_count\": %u,\n", es.partial_slab_count);
-                        fprintf(f, "      \"full_slab_count\": %u,\n", es.full_slab_count);
-                        fprintf(f, "      \"estimated_rss_bytes\": %lu,\n", es.estimated_rss_bytes);
-                        fprintf(f, "      \"reclaimable_slab_count\": %u,\n", es.reclaimable_slab_count);
-                        fprintf(f, "      \"reclaimable_bytes\": %lu\n", es.reclaimable_bytes);
-                        fprintf(f, "    }");
-                    }
-                }
-                fprintf(f, "\n  ]\n");
-                fprintf(f, "}\n");
-                fclose(f);
-            }
+            run_totals(&run, &totals);
+            export_stats_json(backend, &totals, now);
             last_stats_export = now;
         }
-        
+
         /* Print progress every 10 seconds */
         if ((now - last_progress) >= 10000000000ULL) {
             double elapsed_s = (now - start_time) / 1e9;
-            fprintf(stderr, "[%.0fs] Requests: %lu, Allocs: %lu, Frees: %lu, Leaked: %lu\n",
-                    elapsed_s, ws.requests_completed, ws.objects_allocated,
-                    ws.objects_freed, ws.objects_leaked);
+            run_totals(&run, &totals);
+            fprintf(stderr, "[%.0fs] Requests: %lu, Allocs: %lu, Frees: %lu, Leaked: %lu, RSS: %.1f MiB\n",
+                    elapsed_s, totals.requests_completed, totals.objects_allocated,
+                    totals.objects_freed, totals.objects_leaked, rss / (1024.0 * 1024.0));
             last_progress = now;
         }
     }
 
-    ws.stop = true;
-    pthread_join(thread, NULL);
+    atomic_store(&run.stop, true);
+    for (uint32_t i = 0; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
 
     uint64_t elapsed_ns = get_time_ns() - start_time;
     double elapsed_s = elapsed_ns / 1e9;
+    uint64_t rss_final = read_rss_bytes_linux();
+    if (rss_final > rss_peak) rss_peak = rss_final;
+
+    run_totals(&run, &totals);
+    BenchPerf perf = {0};
+    for (uint32_t i = 0; i < started; i++) {
+        bench_perf_merge(&perf, &run.workers[i].perf);
+    }
+    uint64_t ops = totals.objects_allocated + totals.objects_freed;
 
     /* Print results */
     printf("\n");
     printf("Benchmark Results\n");
     printf("=================\n");
     printf("Elapsed time:        %.2f seconds\n", elapsed_s);
-    printf("Requests completed:  %lu\n", ws.requests_completed);
-    printf("Objects allocated:   %lu\n", ws.objects_allocated);
-    printf("Objects freed:       %lu\n", ws.objects_freed);
-    printf("Objects leaked:      %lu\n", ws.objects_leaked);
-    printf("Request rate:        %.2f req/s\n", ws.requests_completed / elapsed_s);
-    printf("Allocation rate:     %.2f obj/s\n", ws.objects_allocated / elapsed_s);
+    printf("Threads:             %u (%s)\n", started, layout);
+    printf("Requests completed:  %lu\n", totals.requests_completed);
+    printf("Objects allocated:   %lu\n", totals.objects_allocated);
+    printf("Objects freed:       %lu\n", totals.objects_freed);
+    printf("Objects leaked:      %lu\n", totals.objects_leaked);
+    printf("Request rate:        %.2f req/s\n", totals.requests_completed / elapsed_s);
+    printf("Allocation rate:     %.2f obj/s\n", totals.objects_allocated / elapsed_s);
+    if (backend->has_epochs) {
+        printf("Epoch retries:       %lu\n", totals.epoch_retries);
+    }
+    if (cfg.pattern == PATTERN_HANDOFF_SPSC || cfg.pattern == PATTERN_HANDOFF_MPMC) {
+        printf("Queue full waits:    %lu\n", totals.queue_full_waits);
+    }
+    printf("RSS peak / final:    %.1f / %.1f MiB\n",
+           rss_peak / (1024.0 * 1024.0), rss_final / (1024.0 * 1024.0));
+    if (cfg.trace_path && cfg.allocator == ALLOCATOR_TSLAB) {
+        SlabTraceStats ts;
+        slab_trace_stop((SlabAllocator*)backend->ctx);
+        slab_trace_stats((SlabAllocator*)backend->ctx, &ts);
+        printf("Trace:               %lu records, %lu dropped -> %s\n",
+               (unsigned long)ts.records, (unsigned long)ts.dropped, cfg.trace_path);
+    }
+    bench_perf_print(&perf, ops);
     printf("\n");
 
-    /* Cleanup */
-    if (ws.free_buffer) {
-        free_buffer_destroy(ws.free_buffer);
+    if (cfg.json_path) {
+        FILE* jf = fopen(cfg.json_path, "w");
+        if (!jf) {
+            fprintf(stderr, "Failed to open JSON file: %s\n", cfg.json_path);
+        } else {
+            BenchPhase ph = {
+                .bench = "synthetic_bench",
+                .phase = pattern_name(cfg.pattern),
+                .allocator = cfg.allocator == ALLOCATOR_TSLAB ? "temporal-slab" : backend->name,
+                .threads = started,
+                .ops = ops,
+                .wall_ns = elapsed_ns,
+            };
+            bench_json_phase(jf, &ph, &perf);
+            fclose(jf);
+        }
     }
+
+    /* Cleanup */
+    run_teardown(&run);
     backend_destroy(backend);
 
     return 0;
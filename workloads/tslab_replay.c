@@ -0,0 +1,704 @@
+/*
+ * tslab_replay.c - Re-drive a captured allocation trace (slab_trace.h)
+ *
+ * Reads a file written by slab_trace_start()/slab_trace_stop() and replays
+ * every allocation, free and epoch transition against a fresh allocator
+ * whose configuration may differ from the traced one: size classes, epoch
+ * ring size, remote frees, reclaim mode, huge-page arenas, and (by building
+ * with or without TLS_OBJ) the thread cache. Reports RSS over the replay and latency
+ * histograms per operation, so one real workload can be compared across
+ * configurations without sharing the workload itself.
+ *
+ * RSS is reported above the baseline measured after the trace is loaded
+ * (the loaded records are resident too), so it is the allocator's own.
+ *
+ * Replay model:
+ * - Records of all traced threads are merged by rebuilt timestamp and
+ *   replayed on one thread. Placement and latency per operation are
+ *   reproduced; cross-thread contention is not.
+ * - Trace handles map to the replay's own handles; epochs map by era, so
+ *   a smaller --epochs ring turns allocations into epochs the traced
+ *   allocator still had open into failures (counted, not fatal).
+ * - --speed=X paces the replay at X times the traced rate; 0 (default)
+ *   replays as fast as possible.
+ *
+ * Compile:
+ *   cd src && make tslab_replay
+ *   cd src && make tslab_replay CFLAGS="$(CFLAGS) -DENABLE_TLS_CACHE=1" TLS_OBJ=slab_tls_cache.o
+ *
+ * Usage:
+ *   ./tslab_replay --trace=app.trace
+ *   ./tslab_replay --trace=app.trace --size_classes=64,128,256,512 --epochs=8
+ *   ./tslab_replay --trace=app.trace --reclaim_mode=lazy --rss_csv=rss.csv
+ *   ./tslab_replay --trace=app.trace --hugepage_slabs
+ *   ./tslab_replay --trace=app.trace --speed=1 --json=replay.jsonl
+ *
+ * --json writes one tslab-bench-v1 phase per operation (alloc, free,
+ * epoch_close) with percentiles, and a "replay" phase with the HW counters
+ * of the whole run (see src/bench_perf.h).
+ */
+
+#define _GNU_SOURCE
+#include <slab_alloc.h>
+#include <slab_stats.h>
+#include <slab_trace.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <time.h>
+#include <getopt.h>
+#include <errno.h>
+
+#include "bench_perf.h"
+
+#if ENABLE_TLS_CACHE
+#define ALLOCATOR_NAME "temporal-slab+tls"
+#else
+#define ALLOCATOR_NAME "temporal-slab"
+#endif
+
+/* ============================================================================
+ * Configuration
+ * ============================================================================ */
+
+typedef struct {
+    const char* trace_path;
+    uint32_t size_classes[SLAB_MAX_CLASSES];
+    uint32_t num_classes;       /* 0 = the traced allocator's table */
+    uint32_t epochs;            /* 0 = the traced ring size */
+    bool remote_free;
+    bool hugepage_slabs;
+    int reclaim_mode;           /* -1 = SLAB_RECLAIM_IMMEDIATE */
+    double speed;               /* 0 = unpaced */
+    uint32_t rss_sample_ms;
+    const char* rss_csv;
+    const char* json_path;
+} ReplayConfig;
+
+static uint64_t now_mono_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/* ============================================================================
+ * Trace loading
+ * ============================================================================ */
+
+typedef struct {
+    SlabTraceHeader hdr;
+    SlabTraceRecord* rec;
+    uint64_t n;             /* Records loaded */
+    uint64_t* ts;           /* Rebuilt absolute timestamp per record */
+    uint64_t* order;        /* Record indices in replay order */
+} Trace;
+
+static int cmp_order(const void* x, const void* y, void* arg) {
+    const uint64_t* ts = (const uint64_t*)arg;
+    uint64_t a = *(const uint64_t*)x, b = *(const uint64_t*)y;
+    if (ts[a] != ts[b]) return ts[a] < ts[b] ? -1 : 1;
+    return (a > b) - (a < b);  /* Same stamp: file order (keeps each thread's order) */
+}
+
+static bool trace_load(const char* path, Trace* t) {
+    memset(t, 0, sizeof(*t));
+    FILE* f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "Cannot open trace %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    if (fread(&t->hdr, sizeof(t->hdr), 1, f) != 1 || t->hdr.magic != SLAB_TRACE_MAGIC) {
+        fprintf(stderr, "%s: not a temporal-slab trace\n", path);
+        fclose(f);
+        return false;
+    }
+    if (t->hdr.version != SLAB_TRACE_VERSION || t->hdr.record_size != sizeof(SlabTraceRecord) ||
+        t->hdr.num_classes == 0 || t->hdr.num_classes > SLAB_MAX_CLASSES) {
+        fprintf(stderr, "%s: unsupported trace version %u (record size %u)\n",
+                path, t->hdr.version, t->hdr.record_size);
+        fclose(f);
+        return false;
+    }
+
+    /* records is 0 if capture never stopped cleanly: take what is there */
+    fseek(f, 0, SEEK_END);
+    long end = ftell(f);
+    uint64_t avail = end > (long)sizeof(t->hdr) ? (uint64_t)(end - (long)sizeof(t->hdr)) / sizeof(SlabTraceRecord) : 0;
+    t->n = t->hdr.records && t->hdr.records <= avail ? t->hdr.records : avail;
+    if (!t->hdr.records) {
+        fprintf(stderr, "%s: capture was not stopped cleanly, replaying %lu records found\n",
+                path, (unsigned long)t->n);
+    }
+    fseek(f, (long)sizeof(t->hdr), SEEK_SET);
+
+    t->rec = (SlabTraceRecord*)malloc((t->n ? t->n : 1) * sizeof(SlabTraceRecord));
+    t->ts = (uint64_t*)malloc((t->n ? t->n : 1) * sizeof(uint64_t));
+    t->order = (uint64_t*)malloc((t->n ? t->n : 1) * sizeof(uint64_t));
+    uint64_t* clock = (uint64_t*)calloc(65536u, sizeof(uint64_t));
+    if (!t->rec || !t->ts || !t->order || !clock || fread(t->rec, sizeof(SlabTraceRecord), t->n, f) != t->n) {
+        fprintf(stderr, "%s: read failed\n", path);
+        fclose(f);
+        free(clock);
+        return false;
+    }
+    fclose(f);
+
+    /* Per-thread clocks: TIME records set them, deltas advance them */
+    uint64_t m = 0;
+    for (uint64_t i = 0; i < t->n; i++) {
+        const SlabTraceRecord* r = &t->rec[i];
+        if (r->op == SLAB_TRACE_TIME) {
+            clock[r->thread] = r->handle;
+            continue;
+        }
+        clock[r->thread] += r->delta_ns;
+        t->ts[i] = clock[r->thread];
+        t->order[m++] = i;
+    }
+    free(clock);
+    qsort_r(t->order, m, sizeof(uint64_t), cmp_order, t->ts);
+    t->n = m;  /* order[] covers the replayable records only */
+    return true;
+}
+
+/* ============================================================================
+ * Handle map (trace handle -> replay handle), open addressing
+ * ============================================================================ */
+
+typedef struct {
+    uint64_t key;           /* Trace handle, 0 = empty */
+    SlabHandle val;
+} HandleSlot;
+
+typedef struct {
+    HandleSlot* slots;
+    size_t cap;             /* Power of two */
+    size_t len;
+} HandleMap;
+
+static inline size_t hm_home(const HandleMap* m, uint64_t key) {
+    return (size_t)((key * 0x9E3779B97F4A7C15ull) >> 20) & (m->cap - 1u);
+}
+
+static bool hm_init(HandleMap* m, size_t cap) {
+    m->cap = cap;
+    m->len = 0;
+    m->slots = (HandleSlot*)calloc(cap, sizeof(HandleSlot));
+    return m->slots != NULL;
+}
+
+static bool hm_put(HandleMap* m, uint64_t key, SlabHandle val);
+
+static bool hm_grow(HandleMap* m) {
+    HandleMap bigger;
+    if (!hm_init(&bigger, m->cap * 2u)) return false;
+    for (size_t i = 0; i < m->cap; i++) {
+        if (m->slots[i].key) hm_put(&bigger, m->slots[i].key, m->slots[i].val);
+    }
+    free(m->slots);
+    *m = bigger;
+    return true;
+}
+
+/* Insert or overwrite (a traced handle recurs only after its free) */
+static bool hm_put(HandleMap* m, uint64_t key, SlabHandle val) {
+    if ((m->len + 1u) * 2u > m->cap && !hm_grow(m)) return false;
+    size_t i = hm_home(m, key);
+    while (m->slots[i].key && m->slots[i].key != key) i = (i + 1u) & (m->cap - 1u);
+    if (!m->slots[i].key) m->len++;
+    m->slots[i].key = key;
+    m->slots[i].val = val;
+    return true;
+}
+
+/* Remove key; returns its value, or 0 if absent */
+static SlabHandle hm_take(HandleMap* m, uint64_t key) {
+    size_t i = hm_home(m, key);
+    while (m->slots[i].key && m->slots[i].key != key) i = (i + 1u) & (m->cap - 1u);
+    if (!m->slots[i].key) return 0;
+    SlabHandle val = m->slots[i].val;
+
+    /* Backward-shift deletion keeps every probe chain contiguous */
+    size_t hole = i;
+    for (size_t j = (i + 1u) & (m->cap - 1u); m->slots[j].key; j = (j + 1u) & (m->cap - 1u)) {
+        size_t home = hm_home(m, m->slots[j].key);
+        if (((j - home) & (m->cap - 1u)) >= ((j - hole) & (m->cap - 1u))) {
+            m->slots[hole] = m->slots[j];
+            hole = j;
+        }
+    }
+    m->slots[hole].key = 0;
+    m->len--;
+    return val;
+}
+
+/* ============================================================================
+ * Epoch map (traced era -> replay EpochId)
+ * ============================================================================ */
+
+typedef struct {
+    uint32_t base_era;      /* Traced era of ids[0] */
+    EpochId* ids;
+    uint32_t len;
+    uint32_t cap;
+} EpochMap;
+
+static bool em_set(EpochMap* em, uint32_t era, EpochId id) {
+    uint32_t k = era - em->base_era;
+    if (k >= em->cap) {
+        uint32_t cap = em->cap ? em->cap : 64u;
+        while (cap <= k) cap *= 2u;
+        EpochId* ids = (EpochId*)realloc(em->ids, cap * sizeof(EpochId));
+        if (!ids) return false;
+        em->ids = ids;
+        em->cap = cap;
+    }
+    for (uint32_t i = em->len; i < k; i++) em->ids[i] = em->ids[em->len ? em->len - 1u : 0];
+    em->ids[k] = id;
+    if (k >= em->len) em->len = k + 1u;
+    return true;
+}
+
+/* Replay epoch for a traced era. Eras opened before the capture started
+ * (or never advanced to in it) fall back to the first replay epoch. */
+static EpochId em_get(const EpochMap* em, uint32_t era, bool* known) {
+    uint32_t k = era - em->base_era;
+    *known = k < em->len;
+    return *known ? em->ids[k] : em->ids[0];
+}
+
+/* ============================================================================
+ * RSS sampling
+ * ============================================================================ */
+
+typedef struct {
+    uint64_t wall_ms;       /* Since replay start */
+    uint64_t trace_ms;      /* Trace time of the last replayed record */
+    uint64_t rss;
+    uint64_t live;          /* Mapped live objects */
+} RssSample;
+
+typedef struct {
+    RssSample* s;
+    size_t len;
+    size_t cap;
+} RssCurve;
+
+static inline uint64_t rss_delta(uint64_t rss, uint64_t base) {
+    return rss > base ? rss - base : 0;
+}
+
+static void rss_sample(RssCurve* c, uint64_t wall_ms, uint64_t trace_ms, uint64_t live) {
+    if (c->len == c->cap) {
+        size_t cap = c->cap ? c->cap * 2u : 1024u;
+        RssSample* s = (RssSample*)realloc(c->s, cap * sizeof(RssSample));
+        if (!s) return;
+        c->s = s;
+        c->cap = cap;
+    }
+    c->s[c->len++] = (RssSample){ wall_ms, trace_ms, read_rss_bytes_linux(), live };
+}
+
+/* ============================================================================
+ * Command-Line Parsing
+ * ============================================================================ */
+
+static void print_usage(const char* prog) {
+    printf("Usage: %s --trace=PATH [OPTIONS]\n\n", prog);
+    printf("Options:\n");
+    printf("  --trace=PATH                   Trace written by slab_trace_start() (required)\n");
+    printf("  --size_classes=N,N,...         Replay size classes (default: the traced table)\n");
+    printf("  --epochs=N                     Epoch ring size (default: the traced ring)\n");
+    printf("  --remote_free                  Enable remote-free queues\n");
+    printf("  --hugepage_slabs               Back slab arenas with huge pages\n");
+    printf("  --reclaim_mode=<immediate|batched|lazy>\n");
+    printf("                                 Page return mode (default: immediate)\n");
+    printf("  --speed=X                      Pace at X times the traced rate, 0=unpaced (default: 0)\n");
+    printf("  --rss_sample_ms=N              RSS sampling interval of replay time (default: 10)\n");
+    printf("  --rss_csv=PATH                 Write the RSS curve as CSV\n");
+    printf("  --json=PATH                    Write latency phases as tslab-bench-v1 JSON\n");
+    printf("  --help                         Show this help\n\n");
+    printf("Thread cache: rebuild with TLS_OBJ=slab_tls_cache.o (see header comment).\n");
+}
+
+static bool parse_size_classes(const char* s, ReplayConfig* cfg) {
+    cfg->num_classes = 0;
+    while (*s) {
+        char* end;
+        unsigned long v = strtoul(s, &end, 10);
+        if (end == s || v == 0 || v > UINT32_MAX || cfg->num_classes == SLAB_MAX_CLASSES) return false;
+        cfg->size_classes[cfg->num_classes++] = (uint32_t)v;
+        s = end;
+        if (*s == ',') s++;
+        else if (*s) return false;
+    }
+    return cfg->num_classes > 0;
+}
+
+static bool parse_args(int argc, char** argv, ReplayConfig* cfg) {
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->reclaim_mode = -1;
+    cfg->rss_sample_ms = 10;
+
+    static struct option long_opts[] = {
+        {"trace", required_argument, 0, 't'},
+        {"size_classes", required_argument, 0, 'c'},
+        {"epochs", required_argument, 0, 'E'},
+        {"remote_free", no_argument, 0, 'F'},
+        {"hugepage_slabs", no_argument, 0, 'H'},
+        {"reclaim_mode", required_argument, 0, 'm'},
+        {"speed", required_argument, 0, 's'},
+        {"rss_sample_ms", required_argument, 0, 'R'},
+        {"rss_csv", required_argument, 0, 'C'},
+        {"json", required_argument, 0, 'j'},
+        {"help", no_argument, 0, 'h'},
+        {0, 0, 0, 0}
+    };
+
+    int opt;
+    while ((opt = getopt_long(argc, argv, "", long_opts, NULL)) != -1) {
+        switch (opt) {
+        case 't':
+            cfg->trace_path = optarg;
+            break;
+        case 'c':
+            if (!parse_size_classes(optarg, cfg)) {
+                fprintf(stderr, "Bad size class list: %s\n", optarg);
+                return false;
+            }
+            break;
+        case 'E':
+            cfg->epochs = (uint32_t)atoi(optarg);
+            break;
+        case 'F':
+            cfg->remote_free = true;
+            break;
+        case 'H':
+            cfg->hugepage_slabs = true;
+            break;
+        case 'm':
+            if (strcmp(optarg, "immediate") == 0) {
+                cfg->reclaim_mode = SLAB_RECLAIM_IMMEDIATE;
+            } else if (strcmp(optarg, "batched") == 0) {
+                cfg->reclaim_mode = SLAB_RECLAIM_BATCHED;
+            } else if (strcmp(optarg, "lazy") == 0) {
+                cfg->reclaim_mode = SLAB_RECLAIM_LAZY;
+            } else {
+                fprintf(stderr, "Unknown reclaim mode: %s\n", optarg);
+                return false;
+            }
+            break;
+        case 's':
+            cfg->speed = atof(optarg);
+            break;
+        case 'R':
+            cfg->rss_sample_ms = (uint32_t)atoi(optarg);
+            break;
+        case 'C':
+            cfg->rss_csv = optarg;
+            break;
+        case 'j':
+            cfg->json_path = optarg;
+            break;
+        case 'h':
+            print_usage(argv[0]);
+            exit(0);
+        default:
+            print_usage(argv[0]);
+            return false;
+        }
+    }
+    if (!cfg->trace_path) {
+        fprintf(stderr, "--trace is required\n");
+        print_usage(argv[0]);
+        return false;
+    }
+    if (cfg->rss_sample_ms == 0) cfg->rss_sample_ms = 10;
+    return true;
+}
+
+/* ============================================================================
+ * Replay
+ * ============================================================================ */
+
+enum { OP_ALLOC, OP_FREE, OP_CLOSE, OP_COUNT };
+static const char* const k_op_names[OP_COUNT] = { "alloc", "free", "epoch_close" };
+
+typedef struct {
+    SlabLatencyHist lat[OP_COUNT];
+    uint64_t alloc_failed;      /* Size too large for the table, closed or stale epoch */
+    uint64_t alloc_unmapped;    /* Allocation into an era opened before the capture */
+    uint64_t free_unmatched;    /* Free of a handle allocated before the capture */
+    uint64_t free_failed;       /* Replay handle rejected (epoch released meanwhile) */
+    uint64_t anonymous;         /* Batch allocations traced without handles */
+    uint64_t advances;
+    uint64_t releases;
+} ReplayTotals;
+
+static inline void lat_add(SlabLatencyHist* h, uint64_t ns) {
+    h->count++;
+    h->sum_ns += ns;
+    h->buckets[slab_lat_bucket(ns)]++;
+}
+
+/* Sleep or spin until the replay clock reaches `target` (monotonic ns) */
+static void pace_until(uint64_t target) {
+    uint64_t now = now_mono_ns();
+    if (now >= target) return;
+    if (target - now > 200000u) {
+        uint64_t ns = target - now - 100000u;
+        struct timespec ts = { (time_t)(ns / 1000000000u), (long)(ns % 1000000000u) };
+        nanosleep(&ts, NULL);
+    }
+    while (now_mono_ns() < target) { }
+}
+
+int main(int argc, char** argv) {
+    ReplayConfig cfg;
+    if (!parse_args(argc, argv, &cfg)) return 1;
+
+    Trace tr;
+    if (!trace_load(cfg.trace_path, &tr)) return 1;
+    const SlabTraceHeader* h = &tr.hdr;
+
+    SlabAllocatorConfig acfg = {
+        .size_classes = cfg.num_classes ? cfg.size_classes : h->class_sizes,
+        .num_classes = cfg.num_classes ? cfg.num_classes : h->num_classes,
+        .reclaim_mode = cfg.reclaim_mode >= 0 ? (SlabReclaimMode)cfg.reclaim_mode : SLAB_RECLAIM_IMMEDIATE,
+        .remote_free = cfg.remote_free,
+        .hugepage_slabs = cfg.hugepage_slabs,
+        .epoch_count = cfg.epochs ? cfg.epochs : h->epoch_count,
+    };
+    SlabAllocator* a = slab_allocator_create_with_config(&acfg);
+    if (!a) {
+        fprintf(stderr, "Allocator configuration rejected: %s\n", strerror(errno));
+        return 1;
+    }
+
+    HandleMap live;
+    EpochMap em = { .base_era = h->start_era };
+    if (!hm_init(&live, 1u << 16) || !em_set(&em, h->start_era, epoch_current(a))) {
+        fprintf(stderr, "Out of memory\n");
+        return 1;
+    }
+
+    printf("Trace:           %s\n", cfg.trace_path);
+    printf("Traced:          %lu records, %u threads, %.2f s, %u epochs, %u classes%s%s%s\n",
+           (unsigned long)h->records, h->threads,
+           h->stop_ns > h->start_ns ? (double)(h->stop_ns - h->start_ns) / 1e9 : 0.0,
+           h->epoch_count, h->num_classes,
+           (h->flags & SLAB_TRACE_F_TLS_CACHE) ? ", TLS cache" : "",
+           (h->flags & SLAB_TRACE_F_REMOTE_FREE) ? ", remote free" : "",
+           (h->flags & SLAB_TRACE_F_HEADER_FREE) ? ", header free" : "");
+    if (h->dropped) {
+        printf("                 %lu records dropped at capture (replay is approximate)\n",
+               (unsigned long)h->dropped);
+    }
+    printf("Replay:          %s, %u epochs, %u classes, reclaim %s%s, %s\n",
+           ALLOCATOR_NAME, slab_epoch_count(a), acfg.num_classes,
+           acfg.reclaim_mode == SLAB_RECLAIM_LAZY ? "lazy" :
+           acfg.reclaim_mode == SLAB_RECLAIM_BATCHED ? "batched" : "immediate",
+           cfg.remote_free ? ", remote free" : "",
+           cfg.speed > 0 ? "paced" : "unpaced");
+
+    ReplayTotals tot;
+    memset(&tot, 0, sizeof(tot));
+    RssCurve curve = {0};
+    const uint64_t sample_ns = (uint64_t)cfg.rss_sample_ms * 1000000ull;
+    const uint64_t trace_t0 = tr.n ? tr.ts[tr.order[0]] : 0;
+
+    BenchPerf perf;
+    bench_perf_open(&perf);
+    bench_perf_start(&perf);
+    const uint64_t wall_t0 = now_mono_ns();
+    uint64_t next_sample = wall_t0;
+    uint64_t trace_ms = 0;
+    rss_sample(&curve, 0, 0, 0);
+    const uint64_t rss_base = curve.s ? curve.s[0].rss : 0;
+
+    for (uint64_t k = 0; k < tr.n; k++) {
+        uint64_t i = tr.order[k];
+        const SlabTraceRecord* r = &tr.rec[i];
+        trace_ms = (tr.ts[i] - trace_t0) / 1000000u;
+        if (cfg.speed > 0) pace_until(wall_t0 + (uint64_t)((double)(tr.ts[i] - trace_t0) / cfg.speed));
+
+        switch (r->op) {
+        case SLAB_TRACE_ALLOC: {
+            bool known;
+            EpochId e = em_get(&em, r->epoch, &known);
+            if (!known) tot.alloc_unmapped++;
+            SlabHandle out = 0;
+            uint64_t t0 = now_mono_ns();
+            void* p = alloc_obj_epoch(a, r->size, e, &out);
+            lat_add(&tot.lat[OP_ALLOC], now_mono_ns() - t0);
+            if (!p) {
+                tot.alloc_failed++;
+            } else if (r->handle == 0) {
+                tot.anonymous++;  /* Never freed individually: goes with its epoch */
+            } else if (!hm_put(&live, r->handle, out)) {
+                fprintf(stderr, "Out of memory\n");
+                return 1;
+            }
+            break;
+        }
+        case SLAB_TRACE_FREE: {
+            SlabHandle out = hm_take(&live, r->handle);
+            if (!out) {
+                tot.free_unmatched++;
+                break;
+            }
+            uint64_t t0 = now_mono_ns();
+            bool ok = free_obj(a, out);
+            lat_add(&tot.lat[OP_FREE], now_mono_ns() - t0);
+            if (!ok) tot.free_failed++;
+            break;
+        }
+        case SLAB_TRACE_EPOCH_ADVANCE:
+            epoch_advance(a);
+            if (!em_set(&em, r->epoch, epoch_current(a))) {
+                fprintf(stderr, "Out of memory\n");
+                return 1;
+            }
+            tot.advances++;
+            break;
+        case SLAB_TRACE_EPOCH_CLOSE: {
+            bool known;
+            EpochId e = em_get(&em, r->epoch, &known);
+            if (!known) break;
+            uint64_t t0 = now_mono_ns();
+            epoch_close(a, e);
+            lat_add(&tot.lat[OP_CLOSE], now_mono_ns() - t0);
+            break;
+        }
+        case SLAB_TRACE_EPOCH_RELEASE: {
+            bool known;
+            EpochId e = em_get(&em, r->epoch, &known);
+            if (known) epoch_release_all(a, e);
+            tot.releases++;
+            break;
+        }
+        default:
+            break;
+        }
+
+        if ((k & 255u) == 0) {
+            uint64_t now = now_mono_ns();
+            if (now >= next_sample) {
+                rss_sample(&curve, (now - wall_t0) / 1000000u, trace_ms, live.len);
+                next_sample = now + sample_ns;
+            }
+        }
+    }
+
+    const uint64_t wall_ns = now_mono_ns() - wall_t0;
+    bench_perf_stop(&perf);
+    bench_perf_close(&perf);
+    rss_sample(&curve, wall_ns / 1000000u, trace_ms, live.len);
+
+    /* Results */
+    uint64_t rss_peak = 0, rss_sum = 0;
+    for (size_t s = 0; s < curve.len; s++) {
+        if (curve.s[s].rss > rss_peak) rss_peak = curve.s[s].rss;
+        rss_sum += curve.s[s].rss;
+    }
+    uint64_t ops = tot.lat[OP_ALLOC].count + tot.lat[OP_FREE].count;
+
+    printf("\n");
+    printf("Replay Results\n");
+    printf("==============\n");
+    printf("Elapsed time:        %.3f seconds (%lu records)\n", wall_ns / 1e9, (unsigned long)tr.n);
+    printf("Allocations:         %lu (%lu failed, %lu into pre-capture epochs)\n",
+           (unsigned long)tot.lat[OP_ALLOC].count, (unsigned long)tot.alloc_failed,
+           (unsigned long)tot.alloc_unmapped);
+    printf("Frees:               %lu (%lu rejected, %lu of pre-capture objects skipped)\n",
+           (unsigned long)tot.lat[OP_FREE].count, (unsigned long)tot.free_failed,
+           (unsigned long)tot.free_unmatched);
+    printf("Epochs:              %lu advanced, %lu closed, %lu released\n",
+           (unsigned long)tot.advances, (unsigned long)tot.lat[OP_CLOSE].count,
+           (unsigned long)tot.releases);
+    if (tot.anonymous) {
+        printf("Anonymous objects:   %lu (batch allocations traced without handles)\n",
+               (unsigned long)tot.anonymous);
+    }
+    printf("Live at end:         %lu objects\n", (unsigned long)live.len);
+    printf("RSS peak / mean / final: %.1f / %.1f / %.1f MiB above %.1f MiB baseline (%zu samples)\n",
+           rss_delta(rss_peak, rss_base) / (1024.0 * 1024.0),
+           rss_delta(rss_sum / curve.len, rss_base) / (1024.0 * 1024.0),
+           rss_delta(curve.s[curve.len - 1].rss, rss_base) / (1024.0 * 1024.0),
+           rss_base / (1024.0 * 1024.0), curve.len);
+    printf("\n%-12s %10s %8s %8s %8s %8s %10s\n", "Latency", "count", "avg", "p50", "p99", "p999", "max");
+    for (int op = 0; op < OP_COUNT; op++) {
+        const SlabLatencyHist* lh = &tot.lat[op];
+        if (!lh->count) continue;
+        printf("%-12s %10lu %7.0fn %7lun %7lun %7lun %9lun\n", k_op_names[op], (unsigned long)lh->count,
+               (double)lh->sum_ns / (double)lh->count,
+               (unsigned long)slab_latency_percentile(lh, 0.50),
+               (unsigned long)slab_latency_percentile(lh, 0.99),
+               (unsigned long)slab_latency_percentile(lh, 0.999),
+               (unsigned long)slab_latency_percentile(lh, 1.0));
+    }
+    bench_perf_print(&perf, ops);
+    printf("\n");
+
+    if (cfg.rss_csv) {
+        FILE* cf = fopen(cfg.rss_csv, "w");
+        if (!cf) {
+            fprintf(stderr, "Failed to open CSV file: %s\n", cfg.rss_csv);
+        } else {
+            fprintf(cf, "wall_ms,trace_ms,rss_bytes,rss_above_baseline,live_objects\n");
+            for (size_t s = 0; s < curve.len; s++) {
+                fprintf(cf, "%lu,%lu,%lu,%lu,%lu\n", (unsigned long)curve.s[s].wall_ms,
+                        (unsigned long)curve.s[s].trace_ms, (unsigned long)curve.s[s].rss,
+                        (unsigned long)rss_delta(curve.s[s].rss, rss_base),
+                        (unsigned long)curve.s[s].live);
+            }
+            fclose(cf);
+        }
+    }
+
+    if (cfg.json_path) {
+        FILE* jf = fopen(cfg.json_path, "w");
+        if (!jf) {
+            fprintf(stderr, "Failed to open JSON file: %s\n", cfg.json_path);
+        } else {
+            for (int op = 0; op < OP_COUNT; op++) {
+                const SlabLatencyHist* lh = &tot.lat[op];
+                if (!lh->count) continue;
+                BenchPhase ph = {
+                    .bench = "tslab_replay",
+                    .phase = k_op_names[op],
+                    .allocator = ALLOCATOR_NAME,
+                    .threads = 1,
+                    .ops = lh->count,
+                    .wall_ns = wall_ns,
+                    .avg_ns = (double)lh->sum_ns / (double)lh->count,
+                    .p50_ns = slab_latency_percentile(lh, 0.50),
+                    .p99_ns = slab_latency_percentile(lh, 0.99),
+                    .p999_ns = slab_latency_percentile(lh, 0.999),
+                };
+                bench_json_phase(jf, &ph, NULL);
+            }
+            BenchPhase ph = {
+                .bench = "tslab_replay",
+                .phase = "replay",
+                .allocator = ALLOCATOR_NAME,
+                .threads = 1,
+                .ops = ops,
+                .wall_ns = wall_ns,
+            };
+            bench_json_phase(jf, &ph, &perf);
+            fclose(jf);
+        }
+    }
+
+    slab_allocator_free(a);
+    free(live.slots);
+    free(em.ids);
+    free(curve.s);
+    free(tr.rec);
+    free(tr.ts);
+    free(tr.order);
+    return 0;
+}